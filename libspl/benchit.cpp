@@ -0,0 +1,1282 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+ *	Micro-benchmarks.  Build against the release library with "make bench",
+ *	then run "./benchit [name]" to run one benchmark.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <spl/types.h>
+#include <spl/Debug.h>
+#include <spl/Exception.h>
+#include <spl/IntrusivePtr.h>
+#include <spl/RefCountPtr.h>
+#include <spl/String.h>
+#include <spl/StringView.h>
+#include <spl/Variant.h>
+#include <spl/Int32.h>
+#include <spl/collection/Hashtable.h>
+#include <spl/collection/Queue.h>
+#include <spl/collection/RingQueue.h>
+#include <spl/collection/SizeClassPool.h>
+#include <spl/data/ColumnOps.h>
+#include <spl/data/DataTable.h>
+#include <spl/data/RecordSet.h>
+#include <spl/io/DelimitedFile.h>
+#include <spl/io/DelimitedFileLoader.h>
+#include <spl/io/File.h>
+#include <spl/io/FlatRecord.h>
+#include <spl/io/MemoryStream.h>
+#include <spl/io/StreamBuffer.h>
+#include <spl/net/Packet.h>
+#include <spl/net/PacketBuilder.h>
+#include <spl/net/PacketSendQueue.h>
+#include <spl/net/ServerSocket.h>
+#include <spl/net/TcpSocket.h>
+#include <spl/threading/ThreadStartDelegate.h>
+#include <spl/web/HttpRequest.h>
+#include <spl/web/HttpRequestParser.h>
+#include <spl/web/server/HttpInstance.h>
+
+using namespace spl;
+
+static double _Seconds()
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return (double)tv.tv_sec + (double)tv.tv_usec / 1000000.0;
+}
+
+static void _Report(const char *name, int count, double secs)
+{
+	printf("%-40s %10d in %6.3fs  %12.0f/s\n", name, count, secs, (double)count / secs);
+}
+
+#ifdef __GLIBC__
+/* Count every malloc, including the library's and operator new's. */
+extern "C" void *__libc_malloc(size_t size);
+
+static volatile long _mallocCount = 0;
+
+extern "C" void *malloc(size_t size)
+{
+	_mallocCount++;
+	return __libc_malloc(size);
+}
+#else
+static volatile long _mallocCount = 0;
+#endif
+
+static void _ReportAllocs(const char *name, int count, double secs, long mallocs)
+{
+	printf("%-40s %10d in %6.3fs  %12.0f/s  %6.2f mallocs/op\n", name, count, secs, (double)count / secs, (double)mallocs / count);
+}
+
+#define BENCH_STRING_ROUNDS 200000
+
+static const char *_benchStringLine = "  GET,/index.html,HTTP/1.1,keep-alive  ";
+
+/** @brief The String operations TestTString covers, counted by malloc calls. */
+static void BenchStrings()
+{
+	int rounds = BENCH_STRING_ROUNDS;
+	int check = 0;
+	String line(_benchStringLine);
+	String comma(",");
+
+	long mallocs = _mallocCount;
+	double start = _Seconds();
+	for ( int r = 0; r < rounds; r++ )
+	{
+		String a("abc");
+		String b(a);
+		String c("Content-Length");
+		check += a.Length() + b.Length() + c.Length();
+	}
+	_ReportAllocs("String short construct + copy", rounds, _Seconds() - start, _mallocCount - mallocs);
+
+	mallocs = _mallocCount;
+	start = _Seconds();
+	for ( int r = 0; r < rounds; r++ )
+	{
+		StringPtr t = line.Trim();
+		StringPtr left = t->Left(3);
+		StringPtr right = t->Right(10);
+		StringPtr mid = t->Mid(4, 15);
+		check += left->Length() + right->Length() + mid->Length();
+	}
+	_ReportAllocs("String Trim + Left/Right/Mid", rounds, _Seconds() - start, _mallocCount - mallocs);
+
+	mallocs = _mallocCount;
+	start = _Seconds();
+	for ( int r = 0; r < rounds; r++ )
+	{
+		String key = String("Host") + ": " + "example.com";
+		check += key.Length();
+	}
+	_ReportAllocs("String operator +", rounds, _Seconds() - start, _mallocCount - mallocs);
+
+	mallocs = _mallocCount;
+	start = _Seconds();
+	for ( int r = 0; r < rounds; r++ )
+	{
+		RefCountPtr<Vector<StringPtr> > parts = line.Split(comma);
+		check += parts->Count();
+	}
+	_ReportAllocs("String::Split", rounds, _Seconds() - start, _mallocCount - mallocs);
+
+	Vector<StringView> views;
+	mallocs = _mallocCount;
+	start = _Seconds();
+	for ( int r = 0; r < rounds; r++ )
+	{
+		views.Clear();
+		check += line.Split(StringView(","), views);
+		check += views.ElementAt(1).Trim().Equals("/index.html") ? 1 : 0;
+	}
+	_ReportAllocs("String::Split to StringView", rounds, _Seconds() - start, _mallocCount - mallocs);
+
+	mallocs = _mallocCount;
+	start = _Seconds();
+	for ( int r = 0; r < rounds; r++ )
+	{
+		check += line.IndexOf("HTTP") + line.IndexOf(StringView("HTTP"), 0);
+		check += line.StartsWith("  GET") ? 1 : 0;
+		check += line.Compare("  GET") + line.Equals("x") ? 1 : 0;
+	}
+	_ReportAllocs("String IndexOf/StartsWith/Compare", rounds, _Seconds() - start, _mallocCount - mallocs);
+
+	mallocs = _mallocCount;
+	start = _Seconds();
+	for ( int r = 0; r < rounds; r++ )
+	{
+		StringView v = line.View().Trim();
+		check += v.Left(3).Equals("GET") + v.Right(10).Length() + v.Substring(4, 11).IndexOf('.');
+	}
+	_ReportAllocs("StringView Trim + Left/Right/Substring", rounds, _Seconds() - start, _mallocCount - mallocs);
+
+	if ( 0 == check )
+	{
+		printf("unexpected check sum\n");
+	}
+}
+
+#define BENCH_HTTP_PIPELINE 16
+
+static const char *_benchHttpRequest = 
+	"GET /images/logo.png?size=large HTTP/1.1\r\n"
+	"Host: www.example.com\r\n"
+	"User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/120.0 Safari/537.36\r\n"
+	"Accept: image/avif,image/webp,image/apng,image/*,*/*;q=0.8\r\n"
+	"Accept-Encoding: gzip, deflate, br\r\n"
+	"Accept-Language: en-US,en;q=0.9\r\n"
+	"Referer: http://www.example.com/index.html\r\n"
+	"Cookie: session=4f2a9c1d7e; theme=dark\r\n"
+	"Connection: keep-alive\r\n"
+	"\r\n";
+
+/** @brief One end of a socketpair, so HttpInstance can be run without a listening port. */
+class BenchPairSocket : public TcpSocket
+{
+public:
+	BenchPairSocket(int fd) : TcpSocket(fd) {}
+};
+
+/** @brief Answers 200, optionally reading what a file handler would. */
+class BenchHandler : public HttpHandler
+{
+public:
+	bool m_read;
+	int m_seen;
+
+	BenchHandler(bool read) : HttpHandler("text/plain"), m_read(read), m_seen(0)
+	{
+		m_fileExtensions.Add("png");
+	}
+
+	virtual void ProcessRequest(HttpRequest& request, HttpResponse& response)
+	{
+		if ( m_read )
+		{
+			m_seen += request.Method().Length() + request.URI().Path().Length() + request.Headers().Header("Host").Length();
+		}
+		response.GetBodyStream()->Write(String("ok").ToByteArray());
+	}
+};
+
+/** @brief Runs the pipelined requests through HttpInstance, the server's path, draining the responses. */
+static void BenchHttpInstance(const Array<byte>& buf, int rounds, bool handlerReads)
+{
+	int fds[2];
+	if ( 0 != socketpair(AF_UNIX, SOCK_STREAM, 0, fds) )
+	{
+		printf("socketpair failed\n");
+		return;
+	}
+	fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+
+	HttpHandlerFactory fact;
+	fact.AddHandler(HttpHandlerPtr(new BenchHandler(handlerReads)));
+	char drain[16 * 1024];
+	{
+		HttpInstance inst(TcpSocketPtr(new BenchPairSocket(fds[0])), &fact, 0x7fffffff);
+
+		long mallocs = _mallocCount;
+		double start = _Seconds();
+		for ( int r = 0; r < rounds; r++ )
+		{
+			inst.IStreamRead_OnRead(buf, buf.Length());
+			while ( 0 < ::read(fds[1], drain, sizeof(drain)) )
+			{
+			}
+		}
+		double secs = _Seconds() - start;
+		_ReportAllocs(handlerReads ? "HttpInstance, handler reads request" : "HttpInstance, handler ignores request", inst.RequestCount(), secs, _mallocCount - mallocs);
+	}
+	::close(fds[1]);
+}
+
+static void BenchHttpParser(int rounds)
+{
+	int reqlen = (int)strlen(_benchHttpRequest);
+	Array<byte> buf(reqlen * BENCH_HTTP_PIPELINE);
+	for ( int x = 0; x < BENCH_HTTP_PIPELINE; x++ )
+	{
+		memcpy(&buf.Data()[x * reqlen], _benchHttpRequest, reqlen);
+	}
+
+	int count = 0;
+	double start = _Seconds();
+	HttpRequest req;
+	for ( int r = 0; r < rounds; r++ )
+	{
+		int pos = 0;
+		while ( pos < buf.Length() )
+		{
+			pos = req.Parse(buf, pos, buf.Length());
+			if ( req.IsComplete() )
+			{
+				count++;
+				req.Reset();
+			}
+		}
+	}
+	_Report("HttpRequest::Parse", count, _Seconds() - start);
+
+	count = 0;
+	start = _Seconds();
+	HttpRequestParser parser;
+	for ( int r = 0; r < rounds; r++ )
+	{
+		bool complete = parser.Parse(buf, 0, buf.Length());
+		while ( complete )
+		{
+			if ( parser.IsKeepAlive() && parser.HasHeader(HTTP_HDR_HOST) )
+			{
+				count++;
+			}
+			complete = parser.Next();
+		}
+	}
+	_Report("HttpRequestParser::Parse", count, _Seconds() - start);
+
+	count = 0;
+	start = _Seconds();
+	for ( int r = 0; r < rounds; r++ )
+	{
+		bool complete = parser.Parse(buf, 0, buf.Length());
+		while ( complete )
+		{
+			parser.CopyTo(req);
+			count++;
+			complete = parser.Next();
+		}
+	}
+	_Report("HttpRequestParser::Parse + CopyTo", count, _Seconds() - start);
+
+	BenchHttpInstance(buf, rounds, false);
+	BenchHttpInstance(buf, rounds, true);
+}
+
+#define BENCH_QUEUE_ITEMS 400000
+#define BENCH_QUEUE_MAX_PRODUCERS 16
+
+/** @brief Puts items on a Queue or RingQueue from its own thread. */
+template<typename Q>
+class BenchProducer
+{
+public:
+	Q *m_q;
+	int m_count;
+	ThreadStartDelegate<BenchProducer<Q> > m_thread;
+
+	BenchProducer() : m_q(NULL), m_count(0), m_thread()
+	{
+	}
+
+	void Run()
+	{
+		for ( int x = 0; x < m_count; x++ )
+		{
+			m_q->Put(x);
+		}
+	}
+};
+
+template<typename Q>
+static void BenchQueue(const char *name, Q& q, int producers)
+{
+	BenchProducer<Q> threads[BENCH_QUEUE_MAX_PRODUCERS];
+	int perThread = BENCH_QUEUE_ITEMS / producers;
+	int total = perThread * producers;
+	char label[64];
+
+	double start = _Seconds();
+	for ( int x = 0; x < producers; x++ )
+	{
+		threads[x].m_q = &q;
+		threads[x].m_count = perThread;
+		threads[x].m_thread.Set(&threads[x], &BenchProducer<Q>::Run);
+		threads[x].m_thread.Start();
+	}
+	for ( int x = 0; x < total; x++ )
+	{
+		q.Get();
+	}
+	double secs = _Seconds() - start;
+
+	for ( int x = 0; x < producers; x++ )
+	{
+		while ( threads[x].m_thread.IsRunning() )
+		{
+			Thread::YYield();
+		}
+	}
+	sprintf(label, "%s, %d producer%s", name, producers, producers > 1 ? "s" : "");
+	_Report(label, total, secs);
+}
+
+static void BenchQueues()
+{
+	static const int producerCounts[] = { 1, 4, 16 };
+
+	for ( int x = 0; x < 3; x++ )
+	{
+		Queue<int> q;
+		BenchQueue("Queue::Put", q, producerCounts[x]);
+	}
+	for ( int x = 0; x < 3; x++ )
+	{
+		RingQueue<int> q(4096);
+		BenchQueue("RingQueue::Put", q, producerCounts[x]);
+	}
+}
+
+#define BENCH_ALLOC_ROUNDS 10000000
+#define BENCH_ALLOC_BATCH 64
+#define BENCH_ALLOC_MAX_THREADS 8
+
+/** @brief Allocates and frees batches of small mixed size blocks, from malloc or a SizeClassPool. */
+class BenchAllocator
+{
+public:
+	SizeClassPool *m_pool;
+	ThreadStartDelegate<BenchAllocator> m_thread;
+
+	BenchAllocator() : m_pool(NULL), m_thread()
+	{
+	}
+
+	void Run()
+	{
+		void *blocks[BENCH_ALLOC_BATCH];
+		for ( int r = 0; r < BENCH_ALLOC_ROUNDS / BENCH_ALLOC_BATCH; r++ )
+		{
+			for ( int x = 0; x < BENCH_ALLOC_BATCH; x++ )
+			{
+				int size = 16 + (x * 24) % 200;
+				blocks[x] = NULL == m_pool ? malloc(size) : m_pool->Malloc(size);
+				*(int *)blocks[x] = x;
+			}
+			for ( int x = 0; x < BENCH_ALLOC_BATCH; x++ )
+			{
+				NULL == m_pool ? free(blocks[x]) : m_pool->Free(blocks[x]);
+			}
+		}
+	}
+};
+
+static void BenchAlloc(const char *name, SizeClassPool *pool, int threadCount)
+{
+	BenchAllocator threads[BENCH_ALLOC_MAX_THREADS];
+	char label[64];
+
+	double start = _Seconds();
+	for ( int x = 0; x < threadCount; x++ )
+	{
+		threads[x].m_pool = pool;
+		threads[x].m_thread.Set(&threads[x], &BenchAllocator::Run);
+		threads[x].m_thread.Start();
+	}
+	for ( int x = 0; x < threadCount; x++ )
+	{
+		while ( threads[x].m_thread.IsRunning() )
+		{
+			Thread::YYield();
+		}
+	}
+	double secs = _Seconds() - start;
+
+	sprintf(label, "%s, %d thread%s", name, threadCount, threadCount > 1 ? "s" : "");
+	_Report(label, BENCH_ALLOC_ROUNDS * threadCount, secs);
+}
+
+static void BenchAllocs()
+{
+	static const int threadCounts[] = { 1, 4, 8 };
+
+	for ( int x = 0; x < 3; x++ )
+	{
+		BenchAlloc("malloc + free", NULL, threadCounts[x]);
+	}
+	for ( int x = 0; x < 3; x++ )
+	{
+		BenchAlloc("SizeClassPool Malloc + Free", &SizeClassPool::Default(), threadCounts[x]);
+	}
+}
+
+#define BENCH_PTR_ROUNDS 1000000
+#define BENCH_PTR_COPIES 8
+
+/** @brief Make a pointer to a short String, then copy it around. */
+template<typename P>
+static int _BenchPtrCopies(const P& ptr)
+{
+	P copies[BENCH_PTR_COPIES];
+	int check = 0;
+	for ( int x = 0; x < BENCH_PTR_COPIES; x++ )
+	{
+		copies[x] = ptr;
+		check += copies[x]->Length();
+	}
+	return check;
+}
+
+static void BenchPtrs()
+{
+	int rounds = BENCH_PTR_ROUNDS;
+	int check = 0;
+
+	long mallocs = _mallocCount;
+	double start = _Seconds();
+	for ( int r = 0; r < rounds; r++ )
+	{
+		RefCountPtr<String> ptr(new String("abc"));
+		check += _BenchPtrCopies(ptr);
+	}
+	_ReportAllocs("RefCountPtr make + 8 copies", rounds, _Seconds() - start, _mallocCount - mallocs);
+
+	mallocs = _mallocCount;
+	start = _Seconds();
+	for ( int r = 0; r < rounds; r++ )
+	{
+		RefCountPtr<String> ptr(new String("abc"), true);
+		check += _BenchPtrCopies(ptr);
+	}
+	_ReportAllocs("RefCountPtr thread safe make + 8 copies", rounds, _Seconds() - start, _mallocCount - mallocs);
+
+	mallocs = _mallocCount;
+	start = _Seconds();
+	for ( int r = 0; r < rounds; r++ )
+	{
+		IntrusivePtr<String> ptr = IntrusivePtr<String>::New("abc");
+		check += _BenchPtrCopies(ptr);
+	}
+	_ReportAllocs("IntrusivePtr make + 8 copies", rounds, _Seconds() - start, _mallocCount - mallocs);
+
+	if ( 0 == check )
+	{
+		printf("unexpected check sum\n");
+	}
+}
+
+#define BENCH_HASH_KEYS 100000
+#define BENCH_HASH_ROUNDS 10
+
+/** @brief Hashtable insert, hit, miss and iteration, with int and String keys. */
+static void BenchHashtable()
+{
+	int keys = BENCH_HASH_KEYS;
+	int rounds = BENCH_HASH_ROUNDS;
+	long check = 0;
+	int x;
+
+	long mallocs = _mallocCount;
+	double start = _Seconds();
+	for ( int r = 0; r < rounds; r++ )
+	{
+		Hashtable<int, int> ht;
+		for ( x = 0; x < keys; x++ )
+		{
+			ht.Set(x * 7, x);
+		}
+		check += ht.Count();
+	}
+	_ReportAllocs("Hashtable<int,int> Set", keys * rounds, _Seconds() - start, _mallocCount - mallocs);
+
+	Hashtable<int, int> iht;
+	for ( x = 0; x < keys; x++ )
+	{
+		iht.Set(x * 7, x);
+	}
+
+	start = _Seconds();
+	for ( int r = 0; r < rounds; r++ )
+	{
+		for ( x = 0; x < keys; x++ )
+		{
+			check += iht.Get(x * 7);
+			check += iht.ContainsKey(x * 7 + 1) ? 1 : 0;
+		}
+	}
+	_Report("Hashtable<int,int> Get hit + miss", keys * rounds, _Seconds() - start);
+
+	start = _Seconds();
+	for ( int r = 0; r < rounds; r++ )
+	{
+		Hashtable<int, int>::Iterator iter = iht.Begin();
+		while ( iter.Next() )
+		{
+			check += iter.Current();
+		}
+	}
+	_Report("Hashtable<int,int> iterate", keys * rounds, _Seconds() - start);
+
+	Vector<StringPtr> names(keys);
+	for ( x = 0; x < keys; x++ )
+	{
+		names.Add(StringPtr(new String("column_" + *Int32::ToString(x))));
+	}
+
+	mallocs = _mallocCount;
+	start = _Seconds();
+	for ( int r = 0; r < rounds; r++ )
+	{
+		Hashtable<String, int> ht;
+		for ( x = 0; x < keys; x++ )
+		{
+			ht.Set(*names.ElementAt(x), x);
+		}
+		check += ht.Count();
+	}
+	_ReportAllocs("Hashtable<String,int> Set", keys * rounds, _Seconds() - start, _mallocCount - mallocs);
+
+	Hashtable<String, int> sht;
+	for ( x = 0; x < keys; x++ )
+	{
+		sht.Set(*names.ElementAt(x), x);
+	}
+
+	start = _Seconds();
+	for ( int r = 0; r < rounds; r++ )
+	{
+		for ( x = 0; x < keys; x++ )
+		{
+			check += sht.Get(*names.ElementAt(x));
+		}
+	}
+	_Report("Hashtable<String,int> Get", keys * rounds, _Seconds() - start);
+
+	int value;
+	mallocs = _mallocCount;
+	start = _Seconds();
+	for ( int r = 0; r < rounds * keys; r++ )
+	{
+		check += sht.TryGet("column_42", value) ? value : 0;
+	}
+	_ReportAllocs("Hashtable<String,int> TryGet const char *", keys * rounds, _Seconds() - start, _mallocCount - mallocs);
+
+	if ( 0 == check )
+	{
+		printf("unexpected check sum\n");
+	}
+}
+
+#define BENCH_VARIANT_ROWS 50000
+#define BENCH_VARIANT_ROUNDS 1000000
+
+/** @brief Fills a DataTable of int, double, DateTime and String cells, then does Variant arithmetic. */
+static void BenchVariants()
+{
+	int rows = BENCH_VARIANT_ROWS;
+	double check = 0;
+
+	DataTable table("bench");
+	DataColumnPtr id = table.AddColumn("id");
+	DataColumnPtr price = table.AddColumn("price");
+	DataColumnPtr stamp = table.AddColumn("stamp");
+	DataColumnPtr name = table.AddColumn("name");
+	DateTime now = DateTime::Now();
+	String label("item");
+
+	long mallocs = _mallocCount;
+	double start = _Seconds();
+	for ( int r = 0; r < rows; r++ )
+	{
+		DataRowPtr row(new DataRow());
+		row->AddColumn(*id, Variant(r));
+		row->AddColumn(*price, Variant(r * 0.25));
+		row->AddColumn(*stamp, Variant(now));
+		row->AddColumn(*name, Variant(label));
+		table.AddRow(row);
+	}
+	_ReportAllocs("DataTable fill, 4 columns", rows, _Seconds() - start, _mallocCount - mallocs);
+
+	mallocs = _mallocCount;
+	start = _Seconds();
+	for ( int pass = 0; pass < 10; pass++ )
+	{
+		for ( int r = 0; r < rows; r++ )
+		{
+			check += table.Cell(r, 0)->ToInt32() + table.Cell(r, 1)->ToFloat64();
+		}
+	}
+	_ReportAllocs("DataTable read int + double cells", rows * 10, _Seconds() - start, _mallocCount - mallocs);
+
+	int rounds = BENCH_VARIANT_ROUNDS;
+	Variant sum((int64)0);
+	Variant fsum(0.0);
+	Variant two(2);
+	Variant half(0.5);
+
+	mallocs = _mallocCount;
+	start = _Seconds();
+	for ( int r = 0; r < rounds; r++ )
+	{
+		Variant v(r);
+		sum = sum + v * two;
+		fsum = fsum + v * half - two;
+		if ( sum < fsum )
+		{
+			check++;
+		}
+	}
+	_ReportAllocs("Variant arithmetic, 5 ops + compare", rounds, _Seconds() - start, _mallocCount - mallocs);
+
+	if ( 0 == check || 0 == sum.ToInt64() )
+	{
+		printf("unexpected check sum\n");
+	}
+}
+
+#define BENCH_COLUMN_ROWS 1000000
+
+static void BenchColumns()
+{
+	int rows = BENCH_COLUMN_ROWS;
+	int passes = 10;
+	double check = 0;
+
+	RecordSet rs;
+	rs.DefineColumn("id", DbSqlType::SQL_TYPE_INT32, 4);
+	rs.DefineColumn("grp", DbSqlType::SQL_TYPE_INT32, 4);
+	rs.DefineColumn("price", DbSqlType::SQL_TYPE_FLOAT64, 8);
+	IColumn *id = rs.GetColumn("id");
+	IColumn *grp = rs.GetColumn("grp");
+	IColumn *price = rs.GetColumn("price");
+	for ( int r = 0; r < rows; r++ )
+	{
+		id->Append( (int32)(((int64)r * 7919) % rows) );
+		grp->Append( (int32)(r % 100) );
+		if ( 0 == r % 50 )
+		{
+			price->AppendNull();
+		}
+		else
+		{
+			price->Append( (float64)(r % 1000) * 0.25 );
+		}
+	}
+
+	double start = _Seconds();
+	for ( int pass = 0; pass < passes; pass++ )
+	{
+		int count = 0;
+		double sum = 0;
+		for ( int r = 0; r < rows; r++ )
+		{
+			if ( id->GetInt32(r) < rows / 2 && !price->IsNull(r) )
+			{
+				count++;
+				sum += price->GetFloat64(r);
+			}
+		}
+		check += count + sum;
+	}
+	_Report("row at a time filter + sum", rows * passes, _Seconds() - start);
+
+	start = _Seconds();
+	for ( int pass = 0; pass < passes; pass++ )
+	{
+		RowBitmap sel(rows);
+		ColumnOps::Filter( id, ColumnOps::CMP_LT, (int64)(rows / 2), sel );
+		ColumnSummary summary = ColumnOps::Aggregate( price, &sel );
+		check += summary.count + summary.sum;
+	}
+	_Report("ColumnOps filter + sum", rows * passes, _Seconds() - start);
+
+	start = _Seconds();
+	for ( int pass = 0; pass < passes; pass++ )
+	{
+		ColumnSummary summary = ColumnOps::Aggregate( price );
+		check += summary.sum + summary.max;
+	}
+	_Report("ColumnOps sum, min, max", rows * passes, _Seconds() - start);
+
+	start = _Seconds();
+	RecordSetPtr groups = ColumnOps::GroupBy( rs, "grp", "price" );
+	_Report("ColumnOps group by, 100 keys", rows, _Seconds() - start);
+	check += groups->RowCount();
+
+	Vector<IColumn *> keys;
+	keys.Add( id );
+	Vector<int> perm;
+	start = _Seconds();
+	ColumnOps::Sort( keys, Vector<bool>(), NULL, perm );
+	_Report("ColumnOps sort int32", rows, _Seconds() - start);
+	check += perm.ElementAt(0);
+
+	if ( 0 == check )
+	{
+		printf("unexpected check sum\n");
+	}
+}
+
+#define BENCH_CSV_ROWS 500000
+
+static void BenchCsv()
+{
+	const char *filename = "benchcsv.csv";
+	int rows = BENCH_CSV_ROWS;
+	char line[128];
+
+	FILE *fp = fopen(filename, "w");
+	for ( int r = 0; r < rows; r++ )
+	{
+		fprintf(fp, "%d,\"Item %d, size %d\",%d.%02d,%d\n", r, r, r % 7, r % 1000, r % 100, r % 50);
+	}
+	fclose(fp);
+
+	double start = _Seconds();
+	DelimitedFilePtr df = DelimitedFile::Parse(filename, ',');
+	_Report("DelimitedFile::Parse", df->RowCount(), _Seconds() - start);
+	df.Release();
+
+	static const int threadCounts[] = { 1, 4, 8 };
+	for ( int t = 0; t < (int)(sizeof(threadCounts) / sizeof(threadCounts[0])); t++ )
+	{
+		DelimitedFileLoader loader(filename, ',');
+		loader.DefineColumn("id", DbSqlType::SQL_TYPE_INT32, 4);
+		loader.DefineColumn("name", DbSqlType::SQL_TYPE_VARCHAR, 32);
+		loader.DefineColumn("price", DbSqlType::SQL_TYPE_FLOAT64, 8);
+		loader.DefineColumn("qty", DbSqlType::SQL_TYPE_INT32, 4);
+		loader.SetThreadCount(threadCounts[t]);
+
+		start = _Seconds();
+		RecordSetPtr rs = loader.Load();
+		sprintf(line, "DelimitedFileLoader, %d thread%s", threadCounts[t], threadCounts[t] > 1 ? "s" : "");
+		_Report(line, rs->RowCount(), _Seconds() - start);
+		if ( rs->RowCount() != rows || rs->GetColumn(0)->GetInt32(rows - 1) != rows - 1 )
+		{
+			printf("unexpected row count\n");
+		}
+	}
+
+	File::Delete(filename);
+}
+
+#define BENCH_FIXED_RECORDS 1000000
+
+static void BenchFixed()
+{
+	const char *filename = "benchfixed.dat";
+	int records = BENCH_FIXED_RECORDS;
+	char line[128];
+
+	FixedRecordDefPtr def(new FixedRecordDef(60));
+	def->AddField("RecordType", 2, DbSqlType::SQL_TYPE_CHAR);
+	def->AddDateField("Received", 6, FIXED_FMT_MMDDYY);
+	def->AddField("Batch", 6, DbSqlType::SQL_TYPE_INT32);
+	def->AddFiller(2);
+	def->AddField("Amount", 14, DbSqlType::SQL_TYPE_FLOAT64, 2);
+	def->AddField("Name", 20, DbSqlType::SQL_TYPE_VARCHAR);
+	def->AddFiller(10);
+
+	FILE *fp = fopen(filename, "wb");
+	for ( int r = 0; r < records; r++ )
+	{
+		fprintf(fp, "M 0704%02d%06d  %+014d%-20s%10s\n", r % 30, r % 1000000, r * 7, "Company name", "");
+	}
+	fclose(fp);
+
+	FixedRecordFile file(filename, def);
+	int amount = def->GetFieldOrdinal("Amount");
+	int batch = def->GetFieldOrdinal("Batch");
+
+	// What the old String per field approach costs.
+	double start = _Seconds();
+	int64 sum = 0;
+	for ( int r = 0; r < records; r++ )
+	{
+		FixedRecord rec = file.Record(r);
+		for ( int f = 0; f < def->FieldCount(); f++ )
+		{
+			StringPtr field = rec.GetView(f).ToString();
+			if ( f == batch )
+			{
+				sum += Int32::Parse(*field);
+			}
+		}
+	}
+	_Report("FixedRecord String per field", records, _Seconds() - start);
+
+	start = _Seconds();
+	int64 sum2 = 0;
+	for ( int r = 0; r < records; r++ )
+	{
+		FixedRecord rec = file.Record(r);
+		sum2 += rec.GetInt32(batch);
+		sum2 += (int64)rec.GetFloat64(amount) * 0;
+	}
+	_Report("FixedRecord views", records, _Seconds() - start);
+	if ( sum != sum2 )
+	{
+		printf("unexpected sum\n");
+	}
+
+	static const int threadCounts[] = { 1, 4, 8 };
+	for ( int t = 0; t < (int)(sizeof(threadCounts) / sizeof(threadCounts[0])); t++ )
+	{
+		file.SetThreadCount(threadCounts[t]);
+		start = _Seconds();
+		RecordSetPtr rs = file.Load();
+		sprintf(line, "FixedRecordFile::Load, %d thread%s", threadCounts[t], threadCounts[t] > 1 ? "s" : "");
+		_Report(line, rs->RowCount(), _Seconds() - start);
+		if ( rs->RowCount() != records )
+		{
+			printf("unexpected row count\n");
+		}
+	}
+
+	File::Delete(filename);
+}
+
+#define BENCH_PACKET_ROUNDS 200000
+#define BENCH_PACKET_BIG_ROUNDS 20000
+#define BENCH_PACKET_BIG_SIZE 16384
+#define BENCH_PACKET_PORT 47311
+
+/** @brief Sends big packets over loopback, either gathered or copied into one buffer as v1 did. */
+class BenchPacketSender
+{
+public:
+	spl::IStreamPtr m_strm;
+	bool m_copy;
+	ThreadStartDelegate<BenchPacketSender> m_thread;
+
+	BenchPacketSender() : m_strm(), m_copy(false), m_thread()
+	{
+	}
+
+	void Run()
+	{
+		Packet pkt;
+		Array<byte> payload(BENCH_PACKET_BIG_SIZE);
+		pkt.Append(payload);
+		byte header[PACKET_V2_HEADER_SIZE];
+
+		for ( int x = 0; x < BENCH_PACKET_BIG_ROUNDS; x++ )
+		{
+			if ( m_copy )
+			{
+				int hlen = pkt.FrameHeader(header);
+				Array<byte> frame(hlen + pkt.PayloadSize());
+				memcpy(frame.Data(), header, hlen);
+				memcpy(&frame.Data()[hlen], pkt.Payload(), pkt.PayloadSize());
+				m_strm->Write(frame);
+			}
+			else
+			{
+				pkt.SendPacket(*m_strm);
+			}
+		}
+	}
+};
+
+static void BenchPacket()
+{
+	char line[128];
+
+	static const PacketWireVersion versions[] = { PACKET_WIRE_V1, PACKET_WIRE_V2 };
+	for ( int v = 0; v < 2; v++ )
+	{
+		MemoryStream strm;
+		Packet out;
+		Packet in;
+		out.SetWireVersion(versions[v]);
+		int64 sum = 0;
+		int frameBytes = 0;
+
+		double start = _Seconds();
+		for ( int r = 0; r < BENCH_PACKET_ROUNDS; r++ )
+		{
+			out.Clear();
+			for ( int x = 0; x < 16; x++ )
+			{
+				out.Append((int32)(r % 1000 + x));
+			}
+			out.Append("customer name", 13);
+			out.SendPacket(strm);
+			frameBytes = (int)strm.Length();
+
+			in.ReadPacket(strm);
+			for ( int x = 0; x < 16; x++ )
+			{
+				sum += in.ReadInt32();
+			}
+			sum += in.ReadString()->Length();
+		}
+		sprintf(line, "Packet v%d round trip, %d byte frames", (int)versions[v], frameBytes);
+		_Report(line, BENCH_PACKET_ROUNDS, _Seconds() - start);
+		if ( 0 == sum )
+		{
+			printf("unexpected sum\n");
+		}
+	}
+
+	ServerSocket server(BENCH_PACKET_PORT, 5);
+	for ( int copy = 1; copy >= 0; copy-- )
+	{
+		TcpSocket client("127.0.0.1", BENCH_PACKET_PORT);
+		client.Connect();
+		TcpSocketPtr peer = server.Accept();
+
+		BenchPacketSender sender;
+		sender.m_strm = client.GetStream();
+		sender.m_copy = 0 != copy;
+
+		StreamBuffer reader(peer->GetStream(), 64 * 1024);
+		Packet in;
+
+		double start = _Seconds();
+		sender.m_thread.Set(&sender, &BenchPacketSender::Run);
+		sender.m_thread.Start();
+		for ( int x = 0; x < BENCH_PACKET_BIG_ROUNDS; x++ )
+		{
+			in.ReadPacket(reader);
+		}
+		double secs = _Seconds() - start;
+		while ( sender.m_thread.IsRunning() )
+		{
+			Thread::YYield();
+		}
+		sprintf(line, "16K packets over loopback, %s", copy ? "copied" : "gathered");
+		_Report(line, BENCH_PACKET_BIG_ROUNDS, secs);
+		client.Close();
+	}
+}
+
+#define BENCH_CORK_PACKETS 200000
+#define BENCH_CORK_RESPONSE 32
+#define BENCH_CORK_PORT 47312
+
+/** @brief Sends small packets in responses of BENCH_CORK_RESPONSE, one write each or through a PacketSendQueue. */
+class BenchCorkSender
+{
+public:
+	spl::IStreamPtr m_strm;
+	PacketSendQueue *m_q;
+	ThreadStartDelegate<BenchCorkSender> m_thread;
+
+	BenchCorkSender() : m_strm(), m_q(NULL), m_thread()
+	{
+	}
+
+	void Run()
+	{
+		Packet pkt;
+		for ( int x = 0; x < BENCH_CORK_PACKETS; x++ )
+		{
+			pkt.Clear();
+			pkt.Append((int32)x);
+			pkt.Append("row", 3);
+			if ( NULL == m_q )
+			{
+				pkt.SendPacket(*m_strm);
+			}
+			else
+			{
+				m_q->Send(pkt);
+				if ( 0 == (x + 1) % BENCH_CORK_RESPONSE )
+				{
+					m_q->Flush();
+				}
+			}
+		}
+		if ( NULL != m_q )
+		{
+			m_q->Flush();
+		}
+	}
+};
+
+static void BenchCork()
+{
+	char line[128];
+	ServerSocket server(BENCH_CORK_PORT, 5);
+
+	for ( int corked = 0; corked < 2; corked++ )
+	{
+		TcpSocket client("127.0.0.1", BENCH_CORK_PORT);
+		client.Connect();
+		client.SetNoDelay();
+		TcpSocketPtr peer = server.Accept();
+
+		PacketSendQueue q(client.GetStream());
+		BenchCorkSender sender;
+		sender.m_strm = client.GetStream();
+		sender.m_q = corked ? &q : NULL;
+
+		StreamBuffer reader(peer->GetStream(), 64 * 1024);
+		Packet in;
+
+		double start = _Seconds();
+		sender.m_thread.Set(&sender, &BenchCorkSender::Run);
+		sender.m_thread.Start();
+		for ( int x = 0; x < BENCH_CORK_PACKETS; x++ )
+		{
+			in.ReadPacket(reader);
+		}
+		double secs = _Seconds() - start;
+		while ( sender.m_thread.IsRunning() )
+		{
+			Thread::YYield();
+		}
+		if ( corked )
+		{
+			sprintf(line, "PacketSendQueue, %.1f packets/write", q.PacketsPerWrite());
+		}
+		else
+		{
+			sprintf(line, "SendPacket, 1 packet/write");
+		}
+		_Report(line, BENCH_CORK_PACKETS, secs);
+		client.Close();
+	}
+}
+
+#define BENCH_FRAME_COUNT 200000
+#define BENCH_FRAME_FIELDS 7
+#define BENCH_FRAME_CHUNK 4096
+
+/** @brief Sums what PacketBuilder dispatches, one delegate call per value. */
+class BenchFrameValues : public IPacketListener
+{
+public:
+	int64 m_sum;
+	int m_fields;
+
+	BenchFrameValues() : m_sum(0), m_fields(0) {}
+	virtual ~BenchFrameValues() {}
+
+	virtual void IPacket_OnData(int64 i) { m_sum += i; m_fields++; }
+	virtual void IPacket_OnData(int32 i) { m_sum += i; m_fields++; }
+	virtual void IPacket_OnData(int16 i) { m_sum += i; m_fields++; }
+	virtual void IPacket_OnData(byte i) { m_sum += i; m_fields++; }
+	virtual void IPacket_OnData(bool b) { m_fields++; }
+	virtual void IPacket_OnData(double d) { m_fields++; }
+	virtual void IPacket_OnData(StringPtr str) { m_sum += str->Length(); m_fields++; }
+	virtual void IPacket_OnData(const Vector<byte>& data, const int len) { m_sum += len; m_fields++; }
+	virtual void IPacket_OnData(const DateTime& dtm) { m_fields++; }
+	virtual void IPacket_OnData(const Date& i) { m_fields++; }
+	virtual void IStreamRead_OnError(const String& msg) {}
+	virtual void IStreamRead_OnClose() {}
+};
+
+/** @brief Sums the same values read in place with a PacketFrame. */
+class BenchFrameCursor : public IPacketFrameListener
+{
+public:
+	int64 m_sum;
+	int m_fields;
+
+	BenchFrameCursor() : m_sum(0), m_fields(0) {}
+	virtual ~BenchFrameCursor() {}
+
+	virtual void IPacketFrame_OnFrame(PacketFrame& frame)
+	{
+		m_sum += frame.NextInt32();
+		m_sum += frame.NextInt32();
+		m_sum += frame.NextInt64();
+		m_sum += frame.NextInt32();
+		m_sum += frame.NextStringView().Length();
+		m_sum += frame.NextStringView().Length();
+		m_sum += frame.NextBytesView().Length();
+		m_fields += BENCH_FRAME_FIELDS;
+	}
+
+	virtual void IStreamRead_OnError(const String& msg) {}
+	virtual void IStreamRead_OnClose() {}
+};
+
+static void _BenchFrameFeed(IStreamReadListener *listener, const Array<byte>& frames, int len)
+{
+	Array<byte> chunk(BENCH_FRAME_CHUNK);
+	for ( int pos = 0; pos < len; pos += BENCH_FRAME_CHUNK )
+	{
+		int count = len - pos < BENCH_FRAME_CHUNK ? len - pos : BENCH_FRAME_CHUNK;
+		memcpy(chunk.Data(), &frames.Data()[pos], count);
+		listener->IStreamRead_OnRead(chunk, count);
+	}
+}
+
+/** @brief Decodes a stream of small frames, per value through PacketBuilder or per frame with a cursor. */
+static void BenchFrames()
+{
+	char line[128];
+	Array<byte> raw(32);
+
+	for ( int version = PACKET_WIRE_V1; version <= PACKET_WIRE_V2; version++ )
+	{
+		MemoryStream strm;
+		Packet pkt;
+		pkt.SetWireVersion((PacketWireVersion)version);
+		for ( int x = 0; x < BENCH_FRAME_COUNT; x++ )
+		{
+			pkt.Clear();
+			pkt.Append((int32)x);
+			pkt.Append((int32)-x);
+			pkt.Append((int64)x * 1000);
+			pkt.Append((int32)(x & 0xFF));
+			pkt.Append("account");
+			pkt.Append("a somewhat longer string value");
+			pkt.Append(raw);
+			pkt.SendPacket(strm);
+		}
+		int len = (int)strm.Length();
+		Array<byte> frames(len);
+		strm.Read(frames);
+
+		BenchFrameValues values;
+		PacketBuilder *builder = new PacketBuilder();
+		builder->Delegates().Add(&values);
+		long mallocs = _mallocCount;
+		double start = _Seconds();
+		_BenchFrameFeed(builder, frames, len);
+		sprintf(line, "v%d PacketBuilder fields", version);
+		_ReportAllocs(line, values.m_fields, _Seconds() - start, _mallocCount - mallocs);
+		delete builder;
+
+		BenchFrameCursor cursor;
+		PacketFrameBuilder *frameBuilder = new PacketFrameBuilder(&cursor);
+		mallocs = _mallocCount;
+		start = _Seconds();
+		_BenchFrameFeed(frameBuilder, frames, len);
+		sprintf(line, "v%d PacketFrameBuilder fields", version);
+		_ReportAllocs(line, cursor.m_fields, _Seconds() - start, _mallocCount - mallocs);
+		delete frameBuilder;
+
+		if ( values.m_sum != cursor.m_sum || values.m_fields != cursor.m_fields )
+		{
+			printf("frame decode mismatch\n");
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	const char *which = (argc > 1) ? argv[1] : "all";
+
+	try
+	{
+		if ( 0 == strcmp(which, "all") || 0 == strcmp(which, "http") )
+		{
+			BenchHttpParser(20000);
+		}
+		if ( 0 == strcmp(which, "all") || 0 == strcmp(which, "queue") )
+		{
+			BenchQueues();
+		}
+		if ( 0 == strcmp(which, "all") || 0 == strcmp(which, "string") )
+		{
+			BenchStrings();
+		}
+		if ( 0 == strcmp(which, "all") || 0 == strcmp(which, "alloc") )
+		{
+			BenchAllocs();
+		}
+		if ( 0 == strcmp(which, "all") || 0 == strcmp(which, "ptr") )
+		{
+			BenchPtrs();
+		}
+		if ( 0 == strcmp(which, "all") || 0 == strcmp(which, "hash") )
+		{
+			BenchHashtable();
+		}
+		if ( 0 == strcmp(which, "all") || 0 == strcmp(which, "variant") )
+		{
+			BenchVariants();
+		}
+		if ( 0 == strcmp(which, "all") || 0 == strcmp(which, "column") )
+		{
+			BenchColumns();
+		}
+		if ( 0 == strcmp(which, "all") || 0 == strcmp(which, "csv") )
+		{
+			BenchCsv();
+		}
+		if ( 0 == strcmp(which, "all") || 0 == strcmp(which, "fixed") )
+		{
+			BenchFixed();
+		}
+		if ( 0 == strcmp(which, "all") || 0 == strcmp(which, "packet") )
+		{
+			BenchPacket();
+		}
+		if ( 0 == strcmp(which, "all") || 0 == strcmp(which, "cork") )
+		{
+			BenchCork();
+		}
+		if ( 0 == strcmp(which, "all") || 0 == strcmp(which, "frame") )
+		{
+			BenchFrames();
+		}
+	}
+	catch ( Exception *ex )
+	{
+		printf("%s\n", ex->Message());
+		delete ex;
+		return 20;
+	}
+	return 0;
+}
@@ -20,7 +20,7 @@
 #include <spl/IConvertable.h>
 #include <spl/Null.h>
 #include <spl/Undefined.h>
-//#include <spl/interp/IJsObject.h>
+#include <spl/interp/IJsObject.h>
 
 namespace spl
 {
@@ -62,8 +62,8 @@ public:
 	inline static bool IsFloat(const DateTime& c) { return false; }
 	inline static bool IsFloat(const Date& c) { return false; }
 	inline static bool IsFloat(const String& c) { return false; }
-	//inline static bool IsFloat(const IJsObject& c) { return false; }
-	//inline static bool IsFloat(const IJsObject* c) { return false; }
+	inline static bool IsFloat(const IJsObject& c) { return false; }
+	inline static bool IsFloat(const IJsObject* c) { return false; }
 
 	inline static bool IsInt(const Null& c) { return false; }
 	inline static bool IsInt(const Null *c) { return false; }
@@ -86,8 +86,8 @@ public:
 	inline static bool IsInt(const DateTime& c) { return false; }
 	inline static bool IsInt(const Date& c) { return false; }
 	inline static bool IsInt(const String& c) { return false; }
-	//nline static bool IsInt(const IJsObject& c) { return false; }
-	//inline static bool IsInt(const IJsObject* c) { return false; }
+	inline static bool IsInt(const IJsObject& c) { return false; }
+	inline static bool IsInt(const IJsObject* c) { return false; }
 
 	inline static bool IsObject(const Null& c) { return false; }
 	inline static bool IsObject(const Null *c) { return false; }
@@ -110,8 +110,8 @@ public:
 	inline static bool IsObject(const DateTime& c) { return false; }
 	inline static bool IsObject(const Date& c) { return false; }
 	inline static bool IsObject(const String& c) { return false; }
-	//inline static bool IsObject(const IJsObject& c) { return true; }
-	//inline static bool IsObject(const IJsObject* c) { return true; }
+	inline static bool IsObject(const IJsObject& c) { return true; }
+	inline static bool IsObject(const IJsObject* c) { return true; }
 
 	inline static bool CanConvertToFloat(const Null& c) { return false; }
 	inline static bool CanConvertToFloat(const Null *c) { return false; }
@@ -134,8 +134,8 @@ public:
 	inline static bool CanConvertToFloat(const DateTime& c) { return false; }
 	inline static bool CanConvertToFloat(const Date& c) { return false; }
 	inline static bool CanConvertToFloat(const String& c) { return false; }
-	//inline static bool CanConvertToFloat(const IJsObject& c) { return false; }
-	//inline static bool CanConvertToFloat(const IJsObject* c) { return false; }
+	inline static bool CanConvertToFloat(const IJsObject& c) { return false; }
+	inline static bool CanConvertToFloat(const IJsObject* c) { return false; }
 
 	inline static bool CanConvertToInt(const Null& c) { return false; }
 	inline static bool CanConvertToInt(const Null *c) { return false; }
@@ -158,8 +158,8 @@ public:
 	inline static bool CanConvertToInt(const DateTime& c) { return false; }
 	inline static bool CanConvertToInt(const Date& c) { return false; }
 	inline static bool CanConvertToInt(const String& c) { return false; }
-	//inline static bool CanConvertToInt(const IJsObject& c) { return false; }
-	//inline static bool CanConvertToInt(const IJsObject* c) { return false; }
+	inline static bool CanConvertToInt(const IJsObject& c) { return false; }
+	inline static bool CanConvertToInt(const IJsObject* c) { return false; }
 
 	inline static bool ToChar(const Null& c, char& c2) { c2 = 0; return true; }
 	inline static bool ToChar(const Null *c, char& c2) { c2 = 0; return true; }
@@ -182,8 +182,8 @@ public:
 	inline static bool ToChar(const Date& c, char& c2) { return false; }
 	inline static bool ToChar(const String& c, char& c2) { c2 = c.Length() == 0 ? '\0' : c.CharAt(0); return true; }
 	inline static bool ToChar(const Decimal& c, char& c2) { return false; }
-	//inline static bool ToChar(const IJsObject& c, char& c2) { return false; }
-	//inline static bool ToChar(const IJsObject* c, char& c2) { return false; }
+	inline static bool ToChar(const IJsObject& c, char& c2) { return false; }
+	inline static bool ToChar(const IJsObject* c, char& c2) { return false; }
 
 	inline static bool ToBool(const Null& c, bool& c2) { c2 = false; return true; }
 	inline static bool ToBool(const Null *c, bool& c2) { c2 = false; return true; }
@@ -206,8 +206,8 @@ public:
 	inline static bool ToBool(const Date& c, bool& c2) { return false; }
 	inline static bool ToBool(const String& c, bool& b) { b = c.EqualsIgnoreCase("true"); return true; }
 	inline static bool ToBool(const Decimal& c, bool& c2) { return false; }
-	//inline static bool ToBool(const IJsObject& c, bool& c2) { c2 = true; return true; }
-	//inline static bool ToBool(const IJsObject* c, bool& c2) { c2 = true; return true; }
+	inline static bool ToBool(const IJsObject& c, bool& c2) { c2 = true; return true; }
+	inline static bool ToBool(const IJsObject* c, bool& c2) { c2 = true; return true; }
 
 	inline static bool ToByte(const Null& c, byte& c2) { c2 = 0; return true; }
 	inline static bool ToByte(const Null *c, byte& c2) { c2 = 0; return true; }
@@ -238,8 +238,8 @@ public:
 		return false;
 	}
 	inline static bool ToByte(const Decimal& c, byte& c2) { return false; }
-//	inline static bool ToByte(const IJsObject& c, byte& c2) { return false; }
-//	inline static bool ToByte(const IJsObject* c, byte& c2) { return false; }
+	inline static bool ToByte(const IJsObject& c, byte& c2) { return false; }
+	inline static bool ToByte(const IJsObject* c, byte& c2) { return false; }
 
 	inline static bool ToInt16(const Null& c, int16& c2) { c2 = 0; return true; }
 	inline static bool ToInt16(const Null *c, int16& c2) { c2 = 0; return true; }
@@ -270,8 +270,8 @@ public:
 		return false;
 	}
 	inline static bool ToInt16(const Decimal& c, int16& c2) { c2 = (int16)c.ToInt(); return true; }
-//	inline static bool ToInt16(const IJsObject& c, int16& c2) { return false; }
-//	inline static bool ToInt16(const IJsObject* c, int16& c2) { return false; }
+	inline static bool ToInt16(const IJsObject& c, int16& c2) { return false; }
+	inline static bool ToInt16(const IJsObject* c, int16& c2) { return false; }
 
 	inline static bool ToInt32(const Null& c, int32& c2) { c2 = 0; return true; }
 	inline static bool Toint32(const Null *c, int32& c2) { c2 = 0; return true; }
@@ -302,8 +302,8 @@ public:
 		return false;
 	}
 	inline static bool ToInt32(const Decimal& c, int32& c2) { c2 = c.ToInt(); return true; }
-//	inline static bool ToInt32(const IJsObject& c, int32& c2) { return false; }
-//	inline static bool ToInt32(const IJsObject* c, int32& c2) { return false; }
+	inline static bool ToInt32(const IJsObject& c, int32& c2) { return false; }
+	inline static bool ToInt32(const IJsObject* c, int32& c2) { return false; }
 
 	inline static bool ToInt64(const Null& c, int64& c2) { c2 = 0; return true; }
 	inline static bool ToInt64(const Null *c, int64& c2) { c2 = 0; return true; }
@@ -334,8 +334,8 @@ public:
 		return false;
 	}
 	inline static bool ToInt64(const Decimal& c, int64& c2) { c2 = c.ToInt(); return true; }
-//	inline static bool ToInt64(const IJsObject& c, int64& c2) { return false; }
-//	inline static bool ToInt64(const IJsObject* c, int64& c2) { return false; }
+	inline static bool ToInt64(const IJsObject& c, int64& c2) { return false; }
+	inline static bool ToInt64(const IJsObject* c, int64& c2) { return false; }
 
 	inline static bool ToUInt32(const Null& c, uint32& c2) { c2 = 0; return true; }
 	inline static bool ToUInt32(const Null *c, uint32& c2) { c2 = 0; return true; }
@@ -366,8 +366,8 @@ public:
 		return false;
 	}
 	inline static bool ToUInt32(const Decimal& c, uint32& c2) { c2 = c.ToInt(); return true; }
-//	inline static bool ToUInt32(const IJsObject& c, uint32& c2) { return false; }
-//	inline static bool ToUInt32(const IJsObject* c, uint32& c2) { return false; }
+	inline static bool ToUInt32(const IJsObject& c, uint32& c2) { return false; }
+	inline static bool ToUInt32(const IJsObject* c, uint32& c2) { return false; }
 
 	inline static bool ToUInt64(const Null& c, uint64& c2) { c2 = 0; return true; }
 	inline static bool ToUInt64(const Null *c, uint64& c2) { c2 = 0; return true; }
@@ -398,8 +398,8 @@ public:
 		return false;
 	}
 	inline static bool ToUInt64(const Decimal& c, uint64& c2) { c2 = c.ToInt(); return true; }
-//	inline static bool ToUInt64(const IJsObject& c, uint64& c2) { return false; }
-//	inline static bool ToUInt64(const IJsObject* c, uint64& c2) { return false; }
+	inline static bool ToUInt64(const IJsObject& c, uint64& c2) { return false; }
+	inline static bool ToUInt64(const IJsObject* c, uint64& c2) { return false; }
 
 	//inline static bool ToBigInteger(const Null& c, BigInteger& c2) { c2 = 0; return true; }
 	//inline static bool ToBigInteger(const Null *c, BigInteger& c2) { c2 = 0; return true; }
@@ -461,8 +461,8 @@ public:
 		return false;
 	}
 	inline static bool ToFloat32(const Decimal& c, float32& c2) { c2 = (float32)c.ToDouble(); return true; }
-//	inline static bool ToFloat32(const IJsObject& c, float32& c2) { return false; }
-//	inline static bool ToFloat32(const IJsObject* c, float32& c2) { return false; }
+	inline static bool ToFloat32(const IJsObject& c, float32& c2) { return false; }
+	inline static bool ToFloat32(const IJsObject* c, float32& c2) { return false; }
 
 	inline static bool ToFloat64(const Null& c, float64& c2) { c2 = 0; return true; }
 	inline static bool ToFloat64(const Null *c, float64& c2) { c2 = 0; return true; }
@@ -493,8 +493,8 @@ public:
 		return false;
 	}
 	inline static bool ToFloat64(const Decimal& c, float64& c2) { c2 = c.ToDouble(); return true; }
-//	inline static bool ToFloat64(const IJsObject& c, float64& c2) { return false; }
-//	inline static bool ToFloat64(const IJsObject* c, float64& c2) { return false; }
+	inline static bool ToFloat64(const IJsObject& c, float64& c2) { return false; }
+	inline static bool ToFloat64(const IJsObject* c, float64& c2) { return false; }
 
 	inline static bool ToDateTime(const Null& c, DateTime& c2) { return false; }
 	inline static bool ToDateTime(const Null *c, DateTime& c2) { return false; }
@@ -525,8 +525,8 @@ public:
 		return false;
 	}
 	inline static bool ToDateTime(const Decimal& c, DateTime& c2) { return false; }
-//	inline static bool ToDateTime(const IJsObject& c, DateTime& c2) { return false; }
-//	inline static bool ToDateTime(const IJsObject* c, DateTime& c2) { return false; }
+	inline static bool ToDateTime(const IJsObject& c, DateTime& c2) { return false; }
+	inline static bool ToDateTime(const IJsObject* c, DateTime& c2) { return false; }
 
 	inline static bool ToDate(const Null& c, Date& c2) { return false; }
 	inline static bool ToDate(const Null *c, Date& c2) { return false; }
@@ -557,8 +557,8 @@ public:
 		return false;
 	}
 	inline static bool ToDate(const Decimal& c, Date& c2) { return false; }
-//	inline static bool ToDate(const IJsObject& c, Date& c2) { return false; }
-//	inline static bool ToDate(const IJsObject* c, Date& c2) { return false; }
+	inline static bool ToDate(const IJsObject& c, Date& c2) { return false; }
+	inline static bool ToDate(const IJsObject* c, Date& c2) { return false; }
 
 	inline static bool ToDecimal(const Null& c, Decimal& c2) { c2 = 0; return true; }
 	inline static bool ToDecimal(const Null *c, Decimal& c2) { c2 = 0; return true; }
@@ -589,8 +589,8 @@ public:
 		return false;
 	}
 	inline static bool ToDecimal(const Decimal& c, Decimal& c2) { c2 = c; return true; }
-//	inline static bool ToDecimal(const IJsObject& c, Decimal& c2) { return false; }
-//	inline static bool ToDecimal(const IJsObject* c, Decimal& c2) { return false; }
+	inline static bool ToDecimal(const IJsObject& c, Decimal& c2) { return false; }
+	inline static bool ToDecimal(const IJsObject* c, Decimal& c2) { return false; }
 
 	inline static bool ToString(const Null& c, String& c2) { c2 = "null"; return true; }
 	inline static bool ToString(const Null *c, String& c2) { c2 = "null"; return true; }
@@ -613,8 +613,8 @@ public:
 	inline static bool ToString(const Date& c, String& c2) { c2 = *c.ToString(); return true; }
 	inline static bool ToString(const String& c, String& c2) { c2 = c; return true; }
 	inline static bool ToString(const Decimal& c, String& c2) { c2 = *c.ToString(); return true; }
-//	inline static bool ToString(const IJsObject& c, String& c2) { c2 = *c.ToString(); return true; }
-//	inline static bool ToString(const IJsObject* c, String& c2) { c2 = *c->ToString(); return true; }
+	inline static bool ToString(const IJsObject& c, String& c2) { c2 = *c.ToString(); return true; }
+	inline static bool ToString(const IJsObject* c, String& c2) { c2 = *c->ToString(); return true; }
 
 //	inline static bool ToObject(const Null& c, IJsObject& c2) { return false; }
 //	inline static bool ToObject(const Null *c, IJsObject& c2) { return false; }
@@ -661,14 +661,14 @@ public:
 	inline static String TypeName(const Date& c) { return String("Date"); }
 	inline static String TypeName(const String& c) { return String("String"); }
 	inline static String TypeName(const Decimal& c) { return String("Decimal"); }
-//	inline static String TypeName(const IJsObject& c) 
-//	{
-//		return *c.TypeName();
-//	}
-//	inline static String TypeName(const IJsObject* c) 
-//	{
-//		return TypeName(*c);
-//	}
+	inline static String TypeName(const IJsObject& c) 
+	{
+		return *c.TypeName();
+	}
+	inline static String TypeName(const IJsObject* c) 
+	{
+		return TypeName(*c);
+	}
 };
 
 /** @} */
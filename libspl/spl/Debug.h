@@ -80,6 +80,10 @@ void _debugValidateHeap();
 //void _debugUnlockHeap();
 void _debugFreeHeap();
 void _debugEnableHeapLocking();
+void _debugSetSampleRate( const int n );
+int _debugAllocSiteCount( const char *filename, const int lineno );
+void _debugDumpAllocSites( const int top );
+void _debugDumpLeakSites( const int top );
 
 #define malloc(size) _debugMalloc(size, __FILE__, __LINE__, false)
 #define free(ptr) _debugFree(ptr)
@@ -104,6 +108,9 @@ void realfree(void *vp);
 //#define DEBUG_UNLOCK_HEAP() _debugUnlockHeap()
 #define DEBUG_FREE_HEAP() _debugFreeHeap()
 #define DEBUG_ENABLE_HEAP_LOCK() _debugEnableHeapLocking()
+#define DEBUG_SET_SAMPLE_RATE(n) _debugSetSampleRate(n)
+#define DEBUG_DUMP_ALLOC_SITES(top) _debugDumpAllocSites(top)
+#define DEBUG_DUMP_LEAK_SITES(top) _debugDumpLeakSites(top)
 
 #ifdef DEBUG2
 #define DEBUG_VALIDATE() _debugValidateHeap()
@@ -157,6 +164,9 @@ void *rpl_malloc( const int size );
 #define UNIT_ASSERT_MEM_NOTED(msg) 
 #define UNIT_ASSERT_CHECK_POINT(msg)
 #define DEBUG_ENABLE_HEAP_LOCK()
+#define DEBUG_SET_SAMPLE_RATE(n)
+#define DEBUG_DUMP_ALLOC_SITES(top)
+#define DEBUG_DUMP_LEAK_SITES(top)
 
 #define DEBUG_VALIDATE()
 //#define DEBUG_LOCK_HEAP()
@@ -215,14 +225,41 @@ public:
 		DEBUG_FREE_HEAP();
 	}
 
-	/** @brief Enable heap locking with HeapLock() and HeapUnlock. 
-	 *	This may help with some multi threaded scenerios, but deadlocks in memory and pointer checks are still possible.
+	/** @brief Lock the debug heap for use from several threads; Thread calls this.
+	 *	Blocks are split into stripes by address, each with its own lock, so
+	 *	allocations on different threads rarely wait on each other.
 	 */
 	inline static void EnableHeapLocking()
 	{
 		DEBUG_ENABLE_HEAP_LOCK();
 	}
 
+	/** @brief Track only one in n allocations, so a debug build can run under
+	 *	real load.  Skipped blocks still have their guard bytes checked when
+	 *	freed, but leak checks and reports only see the tracked ones.  The
+	 *	SPL_DEBUG_HEAP_SAMPLE environment variable sets the rate at startup.
+	 */
+	inline static void SetSampleRate(int n)
+	{
+		DEBUG_SET_SAMPLE_RATE(n);
+	}
+
+	/** @brief printf the top call sites by number of tracked allocations, with their live blocks. 
+	 *	@ref SetSampleRate
+	 */
+	inline static void PrintAllocSites(int top)
+	{
+		DEBUG_DUMP_ALLOC_SITES(top);
+	}
+
+	/** @brief printf the call sites of blocks not marked with NoteMem, largest first.
+	 *	@ref PrintMemoryLeaks
+	 */
+	inline static void PrintLeakSites(int top)
+	{
+		DEBUG_DUMP_LEAK_SITES(top);
+	}
+
 	/** @brief Lock the debug heap mutex.
 	 *	@ref Mutex
 	 *	@ref EnableHeapLocking
@@ -0,0 +1,330 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _intrusiveptr_h
+#define _intrusiveptr_h
+
+#include <spl/types.h>
+#include <spl/Debug.h>
+#include <spl/Exception.h>
+#include <spl/Memory.h>
+
+#ifdef _WINDOWS
+#include <spl/cleanwindows.h>
+#endif
+
+namespace spl
+{
+	/**
+	 * @defgroup smrtptr Smart Pointers
+	 * @ingroup core
+	 * @{
+	 */
+
+#if !defined(_WINDOWS) && !defined(HAVE_ATOMIC_BUILTINS)
+	/** @brief Private, for internal use; locked fallback for platforms without atomics. */
+	int32 _IntrusiveAdd(volatile int32 *count, int32 delta);
+#endif
+
+	/** @brief Private, for internal use.  The reference count at the front of an IntrusivePtr allocation. */
+	class _IntrusiveCount
+	{
+	private:
+		inline _IntrusiveCount(const _IntrusiveCount&) {}
+		inline void operator =(const _IntrusiveCount&) {}
+
+	public:
+		volatile int32 m_count;
+
+		inline _IntrusiveCount()
+		: m_count(1)
+		{
+		}
+
+		/// Only called when the last reference goes away, never per Inc or Dec.
+		virtual ~_IntrusiveCount()
+		{
+		}
+
+		inline void Inc()
+		{
+#if defined(_WINDOWS)
+			InterlockedIncrement((volatile LONG *)&m_count);
+#elif defined(HAVE_ATOMIC_BUILTINS)
+			__sync_fetch_and_add(&m_count, 1);
+#else
+			_IntrusiveAdd(&m_count, 1);
+#endif
+		}
+
+		/// @return The count after the decrement.
+		inline int32 Dec()
+		{
+#if defined(_WINDOWS)
+			return InterlockedDecrement((volatile LONG *)&m_count);
+#elif defined(HAVE_ATOMIC_BUILTINS)
+			return __sync_fetch_and_sub(&m_count, 1) - 1;
+#else
+			return _IntrusiveAdd(&m_count, -1);
+#endif
+		}
+	};
+
+	/** @brief Private, for internal use.  The count and the object in one block. */
+	template<class T>
+	class _IntrusiveHolder : public _IntrusiveCount
+	{
+	public:
+		T m_obj;
+
+		inline _IntrusiveHolder() : _IntrusiveCount(), m_obj() {}
+
+		template<class A1>
+		inline _IntrusiveHolder(const A1& a1) : _IntrusiveCount(), m_obj(a1) {}
+
+		template<class A1, class A2>
+		inline _IntrusiveHolder(const A1& a1, const A2& a2) : _IntrusiveCount(), m_obj(a1, a2) {}
+
+		template<class A1, class A2, class A3>
+		inline _IntrusiveHolder(const A1& a1, const A2& a2, const A3& a3) : _IntrusiveCount(), m_obj(a1, a2, a3) {}
+
+		template<class A1, class A2, class A3, class A4>
+		inline _IntrusiveHolder(const A1& a1, const A2& a2, const A3& a3, const A4& a4) : _IntrusiveCount(), m_obj(a1, a2, a3, a4) {}
+	};
+
+	/** @brief A thread safe reference counted pointer that costs one allocation.
+	 *	Unlike RefCountPtr, the count is kept in the same block as the object,
+	 *	so IntrusivePtr<T>::New makes both with one new, and copies only do an
+	 *	atomic add on the count; there is no separate holder and no virtual
+	 *	call until the object is deleted.  Objects must be made with New; an
+	 *	IntrusivePtr can't adopt a pointer from elsewhere.
+	 *	An IntrusivePtr<Derived> converts to an IntrusivePtr<Base>.
+	 */
+	template<class T>
+	class IntrusivePtr
+	{
+	private:
+		template<class U> friend class IntrusivePtr;
+
+		_IntrusiveCount *m_holder;
+		T *m_ptr;
+
+		inline IntrusivePtr(_IntrusiveCount *holder, T *ptr)
+		: m_holder(holder), m_ptr(ptr)
+		{
+		}
+
+		template<class U>
+		inline static IntrusivePtr<T> Adopt(_IntrusiveHolder<U> *holder)
+		{
+			return IntrusivePtr<T>(holder, &holder->m_obj);
+		}
+
+	public:
+		typedef T element_type;
+
+		inline IntrusivePtr()
+		: m_holder(NULL), m_ptr(NULL)
+		{
+		}
+
+		inline IntrusivePtr(const IntrusivePtr<T>& rhs)
+		: m_holder(rhs.m_holder), m_ptr(rhs.m_ptr)
+		{
+			if (NULL != m_holder)
+			{
+				m_holder->Inc();
+			}
+		}
+
+		template<class U>
+		inline IntrusivePtr(const IntrusivePtr<U>& rhs)
+		: m_holder(rhs.m_holder), m_ptr(rhs.m_ptr)
+		{
+			if (NULL != m_holder)
+			{
+				m_holder->Inc();
+			}
+		}
+
+		inline ~IntrusivePtr()
+		{
+			Release();
+		}
+
+		inline IntrusivePtr<T>& operator =(const IntrusivePtr<T>& rhs)
+		{
+			// Inc first and copy rhs before releasing, rhs may be this.
+			_IntrusiveCount *holder = rhs.m_holder;
+			T *ptr = rhs.m_ptr;
+			if (NULL != holder)
+			{
+				holder->Inc();
+			}
+			Release();
+			m_holder = holder;
+			m_ptr = ptr;
+			return *this;
+		}
+
+		inline static IntrusivePtr<T> New()
+		{
+			return Adopt(new _IntrusiveHolder<T>());
+		}
+
+		template<class A1>
+		inline static IntrusivePtr<T> New(const A1& a1)
+		{
+			return Adopt(new _IntrusiveHolder<T>(a1));
+		}
+
+		template<class A1, class A2>
+		inline static IntrusivePtr<T> New(const A1& a1, const A2& a2)
+		{
+			return Adopt(new _IntrusiveHolder<T>(a1, a2));
+		}
+
+		template<class A1, class A2, class A3>
+		inline static IntrusivePtr<T> New(const A1& a1, const A2& a2, const A3& a3)
+		{
+			return Adopt(new _IntrusiveHolder<T>(a1, a2, a3));
+		}
+
+		template<class A1, class A2, class A3, class A4>
+		inline static IntrusivePtr<T> New(const A1& a1, const A2& a2, const A3& a3, const A4& a4)
+		{
+			return Adopt(new _IntrusiveHolder<T>(a1, a2, a3, a4));
+		}
+
+		/** @brief Like static_cast, for going from a base to a derived type. */
+		template<class U>
+		inline static IntrusivePtr<T> StaticCast(const IntrusivePtr<U>& rhs)
+		{
+			if (NULL == rhs.m_holder)
+			{
+				return IntrusivePtr<T>();
+			}
+			rhs.m_holder->Inc();
+			return IntrusivePtr<T>(rhs.m_holder, static_cast<T *>(rhs.m_ptr));
+		}
+
+		inline void Release()
+		{
+			if (NULL != m_holder)
+			{
+				ASSERT(m_holder->m_count > 0);
+				if (0 == m_holder->Dec())
+				{
+					delete m_holder;
+				}
+				m_holder = NULL;
+				m_ptr = NULL;
+			}
+		}
+
+		/// @brief Only exact when no other thread is copying or releasing this object.
+		inline int ReferenceCount() const
+		{
+			return NULL == m_holder ? 0 : m_holder->m_count;
+		}
+
+		inline bool IsNull() const
+		{
+			return NULL == m_ptr;
+		}
+
+		inline bool IsNotNull() const
+		{
+			return NULL != m_ptr;
+		}
+
+		inline T* Get() const
+		{
+			return m_ptr;
+		}
+
+		inline T& operator*() const
+		{
+			ASSERT(NULL != m_ptr);
+			return *m_ptr;
+		}
+
+		inline T* operator->() const
+		{
+			ASSERT(NULL != m_ptr);
+			return m_ptr;
+		}
+
+		inline operator T&() const
+		{
+			if (NULL == m_ptr)
+			{
+				throw new Exception("NULL pointer");
+			}
+			return *m_ptr;
+		}
+
+		inline bool operator ==(const IntrusivePtr<T>& rhs) const
+		{
+			return m_ptr == rhs.m_ptr;
+		}
+
+		inline bool operator !=(const IntrusivePtr<T>& rhs) const
+		{
+			return m_ptr != rhs.m_ptr;
+		}
+
+#if defined(DEBUG) || defined(_DEBUG)
+		void CheckMem() const
+		{
+			if (NULL != m_holder)
+			{
+				// The object is inside the holder's block, so only the holder is noted.
+				DEBUG_NOTE_MEM(m_holder);
+				TypeCheckMem(*m_ptr);
+			}
+		}
+
+		void ValidateMem() const
+		{
+			if (NULL != m_holder)
+			{
+				ASSERT_PTR(m_holder);
+				ASSERT(m_holder->m_count > 0);
+				TypeValidate(*m_ptr);
+			}
+		}
+#else
+		inline void CheckMem() const {}
+		inline void ValidateMem() const {}
+#endif
+	};
+
+	template<class T>
+	inline void TypeValidate( const IntrusivePtr<T>& p )
+	{
+		p.ValidateMem();
+	}
+
+	template<class T>
+	inline void TypeCheckMem( const IntrusivePtr<T>& p )
+	{
+		p.CheckMem();
+	}
+
+	/** @} */
+}
+#endif
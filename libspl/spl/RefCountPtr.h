@@ -22,6 +22,7 @@
 #include <spl/Exception.h>
 #include <spl/threading/InterlockCounter.h>
 #include <spl/Memory.h>
+#include <spl/collection/SizeClassPool.h>
 
 namespace spl
 {
@@ -46,6 +47,20 @@ namespace spl
 		{
 		}
 
+#if !defined(DEBUG) && !defined(_DEBUG)
+		// One holder is made for every object put in a RefCountPtr.  Debug
+		// builds leave them on the debug heap so CheckMem can see them.
+		inline void *operator new(size_t size)
+		{
+			return SizeClassPool::Default().Malloc((int)size);
+		}
+
+		inline void operator delete(void *vp)
+		{
+			SizeClassPool::Default().Free(vp);
+		}
+#endif
+
 		virtual int Count()
 		{
 			return m_icount;
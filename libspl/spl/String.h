@@ -36,6 +36,7 @@ char *ltoa( long i, char *buf, const int buflen );
 #include <spl/collection/Array.h>
 #include <spl/Memory.h>
 #include <spl/RefCountPtr.h>
+#include <spl/StringView.h>
 #include <spl/collection/Vector.h>
 #include <spl/WeakReference.h>
 
@@ -49,6 +50,9 @@ namespace spl
 
 #define STRING_MAJIC 0x0001		//< Majic number for ASSERT's in Compare and Convert
 
+/// Strings shorter than this are kept inside the String object instead of on the heap.
+#define STRING_SSO_SIZE 16
+
 #ifdef StrCmp
 #undef StrCmp
 #endif
@@ -79,8 +83,22 @@ protected:
 	const char *m_cstr;
 	bool m_isintern;
 	int m_len;
+	char m_sso[STRING_SSO_SIZE];
 
 	void InitWith(const char *cp, const int offset, const int len);
+	void InitWith(const char *cp, const int len, const char *cp2, const int len2);
+
+	/// @brief Space for len characters and the null, in m_sso if it fits.
+	char *Alloc(const int len);
+
+	/// @brief Frees m_cstr if this String owns a heap copy.
+	inline void Release()
+	{
+		if ( !m_isintern && m_cstr != m_sso )
+		{
+			free((char *)m_cstr);
+		}
+	}
 
 public:
 	String();
@@ -110,6 +128,11 @@ public:
 		InitWith(cp, 0, (int)strlen(cp));
 	}
 
+	explicit inline String( const StringView& sv )
+	{
+		InitWith(sv.GetChars(), 0, sv.Length());
+	}
+
 	String( const String& str );
 
 	~String();
@@ -171,19 +194,31 @@ public:
 		return Compare(str) >= 0;
 	}
 
+	/// @brief A view of the whole string; valid until this String changes or is destroyed.
+	inline StringView View() const { return StringView(m_cstr, m_len); }
+	/// @brief Like Substring, without the copy.
+	inline StringView View( int start, int len ) const { return View().Substring(start, len); }
+
 	StringPtr Substring( int start, int len ) const;
 	inline StringPtr Substring( int start ) const { return Substring(start, m_len - start); }
 
 	StringPtr Cat( const String& cp, const int len ) const;
-	inline StringPtr Cat( const String& arg ) const { return Cat(arg.GetChars(), arg.Length()); }
+	inline StringPtr Cat( const String& arg ) const { return Cat(arg, arg.Length()); }
 
-	inline String operator +( const String& arg ) const { return *Cat(arg); }
+	inline String operator +( const String& arg ) const
+	{
+		String ret;
+		ret.InitWith(m_cstr, m_len, arg.m_cstr, arg.m_len);
+		return ret;
+	}
 
 	StringPtr Right( int len ) const;
 	StringPtr Left( int len ) const;
 	StringPtr Mid( int start, int stop ) const;
 
 	RefCountPtr<Vector<StringPtr> > Split( const String& cp ) const;
+	/// @brief Appends views of the pieces between delim to parts; nothing is copied.
+	inline int Split( const StringView& delim, Vector<StringView>& parts ) const { return View().Split(delim, parts); }
 	
 	StringPtr PadRight( char ch, int count );
 
@@ -203,6 +238,11 @@ public:
 		return spl::StrCmp( m_cstr, cp, (int)strlen(cp) );
 	}
 
+	inline int Compare( const StringView& sv ) const
+	{
+		return View().Compare(sv);
+	}
+
 	inline int CompareNoCase( const char *cp ) const
 	{
 		return spl::StrCmpNoCase( m_cstr, m_len, cp );
@@ -220,6 +260,11 @@ public:
 
 	int IndexOf( const String& cp, const int start ) const;
 
+	inline int IndexOf( const StringView& sv, const int start ) const
+	{
+		return View().IndexOf(sv, start);
+	}
+
 	inline int IndexOf( const char ch ) const
 	{
 		return IndexOf( ch, 0 );
@@ -241,8 +286,10 @@ public:
 
 	inline bool StartsWith( char ch ) { char buf[2]; buf[0] = ch; buf[1] = '\0'; return StartsWith(buf); }
 	bool StartsWith( const String& str ) const;
+	inline bool StartsWith( const StringView& sv ) const { return View().StartsWith(sv); }
 
 	bool EndsWith( const String& str ) const;
+	inline bool EndsWith( const StringView& sv ) const { return View().EndsWith(sv); }
 
 	inline bool EndsWith( char cp ) const
 	{
@@ -265,6 +312,16 @@ public:
 		return 0 == spl::StrCmp(m_cstr, cp.m_cstr, m_len);
 	}
 
+	inline bool Equals( const char *cp ) const
+	{
+		return 0 == strcmp(m_cstr, cp);
+	}
+
+	inline bool Equals( const StringView& sv ) const
+	{
+		return View().Equals(sv);
+	}
+
 	inline bool Equals( const char ch ) const
 	{
 		return 1 == m_len && ch == m_cstr[0];
@@ -361,6 +418,16 @@ inline bool operator ==(const char *cp, const String& str)
 	return str == cp;
 }
 
+inline StringView::StringView( const String& str )
+: m_cstr(str.GetChars()), m_len(str.Length())
+{
+}
+
+inline bool StringView::Equals( const String& str ) const
+{
+	return Equals(StringView(str));
+}
+
 REGISTER_TYPEOF( 570, String );
 REGISTER_TYPEOF( 588, Vector<String> );
 REGISTER_TYPEOF( 589, Array<String> );
@@ -0,0 +1,165 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _stringview_h
+#define _stringview_h
+
+#include <string.h>
+
+#include <spl/types.h>
+#include <spl/Debug.h>
+#include <spl/RefCountPtr.h>
+
+namespace spl
+{
+/**
+ * @defgroup types Types
+ * @ingroup core
+ * @{
+ */
+
+class String;
+class StringView;
+typedef RefCountPtr<String> StringPtr;
+
+template<typename T> class Vector;
+
+/** @brief A read only window on characters owned by someone else.
+ *	A StringView doesn't copy or free anything, so slicing one is free.  It
+ *	must not outlive the String or buffer it looks at, and its characters
+ *	are not null terminated.  Use ToString() to get a String.
+ */
+class StringView
+{
+protected:
+	const char *m_cstr;
+	int m_len;
+
+public:
+	inline StringView()
+	: m_cstr(""), m_len(0)
+	{
+	}
+
+	inline StringView( const char *cp, const int len )
+	: m_cstr(cp), m_len(len)
+	{
+	}
+
+	inline StringView( const char *cp, const int offset, const int len )
+	: m_cstr(&cp[offset]), m_len(len)
+	{
+	}
+
+	/// Explicit, so that calls passing a char * still pick the String overloads.
+	explicit inline StringView( const char *cp )
+	: m_cstr(cp), m_len((int)strlen(cp))
+	{
+	}
+
+	/// Defined in String.h.
+	inline StringView( const String& str );
+
+	inline StringView( const StringView& sv )
+	: m_cstr(sv.m_cstr), m_len(sv.m_len)
+	{
+	}
+
+	inline StringView& operator =( const StringView& sv )
+	{
+		m_cstr = sv.m_cstr;
+		m_len = sv.m_len;
+		return *this;
+	}
+
+	/// @brief The first character; not null terminated.
+	inline const char *GetChars() const { return m_cstr; }
+	inline int Length() const { return m_len; }
+	inline bool IsEmpty() const { return 0 == m_len; }
+
+	char CharAt( const int idx ) const;
+	inline char operator[] ( const int idx ) const { return CharAt(idx); }
+
+	StringView Substring( int start, int len ) const;
+	inline StringView Substring( int start ) const { return Substring(start, m_len - start); }
+	inline StringView Left( int len ) const { return Substring(0, len); }
+	inline StringView Right( int len ) const { return Substring(m_len - len, len); }
+
+	/// @brief Trims spaces and tabs from both ends.
+	StringView Trim() const;
+
+	int IndexOf( const char ch, const int start ) const;
+	inline int IndexOf( const char ch ) const { return IndexOf(ch, 0); }
+	int IndexOf( const StringView& str, const int start ) const;
+	inline int IndexOf( const StringView& str ) const { return IndexOf(str, 0); }
+	int LastIndexOf( const char ch ) const;
+
+	inline bool StartsWith( const StringView& str ) const
+	{
+		return str.m_len <= m_len && 0 == memcmp(m_cstr, str.m_cstr, str.m_len);
+	}
+
+	inline bool EndsWith( const StringView& str ) const
+	{
+		return str.m_len <= m_len && 0 == memcmp(&m_cstr[m_len - str.m_len], str.m_cstr, str.m_len);
+	}
+
+	inline bool Equals( const StringView& str ) const
+	{
+		return m_len == str.m_len && 0 == memcmp(m_cstr, str.m_cstr, m_len);
+	}
+
+	inline bool Equals( const char *cp ) const
+	{
+		return 0 == strncmp(m_cstr, cp, m_len) && '\0' == cp[m_len];
+	}
+
+	/// Defined in String.h.
+	inline bool Equals( const String& str ) const;
+
+	bool EqualsIgnoreCase( const StringView& str ) const;
+
+	/// @brief Lexical compare; a prefix sorts before the longer string.
+	int Compare( const StringView& str ) const;
+
+	inline bool operator ==( const StringView& str ) const { return Equals(str); }
+	inline bool operator !=( const StringView& str ) const { return !Equals(str); }
+	inline bool operator <( const StringView& str ) const { return Compare(str) < 0; }
+
+	/// @brief Same as String::HashCode for the same characters, so views can look up String keys.
+	uint32 HashCode() const;
+
+	/** @brief Appends the pieces between delim to parts, like String::Split.
+	 *  @return The number of pieces added.
+	 */
+	int Split( const StringView& delim, Vector<StringView>& parts ) const;
+
+	StringPtr ToString() const;
+};
+
+inline void TypeValidate( const StringView& sv )
+{
+}
+
+inline void TypeCheckMem( const StringView& sv )
+{
+}
+
+REGISTER_TYPEOF( 471, StringView );
+
+/** @} */
+}
+#endif
@@ -19,10 +19,27 @@
 
 #include <spl/Convert.h>
 #include <spl/IVariant.h>
-//#include <spl/interp/IJsObject.h>
+#include <spl/interp/IJsObject.h>
 #include <spl/Null.h>
 #include <spl/RefCountPtr.h>
 
+/** @brief Private, for internal use; tag for building a _VariantData inside a Variant.
+ *	The debug heap declares its own operator new, which conflicts with <new>,
+ *	so Variant has its own placement form.
+ */
+struct _VariantInline
+{
+};
+
+inline void *operator new(size_t size, void *buf, const _VariantInline&)
+{
+	return buf;
+}
+
+inline void operator delete(void *vp, void *buf, const _VariantInline&)
+{
+}
+
 namespace spl
 {
 /** 
@@ -67,21 +84,63 @@ public:
 
 	virtual IVariantData *Clone() = 0;
 	virtual IVariantData *Copy() = 0;
+	/// @brief Copies into buf if it fits in bufSize bytes, otherwise onto the heap.
+	virtual IVariantData *Copy(void *buf, int bufSize) = 0;
 	virtual void *Data() = 0;
 };
 
+/** @brief Private, for internal use; how _VariantData<T> stores a T.
+ *	Most types are stored as they are.  Date and DateTime are stored as a
+ *	number and rebuilt when read, so they fit in a Variant's inline buffer.
+ */
+template<typename T>
+struct _VariantStore
+{
+	typedef T Type;
+	typedef const T& Result;
+
+	inline static const T& Save(const T& val) { return val; }
+	inline static const T& Load(const T& val) { return val; }
+};
+
+template<>
+struct _VariantStore<Date>
+{
+	typedef int32 Type;
+	typedef Date Result;
+
+	inline static int32 Save(const Date& val) { return val.ToRevInt(); }
+	inline static Date Load(int32 val) { return Date(val / 10000, (val / 100) % 100, val % 100); }
+};
+
+template<>
+struct _VariantStore<DateTime>
+{
+	typedef int64 Type;
+	typedef DateTime Result;
+
+	inline static int64 Save(const DateTime& val) { return (int64)val.ToSysTime(); }
+	inline static DateTime Load(int64 val) { return DateTime((time_t)val); }
+};
+
 template<typename T>
 class _VariantData : public IVariantData
 {
 private:
-	T m_data;
+	typename _VariantStore<T>::Type m_data;
 
 public:
 	_VariantData()
 	{
 	}
 
-	_VariantData(T data)
+	_VariantData(const T& data)
+	: m_data(_VariantStore<T>::Save(data))
+	{
+	}
+
+	/// @brief Copies another _VariantData's stored form without rebuilding T.
+	_VariantData(const typename _VariantStore<T>::Type& data, const _VariantInline&)
 	: m_data(data)
 	{
 	}
@@ -103,48 +162,48 @@ public:
 
 	virtual bool Equals( const IComparable& a ) const
 	{
-		return Compare::Equals(a, m_data);
+		return Compare::Equals(a, Get());
 	}
 
 	virtual int Compare( const IComparable& a ) const
 	{
-		return static_cast<int>(Compare::Cmp(m_data, a));
+		return static_cast<int>(Compare::Cmp(Get(), a));
 	}
 
 	virtual int32 MajicNumber() const
 	{
-		return Compare::Majic(m_data);
+		return Compare::Majic(Get());
 		//return 911 + Compare::Majic(m_data);
 	}
 
 	virtual uint32 HashCode() const
 	{
-		return Math::Hash(m_data);
+		return Math::Hash(Get());
 	}
 
 	virtual bool ToChar(char& c2) const
 	{
-		return Convert::ToChar(m_data, c2);
+		return Convert::ToChar(Get(), c2);
 	}
 
 	virtual bool ToBool(bool& c2) const
 	{
-		return Convert::ToBool(m_data, c2);
+		return Convert::ToBool(Get(), c2);
 	}
 
 	virtual bool ToByte(byte& c2) const
 	{
-		return Convert::ToByte(m_data, c2);
+		return Convert::ToByte(Get(), c2);
 	}
 
 	virtual bool ToInt16(int16& c2) const
 	{
-		return Convert::ToInt16(m_data, c2);
+		return Convert::ToInt16(Get(), c2);
 	}
 
 	virtual bool ToInt32(int32& c2) const
 	{
-		return Convert::ToInt32(m_data, c2);
+		return Convert::ToInt32(Get(), c2);
 	}
 
 	inline int32 ToInt32() const
@@ -157,17 +216,17 @@ public:
 
 	virtual bool ToInt64(int64& c2) const
 	{
-		return Convert::ToInt64(m_data, c2);
+		return Convert::ToInt64(Get(), c2);
 	}
 
 	virtual bool ToUInt32(uint32& c2) const
 	{
-		return Convert::ToUInt32(m_data, c2);
+		return Convert::ToUInt32(Get(), c2);
 	}
 
 	virtual bool ToUInt64(uint64& c2) const
 	{
-		return Convert::ToUInt64(m_data, c2);
+		return Convert::ToUInt64(Get(), c2);
 	}
 
 	//virtual bool ToBigInteger(const BigInteger& c2) const
@@ -176,32 +235,32 @@ public:
 
 	virtual bool ToFloat32(float32& c2) const
 	{
-		return Convert::ToFloat32(m_data, c2);
+		return Convert::ToFloat32(Get(), c2);
 	}
 
 	virtual bool ToFloat64(float64& c2) const
 	{
-		return Convert::ToFloat64(m_data, c2);
+		return Convert::ToFloat64(Get(), c2);
 	}
 
 	virtual bool ToDateTime(DateTime& c2) const
 	{
-		return Convert::ToDateTime(m_data, c2);
+		return Convert::ToDateTime(Get(), c2);
 	}
 
 	virtual bool ToDate(Date& c2) const
 	{
-		return Convert::ToDate(m_data, c2);
+		return Convert::ToDate(Get(), c2);
 	}
 
 	virtual bool ToDecimal(Decimal& c2) const
 	{
-		return Convert::ToDecimal(m_data, c2);
+		return Convert::ToDecimal(Get(), c2);
 	}
 
 	virtual bool ToString(String& c2) const
 	{
-		return Convert::ToString(m_data, c2);
+		return Convert::ToString(Get(), c2);
 	}
 
 	//virtual bool ToObject(IJsObject& c2) const
@@ -218,12 +277,12 @@ public:
 
 	virtual bool IsObject() const
 	{
-		return Convert::IsObject(m_data);
+		return Convert::IsObject(Get());
 	}
 
 	virtual String TypeName() const
 	{
-		return Convert::TypeName(m_data);
+		return Convert::TypeName(Get());
 	}
 
 	virtual IVariantData *Clone()
@@ -235,18 +294,27 @@ public:
 		//}
 		//else
 		//{
-			return new _VariantData<T>(m_data);
+			return new _VariantData<T>(m_data, _VariantInline());
 		//}
 	}
 	
 	virtual IVariantData *Copy()
 	{
-		return new _VariantData<T>(m_data);
+		return new _VariantData<T>(m_data, _VariantInline());
 	}
 
-	inline T Get()
+	virtual IVariantData *Copy(void *buf, int bufSize)
 	{
-		return m_data;
+		if ((int)sizeof(_VariantData<T>) <= bufSize)
+		{
+			return new (buf, _VariantInline()) _VariantData<T>(m_data, _VariantInline());
+		}
+		return new _VariantData<T>(m_data, _VariantInline());
+	}
+
+	inline typename _VariantStore<T>::Result Get() const
+	{
+		return _VariantStore<T>::Load(m_data);
 	}
 
 	inline T& GetRef()
@@ -261,7 +329,7 @@ public:
 
 	virtual bool IsFloat() const
 	{
-		return Convert::IsFloat(m_data);
+		return Convert::IsFloat(Get());
 	}
 
 #ifdef DEBUG
@@ -286,13 +354,48 @@ REGISTER_TYPEOF( 586, VariantRef );
 REGISTER_TYPEOF( 606, Array<VariantPtr> );
 REGISTER_TYPEOF( 610, Vector<VariantPtr> );
 
+/// Bytes inside each Variant for values that don't need the heap; room for a 64 bit scalar.
+#define VARIANT_INLINE_SIZE ((int)sizeof(_VariantData<int64>))
+
 /** @brief A variant type mostly for use in interpreters for variant languages.
- *
+ *	Numbers, bool, Date and DateTime are built in a buffer inside the
+ *	Variant, so setting or copying one doesn't allocate; Decimal, String
+ *	and objects go on the heap.  The type is also kept
+ *	as a tag, so arithmetic and comparisons on numbers don't go through the
+ *	virtual conversions.
  */
 class Variant : public IVariant
 {
+public:
+	/// The type of the value held.
+	enum VariantType
+	{
+		VAR_UNDEFINED,
+		VAR_NULL,
+		VAR_BOOL,
+		VAR_INT8,
+		VAR_INT16,
+		VAR_INT32,
+		VAR_INT64,
+		VAR_FLOAT32,
+		VAR_FLOAT64,
+		VAR_DATE,
+		VAR_DATETIME,
+		VAR_DECIMAL,
+		VAR_STRING,
+		VAR_OBJECT
+	};
+
 private:
 	IVariantData *m_data;
+	VariantType m_type;
+	union
+	{
+		char m_inline[VARIANT_INLINE_SIZE];
+		int64 m_alignInt;
+		float64 m_alignFloat;
+		void *m_alignPtr;
+	};
 
 	enum CompareOperator
 	{
@@ -302,7 +405,57 @@ private:
 	};
 
 	bool BinOp(const Variant& b, enum CompareOperator op) const;
-	Variant(IVariantData *m_data);
+
+	template<typename T>
+	inline void Store(const T& val, VariantType type)
+	{
+		m_type = type;
+		if ((int)sizeof(_VariantData<T>) <= VARIANT_INLINE_SIZE)
+		{
+			m_data = new (m_inline, _VariantInline()) _VariantData<T>(val);
+		}
+		else
+		{
+			m_data = new _VariantData<T>(val);
+		}
+	}
+
+	inline void StoreCopy(const Variant& v)
+	{
+		m_type = v.m_type;
+		m_data = v.m_data->Copy(m_inline, VARIANT_INLINE_SIZE);
+	}
+
+	inline bool IsInline() const
+	{
+		return (const void *)m_data == (const void *)m_inline;
+	}
+
+	inline void Free()
+	{
+		if (IsInline())
+		{
+			m_data->~IVariantData();
+		}
+		else
+		{
+			delete m_data;
+		}
+	}
+
+	template<typename T>
+	inline T& Value() const
+	{
+		return static_cast<_VariantData<T> *>(m_data)->GetRef();
+	}
+
+	inline bool IsNumber() const { return m_type >= VAR_INT8 && m_type <= VAR_FLOAT64; }
+	inline bool IsFloatNumber() const { return VAR_FLOAT32 == m_type || VAR_FLOAT64 == m_type; }
+	int64 NumberToInt64() const;
+	float64 NumberToFloat64() const;
+
+	/// @brief +, -, *, / or % on two numbers without a virtual call; int64 unless either is a float.
+	Variant NumberOp(const Variant& v, char op) const;
 	
 public:
 	Variant();
@@ -322,7 +475,7 @@ public:
 	Variant(const Variant& v);
 	Variant(const Undefined& v);
 	Variant(const Null& v);
-	//Variant(RefCountPtr<IJsObject> jso);
+	Variant(RefCountPtr<IJsObject> jso);
 	virtual ~Variant();
 
 	VariantPtr ToVarBool() const;
@@ -348,7 +501,7 @@ public:
 	virtual Date ToDate() const;
 	virtual Decimal ToDecimal() const;
 	virtual StringPtr ToString() const;
-	//virtual RefCountPtr<IJsObject> ToObject() const;
+	virtual RefCountPtr<IJsObject> ToObject() const;
 
 	virtual bool ToChar(char& c2) const;
 	virtual bool ToBool(bool& c2) const;
@@ -383,6 +536,11 @@ public:
 	{
 		return m_data->TypeName();
 	}
+
+	inline VariantType Type() const
+	{
+		return m_type;
+	}
 	
 	inline VariantPtr ToRValue()
 	{
@@ -391,8 +549,8 @@ public:
 
 	inline void Clear()
 	{
-		delete m_data;
-		m_data = new _VariantData<Undefined>(Undefined());
+		Free();
+		Store(Undefined(), VAR_UNDEFINED);
 	}
 
 	Variant& operator =(const Variant& v);
@@ -404,7 +562,7 @@ public:
 	Variant& operator =(const DateTime& s);
 	Variant& operator =(const Date& s);
 	Variant& operator =(const Decimal& s);
-	//Variant& operator =(RefCountPtr<IJsObject> s);
+	Variant& operator =(RefCountPtr<IJsObject> s);
 
 	bool operator ==(const Variant& v) const;
 	bool operator !=(const Variant& v) const;
@@ -430,11 +588,11 @@ public:
 	VariantPtr Comp() const;
 	VariantPtr Neg() const;
 
-	inline Variant operator +(const Variant& v) const { return *Add(v); }
-	inline Variant operator -(const Variant& v) const { return *Sub(v); }
-	inline Variant operator /(const Variant& v) const { return *Div(v); }
-	inline Variant operator *(const Variant& v) const { return *Mul(v); }
-	inline Variant operator %(const Variant& v) const { return *Mod(v); }
+	Variant operator +(const Variant& v) const;
+	Variant operator -(const Variant& v) const;
+	Variant operator /(const Variant& v) const;
+	Variant operator *(const Variant& v) const;
+	Variant operator %(const Variant& v) const;
 	inline Variant operator ^(const Variant& v) const { return *Exp(v); }
 	inline Variant operator <<(const Variant& v) const { return *ShiftLeft(v); }
 	inline Variant operator >>(const Variant& v) const { return *ShiftRigth(v); }
@@ -448,7 +606,7 @@ public:
 
 	VariantPtr Clone() const;
 
-	inline bool IsUndefined() const { return m_data->MajicNumber() == UNDEFINED_MAJIC; }
+	inline bool IsUndefined() const { return VAR_UNDEFINED == m_type; }
 
 #ifdef DEBUG
 	virtual void ValidateMem() const;
@@ -37,121 +37,215 @@ namespace spl
  * @{
  */
 
-/* For resizing the hashtable */
-extern const int __hashtableSizes[];
-
 /** @brief A key value map.
- *	Dynamically resizes based on a 75% fill factor.
- *	@todo Allow the user to specify the initial table size.
+ *	Items are kept in one array using open addressing with Robin Hood
+ *	probing: an item that is further from its home slot takes the place of
+ *	one that is closer, so probes stay short, and removes shift the
+ *	following items back instead of leaving tombstones.  Each slot keeps the
+ *	key's hash, so lookups compare hashes before keys and growing doesn't
+ *	hash the keys again.  The table doubles when it's 80% full.
+ *
+ *	References from GetRef, operator[] and Iterator::CurrentRef are good
+ *	until the next Set or Remove.
  */
 template<typename K, typename T>
 class Hashtable : public IEnumerable<T>
 {
 private:
-	class _Kthashitem : public IMemoryValidate
+	/// A slot.  dist is one more than the distance from the item's home slot, 0 if the slot is empty.
+	class _Kthashitem
 	{
 	public:
 		K key;
 		T data;
+		uint32 hash;
+		uint32 dist;
+
+		_Kthashitem() : key(), data(), hash(0), dist(0) {}
+	};
+
+	_Kthashitem *m_items;
+	int m_capacity;			//< Zero or a power of two.
+	int m_shift;			//< 32 - log2(m_capacity).
+	int m_count;
 
-		_Kthashitem() : key(), data() {}
-		_Kthashitem(const _Kthashitem& item) : key(item.key), data(item.data) {}
-		~_Kthashitem() {}
+	inline static uint32 HashOf( const K& key )
+	{
+		return (uint32)Math::Hash(key);
+	}
+
+	/// Fibonacci hashing, so keys that differ only in their high bits (or are multiples of the capacity) still spread.
+	inline int Home( uint32 hash ) const
+	{
+		return (int)((hash * 2654435769U) >> m_shift);
+	}
 
-	#if defined(DEBUG)
-		virtual void CheckMem() const
+	inline int FindIndex( const K& key, uint32 hash ) const
+	{
+		if ( 0 == m_count )
 		{
-			TypeCheckMem( key );
-			TypeCheckMem( data );
+			return -1;
 		}
-		virtual void ValidateMem() const
+		int mask = m_capacity - 1;
+		int idx = Home(hash);
+		for ( uint32 dist = 1; ; dist++ )
 		{
-			TypeValidate( key );
-			TypeValidate( data );
+			const _Kthashitem& item = m_items[idx];
+			if ( item.dist < dist )
+			{
+				// Empty, or an item that would have been put after this key.
+				return -1;
+			}
+			if ( item.hash == hash && Compare::Equals(item.key, key) )
+			{
+				return idx;
+			}
+			idx = (idx + 1) & mask;
 		}
-	#endif
-	};
-	
-	void Resize()
+	}
+
+	template<typename L>
+	inline int FindLike( const L& key, uint32 hash ) const
 	{
-		if (__hashtableSizes[m_tablesize+1] == -1)
+		if ( 0 == m_count )
 		{
-			return;
+			return -1;
+		}
+		int mask = m_capacity - 1;
+		int idx = Home(hash);
+		for ( uint32 dist = 1; ; dist++ )
+		{
+			const _Kthashitem& item = m_items[idx];
+			if ( item.dist < dist )
+			{
+				return -1;
+			}
+			if ( item.hash == hash && key.Equals(item.key) )
+			{
+				return idx;
+			}
+			idx = (idx + 1) & mask;
+		}
+	}
+
+	/// Puts an item that isn't in the table into it; there must be an empty slot.
+	void Insert( const K& key, const T& val, uint32 hash )
+	{
+		_Kthashitem carry;
+		carry.key = key;
+		carry.data = val;
+		carry.hash = hash;
+		carry.dist = 1;
+
+		int mask = m_capacity - 1;
+		int idx = Home(hash);
+		while ( true )
+		{
+			_Kthashitem& item = m_items[idx];
+			if ( 0 == item.dist )
+			{
+				item = carry;
+				m_count++;
+				return;
+			}
+			if ( item.dist < carry.dist )
+			{
+				_Kthashitem tmp(item);
+				item = carry;
+				carry = tmp;
+			}
+			carry.dist++;
+			idx = (idx + 1) & mask;
+		}
+	}
+
+	void Resize( int capacity )
+	{
+		ASSERT( capacity >= 8 && 0 == (capacity & (capacity - 1)) );
+
+		_Kthashitem *old = m_items;
+		int oldCapacity = m_capacity;
+
+		if ( NULL == (m_items = new _Kthashitem[capacity]) )
+		{
+			m_items = old;
+			throw OutOfMemoryException();
+		}
+		m_capacity = capacity;
+		m_shift = 32;
+		while ( capacity > 1 )
+		{
+			m_shift--;
+			capacity >>= 1;
 		}
-		m_tablesize++;
-		Vector<List<_Kthashitem *> *> vlold(m_valueLists);
-		m_valueLists.Clear();
-		m_valueLists = Vector<List<_Kthashitem *> *>(TableSize());
-		_Clear(m_valueLists);
 		m_count = 0;
-		
-		int x;
-		int count = vlold.Count();
-		for ( x = 0; x < count; x++ )
+
+		for ( int x = 0; x < oldCapacity; x++ )
 		{
-			List<_Kthashitem *> *list = vlold.ElementAt(x);
-			if ( list != NULL )
+			if ( 0 != old[x].dist )
 			{
-				typename List<_Kthashitem *>::Iterator iter = list->Begin();
-				while ( iter.Next() )
-				{
-					this->Set(iter.Current()->key, iter.Current()->data);
-				}
+				Insert( old[x].key, old[x].data, old[x].hash );
 			}
 		}
-		_Clear(vlold);
+		if ( NULL != old )
+		{
+			delete[] old;
+		}
 	}
 
-	inline void CheckForResize()
+	inline bool IsFull( int count ) const
 	{
-		if ((double)m_count / (double)TableSize() > 0.749)
+		return count * 5 > m_capacity * 4;
+	}
+
+	void CopyFrom( const Hashtable& ht )
+	{
+		ASSERT( NULL == m_items );
+		m_count = ht.m_count;
+		m_capacity = ht.m_capacity;
+		m_shift = ht.m_shift;
+		if ( 0 == m_capacity )
+		{
+			return;
+		}
+		if ( NULL == (m_items = new _Kthashitem[m_capacity]) )
+		{
+			throw OutOfMemoryException();
+		}
+		for ( int x = 0; x < m_capacity; x++ )
 		{
-			Resize();
+			m_items[x] = ht.m_items[x];
 		}
 	}
-		
-protected:
-	Vector<List<_Kthashitem *> *> m_valueLists;
-	int m_tablesize;
-	int m_count;
-	
+
 public:
 	class Iterator : public IIterator<T>
 	{
 	private:
-		const Vector<List<_Kthashitem *> *> *m_valueLists;
-		typename Vector<List<_Kthashitem *> *>::Iterator m_valueListsPos;
-		typename List<_Kthashitem *>::Iterator m_listPos;
+		const Hashtable<K, T> *m_table;
+		int m_pos;
 
 	public:
-		Iterator(const Vector<List<_Kthashitem *> *> *valueLists)
-		: m_valueLists(valueLists), m_valueListsPos(valueLists->Begin()), m_listPos()
+		Iterator(const Hashtable<K, T> *table)
+		: m_table(table), m_pos(-1)
 		{
 		}
 
 		Iterator(const Iterator& hki)
-		: m_valueLists(hki.m_valueLists), m_valueListsPos(hki.m_valueListsPos), m_listPos(hki.m_listPos)
+		: m_table(hki.m_table), m_pos(hki.m_pos)
 		{
 		}
 
 		virtual bool Next( )
 		{
-			if (m_listPos.Next())
-			{
-				return true;
-			}
-			while (m_valueListsPos.Next())
+			while ( ++m_pos < m_table->m_capacity )
 			{
-				if (NULL != m_valueListsPos.Current())
+				if ( 0 != m_table->m_items[m_pos].dist )
 				{
-					m_listPos = m_valueListsPos.Current()->Begin();
-					if (m_listPos.Next())
-					{
-						return true;
-					}
+					return true;
 				}
 			}
-
+			m_pos = m_table->m_capacity;
 			return false;
 		}
 
@@ -162,212 +256,158 @@ public:
 
 		virtual T Current()
 		{
-			return m_listPos.Current()->data;
+			return m_table->m_items[m_pos].data;
 		}
 
 		virtual T& CurrentRef()
 		{
-			return m_listPos.Current()->data;
+			return m_table->m_items[m_pos].data;
 		}
 
 		virtual K CurrentKey()
 		{
-			return m_listPos.Current()->key;
+			return m_table->m_items[m_pos].key;
 		}
 
 		virtual K& CurrentKeyRef()
 		{
-			return m_listPos.Current()->key;
+			return m_table->m_items[m_pos].key;
 		}
 	};
 
 protected:
-	inline List<_Kthashitem *> *FindList( const K& key ) const
+	virtual RefCountPtr<IIterator<T> > _Begin()
 	{
-		int hash = Math::Hash(key) % TableSize();
-		ASSERT( hash > -1 );
-		ASSERT( m_valueLists.Count() >  hash );
-		return m_valueLists.ElementAt( hash );
+		return RefCountPtr<IIterator<T> >(new Iterator(this));
 	}
-	
-	inline List<_Kthashitem *> *AddList( const K& key )
+
+public:
+	Hashtable(  )
+	: m_items(NULL), m_capacity(0), m_shift(32), m_count(0)
 	{
-		List<_Kthashitem *> *list = new List<_Kthashitem *>();
-		m_valueLists.SetElementAt( list, Math::Hash(key) % TableSize() );
-		return list;
 	}
-	
-	inline bool FindItem(typename List<_Kthashitem *>::Iterator& list, const K& key) const
+
+	/** @brief Sizes the table for count items. */
+	Hashtable( int count )
+	: m_items(NULL), m_capacity(0), m_shift(32), m_count(0)
 	{
-		while ( list.Next() )
-		{
-			if ( Compare::Equals(list.Current()->key, key) )
-			{
-				return true;
-			}
-		}
-		return false;
+		Reserve(count);
 	}
-	
-	virtual RefCountPtr<IIterator<T> > _Begin()
+
+	Hashtable( const Hashtable &ht )
+	: m_items(NULL), m_capacity(0), m_shift(32), m_count(0)
 	{
-		return RefCountPtr<IIterator<T> >(new Iterator(&m_valueLists));
+		CopyFrom(ht);
 	}
 
-	inline int TableSize() const
+	virtual ~Hashtable()
 	{
-		return __hashtableSizes[m_tablesize];
+		if ( NULL != m_items )
+		{
+			delete[] m_items;
+		}
 	}
-	
-	void _Clear(Vector<List<_Kthashitem *> *>& valueLists)
+
+	Hashtable<K, T>& operator =(const Hashtable<K, T>& ht)
 	{
-		int x;
-		int count = valueLists.Count();
-		for ( x = 0; x < count; x++ )
+		if ( this == &ht )
 		{
-			List<_Kthashitem *> *list = valueLists.ElementAt(x);
-			if ( list != NULL )
-			{
-				typename List<_Kthashitem *>::Iterator iter = list->Begin();
-				while ( iter.Next() )
-				{
-					delete iter.Current();
-				}
-				delete list;
-			}
+			return *this;
+		}
+		if ( NULL != m_items )
+		{
+			delete[] m_items;
+			m_items = NULL;
 		}
-		valueLists.Clear();
+		CopyFrom(ht);
+		return *this;
+	}
 
-		for ( x = 0; x < TableSize(); x++ )
+	/** @brief Grows the table so that count items can be added without it growing again. */
+	void Reserve( int count )
+	{
+		int capacity = (0 == m_capacity) ? 8 : m_capacity;
+		while ( count * 5 > capacity * 4 )
+		{
+			capacity *= 2;
+		}
+		if ( capacity > m_capacity )
 		{
-			valueLists.Add( NULL );
+			Resize( capacity );
 		}
 	}
 
-public:
-	Hashtable(  )
-	: m_count(0), m_tablesize(0), m_valueLists(__hashtableSizes[0])
+	inline bool ContainsKey( const K& key ) const
 	{
-		ASSERT(Math::IsPrime(TableSize()));
-		Clear();
+		return 0 <= FindIndex( key, HashOf(key) );
 	}
 
-	Hashtable( const Hashtable &ht )
-	: m_count(ht.m_count), m_tablesize(ht.m_tablesize), m_valueLists(__hashtableSizes[ht.m_tablesize])
+	/** @brief ContainsKey with a hash already computed by Math::Hash(key). */
+	inline bool ContainsKey( const K& key, const uint32 hash ) const
 	{
-		Clear();
-		
-		int count = ht.m_valueLists.Count();
-		for ( int x = 0; x < count; x++ )
-		{
-			List<_Kthashitem *> *list = ht.m_valueLists.ElementAt(x);
-			if ( list != NULL )
-			{
-				int lcount = list->Count();
-				for ( int y = 0; y < lcount; y++ )
-				{
-					_Kthashitem *item = list->ElementAt(y);
-					ASSERT_MEM( item, sizeof(_Kthashitem) );
-					Set( item->key, item->data );
-				}
-			}
-		}
+		return 0 <= FindIndex( key, hash );
 	}
 
-	virtual ~Hashtable()
+	T Get( const K& key ) const
 	{
-		int x;
-		int count = m_valueLists.Count();
-		for ( x = 0; x < count; x++ )
+		int idx = FindIndex( key, HashOf(key) );
+		if ( 0 > idx )
 		{
-			List<_Kthashitem *> *list = m_valueLists.ElementAt(x);
-			if ( list != NULL )
-			{
-				typename List<_Kthashitem *>::Iterator iter = list->Begin();
-				while ( iter.Next() )
-				{
-					delete iter.Current();
-				}
-				delete list;
-			}
+			return T();
 		}
+		return m_items[idx].data;
 	}
 
-	Hashtable<K, T>& operator =(const Hashtable<K, T>& ht)
+	/** @return false if the key isn't in the table. */
+	bool TryGet( const K& key, T& value ) const
 	{
-		int x;
-
-		Clear();
-
-		m_count = ht.m_count;
-
-		if ( m_tablesize != ht.m_tablesize )
+		int idx = FindIndex( key, HashOf(key) );
+		if ( 0 > idx )
 		{
-			m_tablesize = ht.m_tablesize;
-			m_valueLists.Clear();
-
-			for ( x = 0; x < TableSize(); x++ )
-			{
-				m_valueLists.Add( NULL );
-			}
+			return false;
 		}
+		value = m_items[idx].data;
+		return true;
+	}
 
-		for ( x = 0; x < TableSize(); x++ )
-		{
-			List<_Kthashitem *> *list = ht.m_valueLists.ElementAt(x);
-			if ( list != NULL )
-			{
-				int lcount = list->Count();
-				for ( int y = 0; y < lcount; y++ )
-				{
-					_Kthashitem *item = list->ElementAt(y);
-					ASSERT_MEM( item, sizeof(_Kthashitem) );
-					Set( item->key, item->data );
-				}
-			}
-		}
-		return *this;
+	/** @brief Looks up a key using a stand-in for K, such as a StringView for a String key.
+	 *	Math::Hash(key) must equal the hash of the matching K, and key.Equals(K)
+	 *	must compare them; no K is constructed.
+	 *	@return false if the key isn't in the table.
+	 */
+	template<typename L>
+	bool TryGet( const L& key, T& value ) const
+	{
+		return TryGet( key, (uint32)Math::Hash(key), value );
 	}
 
-	bool ContainsKey( const K& key ) const
+	/** @brief TryGet with a hash already computed by Math::Hash(key), for keys that are looked up many times. */
+	template<typename L>
+	bool TryGet( const L& key, const uint32 hash, T& value ) const
 	{
-		List<_Kthashitem *> *list = FindList( key );
-		if ( NULL == list )
+		int idx = FindLike( key, hash );
+		if ( 0 > idx )
 		{
 			return false;
 		}
-		typename List<_Kthashitem *>::Iterator iter = list->Begin();
-		return FindItem( iter, key );
+		value = m_items[idx].data;
+		return true;
 	}
-	
-	T Get( const K& key ) const
+
+	/** @brief TryGet for a String key given as a C string. */
+	inline bool TryGet( const char *key, T& value ) const
 	{
-		List<_Kthashitem *> *list = FindList( key );
-		if ( NULL == list )
-		{
-			return T();
-		}
-		typename List<_Kthashitem *>::Iterator iter = list->Begin();
-		if ( ! FindItem( iter, key ) )
-		{
-			return T();
-		}
-		return iter.Current()->data;
+		return TryGet( StringView(key), value );
 	}
-	
+
 	T& GetRef( const K& key ) const
 	{
-		List<_Kthashitem *> *list = FindList( key );
-		if ( NULL == list )
-		{
-			throw new IndexOutOfBoundsException("key not found");
-		}
-		typename List<_Kthashitem *>::Iterator iter = list->Begin();
-		if ( ! FindItem( iter, key ) )
+		int idx = FindIndex( key, HashOf(key) );
+		if ( 0 > idx )
 		{
 			throw new IndexOutOfBoundsException("key not found");
 		}
-		return iter.Current()->data;
+		return m_items[idx].data;
 	}
 	
 	inline T& operator[] (const K& key) const
@@ -377,74 +417,50 @@ public:
 
 	void Set( K key, T val )
 	{
-		List<_Kthashitem *> *list = FindList( key );
-		if ( NULL == list )
-		{
-			list = AddList( key );
-			m_count++;
-		}
-		else
+		uint32 hash = HashOf(key);
+		int idx = FindIndex( key, hash );
+		if ( 0 <= idx )
 		{
-			typename List<_Kthashitem *>::Iterator iter = list->Begin();
-			if ( FindItem( iter, key ) )
-			{
-				_Kthashitem *item = iter.Current();
-				list->RemoveCurrent(iter);
-				delete item;
-			}
-			else
-			{
-				m_count++;
-			}
+			m_items[idx].data = val;
+			return;
 		}
-		_Kthashitem *item = new _Kthashitem();
-		if ( NULL == item )
+		if ( 0 == m_capacity || IsFull(m_count + 1) )
 		{
-			throw OutOfMemoryException();
+			Resize( (0 == m_capacity) ? 8 : m_capacity * 2 );
 		}
-		item->key = key;
-		item->data = val;
-		list->Add( item );
-				
-		CheckForResize();
+		Insert( key, val, hash );
 	}
 
 	void Remove( const K& key )
 	{
-		List<_Kthashitem *> *list = FindList( key );
-		if ( NULL == list )
+		int idx = FindIndex( key, HashOf(key) );
+		if ( 0 > idx )
 		{
 			return;
 		}
-		typename List<_Kthashitem *>::Iterator iter = list->Begin();
-		if ( ! FindItem( iter, key ) )
+
+		// Shift the items after it back a slot, up to an empty slot or one already at home.
+		int mask = m_capacity - 1;
+		int next = (idx + 1) & mask;
+		while ( m_items[next].dist > 1 )
 		{
-			return;
+			m_items[idx] = m_items[next];
+			m_items[idx].dist--;
+			idx = next;
+			next = (next + 1) & mask;
 		}
-		_Kthashitem *item = iter.Current();
-		list->RemoveCurrent(iter);
-		delete item;
+		m_items[idx] = _Kthashitem();
 		m_count--;
 	}
 
 	RefCountPtr<Vector<K> > Keys() const
 	{
-		RefCountPtr<Vector<K> > vect(new Vector<K>());
-		int count = m_valueLists.Count();
-		for ( int x = 0; x < count; x++ )
+		RefCountPtr<Vector<K> > vect(new Vector<K>(m_count + 1));
+		for ( int x = 0; x < m_capacity; x++ )
 		{
-			List<_Kthashitem *> *list = m_valueLists.ElementAt(x);
-			if ( NULL == list )
+			if ( 0 != m_items[x].dist )
 			{
-				continue;
-			}
-			ASSERT_MEM(list, sizeof(List<_Kthashitem *>));
-			list->ValidateMem();
-
-			typename List<_Kthashitem *>::Iterator iter = list->Iterator();
-			while(iter.Next())
-			{
-				vect->Add(iter.Current()->key);
+				vect->Add(m_items[x].key);
 			}
 		}
 		ASSERT(m_count == vect->Count());
@@ -453,7 +469,7 @@ public:
 	
 	inline Iterator Begin() const
 	{
-		return Iterator(&m_valueLists);
+		return Iterator(this);
 	}
 
 	inline void ForEachKey(IDelegateOneParameter<K&>& func)
@@ -461,37 +477,34 @@ public:
 		Iterator iter = Begin();
 		while(iter.Next())
 		{
-			func.Call(iter->Current(iter.CurrentRef()));
+			func.Call(iter.CurrentKeyRef());
 		}
 	}
 
 	RefCountPtr<Vector<T> > Values() const
 	{
-		RefCountPtr<Vector<T> > vect(new Vector<T>());
-		int count = m_valueLists.Count();
-		for ( int x = 0; x < count; x++ )
+		RefCountPtr<Vector<T> > vect(new Vector<T>(m_count + 1));
+		for ( int x = 0; x < m_capacity; x++ )
 		{
-			List<_Kthashitem *> *list = m_valueLists.ElementAt(x);
-			if ( NULL == list )
+			if ( 0 != m_items[x].dist )
 			{
-				continue;
-			}
-			ASSERT_MEM(list, sizeof(List<_Kthashitem *>));
-			list->ValidateMem();
-
-			typename List<_Kthashitem *>::Iterator iter = list->Begin();
-			while(iter.Next())
-			{
-				vect->Add(iter.Current()->data);
+				vect->Add(m_items[x].data);
 			}
 		}
 		ASSERT(m_count == vect->Count());
 		return vect;
 	}
 
+	/** @brief Removes every item; the table keeps its size. */
 	inline void Clear()
 	{
-		_Clear(m_valueLists);
+		for ( int x = 0; x < m_capacity; x++ )
+		{
+			if ( 0 != m_items[x].dist )
+			{
+				m_items[x] = _Kthashitem();
+			}
+		}
 		m_count = 0;
 	}
 
@@ -503,31 +516,37 @@ public:
 #ifdef DEBUG
 	virtual void ValidateMem() const
 	{
-		m_valueLists.ValidateMem();
-		int count = m_valueLists.Count();
-		for ( int x = 0; x < count; x++ )
+		if ( NULL == m_items )
+		{
+			ASSERT( 0 == m_capacity && 0 == m_count );
+			return;
+		}
+		ASSERT_MEM( m_items, sizeof(_Kthashitem) * m_capacity );
+		int count = 0;
+		for ( int x = 0; x < m_capacity; x++ )
 		{
-			List<_Kthashitem *> *list = m_valueLists.ElementAt(x);
-			if ( list != NULL )
+			TypeValidate( m_items[x].key );
+			TypeValidate( m_items[x].data );
+			if ( 0 != m_items[x].dist )
 			{
-				ASSERT_MEM( list, sizeof(List<_Kthashitem *>) );
-				list->ValidateMem();
+				count++;
 			}
 		}
+		ASSERT( count == m_count );
 	}
 
 	virtual void CheckMem() const
 	{
-		m_valueLists.CheckMem();
-		int count = m_valueLists.Count();
-		for ( int x = 0; x < count; x++ )
+		if ( NULL == m_items )
 		{
-			List<_Kthashitem *> *list = m_valueLists.ElementAt(x);
-			if ( list != NULL )
-			{
-				DEBUG_NOTE_MEM( list );
-				list->CheckMem();
-			}
+			return;
+		}
+		DEBUG_NOTE_MEM( m_items );
+		// Empty slots too; a default K or T may own memory.
+		for ( int x = 0; x < m_capacity; x++ )
+		{
+			TypeCheckMem( m_items[x].key );
+			TypeCheckMem( m_items[x].data );
 		}
 	}
 #else
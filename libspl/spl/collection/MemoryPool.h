@@ -56,6 +56,10 @@ static const int DEFAULT_MEMORY_POOL_BLOCK_SIZE = 1024 ;	//!< Initial MemoryPool
  * This class is the actual implementation of the IMemoryBlock - Interface.
  * It is responsible for all MemoryRequests (GetMemory() / FreeMemory()) and
  * manages the allocation/deallocation of Memory from the Operating-System.
+ *
+ * Used as an arena, allocations are never freed one at a time; Reset()
+ * releases everything at once and keeps the blocks for the next round.
+ * See SizeClassPool for objects freed one at a time from many threads.
  */
 class MemoryPool : public IMemoryValidate
 {
@@ -102,6 +106,19 @@ public:
 	*/
 	void Free(void *ptr);
 
+	/*!
+	  Frees everything allocated from the pool at once.  Blocks made for
+	  requests larger than the block size are given back to the system; the
+	  others are kept for reuse.
+	*/
+	void Reset();
+
+	/// @brief Bytes handed out by Malloc and not yet freed.
+	inline int UsedSize() const { return m_usedMemoryPoolSize; }
+
+	/// @brief Bytes taken from the system.
+	inline int TotalSize() const { return m_totalMemoryPoolSize; }
+
 	/*!
 	  Writes the contents of the MemoryPool to a File.
 	  Note : This file can be quite large (several MB).
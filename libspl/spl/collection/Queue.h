@@ -28,7 +28,10 @@ namespace spl
 		}
 
 	public:
+		// Put's notify is lost if it lands between Get's check and its
+		// wait, so Get also wakes up to look again.
 		inline Queue()
+		: m_event(50)
 		{
 		}
 
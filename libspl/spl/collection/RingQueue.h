@@ -0,0 +1,300 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _ringqueue_h
+#define _ringqueue_h
+
+#include <spl/types.h>
+#include <spl/Debug.h>
+#include <spl/Exception.h>
+#include <spl/Memory.h>
+#include <spl/threading/Event.h>
+#include <spl/threading/InterlockCounter.h>
+#include <spl/threading/Thread.h>
+
+namespace spl
+{
+/**
+ * @defgroup collection Collections
+ * @{
+ */
+
+/// Longest a blocked RingQueue reader or writer sleeps before checking the ring again.
+#define RING_QUEUE_WAIT_MS 50
+
+/// Times a blocked RingQueue writer yields before it sleeps.
+#define RING_QUEUE_SPINS 16
+
+/** @brief A bounded queue for many writer threads and one reader thread.
+ *	Put and TryGet don't take a lock.  Each slot carries a sequence number;
+ *	writers claim a slot by advancing the tail with a compare and swap, and
+ *	the reader owns the head.  Put's behaviour on a full ring is chosen when
+ *	the queue is made: wait for room, fail, or drop and count the item.
+ *	Sleeping readers and writers are woken with an Event, but they also wake
+ *	every RING_QUEUE_WAIT_MS, so a missed notify only costs latency.
+ */
+template<typename T>
+class RingQueue : public IMemoryValidate
+{
+public:
+	/// What Put does when the ring is full.
+	enum FullPolicy
+	{
+		RING_BLOCK,			///< Wait for the reader to make room.
+		RING_NONBLOCK,		///< Return false; the caller keeps the item.
+		RING_DROP			///< Return false and count the item in DroppedCount.
+	};
+
+private:
+	class Slot
+	{
+	public:
+		InterlockCounter m_seq;
+		T m_item;
+	};
+
+	// Copy constructor doesn't make sense for this class
+	inline RingQueue(const RingQueue& q) {}
+	inline void operator =(const RingQueue& q) {}
+
+	Slot *m_slots;
+	int32 m_mask;
+	FullPolicy m_policy;
+
+	// Keep the writers' tail and the reader's head on separate cache lines.
+	char m_pad0[64];
+	InterlockCounter m_tail;
+	char m_pad1[64];
+	int32 m_head;
+	char m_pad2[64];
+
+	volatile int m_readerWaiting;
+	InterlockCounter m_writersWaiting;
+	InterlockCounter m_dropped;
+	Event m_notEmpty;
+	Event m_notFull;
+
+	/// Sequence numbers wrap, so compare them as a signed distance.
+	inline static int32 Distance(int32 a, int32 b) { return (int32)((uint32)a - (uint32)b); }
+	inline static int32 Advance(int32 a, int32 n) { return (int32)((uint32)a + (uint32)n); }
+
+	inline void WaitNotFull()
+	{
+		m_writersWaiting++;
+		m_notFull.Wait();
+		m_writersWaiting--;
+	}
+
+public:
+	/** @param capacity Rounded up to a power of two. */
+	RingQueue(int capacity, FullPolicy policy = RING_BLOCK)
+	:	m_slots(NULL), m_mask(0), m_policy(policy), m_tail(0), m_head(0),
+		m_readerWaiting(0), m_writersWaiting(0), m_dropped(0),
+		m_notEmpty(RING_QUEUE_WAIT_MS), m_notFull(RING_QUEUE_WAIT_MS)
+	{
+		if (capacity < 1)
+		{
+			throw new InvalidArgumentException("RingQueue capacity must be at least 1");
+		}
+		int32 size = 2;
+		while (size < capacity)
+		{
+			size <<= 1;
+		}
+		m_mask = size - 1;
+		m_slots = new Slot[size];
+		for (int32 x = 0; x < size; x++)
+		{
+			m_slots[x].m_seq.Set(x);
+		}
+	}
+
+	virtual ~RingQueue()
+	{
+		delete[] m_slots;
+	}
+
+	inline int Capacity() const { return m_mask + 1; }
+	inline FullPolicy Policy() const { return m_policy; }
+
+	/// @brief Items waiting to be read; only exact when the writers are idle.
+	inline int Count() { return Distance(m_tail.Get(), m_head); }
+	inline bool IsEmpty() { return Count() <= 0; }
+
+	/// @brief Items thrown away by a RING_DROP queue.
+	inline int DroppedCount() { return m_dropped.Get(); }
+
+	/** @brief Adds item if there's room, never waits. */
+	bool TryPut(const T& item)
+	{
+		int32 pos = m_tail.Get();
+		Slot *slot;
+
+		while (true)
+		{
+			slot = &m_slots[pos & m_mask];
+			int32 diff = Distance(slot->m_seq.Get(), pos);
+			if (0 == diff)
+			{
+				int32 prev = m_tail.TestAndSet(Advance(pos, 1), pos);
+				if (prev == pos)
+				{
+					break;
+				}
+				pos = prev;
+			}
+			else if (diff < 0)
+			{
+				// The reader hasn't emptied this slot yet.
+				return false;
+			}
+			else
+			{
+				pos = m_tail.Get();
+			}
+		}
+
+		slot->m_item = item;
+		// Set is a release store, so the reader sees m_item before the sequence.
+		slot->m_seq.Set(Advance(pos, 1));
+
+		if (m_readerWaiting)
+		{
+			m_notEmpty.Notify();
+		}
+		return true;
+	}
+
+	/** @brief Adds item, applying the queue's FullPolicy if the ring is full.
+	 *  @return true if the item was queued.
+	 */
+	bool Put(const T& item)
+	{
+		if (TryPut(item))
+		{
+			return true;
+		}
+		if (RING_DROP == m_policy)
+		{
+			m_dropped++;
+			return false;
+		}
+		if (RING_NONBLOCK == m_policy)
+		{
+			return false;
+		}
+
+		for (int spins = 0; ; spins++)
+		{
+			if (spins < RING_QUEUE_SPINS)
+			{
+				Thread::YYield();
+			}
+			else
+			{
+				WaitNotFull();
+			}
+			if (TryPut(item))
+			{
+				return true;
+			}
+		}
+	}
+
+	/** @brief Removes the oldest item if there is one (reader thread only). */
+	bool TryGet(T& item)
+	{
+		Slot *slot = &m_slots[m_head & m_mask];
+		if (Distance(slot->m_seq.Get(), Advance(m_head, 1)) < 0)
+		{
+			return false;
+		}
+
+		item = slot->m_item;
+		slot->m_item = T();
+		slot->m_seq.Set(Advance(m_head, m_mask + 1));
+		m_head = Advance(m_head, 1);
+
+		if (0 != m_writersWaiting.Get())
+		{
+			m_notFull.Notify();
+		}
+		return true;
+	}
+
+	/** @brief Waits up to timeoutMs for an item (reader thread only).
+	 *  @return false if the ring was still empty.
+	 */
+	bool Get(T& item, int timeoutMs)
+	{
+		if (TryGet(item))
+		{
+			return true;
+		}
+
+		m_readerWaiting = 1;
+		if (TryGet(item))
+		{
+			m_readerWaiting = 0;
+			return true;
+		}
+		m_notEmpty.SetTimeOut(timeoutMs > 0 ? timeoutMs : RING_QUEUE_WAIT_MS);
+		m_notEmpty.Wait();
+		m_readerWaiting = 0;
+
+		return TryGet(item);
+	}
+
+	/** @brief Makes a reader waiting in Get check the ring now. */
+	inline void Wake()
+	{
+		m_notEmpty.Notify();
+	}
+
+	/** @brief Waits for an item (reader thread only). */
+	T Get()
+	{
+		T item;
+		while (!Get(item, RING_QUEUE_WAIT_MS))
+		{
+		}
+		return item;
+	}
+
+#ifdef DEBUG
+	virtual void ValidateMem() const
+	{
+		ASSERT_PTR(m_slots);
+		for (int x = 0; x <= m_mask; x++)
+		{
+			TypeValidate(m_slots[x].m_item);
+		}
+	}
+
+	virtual void CheckMem() const
+	{
+		DEBUG_NOTE_MEM_ALLOCATION(m_slots);
+		for (int x = 0; x <= m_mask; x++)
+		{
+			TypeCheckMem(m_slots[x].m_item);
+		}
+	}
+#endif
+};
+
+/** @} */
+}
+#endif
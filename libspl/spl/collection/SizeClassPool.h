@@ -0,0 +1,119 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _sizeclasspool_h
+#define _sizeclasspool_h
+
+#include <spl/types.h>
+#include <spl/Debug.h>
+#include <spl/Memory.h>
+
+namespace spl
+{
+/**
+ * @defgroup collection Collections
+ * @{
+ */
+
+/// Number of block sizes SizeClassPool keeps free lists for.
+#define SIZECLASSPOOL_CLASSES 16
+
+/// Requests larger than this go straight to malloc.
+#define SIZECLASSPOOL_MAX_SIZE 1024
+
+/// Blocks moved between a thread's cache and the shared free lists at a time.
+#define SIZECLASSPOOL_BATCH 32
+
+/// Bytes of blocks carved out of the system at a time for one size class.
+#define SIZECLASSPOOL_SPAN_SIZE (64 * 1024)
+
+struct _SizeClassCache;
+struct _SizeClassCentral;
+
+/** @brief A thread caching allocator for small, short lived objects.
+ *
+ *	Requests are rounded up to one of SIZECLASSPOOL_CLASSES block sizes.  Each
+ *	thread keeps its own free list per size, so Malloc and Free don't lock;
+ *	a thread that runs out takes SIZECLASSPOOL_BATCH blocks from the shared
+ *	lists, and a thread that collects too many gives a batch back.  Requests
+ *	over SIZECLASSPOOL_MAX_SIZE bypass the lists and use malloc.
+ *
+ *	A block may be freed by any thread, but only to the pool it came from.
+ *	Blocks are 8 byte aligned.  Memory is returned to the system when the
+ *	pool is deleted.
+ */
+class SizeClassPool : public IMemoryValidate
+{
+private:
+	// Copy constructor doesn't make sense for this class
+	inline SizeClassPool(const SizeClassPool& pool) {}
+	inline void operator =(const SizeClassPool& pool) {}
+
+	_SizeClassCentral *m_central;
+
+	static SizeClassPool *m_default;
+
+	_SizeClassCache *ThreadCache();
+	_SizeClassCache *FindThreadCache();
+
+	static SizeClassPool& CreateDefault();
+
+public:
+	SizeClassPool();
+	virtual ~SizeClassPool();
+
+	/** @brief A block of at least size bytes. */
+	void *Malloc(int size);
+
+	/** @brief Returns a block from Malloc to this pool. */
+	void Free(void *ptr);
+
+	/** @brief Gives the calling thread's cached blocks back to the shared lists.
+	 *	Threads do this when they exit; call it from a thread that is about to
+	 *	go idle for a long time.
+	 */
+	void FlushThreadCache();
+
+	/** @brief The bytes usable in a block from Malloc. */
+	static int BlockSize(const void *ptr);
+
+	/** @brief Bytes taken from the system for pooled blocks, not counting large requests. */
+	int64 SpanBytes() const;
+
+	/** @brief The process wide pool.  It is never deleted, so blocks may
+	 *	be freed during static destruction.
+	 */
+	inline static SizeClassPool& Default()
+	{
+		SizeClassPool *pool = m_default;
+		return NULL != pool ? *pool : CreateDefault();
+	}
+
+#ifdef DEBUG
+	virtual void ValidateMem () const;
+	virtual void CheckMem () const;
+#endif
+};
+
+REGISTER_TYPEOF( 402, SizeClassPool );
+
+/** @} */
+}
+
+void *operator new (size_t size, spl::SizeClassPool& pool);
+void operator delete (void *ptr, spl::SizeClassPool& pool);
+
+#endif
@@ -190,6 +190,19 @@ public:
 		AddRange(a, 0, a.Length());
 	}
 
+	/** @brief Appends count items from a C array, growing the vector at most once. */
+	void AddRange(const T *items, const int count)
+	{
+		if ( m_pos + count > m_size )
+		{
+			Extend(m_pos + count > m_size * 2 ? m_pos + count : m_size * 2);
+		}
+		for ( int x = 0; x < count; x++ )
+		{
+			m_data[m_pos++] = items[x];
+		}
+	}
+
 	void AddRange(const Vector<T>& v)
 	{
 		for (int x = 0; x < v.Count(); x++)
@@ -264,7 +277,10 @@ public:
 		{
 			ExtendTo(m_size+10);
 		}
-		memcpy(&m_data[pos+1], &m_data[pos], (m_pos - pos)*sizeof(T));
+		for ( int x = m_pos; x > pos; x-- )
+		{
+			m_data[x] = m_data[x-1];
+		}
 		m_data[pos] = item;
 		m_pos++;
 		ASSERT_PTR( &m_data[m_pos] );
@@ -319,13 +335,43 @@ public:
 		T element = ElementAt(pos);
 		ASSERT_MEM( m_data, sizeof(T) * m_size );
 		ASSERT_PTR( &m_data[pos] );
-		memcpy(&m_data[pos], &m_data[pos+1], (m_pos - pos)*sizeof(T));
+		for ( int x = pos; x < m_pos - 1; x++ )
+		{
+			m_data[x] = m_data[x+1];
+		}
 		m_pos--;
+		m_data[m_pos] = T();
 		ASSERT_PTR( &m_data[m_pos] );
 		ASSERT_MEM( m_data, sizeof(T) * m_size );
 		return element;
 	}
 
+	/** @brief Remove count elements starting at pos.
+	  *
+	  * No error if the range runs past the end of the vector.
+	  */
+	void RemoveRange( const int pos, int count )
+	{
+		if ( pos >= m_pos || count <= 0 )
+		{
+			return;
+		}
+		if ( count > m_pos - pos )
+		{
+			count = m_pos - pos;
+		}
+		ASSERT_MEM( m_data, sizeof(T) * m_size );
+		for ( int x = pos; x < m_pos - count; x++ )
+		{
+			m_data[x] = m_data[x + count];
+		}
+		for ( int x = m_pos - count; x < m_pos; x++ )
+		{
+			m_data[x] = T();
+		}
+		m_pos -= count;
+	}
+
 	inline T& operator[] (const int idx) const
 	{
 		return ElementAtRef(idx);
@@ -424,6 +470,7 @@ public:
 	  *
 	  */
 	inline T *Data() { return m_data; }
+	inline const T *Data() const { return m_data; }
 
 	/** @brief Ensure the vector has a minimum number of elements.
 	  *
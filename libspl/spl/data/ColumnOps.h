@@ -0,0 +1,158 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _columnops_h
+#define _columnops_h
+
+#include <spl/types.h>
+#include <spl/Debug.h>
+#include <spl/Memory.h>
+#include <spl/collection/Array.h>
+#include <spl/collection/Vector.h>
+#include <spl/data/RecordSet.h>
+
+namespace spl
+{
+/**
+ * @defgroup datamodel Data Access Classes
+ * @ingroup database
+ * @{
+ */
+
+/** @brief A set of rows, one bit per row; made by the ColumnOps filters. */
+class RowBitmap : public IMemoryValidate
+{
+private:
+	Array<uint32> m_words;		//< Bits past m_rows are always clear.
+	int m_rows;
+
+	void ClearTail();
+
+public:
+	/** @param selected True to start with every row in the set. */
+	RowBitmap(int rows, bool selected = false);
+	RowBitmap(const RowBitmap& bits);
+	virtual ~RowBitmap();
+
+	RowBitmap& operator =(const RowBitmap& bits);
+
+	inline int Rows() const { return m_rows; }
+	inline int WordCount() const { return m_words.Length(); }
+	inline uint32 *Words() { return m_words.Data(); }
+	inline const uint32 *Words() const { return m_words.Data(); }
+
+	inline bool IsSet(int row) const
+	{
+		ASSERT(row >= 0 && row < m_rows);
+		return 0 != ((m_words.Data()[row >> 5] >> (row & 31)) & 1);
+	}
+
+	inline void Set(int row)
+	{
+		ASSERT(row >= 0 && row < m_rows);
+		m_words.Data()[row >> 5] |= 1U << (row & 31);
+	}
+
+	inline void Clear(int row)
+	{
+		ASSERT(row >= 0 && row < m_rows);
+		m_words.Data()[row >> 5] &= ~(1U << (row & 31));
+	}
+
+	/** @brief The number of rows in the set. */
+	int Count() const;
+
+	void And(const RowBitmap& bits);
+	void Or(const RowBitmap& bits);
+	void Not();
+
+	/** @brief Adds the rows in the set to rows, in order. */
+	void ToRows(Vector<int>& rows) const;
+
+#if defined(DEBUG)
+	virtual void CheckMem() const;
+	virtual void ValidateMem() const;
+#endif
+};
+
+/** @brief The result of ColumnOps::Aggregate.  Nulls are not counted. */
+typedef struct _ColumnSummary
+{
+	int64 count;
+	float64 sum;
+	int64 intSum;		///< The exact sum, for integer columns.
+	float64 min;		///< Zero if count is zero.
+	float64 max;
+
+	inline float64 Avg() const { return 0 == count ? 0 : sum / (float64)count; }
+} ColumnSummary;
+
+/** @brief Column at a time filters, aggregates, grouping and sorting for RecordSets.
+ *	The numeric columns (int8 to int64, float32, float64 and flags) are read
+ *	straight from their value arrays, 32 rows at a time, in loops the compiler
+ *	can unroll and vectorize; null rows are dropped a word at a time using the
+ *	columns' null bitmaps.  Other column types are read through GetVarchar,
+ *	and only GroupBy and Sort accept them.
+ */
+class ColumnOps
+{
+private:
+	inline ColumnOps() {}
+
+public:
+	enum
+	{
+		CMP_EQ = 0,
+		CMP_NE = 1,
+		CMP_LT = 2,
+		CMP_LE = 3,
+		CMP_GT = 4,
+		CMP_GE = 5
+	};
+
+	/** @brief Sets result to the rows where col op value is true; null rows are never in it.
+	 *	@param result Must have col->Count() rows.
+	 */
+	static void Filter(IColumn *col, int op, int64 value, RowBitmap& result);
+	static void Filter(IColumn *col, int op, float64 value, RowBitmap& result);
+
+	/** @brief Sets result to the null rows of col, or the non null rows if isNull is false. */
+	static void FilterNull(IColumn *col, bool isNull, RowBitmap& result);
+
+	/** @brief COUNT, SUM, MIN, MAX and AVG of a numeric column.
+	 *	@param sel The rows to use, or NULL for all of them.
+	 */
+	static ColumnSummary Aggregate(IColumn *col, const RowBitmap *sel = NULL);
+
+	/** @brief Groups the rows by keyCol and aggregates valueCol for each group.
+	 *	The result has the columns keyCol (int64 for integer keys, varchar
+	 *	otherwise), count, sum, min, max and avg, with one row per key in the
+	 *	order the keys were first seen.  Null keys form one group.  Groups
+	 *	without a non null value have null sum, min, max and avg.
+	 */
+	static RecordSetPtr GroupBy(RecordSet& rs, const String& keyCol, const String& valueCol, const RowBitmap *sel = NULL);
+
+	/** @brief The row order that sorts by keys, first key first.  Stable; nulls sort first.
+	 *	@param descending One per key, or empty for all ascending.
+	 *	@param sel The rows to sort, or NULL for all of them.
+	 *	@param perm Cleared, then given the row numbers in sorted order.
+	 */
+	static void Sort(const Vector<IColumn *>& keys, const Vector<bool>& descending, const RowBitmap *sel, Vector<int>& perm);
+};
+
+/** @} */
+}
+#endif
@@ -41,6 +41,7 @@ public:
 	virtual ~Int8Column();
 
 	virtual int Count() const;
+	inline const int8 *Data() const { return m_data.Data(); }
 	virtual int Type() const;
 	virtual IColumn *Clone() const;
 
@@ -58,6 +59,7 @@ public:
 	virtual void AppendParse( const char *data, const int len);
 	virtual void Append( void *data, int len );
 	virtual void Append( IColumn *col, const int row );
+	virtual void AppendRows( IColumn *col );
 	virtual void AppendNull(  );
 
 	virtual int8 GetByte(const int row);
@@ -91,6 +93,7 @@ public:
 	virtual ~Int16Column();
 
 	virtual int Count() const;
+	inline const int16 *Data() const { return m_data.Data(); }
 	virtual int Type() const;
 	virtual IColumn *Clone() const;
 
@@ -108,6 +111,7 @@ public:
 	virtual void AppendParse( const char * data, const int len);
 	virtual void Append( void *data, int len );
 	virtual void Append( IColumn *col, const int row );
+	virtual void AppendRows( IColumn *col );
 	virtual void AppendNull(  );
 
 	virtual int8 GetByte(const int row);
@@ -141,6 +145,7 @@ public:
 	virtual ~Int32Column();
 
 	virtual int Count() const;
+	inline const int32 *Data() const { return m_data.Data(); }
 	virtual int Type() const;
 	virtual IColumn *Clone() const;
 
@@ -158,6 +163,7 @@ public:
 	virtual void AppendParse( const char * data, const int len);
 	virtual void Append( void *data, int len );
 	virtual void Append( IColumn *col, const int row );
+	virtual void AppendRows( IColumn *col );
 	virtual void AppendNull(  );
 
 	virtual int8 GetByte(const int row);
@@ -191,6 +197,7 @@ public:
 	virtual ~Int64Column();
 
 	virtual int Count() const;
+	inline const int64 *Data() const { return m_data.Data(); }
 	virtual int Type() const;
 	virtual IColumn *Clone() const;
 
@@ -208,6 +215,7 @@ public:
 	virtual void AppendParse( const char * data, const int len);
 	virtual void Append( void *data, int len );
 	virtual void Append( IColumn *col, const int row );
+	virtual void AppendRows( IColumn *col );
 	virtual void AppendNull(  );
 
 	virtual int8 GetByte(const int row);
@@ -240,6 +248,7 @@ public:
 	Float32Column(const String& name);
 	virtual ~Float32Column();
 	virtual int Count() const;
+	inline const float32 *Data() const { return m_data.Data(); }
 	virtual int Type() const;
 	virtual IColumn *Clone() const;
 
@@ -257,6 +266,7 @@ public:
 	virtual void AppendParse( const char * data, const int len);
 	virtual void Append( void *data, int len );
 	virtual void Append( IColumn *col, const int row );
+	virtual void AppendRows( IColumn *col );
 	virtual void AppendNull(  );
 
 	virtual int8 GetByte(const int row);
@@ -290,6 +300,7 @@ public:
 	virtual ~Float64Column();
 
 	virtual int Count() const;
+	inline const float64 *Data() const { return m_data.Data(); }
 	virtual int Type() const;
 	virtual IColumn *Clone() const;
 
@@ -307,6 +318,7 @@ public:
 	virtual void AppendParse( const char * data, const int len);
 	virtual void Append( void *data, int len );
 	virtual void Append( IColumn *col, const int row );
+	virtual void AppendRows( IColumn *col );
 	virtual void AppendNull(  );
 
 	virtual int8 GetByte(const int row);
@@ -390,6 +402,7 @@ public:
 	virtual ~BitColumn();
 
 	virtual int Count() const;
+	inline const bool *Data() const { return m_data.Data(); }
 	virtual int Type() const;
 	virtual IColumn *Clone() const;
 
@@ -407,6 +420,7 @@ public:
 	virtual void AppendParse( const char * data, const int len);
 	virtual void Append( void *data, int len );
 	virtual void Append( IColumn *col, const int row );
+	virtual void AppendRows( IColumn *col );
 	virtual void AppendNull(  );
 
 	virtual int8 GetByte(const int row);
@@ -483,7 +497,8 @@ public:
 class DateColumn : public IColumn
 {
 protected:
-	Vector<Date> m_data;
+	// YYYYMMDD, since a Date default constructs to today, which is slow to fill a vector with.
+	Vector<int32> m_data;
 
 public:
 	DateColumn(const String& name);
@@ -507,6 +522,7 @@ public:
 	virtual void AppendParse( const char * data, const int len);
 	virtual void Append( void *data, int len );
 	virtual void Append( IColumn *col, const int row );
+	virtual void AppendRows( IColumn *col );
 	virtual void AppendNull(  );
 
 	virtual int8 GetByte(const int row);
@@ -670,6 +686,7 @@ public:
 	virtual void AppendParse( const char * data, const int len);
 	virtual void Append( void *data, int len );
 	virtual void Append( IColumn *col, const int row );
+	virtual void AppendRows( IColumn *col );
 	virtual void AppendNull(  );
 
 	virtual int8 GetByte(const int row);
@@ -693,6 +710,61 @@ public:
 #endif
 };
 
+/** @brief Binary values, one byte array per row.  Null rows have no array.
+ *	As a string, a value is base 64 encoded.
+ */
+class BlobColumn : public IColumn
+{
+protected:
+	Vector<RefCountPtr<Array<byte> > > m_data;
+
+public:
+	BlobColumn(const String& name, const int maxlen);
+	virtual ~BlobColumn();
+
+	virtual int Count() const;
+	virtual int Type() const;
+	virtual IColumn *Clone() const;
+
+	virtual void Append( int8 i );
+	virtual void Append( int16 i );
+	virtual void Append( int32 i );
+	virtual void Append( int64 i );
+	virtual void Append( Decimal i );
+	virtual void Append( float32 i );
+	virtual void Append( float64 i );
+	virtual void Append( bool i );
+	virtual void Append( DateTime i );
+	virtual void Append( Date i );
+	virtual void Append( const String& str );
+	virtual void AppendParse( const char * data, const int len);
+	virtual void Append( void *data, int len );
+	virtual void Append( IColumn *col, const int row );
+	virtual void AppendNull(  );
+
+	inline RefCountPtr<Array<byte> > GetBlob(const int row) { return m_data.ElementAt(row); }
+
+	virtual int8 GetByte(const int row);
+	virtual int16 GetInt16(const int row);
+	virtual int32 GetInt32(const int row);
+	virtual int64 GetInt64(const int row);
+	virtual Decimal GetDecimal(const int row);
+	virtual float32 GetFloat32(const int row);
+	virtual float64 GetFloat64(const int row);
+	virtual bool GetBit(const int row);
+	virtual DateTime GetTimeStamp(const int row);
+	virtual Date GetDate(const int row);
+	virtual DateTime GetDateTime(const int row);
+	virtual StringPtr GetChar(const int row);
+	virtual StringPtr GetVarchar(const int row);
+	virtual Variant GetVariant(const int row);
+
+#if defined(DEBUG)
+	virtual void CheckMem() const;
+	virtual void ValidateMem() const;
+#endif
+};
+
 /** @} */
 }
 #endif
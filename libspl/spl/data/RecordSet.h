@@ -35,15 +35,33 @@ namespace spl
  * @{
  */
 
+/** @brief A typed column of a RecordSet.
+ *	Nulls are kept in a bitmap beside the values, which hold zero for a null
+ *	row.  The bitmap is only made when the first null is appended.
+ */
 class IColumn : public IMemoryValidate
 {
 private:
 	int m_currow;
+	Vector<uint32> *m_nulls;	//< Bit row % 32 of word row / 32 is set for a null; missing words are zero.
+	int m_nullCount;
+
+	inline IColumn(const IColumn& col) {}
+	inline void operator =(const IColumn& col) {}
 
 protected:
 	String m_name;
 	int m_maxlen;
 
+	/** @brief Marks row null; called by AppendNull. */
+	void NoteNull(const int row);
+
+	/** @brief For Clone. */
+	void CopyNulls(const IColumn& from);
+
+	/** @brief Marks from's null rows, offset by offset; for AppendRows. */
+	void AppendNulls(const IColumn& from, const int offset);
+
 public:
 	IColumn(const String& name, const int maxlen);
 	virtual ~IColumn();
@@ -75,6 +93,29 @@ public:
 	virtual void Append( IColumn *col, const int row ) = 0;
 	virtual void AppendNull() = 0;
 
+	/** @brief Appends every row of col.  Columns of the same type copy their
+	 *	values in bulk; others go through Append(col, row).
+	 */
+	virtual void AppendRows( IColumn *col );
+
+	inline bool IsNull(const int row) const
+	{
+		ASSERT(row >= 0);
+		return NULL != m_nulls && (row >> 5) < m_nulls->Count() && 0 != ((m_nulls->Data()[row >> 5] >> (row & 31)) & 1);
+	}
+
+	inline bool IsNull() const { return IsNull(m_currow); }
+	inline int NullCount() const { return m_nullCount; }
+
+	/** @brief The null bitmap, or NULL if there are no nulls.
+	 *	@param words Set to the number of words; rows past words * 32 aren't null.
+	 */
+	inline const uint32 *NullBitmap(int& words) const
+	{
+		words = NULL == m_nulls ? 0 : m_nulls->Count();
+		return NULL == m_nulls ? NULL : m_nulls->Data();
+	}
+
 	inline int8 GetByte() { return GetByte(m_currow); }
 	inline int16 GetInt16() { return GetInt16(m_currow); }
 	inline int32 GetInt32() { return GetInt32(m_currow); }
@@ -158,6 +199,9 @@ public:
 
 	void DefineColumn(const String& name, int type, int fieldmaxlen);
 	void SetColumns( RecordSet& rs );
+
+	/** @brief Appends rs's rows; rs must have the same columns, in the same order. */
+	void AppendRows( RecordSet& rs );
 	inline IColumn *GetColumn(const String& name) { return m_columnIdx.Get(String(name)); }
 	inline IColumn *GetColumn(int idx) { return m_columns.ElementAt(idx); }
 	
@@ -42,6 +42,7 @@ typedef RefCountPtr<DelimitedFile> DelimitedFilePtr;
 REGISTER_TYPEOF(76, DelimitedFilePtr);
 
 /** @brief Loads delimited file into memory.
+ *	For large files into typed columns, see DelimitedFileLoader.
  *	@ref DataTable
  */
 class DelimitedFile : public IMemoryValidate
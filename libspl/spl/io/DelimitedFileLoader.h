@@ -0,0 +1,123 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _delimitedfileloader_h
+#define _delimitedfileloader_h
+
+#include <spl/types.h>
+#include <spl/Debug.h>
+#include <spl/Delegate.h>
+#include <spl/Memory.h>
+#include <spl/RefCountPtr.h>
+#include <spl/String.h>
+#include <spl/data/RecordSet.h>
+#include <spl/io/MappedFile.h>
+
+namespace spl
+{
+/**
+ * @defgroup file File System
+ * @ingroup io
+ * @{
+ */
+
+class DelimitedFileLoader;
+typedef RefCountPtr<DelimitedFileLoader> DelimitedFileLoaderPtr;
+
+/** @brief Called with each batch of rows by DelimitedFileLoader::Load; the
+ *	record set is only valid during the call.
+ */
+typedef RefCountPtr<IDelegateOneParameter<RecordSet&> > DelimitedFileBatchDelegatePtr;
+
+REGISTER_TYPEOF( 420, DelimitedFileLoaderPtr );
+
+/** @brief Loads a large delimited file into typed RecordSet columns.
+ *	The file is mapped and cut into chunks at record boundaries, found from
+ *	the parity of the quotes before each newline.  The chunks are parsed on
+ *	several threads, each into its own record set.
+ *	<ul>
+ *	<li>Fields may be quoted with '"'; a quoted field may hold the delimiter,
+ *	newlines and "" for a quote.  A quote inside an unquoted field also starts
+ *	a quoted section.</li>
+ *	<li>Records end with \\n or \\r\\n.  Blank lines are skipped.</li>
+ *	<li>An empty field is null, except that "" is an empty string in CHAR and
+ *	VARCHAR columns.  Missing fields are null and extra fields are ignored.</li>
+ *	</ul>
+ *	If no columns are defined, every column is VARCHAR and is named from the
+ *	header, or by its position if there is no header.
+ *	<pre>
+ *	DelimitedFileLoader loader("extract.csv", ',');
+ *	loader.SetHasHeader(true);
+ *	loader.DefineColumn("id", DbSqlType::SQL_TYPE_INT32, 4);
+ *	loader.DefineColumn("name", DbSqlType::SQL_TYPE_VARCHAR, 64);
+ *	RecordSetPtr rs = loader.Load();
+ *	</pre>
+ *	@ref DelimitedFile
+ */
+class DelimitedFileLoader : public IMemoryValidate
+{
+private:
+	// forbid copy constructor
+	inline DelimitedFileLoader(const DelimitedFileLoader& dfl) {}
+	inline void operator =(const DelimitedFileLoader& dfl) {}
+
+	MappedFilePtr m_file;
+	char m_coldelim;
+	bool m_hasHeader;
+	int m_threadCount;
+	int m_chunkSize;
+	RecordSet m_columns;
+
+	/** @brief Returns the offset just past the header, defining VARCHAR columns from it if none are defined. */
+	int64 ReadHeader();
+
+	/** @brief Finds the record boundaries of the batch starting at pos and parses it into batch, one record set per chunk. */
+	int64 ParseBatch(int64 pos, Vector<RecordSet *>& batch);
+
+public:
+	/** @brief Maps filename; throws IOException if it can't be opened. */
+	DelimitedFileLoader(const String& filename, char coldelim);
+	virtual ~DelimitedFileLoader();
+
+	void DefineColumn(const String& name, int type, int fieldmaxlen);
+
+	/** @brief Skip the first record, and name the columns from it if none are defined. */
+	inline void SetHasHeader(bool hasHeader) { m_hasHeader = hasHeader; }
+
+	/** @brief Number of threads to parse on; the default is the processor count. */
+	inline void SetThreadCount(int count) { m_threadCount = count < 1 ? 1 : count; }
+
+	/** @brief Bytes per chunk, which is also the unit a thread parses; the default is 4MB. */
+	inline void SetChunkSize(int bytes) { m_chunkSize = bytes < 64 ? 64 : bytes; }
+
+	/** @brief Loads the whole file into one record set. */
+	RecordSetPtr Load();
+
+	/** @brief Calls onBatch with each chunk's rows in file order.  Only a batch
+	 *	of chunks (threads times chunk size) is held in memory at a time, so this
+	 *	works on files larger than memory.
+	 */
+	void Load(DelimitedFileBatchDelegatePtr onBatch);
+
+#if defined(DEBUG)
+	void CheckMem() const;
+	void ValidateMem() const;
+#endif
+};
+
+/** @} */
+}
+#endif
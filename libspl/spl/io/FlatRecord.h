@@ -14,731 +14,300 @@
  *   You should have received a copy of the GNU General Public License
  *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
  */
-/*using System;
-using System.Collections;
-using System.Diagnostics;
-using System.Text;
-
-	/// <summary>
-	/// Definition of a fixed width field
-	/// </summary>
-	public class FixedFieldDef
+#ifndef _flatrecord_h
+#define _flatrecord_h
+
+#include <spl/types.h>
+#include <spl/Debug.h>
+#include <spl/Date.h>
+#include <spl/DateTime.h>
+#include <spl/Decimal.h>
+#include <spl/Delegate.h>
+#include <spl/Memory.h>
+#include <spl/RefCountPtr.h>
+#include <spl/String.h>
+#include <spl/StringView.h>
+#include <spl/collection/Hashtable.h>
+#include <spl/collection/Vector.h>
+#include <spl/data/RecordSet.h>
+#include <spl/io/MappedFile.h>
+
+namespace spl
+{
+/**
+ * @defgroup file File System
+ * @ingroup io
+ * @{
+ */
+
+class FixedRecordDef;
+typedef RefCountPtr<FixedRecordDef> FixedRecordDefPtr;
+
+class FixedRecordFile;
+typedef RefCountPtr<FixedRecordFile> FixedRecordFilePtr;
+
+/** @brief Called with each batch of rows by FixedRecordFile::Load; the record
+ *	set is only valid during the call.
+ */
+typedef RefCountPtr<IDelegateOneParameter<RecordSet&> > FixedRecordBatchDelegatePtr;
+
+REGISTER_TYPEOF( 401, FixedRecordDefPtr );
+REGISTER_TYPEOF( 403, FixedRecordFilePtr );
+
+/** @brief How a fixed width field's characters are read. */
+typedef enum _FixedFieldFormat
+{
+	FIXED_FMT_DEFAULT = 0,	//< Text with trailing spaces trimmed, or a number.
+	FIXED_FMT_MMDDYY,		//< Years over 50 are 19xx.
+	FIXED_FMT_YYYYMMDD,
+	FIXED_FMT_TIMESTAMP		//< YYYY-MM-DD?HH:MM:SS, with any separators and fraction ignored.
+} FixedFieldFormat;
+
+/** @brief A field's place in a fixed width record. */
+class FixedFieldDef : public IMemoryValidate
+{
+public:
+	String m_name;
+	int m_offset;
+	int m_length;
+	int m_type;				//< DbSqlType, or SQL_TYPE_UNASSIGNED for filler.
+	int m_scale;			//< Implied decimal places of a number.
+	FixedFieldFormat m_format;
+
+	FixedFieldDef();
+	FixedFieldDef(const String& name, int offset, int length, int type, int scale, FixedFieldFormat format);
+	FixedFieldDef(const FixedFieldDef& fld);
+	virtual ~FixedFieldDef();
+	FixedFieldDef& operator =(const FixedFieldDef& fld);
+
+	inline bool IsFiller() const { return DbSqlType::SQL_TYPE_UNASSIGNED == m_type; }
+
+#if defined(DEBUG)
+	void CheckMem() const;
+	void ValidateMem() const;
+#endif
+};
+
+inline void TypeValidate( const FixedFieldDef& fld )
+{
+	fld.ValidateMem();
+}
+
+inline void TypeCheckMem( const FixedFieldDef& fld )
+{
+	fld.CheckMem();
+}
+
+class FixedRecord;
+
+/** @brief The layout of a fixed width record, defined once and shared by
+ *	every record parsed with it.  Fields are laid out in the order they are
+ *	added.
+ *	<pre>
+ *	FixedRecordDefPtr def(new FixedRecordDef(40));
+ *	def->AddField("RecordType", 2, DbSqlType::SQL_TYPE_CHAR);
+ *	def->AddDateField("Received", 6, FIXED_FMT_MMDDYY);
+ *	def->AddFiller(4);
+ *	def->AddField("Amount", 14, DbSqlType::SQL_TYPE_DECIMAL, 2);
+ *	def->AddField("Name", 14, DbSqlType::SQL_TYPE_VARCHAR);
+ *	</pre>
+ *	Numbers may have leading spaces or zeros and a leading sign, or an
+ *	overpunched sign in the last digit ('{' and A-I positive, '}' and J-R
+ *	negative).  A blank number or date, or a date of all zeros, loads as null.
+ */
+class FixedRecordDef : public IMemoryValidate
+{
+private:
+	// forbid copy constructor
+	inline FixedRecordDef(const FixedRecordDef& def) {}
+	inline void operator =(const FixedRecordDef& def) {}
+
+	int m_recordLength;
+	int m_recordEnd;
+	Vector<FixedFieldDef> m_fields;
+	Hashtable<String, int> m_fieldIdx;
+
+	int AddField(const FixedFieldDef& fld);
+
+public:
+	/** @brief recordLength is the length in bytes, not counting any line terminator. */
+	FixedRecordDef(int recordLength);
+	virtual ~FixedRecordDef();
+
+	/** @brief Adds a field after the last one and returns its ordinal.  Throws
+	 *	InvalidArgumentException if it runs past the end of the record.
+	 */
+	inline int AddField(const String& name, int length, int type)
+	{
+		return AddField(FixedFieldDef(name, m_recordEnd, length, type, 0, FIXED_FMT_DEFAULT));
+	}
+
+	/** @brief A number with scale implied decimal places, so "+0001234" with a scale of 2 is 12.34. */
+	inline int AddField(const String& name, int length, int type, int scale)
+	{
+		return AddField(FixedFieldDef(name, m_recordEnd, length, type, scale, FIXED_FMT_DEFAULT));
+	}
+
+	/** @brief A DATE field, or a DATETIME field for FIXED_FMT_TIMESTAMP. */
+	inline int AddDateField(const String& name, int length, FixedFieldFormat format)
+	{
+		int type = FIXED_FMT_TIMESTAMP == format ? DbSqlType::SQL_TYPE_DATETIME : DbSqlType::SQL_TYPE_DATE;
+		return AddField(FixedFieldDef(name, m_recordEnd, length, type, 0, format));
+	}
+
+	/** @brief Skips length bytes that aren't loaded. */
+	inline int AddFiller(int length)
+	{
+		return AddField(FixedFieldDef(String(), m_recordEnd, length, DbSqlType::SQL_TYPE_UNASSIGNED, 0, FIXED_FMT_DEFAULT));
+	}
+
+	inline int RecordLength() const { return m_recordLength; }
+	inline int FieldCount() const { return m_fields.Count(); }
+	inline const FixedFieldDef& Field(int ordinal) const { return m_fields.ElementAtRef(ordinal); }
+
+	/** @brief Returns -1 if there is no field called name. */
+	int GetFieldOrdinal(const String& name) const;
+
+	/** @brief Defines a column in rs for each field that isn't filler. */
+	void DefineColumns(RecordSet& rs) const;
+
+	/** @brief A view of the record at data, which must be at least RecordLength() bytes. */
+	FixedRecord Parse(const byte *data) const;
+
+#if defined(DEBUG)
+	void CheckMem() const;
+	void ValidateMem() const;
+#endif
+};
+
+/** @brief A view of one record in a buffer owned by someone else, such as a
+ *	MappedFile.  Fields are only converted when they are read, and text is
+ *	returned as a StringView, so reading a record doesn't allocate.
+ */
+class FixedRecord
+{
+private:
+	const FixedRecordDef *m_def;
+	const char *m_data;
+
+public:
+	inline FixedRecord(const FixedRecordDef& def, const byte *data)
+	: m_def(&def), m_data((const char *)data)
 	{
-		/// <summary>
-		/// Define a field with a repeating fill character
-		/// </summary>
-		/// <param name="name">Field Name (Unique in record)</param>
-		/// <param name="len">Length in characters</param>
-		/// <param name="recposition">Character position in record</param>
-		/// <param name="ordnal">Field number (starting at zero)</param>
-		/// <param name="fill">Default fill character</param>
-		public FixedFieldDef( string name, int len, int recposition, int ordnal, char fill )
-		{
-			m_name = name;
-			m_len = len;
-			m_recpos = recposition;
-			m_fieldpos = ordnal;
-			m_templateData = new string( fill, m_len );
-		}
-
-		/// <summary>
-		/// Define a field with default data
-		/// </summary>
-		/// <param name="name">Field Name (Unique in record)</param>
-		/// <param name="len">Length in characters</param>
-		/// <param name="recposition">Character position in record</param>
-		/// <param name="ordnal">Field number (starting at zero)</param>
-		/// <param name="defaultData">Default field data (lenght must equal field length)</param>
-		public FixedFieldDef( string name, int len, int recposition, int ordnal, string defaultData )
-		{
-			Debug.Assert( defaultData.Length == len );
-			if ( defaultData.Length != len )
-			{
-				throw new Exception(name + " incorrect length" );
-			}
-			m_name = name;
-			m_len = len;
-			m_recpos = recposition;
-			m_fieldpos = ordnal;
-			m_templateData = defaultData;
-		}
-
-		/// <summary>
-		/// Size in chars
-		/// </summary>
-		public int Length
-		{
-			get
-			{
-				return m_len;
-			}
-		}
-
-		/// <summary>
-		/// Record unique field name
-		/// </summary>
-		public string Name
-		{
-			get
-			{
-				return m_name;
-			}
-		}
-
-		/// <summary>
-		/// Default field data
-		/// </summary>
-		public string DefaultData
-		{
-			get
-			{
-				return m_templateData;
-			}
-		}
-
-		/// <summary>
-		/// Zero based field position
-		/// </summary>
-		public int OrdinalPosition
-		{
-			get
-			{
-				return m_fieldpos;
-			}
-		}
-
-		/// <summary>
-		/// Extract the data for this field.
-		/// </summary>
-		/// <param name="record">A single flat record line</param>
-		/// <returns></returns>
-		public string Parse( string record )
-		{
-			Debug.Assert( m_recpos + m_len <= record.Length, m_name + " record too short" );
-			return record.Substring(m_recpos, m_len);
-		}
-
-		protected string m_name;
-		protected int m_len;
-		protected int m_recpos;
-		/// <summary>Field ordinal position</summary>
-		protected int m_fieldpos;
-		protected string m_templateData;
 	}
 
-	/// <summary>
-	/// Definition for a fixed width file record.  (See FlatRecordFactory)
-	/// </summary>
-	public class FixedRecordDef
+	inline FixedRecord(const FixedRecord& rec)
+	: m_def(rec.m_def), m_data(rec.m_data)
 	{
-		/// <summary>
-		/// Define a record
-		/// </summary>
-		/// <param name="linelen">Length of the record in chars</param>
-		public FixedRecordDef( int linelen )
-		{
-			m_linelen = linelen;
-		}
-
-		/// <summary>
-		/// Add a field to the record
-		/// </summary>
-		/// <param name="name">Unique field name</param>
-		/// <param name="len">Length in chars</param>
-		/// <param name="defData">Default data (length must equal field length</param>
-		public void AddField( string name, int len, string defData )
-		{
-			FixedFieldDef fld = new FixedFieldDef( name, len, m_recordEnd, m_fields.Count, defData );
-			AddField( fld );
-		}
-
-		/// <summary>
-		/// Add a field to the record
-		/// </summary>
-		/// <param name="name">Unique field name</param>
-		/// <param name="len">Length in chars</param>
-		/// <param name="fill">Fill default field data</param>
-		public void AddField( string name, int len, char fill )
-		{
-			FixedFieldDef fld = new FixedFieldDef( name, len, m_recordEnd, m_fields.Count, fill );
-			AddField( fld );
-		}
-
-		/// <summary>
-		/// Add the created field
-		/// </summary>
-		/// <param name="fld"></param>
-		private void AddField( FixedFieldDef fld )
-		{
-			m_recordEnd += fld.Length;
-			Debug.Assert( m_recordEnd <= m_linelen, "Field exceeds max record size" );
-
-			m_fields.Add( fld );
-			m_fieldIndex.Add( fld.Name, fld );
-		}
-
-		/// <summary>
-		/// Parse a record from a text file
-		/// </summary>
-		/// <param name="record">A line from the fixed width file</param>
-		/// <returns>FixedRecord</returns>
-		public FixedRecord Parse( string record )
-		{
-			FixedFieldData[] data = new FixedFieldData[ m_fields.Count ];
-
-			for ( int x = 0; x < m_fields.Count; x++ )
-			{
-				data[x] = new FixedFieldData( (FixedFieldDef)m_fields[x], record );
-			}
-			return new FixedRecord( this, data );
-		}
-
-		/// <summary>
-		/// Creates an empty data record
-		/// </summary>
-		/// <returns>FixedRecord</returns>
-		public FixedRecord Create( )
-		{
-			FixedFieldData[] data = new FixedFieldData[ m_fields.Count ];
-
-			for ( int x = 0; x < m_fields.Count; x++ )
-			{
-				data[x] = new FixedFieldData( (FixedFieldDef)m_fields[x] );
-			}
-			return new FixedRecord( this, data );
-		}
-
-		/// <summary>
-		/// Get a record from the record catch
-		/// </summary>
-		/// <returns>FixedRecord</returns>
-		public FixedRecord CreateCached()
-		{
-			lock ( m_cache )
-			{
-				if ( m_cache.Count == 0 )
-				{
-					return Create();
-				}
-				FixedRecord rcd = (FixedRecord)m_cache[ m_cache.Count-1 ];
-				m_cache.RemoveAt( m_cache.Count - 1 );
-				return rcd;
-			}
-		}
-
-		/// <summary>
-		/// Put a record back into the cache
-		/// </summary>
-		/// <param name="rcd"></param>
-		public void ReleaseCached( FixedRecord rcd )
-		{
-			lock( m_cache )
-			{
-				rcd.Reset();
-				m_cache.Add( rcd );
-			}
-		}
-
-		/// <summary>
-		/// Get the field position in the file
-		/// </summary>
-		/// <param name="name">Field name</param>
-		/// <returns>field ordinal position</returns>
-		public int GetFieldOrdinal( string name )
-		{
-			return ((FixedFieldDef)m_fieldIndex[ name ]).OrdinalPosition;
-		}
-
-		protected Hashtable m_fieldIndex = new Hashtable();
-		protected ArrayList m_fields = new ArrayList();
-		protected int m_linelen;
-		protected int m_recordEnd;
-
-		protected ArrayList m_cache = new ArrayList();
 	}
 
-	/// <summary>
-	/// Field data for a record
-	/// </summary>
-	public class FixedFieldData
+	inline FixedRecord& operator =(const FixedRecord& rec)
 	{
-		/// <summary>
-		/// Initialize the field data from the field definition
-		/// </summary>
-		/// <param name="field"></param>
-		public FixedFieldData( FixedFieldDef field )
-		{
-			m_field = field;
-			m_data = field.DefaultData;
-		}
-
-		/// <summary>
-		/// Initialize the field data from a record
-		/// </summary>
-		/// <param name="field"></param>
-		/// <param name="record"></param>
-		public FixedFieldData( FixedFieldDef field, string record )
-		{
-			m_field = field;
-			m_data = field.Parse( record );
-		}
-
-		/// <summary>
-		/// The field's data
-		/// </summary>
-		public string Value
-		{
-			get
-			{
-				return m_data;
-			}
-		}
-
-		/// <summary>
-		/// Parse the field data as a Date (MMDDYY)
-		/// </summary>
-		/// <returns>Date</returns>
-		public Date ParseDate()
-		{
-			Debug.Assert( m_field.Length == 6 );
-			string mm = m_data.Substring(0, 2);
-			string dd = m_data.Substring(2, 2);
-			string yy = m_data.Substring(4, 2);
-
-			int iyy = Int32.Parse( yy );
-			if ( iyy > 50 )
-			{
-				iyy += 1900;
-			}
-			else
-			{
-				iyy += 2000;
-			}
-			return new Date( iyy, Int32.Parse(mm), Int32.Parse(dd) );
-		}
-
-		/// <summary>
-		/// Parse the field's data as an integer
-		/// </summary>
-		/// <returns>int</returns>
-		public int ParseInt()
-		{
-			string i = StripZeros(m_data).Trim();
-			if ( i.Length == 0 )
-			{
-				i = "0";
-			}
-			return Int32.Parse( i );
-		}
-
-		/// <summary>
-		/// Parse the field's data as money (+00000000000000;-00000000000000)
-		/// </summary>
-		/// <returns>money</returns>
-		public decimal ParseMoney() 
-		{
-			char sign = m_data[0];
-			Debug.Assert( sign == '+' || sign == '-', "Invalid money format " + m_data );
-			decimal amt = Decimal.Parse( m_data.Substring( 1 ) ) / 100;
-			if ( sign == '-' )
-			{
-				return -amt;
-			}
-			return amt;
-		}
-
-		/// <summary>
-		/// Parse a largish integer
-		/// </summary>
-		/// <returns>decimal</returns>
-		public decimal ParseDecimal()
-		{
-			return Decimal.Parse( StripZeros(m_data) );
-		}
-
-		/// <summary>
-		/// Parse a string with the format of "YYYY-MM-DD:HH:NN:SS.000000"
-		/// </summary>
-		/// <returns>DateTime</returns>
-		public DateTime ParseDateTime()
-		{
-			int yyyy = Int32.Parse( m_data.Substring(0, 4) );
-			int mm = Int32.Parse( m_data.Substring(5, 2) );
-			int dd = Int32.Parse( m_data.Substring(8, 2) );
-
-			string timepart = m_data.Substring(11);
-			string[] tps = timepart.Split(new char[] {':'});
-			return new DateTime(yyyy, mm, dd, Int32.Parse(tps[0]), Int32.Parse(tps[1]), (int)Double.Parse(tps[2]));
-		}
-
-		/// <summary>
-		/// Return a four digit year
-		/// </summary>
-		/// <returns>int</returns>
-		public int ParseYear()
-		{
-			Debug.Assert( m_field.Length == 2 || m_field.Length == 4 );
-			if ( m_field.Length == 4 )
-			{
-				return ParseInt();
-			}
-			int yy = Int32.Parse( m_data );
-			if ( yy > 50 )
-			{
-				return yy + 1900;
-			}
-			return yy + 2000;
-		}
-
-		/// <summary>
-		/// Set a short date format (MMDDYY)
-		/// </summary>
-		/// <param name="dt">date</param>
-		public void SetDate( Date dt )
-		{
-			Debug.Assert( m_field.Length == 6 );
-			m_data = dt.Format("MMDDYY");
-		}
-
-		/// <summary>
-		/// Set a left justified integer, pad with the default fill
-		/// </summary>
-		/// <param name="i">int</param>
-		public void SetIntLeft( int i )
-		{
-			m_data = Right((m_field.DefaultData + i.ToString()), m_field.Length);
-			
-			Debug.Assert( m_data.Length == m_field.Length );
-			if ( m_data.Length != m_field.Length )
-			{
-				throw new Exception( m_field.Name + " incorrect length" );
-			}
-		}
-		
-		public void SetSignedIntLeft( int i )
-		{
-			char sign = '+';
-			if ( i < 0 )
-			{
-				sign = '-';
-				i = -i;
-			}
-			m_data = sign + Right(m_field.DefaultData + i.ToString(), m_field.Length-1);
-			Debug.Assert(m_data.Length == m_field.Length, "Assumption failure");
-
-			Debug.Assert( m_data.Length == m_field.Length );
-			if ( m_data.Length != m_field.Length )
-			{
-				throw new Exception( m_field.Name + " incorrect length" );
-			}
-		}
-
-		/// <summary>
-		/// Set the exact string.  The length must equal the field size.
-		/// </summary>
-		/// <param name="val">the data</param>
-		public void Set( string val )
-		{
-			Debug.Assert( val.Length == m_field.Length );
-			m_data = val;
-
-			Debug.Assert( m_data.Length == m_field.Length );
-			if ( m_data.Length != m_field.Length )
-			{
-				throw new Exception( m_field.Name + " incorrect length" );
-			}
-		}
-
-		/// <summary>
-		/// Set the field as tandem format money (+00000000000000;-00000000000000)
-		/// </summary>
-		/// <param name="val">money</param>
-		public void SetMoney( decimal val )
-		{
-			char sign = '+';
-			if ( val < 0 )
-			{
-				sign = '-';
-				val = -val;
-			}
-			m_data = sign + Right((m_field.DefaultData + val.ToString("#0.00").Replace(".", "")), m_field.Length-1);
-			Debug.Assert(m_data.Length == m_field.Length, "Assumption failure");
-
-			Debug.Assert( m_data.Length == m_field.Length );
-			if ( m_data.Length != m_field.Length )
-			{
-				throw new Exception( m_field.Name + " incorrect length" );
-			}
-		}
-
-		/// <summary>
-		/// Set left justified, padded with the default fill
-		/// </summary>
-		/// <param name="val">data</param>
-		public void SetLeft( string val )
-		{
-			m_data = Right((m_field.DefaultData + val), m_field.Length);
-
-			Debug.Assert( m_data.Length == m_field.Length );
-			if ( m_data.Length != m_field.Length )
-			{
-				throw new Exception( m_field.Name + " incorrect length" );
-			}
-		}
-
-		/// <summary>
-		/// format as YYYY-MM-DD:HH:NN:SS.000000
-		/// </summary>
-		/// <param name="dtm">date</param>
-		public void SetDateTime( DateTime dtm )
-		{
-			Debug.Assert( m_field.Length == 26, "Invalid field size" );
-			m_data = dtm.ToString("yyyy-MM-dd:HH:mm:ss.000000");
-			Debug.Assert( m_data.Length == 26 );
-
-			Debug.Assert( m_data.Length == m_field.Length );
-			if ( m_data.Length != m_field.Length )
-			{
-				throw new Exception( m_field.Name + " incorrect length" );
-			}
-		}
-
-		/// <summary>
-		/// format as YYYY-MM-DD:HH:NN:SS.000000
-		/// </summary>
-		/// <param name="dt"></param>
-		public void SetDateTime( Date dt )
-		{
-			Debug.Assert( m_field.Length == 26, "Invalid field size" );
-			m_data = dt.Year + "-" + dt.Month.ToString("00") + "-" + dt.Day.ToString("00") + ":00:00:00.000000";
-			Debug.Assert( m_data.Length == 26 );
-
-			Debug.Assert( m_data.Length == m_field.Length );
-			if ( m_data.Length != m_field.Length )
-			{
-				throw new Exception( m_field.Name + " incorrect length" );
-			}
-		}
-
-		/// <summary>
-		/// Left justify largish integer
-		/// </summary>
-		/// <param name="val"></param>
-		public void SetDecimal ( decimal val )
-		{
-			m_data = Right((m_field.DefaultData + val.ToString()), m_field.Length);
-
-			Debug.Assert( m_data.Length == m_field.Length );
-			if ( m_data.Length != m_field.Length )
-			{
-				throw new Exception( m_field.Name + " incorrect length" );
-			}
-		}
-
-		/// <summary>
-		/// Special handling for the cert id.  Certs are left justified if numeric,
-		/// right justified otherwise.
-		/// </summary>
-		/// <param name="val">cert id</param>
-		public void SetSpecial( string val )
-		{
-			val = val.Trim();
-			if ( val.Length == 0 )
-			{
-				m_data  = m_field.DefaultData;
-				return;
-			}
-			int ival = 0;
-			if ( IsNumeric( val, ref ival ) )
-			{
-				// left justify
-				SetIntLeft( ival );
-			}
-			else
-			{
-				// right justify
-				m_data = (val + m_field.DefaultData).Substring(0, m_field.Length);
-			}
-
-			Debug.Assert( m_data.Length == m_field.Length );
-			if ( m_data.Length != m_field.Length )
-			{
-				throw new Exception( m_field.Name + " incorrect length" );
-			}
-		}
-
-		/// <summary>
-		/// Is the string a numeric value?
-		/// </summary>
-		/// <param name="str">certid</param>
-		/// <param name="i">the value if numeric</param>
-		/// <returns></returns>
-		internal static bool IsNumeric( string str, ref int i )
-		{
-			try
-			{
-				i = Int32.Parse( str );
-				return true;
-			}
-			catch ( Exception *ex )
-			{
-				delete ex;
-				return false;
-			}
-		}
-
-		/// <summary>
-		/// Just like VB Right$
-		/// </summary>
-		/// <param name="str">the string</param>
-		/// <param name="len">lenght to return</param>
-		/// <returns></returns>
-		internal static string Right( string str, int len )
-		{
-			if ( str.Length <= len )
-			{
-				return str;
-			}
-			return str.Substring(str.Length - len);
-		}
-
-		/// <summary>
-		/// Return the substring right padded with spaces
-		/// </summary>
-		/// <param name="str">data</param>
-		/// <param name="start">start position</param>
-		/// <param name="len">length</param>
-		/// <returns></returns>
-		internal static string PadSubstring( string str, int start, int len )
-		{
-			if ( len + start > str.Length )
-			{
-				string part = str.Substring( start, str.Length - start );
-				return part + (new string( ' ', len - part.Length ));
-			}
-			return str.Substring( start, len );
-		}
-
-		/// <summary>
-		/// Strip leading zeros from a string
-		/// </summary>
-		/// <param name="str">the string</param>
-		/// <returns>the string without leading zeros</returns>
-		internal static string StripZeros( string str )
-		{
-			string ret = "";
-			bool copying = false;
-
-			for ( int x = 0; x < str.Length; x++ )
-			{
-				if ( !copying && str[x] == '0' )
-				{
-					ret += ' ';
-				}
-				else
-				{
-					copying = true;
-					ret += str[x];
-				}
-			}
-			return ret;
-		}
-
-		/// <summary>
-		/// Reset field to default value
-		/// </summary>
-		public void Reset()
-		{
-			m_data = m_field.DefaultData;
-			Debug.Assert( m_data.Length == m_field.Length );
-
-			if ( m_data.Length != m_field.Length )
-			{
-				throw new Exception( m_field.Name + " incorrect length" );
-			}
-		}
-
-		protected FixedFieldDef m_field;
-		protected string m_data;
+		m_def = rec.m_def;
+		m_data = rec.m_data;
+		return *this;
 	}
 
-	/// <summary>
-	/// The data contained in a fixed width record
-	/// </summary>
-	public class FixedRecord
+	inline const FixedRecordDef& Def() const { return *m_def; }
+
+	/** @brief The field's bytes, untrimmed. */
+	inline StringView GetView(int ordinal) const
 	{
-		/// <summary>
-		/// Initialize the record from the definition
-		/// </summary>
-		/// <param name="def"></param>
-		/// <param name="fields"></param>
-		public FixedRecord ( FixedRecordDef def, FixedFieldData[] fields )
-		{
-			m_recdef = def;
-			m_data = fields;
-		}
-
-		/// <summary>
-		/// Number of fields in the record
-		/// </summary>
-		public int Count
-		{
-			get
-			{
-				return m_data.Length;
-			}
-		}
-
-		/// <summary>
-		/// Data field by ordinal position
-		/// </summary>
-		public FixedFieldData this[ int index ]
-		{
-			get
-			{
-				return m_data[index];
-			}
-		}
-
-		/// <summary>
-		/// Data field by name
-		/// </summary>
-		public FixedFieldData this[ string name ]
-		{
-			get
-			{
-				return m_data[ m_recdef.GetFieldOrdinal( name ) ];
-			}
-		}
-
-		/// <summary>
-		/// Reset all fields to default values
-		/// </summary>
-		public void Reset()
-		{
-			for( int x = 0; x < m_data.Length; x++ )
-			{
-				m_data[x].Reset();
-			}
-		}
-
-		/// <summary>
-		/// Create the fixed text record
-		/// </summary>
-		/// <returns>Fixed text string</returns>
-		public override string ToString()
-		{
-			StringBuilder buf = new StringBuilder();
-			for( int x = 0; x < m_data.Length; x++ )
-			{
-				buf.Append( m_data[x].Value );
-			}
-			return buf.ToString() + "\r\n";
-		}
-
-		protected FixedRecordDef m_recdef;
-		protected FixedFieldData[] m_data;
+		const FixedFieldDef& fld = m_def->Field(ordinal);
+		return StringView(m_data, fld.m_offset, fld.m_length);
 	}
 
-*/
-				
+	/** @brief The field with spaces trimmed from the end. */
+	StringView GetText(int ordinal) const;
+
+	/** @brief True if the field is all spaces. */
+	bool IsBlank(int ordinal) const;
+
+	/** @brief Throws ParseException if the field isn't a number; a blank field is zero. */
+	int64 GetInt64(int ordinal) const;
+	inline int32 GetInt32(int ordinal) const { return (int32)GetInt64(ordinal); }
+
+	/** @brief The number with the field's implied decimal places applied. */
+	float64 GetFloat64(int ordinal) const;
+	Decimal GetDecimal(int ordinal) const;
+
+	/** @brief Reads the field in its date format; throws ParseException if it
+	 *	isn't a date.  A field with the default format is read as YYYYMMDD if it
+	 *	is 8 long, MMDDYY if it is 6 long, and with Date::Parse otherwise.
+	 */
+	Date GetDate(int ordinal) const;
+	DateTime GetDateTime(int ordinal) const;
+
+	/** @brief Appends the fields that aren't filler to rs's columns, in order,
+	 *	converting each to its column's type.
+	 */
+	void AppendTo(RecordSet& rs) const;
+};
+
+/** @brief Reads a file of fixed width records.  The file is mapped, and since
+ *	every record is the same length, records can be read at random and the
+ *	file is split into chunks of whole records that are loaded on several
+ *	threads.  Records may be followed by \\n or \\r\\n, which is detected from
+ *	the first record, or packed with no terminator.
+ *	<pre>
+ *	FixedRecordFile file("extract.dat", def);
+ *	RecordSetPtr rs = file.Load();
+ *	</pre>
+ *	@ref FixedRecordDef
+ */
+class FixedRecordFile : public IMemoryValidate
+{
+private:
+	// forbid copy constructor
+	inline FixedRecordFile(const FixedRecordFile& frf) {}
+	inline void operator =(const FixedRecordFile& frf) {}
+
+	MappedFilePtr m_file;
+	FixedRecordDefPtr m_def;
+	int m_stride;
+	int64 m_recordCount;
+	int m_threadCount;
+	int m_chunkRecords;
+
+	/** @brief Loads records [first, first + count) on the loader's threads, one record set per chunk. */
+	void LoadBatch(int64 first, int64 count, Vector<RecordSet *>& batch);
+
+public:
+	/** @brief Maps filename; throws IOException if it can't be opened or ends in a partial record. */
+	FixedRecordFile(const String& filename, FixedRecordDefPtr def);
+	virtual ~FixedRecordFile();
+
+	inline int64 RecordCount() const { return m_recordCount; }
+
+	/** @brief The record's length plus its terminator. */
+	inline int Stride() const { return m_stride; }
+
+	inline FixedRecord Record(int64 idx) const
+	{
+		ASSERT(idx >= 0 && idx < m_recordCount);
+		return FixedRecord(*m_def, &m_file->Data()[idx * m_stride]);
+	}
+
+	/** @brief Number of threads to load on; the default is the processor count. */
+	inline void SetThreadCount(int count) { m_threadCount = count < 1 ? 1 : count; }
+
+	/** @brief Records per chunk, which is the unit a thread loads; the default is 64K. */
+	inline void SetChunkRecords(int count) { m_chunkRecords = count < 1 ? 1 : count; }
+
+	/** @brief Loads every record into one record set, with a column per field that isn't filler. */
+	RecordSetPtr Load();
+
+	/** @brief Calls onBatch with each chunk's rows in file order, holding only
+	 *	one batch of chunks in memory at a time.
+	 */
+	void Load(FixedRecordBatchDelegatePtr onBatch);
+
+#if defined(DEBUG)
+	void CheckMem() const;
+	void ValidateMem() const;
+#endif
+};
+
+/** @} */
+}
+#endif
@@ -39,6 +39,13 @@ namespace spl
 	class IStream;
 	typedef RefCountPtr<IStream> IStreamPtr;
 
+	/** @brief One buffer of a gathered write, see IStream::WriteGather. */
+	typedef struct _StreamSegment
+	{
+		const byte *data;
+		int count;
+	} StreamSegment;
+
 	/** @brief Stream interface. */
 	class IStream : public IMemoryValidate
 	{
@@ -72,6 +79,12 @@ namespace spl
 		inline void Write(const Array<byte>& buffer) { Write(buffer, 0, buffer.Length()); }
 		virtual void WriteByte(byte value) = 0;
 
+		/** @brief Writes the segments in order as though they were one buffer.  The
+		 *	default copies them into one buffer for a single Write; socket streams
+		 *	send them with one writev.
+		 */
+		virtual void WriteGather(const StreamSegment *segments, const int segmentCount);
+
 		virtual bool CanRead() const = 0;
 		virtual bool CanSeek() const = 0;
 		virtual bool CanWrite() const = 0;
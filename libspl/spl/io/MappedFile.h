@@ -0,0 +1,81 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _mappedfile_h
+#define _mappedfile_h
+
+#include <spl/types.h>
+#include <spl/Debug.h>
+#include <spl/Memory.h>
+#include <spl/RefCountPtr.h>
+#include <spl/String.h>
+
+namespace spl
+{
+/**
+ * @defgroup file File System
+ * @ingroup io
+ * @{
+ */
+
+class MappedFile;
+typedef RefCountPtr<MappedFile> MappedFilePtr;
+
+REGISTER_TYPEOF( 416, MappedFilePtr );
+
+/** @brief A read only view of a whole file.
+ *	Where HAVE_SYS_MMAN_H is defined the file is mapped, so pages are read on
+ *	demand and can be dropped again under memory pressure; elsewhere the file
+ *	is read into memory.
+ */
+class MappedFile : public IMemoryValidate
+{
+private:
+	// forbid copy constructor
+	inline MappedFile(const MappedFile& mf) {}
+	inline void operator =(const MappedFile& mf) {}
+
+	byte *m_data;
+	int64 m_length;
+	bool m_mapped;
+
+public:
+	/** @brief Throws IOException if the file can't be opened. */
+	MappedFile(const String& filename);
+	virtual ~MappedFile();
+
+	/** @brief The file's bytes, or NULL for an empty file. */
+	inline const byte *Data() const { return m_data; }
+	inline int64 Length() const { return m_length; }
+	inline bool IsMapped() const { return m_mapped; }
+
+	/** @brief Hints that the range will be read soon, so the OS can read ahead. */
+	void WillNeed(int64 offset, int64 len);
+
+	/** @brief Hints that the range won't be read again, so its pages can be dropped. */
+	void DontNeed(int64 offset, int64 len);
+
+#if defined(DEBUG)
+	void CheckMem() const;
+	void ValidateMem() const;
+#endif
+};
+
+REGISTER_TYPEOF( 418, MappedFile );
+
+/** @} */
+}
+#endif
@@ -61,6 +61,7 @@ public:
 	virtual long Seek(const long offset, const SeekOrigin origin);
 	virtual void Write(const Array<byte>& buffer, const int offset, const int count);
 	virtual void WriteByte(byte value);
+	virtual void WriteGather(const StreamSegment *segments, const int segmentCount);
 
 	virtual bool CanRead() const;
 	virtual bool CanSeek() const;
@@ -70,6 +70,9 @@ public:
 	/** Write a byte; whether this blocks or not depends on the underlying stream. */
 	virtual void WriteByte(byte value);
 
+	/** Copies small segments into the buffer; large writes are flushed through to the underlying stream's WriteGather. */
+	virtual void WriteGather(const StreamSegment *segments, const int segmentCount);
+
 	virtual bool CanRead() const;
 	virtual bool CanSeek() const;
 	virtual bool CanWrite() const;
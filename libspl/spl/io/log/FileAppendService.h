@@ -18,39 +18,129 @@
 #define _fileappendservice_h
 
 #include <spl/Memory.h>
-#include <spl/collection/Queue.h>
+#include <spl/collection/Array.h>
+#include <spl/collection/RingQueue.h>
 #include <spl/String.h>
-#include <spl/io/TextStream.h>
+#include <spl/threading/InterlockCounter.h>
 #include <spl/threading/ThreadStartDelegate.h>
 
 namespace spl
 {
+	/// Bytes buffered before the writer thread writes them to the file.
+	#define FILE_APPEND_FLUSH_BYTES (64 * 1024)
+	/// Longest time a line waits in memory before it's written.
+	#define FILE_APPEND_FLUSH_MS 250
+	/// Lines waiting for the writer thread before WriteLine starts dropping them.
+	#define FILE_APPEND_MAX_QUEUED 16384
+
 	class FileAppendService;
 	typedef RefCountPtr<FileAppendService> FileAppendServicePtr;
 	typedef WeakReference<FileAppendService, FileAppendServicePtr> FileAppendServiceRef;
 
+	/** @brief Appends lines to a file from a background thread.
+	 *	WriteLine only puts the line on a RingQueue, without taking a lock.  The
+	 *	writer thread keeps the file open, drains the queued lines in batches,
+	 *	and writes them through a buffer that
+	 *	is flushed when it's full or FlushInterval ms have passed.  The file can
+	 *	be rotated on size or age; rotated files are named file.1 (newest) to
+	 *	file.N.
+	 */
 	class FileAppendService : public IMemoryValidate
 	{
+	public:
+		/// When the file is fsync'ed.
+		enum FsyncPolicy
+		{
+			FSYNC_NEVER,		///< Leave it to the OS.
+			FSYNC_ON_FLUSH,		///< After every buffer flush.
+			FSYNC_ON_ROTATE		///< Before a file is rotated or closed.
+		};
+
 	private:
-		bool m_running;
+		volatile bool m_running;
 		String m_fileName;
-		//TextWriterPtr m_out;
 		RefCountPtr<ThreadStartDelegate<FileAppendService> > m_thread;
-		Queue<String> m_q;
 
-		inline FileAppendService(const FileAppendService&) {}
+		RingQueue<String> m_ring;
+
+		int m_fd;
+		Array<byte> m_buf;
+		int m_bufLen;
+		int m_bufLines;
+		int64 m_fileBytes;
+		int64 m_fileOpened;
+		int64 m_lastFlush;
+		int64 m_now;
+
+		volatile int m_flushBytes;
+		volatile int m_flushMs;
+		volatile FsyncPolicy m_fsync;
+		volatile int64 m_rotateBytes;
+		volatile int m_rotateSeconds;
+		volatile int m_rotateKeep;
+
+		InterlockCounter m_written;
+		InterlockCounter m_dropped;
+		volatile int64 m_bytesWritten;
+		volatile int m_flushes;
+		volatile int m_rotations;
+
+		inline FileAppendService(const FileAppendService&) : m_ring(1) {}
 		inline FileAppendService& operator =(const FileAppendService&) {throw Exception();}
 
 		void Run();
+		void OpenFile();
+		void CloseFile();
+		void Append(const String& line);
+		void WriteFile(const byte *data, int len);
+		void Flush();
+		void Sync();
+		void Rotate();
+		bool RotateDue(int len) const;
 
 	public:
-		FileAppendService(const String& fileName);
+		FileAppendService(const String& fileName, int maxQueued = FILE_APPEND_MAX_QUEUED);
 		virtual ~FileAppendService();
 
+		/// @brief Writes the queued lines, closes the file and waits for the writer thread to exit.
 		void Stop();
 
+		/// @brief Queues a line, or drops it if MaxQueued lines are already waiting.
 		void WriteLine(const String& line);
 
+		inline const String& FileName() const { return m_fileName; }
+
+		/// @brief Write the buffer once it holds this many bytes.
+		inline void SetFlushBytes(int bytes) { m_flushBytes = bytes; }
+		inline int FlushBytes() const { return m_flushBytes; }
+
+		/// @brief Write buffered lines at least this often.
+		inline void SetFlushInterval(int ms) { m_flushMs = ms; }
+		inline int FlushInterval() const { return m_flushMs; }
+
+		inline void SetFsyncPolicy(FsyncPolicy policy) { m_fsync = policy; }
+		inline FsyncPolicy GetFsyncPolicy() const { return m_fsync; }
+
+		/// @brief Rotate before the file grows past bytes (0 to disable).
+		inline void SetRotateBytes(int64 bytes) { m_rotateBytes = bytes; }
+		/// @brief Rotate once the file has been open this long (0 to disable).
+		inline void SetRotateSeconds(int seconds) { m_rotateSeconds = seconds; }
+		/// @brief Number of rotated files to keep.
+		inline void SetRotateKeep(int count) { m_rotateKeep = count; }
+
+		/// @brief The maxQueued passed to the constructor, rounded up to a power of two.
+		inline int MaxQueued() const { return m_ring.Capacity(); }
+
+		/// @brief Lines waiting to be written.
+		inline int QueuedCount() { return m_ring.Count(); }
+		/// @brief Lines written to the file (they may still be in the OS cache).
+		inline int WrittenCount() { return m_written.Get(); }
+		/// @brief Lines dropped because the queue was full or the service stopped.
+		inline int DroppedCount() { return m_dropped.Get() + m_ring.DroppedCount(); }
+		inline int64 BytesWritten() const { return m_bytesWritten; }
+		inline int FlushCount() const { return m_flushes; }
+		inline int RotationCount() const { return m_rotations; }
+
 	#if defined(DEBUG)
 		void CheckMem() const;
 		void ValidateMem() const;
@@ -17,6 +17,7 @@
 #ifndef _threadedlog_h
 #define _threadedlog_h
 
+#include <spl/collection/RingQueue.h>
 #include <spl/io/log/Log.h>
 #include <spl/threading/ThreadStartDelegate.h>
 #include <spl/net/UdpServer.h>
@@ -24,15 +25,18 @@
 
 namespace spl
 {
+	/// Log entries waiting for the relay thread before new ones are dropped.
+	#define THREADED_LOG_RELAY_SIZE 4096
+
 	class ThreadedLog : public Log
 	{
 	private:
 		bool m_running;
 		FileAppendServicePtr m_file;
-		Queue<Log::LogEntry> m_relay;
+		RingQueue<Log::LogEntry> m_relay;
 		ThreadStartDelegate<ThreadedLog> m_thread;
 
-		inline ThreadedLog(const ThreadedLog& tl) : Log() {}
+		inline ThreadedLog(const ThreadedLog& tl) : Log(), m_relay(1) {}
 		inline ThreadedLog& operator =(const ThreadedLog& tl) {throw Exception();}
 
 		void Run();
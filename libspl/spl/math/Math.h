@@ -56,6 +56,8 @@ namespace spl
 	#define tanhf tanh
 	#endif
 
+	class StringView;
+
 	/**
 	 *	@brief Static class for math functions.
 	 *	Besides cross platform issues, this also address version issues in MSVC.
@@ -202,11 +204,11 @@ namespace spl
 		static bool IsPrime( const int n );
 		static int NextPrime( const int n );
 		
-		inline static int32 Hash( const int64 i ) { return (int32)((i >> 32) ^ (i && 0XFFFFFFFF)); }
+		inline static int32 Hash( const int64 i ) { return (int32)((i >> 32) ^ (i & 0XFFFFFFFF)); }
 		inline static int32 Hash( const int32 i ) { return i; }
 		inline static int32 Hash( const int16 i ) { return i | (i << 16); }
 		inline static int32 Hash( const int8 i ) { return i | (i << 8) | (i << 16) | (i << 24); }
-		inline static int32 Hash( const uint64 i ) { return (int32)((i >> 32) ^ (i && 0XFFFFFFFF)); }
+		inline static int32 Hash( const uint64 i ) { return (int32)((i >> 32) ^ (i & 0XFFFFFFFF)); }
 		inline static int32 Hash( const uint32 i ) { return (int32)i; }
 		inline static int32 Hash( const uint16 i ) { return i | (i << 16); }
 		inline static int32 Hash( const uint8 i ) { return i | (i << 8) | (i << 16) | (i << 24); }
@@ -214,6 +216,10 @@ namespace spl
 		static uint32 Hash( const float64 i );
 		static uint32 Hash( const char *cp );
 		static uint64 HashLong( const char *cp );
+		/// @brief Hashes at most len characters; stops early at a null, so it agrees with Hash(cp).
+		static uint32 Hash( const char *cp, const int len );
+		static uint64 HashLong( const char *cp, const int len );
+		static uint32 Hash( const StringView& sv );
 		static uint32 Hash( const IHashable& i );
 		static uint32 Hash( const IHashable *i );
 	};
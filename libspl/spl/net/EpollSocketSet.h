@@ -0,0 +1,103 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _epollsocketset_h
+#define _epollsocketset_h
+
+#include <spl/types.h>
+#include <spl/Debug.h>
+
+#ifdef HAVE_SYS_EPOLL_H
+
+#include <sys/epoll.h>
+
+#include <spl/collection/Array.h>
+#include <spl/collection/Hashtable.h>
+#include <spl/net/SocketSet.h>
+#include <spl/threading/Mutex.h>
+#include <spl/threading/Thread.h>
+
+namespace spl
+{
+/**
+ * @defgroup socket Sockets
+ * @ingroup network
+ * @{
+ */
+
+/// Maximum number of ready events returned by one epoll_wait().
+#define EPOLLSS_MAX_EVENTS 256
+
+class EpollSocketSet;
+typedef RefCountPtrCast<EpollSocketSet, ISocketService, ISocketServicePtr> EpollSocketSetPtr;
+
+REGISTER_TYPEOF(52, EpollSocketSetPtr);
+
+/** @brief A threaded, edge-triggered epoll() IO dispatcher.
+ *	Has the same contract as SocketSet, but the cost of a wakeup is proportional
+ *	to the number of ready sockets instead of the number of registered sockets,
+ *	and there is no FD_SETSIZE limit.
+ */
+class EpollSocketSet : public ISocketService, public Thread
+{
+private:
+	// Copy constructor doesn't make sense for this class
+	inline EpollSocketSet(const EpollSocketSet& ss) : Thread() {}
+	inline void operator =(const EpollSocketSet& s) {}
+
+protected:
+	Array<byte> m_buf;
+	Hashtable<int, SocketListenerPair *> m_fds;
+	struct epoll_event m_events[EPOLLSS_MAX_EVENTS];
+	int m_epfd;
+	int m_wakefds[2];
+
+	Mutex m_fdsMutex;
+	volatile bool m_running;
+
+	void Wake();
+	void WaitForIO();
+	void DispatchRead( SocketListenerPair *pair, uint32 events );
+	void RemoveSocket( SocketListenerPair *pair );
+	void CloseAll();
+	void Run();
+
+public:
+	EpollSocketSet(  );
+	virtual ~EpollSocketSet();
+
+	virtual void AddSocket( IStreamReadListenerPtr listener, TcpSocketPtr sp );
+	virtual void Close();
+	virtual void CloseAndDelete();
+	virtual int SocketCount() const;
+	void Broadcast( const Array<byte>& buf, const int len );
+
+	virtual void Join(int timeoutms);
+	virtual void Join();
+
+#if defined(DEBUG) || defined(_DEBUG)
+	virtual void CheckMem() const;
+	virtual void ValidateMem() const;
+#endif
+};
+
+REGISTER_TYPEOF(54, EpollSocketSet);
+
+/** @} */
+}
+
+#endif
+#endif
@@ -27,6 +27,7 @@
 #include <spl/Memory.h>
 #include <spl/RefCountPtr.h>
 #include <spl/String.h>
+#include <spl/StringView.h>
 #include <spl/net/Socket.h>
 #include <spl/io/Stream.h>
 #include <spl/io/StreamReadPump.h>
@@ -45,25 +46,153 @@ typedef RefCountPtr<Packet> PacketPtr;
 
 REGISTER_TYPEOF(20, PacketPtr);
 
+/** @brief Frame formats written by Packet::SendPacket. */
+typedef enum _PacketWireVersion
+{
+	PACKET_WIRE_V1 = 1,		//< 3 byte header with a 16 bit frame size; fixed width integers.
+	PACKET_WIRE_V2 = 2		//< 5 byte header with a 32 bit payload size; varint integers and lengths.
+} PacketWireVersion;
+
+/** @brief First byte of a v2 frame.  v1 frames start with their byte order, 0 or 1. */
+#define PACKET_V2_MARK 0xF2
+#define PACKET_V1_HEADER_SIZE 3
+#define PACKET_V2_HEADER_SIZE 5
+
+/** @brief Frames with a larger payload are rejected as corrupt when read. */
+#define PACKET_MAX_READ_SIZE (64 * 1024 * 1024)
+
+/** @brief Reads the header at data, which holds len bytes.  Returns the frame's
+ *	size including the header, or -1 if more than len bytes are needed to tell,
+ *	in which case headerLen is set to the number needed.  Throws
+ *	ProtocolException if the header is invalid.
+ */
+int PacketFrameHeader(const byte *data, int len, int& headerLen, PacketWireVersion& version, bool& revbytes);
+
+/** @brief A read only window on bytes in a packet frame. */
+class PacketBytesView
+{
+private:
+	const byte *m_data;
+	int m_len;
+
+public:
+	inline PacketBytesView() : m_data(NULL), m_len(0) {}
+	inline PacketBytesView(const byte *data, int len) : m_data(data), m_len(len) {}
+	inline PacketBytesView(const PacketBytesView& v) : m_data(v.m_data), m_len(v.m_len) {}
+	inline PacketBytesView& operator =(const PacketBytesView& v) { m_data = v.m_data; m_len = v.m_len; return *this; }
+
+	inline const byte *Data() const { return m_data; }
+	inline int Length() const { return m_len; }
+	inline byte operator[] (const int idx) const { ASSERT(idx >= 0 && idx < m_len); return m_data[idx]; }
+};
+
+/** @brief A typed cursor over the payload of one frame, in a buffer owned by
+ *	someone else.  Each Next call checks the value's type tag, converts it in
+ *	place and moves past it; strings and binary data are returned as views, so
+ *	reading a frame doesn't allocate.  Throws PacketReadTypeMismatchException if
+ *	the next value has a different type, and PacketUnderflowException at the
+ *	end of the frame.
+ *	@ref PacketFrameBuilder
+ */
+class PacketFrame
+{
+private:
+	const byte *m_data;
+	int m_len;
+	int m_pos;
+	PacketWireVersion m_version;
+	bool m_revbytes;
+
+	inline byte _Next() { if (m_pos >= m_len) throw new PacketUnderflowException(); return m_data[m_pos++]; }
+	int16 _NextRaw16();
+	int32 _NextRaw32();
+	uint64 _NextVarintLong();
+	inline uint64 _NextVarint() { return m_pos < m_len && 0 == (m_data[m_pos] & 0x80) ? m_data[m_pos++] : _NextVarintLong(); }
+	const byte *_NextSpan(int len);
+
+public:
+	inline PacketFrame()
+	: m_data(NULL), m_len(0), m_pos(0), m_version(PACKET_WIRE_V2), m_revbytes(false)
+	{
+	}
+
+	/** @brief payload is the frame's bytes after its header. */
+	inline PacketFrame(const byte *payload, int len, PacketWireVersion version, bool revbytes)
+	: m_data(payload), m_len(len), m_pos(0), m_version(version), m_revbytes(revbytes)
+	{
+	}
+
+	inline PacketFrame(const PacketFrame& frame)
+	: m_data(frame.m_data), m_len(frame.m_len), m_pos(frame.m_pos), m_version(frame.m_version), m_revbytes(frame.m_revbytes)
+	{
+	}
+
+	inline PacketFrame& operator =(const PacketFrame& frame)
+	{
+		m_data = frame.m_data;
+		m_len = frame.m_len;
+		m_pos = frame.m_pos;
+		m_version = frame.m_version;
+		m_revbytes = frame.m_revbytes;
+		return *this;
+	}
+
+	inline PacketWireVersion Version() const { return m_version; }
+	inline bool IsReversed() const { return m_revbytes; }
+	inline const byte *Payload() const { return m_data; }
+	inline int Length() const { return m_len; }
+	inline int Position() const { return m_pos; }
+	inline void SetPosition(int pos) { ASSERT(pos >= 0 && pos <= m_len); m_pos = pos; }
+	inline bool HasNext() const { return m_pos < m_len; }
+
+	/** @brief The next value's type tag, such as 'i' or 'I' for an int32, without moving past it. */
+	inline char PeekType() const { if (m_pos >= m_len) throw new PacketUnderflowException(); return (char)m_data[m_pos]; }
+
+	int64 NextInt64();
+	int32 NextInt32();
+	int16 NextInt16();
+	byte NextInt8();
+	bool NextBool();
+	double NextDouble();
+	DateTime NextDateTime();
+	Date NextDate();
+
+	/** @brief The string's characters in the frame; only valid while the frame's buffer is. */
+	StringView NextStringView();
+	/** @brief A copy of the next string, which may also use v1's wide character sizes. */
+	StringPtr NextString();
+	/** @brief The binary data in the frame; only valid while the frame's buffer is. */
+	PacketBytesView NextBytesView();
+
+	/** @brief Moves past the next value, whatever its type. */
+	void Skip();
+};
+
 /** @brief Endian aware network packet interface.
   *
+  *	Each value is written with a one character type tag.  Version 2 frames
+  *	(the default) write int32 and int64 as zigzag varints and string and raw
+  *	lengths as varints, and have a 32 bit frame size.  Version 1 frames are
+  *	limited to 32K and are only written after SetWireVersion(PACKET_WIRE_V1),
+  *	for peers that haven't been upgraded.  ReadPacket accepts either version.
   */
 class Packet : public IMemoryValidate
 {
 protected:
-	Array<byte> m_abuf;
-	Vector<byte> m_buf;
+	Array<byte> m_abuf;				//< Payload of the last frame read.
+	Vector<byte> m_buf;				//< Payload being built for SendPacket.
+	PacketWireVersion m_version;
 	bool m_readPacketReady;
-	int m_readpos;
-	bool m_readRevByteOrder;
-	int16 m_rpacketsize;
+	int32 m_rpacketsize;
+	PacketFrame m_frame;			//< Cursor over m_abuf.
 
-	inline byte _NextByte() { if (m_readpos >= m_buf.Count()) throw new PacketUnderflowException(); return m_buf.ElementAt(m_readpos++); }
+	inline PacketFrame& _ReadFrame() { if ( ! m_readPacketReady ) throw new PacketNotReadyException("Packet must be in read state to get size"); return m_frame; }
 
 	void _AppendRaw( byte i );
 	void _AppendRaw( int16 i );
 	void _AppendRaw( int32 i );
 	void _AppendRaw( int64 i );
+	void _AppendVarint( uint64 i );
 
 public:
 	Packet();
@@ -72,10 +201,34 @@ public:
 
 	Packet& operator =(const Packet& pkt);
 
+	/** @brief The version SendPacket writes; Append writes values in this version's encoding, so set it first. */
+	inline void SetWireVersion(PacketWireVersion version) { ASSERT(0 == m_buf.Count()); m_version = version; }
+	inline PacketWireVersion WireVersion() const { return m_version; }
+
+	/** @brief The version of the frame last read. */
+	inline PacketWireVersion ReadWireVersion() const { return m_frame.Version(); }
+
+	/** @brief The cursor the Read methods use, over the frame last read. */
+	inline PacketFrame& Frame() { return _ReadFrame(); }
+
 	void Clear();
+
+	/** @brief Sends the header and payload with one gathered write. */
 	void SendPacket(spl::IStream& sock);
+
+	/** @brief Reads one frame of either version.  The header is read in one or two
+	 *	bulk reads and the payload in one, so wrap unbuffered streams in a
+	 *	StreamBuffer when frames are small.
+	 */
 	void ReadPacket(spl::IStream& sock);
 
+	/** @brief Writes the frame header for the current payload to header, which must
+	 *	hold PACKET_V2_HEADER_SIZE bytes, and returns its length.
+	 */
+	int FrameHeader(byte *header) const;
+	inline const byte *Payload() const { return m_buf.Data(); }
+	inline int PayloadSize() const { return m_buf.Count(); }
+
 	void Append(int64 i);
 	void Append(int32 i);
 	void Append(int16 i);
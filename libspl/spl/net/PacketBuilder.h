@@ -33,7 +33,9 @@ typedef RefCountPtrCast<PacketBuilder, IStreamReadListener, IStreamReadListenerP
 
 REGISTER_TYPEOF(30, PacketBuilderPtr);
 
-/** @brief Allows automatic construction of packets from a stream.
+/** @brief Allows automatic construction of packets from a stream.  Frames of
+ *	either wire version are accepted, and each value is dispatched to the
+ *	listeners as soon as its last byte arrives.
  */
 class PacketBuilder : public IStreamReadListener
 {
@@ -43,10 +45,14 @@ protected:
 		PKT_ENDIAN,
 		PKT_SIZE_MCB,
 		PKT_SIZE_LCB,
+		PKT_V2_SIZE,
 		PKT_DT,
 		PKT_DT_LEN_MCB,
 		PKT_DT_LEN_LCB,
+		PKT_DT_LEN8,
+		PKT_DT_VARLEN,
 		PKT_CHARSIZE,
+		PKT_VARINT,
 		PKT_DATA,
 		PKT_ERROR,
 		PKT_CLOSED
@@ -57,13 +63,17 @@ protected:
 
 	bool m_isLittleEndian;
 	bool m_revbytes;
-	int16 m_pktsize;
+	int32 m_pktsize;
 	char m_datatype;
-	int16 m_datalen;
+	int32 m_datalen;
 	int8 m_charsize;
+	uint64 m_varint;
+	int m_varshift;
 	Vector<byte> m_buf;
 	int m_readPos;
 
+	/** @brief Dispatches the value now if it's empty, otherwise waits for its bytes. */
+	void _BeginData();
 	void _ParseData();
 	StringPtr _ParseString();
 
@@ -85,6 +95,73 @@ public:
 
 REGISTER_TYPEOF(32, PacketBuilder);
 
+class IPacketFrameListener;
+typedef RefCountPtr<IPacketFrameListener> IPacketFrameListenerPtr;
+
+REGISTER_TYPEOF(409, IPacketFrameListenerPtr);
+
+/** @brief Receives whole frames from a PacketFrameBuilder. */
+class IPacketFrameListener
+{
+public:
+	IPacketFrameListener() {}
+	virtual ~IPacketFrameListener();
+
+	/** @brief The frame's bytes are only valid until this returns. */
+	virtual void IPacketFrame_OnFrame(PacketFrame& frame) = 0;
+
+	virtual void IStreamRead_OnError(const String& msg) = 0;
+	virtual void IStreamRead_OnClose() = 0;
+};
+
+class PacketFrameBuilder;
+typedef RefCountPtrCast<PacketFrameBuilder, IStreamReadListener, IStreamReadListenerPtr> PacketFrameBuilderPtr;
+
+REGISTER_TYPEOF(413, PacketFrameBuilderPtr);
+
+/** @brief Splits a stream into frames of either wire version and hands each
+ *	one to the listener as a PacketFrame, which reads the values in place.
+ *	Unlike PacketBuilder, nothing is allocated per value and there is one
+ *	virtual call per frame rather than a delegate dispatch per value.  Frames
+ *	that arrive whole in one read are passed straight from the read buffer;
+ *	only frames split across reads are copied.
+ */
+class PacketFrameBuilder : public IStreamReadListener
+{
+private:
+	// forbid copy constructor
+	inline PacketFrameBuilder(const PacketFrameBuilder& pb) {}
+	inline void operator =(const PacketFrameBuilder& pb) {}
+
+protected:
+	IPacketFrameListener *m_listener;
+	Vector<byte> m_pending;
+	int64 m_frames;
+
+	void _Dispatch(const byte *data, int size, int headerLen, PacketWireVersion version, bool revbytes);
+	void _Split(const byte *data, int len);
+
+	virtual void IStreamRead_OnRead(const Array<byte>& buf, int len);
+	virtual void IStreamRead_OnError(const String& msg);
+	virtual void IStreamRead_OnClose();
+
+public:
+	PacketFrameBuilder(IPacketFrameListener *listener);
+	virtual ~PacketFrameBuilder();
+
+	/** @brief Frames dispatched so far. */
+	inline int64 FrameCount() const { return m_frames; }
+	/** @brief Bytes of a split frame waiting for the rest of it. */
+	inline int PendingCount() const { return m_pending.Count(); }
+
+#if defined(DEBUG) || defined(_DEBUG)
+	virtual void CheckMem() const;
+	virtual void ValidateMem() const;
+#endif
+};
+
+REGISTER_TYPEOF(415, PacketFrameBuilder);
+
 /** @} */
 }
 #endif
@@ -0,0 +1,174 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _packetsendqueue_h
+#define _packetsendqueue_h
+
+#include <spl/types.h>
+#include <spl/Debug.h>
+#include <spl/Memory.h>
+#include <spl/RefCountPtr.h>
+#include <spl/collection/Vector.h>
+#include <spl/io/IStream.h>
+#include <spl/net/Packet.h>
+#include <spl/threading/Mutex.h>
+#include <spl/threading/ThreadStartDelegate.h>
+
+namespace spl
+{
+/**
+ * @defgroup packet Packets
+ * @ingroup network
+ * @{
+ */
+
+/// Bytes queued before Send writes them without waiting for Flush.
+#define PACKET_SEND_FLUSH_BYTES (16 * 1024)
+/// Longest time a queued packet waits for Flush before the timer writes it.
+#define PACKET_SEND_FLUSH_MS 5
+
+class PacketSendQueue;
+typedef RefCountPtr<PacketSendQueue> PacketSendQueuePtr;
+
+class PacketSendTimer;
+typedef RefCountPtr<PacketSendTimer> PacketSendTimerPtr;
+
+REGISTER_TYPEOF( 405, PacketSendQueuePtr );
+REGISTER_TYPEOF( 407, PacketSendTimerPtr );
+
+/** @brief Corks a connection's outgoing packets so that many small ones go out
+ *	in one write.  Send copies the packet's frame into a buffer, which is
+ *	written when Flush is called (at the end of a response, say), when it holds
+ *	FlushBytes, or once the oldest packet has waited MaxLatency ms.  Packets
+ *	too big to be worth copying are written straight away, gathered with
+ *	whatever is queued ahead of them.  Nothing waits on the socket's own
+ *	coalescing, so TCP_NODELAY can stay on.
+ *	<pre>
+ *	PacketSendQueue q(sock->GetStream());
+ *	for (...) { pkt.Clear(); ...; q.Send(pkt); }
+ *	q.Flush();
+ *	</pre>
+ *	Send and Flush can be called from several threads.  The latency limit is
+ *	only checked by Send unless the queue is added to a PacketSendTimer.
+ */
+class PacketSendQueue : public IMemoryValidate
+{
+private:
+	// forbid copy constructor
+	inline PacketSendQueue(const PacketSendQueue& q) {}
+	inline void operator =(const PacketSendQueue& q) {}
+
+	mutable Mutex m_lock;
+	spl::IStreamPtr m_strm;
+	Vector<byte> m_buf;
+	int m_bufPackets;
+	int64 m_firstQueued;
+	int m_flushBytes;
+	int m_maxLatencyMs;
+	PacketSendTimer *m_timer;
+
+	int64 m_packets;
+	int64 m_writes;
+	int64 m_bytes;
+	int m_timerFlushes;
+
+	/// @brief Writes the buffer, plus extra if it isn't NULL; m_lock must be held.
+	void _Write(const StreamSegment *extra, int extraCount);
+
+	friend class PacketSendTimer;
+
+public:
+	PacketSendQueue(spl::IStreamPtr strm, int flushBytes = PACKET_SEND_FLUSH_BYTES, int maxLatencyMs = PACKET_SEND_FLUSH_MS);
+	/// @brief Flushes, and leaves the timer if the queue was added to one.
+	virtual ~PacketSendQueue();
+
+	/// @brief Queues the packet's frame; the packet can be cleared and reused straight away.
+	void Send(const Packet& pkt);
+
+	/// @brief Writes everything queued in one write.
+	void Flush();
+
+	/// @brief Flushes if the oldest queued packet has waited MaxLatency ms as of now (in ms).
+	bool FlushIfDue(int64 now);
+
+	inline void SetFlushBytes(int bytes) { m_flushBytes = bytes; }
+	inline int FlushBytes() const { return m_flushBytes; }
+
+	/// @brief 0 leaves packets queued until Flush or FlushBytes.
+	inline void SetMaxLatency(int ms) { m_maxLatencyMs = ms; }
+	inline int MaxLatency() const { return m_maxLatencyMs; }
+
+	/// @brief Packets waiting to be written.
+	int QueuedCount() const;
+	/// @brief Packets written so far.
+	int64 PacketCount() const;
+	/// @brief Writes (send system calls) issued.
+	int64 WriteCount() const;
+	int64 BytesWritten() const;
+	/// @brief Flushes made by the timer because a packet had waited MaxLatency ms.
+	int TimerFlushCount() const;
+	double PacketsPerWrite() const;
+
+	/// @brief The time in ms used by the latency checks.
+	static int64 NowMs();
+
+#if defined(DEBUG)
+	void CheckMem() const;
+	void ValidateMem() const;
+#endif
+};
+
+/** @brief One thread that flushes the PacketSendQueues added to it once their
+ *	oldest packet has waited MaxLatency ms, so a server with many connections
+ *	doesn't need a timer thread per connection.  The timer must outlive its
+ *	queues: remove or delete every queue before deleting the timer.
+ */
+class PacketSendTimer : public IMemoryValidate
+{
+private:
+	// forbid copy constructor
+	inline PacketSendTimer(const PacketSendTimer& t) {}
+	inline void operator =(const PacketSendTimer& t) {}
+
+	Mutex m_lock;
+	Vector<PacketSendQueue *> m_queues;
+	volatile bool m_running;
+	int m_tickMs;
+	RefCountPtr<ThreadStartDelegate<PacketSendTimer> > m_thread;
+
+	void Run();
+
+public:
+	/// @brief Checks the queues every tickMs ms.
+	PacketSendTimer(int tickMs = 1);
+	virtual ~PacketSendTimer();
+
+	/// @brief q is flushed by the timer until it's removed or deleted, which must happen before the timer is deleted.
+	void Add(PacketSendQueue *q);
+	void Remove(PacketSendQueue *q);
+
+	/// @brief Waits for the timer thread to exit; queued packets are left for their queues to flush.
+	void Stop();
+
+#if defined(DEBUG)
+	void CheckMem() const;
+	void ValidateMem() const;
+#endif
+};
+
+/** @} */
+}
+#endif
@@ -38,6 +38,8 @@ class PooledSocketSet;
 typedef RefCountPtrCast<PooledSocketSet, ISocketService, ISocketServicePtr> PooledSocketSetPtr;
 
 ///@brief Creates 64 SocketSets, each with its own thread -- performance should be close to windows IO completion ports.
+/// With SERVICE_EPOLL, each set is an EpollSocketSet and sockets go to the least loaded set.
+/// With SERVICE_REACTOR, a single ReactorSocketSet with poolSize workers is used.
 ///
 class PooledSocketSet : public ISocketService
 {
@@ -47,14 +49,15 @@ private:
 	inline void operator =(const PooledSocketSet& pss) {}
 
 protected:
-	Vector<SocketSetPtr> m_sets;
+	Vector<ISocketServicePtr> m_sets;
 	int m_socketCount;
 	Mutex m_setsMtx;
+	enum ServiceType m_type;
 
 	void RemoveSocket( TcpSocket& sp );
 
 public:
-	PooledSocketSet(int poolSize = 1024/FD_SETSIZE);
+	PooledSocketSet(int poolSize = 1024/FD_SETSIZE, enum ServiceType type = SERVICE_SELECT);
 	virtual ~PooledSocketSet();
 
 	virtual void AddSocket( IStreamReadListenerPtr listener, TcpSocketPtr sp );
@@ -99,7 +102,7 @@ protected:
 	virtual void IPortListener_OnStop();
 
 public:
-	PooledSocketServer(IServerConnectionFactory *conFactory, int serverPort, int poolSize = 1024/FD_SETSIZE);
+	PooledSocketServer(IServerConnectionFactory *conFactory, int serverPort, int poolSize = 1024/FD_SETSIZE, enum ServiceType type = SERVICE_SELECT);
 	virtual ~PooledSocketServer();
 
 	virtual void AddSocket( IStreamReadListenerPtr listener, TcpSocketPtr sp );
@@ -0,0 +1,237 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _reactorsocketset_h
+#define _reactorsocketset_h
+
+#include <spl/types.h>
+#include <spl/Debug.h>
+
+#ifdef HAVE_SYS_EPOLL_H
+
+#include <sys/epoll.h>
+
+#include <spl/collection/Array.h>
+#include <spl/collection/Hashtable.h>
+#include <spl/collection/List.h>
+#include <spl/collection/Vector.h>
+#include <spl/Memory.h>
+#include <spl/net/SocketSet.h>
+#include <spl/threading/InterlockCounter.h>
+#include <spl/threading/Mutex.h>
+#include <spl/threading/Semaphore.h>
+#include <spl/threading/Thread.h>
+
+namespace spl
+{
+/**
+ * @defgroup socket Sockets
+ * @ingroup network
+ * @{
+ */
+
+/// Maximum number of ready events returned by one reactor epoll_wait().
+#define REACTOR_MAX_EVENTS 256
+
+class ReactorSocketSet;
+
+///@brief A socket registered with a ReactorSocketSet (internal).
+class ReactorConnection : public IMemoryValidate
+{
+public:
+	IStreamReadListenerPtr m_listener;
+	TcpSocketPtr m_sp;
+	int m_fd;
+	int m_home;				///< Worker that normally runs this connection's reads.
+	uint32 m_events;		///< Events from the last epoll_wait().
+	uint32 m_gen;			///< Tells this connection's events from those of an earlier socket on the same fd.
+	bool m_busy;			///< Queued or being dispatched, so a worker owns it; guarded by m_connsMtx.
+
+	ReactorConnection(IStreamReadListenerPtr listener, TcpSocketPtr sp, int fd, int home, uint32 gen);
+	virtual ~ReactorConnection();
+
+#if defined(DEBUG) || defined(_DEBUG)
+	virtual void CheckMem() const;
+	virtual void ValidateMem() const;
+#endif
+};
+
+///@brief Waits for readiness on a share of a ReactorSocketSet's sockets (internal).
+class ReactorPoller : public Thread
+{
+private:
+	inline ReactorPoller(const ReactorPoller& p) : Thread() {}
+	inline void operator =(const ReactorPoller& p) {}
+
+protected:
+	ReactorSocketSet *m_reactor;
+	struct epoll_event m_events[REACTOR_MAX_EVENTS];
+	int m_epfd;
+	int m_wakefds[2];
+
+	void Run();
+
+public:
+	ReactorPoller(ReactorSocketSet *reactor);
+	virtual ~ReactorPoller();
+
+	/** @brief Starts watching conn; it is dispatched once, then must be re-armed. */
+	bool Register( ReactorConnection *conn );
+	/** @brief Re-enables readiness notification after a worker is done with conn. */
+	bool Rearm( ReactorConnection *conn );
+	void Unregister( ReactorConnection *conn );
+	/** @brief Interrupts epoll_wait(), used to shut down. */
+	void Wake();
+
+#if defined(DEBUG) || defined(_DEBUG)
+	virtual void CheckMem() const;
+	virtual void ValidateMem() const;
+#endif
+};
+
+///@brief Runs IStreamRead_OnRead callbacks for a ReactorSocketSet (internal).
+class ReactorWorker : public Thread
+{
+	friend class ReactorSocketSet;
+
+private:
+	inline ReactorWorker(const ReactorWorker& w) : Thread() {}
+	inline void operator =(const ReactorWorker& w) {}
+
+protected:
+	ReactorSocketSet *m_reactor;
+	int m_index;
+	Array<byte> m_buf;
+	/// Ready connections.  The owner takes the oldest from the tail,
+	/// thieves take the newest from the head.
+	List<ReactorConnection *> m_queue;
+	Mutex m_queueMtx;
+
+	void Run();
+
+public:
+	ReactorWorker(ReactorSocketSet *reactor, int index);
+	virtual ~ReactorWorker();
+
+	int QueueDepth();
+
+#if defined(DEBUG) || defined(_DEBUG)
+	virtual void CheckMem() const;
+	virtual void ValidateMem() const;
+#endif
+};
+
+typedef RefCountPtrCast<ReactorSocketSet, ISocketService, ISocketServicePtr> ReactorSocketSetPtr;
+
+REGISTER_TYPEOF(53, ReactorSocketSetPtr);
+
+/** @brief Reactor style IO dispatcher.
+ *	A few poller threads wait for readiness with epoll() and hand ready sockets
+ *	to a pool of worker threads, which call IStreamRead_OnRead.  Each socket
+ *	has a home worker; idle workers steal from busy ones, so a slow handler
+ *	only holds up its own socket.  Sockets are registered EPOLLONESHOT and
+ *	re-armed after their reads are dispatched, so callbacks for a socket never
+ *	run concurrently and are delivered in order.
+ */
+class ReactorSocketSet : public ISocketService
+{
+	friend class ReactorPoller;
+	friend class ReactorWorker;
+
+private:
+	// Copy constructor doesn't make sense for this class
+	inline ReactorSocketSet(const ReactorSocketSet& rs) {}
+	inline void operator =(const ReactorSocketSet& rs) {}
+
+protected:
+	Vector<ReactorPoller *> m_pollers;
+	Vector<ReactorWorker *> m_workers;
+	Hashtable<int, ReactorConnection *> m_conns;
+	Mutex m_connsMtx;
+	uint32 m_nextGen;
+
+	/// One permit per queued connection (plus one from construction).
+	Semaphore m_workAvail;
+	volatile bool m_running;
+
+	InterlockCounter m_queued;
+	InterlockCounter m_dispatched;
+	InterlockCounter m_steals;
+
+	inline ReactorPoller *PollerFor( ReactorConnection *conn ) const { return m_pollers.ElementAt(conn->m_fd % m_pollers.Count()); }
+
+	void Schedule( ReactorConnection *conn );
+	ReactorConnection *NextReady( int worker );
+	void Dispatch( ReactorConnection *conn, Array<byte>& buf );
+	/** @brief Hands conn back to its poller; false if it failed or conn was replaced by a new socket on its fd. */
+	bool RearmConnection( ReactorConnection *conn );
+	void RemoveConnection( ReactorConnection *conn );
+
+	inline bool IsCurrent( ReactorConnection *conn ) const
+	{
+		ReactorConnection *cur;
+		return m_conns.TryGet(conn->m_fd, cur) && cur == conn;
+	}
+	void CloseAll();
+
+public:
+	/** @param pollerCount Number of epoll threads.
+	 *  @param workerCount Number of threads running read callbacks.
+	 */
+	ReactorSocketSet( int pollerCount = 1, int workerCount = 4 );
+	virtual ~ReactorSocketSet();
+
+	virtual void AddSocket( IStreamReadListenerPtr listener, TcpSocketPtr sp );
+	virtual void Close();
+	virtual void CloseAndDelete();
+	virtual int SocketCount() const;
+	virtual void Broadcast( const Array<byte>& buf, const int len );
+
+	virtual void Join(int timeoutms);
+	virtual void Join();
+
+	inline int PollerCount() const { return m_pollers.Count(); }
+	inline int WorkerCount() const { return m_workers.Count(); }
+
+	/** @brief Number of ready sockets waiting for a worker. */
+	inline int QueueDepth() { return m_queued.Get(); }
+	/** @brief Number of ready sockets waiting in one worker's queue. */
+	inline int QueueDepth( int worker ) { return m_workers.ElementAt(worker)->QueueDepth(); }
+	/** @brief Number of times a socket's reads were dispatched to a worker. */
+	inline int DispatchCount() { return m_dispatched.Get(); }
+	/** @brief Number of dispatches run by a worker other than the socket's home worker. */
+	inline int StealCount() { return m_steals.Get(); }
+
+	/** @brief Steals as a fraction of dispatches. */
+	inline double StealRate()
+	{
+		int dispatched = m_dispatched.Get();
+		return 0 == dispatched ? 0.0 : (double)m_steals.Get() / (double)dispatched;
+	}
+
+#if defined(DEBUG) || defined(_DEBUG)
+	virtual void CheckMem() const;
+	virtual void ValidateMem() const;
+#endif
+};
+
+REGISTER_TYPEOF(55, ReactorSocketSet);
+
+/** @} */
+}
+
+#endif
+#endif
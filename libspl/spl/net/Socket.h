@@ -161,6 +161,16 @@ public:
 	inline void Send (const Array<byte>& data) { Send(data, data.Length()); }
 	inline void Send (const String& str) { Send(str.ToByteArray()); }
 
+	/** @brief Sends the segments in order with as few system calls as possible,
+	 *  using writev() where available.  Blocks until everything is sent.
+	 */
+	void SendGather (const StreamSegment *segments, const int segmentCount);
+
+	/** @brief Writes count bytes of a file starting at offset.  Uses sendfile() where
+	 *  available, so the data doesn't pass through user space.
+	 */
+	void SendFile (const String& filename, const long offset, const long count);
+
 	// returns bytes read
 	int Recv (Array<byte>& buf, const int offset, const int blen);   ///< pull data from sock.
 	inline int Recv (Array<byte>& buf, const int blen) { return Recv(buf, 0, blen); }
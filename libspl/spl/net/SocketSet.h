@@ -44,9 +44,20 @@ typedef RefCountPtr<ISocketService> ISocketServicePtr;
 class ISocketService
 {
 public:
+	/** @brief IO multiplexing mechanism used to wait for socket reads. */
+	enum ServiceType
+	{
+		SERVICE_SELECT = 0,	///< select(), portable but O(n) per wakeup and limited to FD_SETSIZE.
+		SERVICE_EPOLL = 1,	///< Edge-triggered epoll(), falls back to select() where not available.
+		SERVICE_REACTOR = 2	///< epoll() pollers feeding a work-stealing worker pool, falls back to select().
+	};
+
 	inline ISocketService() {}
 	virtual ~ISocketService();
 
+	/** @brief Creates a dispatcher (SocketSet, EpollSocketSet or ReactorSocketSet) of the requested type. */
+	static ISocketServicePtr Create( enum ServiceType type );
+
 	virtual void AddSocket( IStreamReadListenerPtr listener, TcpSocketPtr sp ) = 0;
 	virtual void Close() = 0;
 	virtual void CloseAndDelete() = 0;
@@ -176,7 +187,7 @@ REGISTER_TYPEOF(64, SocketSetServerPtr);
 class SocketSetServer : public ISocketService, public IPortListenerListener
 {
 protected:
-	SocketSet m_ss;
+	ISocketServicePtr m_ss;
 	PortListener m_listener;
 	IServerConnectionFactory *m_conFactory;
 
@@ -184,7 +195,7 @@ protected:
 	virtual void IPortListener_OnStop();
 
 public:
-	SocketSetServer(IServerConnectionFactory *conFactory, int serverPort);
+	SocketSetServer(IServerConnectionFactory *conFactory, int serverPort, enum ServiceType type = SERVICE_SELECT);
 	virtual ~SocketSetServer();
 
 	virtual void AddSocket( IStreamReadListenerPtr listener, TcpSocketPtr sp );
@@ -71,6 +71,7 @@ public:
 	inline void SetLingerOn() { m_sock->SetLingerOn(); }
 	inline void SetLingerOff() { m_sock->SetLingerOff(); }
 	inline void SetNoDelay() { m_sock->SetNoDelay(); }
+	inline void SendFile(const String& filename, const long offset, const long count) { m_sock->SendFile(filename, offset, count); }
 
 	inline void SetSendTimeout(int toMS) { m_sock->SetSendTimeout(toMS); }
 	inline void SetRecvTimeout(int toMS) { m_sock->SetRecvTimeout(toMS); }
@@ -89,6 +90,8 @@ public:
 
 	friend class ServerSocket;
 	friend class SocketSet;
+	friend class EpollSocketSet;
+	friend class ReactorSocketSet;
 
 #if defined(DEBUG) || defined(_DEBUG)
 	virtual void CheckMem() const;
@@ -115,7 +115,9 @@ public:
 	/** Assign a new value to the counter. */
 	int32 operator=(int32 value) throw();
 
-	/** Assign a new value to the counter, returning the new value. */
+	/** Assign a new value to the counter, returning the new value.  Writes made
+	 *  before the call are visible to a thread that reads the new value.
+	 */
 	int32 Set(int32 value) throw();
 
 	/** Assign a new value to the counter, returning the previous value. */
@@ -127,7 +127,7 @@ public:
 #endif
 };
 
-REGISTER_TYPEOF( 476, Semaphore );
+REGISTER_TYPEOF( 477, Semaphore );
 
 /** @} */
 }
@@ -94,6 +94,13 @@ public:
 		return m_headers.Count(); 
 	}
 
+	inline void Clear()
+	{
+		m_headers.Clear();
+		m_headerIdx.Clear();
+		m_cookies.Clear();
+	}
+
 	void ParseLine( const String& line );
 
 	void Write(spl::IStream& stream) const;
@@ -32,8 +32,17 @@ namespace spl
  * @{
  */
 
+class HttpRequestParser;
+
+/** @brief An HTTP request, either parsed by itself or attached to an HttpRequestParser.
+ *	An attached request creates its Strings from the parser's buffer the first
+ *	time each part is asked for, and is only valid until the parser's Next()
+ *	or Reset().
+ */
 class HttpRequest : public IMemoryValidate
 {
+	friend class HttpRequestParser;
+
 private:
 	enum State
 	{
@@ -41,7 +50,19 @@ private:
 		HTTPREQ_STATE_URI = 1,
 		HTTPREQ_STATE_VERSION = 2,
 		HTTPREQ_STATE_HEADERS = 3,
-		HTTPREQ_STATE_BODY = 4
+		HTTPREQ_STATE_BODY = 4,
+		HTTPREQ_STATE_COMPLETE = 5
+	};
+
+	/// Parts of an attached request that have been loaded from the parser.
+	enum Part
+	{
+		HTTPREQ_PART_METHOD = 1,
+		HTTPREQ_PART_URI = 2,
+		HTTPREQ_PART_VERSION = 4,
+		HTTPREQ_PART_HEADERS = 8,
+		HTTPREQ_PART_BODY = 16,
+		HTTPREQ_PART_ALL = 31
 	};
 
 protected:
@@ -53,8 +74,23 @@ protected:
 
 	HttpRequest::State m_state;
 	StringBuffer m_accum;
+	int m_contentLength;	///< Checked once, when the headers are complete.
+	const HttpRequestParser *m_source;	///< Parser this request is attached to, or NULL.
+	int m_loaded;			///< Parts already loaded from m_source.
+
+	inline void Need(int parts)
+	{
+		if ( NULL != m_source && parts != (m_loaded & parts) )
+		{
+			Load(parts);
+		}
+	}
+	void Load(int parts);
 
 	bool ParseLine(const byte *data, int len, int *pos);
+	/** @brief Reads Content-Length, 0 if there isn't one; throws if it isn't a non-negative integer. */
+	int ParseContentLength();
+	void CreateBody();
 
 public:
 	HttpRequest();
@@ -64,16 +100,29 @@ public:
 
 	HttpRequest& operator =(const HttpRequest& req);
 
-	inline String& Method() { return m_method; }
-	inline Uri& URI() { return m_uri; }
+	inline String& Method() { Need(HTTPREQ_PART_METHOD); return m_method; }
+	inline Uri& URI() { Need(HTTPREQ_PART_URI); return m_uri; }
+	inline String& HttpVersion() { Need(HTTPREQ_PART_VERSION); return m_httpVersion; }
 
 	void Parse(const Array<byte>& data, int len);
+
+	/** @brief Parses data[pos..len) and stops at the end of the request.
+	 *  @return The position after the last byte consumed; the rest belongs to
+	 *  the next pipelined request.
+	 */
+	int Parse(const Array<byte>& data, int pos, int len);
 	bool IsComplete();
 
+	/** @brief Clears the request so the next request on a connection can be parsed into it. */
+	void Reset();
+
+	/** @brief True if the client wants the connection kept open (HTTP/1.1 default). */
+	bool IsKeepAlive();
+
 	HttpResponse *Send();
 
-	inline HttpHeader& Headers() { return m_header; }
-	inline IHttpRequestBody* Body() { return m_body; }
+	inline HttpHeader& Headers() { Need(HTTPREQ_PART_HEADERS); return m_header; }
+	inline IHttpRequestBody* Body() { Need(HTTPREQ_PART_BODY); return m_body; }
 
 	StringPtr ToString() const;
 
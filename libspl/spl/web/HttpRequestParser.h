@@ -0,0 +1,238 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _httprequestparser_h
+#define _httprequestparser_h
+
+#include <spl/types.h>
+#include <spl/Debug.h>
+#include <spl/collection/Array.h>
+#include <spl/Memory.h>
+#include <spl/String.h>
+#include <spl/web/HttpRequest.h>
+
+/// Initial size of an HttpRequestParser's receive buffer.
+#define HTTP_PARSER_INITIAL_BUFFER 4096
+/// Largest request line plus headers HttpRequestParser will accept.
+#define HTTP_PARSER_MAX_HEADER_BYTES (64 * 1024)
+/// Default largest request, including the body, HttpRequestParser will buffer.
+#define HTTP_PARSER_MAX_REQUEST_BYTES (8 * 1024 * 1024)
+/// Most header lines HttpRequestParser will accept in one request.
+#define HTTP_PARSER_MAX_HEADERS 64
+
+namespace spl
+{
+/** 
+ * @defgroup web Web
+ * @{
+ */
+
+/** @brief Header names HttpRequestParser recognizes without comparing strings again. */
+enum HttpHeaderId
+{
+	HTTP_HDR_UNKNOWN = 0,
+	HTTP_HDR_ACCEPT,
+	HTTP_HDR_ACCEPT_ENCODING,
+	HTTP_HDR_ACCEPT_LANGUAGE,
+	HTTP_HDR_AUTHORIZATION,
+	HTTP_HDR_CONNECTION,
+	HTTP_HDR_CONTENT_LENGTH,
+	HTTP_HDR_CONTENT_TYPE,
+	HTTP_HDR_COOKIE,
+	HTTP_HDR_EXPECT,
+	HTTP_HDR_HOST,
+	HTTP_HDR_IF_MODIFIED_SINCE,
+	HTTP_HDR_IF_NONE_MATCH,
+	HTTP_HDR_IF_RANGE,
+	HTTP_HDR_RANGE,
+	HTTP_HDR_REFERER,
+	HTTP_HDR_TRANSFER_ENCODING,
+	HTTP_HDR_USER_AGENT,
+	HTTP_HDR_COUNT
+};
+
+///@brief A run of bytes in an HttpRequestParser's buffer (internal).
+class HttpSlice
+{
+public:
+	int m_offset;
+	int m_len;
+
+	inline HttpSlice() : m_offset(0), m_len(0) {}
+	inline HttpSlice(int offset, int len) : m_offset(offset), m_len(len) {}
+};
+
+///@brief A header line found by HttpRequestParser (internal).
+class HttpHeaderSlice
+{
+public:
+	HttpSlice m_name;
+	HttpSlice m_value;
+	enum HttpHeaderId m_id;
+
+	inline HttpHeaderSlice() : m_name(), m_value(), m_id(HTTP_HDR_UNKNOWN) {}
+};
+
+#ifdef DEBUG
+inline void TypeValidate( const HttpHeaderSlice& hs ) {}
+inline void TypeCheckMem( const HttpHeaderSlice& hs ) {}
+#endif
+
+/** @brief Incremental HTTP/1.x request parser that doesn't allocate per request.
+ *	Received bytes are appended to a buffer owned by the parser (one per 
+ *	connection), and the request line, headers and body are recorded as 
+ *	offsets into it.  Common header names are matched once to an HttpHeaderId,
+ *	Content-Length and chunked transfer encoding are decoded as the request 
+ *	arrives, and chunked bodies are joined in place.  Strings are only created 
+ *	when asked for, or by CopyTo for code that wants an HttpRequest.
+ *
+ *	Parse() throws an Exception for a malformed request; the connection should 
+ *	be answered with a 400 and closed.
+ */
+class HttpRequestParser : public IMemoryValidate
+{
+	friend class HttpRequest;
+
+private:
+	enum State
+	{
+		HTTPPARSE_STATE_REQUEST_LINE = 0,
+		HTTPPARSE_STATE_HEADERS = 1,
+		HTTPPARSE_STATE_BODY = 2,
+		HTTPPARSE_STATE_CHUNK_SIZE = 3,
+		HTTPPARSE_STATE_CHUNK_DATA = 4,
+		HTTPPARSE_STATE_CHUNK_END = 5,
+		HTTPPARSE_STATE_TRAILERS = 6,
+		HTTPPARSE_STATE_COMPLETE = 7
+	};
+
+	// Copy constructor doesn't make sense for this class
+	inline HttpRequestParser(const HttpRequestParser& p) {}
+	inline void operator =(const HttpRequestParser& p) {}
+
+protected:
+	Array<byte> m_buf;
+	int m_len;				///< Bytes in m_buf.
+	int m_scan;				///< Next byte to parse.
+	int m_end;				///< End of the completed request, start of the next.
+	int m_maxRequestBytes;
+
+	enum State m_state;
+	HttpSlice m_method;
+	HttpSlice m_uri;
+	HttpSlice m_version;
+	Array<HttpHeaderSlice> m_headers;
+	int m_headerCount;
+	int m_known[HTTP_HDR_COUNT];	///< Index of the first header with each id, or -1.
+
+	long m_contentLength;
+	bool m_chunked;
+	long m_chunkRemaining;
+	int m_bodyOffset;
+	int m_bodyLen;
+
+	void Append( const byte *data, int len );
+	bool FindLine( int *lineStart, int *lineLen );
+	void ParseRequestLine( int start, int len );
+	void ParseHeaderLine( int start, int len );
+	void EndOfHeaders();
+	void Run();
+	void Clear();
+
+	inline const char *Chars( const HttpSlice& s ) const { return (const char *)&m_buf.Data()[s.m_offset]; }
+	bool SliceEquals( const HttpSlice& s, const char *cp ) const;
+	bool SliceContainsToken( const HttpSlice& s, const char *token ) const;
+	inline StringPtr ToString( const HttpSlice& s ) const { return StringPtr(new String(Chars(s), s.m_len)); }
+
+	/** @brief Creates the Strings for parts (HttpRequest::Part flags) of req. */
+	void CopyPart( HttpRequest& req, int parts ) const;
+
+public:
+	HttpRequestParser( int maxRequestBytes = HTTP_PARSER_MAX_REQUEST_BYTES );
+	virtual ~HttpRequestParser();
+
+	/** @brief Appends data[pos..len) and parses as far as possible.
+	 *  Bytes past the end of a complete request are kept for Next().
+	 *  @return IsComplete().
+	 */
+	bool Parse( const Array<byte>& data, int pos, int len );
+
+	/** @brief Drops the completed request and parses any pipelined bytes after it.
+	 *  @return IsComplete() for the next request.
+	 */
+	bool Next();
+
+	/** @brief Forgets everything, including pipelined bytes. */
+	void Reset();
+
+	inline bool IsComplete() const { return HTTPPARSE_STATE_COMPLETE == m_state; }
+
+	/** @brief Bytes received after the current request. */
+	inline int PendingBytes() const { return m_len - (IsComplete() ? m_end : m_len); }
+
+	/** @brief Looks up a header name, HTTP_HDR_UNKNOWN if it isn't one of the interned names. */
+	static enum HttpHeaderId HeaderId( const char *name, int len );
+	static const char *HeaderIdName( enum HttpHeaderId id );
+
+	inline bool IsMethod( const char *method ) const { return SliceEquals(m_method, method); }
+	inline bool IsVersion( const char *version ) const { return SliceEquals(m_version, version); }
+	inline bool HasHeader( enum HttpHeaderId id ) const { return 0 <= m_known[id]; }
+	bool HeaderEquals( enum HttpHeaderId id, const char *value ) const;
+
+	/** @brief True if the client wants the connection kept open (HTTP/1.1 default). */
+	bool IsKeepAlive() const;
+	inline bool IsChunked() const { return m_chunked; }
+	inline long ContentLength() const { return m_contentLength; }
+
+	inline int HeaderCount() const { return m_headerCount; }
+	inline StringPtr HeaderName( int idx ) const { return ToString(m_headers[idx].m_name); }
+	inline StringPtr HeaderValue( int idx ) const { return ToString(m_headers[idx].m_value); }
+
+	inline StringPtr Method() const { return ToString(m_method); }
+	inline StringPtr RawUri() const { return ToString(m_uri); }
+	inline StringPtr HttpVersion() const { return ToString(m_version); }
+	/** @brief Value of the first header with this id; an empty string if there isn't one. */
+	StringPtr Header( enum HttpHeaderId id ) const;
+	/** @brief Value of the first header named name; an empty string if there isn't one. */
+	StringPtr Header( const String& name ) const;
+
+	/** @brief The body, after chunked decoding.  Only valid until Next() or Reset(). */
+	inline const byte *BodyData() const { return &m_buf.Data()[m_bodyOffset]; }
+	inline int BodyLength() const { return m_bodyLen; }
+
+	/** @brief The file extension of the request URI, as Uri::FileExt() would give it.
+	 *  @return false if the URI has a scheme or port, which only Uri can parse.
+	 */
+	bool UriFileExt( StringView& ext ) const;
+
+	/** @brief Loads the completed request into req, creating its Strings. */
+	void CopyTo( HttpRequest& req ) const;
+
+	/** @brief Points req at the completed request without creating any Strings.
+	 *	Each part of req is created the first time it's asked for.  req must not
+	 *	be used after Next() or Reset().
+	 */
+	void AttachTo( HttpRequest& req ) const;
+
+#if defined(DEBUG) || defined(_DEBUG)
+	virtual void CheckMem() const;
+	virtual void ValidateMem() const;
+#endif
+};
+
+/** @} */
+}
+#endif
@@ -51,6 +51,10 @@ protected:
 	int m_statusCode;
 	HttpHeader m_header;
 	MemoryStreamPtr m_body;
+	String m_bodyFile;
+	long m_bodyFileOffset;
+	long m_bodyFileLength;
+	bool m_sendBody;
 
 	StringBuffer m_accum;
 	enum HttpResponse::State m_state;
@@ -63,6 +67,7 @@ public:
 	HttpResponse& operator =(const HttpResponse& resp);
 
 	inline int& StatusCode() { return m_statusCode; }
+	inline String& HttpVersion() { return m_httpVersion; }
 	
 	inline void AddHeader(const String& header, const String& value) { m_header.Header(header) = value; }
 	inline HttpHeader& Headers() { return m_header; }
@@ -71,8 +76,23 @@ public:
 
 	inline spl::IStreamPtr GetBodyStream() { return m_body; }
 
-	inline int ContentLength() { return m_body->Length(); }
+	/** @brief Sends count bytes of filename starting at offset as the body, in place of 
+	 *  the body stream.  The file isn't read until the response is written.
+	 */
+	void SetBodyFile( const String& filename, long offset, long count );
+	inline bool HasBodyFile() const { return m_bodyFile.Length() > 0; }
+	inline const String& BodyFile() const { return m_bodyFile; }
+	inline long BodyFileOffset() const { return m_bodyFileOffset; }
 
+	/** @brief False to send only the headers, as for HEAD.  Content-Length still 
+	 *  describes the body.
+	 */
+	inline bool& SendBody() { return m_sendBody; }
+
+	inline long ContentLength() { return HasBodyFile() ? m_bodyFileLength : m_body->Length(); }
+
+	/** @brief Writes the status line and headers. */
+	void WriteHeader( spl::IStream& strm );
 	void Write( spl::IStream& strm );
 
 	void Parse( const Array<byte>& data, int len );
@@ -17,6 +17,7 @@
 #ifndef _httputility_h
 #define _httputility_h
 
+#include <time.h>
 #include <spl/String.h>
 
 namespace spl
@@ -61,6 +62,23 @@ public:
 
 	static bool HtmlEncodeRequired (const char *cp, int len);
 	inline static bool HtmlEncodeRequired (const String& s) { return HtmlEncodeRequired(s.GetChars(), s.Length()); }
+
+	/** @brief Formats t as an RFC 1123 date, as used by Date and Last-Modified. */
+	static StringPtr FormatDate (time_t t);
+
+	/** @brief Result of ParseByteRange. */
+	enum ByteRange
+	{
+		RANGE_NONE = 0,				///< No usable range; send the whole entity.
+		RANGE_SATISFIABLE = 1,		///< Send offset and count with a 206.
+		RANGE_UNSATISFIABLE = 2		///< The range is outside the entity; send a 416.
+	};
+
+	/** @brief Parses a Range header value for an entity of size bytes.
+	 *  Only a single bytes range is supported (first-last, first- or -suffix);
+	 *  multiple ranges and other units return RANGE_NONE.
+	 */
+	static enum ByteRange ParseByteRange (const String& range, long size, long& offset, long& count);
 };
 
 /** @} */
@@ -0,0 +1,107 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _httpfilecache_h
+#define _httpfilecache_h
+
+#include <spl/collection/Array.h>
+#include <spl/collection/Hashtable.h>
+#include <spl/Memory.h>
+#include <spl/RefCountPtr.h>
+#include <spl/String.h>
+#include <spl/threading/Mutex.h>
+
+#ifdef HAVE_TIME_H
+#include <time.h>
+#endif
+
+/// Default total bytes held by an HttpFileCache.
+#define HTTP_FILE_CACHE_MAX_BYTES (4 * 1024 * 1024)
+/// Default size of the largest file an HttpFileCache will hold.
+#define HTTP_FILE_CACHE_MAX_FILE (64 * 1024)
+
+namespace spl
+{
+class HttpFileCache;
+typedef RefCountPtr<HttpFileCache> HttpFileCachePtr;
+
+///@brief A file held by an HttpFileCache (internal).
+class HttpFileCacheEntry : public IMemoryValidate
+{
+public:
+	RefCountPtr<Array<byte> > m_data;
+	time_t m_mtime;
+	int64 m_lastUse;
+
+	HttpFileCacheEntry(RefCountPtr<Array<byte> > data, time_t mtime, int64 lastUse);
+	virtual ~HttpFileCacheEntry();
+
+#if defined(DEBUG) || defined(_DEBUG)
+	virtual void CheckMem() const;
+	virtual void ValidateMem() const;
+#endif
+};
+
+///@brief Thread safe, size bounded cache of small files for FileHandlerBase.
+/// Entries are keyed by path and modification time, so a changed file is 
+/// reloaded on its next request.  The least recently used files are dropped 
+/// to stay under the byte limit.
+class HttpFileCache : public IMemoryValidate
+{
+private:
+	// Copy constructor doesn't make sense for this class
+	inline HttpFileCache(const HttpFileCache& c) {}
+	inline void operator =(const HttpFileCache& c) {}
+
+protected:
+	Hashtable<String, HttpFileCacheEntry *> m_entries;
+	Mutex m_mtx;
+	long m_maxBytes;
+	long m_maxFileSize;
+	long m_bytes;
+	int64 m_clock;
+	int m_hits;
+	int m_misses;
+
+	void Remove( const String& path );
+	void EvictFor( long bytes );
+
+public:
+	HttpFileCache( long maxBytes = HTTP_FILE_CACHE_MAX_BYTES, long maxFileSize = HTTP_FILE_CACHE_MAX_FILE );
+	virtual ~HttpFileCache();
+
+	/** @brief Returns the contents of path, loading it if it isn't cached or 
+	 *  has a different mtime.  Returns a null pointer if size is over MaxFileSize().
+	 */
+	RefCountPtr<Array<byte> > Get( const String& path, time_t mtime, long size );
+
+	void Clear();
+
+	inline long MaxFileSize() const { return m_maxFileSize; }
+	inline long MaxBytes() const { return m_maxBytes; }
+
+	int Count();
+	long Bytes();
+	int HitCount();
+	int MissCount();
+
+#if defined(DEBUG) || defined(_DEBUG)
+	virtual void CheckMem() const;
+	virtual void ValidateMem() const;
+#endif
+};
+}
+#endif
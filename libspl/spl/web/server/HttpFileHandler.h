@@ -18,6 +18,7 @@
 #define _filehandlerbase_h
 
 #include <spl/text/StringBuffer.h>
+#include <spl/web/server/HttpFileCache.h>
 #include <spl/web/server/HttpHandler.h>
 
 namespace spl
@@ -25,16 +26,29 @@ namespace spl
 class FileHandlerBase;
 typedef RefCountPtrCast<FileHandlerBase, HttpHandler, HttpHandlerPtr> FileHandlerBasePtr;
 
-///@brief Base class for HttpHandlers that deal with files.
+///@brief Base class for HttpHandlers that deal with files.  Files are sent as 
+/// binary with sendfile() where available, and support single byte Range 
+/// requests and conditional GETs on ETag and Last-Modified.
 class FileHandlerBase : public HttpHandler
 {
 private:
 	static const int BLOCK_SIZE;
 
+protected:
+	HttpFileCachePtr m_cache;
+
+	static StringPtr EntityTag(long size, time_t mtime);
+	static bool IsNotModified(HttpRequest& request, const String& etag, const String& lastModified);
+
 public:
 	FileHandlerBase(const String& defaultMimeType);
 	virtual ~FileHandlerBase();
 
+	///@brief Keep small files in memory instead of sending them from disk.
+	void EnableCache(long maxBytes = HTTP_FILE_CACHE_MAX_BYTES, long maxFileSize = HTTP_FILE_CACHE_MAX_FILE);
+	///@brief Null unless EnableCache has been called.
+	inline HttpFileCachePtr Cache() { return m_cache; }
+
 	///@brief Allow subclasses to alter the content prior to sending.
 	virtual void ProcessFileContentBlock(StringBuffer& buf);
 
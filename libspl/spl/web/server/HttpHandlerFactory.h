@@ -38,7 +38,9 @@ public:
 	///@brief Add a handler for a file extension.
 	void AddHandler(HttpHandlerPtr handler);
 
+	///@brief The handler for a file extension, ignoring case; NULL if there isn't one.
 	HttpHandler *GetHandler(const String& fileExtension) const;
+	HttpHandler *GetHandler(const StringView& fileExtension) const;
 
 	///@brief Remove and delete all handlers.
 	void Clear();
@@ -19,27 +19,64 @@
 
 #include <spl/io/IStream.h>
 #include <spl/web/HttpRequest.h>
+#include <spl/web/HttpRequestParser.h>
 #include <spl/web/HttpResponse.h>
 #include <spl/net/TcpSocket.h>
+#include <spl/threading/Mutex.h>
+
+#ifdef HAVE_TIME_H
+#include <time.h>
+#endif
 
 #include <spl/web/server/HttpHandlerFactory.h>
 
+/// Default number of requests served on one keep-alive connection.
+#define HTTP_KEEPALIVE_MAX_REQUESTS 100
+/// Default seconds a keep-alive connection may sit idle.
+#define HTTP_KEEPALIVE_TIMEOUT 15
+
 namespace spl
 {
+class HttpInstance;
+typedef RefCountPtrCast<HttpInstance, IStreamReadListener, IStreamReadListenerPtr> HttpInstancePtr;
+
 ///@brief HttpInstance is a request parser and executor.  The caller is responsable
 /// for cleaning up/deleting the socket and factory.
+///
+/// Connections are persistent when the client asks (HTTP/1.1 default or
+/// Connection: keep-alive).  Pipelined requests are answered in order, and
+/// the request object is reset rather than reallocated between requests.
+/// Requests are framed by an HttpRequestParser, and only copied into the
+/// HttpRequest once complete.
 class HttpInstance : public IStreamReadListener
 {
 private:
+	HttpRequestParser m_parser;
 	HttpRequest m_request;
 	TcpSocketPtr m_sock;
 	HttpHandlerFactory *m_handlerFact;
+	int m_maxRequests;
+	int m_requestCount;
+	time_t m_lastActivity;
+	bool m_closed;
+	Mutex m_mtx;
+
+	void Respond(bool keepAlive);
+	void RespondBadRequest();
 
 public:
-	HttpInstance(TcpSocketPtr sock, HttpHandlerFactory *handlerFact);
+	HttpInstance(TcpSocketPtr sock, HttpHandlerFactory *handlerFact, int maxRequests = HTTP_KEEPALIVE_MAX_REQUESTS);
 	virtual ~HttpInstance();
 
 	inline TcpSocketPtr ClientConnection() { return m_sock; }
+	inline int RequestCount() const { return m_requestCount; }
+	inline bool IsClosed() const { return m_closed; }
+
+	/** @brief Shuts down the connection if nothing was received for idleSeconds.
+	 *  The socket service then sees end of file and removes it.
+	 *  @return True if the connection is closed.
+	 */
+	bool CloseIfIdle(time_t now, int idleSeconds);
 
 	virtual void IStreamRead_OnClose();
 	virtual void IStreamRead_OnRead(const Array<byte>& buf, int len);
@@ -24,25 +24,49 @@
 #include <spl/web/HttpUtility.h>
 #include <spl/web/Uri.h>
 #include <spl/net/PooledSocketSet.h>
+#include <spl/threading/Event.h>
+#include <spl/threading/ThreadStartDelegate.h>
 
 #include <spl/web/server/HttpHandlerFactory.h>
+#include <spl/web/server/HttpInstance.h>
 
 namespace spl
 {
 class HttpServer;
 typedef RefCountPtr<HttpServer> HttpServerPtr;
 
-///@brief HTTP service class.
+///@brief HTTP service class.  Keep-alive connections idle for more than
+/// idleTimeout seconds are closed by a background thread.
 class HttpServer : public IServerConnectionFactory
 {
 private:
-	ISocketServicePtr m_server;
 	HttpHandlerFactory m_handlerFact;
+	Vector<HttpInstancePtr> m_instances;
+	Mutex m_instancesMtx;
+	int m_idleTimeout;
+	int m_maxRequests;
+	volatile bool m_running;
+	Event m_reapEvent;
+	ThreadStartDelegate<HttpServer> m_reaper;
+	// Last, since it starts accepting connections as soon as it is constructed.
+	ISocketServicePtr m_server;
+
+	void ReapIdle();
+	void StopReaper();
 
 public:
-	HttpServer(int port);
+	HttpServer
+	(
+		int port, 
+		enum ISocketService::ServiceType type = ISocketService::SERVICE_SELECT, 
+		int idleTimeout = HTTP_KEEPALIVE_TIMEOUT, 
+		int maxRequests = HTTP_KEEPALIVE_MAX_REQUESTS
+	);
 	virtual ~HttpServer();
 
+	///@brief Number of connections that haven't been closed.
+	int ConnectionCount();
+
 	///@brief Add a handler for a file extension.
 	inline void AddHandler(HttpHandlerPtr handler) { m_handlerFact.AddHandler(handler); }
 
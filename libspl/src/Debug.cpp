@@ -59,11 +59,21 @@
 
 #define DEBUG_MEM_FILL (char)0xCA
 
-static int mallocsize = 0;
-static int midnum = 0;
+/* Blocks are spread over stripes by address, each with its own lock, list
+   and index, so threads rarely wait on each other and a block freed on
+   another thread still finds its stripe. */
+#define DEBUG_HEAP_STRIPES 16
+#define DEBUG_HEAP_BUCKETS 256
+#define DEBUG_SITE_SLOTS 1024
+
+#define DEBUG_HASH_MULT 0x9E3779B97F4A7C15ULL
+
 static bool isshutdown = false;
-static bool mutexinit = false;
+static bool heapinit = false;
 static bool _usemutex = false;
+static int midnum = 0;
+static int _sampleRate = 1;
+static bool _sampling = false;
 
 #if defined(_WINDOWS)
 #	define _WINSOCKAPI_
@@ -78,41 +88,76 @@ static bool _usemutex = false;
 #	include <pthread.h>
 #endif
 #if defined(_WINDOWS)
-	HANDLE mutex;
+	typedef CRITICAL_SECTION debuglock;
 #else
-	pthread_mutex_t mutex;
-	int mutex_recur_hack = 0;
+	typedef pthread_mutex_t debuglock;
 #endif
 
+#include <stddef.h>
 #include <spl/BigInteger.h>
 
 using namespace spl;
 
+/* Allocation counts for one malloc call site. */
+struct allocsite
+{
+	const char *filename;
+	int lineno;
+	int64 count;
+	int64 bytes;
+	int live;
+	int64 livebytes;
+	int leaks;			/* scratch for _debugDumpLeakSites */
+	int64 leakbytes;
+};
+
 struct allocblock
 {
 	int16 majic;
+	byte stripe;
+	char tracked;	/* 0 if sampling skipped the block, which is then only guarded */
 	int id;
 	char checkbit;
 	bool isarray;	/* new something[] reservse the first 4 bytes */
+	/* checkbit2 sits in the padding ahead of size, so data lands on a pointer
+	   boundary; mutexes in misaligned blocks make futex calls fail. */
+	char checkbit2;
 	int size;
 	const char *filename;
 	int lineno;
+	struct allocsite *site;
 	struct allocblock *next;
 	struct allocblock *prev;
-	char checkbit2;
+	struct allocblock *hnext;	/* next block in the same index bucket */
 	char data[4];
 };
 
+struct heapstripe
+{
+	debuglock lock;
+	struct allocblock head;
+	struct allocblock tail;
+	struct allocblock **buckets;
+	int bucketcount;
+	int blockcount;
+	int64 size;
+	int sampleclock;
+	int sitecount;
+	struct allocsite other;		/* sites that didn't fit in the table */
+	struct allocsite sites[DEBUG_SITE_SLOTS];
+};
+
 struct memcheckpoint
 {
 	int count;
-	int size;
+	int64 size;
 };
 
 #define ALLOCBLOC_MAJIC -31069
 
-static struct allocblock m_abhead = { ALLOCBLOC_MAJIC, -1, 0, 0, 0, NULL, 0, NULL, NULL, DEBUG_MEM_FILL, DEBUG_MEM_FILL, DEBUG_MEM_FILL, DEBUG_MEM_FILL, DEBUG_MEM_FILL };
-static struct allocblock m_abtail = { ALLOCBLOC_MAJIC, -1, 0, 0, 0, NULL, 0, NULL, NULL, DEBUG_MEM_FILL, DEBUG_MEM_FILL, DEBUG_MEM_FILL, DEBUG_MEM_FILL, DEBUG_MEM_FILL };
+#define BLOCK_OF(vp) ((struct allocblock *)(((byte *)(vp)) - offsetof(struct allocblock, data)))
+
+static struct heapstripe m_stripes[DEBUG_HEAP_STRIPES];
 
 static struct memcheckpoint m_memcheckpoint;
 
@@ -124,126 +169,347 @@ static struct memcheckpoint m_memcheckpoint;
 		a->data[a->size+3] == DEBUG_MEM_FILL &&								\
 		(a->checkbit == 0 || a->checkbit == 1)))
 
-/*
-inline int validateBlock( const struct allocblock *bp )
+static void _debugInitEnd( struct allocblock *bp )
+{
+	memset( bp, 0, sizeof(struct allocblock) );
+	bp->majic = ALLOCBLOC_MAJIC;
+	bp->id = -1;
+	bp->checkbit2 = DEBUG_MEM_FILL;
+	memset( bp->data, DEBUG_MEM_FILL, sizeof(bp->data) );
+}
+
+static void _debugInitHeap()
 {
-	ASSERT( bp != NULL );
-	// Fails on WINE
-#ifndef WINE
-	ASSERT( _CrtIsValidPointer( bp, sizeof(struct allocblock) + bp->size, 1 ) );
-	ASSERT( _CrtIsValidPointer( bp->data, 1, 1 ) );
+	const char *rate = getenv("SPL_DEBUG_HEAP_SAMPLE");
+	if ( NULL != rate && atoi(rate) > 1 )
+	{
+		_sampleRate = atoi(rate);
+		_sampling = true;
+	}
+
+	for ( int x = 0; x < DEBUG_HEAP_STRIPES; x++ )
+	{
+		struct heapstripe *st = &m_stripes[x];
+#ifdef _WINDOWS
+		InitializeCriticalSection( &st->lock );
+#else
+		assert( 0 == pthread_mutex_init( &st->lock, NULL ) );
 #endif
-	return bp->checkbit2 == DEBUG_MEM_FILL &&
-		bp->data[bp->size] == DEBUG_MEM_FILL &&
-		bp->data[bp->size+1] == DEBUG_MEM_FILL &&
-		bp->data[bp->size+2] == DEBUG_MEM_FILL &&
-		bp->data[bp->size+3] == DEBUG_MEM_FILL &&
-		(bp->checkbit == 0 || bp->checkbit == 1);
-}*/
+		_debugInitEnd( &st->head );
+		_debugInitEnd( &st->tail );
+		st->head.next = &st->tail;
+		st->tail.prev = &st->head;
+		st->buckets = (struct allocblock **)calloc( DEBUG_HEAP_BUCKETS, sizeof(struct allocblock *) );
+		assert( NULL != st->buckets );
+		st->bucketcount = DEBUG_HEAP_BUCKETS;
+		st->other.filename = "(other sites)";
+	}
+	heapinit = true;
+}
+
+inline static void _debugEnsureHeap()
+{
+	if ( ! heapinit )
+	{
+		_debugInitHeap();
+	}
+}
+
+inline static uint64 _debugHash( const void *vp )
+{
+	return (uint64)(size_t)vp * DEBUG_HASH_MULT;
+}
+
+inline static struct heapstripe *_debugStripeOf( const void *vp )
+{
+	return &m_stripes[(int)(_debugHash( vp ) >> 60) & (DEBUG_HEAP_STRIPES - 1)];
+}
+
+inline static int _debugBucketOf( const struct heapstripe *st, const void *vp )
+{
+	return (int)(_debugHash( vp ) >> 24) & (st->bucketcount - 1);
+}
 
 void _debugEnableHeapLocking()
 {
 	_usemutex = true;
 }
 
-inline static void _debugLockHeap()
+inline static void _debugLockStripe( struct heapstripe *st )
 {
-	if ( mutexinit )
+	if ( _usemutex )
 	{
 #ifdef _WINDOWS
-		WaitForSingleObject(mutex, INFINITE);
+		EnterCriticalSection( &st->lock );
 #else
-		int ret = pthread_mutex_lock( &mutex );
-		if ( ret == EDEADLK )
-		{
-			// recursive lock not supported
-			mutex_recur_hack++;
-		}
-		else
-		{
-			assert(ret == 0);
-		}
+		int ret = pthread_mutex_lock( &st->lock );
+		assert(ret == 0);
 #endif
 	}
 }
 
-inline static void _debugUnlockHeap()
+inline static void _debugUnlockStripe( struct heapstripe *st )
 {
-	if ( mutexinit )
+	if ( _usemutex )
 	{
 #ifdef _WINDOWS
-		ReleaseMutex(mutex);
+		LeaveCriticalSection( &st->lock );
 #else
-		if ( 0 != mutex_recur_hack )
+		int ret = pthread_mutex_unlock( &st->lock );
+		assert(ret == 0);
+#endif
+	}
+}
+
+/* Walks lock every stripe, always in the same order. */
+static void _debugLockHeap()
+{
+	for ( int x = 0; x < DEBUG_HEAP_STRIPES; x++ )
+	{
+		_debugLockStripe( &m_stripes[x] );
+	}
+}
+
+static void _debugUnlockHeap()
+{
+	for ( int x = DEBUG_HEAP_STRIPES - 1; x >= 0; x-- )
+	{
+		_debugUnlockStripe( &m_stripes[x] );
+	}
+}
+
+void _debugSetSampleRate( const int n )
+{
+	_sampleRate = n > 1 ? n : 1;
+	if ( _sampleRate > 1 )
+	{
+		_sampling = true;
+	}
+}
+
+static struct allocsite *_debugSite( struct heapstripe *st, const char *filename, const int lineno )
+{
+	if ( NULL == filename )
+	{
+		return &st->other;
+	}
+
+	uint64 h = ((uint64)(size_t)filename * 31 + (uint64)lineno) * DEBUG_HASH_MULT;
+	int slot = (int)(h >> 40) & (DEBUG_SITE_SLOTS - 1);
+
+	for ( int probe = 0; probe < DEBUG_SITE_SLOTS; probe++ )
+	{
+		struct allocsite *site = &st->sites[slot];
+		if ( site->filename == filename && site->lineno == lineno )
 		{
-			assert( mutex_recur_hack > 0 );
-			mutex_recur_hack--;
+			return site;
 		}
-		else
+		if ( NULL == site->filename )
 		{
-			assert( 0 == pthread_mutex_unlock( &mutex ) );
+			// Keep a slot free so probes always end.
+			if ( st->sitecount >= DEBUG_SITE_SLOTS - 1 )
+			{
+				break;
+			}
+			st->sitecount++;
+			site->filename = filename;
+			site->lineno = lineno;
+			return site;
 		}
-#endif
+		slot = (slot + 1) & (DEBUG_SITE_SLOTS - 1);
 	}
+	return &st->other;
+}
+
+static void _debugGrowIndex( struct heapstripe *st )
+{
+	int count = st->bucketcount * 2;
+	struct allocblock **buckets = (struct allocblock **)calloc( count, sizeof(struct allocblock *) );
+	if ( NULL == buckets )
+	{
+		// The chains just get longer.
+		return;
+	}
+
+	struct allocblock **old = st->buckets;
+	int oldcount = st->bucketcount;
+	st->buckets = buckets;
+	st->bucketcount = count;
+
+	for ( int x = 0; x < oldcount; x++ )
+	{
+		struct allocblock *bp = old[x];
+		while ( NULL != bp )
+		{
+			struct allocblock *next = bp->hnext;
+			int b = _debugBucketOf( st, bp->data );
+			bp->hnext = buckets[b];
+			buckets[b] = bp;
+			bp = next;
+		}
+	}
+	free( old );
+}
+
+static void _debugClearIndex( struct heapstripe *st )
+{
+	memset( st->buckets, 0, st->bucketcount * sizeof(struct allocblock *) );
+	st->blockcount = 0;
+	st->size = 0;
+	for ( int x = 0; x < DEBUG_SITE_SLOTS; x++ )
+	{
+		st->sites[x].live = 0;
+		st->sites[x].livebytes = 0;
+	}
+	st->other.live = 0;
+	st->other.livebytes = 0;
+}
+
+/* The stripe must be locked. */
+static struct allocblock *_debugIndexFind( struct heapstripe *st, const void *vp )
+{
+	struct allocblock *bp = st->buckets[_debugBucketOf( st, vp )];
+	while ( NULL != bp && vp != bp->data )
+	{
+		bp = bp->hnext;
+	}
+	return bp;
+}
+
+/* Unlinks the block whose data starts at vp, or returns NULL if there isn't one. */
+static struct allocblock *_debugRemoveBlock( const void *vp )
+{
+	struct heapstripe *st = _debugStripeOf( vp );
+
+	_debugLockStripe( st );
+
+	struct allocblock **link = &st->buckets[_debugBucketOf( st, vp )];
+	while ( NULL != *link && vp != (*link)->data )
+	{
+		link = &(*link)->hnext;
+	}
+	struct allocblock *bp = *link;
+	if ( NULL == bp )
+	{
+		_debugUnlockStripe( st );
+		return NULL;
+	}
+	*link = bp->hnext;
+
+	assert
+	(
+		validateBlock( bp ) &&
+		bp->stripe == (byte)(st - m_stripes) &&
+		bp->prev->next == bp &&
+		bp->next->prev == bp
+	);
+
+	bp->next->prev = bp->prev;
+	bp->prev->next = bp->next;
+
+	assert
+	(
+		bp->prev != NULL &&
+		((&st->head == bp->prev)?1:validateBlock( bp->prev )) &&
+		validateBlock( bp->next ) &&
+		&st->head != bp
+	);
+
+	st->blockcount--;
+	st->size -= bp->size;
+	bp->site->live--;
+	bp->site->livebytes -= bp->size;
+
+	_debugUnlockStripe( st );
+	return bp;
+}
+
+/* Blocks skipped by sampling aren't indexed, so they're recognized by their header. */
+static struct allocblock *_debugUntrackedBlock( const void *vp )
+{
+	if ( ! _sampling || NULL == vp )
+	{
+		return NULL;
+	}
+	struct allocblock *bp = BLOCK_OF( vp );
+	if ( ALLOCBLOC_MAJIC == bp->majic && 0 == bp->tracked && validateBlock( bp ) )
+	{
+		return bp;
+	}
+	return NULL;
 }
 
 void _debugFreeHeap()
 {
 	BigInteger::DebugClearStatics();
 
-	struct allocblock *bp = m_abhead.next;
-	if ( NULL == bp )
+	if ( ! heapinit )
 	{
 		return;
 	}
-	while ( &m_abtail != bp )
+
+	_debugLockHeap();
+	for ( int x = 0; x < DEBUG_HEAP_STRIPES; x++ )
 	{
-		assert(bp->next->prev == bp);
-		assert( validateBlock( bp ) );
-		bp = bp->next;
-		free( bp->prev );
-	}
+		struct heapstripe *st = &m_stripes[x];
+		struct allocblock *bp = st->head.next;
+		while ( &st->tail != bp )
+		{
+			assert(bp->next->prev == bp);
+			assert( validateBlock( bp ) );
+			bp = bp->next;
+			free( bp->prev );
+		}
+		st->head.next = &st->tail;
+		st->tail.prev = &st->head;
+		_debugClearIndex( st );
 
-	assert(m_abhead.next == &m_abtail);
-	assert(m_abhead.prev == NULL);
-	assert(m_abtail.prev == &m_abhead);
-	assert(m_abtail.next == NULL);
+		assert(st->head.prev == NULL);
+		assert(st->tail.next == NULL);
+	}
+	_debugUnlockHeap();
 }
 
 void _debugTearDown(bool reallyfree)
 {
 	BigInteger::DebugClearStatics();
 
-	struct allocblock *bp = m_abhead.next;
+	if ( ! heapinit )
+	{
+		isshutdown = true;
+		return;
+	}
 
-	while( bp != NULL && &m_abtail != bp )
+	for ( int x = 0; x < DEBUG_HEAP_STRIPES; x++ )
 	{
-		struct allocblock *next;
-		assert( validateBlock( bp ) );
-		next = bp->next;
+		struct heapstripe *st = &m_stripes[x];
+		struct allocblock *bp = st->head.next;
+
+		while( &st->tail != bp )
+		{
+			struct allocblock *next;
+			assert( validateBlock( bp ) );
+			next = bp->next;
+			if ( reallyfree )
+			{
+				free( bp );
+			}
+			bp = next;
+		}
 		if ( reallyfree )
 		{
-			free( bp );
+			st->head.next = &st->tail;
+			st->tail.prev = &st->head;
+			_debugClearIndex( st );
 		}
-		bp = next;
-	}
 
-	if ( mutexinit )
-	{
 #ifdef _WINDOWS
-		CloseHandle(mutex);
+		DeleteCriticalSection( &st->lock );
 #else
-		pthread_mutex_destroy( &mutex );
+		pthread_mutex_destroy( &st->lock );
 #endif
-		mutexinit = false;
-	}
-	if ( reallyfree )
-	{
-		assert(m_abhead.next == &m_abtail);
-		assert(m_abhead.prev == NULL);
-		assert(m_abtail.prev == &m_abhead);
-		assert(m_abtail.next == NULL);
 	}
+	_usemutex = false;
 	isshutdown = true;
 }
 
@@ -252,24 +518,7 @@ void *_debugMalloc( const int len, const char *filename, const int lineno, const
 	struct allocblock *ab;
 
 	assert( ! isshutdown && len > 0 );
-
-	if ( NULL == m_abhead.next )
-	{
-		m_abhead.next = &m_abtail;
-		m_abtail.prev = &m_abhead;
-		if ( _usemutex && !mutexinit )
-		{
-#		ifdef _WINDOWS
-			mutex = CreateMutex(NULL, FALSE, NULL);
-#		else
-			assert( 0 == pthread_mutex_init( &mutex, NULL ) );
-#		endif
-			mutexinit = true;
-		}
-	}
-	_debugLockHeap( );
-
-	mallocsize += sizeof( struct allocblock ) + len;
+	_debugEnsureHeap();
 
 	ab = (struct allocblock *)::malloc( sizeof( struct allocblock ) + len );
 	if( NULL == ab )
@@ -277,12 +526,10 @@ void *_debugMalloc( const int len, const char *filename, const int lineno, const
 		assert(false);
 	}
 
+	struct heapstripe *st = _debugStripeOf( ab->data );
+
 	ab->majic = ALLOCBLOC_MAJIC;
-	ab->id = midnum++;
-	//if ( ab->id == 2887 )
-	//{
-	//	printf("hi\n");
-	//}
+	ab->stripe = (byte)(st - m_stripes);
 	ab->data[len] = DEBUG_MEM_FILL;
 	ab->data[len+1] = DEBUG_MEM_FILL;
 	ab->data[len+2] = DEBUG_MEM_FILL;
@@ -293,89 +540,90 @@ void *_debugMalloc( const int len, const char *filename, const int lineno, const
 	ab->checkbit = 0;
 	ab->checkbit2 = DEBUG_MEM_FILL;
 	ab->isarray = isarray;
-	ab->next = m_abhead.next;
-	ab->next->prev = ab;
-	ab->prev = &m_abhead;
-	m_abhead.next = ab;
+	ab->next = NULL;
+	ab->prev = NULL;
+	ab->hnext = NULL;
+	ab->site = NULL;
 
-	assert( validateBlock( ab ) );
+	_debugLockStripe( st );
 
-	_debugUnlockHeap( );
-	return ab->data;
-}
+	ab->id = midnum++;
+	//if ( ab->id == 2887 )
+	//{
+	//	printf("hi\n");
+	//}
 
-static struct allocblock *_debugScanForBlock( const void *vp )
-{
-	struct allocblock *bp;
-	if ( 0 == vp || NULL == vp )
+	if ( _sampleRate > 1 && ++st->sampleclock < _sampleRate )
 	{
-		return NULL;
+		ab->tracked = 0;
+		_debugUnlockStripe( st );
+		return ab->data;
 	}
+	st->sampleclock = 0;
+	ab->tracked = 1;
 
-	bp = (struct allocblock *)(((byte *)vp) - (sizeof(struct allocblock)));
-	if ( ALLOCBLOC_MAJIC == bp->majic && vp == bp->data )
-	{
-		if(validateBlock(bp))
-		{
-			return bp;
-		}
-	}
+	ab->site = _debugSite( st, filename, lineno );
+	ab->site->count++;
+	ab->site->bytes += len;
+	ab->site->live++;
+	ab->site->livebytes += len;
 
-	bp = (struct allocblock *)(((byte *)vp) - (sizeof(struct allocblock)-7));
-	if ( ALLOCBLOC_MAJIC == bp->majic && vp == bp->data )
-	{
-		if(validateBlock(bp))
-		{
-			return bp;
-		}
-	}
+	ab->next = st->head.next;
+	ab->next->prev = ab;
+	ab->prev = &st->head;
+	st->head.next = ab;
 
-	bp = (struct allocblock *)(((byte *)vp) - (sizeof(struct allocblock)-4));
-	if ( ALLOCBLOC_MAJIC == bp->majic && vp == bp->data )
+	if ( ++st->blockcount > st->bucketcount * 2 )
 	{
-		if(validateBlock(bp))
-		{
-			return bp;
-		}
+		_debugGrowIndex( st );
 	}
+	int b = _debugBucketOf( st, ab->data );
+	ab->hnext = st->buckets[b];
+	st->buckets[b] = ab;
+	st->size += len;
+
+	assert( validateBlock( ab ) );
+
+	_debugUnlockStripe( st );
+	return ab->data;
+}
 
-	bp = (struct allocblock *)(((byte *)vp) - (sizeof(struct allocblock)-8));
-	if ( ALLOCBLOC_MAJIC == bp->majic && vp == bp->data )
+/* Finds the block whose data starts at vp. */
+static struct allocblock *_debugScanForBlock( const void *vp )
+{
+	if ( NULL == vp || ! heapinit )
 	{
-		if(validateBlock(bp))
-		{
-			return bp;
-		}
+		return NULL;
 	}
 
-	bp = m_abtail.prev;
-	while ( bp != &m_abhead )
+	struct heapstripe *st = _debugStripeOf( vp );
+	_debugLockStripe( st );
+	struct allocblock *bp = _debugIndexFind( st, vp );
+	_debugUnlockStripe( st );
+
+	if ( NULL == bp )
 	{
-		if ( vp == bp->data )
-		{
-			return bp;
-		}
-		if ( vp > bp->data )
-		{
-			if (vp < (void *)(bp->data + bp->size))
-			{
-				return bp;
-			}
-		}
-		bp = bp->prev;
+		return _debugUntrackedBlock( vp );
 	}
-
-	return NULL;
+	return validateBlock( bp ) ? bp : NULL;
 }
 
+/* Finds the block that vp points into, which takes a walk unless vp is the start of one. */
 struct allocblock *findBlock( const void *vp )
 {
 	struct allocblock *bp = _debugScanForBlock( vp );
 
-	if ( bp == NULL )
+	if ( bp != NULL || ! heapinit )
 	{
-		bp = m_abhead.next;
-		while ( NULL != bp )
+		return bp;
+	}
+
+	for ( int x = 0; x < DEBUG_HEAP_STRIPES; x++ )
+	{
+		struct heapstripe *st = &m_stripes[x];
+		_debugLockStripe( st );
+		bp = st->head.next;
+		while ( &st->tail != bp )
 		{
 			if( bp->checkbit2 != DEBUG_MEM_FILL )
 			{
@@ -384,14 +632,12 @@ struct allocblock *findBlock( const void *vp )
 			if ( vp >= (void *)bp->data && vp < (void *)(bp->data + bp->size) )
 			{
 				//*offsetSize = bp->size - (int)((char *)vp - (char*)bp->data);
+				_debugUnlockStripe( st );
 				return bp;
 			}
 			bp = bp->next;
 		}
-	}
-	else
-	{
-		return bp;
+		_debugUnlockStripe( st );
 	}
 	return NULL;
 }
@@ -407,18 +653,18 @@ void _debugFree( void *vp )
 	}
 
 	assert(NULL != vp);
+	assert(heapinit);
 
 	DEBUG_VALIDATE();
-	_debugLockHeap(  );
 
-	bp = _debugScanForBlock( vp );
-	if ( NULL == bp )
+	bp = _debugRemoveBlock( vp );
+	if ( NULL == bp && NULL == (bp = _debugUntrackedBlock( vp )) )
 	{
-		if ( NULL != (bp = _debugScanForBlock( ((byte *)vp)-4 )) )
+		if ( NULL != (bp = _debugRemoveBlock( ((byte *)vp)-4 )) )
 		{
 			assert( _CrtIsValidPointer( ((byte *)vp)-4, 1, 1 ) );
 		}
-		else if ( NULL != (bp = _debugScanForBlock( ((byte *)vp)-8 )) )
+		else if ( NULL != (bp = _debugRemoveBlock( ((byte *)vp)-8 )) )
 		{
 			assert( _CrtIsValidPointer( ((byte *)vp)-8, 1, 1 ) );
 		}
@@ -433,41 +679,15 @@ void _debugFree( void *vp )
 	}
 
 	assert( validateBlock(bp) );
-
-	assert
-	(
-		vp == bp->data  &&
-		-1 == m_abhead.id &&
-		0 == m_abhead.checkbit &&
-		NULL != bp &&
-		bp->prev->next == bp &&
-		_CrtIsValidPointer( bp, sizeof(struct allocblock), 1 )
-	);
+	assert( _CrtIsValidPointer( bp, sizeof(struct allocblock), 1 ) );
 
 	//if ( bp->id == 2887 )
 	//{
 	//	printf("hi\n");
 	//}
 
-	bp->next->prev = bp->prev;
-	bp->prev->next = bp->next;
-
-	assert
-	(
-		validateBlock( bp ) &&
-		bp->prev != NULL &&
-		((&m_abhead == bp->prev)?1:validateBlock( bp->prev )) &&
-		validateBlock( bp->next ) &&
-		&m_abhead != bp
-	);
-
 	memset( bp, DEBUG_MEM_FILL, sizeof(struct allocblock) + bp->size );
 
-	assert( _CrtIsValidPointer( bp, sizeof(struct allocblock), 1 ) );
-
-	mallocsize -= bp->size;
-
-	_debugUnlockHeap(  );
 	DEBUG_VALIDATE();
 	free( bp );
 	DEBUG_VALIDATE();
@@ -489,21 +709,17 @@ void _debugAssert( const int cond, const char *filename, const int lineno )
 int _debugCheckPtr( const void *ptr )
 {
 	struct allocblock *bp;
-	bool ret;
 	if ( isshutdown )
 	{
 		return 1;
 	}
 
-	_debugLockHeap(  );
-
 	if ( NULL == (bp = findBlock( ptr )) )
 	{
 		if ( NULL != (bp = findBlock( ((byte *)ptr)-4 )) )
 		{
 			if ( ! bp->isarray )
 			{
-				_debugUnlockHeap(  );
 				/*printf("pointer found, but should be array for padding?\n");*/
 				return 0;
 			}
@@ -513,14 +729,12 @@ int _debugCheckPtr( const void *ptr )
 			// Also happens on sub classes with abstract (virtual) base class
 			//if ( ! bp->isarray )
 			//{
-			//	debugUnlockHeap(  );
 				/*printf("pointer found, but should be array for padding?\n");*/
 			//	return 0;
 			//}
 		}
 		else
 		{
-			_debugUnlockHeap(  );
 			/*printf("pointer not found.\n");*/
 			return 0;
 		}
@@ -530,9 +744,7 @@ int _debugCheckPtr( const void *ptr )
 	{
 		assert( _CrtIsValidPointer( ptr, 1, 1 ) );
 	}
-	ret = validateBlock( bp );
-	_debugUnlockHeap(  );
-	return ret;
+	return validateBlock( bp );
 }
 
 int _debugCheckBlock( const void *ptr, const int size )
@@ -548,8 +760,6 @@ int _debugCheckBlock( const void *ptr, const int size )
 		assert( NULL != ptr );
 	}
 
-	_debugLockHeap(  );
-
 	bp = _debugScanForBlock( ptr );
 	if( bp == NULL )
 	{
@@ -558,13 +768,11 @@ int _debugCheckBlock( const void *ptr, const int size )
 		/* check for compiler padding, typical for arrays */
 		if ( NULL == (bp = _debugScanForBlock( ((byte *)ptr)-vpsize ) ) )
 		{
-			_debugUnlockHeap(  );
 			return 0;
 		}
 		/* This also happens for abstract base classes w/virtual members */
 		/*if ( ! bp->isarray )
 		{
-			debugUnlockHeap(  );
 			return 0;
 		}*/
 
@@ -574,50 +782,43 @@ int _debugCheckBlock( const void *ptr, const int size )
 	{
 		assert( _CrtIsValidPointer( ptr, 1, 1 ) );
 	}
-	if ( NULL == bp )
-	{
-		_debugUnlockHeap(  );
-		return 0;
-	}
 	if ( bp->size != size || bp->data != ptr )
 	{
 		if ( bp->size < size )
 		{
-			_debugUnlockHeap(  );
 			return 0;
 		}
 	}
 
 	assert( validateBlock( bp ));
-	_debugUnlockHeap(  );
 	return bp->size >= size;
 }
 
 void _debugClearMemCheckPoints()
 {
-	struct allocblock *bp;
-
-	if ( isshutdown )
+	if ( isshutdown || ! heapinit )
 	{
 		return;
 	}
 
 	_debugLockHeap(  );
 
-	bp = m_abhead.next;
-	while ( NULL != bp )
+	for ( int x = 0; x < DEBUG_HEAP_STRIPES; x++ )
 	{
-		assert( validateBlock( bp ) );
-		if ( bp != NULL )
+		struct heapstripe *st = &m_stripes[x];
+		struct allocblock *bp = st->head.next;
+		while ( &st->tail != bp )
 		{
+			assert( validateBlock( bp ) );
 			bp->checkbit = 0;
+			bp = bp->next;
 		}
-		bp = bp->next;
 	}
 
-	BigInteger::CheckMemStatics();
-
 	_debugUnlockHeap(  );
+
+	// Notes its own blocks, so the heap can't be locked.
+	BigInteger::CheckMemStatics();
 }
 
 void _debugNoteMemBlock( const void *vp )
@@ -629,130 +830,144 @@ void _debugNoteMemBlock( const void *vp )
 		return;
 	}
 
-	_debugLockHeap(  );
-
 	assert( _CrtIsValidPointer( vp, 1, 1 ) );
 
-	bp = findBlock( vp );
-
-	if ( NULL == bp )
+	// Array cookies put vp 4 or 8 bytes into the block; try those before walking the heap.
+	if ( NULL == (bp = _debugScanForBlock( vp )) &&
+		NULL == (bp = _debugScanForBlock( ((byte *)vp)-4 )) &&
+		NULL == (bp = _debugScanForBlock( ((byte *)vp)-8 )) )
 	{
-		if ( NULL != (bp = findBlock( ((byte *)vp)-4 )) )
-		{
-			assert ( bp->isarray );
-		}
-		else if ( NULL != (bp = findBlock( ((byte *)vp)-8 )) )
-		{
-			assert ( bp->isarray );
-		}
+		bp = findBlock( vp );
 	}
 
 	assert(NULL != bp && validateBlock( bp ) && ( vp == bp->data || ((char *)vp - 4) == bp->data || ((char *)vp - 8) == bp->data ) );
 	bp->checkbit = 1;
-	_debugUnlockHeap(  );
 }
 
 int _debugCheckMem()
 {
-	struct allocblock *bp;
+	int ret = 1;
 
 	assert(_CrtCheckMemory());
 
-	if ( isshutdown )
+	if ( isshutdown || ! heapinit )
 	{
 		return 1;
 	}
 
 	_debugLockHeap(  );
 
-	bp = m_abhead.next;
-	while ( NULL != bp && &m_abtail != bp )
+	for ( int x = 0; x < DEBUG_HEAP_STRIPES && 0 != ret; x++ )
 	{
-		if ( bp != NULL )
+		struct heapstripe *st = &m_stripes[x];
+		struct allocblock *bp = st->head.next;
+		while ( &st->tail != bp )
 		{
 			assert(validateBlock( bp ));
 			if( bp->checkbit != 1 )
 			{
-				return 0;
+				ret = 0;
+				break;
 			}
+			bp = bp->next;
 		}
-		bp = bp->next;
 	}
 
 	_debugUnlockHeap(  );
-	return 1;
+	return ret;
 }
 
 void _debugValidateHeap()
 {
-	struct allocblock *bp = m_abhead.next;
+	if ( isshutdown || ! heapinit )
+	{
+		return;
+	}
 
 	_debugLockHeap(  );
 
-	while ( NULL != bp && bp != &m_abtail )
+	for ( int x = 0; x < DEBUG_HEAP_STRIPES; x++ )
 	{
-		assert
-		(
-			validateBlock( bp ) &&
-			bp->next->prev == bp &&
-			bp->prev->next == bp
-		);
-		bp = bp->next;
+		struct heapstripe *st = &m_stripes[x];
+		struct allocblock *bp = st->head.next;
+		int count = 0;
+
+		while ( bp != &st->tail )
+		{
+			assert
+			(
+				validateBlock( bp ) &&
+				bp->next->prev == bp &&
+				bp->prev->next == bp &&
+				bp == _debugIndexFind( st, bp->data )
+			);
+			count++;
+			bp = bp->next;
+		}
+		assert( count == st->blockcount );
 	}
 
 	assert(_CrtCheckMemory());
 
-	if ( isshutdown )
-	{
-		return;
-	}
 	_debugUnlockHeap(  );
 }
 
 void _debugDumpMemLeaks()
 {
-	struct allocblock *bp = m_abhead.next;
-	if ( isshutdown || NULL == bp )
+	if ( isshutdown || ! heapinit )
 	{
 		return;
 	}
 	_debugLockHeap(  );
 
-	while ( bp != &m_abtail )
+	for ( int x = 0; x < DEBUG_HEAP_STRIPES; x++ )
 	{
-		assert(validateBlock( bp ));
-		if( bp->checkbit != 1 )
+		struct heapstripe *st = &m_stripes[x];
+		struct allocblock *bp = st->head.next;
+		while ( bp != &st->tail )
 		{
-			printf( "Memory leak %d: %d bytes allocated in %s on line %d\n", bp->id, bp->size, bp->filename, bp->lineno );
+			assert(validateBlock( bp ));
+			if( bp->checkbit != 1 )
+			{
+				printf( "Memory leak %d: %d bytes allocated in %s on line %d\n", bp->id, bp->size, bp->filename, bp->lineno );
+			}
+			bp = bp->next;
 		}
-		bp = bp->next;
 	}
 	_debugUnlockHeap(  );
 }
 
 int _debugAssertMemFree()
 {
-	return m_abhead.next == &m_abtail;
+	if ( ! heapinit )
+	{
+		return 1;
+	}
+	for ( int x = 0; x < DEBUG_HEAP_STRIPES; x++ )
+	{
+		if ( m_stripes[x].head.next != &m_stripes[x].tail )
+		{
+			return 0;
+		}
+	}
+	return 1;
 }
 
 void fillCheckPointData( struct memcheckpoint *mp )
 {
-	struct allocblock *bp;
-
 	mp->count = 0;
 	mp->size = 0;
 
-	_debugLockHeap(  );
-	bp = m_abhead.next;
+	if ( ! heapinit )
+	{
+		return;
+	}
 
-	while( NULL != bp && &m_abtail != bp )
+	_debugLockHeap(  );
+	for ( int x = 0; x < DEBUG_HEAP_STRIPES; x++ )
 	{
-		if( bp != NULL )
-		{
-			mp->count++;
-			mp->size += bp->size;
-		}
-		bp = bp->next;
+		mp->count += m_stripes[x].blockcount;
+		mp->size += m_stripes[x].size;
 	}
 	_debugUnlockHeap(  );
 }
@@ -769,6 +984,177 @@ int _debugAssertCheckPoint()
 	return mp.size == m_memcheckpoint.size && mp.count == m_memcheckpoint.count;
 }
 
+int _debugAllocSiteCount( const char *filename, const int lineno )
+{
+	int64 count = 0;
+
+	if ( ! heapinit )
+	{
+		return 0;
+	}
+
+	_debugLockHeap(  );
+	for ( int x = 0; x < DEBUG_HEAP_STRIPES; x++ )
+	{
+		for ( int s = 0; s < DEBUG_SITE_SLOTS; s++ )
+		{
+			const struct allocsite *site = &m_stripes[x].sites[s];
+			if ( NULL != site->filename && lineno == site->lineno && 0 == strcmp(filename, site->filename) )
+			{
+				count += site->count;
+			}
+		}
+	}
+	_debugUnlockHeap(  );
+
+	return (int)count;
+}
+
+static int _debugCompareSiteKey( const void *a, const void *b )
+{
+	const struct allocsite *sa = (const struct allocsite *)a;
+	const struct allocsite *sb = (const struct allocsite *)b;
+	int cmp = strcmp( sa->filename, sb->filename );
+	return 0 != cmp ? cmp : sa->lineno - sb->lineno;
+}
+
+static int _debugCompareSiteCount( const void *a, const void *b )
+{
+	const struct allocsite *sa = (const struct allocsite *)a;
+	const struct allocsite *sb = (const struct allocsite *)b;
+	return sa->count < sb->count ? 1 : (sa->count > sb->count ? -1 : 0);
+}
+
+static int _debugCompareSiteLeaks( const void *a, const void *b )
+{
+	const struct allocsite *sa = (const struct allocsite *)a;
+	const struct allocsite *sb = (const struct allocsite *)b;
+	return sa->leakbytes < sb->leakbytes ? 1 : (sa->leakbytes > sb->leakbytes ? -1 : 0);
+}
+
+/* Copies every stripe's sites, merged by file and line, into a malloc'ed array. */
+static struct allocsite *_debugCollectSites( int *count )
+{
+	int total = 0;
+	for ( int x = 0; x < DEBUG_HEAP_STRIPES; x++ )
+	{
+		total += m_stripes[x].sitecount + 1;
+	}
+
+	struct allocsite *sites = (struct allocsite *)malloc( total * sizeof(struct allocsite) );
+	int n = 0;
+	if ( NULL == sites )
+	{
+		*count = 0;
+		return NULL;
+	}
+	for ( int x = 0; x < DEBUG_HEAP_STRIPES; x++ )
+	{
+		struct heapstripe *st = &m_stripes[x];
+		for ( int s = 0; s < DEBUG_SITE_SLOTS; s++ )
+		{
+			if ( NULL != st->sites[s].filename )
+			{
+				sites[n++] = st->sites[s];
+			}
+		}
+		if ( 0 != st->other.count )
+		{
+			sites[n++] = st->other;
+		}
+	}
+
+	qsort( sites, n, sizeof(struct allocsite), _debugCompareSiteKey );
+	int merged = 0;
+	for ( int x = 0; x < n; x++ )
+	{
+		if ( merged > 0 && 0 == _debugCompareSiteKey( &sites[merged - 1], &sites[x] ) )
+		{
+			struct allocsite *site = &sites[merged - 1];
+			site->count += sites[x].count;
+			site->bytes += sites[x].bytes;
+			site->live += sites[x].live;
+			site->livebytes += sites[x].livebytes;
+			site->leaks += sites[x].leaks;
+			site->leakbytes += sites[x].leakbytes;
+		}
+		else
+		{
+			sites[merged++] = sites[x];
+		}
+	}
+	*count = merged;
+	return sites;
+}
+
+void _debugDumpAllocSites( const int top )
+{
+	int count;
+
+	if ( isshutdown || ! heapinit )
+	{
+		return;
+	}
+
+	_debugLockHeap(  );
+	struct allocsite *sites = _debugCollectSites( &count );
+	_debugUnlockHeap(  );
+
+	qsort( sites, count, sizeof(struct allocsite), _debugCompareSiteCount );
+	printf( "Top allocation sites, 1 in %d allocations sampled:\n", _sampleRate );
+	for ( int x = 0; x < count && x < top; x++ )
+	{
+		printf( "%10lld allocs %12lld bytes %8d live %12lld live bytes  %s line %d\n",
+			(long long)sites[x].count, (long long)sites[x].bytes, sites[x].live, (long long)sites[x].livebytes,
+			sites[x].filename, sites[x].lineno );
+	}
+	free( sites );
+}
+
+void _debugDumpLeakSites( const int top )
+{
+	int count;
+
+	if ( isshutdown || ! heapinit )
+	{
+		return;
+	}
+
+	_debugLockHeap(  );
+	for ( int x = 0; x < DEBUG_HEAP_STRIPES; x++ )
+	{
+		struct heapstripe *st = &m_stripes[x];
+		for ( int s = 0; s < DEBUG_SITE_SLOTS; s++ )
+		{
+			st->sites[s].leaks = 0;
+			st->sites[s].leakbytes = 0;
+		}
+		st->other.leaks = 0;
+		st->other.leakbytes = 0;
+
+		struct allocblock *bp = st->head.next;
+		while ( bp != &st->tail )
+		{
+			if ( bp->checkbit != 1 )
+			{
+				bp->site->leaks++;
+				bp->site->leakbytes += bp->size;
+			}
+			bp = bp->next;
+		}
+	}
+	struct allocsite *sites = _debugCollectSites( &count );
+	_debugUnlockHeap(  );
+
+	qsort( sites, count, sizeof(struct allocsite), _debugCompareSiteLeaks );
+	printf( "Sites of blocks not noted since the last check point, 1 in %d allocations sampled:\n", _sampleRate );
+	for ( int x = 0; x < count && x < top && 0 != sites[x].leaks; x++ )
+	{
+		printf( "%8d blocks %12lld bytes  %s line %d\n", sites[x].leaks, (long long)sites[x].leakbytes, sites[x].filename, sites[x].lineno );
+	}
+	free( sites );
+}
+
 #ifdef DEBUG
 void *rpl_malloc( const int size, char *filename, const int lineno, const bool isarray )
 {
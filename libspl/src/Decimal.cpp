@@ -273,7 +273,11 @@ StringPtr Decimal::ToString() const
 	char s[64];
 	int64 n2=n / q;
 	int fract = (int)(n-n2*q);
-	sprintf(s, "%d.%0*d", (int)n2, precision, fract);
+	if ( fract < 0 )
+	{
+		fract = -fract;
+	}
+	sprintf(s, "%s%lld.%0*d", (n < 0 && 0 == n2) ? "-" : "", (long long)n2, precision, fract);
 	return StringPtr(new String(s));
 }
 
@@ -151,7 +151,7 @@ DelimitedFilePtr DelimitedFile::Parse( const String& filename, char coldelim )
 	}
 
 	IStreamPtr fs = File::OpenText(filename);
-	TextReader reader(StreamBufferPtr(new StreamBuffer(fs, true)));
+	TextReader reader(StreamBufferPtr(new StreamBuffer(fs)));
 	DelimitedFilePtr df;
 
 	try
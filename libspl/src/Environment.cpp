@@ -482,16 +482,27 @@ int Environment::ProcessorCount()
 	::GetSystemInfo(&si);
 	return si.dwNumberOfProcessors;
 #else
+#if defined(HAVE_UNISTD_H) && defined(_SC_NPROCESSORS_ONLN)
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	if (count > 0)
+	{
+		return (int)count;
+	}
+#endif
 	const char *procCpuInfo = "/proc/cpuinfo";
 	if (File::Exists(procCpuInfo))
 	{
-		Regex regex("^processor", RegexOptions::MULTILINE);
 		StringPtr cpuinfo = File::LoadText(procCpuInfo);
-		if (cpuinfo.IsNull())
+		if (cpuinfo.IsNull() || cpuinfo->Length() == 0)
 		{
 			return 1;
 		}
+		Regex regex("^processor", RegexOptions::MULTILINE);
 		RefCountPtr<Array<StringPtr> > matches = regex.Matches(cpuinfo);
+		if (matches.IsNull() || matches->Count() < 1)
+		{
+			return 1;
+		}
 		return matches->Count();
 	}
 	return 1;
@@ -0,0 +1,367 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* on some platforms, threads overrides IO routines */
+#include <spl/threading/Thread.h>
+#include <spl/net/EpollSocketSet.h>
+
+#ifdef HAVE_SYS_EPOLL_H
+
+#include <spl/Environment.h>
+#include <spl/io/log/Log.h>
+
+#ifdef HAVE_ERRNO_H
+#include <errno.h>
+#endif
+#ifdef HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+using namespace spl;
+
+EpollSocketSet::EpollSocketSet(  )
+: m_buf(SOCKBUF_SIZE), m_fds(), m_fdsMutex(), m_running(true)
+{
+	m_epfd = epoll_create(EPOLLSS_MAX_EVENTS);
+	if ( 0 > m_epfd )
+	{
+		throw new SocketException(Environment::LastErrorMessage());
+	}
+
+	// The read end of the pipe is registered with a NULL pair, so
+	// Close() can interrupt epoll_wait() without waiting for the timeout.
+	if ( 0 != pipe(m_wakefds) )
+	{
+		::close(m_epfd);
+		throw new SocketException(Environment::LastErrorMessage());
+	}
+	fcntl(m_wakefds[0], F_SETFL, fcntl(m_wakefds[0], F_GETFL, 0) | O_NONBLOCK);
+	fcntl(m_wakefds[1], F_SETFL, fcntl(m_wakefds[1], F_GETFL, 0) | O_NONBLOCK);
+
+	struct epoll_event ev;
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN;
+	ev.data.ptr = NULL;
+	if ( 0 != epoll_ctl(m_epfd, EPOLL_CTL_ADD, m_wakefds[0], &ev) )
+	{
+		::close(m_wakefds[0]);
+		::close(m_wakefds[1]);
+		::close(m_epfd);
+		throw new SocketException(Environment::LastErrorMessage());
+	}
+
+	Start();
+}
+
+EpollSocketSet::~EpollSocketSet()
+{
+	Close();
+	Thread::Join(10 * 1000);
+
+	::close(m_wakefds[0]);
+	::close(m_wakefds[1]);
+	::close(m_epfd);
+}
+
+void EpollSocketSet::Join(int timeoutms)
+{
+	Thread::Join(timeoutms);
+}
+
+void EpollSocketSet::Join()
+{
+	Thread::Join();
+}
+
+int EpollSocketSet::SocketCount() const
+{
+	return m_fds.Count();
+}
+
+void EpollSocketSet::Wake()
+{
+	byte b = 0;
+	// EAGAIN means a wakeup is already pending.
+	if ( 1 != ::write(m_wakefds[1], &b, 1) && EAGAIN != errno )
+	{
+		Log::SWriteError("EpollSocketSet wake pipe write failed");
+	}
+}
+
+void EpollSocketSet::AddSocket( IStreamReadListenerPtr listener, TcpSocketPtr sp )
+{
+	sp.ValidateMem();
+
+	SocketListenerPair *pair = new SocketListenerPair(listener, sp);
+	int fd = sp->m_sock->GetFD();
+
+	struct epoll_event ev;
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN | EPOLLRDHUP | EPOLLET;
+	ev.data.ptr = pair;
+
+	m_fdsMutex.Lock();
+
+	if ( m_fds.ContainsKey(fd) )
+	{
+		// The old socket was closed outside a callback and the kernel has
+		// handed its descriptor to this one.  Closing the fd already took it
+		// out of the epoll set, so only the stale entry needs dropping.
+		SocketListenerPair *stale = m_fds.Get(fd);
+		ASSERT_MEM( stale, sizeof(SocketListenerPair) );
+		m_fds.Remove( fd );
+		stale->m_listener->IStreamRead_OnClose();
+		delete stale;
+	}
+
+	m_fds.Set( fd, pair );
+
+	if ( 0 != epoll_ctl(m_epfd, EPOLL_CTL_ADD, fd, &ev) )
+	{
+		m_fds.Remove( fd );
+		m_fdsMutex.Unlock();
+
+		String msg(Environment::LastErrorMessage());
+		listener->IStreamRead_OnError( msg );
+		listener->IStreamRead_OnClose();
+		sp->Close();
+		delete pair;
+		return;
+	}
+
+	m_fdsMutex.Unlock();
+}
+
+void EpollSocketSet::RemoveSocket( SocketListenerPair *pair )
+{
+	ASSERT_MEM( pair, sizeof(SocketListenerPair) );
+	pair->m_sp.ValidateMem();
+
+	int fd = pair->m_sp->m_sock->GetFD();
+
+	// The listener may have already closed the socket, in which case the
+	// kernel has removed it from the interest list and this fails harmlessly.
+	epoll_ctl(m_epfd, EPOLL_CTL_DEL, fd, NULL);
+	pair->m_sp->Close();
+
+	ASSERT( m_fds.ContainsKey(fd) && m_fds.Get(fd) == pair );
+	m_fds.Remove( fd );
+	delete pair;
+}
+
+void EpollSocketSet::DispatchRead( SocketListenerPair *pair, uint32 events )
+{
+	if ( pair->m_sp->IsClosed() )
+	{
+		pair->m_listener->IStreamRead_OnClose();
+		RemoveSocket( pair );
+		return;
+	}
+
+	// Edge triggered, so everything available has to be consumed now.
+	int bytes = pair->m_sp->GetBytesAvail();
+	bool peerClosed = 0 == bytes || 0 != (events & (EPOLLRDHUP | EPOLLHUP));
+
+	while ( bytes > 0 )
+	{
+		if ( ! m_running )
+		{
+			return;
+		}
+		bytes = pair->m_sp->GetStream()->Read(m_buf, 0, SOCKBUF_SIZE);
+		if ( 0 > bytes )
+		{
+			// socket closed
+			pair->m_listener->IStreamRead_OnClose();
+			RemoveSocket( pair );
+			return;
+		}
+		ASSERT(pair->m_listener.IsNotNull());
+		pair->m_listener->IStreamRead_OnRead( m_buf, bytes );
+
+		bytes = (pair->m_sp->IsClosed()) ? -1 : pair->m_sp->GetBytesAvail();
+	}
+
+	if ( pair->m_sp->IsClosed() )
+	{
+		// The listener closed the socket in IStreamRead_OnRead, which also
+		// took it out of the epoll set.
+		RemoveSocket( pair );
+	}
+	else if ( peerClosed )
+	{
+		pair->m_listener->IStreamRead_OnClose();
+		RemoveSocket( pair );
+	}
+}
+
+void EpollSocketSet::WaitForIO(  )
+{
+	int count = epoll_wait( m_epfd, m_events, EPOLLSS_MAX_EVENTS, 10 * 1000 );
+	if ( count < 0 )
+	{
+		if ( EINTR == errno )
+		{
+			return;
+		}
+		throw new SocketException(Environment::LastErrorMessage());
+	}
+
+	m_fdsMutex.Lock();
+
+	for ( int x = 0; x < count && m_running; x++ )
+	{
+		SocketListenerPair *pair = (SocketListenerPair *)m_events[x].data.ptr;
+		uint32 events = m_events[x].events;
+
+		if ( NULL == pair )
+		{
+			byte drain[64];
+			while ( 0 < ::read(m_wakefds[0], drain, sizeof(drain)) )
+			{
+			}
+			continue;
+		}
+
+		ASSERT_MEM( pair, sizeof( SocketListenerPair ) );
+		pair->m_sp.ValidateMem();
+
+		try
+		{
+			if ( 0 != (events & EPOLLERR) )
+			{
+				pair->m_listener->IStreamRead_OnError( "Socket exception set" );
+				pair->m_listener->IStreamRead_OnClose();
+				RemoveSocket( pair );
+			}
+			else
+			{
+				DispatchRead( pair, events );
+			}
+		}
+		catch ( SocketException *se )
+		{
+			ASSERT_MEM( pair, sizeof(SocketListenerPair) );
+			pair->m_listener->IStreamRead_OnError( se->Message() );
+			pair->m_listener->IStreamRead_OnClose();
+			RemoveSocket( pair );
+			delete se;
+		}
+		catch (Exception *ex)
+		{
+			Log::SWrite(ex);
+			ASSERT_MEM( pair, sizeof(SocketListenerPair) );
+			pair->m_listener->IStreamRead_OnError( ex->Message() );
+			pair->m_listener->IStreamRead_OnClose();
+			RemoveSocket( pair );
+			delete ex;
+			Thread::YYield();
+		}
+	}
+
+	m_fdsMutex.Unlock();
+}
+
+void EpollSocketSet::CloseAll()
+{
+	m_fdsMutex.Lock();
+
+	Hashtable<int, SocketListenerPair *>::Iterator iter = m_fds.Begin();
+	while ( iter.Next() )
+	{
+		SocketListenerPair *sp = iter.Current();
+		ASSERT_MEM( sp, sizeof( SocketListenerPair ) );
+		sp->m_sp->ValidateMem();
+		epoll_ctl(m_epfd, EPOLL_CTL_DEL, sp->m_sp->m_sock->GetFD(), NULL);
+		sp->m_sp->Close();
+		delete sp;
+	}
+	m_fds.Clear();
+	ASSERT( 0 == m_fds.Count() );
+
+	m_fdsMutex.Unlock();
+}
+
+void EpollSocketSet::Close()
+{
+	if ( ! m_running )
+	{
+		return;
+	}
+	m_running = false;
+	Wake();
+	CloseAll();
+}
+
+void EpollSocketSet::CloseAndDelete()
+{
+	Close();
+}
+
+void EpollSocketSet::Run()
+{
+	while ( m_running )
+	{
+		try
+		{
+			WaitForIO();
+		}
+		catch ( OutOfMemoryException mex )
+		{
+			Log::SWrite(mex);
+		}
+		catch ( Exception *ex )
+		{
+			Log::SWrite(ex);
+			delete ex;
+			Thread::YYield();
+		}
+	}
+}
+
+void EpollSocketSet::Broadcast( const Array<byte>& buf, const int len )
+{
+	m_fdsMutex.Lock();
+	Hashtable<int, SocketListenerPair *>::Iterator iter = m_fds.Begin();
+	while ( iter.Next() )
+	{
+		SocketListenerPair *sp = iter.Current();
+		if ( NULL != sp )
+		{
+			sp->m_sp->GetStream()->Write( buf, 0, len );
+		}
+	}
+	m_fdsMutex.Unlock();
+}
+
+#if defined(DEBUG) || defined(_DEBUG)
+void EpollSocketSet::CheckMem() const
+{
+	m_buf.CheckMem();
+	m_fds.CheckMem();
+}
+
+void EpollSocketSet::ValidateMem() const
+{
+	m_buf.ValidateMem();
+	m_fds.ValidateMem();
+}
+#endif
+
+#endif
@@ -235,7 +235,9 @@ RefCountPtr<Array<spl::byte> > File::LoadBinary( const String& filename )
 	}
 
 	RefCountPtr<Array<byte> > buf( new Array<byte>(size) );
-	if ( size != (int)fread(buf.Get(), 1, size, fp) )
+	int count = (int)fread(buf->Data(), 1, size, fp);
+	fclose(fp);
+	if ( size != count )
 	{
 		return RefCountPtr<Array<byte> >();
 	}
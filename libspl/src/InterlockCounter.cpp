@@ -42,7 +42,7 @@ static inline int32 atomic_decrement(int32 *ptr)
 
 static inline int32 atomic_set(int32 *ptr, int32 val)
 {
-	*ptr = val;
+	InterlockedExchange((LONG *)ptr, val);
 	return val;
 }
 
@@ -79,6 +79,9 @@ static inline int32 atomic_decrement(int32 *ptr)
 
 static inline int32 atomic_set(int32 *ptr, int32 val)
 {
+	// __sync_lock_test_and_set is only an acquire barrier; the fence keeps
+	// earlier writes from moving past the store.
+	__sync_synchronize();
 	__sync_lock_test_and_set(ptr, val);
 	return val;
 }
@@ -90,13 +93,12 @@ static inline int32 atomic_add(int32 *ptr, int32 val)
 
 static inline int32 atomic_cas(int32 *ptr, int32 val, int32 cmp)
 {
-	return __sync_val_compare_and_swap(ptr, val, cmp);
+	return __sync_val_compare_and_swap(ptr, cmp, val);
 }
 
 static inline int32 atomic_swap(int32 *ptr, int32 val)
 {
-	__sync_lock_test_and_set(ptr, val);
-	return val;
+	return __sync_lock_test_and_set(ptr, val);
 }
 
 #else
@@ -14,12 +14,28 @@
  *   You should have received a copy of the GNU General Public License
  *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
  */
-#include <spl/collection/Hashtable.h>
+#include <spl/types.h>
+#include <spl/IntrusivePtr.h>
+
+#if !defined(_WINDOWS) && !defined(HAVE_ATOMIC_BUILTINS)
+
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+
+using namespace spl;
+
+static pthread_mutex_t _intrusiveMutex = PTHREAD_MUTEX_INITIALIZER;
 
 namespace spl
 {
-	const int __hashtableSizes[] =
+	int32 _IntrusiveAdd(volatile int32 *count, int32 delta)
 	{
-		53, 193, 389, 701, 1543, 3079, 6151, 12289, 24593, 49157, 98317, 196613, 393241, 786433, 1572869, 3145739, 6291469, 12582917, 25165843, 50331653, 100663319, 201326611, 402653189, 805306457, 1610612741, -1
-	};
+		pthread_mutex_lock(&_intrusiveMutex);
+		int32 ret = (*count += delta);
+		pthread_mutex_unlock(&_intrusiveMutex);
+		return ret;
+	}
 }
+
+#endif
@@ -24,6 +24,7 @@
 #endif
 
 #include <spl/math/Math.h>
+#include <spl/StringView.h>
 
 using namespace spl;
 
@@ -136,12 +137,16 @@ uint32 Math::Hash( const float64 i )
 }
 
 uint64 Math::HashLong(const char *cp)
+{
+	return HashLong(cp, (int)strlen(cp));
+}
+
+uint64 Math::HashLong(const char *cp, const int len)
 {
 	uint64 h = 0;
-	int count = (int)strlen(cp);
 	int x;
 	
-	for (x = 0; x < count; x++)
+	for (x = 0; x < len && '\0' != cp[x]; x++)
 	{
 		h = (h << 6) ^ (h >> 58) ^ cp[x];
 	}
@@ -151,11 +156,21 @@ uint64 Math::HashLong(const char *cp)
 
 uint32 Math::Hash( const char *str )
 {
-	uint64 h = HashLong(str);
+	return Hash(str, (int)strlen(str));
+}
+
+uint32 Math::Hash( const char *str, const int len )
+{
+	uint64 h = HashLong(str, len);
 
 	return (uint32)((h & 0xFFFFFFFF) ^ (h >> 32));
 }
 
+uint32 Math::Hash( const StringView& sv )
+{
+	return Hash(sv.GetChars(), sv.Length());
+}
+
 uint32 Math::Hash( const IHashable& i)
 {
 	return i.HashCode();
@@ -53,7 +53,7 @@ MemoryPool::~MemoryPool()
 		
 		MemoryBlock *next = mb->m_next;
 		free(mb->m_data);
-		delete mb;
+		free(mb);
 		mb = next;
 	}
 	m_head.m_next = NULL;
@@ -63,6 +63,9 @@ void *MemoryPool::Malloc(int size)
 {
 	ASSERT(m_head.m_checkBits == MP_MAJIC);
 
+	// keep every allocation 8 byte aligned
+	size = (size + 7) & ~7;
+
 	m_freeMemoryPoolSize -= size;
 	m_usedMemoryPoolSize += size;
 
@@ -116,9 +119,11 @@ void MemoryPool::Free(void *ptr)
 		if ( mb->m_blockId == blockId )
 		{
 			ASSERT( size <= mb->m_size );
+			m_usedMemoryPoolSize -= size - 8;
+			m_freeMemoryPoolSize += size - 8;
 			mb->m_freeSize += size;
-			ASSERT( mb->m_freeSize <= mb->m_size );
-			if ( mb->m_freeSize == mb->m_size )
+			ASSERT( mb->m_freeSize <= mb->m_pos );
+			if ( mb->m_freeSize == mb->m_pos )
 			{
 				mb->m_freeSize = 0;
 				mb->m_pos = 0;
@@ -130,6 +135,39 @@ void MemoryPool::Free(void *ptr)
 	throw new Exception("MemoryPool::Free: pointer not found");
 }
 
+void MemoryPool::Reset()
+{
+	ASSERT(m_head.m_checkBits == MP_MAJIC);
+
+	MemoryBlock *prev = &m_head;
+	MemoryBlock *mb = m_head.m_next;
+	while ( NULL != mb )
+	{
+		MemoryBlock *next = mb->m_next;
+		if ( mb->m_size > m_memoryBlockSize )
+		{
+			prev->m_next = next;
+			m_totalMemoryPoolSize -= mb->m_size;
+			free(mb->m_data);
+			free(mb);
+		}
+		else
+		{
+			if ( m_setMemoryData )
+			{
+				memset(mb->m_data, FREEED_MEMORY_CONTENT, mb->m_pos);
+			}
+			mb->m_pos = 0;
+			mb->m_freeSize = 0;
+			prev = mb;
+		}
+		mb = next;
+	}
+
+	m_usedMemoryPoolSize = 0;
+	m_freeMemoryPoolSize = m_totalMemoryPoolSize;
+}
+
 bool MemoryPool::WriteMemoryDumpToFile(const char *fileName) const
 {
 	spl::IStreamPtr writer = File::OpenWrite(fileName);
@@ -248,9 +248,13 @@ void Event::Wait()
 		struct timeval tp;
 		
 		gettimeofday(&tp, NULL);
-		ts.tv_sec  = tp.tv_sec;
-		ts.tv_nsec = tp.tv_usec * 1000;
-		ts.tv_sec += m_timeoutMs / 1000;
+		ts.tv_sec  = tp.tv_sec + m_timeoutMs / 1000;
+		ts.tv_nsec = tp.tv_usec * 1000 + (m_timeoutMs % 1000) * 1000000;
+		if ( ts.tv_nsec >= 1000000000 )
+		{
+			ts.tv_sec++;
+			ts.tv_nsec -= 1000000000;
+		}
 		
 		ret = pthread_cond_timedwait(&cond, &mtx, &ts);
 	}
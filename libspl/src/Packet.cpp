@@ -15,6 +15,7 @@
  *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <stdlib.h>
+#include <string.h>
 
 #include <spl/net/Packet.h>
 #include <spl/net/PacketBuilder.h>
@@ -77,20 +78,313 @@ void PacketListenerDelegateDispatch::CheckMem() const
 }
 #endif
 
+int16 PacketFrame::_NextRaw16()
+{
+	int b0 = _Next();
+	int b1 = _Next();
+	return m_revbytes ? (int16)(b0 | (b1 << 8)) : (int16)((b0 << 8) | b1);
+}
+
+int32 PacketFrame::_NextRaw32()
+{
+	if ( m_len - m_pos < 4 )
+	{
+		throw new PacketUnderflowException();
+	}
+	const byte *p = &m_data[m_pos];
+	m_pos += 4;
+	if ( m_revbytes )
+	{
+		return (int32)((uint32)p[0] | ((uint32)p[1] << 8) | ((uint32)p[2] << 16) | ((uint32)p[3] << 24));
+	}
+	return (int32)(((uint32)p[0] << 24) | ((uint32)p[1] << 16) | ((uint32)p[2] << 8) | (uint32)p[3]);
+}
+
+uint64 PacketFrame::_NextVarintLong()
+{
+	uint64 i = 0;
+	for ( int shift = 0; shift < 64; shift += 7 )
+	{
+		byte b = _Next();
+		i |= (uint64)(b & 0x7F) << shift;
+		if ( 0 == (b & 0x80) )
+		{
+			return i;
+		}
+	}
+	throw new ProtocolException("Malformed varint");
+}
+
+const byte *PacketFrame::_NextSpan(int len)
+{
+	if ( 0 > len || len > m_len - m_pos )
+	{
+		throw new PacketUnderflowException();
+	}
+	const byte *p = &m_data[m_pos];
+	m_pos += len;
+	return p;
+}
+
+int64 PacketFrame::NextInt64()
+{
+	byte datatype = _Next();
+	if ( (byte)'l' == datatype )
+	{
+		uint64 i = _NextVarint();
+		return (int64)(i >> 1) ^ -(int64)(i & 1);
+	}
+	if ( (byte)'L' != datatype )
+	{
+		throw new PacketReadTypeMismatchException("Expected int64");
+	}
+	int64 i = (int64)(uint32)_NextRaw32();
+	int64 i2 = (int64)(uint32)_NextRaw32();
+	return m_revbytes ? ((i2 << 32) | i) : ((i << 32) | i2);
+}
+
+int32 PacketFrame::NextInt32()
+{
+	byte datatype = _Next();
+	if ( (byte)'i' == datatype )
+	{
+		uint32 i = (uint32)_NextVarint();
+		return (int32)(i >> 1) ^ -(int32)(i & 1);
+	}
+	if ( (byte)'I' != datatype )
+	{
+		throw new PacketReadTypeMismatchException("Expected int32");
+	}
+	return _NextRaw32();
+}
+
+int16 PacketFrame::NextInt16()
+{
+	if ( (byte)'X' != _Next() )
+	{
+		throw new PacketReadTypeMismatchException("Expected int16");
+	}
+	return _NextRaw16();
+}
+
+byte PacketFrame::NextInt8()
+{
+	if ( (byte)'B' != _Next() )
+	{
+		throw new PacketReadTypeMismatchException("Expected byte");
+	}
+	return _Next();
+}
+
+bool PacketFrame::NextBool()
+{
+	if ( (byte)'F' != _Next() )
+	{
+		throw new PacketReadTypeMismatchException("Expected bool");
+	}
+	return _Next() != 0;
+}
+
+double PacketFrame::NextDouble()
+{
+	if ( (byte)'d' != _Next() )
+	{
+		throw new PacketReadTypeMismatchException("Expected double");
+	}
+	int len = _Next();
+	const byte *p = _NextSpan(len);
+
+	// The length is one byte, so this always fits.
+	char buf[256];
+	memcpy(buf, p, len);
+	buf[len] = '\0';
+	double val;
+	sscanf(buf, "%lf", &val);
+	return val;
+}
+
+DateTime PacketFrame::NextDateTime()
+{
+	if ( (byte)'T' != _Next() )
+	{
+		throw new PacketReadTypeMismatchException("Expected DateTime type char");
+	}
+
+	int year = _NextRaw16();
+	int month = (int)_Next();
+	int day = (int)_Next();
+	int hour = (int)_Next();
+	int min = (int)_Next();
+	int sec = (int)_Next();
+
+	return DateTime(year, month, day, hour, min, sec);
+}
+
+Date PacketFrame::NextDate()
+{
+	if ( (byte)'D' != _Next() )
+	{
+		throw new PacketReadTypeMismatchException("Expected Date type char");
+	}
+
+	int year = _NextRaw16();
+	int month = (int)_Next();
+	int day = (int)_Next();
+
+	return Date(year, month, day);
+}
+
+StringView PacketFrame::NextStringView()
+{
+	byte datatype = _Next();
+	int numchars;
+
+	if ( (byte)'s' == datatype )
+	{
+		numchars = (int)_NextVarint();
+	}
+	else if ( (byte)'S' == datatype )
+	{
+		numchars = (uint16)_NextRaw16();
+		if ( 1 != _Next() )
+		{
+			throw new PacketReadTypeMismatchException("Wide strings can't be viewed; use NextString");
+		}
+	}
+	else
+	{
+		throw new PacketReadTypeMismatchException("Expected string type char");
+	}
+
+	return StringView((const char *)_NextSpan(numchars), numchars);
+}
+
+StringPtr PacketFrame::NextString()
+{
+	if ( 'S' != PeekType() )
+	{
+		StringView str = NextStringView();
+		return StringPtr(new String(str.GetChars(), str.Length()));
+	}
+
+	m_pos++;
+	int numchars = (uint16)_NextRaw16();
+	int charsize = _Next();
+	if ( 1 == charsize )
+	{
+		return StringPtr(new String((const char *)_NextSpan(numchars), numchars));
+	}
+	if ( 2 != charsize && 4 != charsize )
+	{
+		throw new PacketReadTypeMismatchException("Unknown string character size");
+	}
+
+	// Only the low byte of each wide character is kept.
+	const byte *p = _NextSpan(numchars * charsize);
+	StringBuffer buf(numchars + 1);
+	for ( int x = 0; x < numchars; x++ )
+	{
+		buf.Append( (char)p[x * charsize] );
+	}
+	buf.Append('\0');
+	buf.ValidateMem();
+	return buf.ToString();
+}
+
+PacketBytesView PacketFrame::NextBytesView()
+{
+	byte datatype = _Next();
+	int len;
+	if ( (byte)'r' == datatype )
+	{
+		len = (int)_NextVarint();
+	}
+	else if ( (byte)'R' == datatype )
+	{
+		len = (uint16)_NextRaw16();
+	}
+	else
+	{
+		throw new PacketReadTypeMismatchException("Expected raw data");
+	}
+	return PacketBytesView(_NextSpan(len), len);
+}
+
+void PacketFrame::Skip()
+{
+	switch ( PeekType() )
+	{
+	case 'l':
+	case 'i':
+		m_pos++;
+		_NextVarint();
+		break;
+	case 'L':
+		_NextSpan(9);
+		break;
+	case 'I':
+		_NextSpan(5);
+		break;
+	case 'X':
+		_NextSpan(3);
+		break;
+	case 'B':
+	case 'F':
+		_NextSpan(2);
+		break;
+	case 's':
+	case 'r':
+		m_pos++;
+		_NextSpan((int)_NextVarint());
+		break;
+	case 'S':
+	{
+		m_pos++;
+		int numchars = (uint16)_NextRaw16();
+		_NextSpan(numchars * _Next());
+		break;
+	}
+	case 'R':
+		m_pos++;
+		_NextSpan((uint16)_NextRaw16());
+		break;
+	case 'd':
+		m_pos++;
+		_NextSpan(_Next());
+		break;
+	case 'T':
+		_NextSpan(8);
+		break;
+	case 'D':
+		_NextSpan(5);
+		break;
+	default:
+		throw new PacketReadTypeMismatchException("Unknown type char");
+	}
+}
+
+/*#################################################*/
+
 Packet::Packet()
-:	m_buf(), 
+:	m_abuf(128),
+	m_buf(), 
+	m_version(PACKET_WIRE_V2),
 	m_readPacketReady(false),
-	m_abuf(1)
+	m_rpacketsize(0),
+	m_frame()
 {
 	Clear();
 }
 
 Packet::Packet(const Packet& pkt)
-:	m_buf(pkt.m_buf), 
+:	m_abuf(pkt.m_abuf),
+	m_buf(pkt.m_buf), 
+	m_version(pkt.m_version),
 	m_readPacketReady(pkt.m_readPacketReady), 
-	m_readpos(pkt.m_readpos),
-	m_abuf(1)
+	m_rpacketsize(pkt.m_rpacketsize),
+	m_frame(m_abuf.Data(), pkt.m_frame.Length(), pkt.m_frame.Version(), pkt.m_frame.IsReversed())
 {
+	m_frame.SetPosition(pkt.m_frame.Position());
 }
 
 Packet::~Packet()
@@ -101,9 +395,13 @@ Packet& Packet::operator =(const Packet& pkt)
 {
 	Clear();
 
+	m_abuf = pkt.m_abuf;
 	m_buf = pkt.m_buf;
+	m_version = pkt.m_version;
 	m_readPacketReady = pkt.m_readPacketReady;
-	m_readpos = pkt.m_readpos;
+	m_rpacketsize = pkt.m_rpacketsize;
+	m_frame = PacketFrame(m_abuf.Data(), pkt.m_frame.Length(), pkt.m_frame.Version(), pkt.m_frame.IsReversed());
+	m_frame.SetPosition(pkt.m_frame.Position());
 
 	return *this;
 }
@@ -111,84 +409,136 @@ Packet& Packet::operator =(const Packet& pkt)
 void Packet::Clear()
 {
 	m_buf.Clear();
-	m_readpos = 0;
-#if LITTLE_ENDIAN
-	m_buf.Add(1);
-#else
-	m_buf.Add(0);
-#endif
-	m_buf.Add(0);	// byte count MCB
-	m_buf.Add(0);	// byte count LCB
+	m_frame.SetPosition(0);
+}
+
+int Packet::FrameHeader(byte *header) const
+{
+	int count = m_buf.Count();
+	if ( PACKET_WIRE_V1 == m_version )
+	{
+		count += PACKET_V1_HEADER_SIZE;
+		if ( count > 0x7FFF )
+		{
+			throw new InvalidArgumentException("Packet is too large for the v1 wire format");
+		}
+		// v1 integers are written most significant byte first, which is
+		// flagged as 1 since that is what little endian hosts always sent.
+		header[0] = 1;
+		header[1] = (byte)(count >> 8);
+		header[2] = (byte)(count & 0xFF);
+		return PACKET_V1_HEADER_SIZE;
+	}
 
-	ASSERT(0 == m_buf.ElementAt(1));
-	ASSERT(0 == m_buf.ElementAt(2));
+	header[0] = PACKET_V2_MARK;
+	header[1] = (byte)(count >> 24);
+	header[2] = (byte)((count >> 16) & 0xFF);
+	header[3] = (byte)((count >> 8) & 0xFF);
+	header[4] = (byte)(count & 0xFF);
+	return PACKET_V2_HEADER_SIZE;
 }
 
 void Packet::SendPacket(spl::IStream& sock)
 {
-	int16 count = m_buf.Count();
-	ASSERT(0 == m_buf.ElementAt(1));
-	ASSERT(0 == m_buf.ElementAt(2));
-#if LITTLE_ENDIAN
-	m_buf.SetElementAt( count >> 8, 1 );
-	m_buf.SetElementAt( count & 0xFF, 2 );
-#else
-	m_buf.SetElementAt( count & 0xFF, 1 );
-	m_buf.SetElementAt( count >> 8, 2 );
-#endif
-	sock.Write( m_buf.ToArray(), 0, m_buf.Count() );
+	byte header[PACKET_V2_HEADER_SIZE];
+	StreamSegment segs[2];
+
+	segs[0].data = header;
+	segs[0].count = FrameHeader(header);
+	segs[1].data = m_buf.Data();
+	segs[1].count = m_buf.Count();
+
+	sock.WriteGather(segs, 2);
 }
 
-void Packet::ReadPacket(spl::IStream& sock)
+static void _ReadFully(spl::IStream& sock, Array<byte>& buf, int offset, int count)
 {
-	m_readPacketReady = false;
+	while ( count > 0 )
+	{
+		int len = sock.Read(buf, offset, count);
+		if ( 0 >= len )
+		{
+			throw new SocketException("Short read");
+		}
+		offset += len;
+		count -= len;
+	}
+}
 
-	m_buf.Clear();
-	if (1 != sock.Read(m_abuf, 0, 1) )
+int spl::PacketFrameHeader(const byte *data, int len, int& headerLen, PacketWireVersion& version, bool& revbytes)
+{
+	if ( 0 >= len )
 	{
-		throw new SocketException("Read byte order failed");
+		headerLen = PACKET_V1_HEADER_SIZE;
+		return -1;
 	}
-	m_buf.Add(m_abuf[0]);
-#if LITTLE_ENDIAN
-	m_readRevByteOrder = m_abuf[0] != 1;
-#else
-	m_readRevByteOrder = m_abuf[0] == 1;
-#endif
-	if (1 != sock.Read(m_abuf, 0, 1) )
+
+	if ( PACKET_V2_MARK == data[0] )
 	{
-		throw new SocketException("count MCB failed");
+		headerLen = PACKET_V2_HEADER_SIZE;
+		if ( PACKET_V2_HEADER_SIZE > len )
+		{
+			return -1;
+		}
+		int size = (int)(((uint32)data[1] << 24) | ((uint32)data[2] << 16) | ((uint32)data[3] << 8) | data[4]);
+		if ( 0 > size || PACKET_MAX_READ_SIZE < size )
+		{
+			throw new ProtocolException("Packet size is out of range");
+		}
+		version = PACKET_WIRE_V2;
+		revbytes = false;
+		return size + PACKET_V2_HEADER_SIZE;
 	}
-	m_buf.Add(m_abuf[0]);
-#if LITTLE_ENDIAN
-	m_rpacketsize = m_abuf[0] << 8;
-#else
-	m_rpacketsize = m_abuf[0] & 0xFF;
-#endif
-	if (1 != sock.Read(m_abuf, 0, 1) )
+	if ( 0 != data[0] && 1 != data[0] )
 	{
-		throw new SocketException("count LCB failed");
+		throw new ProtocolException("Unknown packet format");
 	}
-	m_buf.Add(m_abuf[0]);
-	ASSERT(m_buf.Count() == 3);
-#if LITTLE_ENDIAN
-	m_rpacketsize |= m_abuf[0] & 0xFF;
-#else
-	m_rpacketsize |= m_abuf[0] << 8;
-#endif
 
-	int len2 = m_rpacketsize - m_buf.Count();
-	if (m_abuf.Length() < len2)
+	headerLen = PACKET_V1_HEADER_SIZE;
+	if ( PACKET_V1_HEADER_SIZE > len )
 	{
-		m_abuf = Array<byte>(len2);
+		return -1;
 	}
-	
-	if ( len2 != sock.Read( m_abuf, 0, m_rpacketsize-m_buf.Count()) )
+	version = PACKET_WIRE_V1;
+	revbytes = 0 == data[0];
+	int size = revbytes ? (data[1] | (data[2] << 8)) : ((data[1] << 8) | data[2]);
+	if ( PACKET_V1_HEADER_SIZE > size )
+	{
+		throw new ProtocolException("Packet size is out of range");
+	}
+	return size;
+}
+
+void Packet::ReadPacket(spl::IStream& sock)
+{
+	m_readPacketReady = false;
+	m_frame = PacketFrame();
+
+	// Both versions have at least three header bytes, so they're read
+	// together without taking anything from the next frame.
+	ASSERT(m_abuf.Length() >= PACKET_V2_HEADER_SIZE);
+	_ReadFully(sock, m_abuf, 0, PACKET_V1_HEADER_SIZE);
+
+	int hlen;
+	PacketWireVersion version = PACKET_WIRE_V2;
+	bool revbytes = false;
+	int size = PacketFrameHeader(m_abuf.Data(), PACKET_V1_HEADER_SIZE, hlen, version, revbytes);
+	if ( 0 > size )
+	{
+		_ReadFully(sock, m_abuf, PACKET_V1_HEADER_SIZE, hlen - PACKET_V1_HEADER_SIZE);
+		size = PacketFrameHeader(m_abuf.Data(), hlen, hlen, version, revbytes);
+		ASSERT(0 <= size);
+	}
+	int len = size - hlen;
+
+	if ( m_abuf.Length() < len )
 	{
-		throw new SocketException("Short read");
+		m_abuf = Array<byte>(len > m_abuf.Length() * 2 ? len : m_abuf.Length() * 2);
 	}
-	m_buf.AddRange(m_abuf, len2);
-	m_buf.SetCount(m_rpacketsize);
-	m_readpos = 3;
+	_ReadFully(sock, m_abuf, 0, len);
+
+	m_rpacketsize = size;
+	m_frame = PacketFrame(m_abuf.Data(), len, version, revbytes);
 	m_readPacketReady = true;
 }
 
@@ -199,142 +549,128 @@ void Packet::_AppendRaw( byte i )
 
 void Packet::_AppendRaw( int16 i )
 {
-#if LITTLE_ENDIAN
 	m_buf.Add( (byte)((i >> 8) & 0xFF) );
 	m_buf.Add( (byte)(i & 0xFF) );
-#else
-	m_buf.Add( (byte)(i & 0xFF) );
-	m_buf.Add( (byte)((i >> 8) & 0xFF) );
-#endif
 }
 
 void Packet::_AppendRaw( int32 i )
 {
-#if LITTLE_ENDIAN
 	m_buf.Add( (byte)(i >> 24) );
 	m_buf.Add( (byte)((i >> 16) & 0xFF) );
 	m_buf.Add( (byte)((i >> 8) & 0xFF) );
 	m_buf.Add( (byte)(i & 0xFF) );
-#else
-	m_buf.Add( (byte)(i & 0xFF) );
-	m_buf.Add( (byte)((i >> 8) & 0xFF) );
-	m_buf.Add( (byte)((i >> 16) & 0xFF) );
-	m_buf.Add( (byte)(i >> 24) );
-#endif
 }
 
 void Packet::_AppendRaw( int64 i )
 {
-#if LITTLE_ENDIAN
-	m_buf.Add( (byte)(i >> 56) & 0xFF );
-	m_buf.Add( (byte)(i >> 48) & 0xFF );
-	m_buf.Add( (byte)(i >> 40) & 0xFF );
-	m_buf.Add( (byte)(i >> 32) & 0xFF );
-	m_buf.Add( (byte)(i >> 24) & 0xFF );
-	m_buf.Add( (byte)((i >> 16) & 0xFF) );
-	m_buf.Add( (byte)((i >> 8) & 0xFF) );
-	m_buf.Add( (byte)(i & 0xFF) );
-#else
-	m_buf.Add( (byte)(i & 0xFF) );
-	m_buf.Add( (byte)((i >> 8) & 0xFF) );
-	m_buf.Add( (byte)((i >> 16) & 0xFF) );
-	m_buf.Add( (byte)(i >> 24) & 0xFF );
-	m_buf.Add( (byte)(i >> 32) & 0xFF );
-	m_buf.Add( (byte)(i >> 40) & 0xFF );
-	m_buf.Add( (byte)(i >> 48) & 0xFF );
-	m_buf.Add( (byte)(i >> 56) & 0xFF );
-#endif
+	_AppendRaw( (int32)(i >> 32) );
+	_AppendRaw( (int32)(i & 0xFFFFFFFF) );
+}
+
+void Packet::_AppendVarint( uint64 i )
+{
+	while ( i >= 0x80 )
+	{
+		m_buf.Add( (byte)(i | 0x80) );
+		i >>= 7;
+	}
+	m_buf.Add( (byte)i );
 }
 
 void Packet::Append(int64 i)
 {
-	m_buf.Add( (byte)'L' );
-	_AppendRaw( i );
-	ASSERT(0 == m_buf.ElementAt(1));
-	ASSERT(0 == m_buf.ElementAt(2));
+	if ( PACKET_WIRE_V1 == m_version )
+	{
+		m_buf.Add( (byte)'L' );
+		_AppendRaw( i );
+	}
+	else
+	{
+		// zigzag, so small negative numbers are short too
+		m_buf.Add( (byte)'l' );
+		_AppendVarint( ((uint64)i << 1) ^ (uint64)(i >> 63) );
+	}
 }
 
 void Packet::Append(int32 i)
 {
-	m_buf.Add( (byte)'I' );
-	_AppendRaw( i );
-	ASSERT(0 == m_buf.ElementAt(1));
-	ASSERT(0 == m_buf.ElementAt(2));
+	if ( PACKET_WIRE_V1 == m_version )
+	{
+		m_buf.Add( (byte)'I' );
+		_AppendRaw( i );
+	}
+	else
+	{
+		m_buf.Add( (byte)'i' );
+		_AppendVarint( ((uint32)i << 1) ^ (uint32)(i >> 31) );
+	}
 }
 
 void Packet::Append(int16 i)
 {
 	m_buf.Add( (byte)'X' );
 	_AppendRaw( i );
-	ASSERT(0 == m_buf.ElementAt(1));
-	ASSERT(0 == m_buf.ElementAt(2));
 }
 
 void Packet::Append(byte i)
 {
 	m_buf.Add( (byte)'B' );
 	m_buf.Add( i );
-	ASSERT(0 == m_buf.ElementAt(1));
-	ASSERT(0 == m_buf.ElementAt(2));
 }
 
 void Packet::Append(bool b)
 {
 	m_buf.Add( (byte)'F' );
 	m_buf.Add( (b)?1:0 );
-	ASSERT(0 == m_buf.ElementAt(1));
-	ASSERT(0 == m_buf.ElementAt(2));
 }
 
 void Packet::Append(const char *str, int count)
 {
+	if ( PACKET_WIRE_V2 == m_version )
+	{
+		m_buf.Add( (byte)'s' );
+		_AppendVarint( (uint64)count );
+		m_buf.AddRange( (const byte *)str, count );
+		return;
+	}
+
+	if ( count > 0x7FFF )
+	{
+		throw new InvalidArgumentException("String is too long for the v1 wire format");
+	}
+
 	// append datatype
 	m_buf.Add( (byte)'S' );
 
 	// append the number of characters
-	int numchar = count;
 	_AppendRaw( (int16)count );
 
-	// append the size of each char
-	byte charsize = (byte)sizeof(char);
-	_AppendRaw( charsize );
-	
-	if ( 1 == charsize )
+	// append the size of each char, which is always one now
+	_AppendRaw( (byte)sizeof(char) );
+	m_buf.AddRange( (const byte *)str, count );
+}
+
+void Packet::Append(const Array<byte>& buf, int start, int len)
+{
+	if ( start + len > buf.Length() )
 	{
-		for ( int x = 0; x < numchar; x++ )
-		{
-			m_buf.Add( (byte)str[x] );
-		}
+		throw new IndexOutOfBoundsException();
 	}
-	else if ( 2 == charsize )
+	if ( PACKET_WIRE_V2 == m_version )
 	{
-		for ( int x = 0; x < numchar; x++ )
-		{
-			_AppendRaw( (int16)str[x] );
-		}
+		_AppendRaw( (byte)'r' );
+		_AppendVarint( (uint64)len );
 	}
 	else
 	{
-		for ( int x = 0; x < numchar; x++ )
+		if ( len > 0x7FFF )
 		{
-			_AppendRaw( (int32)str[x] );
+			throw new InvalidArgumentException("Buffer is too long for the v1 wire format");
 		}
+		_AppendRaw( (byte)'R' );
+		_AppendRaw( (int16)len );
 	}
-	ASSERT(0 == m_buf.ElementAt(1));
-	ASSERT(0 == m_buf.ElementAt(2));
-}
-
-void Packet::Append(const Array<byte>& buf, int start, int len)
-{
-	_AppendRaw( (byte)'R' );
-	_AppendRaw( (int16)(len - start) );
-
-	for ( int x = start; x < start+len; x++ )
-	{
-		_AppendRaw( buf[x] );
-	}
-	ASSERT(0 == m_buf.ElementAt(1));
-	ASSERT(0 == m_buf.ElementAt(2));
+	m_buf.AddRange( &buf.Data()[start], len );
 }
 
 //void Packet::Append(float f)
@@ -350,8 +686,6 @@ void Packet::Append(const Array<byte>& buf, int start, int len)
 //	{
 //		m_buf.Add( (byte)buf[x] );
 //	}
-//	ASSERT(0 == m_buf.ElementAt(1));
-//	ASSERT(0 == m_buf.ElementAt(2));
 //}
 
 void Packet::Append(double d)
@@ -362,13 +696,7 @@ void Packet::Append(double d)
 	
 	_AppendRaw( (byte)'d' );
 	_AppendRaw( (byte)numchars );
-
-	for ( int x = 0; x < numchars; x++ )
-	{
-		m_buf.Add( (byte)buf[x] );
-	}
-	ASSERT(0 == m_buf.ElementAt(1));
-	ASSERT(0 == m_buf.ElementAt(2));
+	m_buf.AddRange( (const byte *)buf, numchars );
 }
 
 void Packet::Append(const DateTime& dtm)
@@ -396,172 +724,53 @@ int Packet::PacketSize()
 	{
 		throw new PacketNotReadyException("Packet must be in read state to get size");
 	}
-	return m_buf.Count();
+	return m_rpacketsize;
 }
 
 int64 Packet::ReadInt64()
 {
-	if ( ! m_readPacketReady )
-	{
-		throw new PacketNotReadyException("Packet must be in read state to get size");
-	}
-	byte datatype = _NextByte();
-	if ( (byte)'L' != datatype )
-	{
-		throw new PacketReadTypeMismatchException("Expected int64");
-	}
-#if LITTLE_ENDIAN
-	int64 i = (_NextByte() << 24) | (_NextByte() << 16) | (_NextByte() << 8) | (_NextByte());
-	i <<= 32;
-	return i | ((_NextByte() << 24) | (_NextByte() << 16) | (_NextByte() << 8) | (_NextByte()));
-#else
-	int64 i = _NextByte() | (_NextByte() << 8) | (_NextByte() << 16) | (_NextByte() << 24);
-	int64 i2 = _NextByte() | (_NextByte() << 8) | (_NextByte() << 16) | (_NextByte() << 24);
-	return (i2 << 32) | i;
-#endif
+	return _ReadFrame().NextInt64();
 }
 
 int32 Packet::ReadInt32()
 {
-	if ( ! m_readPacketReady )
-	{
-		throw new PacketNotReadyException("Packet must be in read state to get size");
-	}
-	byte datatype = _NextByte();
-	if ( (byte)'I' != datatype )
-	{
-		throw new PacketReadTypeMismatchException("Expected int32");
-	}
-#if LITTLE_ENDIAN
-	return (_NextByte() << 24) | (_NextByte() << 16) | (_NextByte() << 8) | (_NextByte());
-#else
-	return _NextByte() | (_NextByte() << 8) | (_NextByte() << 16) | (_NextByte() << 24);
-#endif
+	return _ReadFrame().NextInt32();
 }
 
 int16 Packet::ReadInt16()
 {
-	if ( ! m_readPacketReady )
-	{
-		throw new PacketNotReadyException("Packet must be in read state to get size");
-	}
-	byte datatype = _NextByte();
-	if ( (byte)'X' != datatype )
-	{
-		throw new PacketReadTypeMismatchException("Expected int16");
-	}
-#if LITTLE_ENDIAN
-	return (int16)((_NextByte() << 8) | (_NextByte()));
-#else
-	return (int16)(_NextByte() | (_NextByte() << 8));
-#endif
+	return _ReadFrame().NextInt16();
 }
 
 byte Packet::ReadInt8()
 {
-	if ( ! m_readPacketReady )
-	{
-		throw new PacketNotReadyException("Packet must be in read state to get size");
-	}
-	byte datatype = _NextByte();
-	if ( (byte)'B' != datatype )
-	{
-		throw new PacketReadTypeMismatchException("Expected byte");
-	}
-	return (byte)_NextByte();
+	return _ReadFrame().NextInt8();
 }
 
 bool Packet::ReadBool()
 {
-	if ( ! m_readPacketReady )
-	{
-		throw new PacketNotReadyException("Packet must be in read state to get size");
-	}
-	byte datatype = _NextByte();
-	if ( (byte)'F' != datatype )
-	{
-		throw new PacketReadTypeMismatchException("Expected bool");
-	}
-	return _NextByte() != 0;
+	return _ReadFrame().NextBool();
 }
 
 StringPtr Packet::ReadString()
 {
-	if ( ! m_readPacketReady )
-	{
-		throw new PacketNotReadyException("Packet must be in read state to get size");
-	}
-	byte datatype = _NextByte();
-	if ( (byte)'S' != datatype )
-	{
-		throw new PacketReadTypeMismatchException("Expected string type char");
-	}
-
-	int16 numchars = (_NextByte() << 8) | _NextByte();
-	int charsize = (byte)_NextByte();
-
-	StringBuffer buf(80);
-
-	if ( charsize == 1 )
-	{
-		for ( int x = 0; x < numchars; x++ )
-		{
-			buf.Append( (char)_NextByte() );
-		}
-	}
-	else if ( charsize == 2 )
-	{
-		for ( int x = 0; x < numchars; x++ )
-		{
-			buf.Append( (char)_NextByte() );
-			_NextByte();
-		}
-	}
-	else
-	{
-		for ( int x = 0; x < numchars; x++ )
-		{
-			buf.Append( (char)_NextByte() );
-			_NextByte();
-			_NextByte();
-			_NextByte();
-		}
-	}
-	buf.Append('\0');
-	buf.ValidateMem();
-	return buf.ToString();
+	return _ReadFrame().NextString();
 }
 
 byte *Packet::ReadBuf(int expectedlen)
 {
-	if ( ! m_readPacketReady )
-	{
-		throw new PacketNotReadyException("Packet must be in read state to get size");
-	}
-	byte datatype = _NextByte();
-	if ( (byte)'R' != datatype )
-	{
-		throw new PacketReadTypeMismatchException("Expected raw data");
-	}
-	int16 len = ReadInt16();
-	if ( len != expectedlen )
+	PacketBytesView data = _ReadFrame().NextBytesView();
+	if ( data.Length() != expectedlen )
 	{
 		throw new PacketUnderflowException();
 	}
-	ASSERT( 0 != len );
-	if ( len > m_buf.Count() - m_readpos )
-	{
-		throw new PacketUnderflowException();
-	}
-	byte *buf = (byte *)malloc( len );
+	ASSERT( 0 != expectedlen );
+	byte *buf = (byte *)malloc( expectedlen );
 	if ( NULL == buf )
 	{
 		return NULL;
 	}
-	for ( int x = 0; x < len; x++ )
-	{
-		buf[x] = _NextByte();
-	}
+	memcpy( buf, data.Data(), expectedlen );
 	return buf;
 }
 
@@ -591,59 +800,17 @@ byte *Packet::ReadBuf(int expectedlen)
 
 double Packet::ReadDouble()
 {
-	if ( ! m_readPacketReady )
-	{
-		throw new PacketNotReadyException("Packet must be in read state to get size");
-	}
-	byte datatype = _NextByte();
-	if ( (byte)'d' != datatype )
-	{
-		throw new PacketReadTypeMismatchException("Expected double");
-	}
-	int len = _NextByte();
-	StringBuffer buf(len+1);
-
-	for ( int x = 0; x < len; x++ )
-	{
-		buf.Append( (char)_NextByte() );
-	}
-	buf.Append('\0');
-	double val;
-	sscanf(buf.GetChars(), "%lf", &val);
-	return val;
+	return _ReadFrame().NextDouble();
 }
 
 DateTime Packet::ReadDateTime()
 {
-	byte datatype = _NextByte();
-	if ( (byte)'T' != datatype )
-	{
-		throw new PacketReadTypeMismatchException("Expected DateTime type char");
-	}
-
-	int year = (int)_NextByte() << 8 | (int)_NextByte();
-	int month = (int)_NextByte();
-	int day = (int)_NextByte();
-	int hour = (int)_NextByte();
-	int min = (int)_NextByte();
-	int sec = (int)_NextByte();
-
-	return DateTime(year, month, day, hour, min, sec);
+	return _ReadFrame().NextDateTime();
 }
 
 Date Packet::ReadDate()
 {
-	byte datatype = _NextByte();
-	if ( (byte)'D' != datatype )
-	{
-		throw new PacketReadTypeMismatchException("Expected Date type char");
-	}
-
-	int year = (int)_NextByte() << 8 | (int)_NextByte();
-	int month = (int)_NextByte();
-	int day = (int)_NextByte();
-
-	return Date(year, month, day);
+	return _ReadFrame().NextDate();
 }
 
 #if defined(DEBUG) || defined(_DEBUG)
@@ -667,7 +834,7 @@ IPacketListener::~IPacketListener()
 }
 
 PacketBuilder::PacketBuilder(/*IPacketListener *listener*/)
-: m_listeners(), m_state(PKT_ENDIAN), m_buf(), m_readPos(0), m_pktsize(0)
+: m_listeners(), m_state(PKT_ENDIAN), m_pktsize(0), m_varint(0), m_varshift(0), m_buf(), m_readPos(0)
 {
 }
 
@@ -689,6 +856,18 @@ void PacketBuilder::IStreamRead_OnClose()
 	m_listeners.DispatchOnClose();
 }
 
+void PacketBuilder::_BeginData()
+{
+	if ( 0 == m_datalen )
+	{
+		_ParseData();
+	}
+	else
+	{
+		m_state = PKT_DATA;
+	}
+}
+
 void PacketBuilder::IStreamRead_OnRead(const Array<byte>& buf, int len)
 {
 	for (int bufpos = 0; bufpos < len; bufpos++ )
@@ -707,42 +886,58 @@ void PacketBuilder::IStreamRead_OnRead(const Array<byte>& buf, int len)
 		{
 		case PKT_ENDIAN:
 			m_readPos = 1;
-			if ( b == 1 )
+			m_pktsize = 0;
+			if ( PACKET_V2_MARK == b )
 			{
-				m_isLittleEndian = true;
+				m_revbytes = false;
+				m_varint = 0;
+				m_state = PKT_V2_SIZE;
+				break;
 			}
-			else
+			if ( 1 < b )
 			{
-				m_isLittleEndian = false;
+				m_state = PKT_ERROR;
+				throw new IOException("Unknown packet format received");
 			}
-#if LITTLE_ENDIAN
+			// v1 values are most significant byte first when this is 1
+			m_isLittleEndian = b == 1;
 			m_revbytes = !m_isLittleEndian;
-#else
-			m_revbytes = m_isLittleEndian;
-#endif
 			m_state = PKT_SIZE_MCB;
 			break;
 		case PKT_SIZE_MCB:
-#if LITTLE_ENDIAN
-			m_pktsize = b << 8;
-#else
-			m_pktsize = b & 0xFF;
-#endif
+			m_pktsize = m_revbytes ? b : b << 8;
 			m_state = PKT_SIZE_LCB;
 			break;
 		case PKT_SIZE_LCB:
-#if LITTLE_ENDIAN
-			m_pktsize |= b & 0xFF;
-#else
-			m_pktsize |= b << 8;
-#endif
-			ASSERT(m_pktsize > 0);
+			m_pktsize |= m_revbytes ? b << 8 : b;
+			if ( m_pktsize < PACKET_V1_HEADER_SIZE )
+			{
+				m_state = PKT_ERROR;
+				throw new IOException("Invalid packet size received");
+			}
 			m_state = PKT_DT;
 			break;
+		case PKT_V2_SIZE:
+			m_varint = (m_varint << 8) | b;
+			if ( PACKET_V2_HEADER_SIZE == m_readPos )
+			{
+				if ( m_varint > PACKET_MAX_READ_SIZE )
+				{
+					m_state = PKT_ERROR;
+					throw new IOException("Invalid packet size received");
+				}
+				m_pktsize = (int32)m_varint + PACKET_V2_HEADER_SIZE;
+				m_state = PKT_DT;
+			}
+			break;
 		case PKT_DT:
 			m_datatype = (char)b;
 			switch ( m_datatype )
 			{
+			case 'L':
+				m_datalen = 8;
+				m_state = PKT_DATA;
+				break;
 			case 'I':
 				m_datalen = 4;
 				m_state = PKT_DATA;
@@ -761,6 +956,19 @@ void PacketBuilder::IStreamRead_OnRead(const Array<byte>& buf, int len)
 			case 'R':
 				m_state = PKT_DT_LEN_MCB;
 				break;
+			case 'i':
+			case 'l':
+				m_varint = 0;
+				m_varshift = 0;
+				m_state = PKT_VARINT;
+				break;
+			case 's':
+			case 'r':
+				m_charsize = 1;
+				m_varint = 0;
+				m_varshift = 0;
+				m_state = PKT_DT_VARLEN;
+				break;
 			case 'F':
 				m_datalen = 1;
 				m_state = PKT_DATA;
@@ -771,12 +979,13 @@ void PacketBuilder::IStreamRead_OnRead(const Array<byte>& buf, int len)
 			//	break;
 			case 'd':
 				m_charsize = 1;
-				m_state = PKT_DT_LEN_MCB;
+				m_state = PKT_DT_LEN8;
 				break;
 			case 'D':
 				m_datalen = 4;
 				m_state = PKT_DATA;
 				break;
+			case 'T':
 			case 't':
 				m_datalen = 7;
 				m_state = PKT_DATA;
@@ -787,32 +996,60 @@ void PacketBuilder::IStreamRead_OnRead(const Array<byte>& buf, int len)
 			}
 			break;
 		case PKT_DT_LEN_MCB:
-#if LITTLE_ENDIAN
-			m_datalen = b << 8;
-#else
-			m_datalen = b & 0xFF;
-#endif
+			m_datalen = m_revbytes ? b : b << 8;
 			m_state = PKT_DT_LEN_LCB;
 			break;
 		case PKT_DT_LEN_LCB:
-#if LITTLE_ENDIAN
-			m_datalen |= b & 0xFF;
-#else
-			m_datalen |= b << 8;
-#endif
+			m_datalen |= m_revbytes ? b << 8 : b;
 			if ( m_datatype == 'S' )
 			{
 				m_state = PKT_CHARSIZE;
 			}
 			else
 			{
-				m_state = PKT_DATA;
+				_BeginData();
+			}
+			break;
+		case PKT_DT_LEN8:
+			m_datalen = b;
+			_BeginData();
+			break;
+		case PKT_DT_VARLEN:
+			m_varint |= (uint64)(b & 0x7F) << m_varshift;
+			m_varshift += 7;
+			if ( 0 == (b & 0x80) )
+			{
+				if ( m_varint > PACKET_MAX_READ_SIZE )
+				{
+					m_state = PKT_ERROR;
+					throw new IOException("Invalid length received");
+				}
+				m_datalen = (int32)m_varint;
+				_BeginData();
+			}
+			else if ( m_varshift >= 35 )
+			{
+				m_state = PKT_ERROR;
+				throw new IOException("Invalid length received");
 			}
 			break;
 		case PKT_CHARSIZE:
 			m_charsize = b;
 			m_datalen *= m_charsize;
-			m_state = PKT_DATA;
+			_BeginData();
+			break;
+		case PKT_VARINT:
+			m_varint |= (uint64)(b & 0x7F) << m_varshift;
+			m_varshift += 7;
+			if ( 0 == (b & 0x80) )
+			{
+				_ParseData();
+			}
+			else if ( m_varshift >= 70 )
+			{
+				m_state = PKT_ERROR;
+				throw new IOException("Invalid varint received");
+			}
 			break;
 		case PKT_DATA:
 			m_buf.Add( b );
@@ -828,19 +1065,41 @@ void PacketBuilder::IStreamRead_OnRead(const Array<byte>& buf, int len)
 		}
 	}
 
-	if (m_readPos == m_pktsize)
+	if (m_pktsize > 0 && m_readPos == m_pktsize)
 	{
 		m_state = PKT_ENDIAN;
 	}
-	ASSERT(m_readPos <= m_pktsize);
+	ASSERT(0 == m_pktsize || m_readPos <= m_pktsize);
 }
 
 void PacketBuilder::_ParseData()
 {
 	int year;
+	int64 i64;
 	StringPtr str;
 	switch ( m_datatype )
 	{
+		case 'i':
+			m_listeners.DispatchOnData((int32)((int64)(m_varint >> 1) ^ -(int64)(m_varint & 1)));
+			break;
+		case 'l':
+			m_listeners.DispatchOnData((int64)(m_varint >> 1) ^ -(int64)(m_varint & 1));
+			break;
+		case 'L':
+			i64 = 0;
+			for ( int x = 0; x < 8; x++ )
+			{
+				if (m_revbytes)
+				{
+					i64 |= (int64)m_buf.ElementAt(x) << (8 * x);
+				}
+				else
+				{
+					i64 = (i64 << 8) | m_buf.ElementAt(x);
+				}
+			}
+			m_listeners.DispatchOnData(i64);
+			break;
 		case 'I':
 			if (m_revbytes)
 			{
@@ -870,11 +1129,13 @@ void PacketBuilder::_ParseData()
 			m_listeners.DispatchOnData( (byte)m_buf.ElementAt(0) );
 			break;
 		case 'S':
+		case 's':
 			str = _ParseString();
 			//m_listener->IPacket_OnData(str);
 			m_listeners.DispatchOnData(str);
 			break;
 		case 'R':
+		case 'r':
 			//m_listener->IPacket_OnData(m_buf, m_datalen);
 			m_listeners.DispatchOnData(m_buf, m_datalen);
 			break;
@@ -894,6 +1155,7 @@ void PacketBuilder::_ParseData()
 			//m_listener->IPacket_OnData(d);
 			m_listeners.DispatchOnData(d);
 			break;
+		case 'T':
 		case 't':
 			if (m_revbytes)
 			{
@@ -1019,6 +1281,102 @@ void PacketBuilder::ValidateMem() const
 }
 #endif
 
+/*#################################################*/
+
+IPacketFrameListener::~IPacketFrameListener()
+{
+}
+
+PacketFrameBuilder::PacketFrameBuilder(IPacketFrameListener *listener)
+: m_listener(listener), m_pending(), m_frames(0)
+{
+}
+
+PacketFrameBuilder::~PacketFrameBuilder()
+{
+}
+
+void PacketFrameBuilder::IStreamRead_OnError(const String& msg)
+{
+	m_pending.Clear();
+	m_listener->IStreamRead_OnError(msg);
+}
+
+void PacketFrameBuilder::IStreamRead_OnClose()
+{
+	m_pending.Clear();
+	m_listener->IStreamRead_OnClose();
+}
+
+void PacketFrameBuilder::_Dispatch(const byte *data, int size, int headerLen, PacketWireVersion version, bool revbytes)
+{
+	PacketFrame frame(&data[headerLen], size - headerLen, version, revbytes);
+	m_frames++;
+	m_listener->IPacketFrame_OnFrame(frame);
+}
+
+void PacketFrameBuilder::_Split(const byte *data, int len)
+{
+	int hlen;
+	PacketWireVersion version = PACKET_WIRE_V2;
+	bool revbytes = false;
+	int pos = 0;
+
+	while ( pos < len )
+	{
+		if ( 0 < m_pending.Count() )
+		{
+			// Finish the header, then the frame, that the last read split.
+			int size = PacketFrameHeader(m_pending.Data(), m_pending.Count(), hlen, version, revbytes);
+			int need = (0 > size ? hlen : size) - m_pending.Count();
+			int count = need < len - pos ? need : len - pos;
+			m_pending.AddRange(&data[pos], count);
+			pos += count;
+			if ( 0 <= size && m_pending.Count() == size )
+			{
+				_Dispatch(m_pending.Data(), size, hlen, version, revbytes);
+				m_pending.Clear();
+			}
+			continue;
+		}
+
+		int size = PacketFrameHeader(&data[pos], len - pos, hlen, version, revbytes);
+		if ( 0 > size || size > len - pos )
+		{
+			m_pending.AddRange(&data[pos], len - pos);
+			return;
+		}
+		_Dispatch(&data[pos], size, hlen, version, revbytes);
+		pos += size;
+	}
+}
+
+void PacketFrameBuilder::IStreamRead_OnRead(const Array<byte>& buf, int len)
+{
+	try
+	{
+		_Split(buf.Data(), len);
+	}
+	catch ( Exception *ex )
+	{
+		// Don't glue the rest of a bad frame onto the next read.
+		m_pending.Clear();
+		throw ex;
+	}
+}
+
+#if defined(DEBUG) || defined(_DEBUG)
+void PacketFrameBuilder::CheckMem() const
+{
+	m_pending.CheckMem();
+}
+
+void PacketFrameBuilder::ValidateMem() const
+{
+	m_pending.ValidateMem();
+}
+#endif
+
 ThreadedPacketStream::ThreadedPacketStream(IPacketListener *listener, spl::IStreamPtr conn)
 : m_builder(), m_conn(conn)
 {
@@ -0,0 +1,354 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#if defined(_WIN32) || defined(_WIN64)
+#include <spl/configwin32.h>
+#else
+#include <spl/autoconf/config.h>
+#endif
+
+#ifdef HAVE_SYS_TIME_H
+#include <sys/time.h>
+#endif
+
+#include <spl/Exception.h>
+#include <spl/io/log/Log.h>
+#include <spl/net/PacketSendQueue.h>
+
+using namespace spl;
+
+PacketSendQueue::PacketSendQueue(spl::IStreamPtr strm, int flushBytes, int maxLatencyMs)
+:	m_lock(),
+	m_strm(strm),
+	m_buf(flushBytes > 0 ? flushBytes : 1),
+	m_bufPackets(0),
+	m_firstQueued(0),
+	m_flushBytes(flushBytes),
+	m_maxLatencyMs(maxLatencyMs),
+	m_timer(NULL),
+	m_packets(0),
+	m_writes(0),
+	m_bytes(0),
+	m_timerFlushes(0)
+{
+}
+
+PacketSendQueue::~PacketSendQueue()
+{
+	// Read without the timer's lock: the timer must outlive the queues added
+	// to it, so only Add and Remove on this queue change m_timer.
+	if ( NULL != m_timer )
+	{
+		m_timer->Remove(this);
+	}
+	try
+	{
+		Flush();
+	}
+	catch ( Exception *ex )
+	{
+		Log::SWrite(ex);
+		delete ex;
+	}
+}
+
+int64 PacketSendQueue::NowMs()
+{
+#ifdef _WINDOWS
+	return (int64)GetTickCount();
+#else
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return (int64)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+#endif
+}
+
+void PacketSendQueue::_Write(const StreamSegment *extra, int extraCount)
+{
+	StreamSegment segs[3];
+	int count = 0;
+	int total = 0;
+
+	ASSERT(extraCount < 3);
+	if ( m_buf.Count() > 0 )
+	{
+		segs[count].data = m_buf.Data();
+		segs[count++].count = m_buf.Count();
+	}
+	for ( int x = 0; x < extraCount; x++ )
+	{
+		segs[count++] = extra[x];
+	}
+	if ( 0 == count )
+	{
+		return;
+	}
+	for ( int x = 0; x < count; x++ )
+	{
+		total += segs[x].count;
+	}
+
+	// Counted before the write, so the stats never lag QueuedCount().  A failed
+	// write may have sent part of a frame, so nothing queued is kept for a retry.
+	m_writes++;
+	m_packets += m_bufPackets;
+	m_bytes += total;
+	m_buf.Clear();
+	m_bufPackets = 0;
+
+	m_strm->WriteGather(segs, count);
+}
+
+void PacketSendQueue::Send(const Packet& pkt)
+{
+	byte header[PACKET_V2_HEADER_SIZE];
+	int hlen = pkt.FrameHeader(header);
+	int len = hlen + pkt.PayloadSize();
+
+	m_lock.Lock();
+	try
+	{
+		int64 now = m_maxLatencyMs > 0 ? NowMs() : 0;
+		if ( 0 == m_bufPackets )
+		{
+			m_firstQueued = now;
+		}
+		m_bufPackets++;
+
+		if ( m_buf.Count() + len >= m_flushBytes )
+		{
+			// It would be written now anyway, so gather it rather than copy it.
+			StreamSegment segs[2];
+			segs[0].data = header;
+			segs[0].count = hlen;
+			segs[1].data = pkt.Payload();
+			segs[1].count = pkt.PayloadSize();
+			_Write(segs, 2);
+		}
+		else
+		{
+			m_buf.AddRange(header, hlen);
+			m_buf.AddRange(pkt.Payload(), pkt.PayloadSize());
+			if ( m_maxLatencyMs > 0 && now - m_firstQueued >= m_maxLatencyMs )
+			{
+				_Write(NULL, 0);
+			}
+		}
+	}
+	catch ( Exception *ex )
+	{
+		m_lock.Unlock();
+		throw ex;
+	}
+	m_lock.Unlock();
+}
+
+void PacketSendQueue::Flush()
+{
+	m_lock.Lock();
+	try
+	{
+		_Write(NULL, 0);
+	}
+	catch ( Exception *ex )
+	{
+		m_lock.Unlock();
+		throw ex;
+	}
+	m_lock.Unlock();
+}
+
+bool PacketSendQueue::FlushIfDue(int64 now)
+{
+	bool flushed = false;
+
+	m_lock.Lock();
+	try
+	{
+		if ( m_bufPackets > 0 && m_maxLatencyMs > 0 && now - m_firstQueued >= m_maxLatencyMs )
+		{
+			m_timerFlushes++;
+			flushed = true;
+			_Write(NULL, 0);
+		}
+	}
+	catch ( Exception *ex )
+	{
+		m_lock.Unlock();
+		throw ex;
+	}
+	m_lock.Unlock();
+
+	return flushed;
+}
+
+int PacketSendQueue::QueuedCount() const
+{
+	m_lock.Lock();
+	int count = m_bufPackets;
+	m_lock.Unlock();
+	return count;
+}
+
+int64 PacketSendQueue::PacketCount() const
+{
+	m_lock.Lock();
+	int64 count = m_packets;
+	m_lock.Unlock();
+	return count;
+}
+
+int64 PacketSendQueue::WriteCount() const
+{
+	m_lock.Lock();
+	int64 count = m_writes;
+	m_lock.Unlock();
+	return count;
+}
+
+int64 PacketSendQueue::BytesWritten() const
+{
+	m_lock.Lock();
+	int64 count = m_bytes;
+	m_lock.Unlock();
+	return count;
+}
+
+int PacketSendQueue::TimerFlushCount() const
+{
+	m_lock.Lock();
+	int count = m_timerFlushes;
+	m_lock.Unlock();
+	return count;
+}
+
+double PacketSendQueue::PacketsPerWrite() const
+{
+	m_lock.Lock();
+	double ratio = 0 == m_writes ? 0.0 : (double)m_packets / (double)m_writes;
+	m_lock.Unlock();
+	return ratio;
+}
+
+#if defined(DEBUG)
+void PacketSendQueue::CheckMem() const
+{
+	m_strm.CheckMem();
+	m_buf.CheckMem();
+}
+
+void PacketSendQueue::ValidateMem() const
+{
+	m_strm.ValidateMem();
+	m_buf.ValidateMem();
+}
+#endif
+
+PacketSendTimer::PacketSendTimer(int tickMs)
+:	m_lock(),
+	m_queues(),
+	m_running(true),
+	m_tickMs(tickMs > 0 ? tickMs : 1),
+	m_thread()
+{
+	m_thread = RefCountPtr<ThreadStartDelegate<PacketSendTimer> >(new ThreadStartDelegate<PacketSendTimer>(this, &PacketSendTimer::Run));
+	m_thread->Start();
+}
+
+PacketSendTimer::~PacketSendTimer()
+{
+	Stop();
+
+	m_lock.Lock();
+	// Queues must be removed (or deleted) before their timer, otherwise a
+	// queue deleted on another thread could call Remove on a deleted timer.
+	ASSERT(0 == m_queues.Count());
+	for ( int x = 0; x < m_queues.Count(); x++ )
+	{
+		m_queues.ElementAt(x)->m_timer = NULL;
+	}
+	m_queues.Clear();
+	m_lock.Unlock();
+}
+
+void PacketSendTimer::Add(PacketSendQueue *q)
+{
+	m_lock.Lock();
+	ASSERT(NULL == q->m_timer);
+	m_queues.Add(q);
+	q->m_timer = this;
+	m_lock.Unlock();
+}
+
+void PacketSendTimer::Remove(PacketSendQueue *q)
+{
+	m_lock.Lock();
+	m_queues.Remove(q);
+	q->m_timer = NULL;
+	m_lock.Unlock();
+}
+
+void PacketSendTimer::Stop()
+{
+	m_running = false;
+
+	if ( m_thread.IsNull() )
+	{
+		return;
+	}
+	while ( m_thread->IsRunning() )
+	{
+		Thread::YYield();
+	}
+}
+
+void PacketSendTimer::Run()
+{
+	while ( m_running )
+	{
+		Thread::Sleep(m_tickMs);
+		int64 now = PacketSendQueue::NowMs();
+
+		m_lock.Lock();
+		for ( int x = 0; x < m_queues.Count(); x++ )
+		{
+			try
+			{
+				m_queues.ElementAt(x)->FlushIfDue(now);
+			}
+			catch ( Exception *ex )
+			{
+				Log::SWrite(ex);
+				delete ex;
+			}
+		}
+		m_lock.Unlock();
+	}
+}
+
+#if defined(DEBUG)
+void PacketSendTimer::CheckMem() const
+{
+	// The queues belong to their connections.
+	DEBUG_NOTE_MEM_ALLOCATION(m_queues.Data());
+	m_thread.CheckMem();
+}
+
+void PacketSendTimer::ValidateMem() const
+{
+	m_thread.ValidateMem();
+}
+#endif
@@ -15,15 +15,24 @@
  *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <spl/net/PooledSocketSet.h>
+#include <spl/net/ReactorSocketSet.h>
 
 using namespace spl;
 
-PooledSocketSet::PooledSocketSet(int poolSize)
-: m_sets(), m_socketCount(0), m_setsMtx()
+PooledSocketSet::PooledSocketSet(int poolSize, enum ServiceType type)
+: m_sets(), m_socketCount(0), m_setsMtx(), m_type(type)
 {
+#ifdef HAVE_SYS_EPOLL_H
+	if ( SERVICE_REACTOR == type )
+	{
+		// The reactor balances across its own workers.
+		m_sets.Add( ISocketServicePtr(new ReactorSocketSet(1, poolSize)) );
+		return;
+	}
+#endif
 	for ( int x = 0; x < poolSize; x++ )
 	{
-		m_sets.Add( SocketSetPtr(new SocketSet()) );
+		m_sets.Add( ISocketService::Create(type) );
 	}
 }
 
@@ -32,7 +41,7 @@ PooledSocketSet::~PooledSocketSet()
 	int count = m_sets.Count();
 	for ( int x = 0; x < count; x++ )
 	{
-		SocketSetPtr ss = m_sets.ElementAt(x);
+		ISocketServicePtr ss = m_sets.ElementAt(x);
 		ss.ValidateMem();
 		ss->CloseAndDelete();
 	}
@@ -41,13 +50,34 @@ PooledSocketSet::~PooledSocketSet()
 
 int PooledSocketSet::SocketCount() const
 { 
-	return m_socketCount; 
+	int count = 0;
+	for ( int x = 0; x < m_sets.Count(); x++ )
+	{
+		count += m_sets.ElementAt(x)->SocketCount();
+	}
+	return count; 
 }
 
 void PooledSocketSet::AddSocket( IStreamReadListenerPtr listener, TcpSocketPtr sp )
 {
 	m_setsMtx.Lock();
 
+	if ( SERVICE_SELECT != m_type && m_sets.Count() > 0 )
+	{
+		// epoll sets have no descriptor limit, so balance the load instead.
+		int least = 0;
+		for ( int x = 1; x < m_sets.Count(); x++ )
+		{
+			if ( m_sets.ElementAt(x)->SocketCount() < m_sets.ElementAt(least)->SocketCount() )
+			{
+				least = x;
+			}
+		}
+		m_sets.ElementAt(least)->AddSocket( listener, sp );
+		m_setsMtx.Unlock();
+		return;
+	}
+
 	for ( int x = 0; x < m_sets.Count(); x++ )
 	{
 		if ( m_sets.ElementAt(x)->SocketCount() < FD_SETSIZE )
@@ -151,9 +181,10 @@ PooledSocketServer::PooledSocketServer
 (
 	IServerConnectionFactory *conFactory, 
 	int serverPort, 
-	int poolSize
+	int poolSize,
+	enum ServiceType type
 )
-: m_ss(poolSize), m_listener(serverPort), m_conFactory(conFactory)
+: m_ss(poolSize, type), m_listener(serverPort), m_conFactory(conFactory)
 {
 	m_listener.Delegates().Add(this);
 }
@@ -0,0 +1,640 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* on some platforms, threads overrides IO routines */
+#include <spl/threading/Thread.h>
+#include <spl/net/ReactorSocketSet.h>
+
+#ifdef HAVE_SYS_EPOLL_H
+
+#include <spl/Environment.h>
+#include <spl/io/log/Log.h>
+
+#ifdef HAVE_ERRNO_H
+#include <errno.h>
+#endif
+#ifdef HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+using namespace spl;
+
+/* Event::Notify() isn't sticky, so Thread::Join() can miss a thread that
+   exits just before the wait starts. */
+static void _JoinThread( Thread *t )
+{
+	while ( t->IsRunning() )
+	{
+		Thread::YYield();
+	}
+}
+
+ReactorConnection::ReactorConnection(IStreamReadListenerPtr listener, TcpSocketPtr sp, int fd, int home, uint32 gen)
+: m_listener(listener), m_sp(sp), m_fd(fd), m_home(home), m_events(0), m_gen(gen), m_busy(false)
+{
+}
+
+ReactorConnection::~ReactorConnection()
+{
+}
+
+#if defined(DEBUG) || defined(_DEBUG)
+void ReactorConnection::CheckMem() const
+{
+	m_listener.CheckMem();
+	m_sp.CheckMem();
+}
+
+void ReactorConnection::ValidateMem() const
+{
+	m_listener.ValidateMem();
+	m_sp.ValidateMem();
+}
+#endif
+
+ReactorPoller::ReactorPoller(ReactorSocketSet *reactor)
+: m_reactor(reactor)
+{
+	m_epfd = epoll_create(REACTOR_MAX_EVENTS);
+	if ( 0 > m_epfd )
+	{
+		throw new SocketException(Environment::LastErrorMessage());
+	}
+
+	if ( 0 != pipe(m_wakefds) )
+	{
+		::close(m_epfd);
+		throw new SocketException(Environment::LastErrorMessage());
+	}
+	fcntl(m_wakefds[0], F_SETFL, fcntl(m_wakefds[0], F_GETFL, 0) | O_NONBLOCK);
+	fcntl(m_wakefds[1], F_SETFL, fcntl(m_wakefds[1], F_GETFL, 0) | O_NONBLOCK);
+
+	struct epoll_event ev;
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN;
+	ev.data.u64 = 0;
+	if ( 0 != epoll_ctl(m_epfd, EPOLL_CTL_ADD, m_wakefds[0], &ev) )
+	{
+		::close(m_wakefds[0]);
+		::close(m_wakefds[1]);
+		::close(m_epfd);
+		throw new SocketException(Environment::LastErrorMessage());
+	}
+}
+
+ReactorPoller::~ReactorPoller()
+{
+	::close(m_wakefds[0]);
+	::close(m_wakefds[1]);
+	::close(m_epfd);
+}
+
+/* The event carries the fd and generation rather than the pointer, so an
+   event for a connection that was replaced after epoll_wait() returned is
+   found to be stale instead of touching a deleted connection.  Generation 0
+   is the wake pipe. */
+static inline uint64 _EventKey( ReactorConnection *conn )
+{
+	return ((uint64)conn->m_gen << 32) | (uint32)conn->m_fd;
+}
+
+bool ReactorPoller::Register( ReactorConnection *conn )
+{
+	struct epoll_event ev;
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+	ev.data.u64 = _EventKey(conn);
+	return 0 == epoll_ctl(m_epfd, EPOLL_CTL_ADD, conn->m_fd, &ev);
+}
+
+bool ReactorPoller::Rearm( ReactorConnection *conn )
+{
+	struct epoll_event ev;
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+	ev.data.u64 = _EventKey(conn);
+	return 0 == epoll_ctl(m_epfd, EPOLL_CTL_MOD, conn->m_fd, &ev);
+}
+
+void ReactorPoller::Unregister( ReactorConnection *conn )
+{
+	// Fails harmlessly if the listener already closed the socket.
+	epoll_ctl(m_epfd, EPOLL_CTL_DEL, conn->m_fd, NULL);
+}
+
+void ReactorPoller::Wake()
+{
+	byte b = 0;
+	// EAGAIN means a wakeup is already pending.
+	if ( 1 != ::write(m_wakefds[1], &b, 1) && EAGAIN != errno )
+	{
+		Log::SWriteError("ReactorPoller wake pipe write failed");
+	}
+}
+
+void ReactorPoller::Run()
+{
+	while ( m_reactor->m_running )
+	{
+		int count = epoll_wait( m_epfd, m_events, REACTOR_MAX_EVENTS, 10 * 1000 );
+		if ( count < 0 )
+		{
+			if ( EINTR == errno )
+			{
+				continue;
+			}
+			// Nothing above the thread would catch an exception.
+			Log::SWriteError("ReactorPoller epoll_wait failed, poller stopped: " + Environment::LastErrorMessage());
+			return;
+		}
+
+		m_reactor->m_connsMtx.Lock();
+
+		for ( int x = 0; x < count && m_reactor->m_running; x++ )
+		{
+			uint64 key = m_events[x].data.u64;
+			if ( 0 == key )
+			{
+				byte drain[64];
+				while ( 0 < ::read(m_wakefds[0], drain, sizeof(drain)) )
+				{
+				}
+				continue;
+			}
+
+			ReactorConnection *conn;
+			if ( ! m_reactor->m_conns.TryGet((int)(uint32)key, conn) || conn->m_gen != (uint32)(key >> 32) || conn->m_busy )
+			{
+				continue;
+			}
+
+			// EPOLLONESHOT disabled the socket, so the worker owns it until it re-arms.
+			conn->m_busy = true;
+			conn->m_events = m_events[x].events;
+			m_reactor->Schedule( conn );
+		}
+
+		m_reactor->m_connsMtx.Unlock();
+	}
+}
+
+#if defined(DEBUG) || defined(_DEBUG)
+void ReactorPoller::CheckMem() const
+{
+}
+
+void ReactorPoller::ValidateMem() const
+{
+}
+#endif
+
+ReactorWorker::ReactorWorker(ReactorSocketSet *reactor, int index)
+: m_reactor(reactor), m_index(index), m_buf(SOCKBUF_SIZE), m_queue(), m_queueMtx()
+{
+}
+
+ReactorWorker::~ReactorWorker()
+{
+}
+
+int ReactorWorker::QueueDepth()
+{
+	m_queueMtx.Lock();
+	int count = m_queue.Count();
+	m_queueMtx.Unlock();
+	return count;
+}
+
+void ReactorWorker::Run()
+{
+	while ( m_reactor->m_running )
+	{
+		m_reactor->m_workAvail.Lock();
+
+		ReactorConnection *conn = m_reactor->NextReady( m_index );
+		if ( NULL != conn )
+		{
+			m_reactor->Dispatch( conn, m_buf );
+		}
+	}
+}
+
+#if defined(DEBUG) || defined(_DEBUG)
+void ReactorWorker::CheckMem() const
+{
+	m_buf.CheckMem();
+	m_queue.CheckMem();
+}
+
+void ReactorWorker::ValidateMem() const
+{
+	m_buf.ValidateMem();
+	m_queue.ValidateMem();
+}
+#endif
+
+ReactorSocketSet::ReactorSocketSet( int pollerCount, int workerCount )
+: m_pollers(), m_workers(), m_conns(), m_connsMtx(), m_nextGen(0), m_workAvail(1), m_running(true), m_queued(0), m_dispatched(0), m_steals(0)
+{
+	if ( 1 > pollerCount || 1 > workerCount )
+	{
+		throw new InvalidArgumentException("ReactorSocketSet needs at least one poller and one worker");
+	}
+
+	for ( int x = 0; x < workerCount; x++ )
+	{
+		m_workers.Add( new ReactorWorker(this, x) );
+	}
+	for ( int x = 0; x < pollerCount; x++ )
+	{
+		m_pollers.Add( new ReactorPoller(this) );
+	}
+	for ( int x = 0; x < workerCount; x++ )
+	{
+		m_workers.ElementAt(x)->Start();
+	}
+	for ( int x = 0; x < pollerCount; x++ )
+	{
+		m_pollers.ElementAt(x)->Start();
+	}
+}
+
+ReactorSocketSet::~ReactorSocketSet()
+{
+	Close();
+
+	for ( int x = 0; x < m_pollers.Count(); x++ )
+	{
+		delete m_pollers.ElementAt(x);
+	}
+	for ( int x = 0; x < m_workers.Count(); x++ )
+	{
+		delete m_workers.ElementAt(x);
+	}
+}
+
+int ReactorSocketSet::SocketCount() const
+{
+	return m_conns.Count();
+}
+
+void ReactorSocketSet::AddSocket( IStreamReadListenerPtr listener, TcpSocketPtr sp )
+{
+	sp.ValidateMem();
+
+	int fd = sp->m_sock->GetFD();
+	ReactorConnection *stale = NULL;
+
+	m_connsMtx.Lock();
+
+	if ( 0 == ++m_nextGen )
+	{
+		m_nextGen = 1;
+	}
+	ReactorConnection *conn = new ReactorConnection(listener, sp, fd, fd % m_workers.Count(), m_nextGen);
+
+	if ( m_conns.TryGet(fd, stale) )
+	{
+		// The old socket was closed outside a callback and the kernel has
+		// handed its descriptor to this one, which also took it out of the
+		// epoll set.  If a worker has it, the worker sees the closed socket
+		// and cleans up; otherwise nothing else can reach it now.
+		m_conns.Remove( fd );
+		if ( stale->m_busy )
+		{
+			stale = NULL;
+		}
+	}
+
+	m_conns.Set( fd, conn );
+
+	// Registered under the lock, since a worker may remove conn as soon as it is armed.
+	if ( ! PollerFor(conn)->Register(conn) )
+	{
+		m_conns.Remove( fd );
+		m_connsMtx.Unlock();
+
+		if ( NULL != stale )
+		{
+			stale->m_listener->IStreamRead_OnClose();
+			stale->m_sp->Close();
+			delete stale;
+		}
+
+		String msg(Environment::LastErrorMessage());
+		listener->IStreamRead_OnError( msg );
+		listener->IStreamRead_OnClose();
+		sp->Close();
+		delete conn;
+		return;
+	}
+
+	m_connsMtx.Unlock();
+
+	if ( NULL != stale )
+	{
+		stale->m_listener->IStreamRead_OnClose();
+		stale->m_sp->Close();
+		delete stale;
+	}
+}
+
+void ReactorSocketSet::Schedule( ReactorConnection *conn )
+{
+	ReactorWorker *worker = m_workers.ElementAt(conn->m_home);
+
+	worker->m_queueMtx.Lock();
+	worker->m_queue.Add( conn );
+	worker->m_queueMtx.Unlock();
+
+	m_queued++;
+	m_workAvail.Unlock();
+}
+
+ReactorConnection *ReactorSocketSet::NextReady( int worker )
+{
+	ReactorConnection *conn = NULL;
+	ReactorWorker *w = m_workers.ElementAt(worker);
+
+	w->m_queueMtx.Lock();
+	if ( w->m_queue.Count() > 0 )
+	{
+		conn = w->m_queue.Tail();
+		w->m_queue.RemoveTail();
+	}
+	w->m_queueMtx.Unlock();
+
+	for ( int x = 1; NULL == conn && x < m_workers.Count(); x++ )
+	{
+		ReactorWorker *victim = m_workers.ElementAt((worker + x) % m_workers.Count());
+
+		victim->m_queueMtx.Lock();
+		if ( victim->m_queue.Count() > 0 )
+		{
+			conn = victim->m_queue.Pop();
+			m_steals++;
+		}
+		victim->m_queueMtx.Unlock();
+	}
+
+	if ( NULL != conn )
+	{
+		m_queued--;
+		m_dispatched++;
+	}
+	return conn;
+}
+
+void ReactorSocketSet::Dispatch( ReactorConnection *conn, Array<byte>& buf )
+{
+	ASSERT_MEM( conn, sizeof(ReactorConnection) );
+	conn->ValidateMem();
+
+	try
+	{
+		if ( 0 != (conn->m_events & EPOLLERR) )
+		{
+			conn->m_listener->IStreamRead_OnError( "Socket exception set" );
+			conn->m_listener->IStreamRead_OnClose();
+			RemoveConnection( conn );
+			return;
+		}
+
+		if ( conn->m_sp->IsClosed() )
+		{
+			conn->m_listener->IStreamRead_OnClose();
+			RemoveConnection( conn );
+			return;
+		}
+
+		// Readable with nothing to read means the peer closed.
+		int bytes = conn->m_sp->GetBytesAvail();
+		if ( 0 == bytes )
+		{
+			conn->m_listener->IStreamRead_OnClose();
+			RemoveConnection( conn );
+			return;
+		}
+
+		while ( bytes > 0 && m_running )
+		{
+			bytes = conn->m_sp->GetStream()->Read(buf, 0, SOCKBUF_SIZE);
+			if ( 0 > bytes )
+			{
+				// socket closed
+				conn->m_listener->IStreamRead_OnClose();
+				RemoveConnection( conn );
+				return;
+			}
+			ASSERT(conn->m_listener.IsNotNull());
+			conn->m_listener->IStreamRead_OnRead( buf, bytes );
+
+			bytes = (conn->m_sp->IsClosed()) ? -1 : conn->m_sp->GetBytesAvail();
+		}
+
+		if ( conn->m_sp->IsClosed() )
+		{
+			// The listener closed the socket in IStreamRead_OnRead.
+			RemoveConnection( conn );
+			return;
+		}
+
+		if ( ! RearmConnection(conn) )
+		{
+			conn->m_listener->IStreamRead_OnClose();
+			RemoveConnection( conn );
+		}
+	}
+	catch ( SocketException *se )
+	{
+		conn->m_listener->IStreamRead_OnError( se->Message() );
+		conn->m_listener->IStreamRead_OnClose();
+		RemoveConnection( conn );
+		delete se;
+	}
+	catch ( Exception *ex )
+	{
+		Log::SWrite(ex);
+		conn->m_listener->IStreamRead_OnError( ex->Message() );
+		conn->m_listener->IStreamRead_OnClose();
+		RemoveConnection( conn );
+		delete ex;
+	}
+}
+
+bool ReactorSocketSet::RearmConnection( ReactorConnection *conn )
+{
+	m_connsMtx.Lock();
+
+	bool ok = IsCurrent( conn );
+	if ( ok && m_running )
+	{
+		ok = PollerFor(conn)->Rearm(conn);
+		if ( ok )
+		{
+			conn->m_busy = false;
+		}
+		else
+		{
+			Log::SWriteError("ReactorSocketSet re-arm failed: " + Environment::LastErrorMessage());
+		}
+	}
+	// When shutting down, a current conn is left for CloseAll.
+
+	m_connsMtx.Unlock();
+	return ok;
+}
+
+void ReactorSocketSet::RemoveConnection( ReactorConnection *conn )
+{
+	m_connsMtx.Lock();
+	// If the listener closed the socket, the descriptor may already belong to a new connection.
+	if ( IsCurrent(conn) )
+	{
+		PollerFor(conn)->Unregister( conn );
+		m_conns.Remove( conn->m_fd );
+	}
+	m_connsMtx.Unlock();
+
+	conn->m_sp->Close();
+	delete conn;
+}
+
+void ReactorSocketSet::CloseAll()
+{
+	// Only called once the threads are stopped.  Queued connections are
+	// still in m_conns, except ones replaced by a new socket on their fd.
+	m_connsMtx.Lock();
+	for ( int x = 0; x < m_workers.Count(); x++ )
+	{
+		List<ReactorConnection *>& queue = m_workers.ElementAt(x)->m_queue;
+		while ( queue.Count() > 0 )
+		{
+			ReactorConnection *conn = queue.Pop();
+			if ( ! IsCurrent(conn) )
+			{
+				conn->m_sp->Close();
+				delete conn;
+			}
+		}
+	}
+	m_queued = 0;
+
+	Hashtable<int, ReactorConnection *>::Iterator iter = m_conns.Begin();
+	while ( iter.Next() )
+	{
+		ReactorConnection *conn = iter.Current();
+		ASSERT_MEM( conn, sizeof(ReactorConnection) );
+		PollerFor(conn)->Unregister( conn );
+		conn->m_sp->Close();
+		delete conn;
+	}
+	m_conns.Clear();
+	m_connsMtx.Unlock();
+}
+
+void ReactorSocketSet::Close()
+{
+	if ( ! m_running )
+	{
+		return;
+	}
+	m_running = false;
+
+	for ( int x = 0; x < m_pollers.Count(); x++ )
+	{
+		m_pollers.ElementAt(x)->Wake();
+	}
+	for ( int x = 0; x < m_workers.Count(); x++ )
+	{
+		m_workAvail.Unlock();
+	}
+	for ( int x = 0; x < m_pollers.Count(); x++ )
+	{
+		_JoinThread( m_pollers.ElementAt(x) );
+	}
+	for ( int x = 0; x < m_workers.Count(); x++ )
+	{
+		_JoinThread( m_workers.ElementAt(x) );
+	}
+
+	CloseAll();
+}
+
+void ReactorSocketSet::CloseAndDelete()
+{
+	Close();
+}
+
+void ReactorSocketSet::Broadcast( const Array<byte>& buf, const int len )
+{
+	m_connsMtx.Lock();
+	Hashtable<int, ReactorConnection *>::Iterator iter = m_conns.Begin();
+	while ( iter.Next() )
+	{
+		ReactorConnection *conn = iter.Current();
+		if ( NULL != conn )
+		{
+			conn->m_sp->GetStream()->Write( buf, 0, len );
+		}
+	}
+	m_connsMtx.Unlock();
+}
+
+void ReactorSocketSet::Join(int timeoutms)
+{
+	for ( int x = 0; x < m_pollers.Count(); x++ )
+	{
+		m_pollers.ElementAt(x)->Join(timeoutms);
+	}
+	for ( int x = 0; x < m_workers.Count(); x++ )
+	{
+		m_workers.ElementAt(x)->Join(timeoutms);
+	}
+}
+
+void ReactorSocketSet::Join()
+{
+	for ( int x = 0; x < m_pollers.Count(); x++ )
+	{
+		m_pollers.ElementAt(x)->Join();
+	}
+	for ( int x = 0; x < m_workers.Count(); x++ )
+	{
+		m_workers.ElementAt(x)->Join();
+	}
+}
+
+#if defined(DEBUG) || defined(_DEBUG)
+void ReactorSocketSet::CheckMem() const
+{
+	m_pollers.CheckMem();
+	m_workers.CheckMem();
+	m_conns.CheckMem();
+}
+
+void ReactorSocketSet::ValidateMem() const
+{
+	m_pollers.ValidateMem();
+	m_workers.ValidateMem();
+	m_conns.ValidateMem();
+}
+#endif
+
+#endif
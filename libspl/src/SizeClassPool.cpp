@@ -0,0 +1,491 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <spl/Exception.h>
+#include <spl/collection/SizeClassPool.h>
+#include <spl/threading/Mutex.h>
+
+#ifdef _WINDOWS
+#include <spl/cleanwindows.h>
+#endif
+
+using namespace spl;
+
+static const uint32 SCP_MAJIC = 0x5C9A110C;
+
+/// The usable bytes in a block of each class.
+static const int _blockSizes[SIZECLASSPOOL_CLASSES] =
+{
+	16, 32, 48, 64, 80, 96, 112, 128, 192, 256, 320, 384, 512, 640, 768, 1024
+};
+
+/// Classes for sizes over 128, indexed by (size - 1) / 64.
+static const int _largeClasses[16] =
+{
+	0, 0, 8, 9, 10, 11, 12, 12, 13, 13, 14, 14, 15, 15, 15, 15
+};
+
+/// In front of every block.  Keeps blocks 8 byte aligned.
+typedef struct _SizeClassHeader
+{
+	uint32 cls;			//!< SIZECLASSPOOL_CLASSES for blocks from malloc.
+	uint32 check;
+} _SizeClassHeader;
+
+typedef struct _SizeClassList
+{
+	void *head;			//!< Blocks are linked through their first word.
+	int count;
+} _SizeClassList;
+
+namespace spl
+{
+	struct _SizeClassCache
+	{
+		_SizeClassList lists[SIZECLASSPOOL_CLASSES];
+		_SizeClassCache *next;
+		_SizeClassCache *prev;
+		_SizeClassCentral *central;
+	};
+
+	struct _SizeClassCentral
+	{
+		Mutex lock;			//!< Guards everything below.
+		_SizeClassList lists[SIZECLASSPOOL_CLASSES];
+		void *spans;		//!< Linked through their first word.
+		int64 spanBytes;
+		_SizeClassCache *caches;
+		uint64 serial;		//!< Never reused, unlike the address of a deleted pool.
+#ifdef _WINDOWS
+		DWORD tls;
+#else
+		pthread_key_t tls;
+#endif
+	};
+}
+
+SizeClassPool *SizeClassPool::m_default = NULL;
+
+static volatile int64 _lastSerial = 0;
+
+// The cache of the pool the thread used last, to skip the key look up.
+// initial-exec keeps the access to one instruction in a shared library, like
+// glibc's own malloc does.
+#if defined(_MSC_VER)
+#define SCP_THREAD_LOCAL __declspec(thread)
+#elif defined(__GNUC__)
+#define SCP_THREAD_LOCAL __thread __attribute__((tls_model("initial-exec")))
+#endif
+
+#ifdef SCP_THREAD_LOCAL
+typedef struct _SizeClassLast
+{
+	uint64 serial;
+	_SizeClassCache *cache;
+} _SizeClassLast;
+
+static SCP_THREAD_LOCAL _SizeClassLast _lastCache = { 0, NULL };
+#endif
+
+static inline int _ClassOf(int size)
+{
+	if (size <= 128)
+	{
+		return size <= 16 ? 0 : ((size + 15) >> 4) - 1;
+	}
+	return _largeClasses[(size - 1) >> 6];
+}
+
+static inline void *_Next(void *block)
+{
+	return *(void **)block;
+}
+
+static inline void _SetNext(void *block, void *next)
+{
+	*(void **)block = next;
+}
+
+static inline void _Unlink(_SizeClassCentral *central, _SizeClassCache *cache)
+{
+	if (NULL == cache->prev)
+	{
+		central->caches = cache->next;
+	}
+	else
+	{
+		cache->prev->next = cache->next;
+	}
+	if (NULL != cache->next)
+	{
+		cache->next->prev = cache->prev;
+	}
+}
+
+static void _Refill(_SizeClassCentral *central, _SizeClassCache *cache, int cls)
+{
+	ASSERT(0 == cache->lists[cls].count);
+
+	central->lock.Lock();
+	_SizeClassList& shared = central->lists[cls];
+
+	if (0 == shared.count)
+	{
+		byte *span = (byte *)malloc(SIZECLASSPOOL_SPAN_SIZE);
+		if (NULL == span)
+		{
+			central->lock.Unlock();
+			throw new OutOfMemoryException();
+		}
+		_SetNext(span, central->spans);
+		central->spans = span;
+		central->spanBytes += SIZECLASSPOOL_SPAN_SIZE;
+
+		// The span's link word takes the first 8 bytes.
+		const int stride = _blockSizes[cls] + (int)sizeof(_SizeClassHeader);
+		for (int pos = 8; pos + stride <= SIZECLASSPOOL_SPAN_SIZE; pos += stride)
+		{
+			_SizeClassHeader *hdr = (_SizeClassHeader *)&span[pos];
+			hdr->cls = (uint32)cls;
+			hdr->check = SCP_MAJIC;
+			_SetNext(hdr + 1, shared.head);
+			shared.head = hdr + 1;
+			shared.count++;
+		}
+	}
+
+	_SizeClassList& local = cache->lists[cls];
+	while (local.count < SIZECLASSPOOL_BATCH && 0 != shared.count)
+	{
+		void *block = shared.head;
+		shared.head = _Next(block);
+		shared.count--;
+		_SetNext(block, local.head);
+		local.head = block;
+		local.count++;
+	}
+	central->lock.Unlock();
+}
+
+static void _Drain(_SizeClassCentral *central, _SizeClassCache *cache, int cls, int count)
+{
+	_SizeClassList& local = cache->lists[cls];
+	ASSERT(count > 0 && count <= local.count);
+
+	// Unlink the chain before taking the lock.
+	void *first = local.head;
+	void *last = first;
+	for (int x = 1; x < count; x++)
+	{
+		last = _Next(last);
+	}
+	local.head = _Next(last);
+	local.count -= count;
+
+	central->lock.Lock();
+	_SizeClassList& shared = central->lists[cls];
+	_SetNext(last, shared.head);
+	shared.head = first;
+	shared.count += count;
+	central->lock.Unlock();
+}
+
+/// Gives all of cache's blocks back and frees it.
+static void _ReleaseCache(_SizeClassCentral *central, _SizeClassCache *cache)
+{
+	for (int cls = 0; cls < SIZECLASSPOOL_CLASSES; cls++)
+	{
+		if (0 != cache->lists[cls].count)
+		{
+			_Drain(central, cache, cls, cache->lists[cls].count);
+		}
+	}
+
+	central->lock.Lock();
+	_Unlink(central, cache);
+	central->lock.Unlock();
+
+#ifdef SCP_THREAD_LOCAL
+	if (_lastCache.cache == cache)
+	{
+		_lastCache.serial = 0;
+		_lastCache.cache = NULL;
+	}
+#endif
+	free(cache);
+}
+
+#ifndef _WINDOWS
+static void _ThreadCacheExit(void *vp)
+{
+	_SizeClassCache *cache = (_SizeClassCache *)vp;
+	_ReleaseCache(cache->central, cache);
+}
+#endif
+
+SizeClassPool::SizeClassPool()
+: m_central(NULL)
+{
+	m_central = new _SizeClassCentral();
+	memset(m_central->lists, 0, sizeof(m_central->lists));
+	m_central->spans = NULL;
+	m_central->spanBytes = 0;
+	m_central->caches = NULL;
+#if defined(_WINDOWS)
+	m_central->serial = (uint64)InterlockedIncrement64((volatile LONGLONG *)&_lastSerial);
+#elif defined(HAVE_ATOMIC_BUILTINS)
+	m_central->serial = (uint64)__sync_add_and_fetch(&_lastSerial, 1);
+#else
+	m_central->serial = (uint64)++_lastSerial;
+#endif
+
+#ifdef _WINDOWS
+	if (TLS_OUT_OF_INDEXES == (m_central->tls = TlsAlloc()))
+#else
+	if (0 != pthread_key_create(&m_central->tls, _ThreadCacheExit))
+#endif
+	{
+		delete m_central;
+		throw new Exception("SizeClassPool: out of thread local storage keys");
+	}
+}
+
+SizeClassPool::~SizeClassPool()
+{
+#ifdef _WINDOWS
+	TlsFree(m_central->tls);
+#else
+	pthread_key_delete(m_central->tls);
+#endif
+
+	while (NULL != m_central->caches)
+	{
+		_SizeClassCache *cache = m_central->caches;
+		m_central->caches = cache->next;
+		free(cache);
+	}
+	while (NULL != m_central->spans)
+	{
+		void *span = m_central->spans;
+		m_central->spans = _Next(span);
+		free(span);
+	}
+	delete m_central;
+}
+
+SizeClassPool& SizeClassPool::CreateDefault()
+{
+	SizeClassPool *pool = new SizeClassPool();
+
+	// Two threads may get here at once; the loser deletes its pool.
+#if defined(_WINDOWS)
+	if (NULL != InterlockedCompareExchangePointer((PVOID *)&m_default, pool, NULL))
+#elif defined(HAVE_ATOMIC_BUILTINS)
+	if (NULL != __sync_val_compare_and_swap(&m_default, (SizeClassPool *)NULL, pool))
+#else
+	if (NULL != m_default || NULL == (m_default = pool))
+#endif
+	{
+		delete pool;
+	}
+	return *m_default;
+}
+
+inline _SizeClassCache *SizeClassPool::ThreadCache()
+{
+#ifdef SCP_THREAD_LOCAL
+	_SizeClassLast *last = &_lastCache;
+	if (last->serial == m_central->serial)
+	{
+		return last->cache;
+	}
+#endif
+	return FindThreadCache();
+}
+
+_SizeClassCache *SizeClassPool::FindThreadCache()
+{
+#ifdef _WINDOWS
+	_SizeClassCache *cache = (_SizeClassCache *)TlsGetValue(m_central->tls);
+#else
+	_SizeClassCache *cache = (_SizeClassCache *)pthread_getspecific(m_central->tls);
+#endif
+	if (NULL != cache)
+	{
+#ifdef SCP_THREAD_LOCAL
+		_lastCache.serial = m_central->serial;
+		_lastCache.cache = cache;
+#endif
+		return cache;
+	}
+
+	if (NULL == (cache = (_SizeClassCache *)malloc(sizeof(_SizeClassCache))))
+	{
+		throw new OutOfMemoryException();
+	}
+	memset(cache, 0, sizeof(_SizeClassCache));
+	cache->central = m_central;
+
+	m_central->lock.Lock();
+	cache->next = m_central->caches;
+	if (NULL != cache->next)
+	{
+		cache->next->prev = cache;
+	}
+	m_central->caches = cache;
+	m_central->lock.Unlock();
+
+#ifdef _WINDOWS
+	TlsSetValue(m_central->tls, cache);
+#else
+	pthread_setspecific(m_central->tls, cache);
+#endif
+#ifdef SCP_THREAD_LOCAL
+	_lastCache.serial = m_central->serial;
+	_lastCache.cache = cache;
+#endif
+	return cache;
+}
+
+void *SizeClassPool::Malloc(int size)
+{
+	ASSERT(size >= 0);
+
+	if (size > SIZECLASSPOOL_MAX_SIZE)
+	{
+		_SizeClassHeader *hdr = (_SizeClassHeader *)malloc(size + sizeof(_SizeClassHeader));
+		if (NULL == hdr)
+		{
+			throw new OutOfMemoryException();
+		}
+		hdr->cls = SIZECLASSPOOL_CLASSES;
+		hdr->check = SCP_MAJIC;
+		return hdr + 1;
+	}
+
+	const int cls = _ClassOf(size);
+	_SizeClassCache *cache = ThreadCache();
+	_SizeClassList& list = cache->lists[cls];
+	if (0 == list.count)
+	{
+		_Refill(m_central, cache, cls);
+	}
+
+	void *block = list.head;
+	list.head = _Next(block);
+	list.count--;
+	return block;
+}
+
+void SizeClassPool::Free(void *ptr)
+{
+	if (NULL == ptr)
+	{
+		return;
+	}
+
+	_SizeClassHeader *hdr = ((_SizeClassHeader *)ptr) - 1;
+	ASSERT(SCP_MAJIC == hdr->check);
+
+	if (SIZECLASSPOOL_CLASSES == hdr->cls)
+	{
+		free(hdr);
+		return;
+	}
+
+	_SizeClassCache *cache = ThreadCache();
+	_SizeClassList& list = cache->lists[hdr->cls];
+	_SetNext(ptr, list.head);
+	list.head = ptr;
+	if (++list.count > 2 * SIZECLASSPOOL_BATCH)
+	{
+		_Drain(m_central, cache, hdr->cls, SIZECLASSPOOL_BATCH);
+	}
+}
+
+void SizeClassPool::FlushThreadCache()
+{
+#ifdef _WINDOWS
+	_SizeClassCache *cache = (_SizeClassCache *)TlsGetValue(m_central->tls);
+#else
+	_SizeClassCache *cache = (_SizeClassCache *)pthread_getspecific(m_central->tls);
+#endif
+	if (NULL == cache)
+	{
+		return;
+	}
+
+#ifdef _WINDOWS
+	TlsSetValue(m_central->tls, NULL);
+#else
+	pthread_setspecific(m_central->tls, NULL);
+#endif
+	_ReleaseCache(m_central, cache);
+}
+
+int SizeClassPool::BlockSize(const void *ptr)
+{
+	const _SizeClassHeader *hdr = ((const _SizeClassHeader *)ptr) - 1;
+	ASSERT(SCP_MAJIC == hdr->check);
+	ASSERT(hdr->cls < SIZECLASSPOOL_CLASSES);
+	return _blockSizes[hdr->cls];
+}
+
+int64 SizeClassPool::SpanBytes() const
+{
+	return m_central->spanBytes;
+}
+
+#ifdef DEBUG
+void SizeClassPool::ValidateMem () const
+{
+	ASSERT_MEM(m_central, sizeof(_SizeClassCentral));
+
+	for (_SizeClassCache *cache = m_central->caches; NULL != cache; cache = cache->next)
+	{
+		ASSERT_MEM(cache, sizeof(_SizeClassCache));
+		ASSERT(cache->central == m_central);
+	}
+	for (void *span = m_central->spans; NULL != span; span = _Next(span))
+	{
+		ASSERT_MEM(span, SIZECLASSPOOL_SPAN_SIZE);
+	}
+}
+
+void SizeClassPool::CheckMem () const
+{
+	DEBUG_NOTE_MEM(m_central);
+
+	for (_SizeClassCache *cache = m_central->caches; NULL != cache; cache = cache->next)
+	{
+		DEBUG_NOTE_MEM(cache);
+	}
+	for (void *span = m_central->spans; NULL != span; span = _Next(span))
+	{
+		DEBUG_NOTE_MEM(span);
+	}
+}
+#endif
+
+void *operator new (size_t size, SizeClassPool& pool)
+{
+	return pool.Malloc((int)size);
+}
+
+void operator delete (void *ptr, SizeClassPool& pool)
+{
+	pool.Free(ptr);
+}
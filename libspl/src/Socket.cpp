@@ -27,11 +27,18 @@
 #ifdef HAVE_SYS_IOCTL_H
 #include <sys/ioctl.h>
 #endif
+#ifdef HAVE_SYS_SENDFILE_H
+#include <sys/sendfile.h>
+#endif
+#ifdef HAVE_SYS_UIO_H
+#include <sys/uio.h>
+#endif
 
 #include <spl/Environment.h>
 #include <ctype.h>
 #include <spl/Debug.h>
 #include <spl/Exception.h>
+#include <spl/io/File.h>
 #include <spl/io/log/Log.h>
 #include <spl/net/ServerSocket.h>
 #include <spl/net/Socket.h>
@@ -374,6 +381,140 @@ void Socket::Send (const Array<byte>& data, const int offset, const int len)
 	}
 }
 
+void Socket::SendGather (const StreamSegment *segments, const int segmentCount)
+{
+#ifdef HAVE_SYS_UIO_H
+	// writev is limited to IOV_MAX buffers, so long lists are sent a window at a time.
+	struct iovec iov[64];
+	int seg = 0;
+	int segoff = 0;
+
+	while ( seg < segmentCount )
+	{
+		int iovcnt = 0;
+		for ( int x = seg; x < segmentCount && iovcnt < 64; x++ )
+		{
+			int off = x == seg ? segoff : 0;
+			if ( segments[x].count > off )
+			{
+				iov[iovcnt].iov_base = (void *)&segments[x].data[off];
+				iov[iovcnt].iov_len = segments[x].count - off;
+				iovcnt++;
+			}
+		}
+		if ( 0 == iovcnt )
+		{
+			break;
+		}
+
+		ssize_t sent = ::writev(m_fd, iov, iovcnt);
+		if ( 0 > sent )
+		{
+			if ( EINTR == errno )
+			{
+				continue;
+			}
+			if ( EAGAIN == errno || EWOULDBLOCK == errno )
+			{
+				Thread::YYield();
+				continue;
+			}
+			m_errorStatus = errno;
+			throw new SocketException(Environment::LastErrorMessage());
+		}
+
+		// Step past what was sent; a short write resumes mid segment.
+		while ( seg < segmentCount && (sent > 0 || segments[seg].count == segoff) )
+		{
+			int left = segments[seg].count - segoff;
+			if ( sent >= left )
+			{
+				sent -= left;
+				seg++;
+				segoff = 0;
+			}
+			else
+			{
+				segoff += (int)sent;
+				sent = 0;
+			}
+		}
+	}
+#else
+	for ( int x = 0; x < segmentCount; x++ )
+	{
+		if (::send (m_fd, (const char *)segments[x].data, segments[x].count, 0) < 0)
+		{
+#ifdef _WIN32
+			m_errorStatus = WSAGetLastError();
+#else
+			m_errorStatus = errno;
+#endif
+			throw new SocketException(Environment::LastErrorMessage());
+		}
+	}
+#endif
+}
+
+void Socket::SendFile (const String& filename, const long offset, const long count)
+{
+#ifdef HAVE_SYS_SENDFILE_H
+	int fd = ::open(filename.GetChars(), O_RDONLY);
+	if ( 0 > fd )
+	{
+		throw new IOException(Environment::LastErrorMessage());
+	}
+
+	off_t pos = (off_t)offset;
+	long remaining = count;
+	while ( remaining > 0 )
+	{
+		ssize_t sent = ::sendfile(m_fd, fd, &pos, (size_t)remaining);
+		if ( 0 > sent )
+		{
+			if ( EINTR == errno )
+			{
+				continue;
+			}
+			if ( EAGAIN == errno || EWOULDBLOCK == errno )
+			{
+				// Non-blocking socket with a full send buffer.
+				Thread::YYield();
+				continue;
+			}
+			m_errorStatus = errno;
+			::close(fd);
+			throw new SocketException(Environment::LastErrorMessage());
+		}
+		if ( 0 == sent )
+		{
+			::close(fd);
+			throw new IOException("File truncated while sending");
+		}
+		remaining -= (long)sent;
+	}
+	::close(fd);
+#else
+	IStreamPtr strm = File::OpenRead(filename);
+	strm->Seek(offset, IStream::SEEK_Begin);
+
+	Array<byte> buf(SOCKBUF_SIZE * 8);
+	long remaining = count;
+	while ( remaining > 0 )
+	{
+		int len = strm->Read(buf, 0, remaining < buf.Length() ? (int)remaining : buf.Length());
+		if ( 0 >= len )
+		{
+			strm->Close();
+			throw new IOException("File truncated while sending");
+		}
+		Send(buf, 0, len);
+		remaining -= len;
+	}
+	strm->Close();
+#endif
+}
+
 int Socket::Recv (Array<byte>& buf, const int offset, const int blen)
 {
 	ASSERT(offset + blen <= buf.Length());
@@ -480,9 +621,20 @@ bool Socket::IsClosed()
 		return true;
 	}
 	char buf;
+#ifdef MSG_DONTWAIT
+	// Don't block the socket set threads when no data is pending.
+	int count = recv(m_fd, &buf, 1, MSG_PEEK | MSG_DONTWAIT);
+#else
 	int count = recv(m_fd, &buf, 1, MSG_PEEK);
+#endif
 	if ( 0 > count )
 	{
+#if !defined(_WINDOWS)
+		if ( EAGAIN == errno || EWOULDBLOCK == errno )
+		{
+			return false;
+		}
+#endif
 		m_closed = true;
 		return true;
 	}
@@ -574,6 +726,11 @@ void SocketStream::Write(const Array<byte>& buffer, const int offset, const int
 	m_sock->Send(buffer, offset, count);
 }
 
+void SocketStream::WriteGather(const StreamSegment *segments, const int segmentCount)
+{
+	m_sock->SendGather(segments, segmentCount);
+}
+
 void SocketStream::WriteByte(byte value)
 {
 	Array<byte> buf(1);
@@ -17,6 +17,8 @@
 /* on some platforms, threads overrides IO routines */
 #include <spl/threading/Thread.h>
 #include <spl/net/SocketSet.h>
+#include <spl/net/EpollSocketSet.h>
+#include <spl/net/ReactorSocketSet.h>
 #include <spl/io/log/Log.h>
 
 using namespace spl;
@@ -25,13 +27,28 @@ ISocketService::~ISocketService()
 {
 }
 
+ISocketServicePtr ISocketService::Create( enum ServiceType type )
+{
+#ifdef HAVE_SYS_EPOLL_H
+	if ( SERVICE_EPOLL == type )
+	{
+		return ISocketServicePtr(new EpollSocketSet());
+	}
+	if ( SERVICE_REACTOR == type )
+	{
+		return ISocketServicePtr(new ReactorSocketSet());
+	}
+#endif
+	return ISocketServicePtr(new SocketSet());
+}
+
 SocketListenerPair::SocketListenerPair(IStreamReadListenerPtr listener, TcpSocketPtr sp)
 : m_listener(listener), m_sp(sp)
 {
 }
 
 SocketSet::SocketSet(  )
-: m_vread(), m_svreadMutex(), m_buf(SOCKBUF_SIZE)
+: m_vread(), m_svreadMutex(), m_buf(SOCKBUF_SIZE), m_running(true)
 {
 	m_to = new struct timeval;
 	m_to->tv_sec = 5;
@@ -50,6 +67,8 @@ SocketSet::SocketSet(  )
 SocketSet::~SocketSet()
 {
 	Close();
+	// Run() may be blocked on m_sockAddedEvent, wait for it to exit before deleting it.
+	Thread::Join(10 * 1000);
 	if ( NULL != m_to )
 	{
 		delete m_to;
@@ -355,8 +374,6 @@ void SocketSet::CloseAndDelete()
 
 void SocketSet::Run()
 {
-	m_running = true;
-
 	while ( m_running )
 	{
 		try
@@ -484,9 +501,10 @@ IServerConnectionFactory::~IServerConnectionFactory()
 SocketSetServer::SocketSetServer
 (
 	IServerConnectionFactory *conFactory, 
-	int serverPort
+	int serverPort,
+	enum ServiceType type
 )
-: m_ss(), m_listener(serverPort), m_conFactory(conFactory)
+: m_ss(ISocketService::Create(type)), m_listener(serverPort), m_conFactory(conFactory)
 {
 	m_listener.Delegates().Add(this);
 }
@@ -498,48 +516,48 @@ SocketSetServer::~SocketSetServer()
 
 void SocketSetServer::AddSocket( IStreamReadListenerPtr listener, TcpSocketPtr sp ) 
 { 
-	m_ss.AddSocket(listener, sp); 
+	m_ss->AddSocket(listener, sp); 
 }
 
 void SocketSetServer::Close() 
 { 
-	m_listener.Stop(); m_ss.Close(); 
+	m_listener.Stop(); m_ss->Close(); 
 }
 
 void SocketSetServer::CloseAndDelete() 
 { 
 	m_listener.Stop(); 
-	m_ss.CloseAndDelete(); 
+	m_ss->CloseAndDelete(); 
 }
 
 int SocketSetServer::SocketCount() const
 { 
-	return m_ss.SocketCount(); 
+	return m_ss->SocketCount(); 
 }
 
 void SocketSetServer::Broadcast( const Array<byte>& buf, const int len ) 
 { 
-	m_ss.Broadcast(buf, len); 
+	m_ss->Broadcast(buf, len); 
 }
 
 void SocketSetServer::Join(int timeoutms) 
 { 
-	m_ss.Join(timeoutms); 
+	m_ss->Join(timeoutms); 
 }
 
 void SocketSetServer::Join()
 {
-	m_ss.Join();
+	m_ss->Join();
 }
 
 void SocketSetServer::IPortListener_OnConnect( TcpSocketPtr sock )
 {
-	m_ss.AddSocket(m_conFactory->Create(sock), sock);
+	m_ss->AddSocket(m_conFactory->Create(sock), sock);
 }
 
 void SocketSetServer::IPortListener_OnStop()
 {
-	m_ss.CloseAndDelete();
+	m_ss->CloseAndDelete();
 }
 
 #if defined(DEBUG) || defined(_DEBUG)
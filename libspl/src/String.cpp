@@ -136,19 +136,40 @@ String::String()
 {
 }
 
-void String::InitWith( const char *str, const int offset, const int len )
+char *String::Alloc( const int len )
 {
-	m_len = len;
+	if ( len < STRING_SSO_SIZE )
+	{
+		return m_sso;
+	}
 	char *cp;
-	if ( NULL == (cp = (char *)malloc(m_len+1)) )
+	if ( NULL == (cp = (char *)malloc(len+1)) )
 	{
 		throw OutOfMemoryException();
 	}
+	return cp;
+}
+
+void String::InitWith( const char *str, const int offset, const int len )
+{
+	m_len = len;
 	m_isintern = false;
+	char *cp = Alloc(len);
 	StrCpyLen(cp, &str[offset], len);
 	m_cstr = cp;
 }
 
+void String::InitWith( const char *cp, const int len, const char *cp2, const int len2 )
+{
+	m_len = len + len2;
+	m_isintern = false;
+	char *buf = Alloc(m_len);
+	memcpy(buf, cp, len);
+	memcpy(&buf[len], cp2, len2);
+	buf[m_len] = eos;
+	m_cstr = buf;
+}
+
 String::String( const String& str )
 {
 	m_len = str.Length();
@@ -158,11 +179,7 @@ String::String( const String& str )
 	}
 	else
 	{
-		char *cp;
-		if ( NULL == (cp = (char *)malloc(m_len+1)) )
-		{
-			throw OutOfMemoryException();
-		}
+		char *cp = Alloc(m_len);
 		StrCpyLen(cp, str.m_cstr, m_len);
 		m_cstr = cp;
 	}
@@ -171,31 +188,17 @@ String::String( const String& str )
 
 String::~String()
 {
-	if ( !m_isintern )
-	{
-		free((char *)m_cstr);
-	}
+	Release();
 }
 
 void String::Set( const String &str )
 {
 	ValidateMem();
-	if ( m_isintern )
-	{
-		m_isintern = false;
-	}
-	else
-	{
-		free( (char *)m_cstr );
-	}
+	Release();
+	m_isintern = false;
 	
 	m_len = str.Length();
-	char *cp;
-	cp = (char *)malloc( m_len + 1 );
-	if ( NULL == cp )
-	{
-		throw OutOfMemoryException();
-	}
+	char *cp = Alloc(m_len);
 	StrCpyLen(cp, str.m_cstr, m_len);
 	m_cstr = cp;
 }
@@ -244,7 +247,6 @@ char String::operator[] (const int idx) const
 
 StringPtr String::Substring( int start, int len ) const
 {
-	char *ret;
 	const char *cpstart;
 
 	if ( len == 0 )
@@ -267,19 +269,8 @@ StringPtr String::Substring( int start, int len ) const
 		len = 0;
 	}
 	cpstart = &m_cstr[start];
-	ASSERT_PTR( cpstart );
-
-	if ( NULL == (ret = (char *)malloc( len+1 )) )
-	{
-		throw OutOfMemoryException();
-	}
-	StrCpyLen( ret, cpstart, len );
-	ret[len] = eos;
-	ASSERT_MEM( ret, len+1 );
 
-	StringPtr strret = StringPtr(new String(ret));
-	free(ret);
-	return strret;
+	return StringPtr(new String(cpstart, len));
 }
 
 RefCountPtr<Vector<RefCountPtr<String> > > String::Split( const String& cp ) const
@@ -376,10 +367,9 @@ StringPtr String::Replace(const String& from, const String& to) const
 
 StringPtr String::Cat( const String& cp, const int len ) const
 {
-	char *buf = StrCat(m_cstr, m_len, cp.m_cstr, len);
-	StringPtr ret = StringPtr(new String(buf));
-	free(buf);
-	return ret;
+	String *ret = new String();
+	ret->InitWith(m_cstr, m_len, cp.m_cstr, len < cp.m_len ? len : cp.m_len);
+	return StringPtr(ret);
 }
 
 StringPtr String::Right( int len ) const
@@ -407,18 +397,11 @@ StringPtr String::Mid( int start, int stop ) const
 
 StringPtr String::RTrim(char ch) const
 {
-	StringBuffer buf(m_len+1);
-
 	int endpos;
-	for ( endpos = m_len-1; m_cstr[endpos] == ch && endpos >= 0; endpos-- )
+	for ( endpos = m_len-1; endpos >= 0 && m_cstr[endpos] == ch; endpos-- )
 	{
 	}
-	for ( int x = 0; x <= endpos; x++ )
-	{
-		ASSERT(m_cstr[x] != '\0');
-		buf.Append(m_cstr[x]);
-	}
-	return buf.ToString();
+	return StringPtr(new String(m_cstr, endpos + 1));
 }
 
 StringPtr String::LTrim(char ch) const
@@ -429,7 +412,6 @@ StringPtr String::LTrim(char ch) const
 	}
 	
 	int pos;
-	StringBuffer buf(m_len);
 	for ( pos = 0; pos < m_len; pos++ )
 	{
 		if (m_cstr[pos] != ch)
@@ -437,36 +419,25 @@ StringPtr String::LTrim(char ch) const
 			break;
 		}
 	}
-	for ( int x = pos; x < m_len; x++ )
-	{
-		buf.Append(m_cstr[x]);
-	}
-
-	return buf.ToString();
+	return StringPtr(new String(m_cstr, pos, m_len - pos));
 }
 
 StringPtr String::Trim() const
 {
-	StringBuffer buf(m_len);
-
 	int pos;
-	for ( pos = 0; m_cstr[pos] == ' ' && pos < m_len; pos++ )
+	for ( pos = 0; pos < m_len && m_cstr[pos] == ' '; pos++ )
 	{
 	}
 	int endpos;
-	for ( endpos = m_len-1; m_cstr[endpos] == ' ' && endpos >= 0; endpos-- )
+	for ( endpos = m_len-1; endpos >= pos && m_cstr[endpos] == ' '; endpos-- )
 	{
 	}
-	for ( int x = pos; x <= endpos; x++ )
-	{
-		buf.Append(m_cstr[x]);
-	}
-	return buf.ToString();
+	return StringPtr(new String(m_cstr, pos, endpos - pos + 1));
 }
 
 void String::UnIntern()
 {
-	char *buf = (char *)malloc(m_len+1);
+	char *buf = Alloc(m_len);
 	StrCpyLen(buf, m_cstr, m_len);	
 	m_isintern = false;
 	m_cstr = buf;
@@ -557,12 +528,12 @@ StringPtr String::Intern( const char *str )
 
 uint32 String::HashCode() const
 {
-	return Math::Hash(m_cstr);
+	return Math::Hash(m_cstr, m_len);
 }
 
 uint64 String::HashCodeLong() const
 {
-	return Math::HashLong(m_cstr);
+	return Math::HashLong(m_cstr, m_len);
 }
 
 int String::Compare( const IComparable *istr ) const
@@ -1736,14 +1707,16 @@ namespace spl
 {
 	String operator +(const char *cp, const String& str)
 	{
-		return *String(cp).Cat(str);
+		String ret;
+		ret.InitWith(cp, (int)strlen(cp), str.m_cstr, str.m_len);
+		return ret;
 	}
 }
 
 #if defined(DEBUG) || defined(_DEBUG)
 void String::CheckMem() const
 {
-	if ( ! m_isintern )
+	if ( ! m_isintern && m_cstr != m_sso )
 	{
 		DEBUG_NOTE_MEM_ALLOCATION( m_cstr );
 	}
@@ -1751,7 +1724,7 @@ void String::CheckMem() const
 
 void String::ValidateMem() const
 {
-	if ( ! m_isintern )
+	if ( ! m_isintern && m_cstr != m_sso )
 	{
 		ASSERT_MEM( m_cstr, m_len );
 	}
@@ -0,0 +1,186 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <ctype.h>
+#include <spl/Exception.h>
+#include <spl/math/Math.h>
+#include <spl/String.h>
+#include <spl/StringView.h>
+
+using namespace spl;
+
+char StringView::CharAt( const int idx ) const
+{
+	if ( idx < 0 || idx >= m_len )
+	{
+		throw new IndexOutOfBoundsException();
+	}
+	return m_cstr[idx];
+}
+
+StringView StringView::Substring( int start, int len ) const
+{
+	if ( start < 0 )
+	{
+		start = 0;
+	}
+	if ( start > m_len )
+	{
+		start = m_len;
+	}
+	if ( start + len > m_len )
+	{
+		len = m_len - start;
+	}
+	if ( len < 0 )
+	{
+		len = 0;
+	}
+	return StringView(m_cstr, start, len);
+}
+
+StringView StringView::Trim() const
+{
+	int pos = 0;
+	int end = m_len;
+
+	while ( pos < end && (' ' == m_cstr[pos] || '\t' == m_cstr[pos]) )
+	{
+		pos++;
+	}
+	while ( end > pos && (' ' == m_cstr[end-1] || '\t' == m_cstr[end-1]) )
+	{
+		end--;
+	}
+	return StringView(m_cstr, pos, end - pos);
+}
+
+int StringView::IndexOf( const char ch, const int start ) const
+{
+	if ( start >= m_len || start < 0 )
+	{
+		return -1;
+	}
+	const char *cp = (const char *)memchr(&m_cstr[start], ch, m_len - start);
+	return NULL == cp ? -1 : (int)(cp - m_cstr);
+}
+
+int StringView::IndexOf( const StringView& str, const int start ) const
+{
+	if ( 0 == str.m_len )
+	{
+		return start <= m_len ? start : -1;
+	}
+
+	char first = str.m_cstr[0];
+	int last = m_len - str.m_len;
+
+	for ( int pos = start < 0 ? 0 : start; pos <= last; pos++ )
+	{
+		const char *cp = (const char *)memchr(&m_cstr[pos], first, last - pos + 1);
+		if ( NULL == cp )
+		{
+			return -1;
+		}
+		pos = (int)(cp - m_cstr);
+		if ( 0 == memcmp(cp, str.m_cstr, str.m_len) )
+		{
+			return pos;
+		}
+	}
+	return -1;
+}
+
+int StringView::LastIndexOf( const char ch ) const
+{
+	for ( int pos = m_len - 1; pos >= 0; pos-- )
+	{
+		if ( ch == m_cstr[pos] )
+		{
+			return pos;
+		}
+	}
+	return -1;
+}
+
+bool StringView::EqualsIgnoreCase( const StringView& str ) const
+{
+	if ( m_len != str.m_len )
+	{
+		return false;
+	}
+	for ( int x = 0; x < m_len; x++ )
+	{
+		if ( toupper(m_cstr[x]) != toupper(str.m_cstr[x]) )
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+int StringView::Compare( const StringView& str ) const
+{
+	int len = m_len < str.m_len ? m_len : str.m_len;
+	int cmp = memcmp(m_cstr, str.m_cstr, len);
+	if ( 0 != cmp )
+	{
+		return cmp > 0 ? 1 : -1;
+	}
+	if ( m_len == str.m_len )
+	{
+		return 0;
+	}
+	return m_len > str.m_len ? 1 : -1;
+}
+
+uint32 StringView::HashCode() const
+{
+	return Math::Hash(m_cstr, m_len);
+}
+
+int StringView::Split( const StringView& delim, Vector<StringView>& parts ) const
+{
+	int count = parts.Count();
+	int pos = 0;
+	int delimpos;
+
+	if ( 0 == m_len )
+	{
+		return 0;
+	}
+	if ( 0 == delim.m_len )
+	{
+		parts.Add(*this);
+		return 1;
+	}
+
+	while ( 0 <= (delimpos = IndexOf(delim, pos)) )
+	{
+		parts.Add(StringView(m_cstr, pos, delimpos - pos));
+		pos = delimpos + delim.m_len;
+	}
+	if ( pos < m_len )
+	{
+		parts.Add(StringView(m_cstr, pos, m_len - pos));
+	}
+	return parts.Count() - count;
+}
+
+StringPtr StringView::ToString() const
+{
+	return StringPtr(new String(m_cstr, m_len));
+}
@@ -97,6 +97,8 @@ void Thread::Start()
 	{
 		throw new ThreadStartException();
 	}
+	// Nothing calls pthread_join, so let the thread's resources go when it exits.
+	pthread_detach(m_threadid);
 #endif
 	/* Wait until 'running' is set */
 
@@ -206,8 +208,9 @@ DWORD WINAPI Thread::TheThread(void *param)
 	}
 
 	thread->m_hasrun = true;
-	thread->m_running = false;
 	thread->m_joinme.Notify();
+	// Last, the owner may delete the thread as soon as it sees this.
+	thread->m_running = false;
 
 	return 0;
 }
@@ -233,8 +236,9 @@ void *spl::TheThread(void *param)
 	}
 
 	thread->m_hasrun = true;
-	thread->m_running = false;
 	thread->m_joinme.Notify();
+	// Last, the owner may delete the thread as soon as it sees this.
+	thread->m_running = false;
 
 	return NULL;
 }
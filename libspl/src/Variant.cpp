@@ -42,103 +42,98 @@ IVariantData::~IVariantData()
 }
 
 Variant::Variant()
-: m_data(new _VariantData<Undefined>(Undefined()))
-{
-}
-
-Variant::Variant(IVariantData *m_data)
-: m_data(m_data)
 {
+	Store(Undefined(), VAR_UNDEFINED);
 }
 
 Variant::Variant(bool flag)
-: m_data(new _VariantData<bool>(flag))
 {
+	Store(flag, VAR_BOOL);
 }
 
 Variant::Variant(int8 i8)
-: m_data(new _VariantData<int8>(i8))
 {
+	Store(i8, VAR_INT8);
 }
 
 Variant::Variant(int16 i16)
-: m_data(new _VariantData<int16>(i16))
 {
+	Store(i16, VAR_INT16);
 }
 
 Variant::Variant(int32 i32)
-: m_data(new _VariantData<int32>(i32))
 {
+	Store(i32, VAR_INT32);
 }
 
 Variant::Variant(int64 i64)
-: m_data(new _VariantData<int64>(i64))
 {
+	Store(i64, VAR_INT64);
 }
 
 Variant::Variant(float32 f32)
-: m_data(new _VariantData<float32>(f32))
 {
+	Store(f32, VAR_FLOAT32);
 }
 
 Variant::Variant(float64 f64)
-: m_data(new _VariantData<float64>(f64))
 {
+	Store(f64, VAR_FLOAT64);
 }
 
 Variant::Variant(const DateTime &dtm)
-: m_data(new _VariantData<DateTime>(dtm))
 {
+	Store(dtm, VAR_DATETIME);
 }
 
 Variant::Variant(const Date& dt)
-: m_data(new _VariantData<Date>(dt))
 {
+	Store(dt, VAR_DATE);
 }
 
 Variant::Variant(const String& str)
-: m_data(new _VariantData<String>(str))
 {
+	Store(str, VAR_STRING);
 }
 
 Variant::Variant(const String *str)
-: m_data(new _VariantData<String>(*str))
 {
+	Store(*str, VAR_STRING);
 }
 
 Variant::Variant(const char * str)
-: m_data(new _VariantData<String>(String(str)))
 {
+	Store(String(str), VAR_STRING);
 }
 
 Variant::Variant(const Decimal& dec)
-: m_data(new _VariantData<Decimal>(dec))
 {
+	Store(dec, VAR_DECIMAL);
 }
 
 Variant::Variant(const Variant& v)
-: m_data(v.m_data->Copy())
 {
+	StoreCopy(v);
 }
 
 Variant::Variant(const Undefined& u)
-: m_data(new _VariantData<Undefined>(u))
 {
+	Store(u, VAR_UNDEFINED);
 }
 
 Variant::Variant(const Null& n)
-: m_data(new _VariantData<Null>(n))
 {
+	Store(n, VAR_NULL);
 }
 
-//Variant::Variant(RefCountPtr<IJsObject> jso)
-//: m_data(new _VariantData<RefCountPtr<IJsObject> >(jso))
-//{
-//}
+Variant::Variant(RefCountPtr<IJsObject> jso)
+{
+	Store(jso, VAR_OBJECT);
+}
 
 Variant::~Variant()
 {
-	delete m_data;
+	Free();
 }
 
 RefCountPtr<Variant> Variant::ParseInt() const
@@ -185,89 +180,173 @@ String Variant::TypeName() const
 
 Variant &Variant::operator =(const Variant &v)
 {
-	ASSERT(m_data != v.m_data);
+	if (&v == this)
+	{
+		return *this;
+	}
 	ValidateMem();
-	delete m_data;
-	m_data = v.m_data->Copy();
+	Free();
+	StoreCopy(v);
 	return *this;
 }
 
 Variant& Variant::operator =(const int32 i)
 {
 	ValidateMem();
-	delete m_data;
-	m_data = new _VariantData<int32>(i);
+	Free();
+	Store(i, VAR_INT32);
 	return *this;
 }
 
 Variant& Variant::operator =(const int64 i)
 {
 	ValidateMem();
-	delete m_data;
-	m_data = new _VariantData<int64>(i);
+	Free();
+	Store(i, VAR_INT64);
 	return *this;
 }
 
 Variant& Variant::operator =(const float64 d)
 {
 	ValidateMem();
-	delete m_data;
-	m_data = new _VariantData<float64>(d);
+	Free();
+	Store(d, VAR_FLOAT64);
 	return *this;	
 }
 
 Variant& Variant::operator =(const String& s)
 {
 	ValidateMem();
-	delete m_data;
-	m_data = new _VariantData<String>(s);
+	Free();
+	Store(s, VAR_STRING);
 	return *this;	
 }
 
 Variant& Variant::operator =(const char *cp)
 {
 	ValidateMem();
-	delete m_data;
-	m_data = new _VariantData<String>(cp);
+	Free();
+	Store(String(cp), VAR_STRING);
 	return *this;	
 }
 
 Variant& Variant::operator =(const DateTime& s)
 {
 	ValidateMem();
-	delete m_data;
-	m_data = new _VariantData<DateTime>(s);
+	Free();
+	Store(s, VAR_DATETIME);
 	return *this;	
 }
 
 Variant& Variant::operator =(const Date& s)
 {
 	ValidateMem();
-	delete m_data;
-	m_data = new _VariantData<Date>(s);
+	Free();
+	Store(s, VAR_DATE);
 	return *this;	
 }
 
 Variant& Variant::operator =(const Decimal& s)
 {
 	ValidateMem();
-	delete m_data;
-	m_data = new _VariantData<Decimal>(s);
+	Free();
+	Store(s, VAR_DECIMAL);
+	return *this;	
+}
+
+Variant& Variant::operator =(RefCountPtr<IJsObject> s)
+{
+	ValidateMem();
+	Free();
+	Store(s, VAR_OBJECT);
 	return *this;	
 }
 
-//Variant& Variant::operator =(RefCountPtr<IJsObject> s)
-//{
-//	ValidateMem();
-//	delete m_data;
-//	m_data = new _VariantData<RefCountPtr<IJsObject> >(s);
-//	return *this;	
-//}
+int64 Variant::NumberToInt64() const
+{
+	switch (m_type)
+	{
+	case VAR_INT8:
+		return Value<int8>();
+	case VAR_INT16:
+		return Value<int16>();
+	case VAR_INT32:
+		return Value<int32>();
+	case VAR_INT64:
+		return Value<int64>();
+	case VAR_FLOAT32:
+		return (int64)Value<float32>();
+	case VAR_FLOAT64:
+		return (int64)Value<float64>();
+	default:
+		ASSERT(false);
+		return 0;
+	}
+}
+
+float64 Variant::NumberToFloat64() const
+{
+	switch (m_type)
+	{
+	case VAR_FLOAT32:
+		return Value<float32>();
+	case VAR_FLOAT64:
+		return Value<float64>();
+	default:
+		return (float64)NumberToInt64();
+	}
+}
+
+Variant Variant::NumberOp(const Variant& v, char op) const
+{
+	ASSERT(IsNumber() && v.IsNumber());
+	if (IsFloatNumber() || v.IsFloatNumber())
+	{
+		float64 a = NumberToFloat64();
+		float64 b = v.NumberToFloat64();
+		switch (op)
+		{
+		case '+':
+			return Variant(a + b);
+		case '-':
+			return Variant(a - b);
+		case '*':
+			return Variant(a * b);
+		case '/':
+			return Variant(a / b);
+		default:
+			ASSERT('%' == op);
+			return Variant(Math::Remainder(a, b));
+		}
+	}
+
+	int64 a = NumberToInt64();
+	int64 b = v.NumberToInt64();
+	switch (op)
+	{
+	case '+':
+		return Variant(a + b);
+	case '-':
+		return Variant(a - b);
+	case '*':
+		return Variant(a * b);
+	case '/':
+		return Variant(a / b);
+	default:
+		ASSERT('%' == op);
+		return Variant(a % b);
+	}
+}
 
 bool Variant::ToBool() const
 {
 	bool b;
 
+	if (VAR_BOOL == m_type)
+	{
+		return Value<bool>();
+	}
+
 	if (m_data->ToBool(b))
 	{
 		return b;
@@ -298,6 +377,10 @@ int16 Variant::ToInt16() const
 int32 Variant::ToInt32() const
 {
 	int32 i;
+	if (VAR_INT32 == m_type)
+	{
+		return Value<int32>();
+	}
 	if (m_data->ToInt32(i))
 	{
 		return i;
@@ -308,6 +391,10 @@ int32 Variant::ToInt32() const
 int64 Variant::ToInt64() const
 {
 	int64 i;
+	if (IsNumber() && !IsFloatNumber())
+	{
+		return NumberToInt64();
+	}
 	if (m_data->ToInt64(i))
 	{
 		return i;
@@ -328,6 +415,10 @@ float32 Variant::ToFloat32() const
 float64 Variant::ToFloat64() const
 {
 	float64 d;
+	if (IsNumber())
+	{
+		return NumberToFloat64();
+	}
 	if (m_data->ToFloat64(d))
 	{
 		return d;
@@ -372,31 +463,17 @@ StringPtr Variant::ToString() const
 	return s.Clone();
 }
 
-/*RefCountPtr<IJsObject> Variant::ToObject() const
+RefCountPtr<IJsObject> Variant::ToObject() const
 {
-	ASSERT(IsObject());
-
-	RefCountPtr<IJsObject> obj = static_cast<_VariantData<RefCountPtr<IJsObject> > *>(m_data)->GetRef();
-	obj.ValidateMem();
-
-	if (m_data->MajicNumber() == JSOBJECT_MAJIC)
-	{
-		ASSERT_MEM(obj.Get(), sizeof(JsObject));
-		return obj;
-	}
-	if (m_data->MajicNumber() == JSARRAY_MAJIC)
-	{
-		ASSERT_MEM(obj.Get(), sizeof(JsArray));
-		return obj;
-	}
-	if (m_data->MajicNumber() == JSMETHOD_MAJIC)
+	if (VAR_OBJECT != m_type)
 	{
-		ASSERT_MEM(obj.Get(), sizeof(JsMethod));
-		return obj;
+		throw new InvalidTypeConversionException("Cannot convert " + m_data->TypeName() + " to object.");
 	}
-	throw new Exception("Internal error Variant::ToObject");
+
+	RefCountPtr<IJsObject> obj = Value<RefCountPtr<IJsObject> >();
+	obj.ValidateMem();
+	return obj;
 }
-*/
 
 bool Variant::ToChar(char& c2) const
 {
@@ -512,6 +589,18 @@ uint32 Variant::HashCode() const
 
 bool Variant::BinOp(const Variant& v, enum CompareOperator op) const
 {
+	if (IsNumber() && v.IsNumber())
+	{
+		if (IsFloatNumber() || v.IsFloatNumber())
+		{
+			float64 a = NumberToFloat64();
+			float64 b = v.NumberToFloat64();
+			return op == Variant::VOP_EQ ? a == b : (op == Variant::VOP_GT ? a > b : a < b);
+		}
+		int64 a = NumberToInt64();
+		int64 b = v.NumberToInt64();
+		return op == Variant::VOP_EQ ? a == b : (op == Variant::VOP_GT ? a > b : a < b);
+	}
 	if (Convert::IsFloat(m_data) || Convert::IsFloat(v.m_data))
 	{
 		float64 a, b;
@@ -769,6 +858,10 @@ RefCountPtr<Variant> Variant::ToVarString() const
 
 RefCountPtr<Variant> Variant::Add(const Variant& v) const
 {
+	if (IsNumber() && v.IsNumber())
+	{
+		return VariantPtr(new Variant(NumberOp(v, '+')));
+	}
 	if (m_data->IsFloat() || v.m_data->IsFloat())
 	{
 		float64 a, b;
@@ -794,6 +887,10 @@ RefCountPtr<Variant> Variant::Add(const Variant& v) const
 
 RefCountPtr<Variant> Variant::Sub(const Variant& v) const
 {
+	if (IsNumber() && v.IsNumber())
+	{
+		return VariantPtr(new Variant(NumberOp(v, '-')));
+	}
 	if (m_data->IsFloat() || v.m_data->IsFloat())
 	{
 		float64 a, b;
@@ -814,6 +911,10 @@ RefCountPtr<Variant> Variant::Sub(const Variant& v) const
 
 RefCountPtr<Variant> Variant::Div(const Variant& v) const
 {
+	if (IsNumber() && v.IsNumber())
+	{
+		return VariantPtr(new Variant(NumberOp(v, '/')));
+	}
 	if (m_data->IsFloat() || v.m_data->IsFloat())
 	{
 		float64 a, b;
@@ -834,6 +935,10 @@ RefCountPtr<Variant> Variant::Div(const Variant& v) const
 
 RefCountPtr<Variant> Variant::Mul(const Variant& v) const
 {
+	if (IsNumber() && v.IsNumber())
+	{
+		return VariantPtr(new Variant(NumberOp(v, '*')));
+	}
 	if (m_data->IsFloat() || v.m_data->IsFloat())
 	{
 		float64 a, b;
@@ -854,6 +959,10 @@ RefCountPtr<Variant> Variant::Mul(const Variant& v) const
 
 RefCountPtr<Variant> Variant::Mod(const Variant& v) const
 {
+	if (IsNumber() && v.IsNumber())
+	{
+		return VariantPtr(new Variant(NumberOp(v, '%')));
+	}
 	if (m_data->IsFloat() || v.m_data->IsFloat())
 	{
 		float64 a, b;
@@ -872,6 +981,51 @@ RefCountPtr<Variant> Variant::Mod(const Variant& v) const
 	return VariantPtr(new Variant());
 }
 
+Variant Variant::operator +(const Variant& v) const
+{
+	if (IsNumber() && v.IsNumber())
+	{
+		return NumberOp(v, '+');
+	}
+	return *Add(v);
+}
+
+Variant Variant::operator -(const Variant& v) const
+{
+	if (IsNumber() && v.IsNumber())
+	{
+		return NumberOp(v, '-');
+	}
+	return *Sub(v);
+}
+
+Variant Variant::operator /(const Variant& v) const
+{
+	if (IsNumber() && v.IsNumber())
+	{
+		return NumberOp(v, '/');
+	}
+	return *Div(v);
+}
+
+Variant Variant::operator *(const Variant& v) const
+{
+	if (IsNumber() && v.IsNumber())
+	{
+		return NumberOp(v, '*');
+	}
+	return *Mul(v);
+}
+
+Variant Variant::operator %(const Variant& v) const
+{
+	if (IsNumber() && v.IsNumber())
+	{
+		return NumberOp(v, '%');
+	}
+	return *Mod(v);
+}
+
 RefCountPtr<Variant> Variant::Exp(const Variant& v) const
 {
 	if (Convert::CanConvertToInt(m_data) && Convert::CanConvertToInt(v.m_data))
@@ -1039,20 +1193,25 @@ RefCountPtr<Variant> Variant::Neg() const
 
 VariantPtr Variant::Clone() const
 {
-	VariantPtr v(new Variant(m_data->Clone()));
-	return v;
+	return VariantPtr(new Variant(*this));
 }
 
 #ifdef DEBUG
 void Variant::ValidateMem() const
 {
-	ASSERT_PTR(m_data);
+	if (!IsInline())
+	{
+		ASSERT_PTR(m_data);
+	}
 	m_data->ValidateMem();
 }
 
 void Variant::CheckMem() const
 {
-	DEBUG_NOTE_MEM(m_data);
+	if (!IsInline())
+	{
+		DEBUG_NOTE_MEM(m_data);
+	}
 	m_data->CheckMem();
 }
 #endif
@@ -0,0 +1,873 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <spl/Exception.h>
+#include <spl/collection/Hashtable.h>
+#include <spl/data/ColumnOps.h>
+#include <spl/data/ColumnTypes.h>
+
+using namespace spl;
+
+static inline int _LowBit(uint32 bits)
+{
+	ASSERT(0 != bits);
+#if defined(__GNUC__)
+	return __builtin_ctz(bits);
+#else
+	int n = 0;
+	while (0 == (bits & 1))
+	{
+		bits >>= 1;
+		n++;
+	}
+	return n;
+#endif
+}
+
+static inline int _PopCount(uint32 bits)
+{
+#if defined(__GNUC__)
+	return __builtin_popcount(bits);
+#else
+	bits = bits - ((bits >> 1) & 0x55555555);
+	bits = (bits & 0x33333333) + ((bits >> 2) & 0x33333333);
+	return (int)((((bits + (bits >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24);
+#endif
+}
+
+/// The bits of word w that are rows in a table of rows rows.
+static inline uint32 _RowMask(int w, int rows)
+{
+	const int left = rows - (w << 5);
+	return left >= 32 ? 0xFFFFFFFF : (1U << left) - 1;
+}
+
+static inline bool _IsIntegerType(int type)
+{
+	return DbSqlType::SQL_TYPE_INT8 == type ||
+		DbSqlType::SQL_TYPE_INT16 == type ||
+		DbSqlType::SQL_TYPE_INT32 == type ||
+		DbSqlType::SQL_TYPE_INT64 == type ||
+		DbSqlType::SQL_TYPE_FLAG == type;
+}
+
+static inline bool _IsFloatType(int type)
+{
+	return DbSqlType::SQL_TYPE_FLOAT32 == type || DbSqlType::SQL_TYPE_FLOAT64 == type;
+}
+
+RowBitmap::RowBitmap(int rows, bool selected)
+: m_words((rows + 31) >> 5), m_rows(rows)
+{
+	if (selected && m_words.Length() > 0)
+	{
+		memset(m_words.Data(), 0xFF, m_words.Length() * sizeof(uint32));
+		ClearTail();
+	}
+}
+
+RowBitmap::RowBitmap(const RowBitmap& bits)
+: m_words(bits.m_words), m_rows(bits.m_rows)
+{
+}
+
+RowBitmap::~RowBitmap()
+{
+}
+
+RowBitmap& RowBitmap::operator =(const RowBitmap& bits)
+{
+	m_words = bits.m_words;
+	m_rows = bits.m_rows;
+	return *this;
+}
+
+void RowBitmap::ClearTail()
+{
+	if (0 != (m_rows & 31))
+	{
+		m_words.Data()[m_words.Length() - 1] &= (1U << (m_rows & 31)) - 1;
+	}
+}
+
+int RowBitmap::Count() const
+{
+	const uint32 *words = m_words.Data();
+	int count = 0;
+	for (int w = 0; w < m_words.Length(); w++)
+	{
+		count += _PopCount(words[w]);
+	}
+	return count;
+}
+
+void RowBitmap::And(const RowBitmap& bits)
+{
+	if (bits.m_rows != m_rows)
+	{
+		throw new InvalidArgumentException("RowBitmap::And: row counts differ");
+	}
+	uint32 *words = m_words.Data();
+	const uint32 *other = bits.m_words.Data();
+	for (int w = 0; w < m_words.Length(); w++)
+	{
+		words[w] &= other[w];
+	}
+}
+
+void RowBitmap::Or(const RowBitmap& bits)
+{
+	if (bits.m_rows != m_rows)
+	{
+		throw new InvalidArgumentException("RowBitmap::Or: row counts differ");
+	}
+	uint32 *words = m_words.Data();
+	const uint32 *other = bits.m_words.Data();
+	for (int w = 0; w < m_words.Length(); w++)
+	{
+		words[w] |= other[w];
+	}
+}
+
+void RowBitmap::Not()
+{
+	uint32 *words = m_words.Data();
+	for (int w = 0; w < m_words.Length(); w++)
+	{
+		words[w] = ~words[w];
+	}
+	ClearTail();
+}
+
+void RowBitmap::ToRows(Vector<int>& rows) const
+{
+	const uint32 *words = m_words.Data();
+	for (int w = 0; w < m_words.Length(); w++)
+	{
+		uint32 bits = words[w];
+		while (0 != bits)
+		{
+			rows.Add((w << 5) + _LowBit(bits));
+			bits &= bits - 1;
+		}
+	}
+}
+
+#if defined(DEBUG)
+void RowBitmap::CheckMem() const
+{
+	m_words.CheckMem();
+}
+
+void RowBitmap::ValidateMem() const
+{
+	m_words.ValidateMem();
+}
+#endif
+
+struct _CmpEq { template<typename A> static inline bool Test(A a, A b) { return a == b; } };
+struct _CmpNe { template<typename A> static inline bool Test(A a, A b) { return a != b; } };
+struct _CmpLt { template<typename A> static inline bool Test(A a, A b) { return a < b; } };
+struct _CmpLe { template<typename A> static inline bool Test(A a, A b) { return a <= b; } };
+struct _CmpGt { template<typename A> static inline bool Test(A a, A b) { return a > b; } };
+struct _CmpGe { template<typename A> static inline bool Test(A a, A b) { return a >= b; } };
+
+/// Sets a bit in out for every row of data that passes; branch free, so it unrolls.
+template<typename T, typename V, typename CMP>
+static void _FilterWith(const T *data, int rows, V value, uint32 *out)
+{
+	const int full = rows >> 5;
+	for (int w = 0; w < full; w++)
+	{
+		const T *p = &data[w << 5];
+		uint32 bits = 0;
+		for (int b = 0; b < 32; b++)
+		{
+			bits |= (uint32)CMP::Test((V)p[b], value) << b;
+		}
+		out[w] = bits;
+	}
+	if (0 != (rows & 31))
+	{
+		const T *p = &data[full << 5];
+		uint32 bits = 0;
+		for (int b = 0; b < (rows & 31); b++)
+		{
+			bits |= (uint32)CMP::Test((V)p[b], value) << b;
+		}
+		out[full] = bits;
+	}
+}
+
+template<typename T, typename V>
+static void _FilterValues(const T *data, int rows, int op, V value, uint32 *out)
+{
+	switch (op)
+	{
+	case ColumnOps::CMP_EQ:
+		_FilterWith<T, V, _CmpEq>(data, rows, value, out);
+		break;
+	case ColumnOps::CMP_NE:
+		_FilterWith<T, V, _CmpNe>(data, rows, value, out);
+		break;
+	case ColumnOps::CMP_LT:
+		_FilterWith<T, V, _CmpLt>(data, rows, value, out);
+		break;
+	case ColumnOps::CMP_LE:
+		_FilterWith<T, V, _CmpLe>(data, rows, value, out);
+		break;
+	case ColumnOps::CMP_GT:
+		_FilterWith<T, V, _CmpGt>(data, rows, value, out);
+		break;
+	case ColumnOps::CMP_GE:
+		_FilterWith<T, V, _CmpGe>(data, rows, value, out);
+		break;
+	default:
+		throw new InvalidArgumentException("ColumnOps::Filter: unknown comparison");
+	}
+}
+
+static void _DropNulls(IColumn *col, RowBitmap& result)
+{
+	int nullWords;
+	const uint32 *nulls = col->NullBitmap(nullWords);
+	uint32 *out = result.Words();
+	if (nullWords > result.WordCount())
+	{
+		nullWords = result.WordCount();
+	}
+	for (int w = 0; w < nullWords; w++)
+	{
+		out[w] &= ~nulls[w];
+	}
+}
+
+static void _CheckRows(IColumn *col, const RowBitmap& bits)
+{
+	if (bits.Rows() != col->Count())
+	{
+		throw new InvalidArgumentException("ColumnOps: the RowBitmap doesn't match the column's row count");
+	}
+}
+
+template<typename V>
+static void _Filter(IColumn *col, int op, V value, RowBitmap& result)
+{
+	_CheckRows(col, result);
+
+	const int rows = col->Count();
+	uint32 *out = result.Words();
+
+	switch (col->Type())
+	{
+	case DbSqlType::SQL_TYPE_INT8:
+		_FilterValues(static_cast<Int8Column *>(col)->Data(), rows, op, value, out);
+		break;
+	case DbSqlType::SQL_TYPE_INT16:
+		_FilterValues(static_cast<Int16Column *>(col)->Data(), rows, op, value, out);
+		break;
+	case DbSqlType::SQL_TYPE_INT32:
+		_FilterValues(static_cast<Int32Column *>(col)->Data(), rows, op, value, out);
+		break;
+	case DbSqlType::SQL_TYPE_INT64:
+		_FilterValues(static_cast<Int64Column *>(col)->Data(), rows, op, value, out);
+		break;
+	case DbSqlType::SQL_TYPE_FLOAT32:
+		_FilterValues(static_cast<Float32Column *>(col)->Data(), rows, op, value, out);
+		break;
+	case DbSqlType::SQL_TYPE_FLOAT64:
+		_FilterValues(static_cast<Float64Column *>(col)->Data(), rows, op, value, out);
+		break;
+	case DbSqlType::SQL_TYPE_FLAG:
+		_FilterValues(static_cast<BitColumn *>(col)->Data(), rows, op, value, out);
+		break;
+	default:
+		throw new InvalidTypeConversionException();
+	}
+
+	_DropNulls(col, result);
+}
+
+void ColumnOps::Filter(IColumn *col, int op, int64 value, RowBitmap& result)
+{
+	if (_IsFloatType(col->Type()))
+	{
+		_Filter<float64>(col, op, (float64)value, result);
+	}
+	else
+	{
+		_Filter<int64>(col, op, value, result);
+	}
+}
+
+void ColumnOps::Filter(IColumn *col, int op, float64 value, RowBitmap& result)
+{
+	_Filter<float64>(col, op, value, result);
+}
+
+void ColumnOps::FilterNull(IColumn *col, bool isNull, RowBitmap& result)
+{
+	_CheckRows(col, result);
+
+	int nullWords;
+	const uint32 *nulls = col->NullBitmap(nullWords);
+	uint32 *out = result.Words();
+	for (int w = 0; w < result.WordCount(); w++)
+	{
+		out[w] = w < nullWords ? nulls[w] : 0;
+	}
+	if (!isNull)
+	{
+		result.Not();
+	}
+}
+
+/** Sums 32 values with four partial sums, so the adds don't wait on each other. */
+template<typename T, typename A>
+static inline void _SummarizeBlock(const T *p, A& sum, A& min, A& max)
+{
+	A s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+	A mn = min, mx = max;
+	for (int b = 0; b < 32; b += 4)
+	{
+		const A v0 = (A)p[b], v1 = (A)p[b + 1], v2 = (A)p[b + 2], v3 = (A)p[b + 3];
+		s0 += v0;
+		s1 += v1;
+		s2 += v2;
+		s3 += v3;
+		mn = v0 < mn ? v0 : mn;
+		mn = v1 < mn ? v1 : mn;
+		mn = v2 < mn ? v2 : mn;
+		mn = v3 < mn ? v3 : mn;
+		mx = v0 > mx ? v0 : mx;
+		mx = v1 > mx ? v1 : mx;
+		mx = v2 > mx ? v2 : mx;
+		mx = v3 > mx ? v3 : mx;
+	}
+	sum += (s0 + s1) + (s2 + s3);
+	min = mn;
+	max = mx;
+}
+
+/** A is int64 for integer columns, so their sum is exact, and float64 otherwise. */
+template<typename T, typename A>
+static void _Summarize(IColumn *col, const T *data, const RowBitmap *sel, ColumnSummary& result)
+{
+	const int rows = col->Count();
+	const int words = (rows + 31) >> 5;
+	int nullWords;
+	const uint32 *nulls = col->NullBitmap(nullWords);
+	const uint32 *selWords = NULL == sel ? NULL : sel->Words();
+
+	A sum = 0, min = 0, max = 0;
+	int64 count = 0;
+	bool seeded = false;
+
+	for (int w = 0; w < words; w++)
+	{
+		uint32 mask = NULL == selWords ? _RowMask(w, rows) : selWords[w];
+		if (w < nullWords)
+		{
+			mask &= ~nulls[w];
+		}
+		if (0 == mask)
+		{
+			continue;
+		}
+
+		const T *p = &data[w << 5];
+		if (!seeded)
+		{
+			min = max = (A)p[_LowBit(mask)];
+			seeded = true;
+		}
+
+		if (0xFFFFFFFF == mask)
+		{
+			_SummarizeBlock<T, A>(p, sum, min, max);
+			count += 32;
+			continue;
+		}
+
+		count += _PopCount(mask);
+		while (0 != mask)
+		{
+			const A v = (A)p[_LowBit(mask)];
+			sum += v;
+			min = v < min ? v : min;
+			max = v > max ? v : max;
+			mask &= mask - 1;
+		}
+	}
+
+	result.count = count;
+	result.sum = (float64)sum;
+	result.intSum = (int64)sum;
+	result.min = (float64)min;
+	result.max = (float64)max;
+}
+
+ColumnSummary ColumnOps::Aggregate(IColumn *col, const RowBitmap *sel)
+{
+	if (NULL != sel)
+	{
+		_CheckRows(col, *sel);
+	}
+
+	ColumnSummary result;
+	switch (col->Type())
+	{
+	case DbSqlType::SQL_TYPE_INT8:
+		_Summarize<int8, int64>(col, static_cast<Int8Column *>(col)->Data(), sel, result);
+		break;
+	case DbSqlType::SQL_TYPE_INT16:
+		_Summarize<int16, int64>(col, static_cast<Int16Column *>(col)->Data(), sel, result);
+		break;
+	case DbSqlType::SQL_TYPE_INT32:
+		_Summarize<int32, int64>(col, static_cast<Int32Column *>(col)->Data(), sel, result);
+		break;
+	case DbSqlType::SQL_TYPE_INT64:
+		_Summarize<int64, int64>(col, static_cast<Int64Column *>(col)->Data(), sel, result);
+		break;
+	case DbSqlType::SQL_TYPE_FLAG:
+		_Summarize<bool, int64>(col, static_cast<BitColumn *>(col)->Data(), sel, result);
+		break;
+	case DbSqlType::SQL_TYPE_FLOAT32:
+		_Summarize<float32, float64>(col, static_cast<Float32Column *>(col)->Data(), sel, result);
+		break;
+	case DbSqlType::SQL_TYPE_FLOAT64:
+		_Summarize<float64, float64>(col, static_cast<Float64Column *>(col)->Data(), sel, result);
+		break;
+	default:
+		throw new InvalidTypeConversionException();
+	}
+	return result;
+}
+
+template<typename T, typename A>
+static inline void _Widen(const T *data, int rows, A *out)
+{
+	for (int x = 0; x < rows; x++)
+	{
+		out[x] = (A)data[x];
+	}
+}
+
+/// Copies a numeric column to out, which has col->Count() elements.
+template<typename A>
+static void _WidenColumn(IColumn *col, A *out)
+{
+	const int rows = col->Count();
+	switch (col->Type())
+	{
+	case DbSqlType::SQL_TYPE_INT8:
+		_Widen(static_cast<Int8Column *>(col)->Data(), rows, out);
+		break;
+	case DbSqlType::SQL_TYPE_INT16:
+		_Widen(static_cast<Int16Column *>(col)->Data(), rows, out);
+		break;
+	case DbSqlType::SQL_TYPE_INT32:
+		_Widen(static_cast<Int32Column *>(col)->Data(), rows, out);
+		break;
+	case DbSqlType::SQL_TYPE_INT64:
+		_Widen(static_cast<Int64Column *>(col)->Data(), rows, out);
+		break;
+	case DbSqlType::SQL_TYPE_FLAG:
+		_Widen(static_cast<BitColumn *>(col)->Data(), rows, out);
+		break;
+	case DbSqlType::SQL_TYPE_FLOAT32:
+		_Widen(static_cast<Float32Column *>(col)->Data(), rows, out);
+		break;
+	case DbSqlType::SQL_TYPE_FLOAT64:
+		_Widen(static_cast<Float64Column *>(col)->Data(), rows, out);
+		break;
+	default:
+		throw new InvalidTypeConversionException();
+	}
+}
+
+static IColumn *_FindColumn(RecordSet& rs, const String& name)
+{
+	IColumn *col = rs.GetColumn(name);
+	if (NULL == col)
+	{
+		throw new InvalidArgumentException("ColumnOps: no such column");
+	}
+	return col;
+}
+
+RecordSetPtr ColumnOps::GroupBy(RecordSet& rs, const String& keyCol, const String& valueCol, const RowBitmap *sel)
+{
+	IColumn *key = _FindColumn(rs, keyCol);
+	IColumn *value = _FindColumn(rs, valueCol);
+	const int rows = key->Count();
+	const bool intKeys = _IsIntegerType(key->Type());
+
+	if (value->Count() != rows)
+	{
+		throw new InvalidArgumentException("ColumnOps::GroupBy: the columns have different row counts");
+	}
+	if (NULL != sel)
+	{
+		_CheckRows(key, *sel);
+	}
+
+	Array<float64> values(rows);
+	_WidenColumn(value, values.Data());
+
+	Array<int64> intKeyValues(intKeys ? rows : 0);
+	if (intKeys)
+	{
+		_WidenColumn(key, intKeyValues.Data());
+	}
+
+	// Per group, in the order the keys were first seen.
+	Vector<int> firstRows;
+	Vector<int64> counts;
+	Vector<float64> sums;
+	Vector<float64> mins;
+	Vector<float64> maxs;
+
+	Hashtable<int64, int> intGroups(intKeys ? 64 : 8);
+	Hashtable<String, int> strGroups;
+	int nullGroup = -1;
+
+	Vector<int> selected;
+	if (NULL == sel)
+	{
+		for (int row = 0; row < rows; row++)
+		{
+			selected.Add(row);
+		}
+	}
+	else
+	{
+		sel->ToRows(selected);
+	}
+
+	for (int x = 0; x < selected.Count(); x++)
+	{
+		const int row = selected.ElementAt(x);
+		int group;
+
+		if (key->IsNull(row))
+		{
+			group = nullGroup;
+		}
+		else if (intKeys)
+		{
+			if (!intGroups.TryGet(intKeyValues.Data()[row], group))
+			{
+				group = -1;
+			}
+		}
+		else
+		{
+			StringPtr str = key->GetVarchar(row);
+			if (!strGroups.TryGet(*str, group))
+			{
+				group = -1;
+			}
+		}
+
+		if (group < 0)
+		{
+			group = firstRows.Count();
+			firstRows.Add(row);
+			counts.Add(0);
+			sums.Add(0);
+			mins.Add(0);
+			maxs.Add(0);
+
+			if (key->IsNull(row))
+			{
+				nullGroup = group;
+			}
+			else if (intKeys)
+			{
+				intGroups.Set(intKeyValues.Data()[row], group);
+			}
+			else
+			{
+				strGroups.Set(*key->GetVarchar(row), group);
+			}
+		}
+
+		if (value->IsNull(row))
+		{
+			continue;
+		}
+
+		const float64 v = values.Data()[row];
+		if (0 == counts.Data()[group]++)
+		{
+			mins.Data()[group] = maxs.Data()[group] = v;
+		}
+		else
+		{
+			mins.Data()[group] = v < mins.Data()[group] ? v : mins.Data()[group];
+			maxs.Data()[group] = v > maxs.Data()[group] ? v : maxs.Data()[group];
+		}
+		sums.Data()[group] += v;
+	}
+
+	RecordSetPtr result(new RecordSet());
+	result->DefineColumn(keyCol, intKeys ? DbSqlType::SQL_TYPE_INT64 : DbSqlType::SQL_TYPE_VARCHAR, intKeys ? 8 : key->MaxLength());
+	result->DefineColumn("count", DbSqlType::SQL_TYPE_INT64, 8);
+	result->DefineColumn("sum", DbSqlType::SQL_TYPE_FLOAT64, 8);
+	result->DefineColumn("min", DbSqlType::SQL_TYPE_FLOAT64, 8);
+	result->DefineColumn("max", DbSqlType::SQL_TYPE_FLOAT64, 8);
+	result->DefineColumn("avg", DbSqlType::SQL_TYPE_FLOAT64, 8);
+
+	IColumn *outKey = result->GetColumn(0);
+	IColumn *outCount = result->GetColumn(1);
+	IColumn *outSum = result->GetColumn(2);
+	IColumn *outMin = result->GetColumn(3);
+	IColumn *outMax = result->GetColumn(4);
+	IColumn *outAvg = result->GetColumn(5);
+
+	for (int group = 0; group < firstRows.Count(); group++)
+	{
+		const int row = firstRows.ElementAt(group);
+		if (group == nullGroup)
+		{
+			outKey->AppendNull();
+		}
+		else if (intKeys)
+		{
+			outKey->Append(intKeyValues.Data()[row]);
+		}
+		else
+		{
+			outKey->Append(*key->GetVarchar(row));
+		}
+
+		const int64 count = counts.ElementAt(group);
+		outCount->Append(count);
+		if (0 == count)
+		{
+			outSum->AppendNull();
+			outMin->AppendNull();
+			outMax->AppendNull();
+			outAvg->AppendNull();
+		}
+		else
+		{
+			outSum->Append(sums.ElementAt(group));
+			outMin->Append(mins.ElementAt(group));
+			outMax->Append(maxs.ElementAt(group));
+			outAvg->Append(sums.ElementAt(group) / (float64)count);
+		}
+	}
+
+	return result;
+}
+
+/// One Sort key, widened to int64, float64 or String for every row.
+class _SortKey
+{
+public:
+	IColumn *col;
+	Array<int64> ints;
+	Array<float64> floats;
+	Array<StringPtr> strs;
+	int kind;				//< 0 for ints, 1 for floats, 2 for strs.
+	bool descending;
+
+	_SortKey(IColumn *c, bool desc)
+	: col(c),
+	  ints(_IsIntegerType(c->Type()) ? c->Count() : 0),
+	  floats(_IsFloatType(c->Type()) ? c->Count() : 0),
+	  strs(_IsIntegerType(c->Type()) || _IsFloatType(c->Type()) ? 0 : c->Count()),
+	  kind(_IsIntegerType(c->Type()) ? 0 : (_IsFloatType(c->Type()) ? 1 : 2)),
+	  descending(desc)
+	{
+		if (0 == kind)
+		{
+			_WidenColumn(col, ints.Data());
+		}
+		else if (1 == kind)
+		{
+			_WidenColumn(col, floats.Data());
+		}
+		else
+		{
+			for (int row = 0; row < col->Count(); row++)
+			{
+				if (!col->IsNull(row))
+				{
+					strs.Data()[row] = col->GetVarchar(row);
+				}
+			}
+		}
+	}
+
+	inline int Compare(int a, int b) const
+	{
+		const bool na = col->IsNull(a);
+		const bool nb = col->IsNull(b);
+		if (na || nb)
+		{
+			return na == nb ? 0 : (na ? -1 : 1);
+		}
+
+		int cmp;
+		if (0 == kind)
+		{
+			const int64 va = ints.Data()[a], vb = ints.Data()[b];
+			cmp = va < vb ? -1 : (va > vb ? 1 : 0);
+		}
+		else if (1 == kind)
+		{
+			const float64 va = floats.Data()[a], vb = floats.Data()[b];
+			cmp = va < vb ? -1 : (va > vb ? 1 : 0);
+		}
+		else
+		{
+			cmp = strs.Data()[a]->Compare(*strs.Data()[b]);
+		}
+		return descending ? -cmp : cmp;
+	}
+};
+
+static inline int _CompareRows(_SortKey **keys, int keyCount, int a, int b)
+{
+	for (int k = 0; k < keyCount; k++)
+	{
+		int cmp = keys[k]->Compare(a, b);
+		if (0 != cmp)
+		{
+			return cmp;
+		}
+	}
+	return 0;
+}
+
+/// Runs this short are insertion sorted before merging.
+#define COLUMNOPS_SORT_RUN 16
+
+void ColumnOps::Sort(const Vector<IColumn *>& keys, const Vector<bool>& descending, const RowBitmap *sel, Vector<int>& perm)
+{
+	perm.Clear();
+	if (0 == keys.Count())
+	{
+		throw new InvalidArgumentException("ColumnOps::Sort: no keys");
+	}
+	if (0 != descending.Count() && descending.Count() != keys.Count())
+	{
+		throw new InvalidArgumentException("ColumnOps::Sort: one descending flag is needed per key");
+	}
+
+	const int rows = keys.ElementAt(0)->Count();
+	for (int k = 1; k < keys.Count(); k++)
+	{
+		if (keys.ElementAt(k)->Count() != rows)
+		{
+			throw new InvalidArgumentException("ColumnOps::Sort: the keys have different row counts");
+		}
+	}
+	if (NULL == sel)
+	{
+		for (int row = 0; row < rows; row++)
+		{
+			perm.Add(row);
+		}
+	}
+	else
+	{
+		_CheckRows(keys.ElementAt(0), *sel);
+		sel->ToRows(perm);
+	}
+
+	const int keyCount = keys.Count();
+	Array<_SortKey *> sortKeys(keyCount);
+	try
+	{
+		for (int k = 0; k < keyCount; k++)
+		{
+			sortKeys.Data()[k] = new _SortKey(keys.ElementAt(k), 0 != descending.Count() && descending.ElementAt(k));
+		}
+
+		_SortKey **sk = sortKeys.Data();
+		const int count = perm.Count();
+		int *data = perm.Data();
+
+		for (int start = 0; start < count; start += COLUMNOPS_SORT_RUN)
+		{
+			const int end = start + COLUMNOPS_SORT_RUN < count ? start + COLUMNOPS_SORT_RUN : count;
+			for (int x = start + 1; x < end; x++)
+			{
+				const int row = data[x];
+				int y = x - 1;
+				while (y >= start && _CompareRows(sk, keyCount, data[y], row) > 0)
+				{
+					data[y + 1] = data[y];
+					y--;
+				}
+				data[y + 1] = row;
+			}
+		}
+
+		Array<int> scratch(count);
+		int *from = data;
+		int *to = scratch.Data();
+		for (int width = COLUMNOPS_SORT_RUN; width < count; width *= 2)
+		{
+			for (int left = 0; left < count; left += 2 * width)
+			{
+				const int mid = left + width < count ? left + width : count;
+				const int right = left + 2 * width < count ? left + 2 * width : count;
+				int a = left, b = mid, out = left;
+				while (a < mid && b < right)
+				{
+					// Ties take from the left run, which keeps the sort stable.
+					to[out++] = _CompareRows(sk, keyCount, from[b], from[a]) < 0 ? from[b++] : from[a++];
+				}
+				while (a < mid)
+				{
+					to[out++] = from[a++];
+				}
+				while (b < right)
+				{
+					to[out++] = from[b++];
+				}
+			}
+			int *swap = from;
+			from = to;
+			to = swap;
+		}
+		if (from != data)
+		{
+			memcpy(data, from, count * sizeof(int));
+		}
+	}
+	catch (...)
+	{
+		for (int k = 0; k < keyCount; k++)
+		{
+			if (NULL != sortKeys.Data()[k])
+			{
+				delete sortKeys.Data()[k];
+			}
+		}
+		throw;
+	}
+
+	for (int k = 0; k < keyCount; k++)
+	{
+		delete sortKeys.Data()[k];
+	}
+}
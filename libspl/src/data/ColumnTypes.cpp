@@ -70,6 +70,7 @@ IColumn *Int8Column::Clone() const
 {
 	Int8Column *col = new Int8Column(m_name.GetChars());
 	col->m_data = m_data;
+	col->CopyNulls(*this);
 	return col;
 }
 
@@ -95,8 +96,18 @@ void Int8Column::Append( void *data, int len )
 	Append( ((byte *)data)[0] );
 #endif
 }
-void Int8Column::Append( IColumn *col, const int row ) { Append(col->GetByte(row)); }
-void Int8Column::AppendNull() { Append(0); }
+void Int8Column::Append( IColumn *col, const int row ) { if (col->IsNull(row)) AppendNull(); else Append(col->GetByte(row)); }
+void Int8Column::AppendRows( IColumn *col )
+{
+	if ( col->Type() != Type() )
+	{
+		IColumn::AppendRows(col);
+		return;
+	}
+	AppendNulls(*col, m_data.Count());
+	m_data.AddRange(static_cast<Int8Column *>(col)->m_data);
+}
+void Int8Column::AppendNull() { NoteNull(m_data.Count()); m_data.Add(0); }
 
 int8 Int8Column::GetByte(const int row) { return m_data.ElementAt(row); }
 int16 Int8Column::GetInt16(const int row) { return (int16)m_data.ElementAt(row); }
@@ -132,6 +143,7 @@ IColumn *Int16Column::Clone() const
 {
 	Int16Column *col = new Int16Column(m_name.GetChars());
 	col->m_data = m_data;
+	col->CopyNulls(*this);
 	return col;
 }
 
@@ -157,8 +169,18 @@ void Int16Column::Append( void *data, int len )
 	Append( *(int16 *)&((byte *)data)[1] );
 #endif
 }
-void Int16Column::Append( IColumn *col, const int row ) { Append(col->GetInt16(row)); }
-void Int16Column::AppendNull() { Append(0); }
+void Int16Column::Append( IColumn *col, const int row ) { if (col->IsNull(row)) AppendNull(); else Append(col->GetInt16(row)); }
+void Int16Column::AppendRows( IColumn *col )
+{
+	if ( col->Type() != Type() )
+	{
+		IColumn::AppendRows(col);
+		return;
+	}
+	AppendNulls(*col, m_data.Count());
+	m_data.AddRange(static_cast<Int16Column *>(col)->m_data);
+}
+void Int16Column::AppendNull() { NoteNull(m_data.Count()); m_data.Add(0); }
 
 int8 Int16Column::GetByte(const int row) { return (int8)m_data.ElementAt(row); }
 int16 Int16Column::GetInt16(const int row) { return m_data.ElementAt(row); }
@@ -194,6 +216,7 @@ IColumn *Int32Column::Clone() const
 {
 	Int32Column *col = new Int32Column(m_name.GetChars());
 	col->m_data = m_data;
+	col->CopyNulls(*this);
 	return col;
 }
 
@@ -219,8 +242,18 @@ void Int32Column::Append( void *data, int len )
 	Append( *(int32 *)&((byte *)data)[3] );
 #endif
 }
-void Int32Column::Append( IColumn *col, const int row ) { Append(col->GetInt32(row)); }
-void Int32Column::AppendNull() { Append(0); }
+void Int32Column::Append( IColumn *col, const int row ) { if (col->IsNull(row)) AppendNull(); else Append(col->GetInt32(row)); }
+void Int32Column::AppendRows( IColumn *col )
+{
+	if ( col->Type() != Type() )
+	{
+		IColumn::AppendRows(col);
+		return;
+	}
+	AppendNulls(*col, m_data.Count());
+	m_data.AddRange(static_cast<Int32Column *>(col)->m_data);
+}
+void Int32Column::AppendNull() { NoteNull(m_data.Count()); m_data.Add(0); }
 
 int8 Int32Column::GetByte(const int row) { return (int8)m_data.ElementAt(row); }
 int16 Int32Column::GetInt16(const int row) { return (int16)m_data.ElementAt(row); }
@@ -256,6 +289,7 @@ IColumn *Int64Column::Clone() const
 {
 	Int64Column *col = new Int64Column(m_name.GetChars());
 	col->m_data = m_data;
+	col->CopyNulls(*this);
 	return col;
 }
 
@@ -281,8 +315,18 @@ void Int64Column::Append( void *data, int len )
 	Append( *(int32 *)&((byte *)data)[7] );
 #endif
 }
-void Int64Column::Append( IColumn *col, const int row ) { Append(col->GetInt64(row)); }
-void Int64Column::AppendNull() { Append(0); }
+void Int64Column::Append( IColumn *col, const int row ) { if (col->IsNull(row)) AppendNull(); else Append(col->GetInt64(row)); }
+void Int64Column::AppendRows( IColumn *col )
+{
+	if ( col->Type() != Type() )
+	{
+		IColumn::AppendRows(col);
+		return;
+	}
+	AppendNulls(*col, m_data.Count());
+	m_data.AddRange(static_cast<Int64Column *>(col)->m_data);
+}
+void Int64Column::AppendNull() { NoteNull(m_data.Count()); m_data.Add(0); }
 
 int8 Int64Column::GetByte(const int row) { return (int8)m_data.ElementAt(row); }
 int16 Int64Column::GetInt16(const int row) { return (int16)m_data.ElementAt(row); }
@@ -318,6 +362,7 @@ IColumn *Float32Column::Clone() const
 {
 	Float32Column *col = new Float32Column(m_name.GetChars());
 	col->m_data = m_data;
+	col->CopyNulls(*this);
 	return col;
 }
 
@@ -343,8 +388,18 @@ void Float32Column::Append( void *data, int len )
 	Append( *(float32 *)data );
 #endif
 }
-void Float32Column::Append( IColumn *col, const int row ) { Append(col->GetFloat32(row)); }
-void Float32Column::AppendNull() { Append(0); }
+void Float32Column::Append( IColumn *col, const int row ) { if (col->IsNull(row)) AppendNull(); else Append(col->GetFloat32(row)); }
+void Float32Column::AppendRows( IColumn *col )
+{
+	if ( col->Type() != Type() )
+	{
+		IColumn::AppendRows(col);
+		return;
+	}
+	AppendNulls(*col, m_data.Count());
+	m_data.AddRange(static_cast<Float32Column *>(col)->m_data);
+}
+void Float32Column::AppendNull() { NoteNull(m_data.Count()); m_data.Add(0); }
 
 int8 Float32Column::GetByte(const int row) { return (int8)m_data.ElementAt(row); }
 int16 Float32Column::GetInt16(const int row) { return (int16)m_data.ElementAt(row); }
@@ -381,6 +436,7 @@ IColumn *Float64Column::Clone() const
 {
 	Float64Column *col = new Float64Column(m_name.GetChars());
 	col->m_data = m_data;
+	col->CopyNulls(*this);
 	return col;
 }
 
@@ -407,8 +463,18 @@ void Float64Column::Append( void *data, int len )
 	Append( *(float64 *)data );
 #endif
 }
-void Float64Column::Append( IColumn *col, const int row ) { Append(col->GetFloat64(row)); }
-void Float64Column::AppendNull() { Append(0); }
+void Float64Column::Append( IColumn *col, const int row ) { if (col->IsNull(row)) AppendNull(); else Append(col->GetFloat64(row)); }
+void Float64Column::AppendRows( IColumn *col )
+{
+	if ( col->Type() != Type() )
+	{
+		IColumn::AppendRows(col);
+		return;
+	}
+	AppendNulls(*col, m_data.Count());
+	m_data.AddRange(static_cast<Float64Column *>(col)->m_data);
+}
+void Float64Column::AppendNull() { NoteNull(m_data.Count()); m_data.Add(0); }
 
 int8 Float64Column::GetByte(const int row) { return (int8)m_data.ElementAt(row); }
 int16 Float64Column::GetInt16(const int row) { return (int16)m_data.ElementAt(row); }
@@ -444,6 +510,7 @@ IColumn *DecimalColumn::Clone() const
 {
 	DecimalColumn *col = new DecimalColumn(m_name.GetChars(), m_maxlen);
 	col->m_data = m_data;
+	col->CopyNulls(*this);
 	return col;
 }
 
@@ -451,7 +518,7 @@ void DecimalColumn::Append( int8 i ) { throw new InvalidTypeConversionException(
 void DecimalColumn::Append( int16 i ) { throw new InvalidTypeConversionException(); }
 void DecimalColumn::Append( int32 i ) { throw new InvalidTypeConversionException(); }
 void DecimalColumn::Append( int64 i ) { throw new InvalidTypeConversionException(); }
-void DecimalColumn::Append( Decimal i ) { m_data.Add( i.RawData() ); }
+void DecimalColumn::Append( Decimal i ) { m_data.Add( i ); }
 void DecimalColumn::Append( float32 i ) { throw new InvalidTypeConversionException(); }
 void DecimalColumn::Append( float64 i ) { throw new InvalidTypeConversionException(); }
 void DecimalColumn::Append( bool i ) { throw new InvalidTypeConversionException(); }
@@ -463,8 +530,8 @@ void DecimalColumn::Append( void *data, int len )
 {
 	throw NotImplementedException("Decimal not yet supported");
 }
-void DecimalColumn::Append( IColumn *col, const int row ) { Append(col->GetDecimal(row)); }
-void DecimalColumn::AppendNull() { Append(0); }
+void DecimalColumn::Append( IColumn *col, const int row ) { if (col->IsNull(row)) AppendNull(); else Append(col->GetDecimal(row)); }
+void DecimalColumn::AppendNull() { NoteNull(m_data.Count()); m_data.Add(Decimal()); }
 
 int8 DecimalColumn::GetByte(const int row) { throw new InvalidTypeConversionException(); }
 int16 DecimalColumn::GetInt16(const int row) { throw new InvalidTypeConversionException(); }
@@ -500,6 +567,7 @@ IColumn *BitColumn::Clone() const
 {
 	BitColumn *col = new BitColumn(m_name.GetChars());
 	col->m_data = m_data;
+	col->CopyNulls(*this);
 	return col;
 }
 
@@ -535,8 +603,18 @@ void BitColumn::Append( void *data, int len )
 		throw Exception("Unsupported bit column length");
 	}
 }
-void BitColumn::Append( IColumn *col, const int row ) { Append(col->GetBit(row)); }
-void BitColumn::AppendNull() { Append(0); }
+void BitColumn::Append( IColumn *col, const int row ) { if (col->IsNull(row)) AppendNull(); else Append(col->GetBit(row)); }
+void BitColumn::AppendRows( IColumn *col )
+{
+	if ( col->Type() != Type() )
+	{
+		IColumn::AppendRows(col);
+		return;
+	}
+	AppendNulls(*col, m_data.Count());
+	m_data.AddRange(static_cast<BitColumn *>(col)->m_data);
+}
+void BitColumn::AppendNull() { NoteNull(m_data.Count()); m_data.Add(false); }
 
 int8 BitColumn::GetByte(const int row) { return (int8)m_data.ElementAt(row); }
 int16 BitColumn::GetInt16(const int row) { return (int16)m_data.ElementAt(row); }
@@ -572,6 +650,7 @@ IColumn *TimeStampColumn::Clone() const
 {
 	TimeStampColumn *col = new TimeStampColumn(m_name.GetChars());
 	col->m_data = m_data;
+	col->CopyNulls(*this);
 	return col;
 }
 
@@ -619,8 +698,8 @@ void TimeStampColumn::Append( void *data, int len )
 	throw NotImplementedException();
 #endif
 }
-void TimeStampColumn::Append( IColumn *col, const int row ) { Append(col->GetDateTime(row)); }
-void TimeStampColumn::AppendNull() { Append(0); }
+void TimeStampColumn::Append( IColumn *col, const int row ) { if (col->IsNull(row)) AppendNull(); else Append(col->GetDateTime(row)); }
+void TimeStampColumn::AppendNull() { NoteNull(m_data.Count()); m_data.Add(DateTime()); }
 
 int8 TimeStampColumn::GetByte(const int row) { throw new InvalidTypeConversionException(); }
 int16 TimeStampColumn::GetInt16(const int row) { throw new InvalidTypeConversionException(); }
@@ -656,6 +735,7 @@ IColumn *DateColumn::Clone() const
 {
 	DateColumn *col = new DateColumn(m_name.GetChars());
 	col->m_data = m_data;
+	col->CopyNulls(*this);
 	return col;
 }
 
@@ -668,15 +748,25 @@ void DateColumn::Append( float32 i ) { throw new InvalidTypeConversionException(
 void DateColumn::Append( float64 i ) { throw new InvalidTypeConversionException(); }
 void DateColumn::Append( bool i ) { throw new InvalidTypeConversionException(); }
 void DateColumn::Append( DateTime i ) { throw new InvalidTypeConversionException(); }
-void DateColumn::Append( Date i ) { m_data.Add( i ); }
+void DateColumn::Append( Date i ) { m_data.Add( i.ToRevInt() ); }
 void DateColumn::Append( const String& str ) { throw new InvalidTypeConversionException(); }
-void DateColumn::AppendParse( const char *data, const int len) { m_data.Add( Date::Parse(data) ); }
+void DateColumn::AppendParse( const char *data, const int len) { m_data.Add( Date::Parse(data).ToRevInt() ); }
 void DateColumn::Append( void *data, int len )
 {
 	throw NotImplementedException("This append is intended for MSSQL, which doesn't support a DATE type");
 }
-void DateColumn::Append( IColumn *col, const int row ) { Append(col->GetDate(row)); }
-void DateColumn::AppendNull() { Append(0); }
+void DateColumn::Append( IColumn *col, const int row ) { if (col->IsNull(row)) AppendNull(); else Append(col->GetDate(row)); }
+void DateColumn::AppendRows( IColumn *col )
+{
+	if ( col->Type() != Type() )
+	{
+		IColumn::AppendRows(col);
+		return;
+	}
+	AppendNulls(*col, m_data.Count());
+	m_data.AddRange(static_cast<DateColumn *>(col)->m_data);
+}
+void DateColumn::AppendNull() { NoteNull(m_data.Count()); m_data.Add(0); }
 
 int8 DateColumn::GetByte(const int row) { throw new InvalidTypeConversionException(); }
 int16 DateColumn::GetInt16(const int row) { throw new InvalidTypeConversionException(); }
@@ -687,11 +777,20 @@ float32 DateColumn::GetFloat32(const int row) { throw new InvalidTypeConversionE
 float64 DateColumn::GetFloat64(const int row) { throw new InvalidTypeConversionException(); }
 bool DateColumn::GetBit(const int row) { throw new InvalidTypeConversionException(); }
 DateTime DateColumn::GetTimeStamp(const int row) { throw new InvalidTypeConversionException(); }
-Date DateColumn::GetDate(const int row) { return m_data.ElementAt(row); }
+Date DateColumn::GetDate(const int row)
+{
+	int32 ymd = m_data.ElementAt(row);
+	if ( 0 == ymd )
+	{
+		// Null
+		return Date();
+	}
+	return Date(ymd / 10000, (ymd / 100) % 100, ymd % 100);
+}
 DateTime DateColumn::GetDateTime(const int row) { throw new InvalidTypeConversionException(); }
-StringPtr DateColumn::GetChar(const int row) { return m_data.ElementAt(row).ToString(); }
-StringPtr DateColumn::GetVarchar(const int row) { return m_data.ElementAt(row).ToString(); }
-Variant DateColumn::GetVariant(const int row) { return Variant(m_data.ElementAt(row)); }
+StringPtr DateColumn::GetChar(const int row) { return GetDate(row).ToString(); }
+StringPtr DateColumn::GetVarchar(const int row) { return GetDate(row).ToString(); }
+Variant DateColumn::GetVariant(const int row) { return Variant(GetDate(row)); }
 
 #if defined(DEBUG)
 void DateColumn::CheckMem() const { IColumn::CheckMem(); m_data.CheckMem(); }
@@ -712,6 +811,7 @@ IColumn *DateTimeColumn::Clone() const
 {
 	DateTimeColumn *col = new DateTimeColumn(m_name.GetChars());
 	col->m_data = m_data;
+	col->CopyNulls(*this);
 	return col;
 }
 
@@ -759,8 +859,8 @@ void DateTimeColumn::Append( void *data, int len )
 	throw NotImplementedException();
 #endif
 }
-void DateTimeColumn::Append( IColumn *col, const int row ) { Append(col->GetDateTime(row)); }
-void DateTimeColumn::AppendNull() { Append(0); }
+void DateTimeColumn::Append( IColumn *col, const int row ) { if (col->IsNull(row)) AppendNull(); else Append(col->GetDateTime(row)); }
+void DateTimeColumn::AppendNull() { NoteNull(m_data.Count()); m_data.Add(DateTime()); }
 
 int8 DateTimeColumn::GetByte(const int row) { throw new InvalidTypeConversionException(); }
 int16 DateTimeColumn::GetInt16(const int row) { throw new InvalidTypeConversionException(); }
@@ -796,6 +896,7 @@ IColumn *CharColumn::Clone() const
 {
 	CharColumn *col = new CharColumn(m_name.GetChars(), m_maxlen);
 	col->m_data = m_data;
+	col->CopyNulls(*this);
 	return col;
 }
 
@@ -819,13 +920,23 @@ void CharColumn::Append( const String& str )
 	strcpy(data.chars, str.GetChars());
 	m_data.Add(data);
 }
-void CharColumn::AppendParse( const char *data, const int len) { Append(String(data, len)); }
+void CharColumn::AppendParse( const char *data, const int len)
+{
+	struct chars255 chars;
+	if ( len >= 255 )
+	{
+		throw new IndexOutOfBoundsException();
+	}
+	memcpy(chars.chars, data, len);
+	chars.chars[len] = '\0';
+	m_data.Add(chars);
+}
 void CharColumn::Append( void *data, int len ) 
 {
 	Append( String((char *)data, len) );
 }
-void CharColumn::Append( IColumn *col, const int row ) { Append(col->GetChar(row)->CharAt(0)); }
-void CharColumn::AppendNull() { Append(0); }
+void CharColumn::Append( IColumn *col, const int row ) { if (col->IsNull(row)) AppendNull(); else Append(*col->GetChar(row)); }
+void CharColumn::AppendNull() { NoteNull(m_data.Count()); Append(String()); }
 
 int8 CharColumn::GetByte(const int row) { throw new InvalidTypeConversionException(); }
 int16 CharColumn::GetInt16(const int row) { throw new InvalidTypeConversionException(); }
@@ -857,7 +968,7 @@ VarCharColumn::~VarCharColumn()
 }
 
 int VarCharColumn::Count() const { return m_data.Count(); }
-int VarCharColumn::Type() const { return DbSqlType::SQL_TYPE_CHAR; }
+int VarCharColumn::Type() const { return DbSqlType::SQL_TYPE_VARCHAR; }
 
 IColumn *VarCharColumn::Clone() const 
 {
@@ -867,6 +978,7 @@ IColumn *VarCharColumn::Clone() const
 	{
 		col->m_data.Add( StringPtr(new String(*m_data.ElementAt(x))) );
 	}
+	col->CopyNulls(*this);
 	return col;
 }
 
@@ -881,13 +993,23 @@ void VarCharColumn::Append( bool i ) { throw new InvalidTypeConversionException(
 void VarCharColumn::Append( DateTime i ) { throw new InvalidTypeConversionException(); }
 void VarCharColumn::Append( Date i ) { throw new InvalidTypeConversionException(); }
 void VarCharColumn::Append( const String& str ) { m_data.Add(StringPtr(new String(str))); }
-void VarCharColumn::AppendParse( const char *data, const int len) { m_data.Add(StringPtr(new String(data))); }
+void VarCharColumn::AppendParse( const char *data, const int len) { m_data.Add(StringPtr(new String(data, len))); }
 void VarCharColumn::Append( void *data, int len ) 
 {
-	Append( String((char *)data, len) );
+	m_data.Add(StringPtr(new String((char *)data, len)));
+}
+void VarCharColumn::Append( IColumn *col, const int row ) { if (col->IsNull(row)) AppendNull(); else Append(*col->GetVarchar(row)); }
+void VarCharColumn::AppendRows( IColumn *col )
+{
+	if ( col->Type() != Type() )
+	{
+		IColumn::AppendRows(col);
+		return;
+	}
+	AppendNulls(*col, m_data.Count());
+	m_data.AddRange(static_cast<VarCharColumn *>(col)->m_data);
 }
-void VarCharColumn::Append( IColumn *col, const int row ) { Append(col->GetVarchar(row)->CharAt(0)); }
-void VarCharColumn::AppendNull() { Append(0); }
+void VarCharColumn::AppendNull() { NoteNull(m_data.Count()); Append(String()); }
 
 int8 VarCharColumn::GetByte(const int row) { throw new InvalidTypeConversionException(); }
 int16 VarCharColumn::GetInt16(const int row) { throw new InvalidTypeConversionException(); }
@@ -927,3 +1049,107 @@ void VarCharColumn::ValidateMem() const
 	}
 }
 #endif
+
+BlobColumn::BlobColumn(const String& name, const int maxlen) 
+: IColumn(name, maxlen)
+{ 
+}
+
+BlobColumn::~BlobColumn() 
+{ 
+}
+
+int BlobColumn::Count() const { return m_data.Count(); }
+int BlobColumn::Type() const { return DbSqlType::SQL_TYPE_BLOB; }
+
+IColumn *BlobColumn::Clone() const 
+{
+	BlobColumn *col = new BlobColumn(m_name.GetChars(), m_maxlen);
+	int count = m_data.Count();
+	for ( int x = 0; x < count; x++ )
+	{
+		RefCountPtr<Array<byte> > bytes = m_data.ElementAt(x);
+		col->m_data.Add( bytes.IsNull() ? bytes : RefCountPtr<Array<byte> >(new Array<byte>(*bytes)) );
+	}
+	col->CopyNulls(*this);
+	return col;
+}
+
+void BlobColumn::Append( int8 i ) { throw new InvalidTypeConversionException(); }
+void BlobColumn::Append( int16 i ) { throw new InvalidTypeConversionException(); }
+void BlobColumn::Append( int32 i ) { throw new InvalidTypeConversionException(); }
+void BlobColumn::Append( int64 i ) { throw new InvalidTypeConversionException(); }
+void BlobColumn::Append( Decimal i ) { throw new InvalidTypeConversionException(); }
+void BlobColumn::Append( float32 i ) { throw new InvalidTypeConversionException(); }
+void BlobColumn::Append( float64 i ) { throw new InvalidTypeConversionException(); }
+void BlobColumn::Append( bool i ) { throw new InvalidTypeConversionException(); }
+void BlobColumn::Append( DateTime i ) { throw new InvalidTypeConversionException(); }
+void BlobColumn::Append( Date i ) { throw new InvalidTypeConversionException(); }
+void BlobColumn::Append( const String& str ) { Append((void *)str.GetChars(), str.Length()); }
+void BlobColumn::AppendParse( const char *data, const int len) { Append((void *)data, len); }
+void BlobColumn::Append( void *data, int len ) 
+{
+	m_data.Add( RefCountPtr<Array<byte> >(new Array<byte>((const byte *)data, len)) );
+}
+void BlobColumn::Append( IColumn *col, const int row ) 
+{
+	if (col->IsNull(row))
+	{
+		AppendNull();
+	}
+	else if (DbSqlType::SQL_TYPE_BLOB == col->Type())
+	{
+		RefCountPtr<Array<byte> > bytes = static_cast<BlobColumn *>(col)->GetBlob(row);
+		Append((void *)bytes->Data(), bytes->Length());
+	}
+	else
+	{
+		Append(*col->GetVarchar(row));
+	}
+}
+void BlobColumn::AppendNull() { NoteNull(m_data.Count()); m_data.Add(RefCountPtr<Array<byte> >()); }
+
+int8 BlobColumn::GetByte(const int row) { throw new InvalidTypeConversionException(); }
+int16 BlobColumn::GetInt16(const int row) { throw new InvalidTypeConversionException(); }
+int32 BlobColumn::GetInt32(const int row) { throw new InvalidTypeConversionException(); }
+int64 BlobColumn::GetInt64(const int row) { throw new InvalidTypeConversionException(); }
+Decimal BlobColumn::GetDecimal(const int row) { throw new InvalidTypeConversionException(); }
+float32 BlobColumn::GetFloat32(const int row) { throw new InvalidTypeConversionException(); }
+float64 BlobColumn::GetFloat64(const int row) { throw new InvalidTypeConversionException(); }
+bool BlobColumn::GetBit(const int row) { throw new InvalidTypeConversionException(); }
+DateTime BlobColumn::GetTimeStamp(const int row) { throw new InvalidTypeConversionException(); }
+Date BlobColumn::GetDate(const int row) { throw new InvalidTypeConversionException(); }
+DateTime BlobColumn::GetDateTime(const int row) { throw new InvalidTypeConversionException(); }
+StringPtr BlobColumn::GetChar(const int row) { return GetVarchar(row); }
+StringPtr BlobColumn::GetVarchar(const int row) 
+{
+	RefCountPtr<Array<byte> > bytes = m_data.ElementAt(row);
+	if (bytes.IsNull())
+	{
+		return StringPtr(new String());
+	}
+	return String::Base64Encode(bytes);
+}
+Variant BlobColumn::GetVariant(const int row) { throw new InvalidTypeConversionException(); }
+
+#if defined(DEBUG)
+void BlobColumn::CheckMem() const
+{ 
+	IColumn::CheckMem(); 
+	m_data.CheckMem(); 
+	for ( int x = 0; x < m_data.Count(); x++ )
+	{
+		m_data.ElementAt(x).CheckMem();
+	}
+}
+
+void BlobColumn::ValidateMem() const
+{ 
+	IColumn::ValidateMem(); 
+	m_data.ValidateMem(); 
+	for ( int x = 0; x < m_data.Count(); x++ )
+	{
+		m_data.ElementAt(x).ValidateMem();
+	}
+}
+#endif
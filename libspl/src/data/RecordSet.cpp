@@ -20,23 +20,98 @@
 using namespace spl;
 
 IColumn::IColumn(const String& name, const int maxlen)
-: m_name(name), m_maxlen(maxlen), m_currow(-1)
+: m_currow(-1), m_nulls(NULL), m_nullCount(0), m_name(name), m_maxlen(maxlen)
 {
 }
 
 IColumn::~IColumn()
 {
+	if ( NULL != m_nulls )
+	{
+		delete m_nulls;
+	}
+}
+
+void IColumn::NoteNull(const int row)
+{
+	if ( NULL == m_nulls )
+	{
+		m_nulls = new Vector<uint32>((row >> 5) + 8);
+	}
+	while ( m_nulls->Count() <= (row >> 5) )
+	{
+		m_nulls->Add(0);
+	}
+	uint32& word = m_nulls->Data()[row >> 5];
+	if ( 0 == (word & (1U << (row & 31))) )
+	{
+		word |= 1U << (row & 31);
+		m_nullCount++;
+	}
+}
+
+void IColumn::CopyNulls(const IColumn& from)
+{
+	if ( NULL != m_nulls )
+	{
+		delete m_nulls;
+		m_nulls = NULL;
+	}
+	if ( NULL != from.m_nulls )
+	{
+		m_nulls = new Vector<uint32>(*from.m_nulls);
+	}
+	m_nullCount = from.m_nullCount;
+}
+
+void IColumn::AppendNulls(const IColumn& from, const int offset)
+{
+	if ( NULL == from.m_nulls )
+	{
+		return;
+	}
+	int words = from.m_nulls->Count();
+	for ( int w = 0; w < words; w++ )
+	{
+		uint32 bits = from.m_nulls->ElementAt(w);
+		for ( int b = 0; 0 != bits; b++, bits >>= 1 )
+		{
+			if ( 0 != (bits & 1) )
+			{
+				NoteNull(offset + (w << 5) + b);
+			}
+		}
+	}
+}
+
+void IColumn::AppendRows( IColumn *col )
+{
+	int count = col->Count();
+	for ( int row = 0; row < count; row++ )
+	{
+		Append(col, row);
+	}
 }
 
 #if defined(DEBUG)
 void IColumn::CheckMem() const
 {
 	m_name.CheckMem();
+	if ( NULL != m_nulls )
+	{
+		DEBUG_NOTE_MEM( m_nulls );
+		m_nulls->CheckMem();
+	}
 }
 
 void IColumn::ValidateMem() const
 {
 	m_name.ValidateMem();
+	if ( NULL != m_nulls )
+	{
+		ASSERT_MEM( m_nulls, sizeof(Vector<uint32>) );
+		m_nulls->ValidateMem();
+	}
 }
 #endif
 
@@ -127,6 +202,19 @@ void RecordSet::SetColumns( RecordSet& rs )
 	}
 }
 
+void RecordSet::AppendRows( RecordSet& rs )
+{
+	int count = m_columns.Count();
+	if ( rs.ColumnCount() != count )
+	{
+		throw new InvalidArgumentException("Record sets have different columns");
+	}
+	for ( int x = 0; x < count; x++ )
+	{
+		m_columns.ElementAt(x)->AppendRows( rs.m_columns.ElementAt(x) );
+	}
+}
+
 void RecordSet::DefineColumn(const String& name, int type, int fieldmaxlen)
 {
 	IColumn *col;
@@ -172,7 +260,7 @@ void RecordSet::DefineColumn(const String& name, int type, int fieldmaxlen)
 		col = new VarCharColumn(name, fieldmaxlen);
 		break;
 	case DbSqlType::SQL_TYPE_BLOB:
-		throw new NotImplementedException();
+		col = new BlobColumn(name, fieldmaxlen);
 		break;
 	default:
 		throw new InvalidArgumentException("Unknown SQL type");
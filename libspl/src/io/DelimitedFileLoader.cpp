@@ -0,0 +1,658 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <string.h>
+
+#include <spl/Environment.h>
+#include <spl/Exception.h>
+#include <spl/Int32.h>
+#include <spl/io/DelimitedFileLoader.h>
+#include <spl/threading/ThreadStartDelegate.h>
+
+using namespace spl;
+
+/* Byte-parallel matching on 64-bit words (SWAR), so runs of ordinary bytes
+   are skipped eight at a time without depending on SIMD intrinsics. */
+#define SWAR_ONES 0x0101010101010101ULL
+#define SWAR_LOW7 0x7F7F7F7F7F7F7F7FULL
+#define SWAR_HIGH 0x8080808080808080ULL
+
+/** @brief Sets the high bit of each byte of word that equals the byte repeated in pattern. */
+static inline uint64 _SwarMatch(uint64 word, uint64 pattern)
+{
+	uint64 x = word ^ pattern;
+	return ~(((x & SWAR_LOW7) + SWAR_LOW7) | x) & SWAR_HIGH;
+}
+
+static inline int _SwarCount(uint64 match)
+{
+	return (int)(((match >> 7) * SWAR_ONES) >> 56);
+}
+
+static inline uint64 _SwarLoad(const byte *cp)
+{
+	uint64 word;
+	memcpy(&word, cp, sizeof(word));
+	return word;
+}
+
+/** @brief One thread's share of a batch: it first counts the quotes in a
+ *	piece of the file and finds its first newline outside and inside quotes,
+ *	then parses the records from a boundary into its own record set.
+ */
+class DelimitedFileChunk
+{
+private:
+	// forbid copy constructor
+	inline DelimitedFileChunk(const DelimitedFileChunk& dfc) {}
+	inline void operator =(const DelimitedFileChunk& dfc) {}
+
+	const byte *m_data;
+	int64 m_length;
+	char m_delim;
+	uint64 m_delimPattern;
+
+	Vector<IColumn *> m_cols;
+	Vector<bool> m_textCols;
+
+	char *m_field;
+	int m_fieldLen;
+	int m_fieldSize;
+	bool m_quoted;
+
+	void GrowField(int size);
+
+	inline void FieldAppend(const byte *cp, int64 len)
+	{
+		if (m_fieldLen + len + 1 > m_fieldSize)
+		{
+			GrowField((int)(m_fieldLen + len + 1));
+		}
+		memcpy(&m_field[m_fieldLen], cp, (size_t)len);
+		m_fieldLen += (int)len;
+	}
+
+	inline bool IsSpecial(byte ch) const
+	{
+		return m_delim == (char)ch || '"' == ch || '\n' == ch || '\r' == ch;
+	}
+
+	void Scan();
+	void Parse();
+	void RunScan();
+	void RunParse();
+
+public:
+	// Scan results.
+	int64 m_start;
+	int64 m_end;
+	int64 m_quotes;
+	int64 m_nlEven;			//< Offset of the first newline after an even number of the piece's quotes, or -1.
+	int64 m_nlOdd;			//< Offset of the first newline after an odd number, or -1.
+
+	// Parse input and results.
+	int64 m_limit;			//< Parse the records that start before limit.
+	int64 m_stop;			//< The offset after the last record.
+	RecordSet *m_rs;
+	Exception *m_error;
+
+	// A Thread can't be restarted reliably, so each phase has its own.
+	ThreadStartDelegate<DelimitedFileChunk> m_scanThread;
+	ThreadStartDelegate<DelimitedFileChunk> m_parseThread;
+
+	DelimitedFileChunk(const MappedFile& file, char delim);
+	~DelimitedFileChunk();
+
+	/** @brief Makes the record set to parse into, with rs's columns. */
+	void SetColumns(RecordSet& rs);
+
+	/** @brief Leaves the field at pos in m_field and returns the offset after its terminator. */
+	int64 NextField(int64 pos, bool& endOfRecord);
+
+	inline int64 SkipBlankLines(int64 pos) const
+	{
+		while (pos < m_length && ('\n' == m_data[pos] || '\r' == m_data[pos]))
+		{
+			pos++;
+		}
+		return pos;
+	}
+
+	inline const char *Field() { m_field[m_fieldLen] = '\0'; return m_field; }
+	inline int FieldLength() const { return m_fieldLen; }
+
+	/** @brief Scans or parses on a new thread, or on this one if thread is false. */
+	void StartScan(bool thread);
+	void StartParse(bool thread);
+	void Join();
+};
+
+DelimitedFileChunk::DelimitedFileChunk(const MappedFile& file, char delim)
+: m_data(file.Data()), m_length(file.Length()), m_delim(delim), m_delimPattern(SWAR_ONES * (byte)delim),
+  m_cols(), m_textCols(), m_field(NULL), m_fieldLen(0), m_fieldSize(0), m_quoted(false),
+  m_start(0), m_end(0), m_quotes(0), m_nlEven(-1), m_nlOdd(-1), m_limit(0), m_stop(0), m_rs(NULL), m_error(NULL), m_scanThread(), m_parseThread()
+{
+	GrowField(256);
+}
+
+DelimitedFileChunk::~DelimitedFileChunk()
+{
+	delete[] m_field;
+	if (NULL != m_rs)
+	{
+		delete m_rs;
+	}
+	if (NULL != m_error)
+	{
+		delete m_error;
+	}
+}
+
+void DelimitedFileChunk::GrowField(int size)
+{
+	if (size < m_fieldSize * 2)
+	{
+		size = m_fieldSize * 2;
+	}
+	char *field = new char[size];
+	if (m_fieldLen > 0)
+	{
+		memcpy(field, m_field, m_fieldLen);
+	}
+	delete[] m_field;
+	m_field = field;
+	m_fieldSize = size;
+}
+
+void DelimitedFileChunk::SetColumns(RecordSet& rs)
+{
+	m_rs = new RecordSet();
+	rs.SetColumns(*m_rs);
+
+	int count = m_rs->ColumnCount();
+	for (int x = 0; x < count; x++)
+	{
+		IColumn *col = m_rs->GetColumn(x);
+		m_cols.Add(col);
+		m_textCols.Add(DbSqlType::SQL_TYPE_CHAR == col->Type() || DbSqlType::SQL_TYPE_VARCHAR == col->Type());
+	}
+}
+
+void DelimitedFileChunk::Scan()
+{
+	const uint64 quotePattern = SWAR_ONES * (byte)'"';
+	const uint64 nlPattern = SWAR_ONES * (byte)'\n';
+	const byte *cp = &m_data[m_start];
+	const byte *end = &m_data[m_end];
+	int64 quotes = 0;
+
+	m_nlEven = m_nlOdd = -1;
+
+	while (cp < end)
+	{
+		if (m_nlEven >= 0 && m_nlOdd >= 0)
+		{
+			// Only the quote count is left.
+			for (; cp + 8 <= end; cp += 8)
+			{
+				quotes += _SwarCount(_SwarMatch(_SwarLoad(cp), quotePattern));
+			}
+			for (; cp < end; cp++)
+			{
+				quotes += '"' == *cp ? 1 : 0;
+			}
+			break;
+		}
+		if (cp + 8 <= end)
+		{
+			uint64 word = _SwarLoad(cp);
+			if (0 == _SwarMatch(word, nlPattern))
+			{
+				quotes += _SwarCount(_SwarMatch(word, quotePattern));
+				cp += 8;
+				continue;
+			}
+		}
+
+		// A word with a newline in it, or the tail.
+		const byte *stop = cp + 8 < end ? cp + 8 : end;
+		for (; cp < stop; cp++)
+		{
+			if ('"' == *cp)
+			{
+				quotes++;
+			}
+			else if ('\n' == *cp)
+			{
+				int64& nl = (quotes & 1) ? m_nlOdd : m_nlEven;
+				if (nl < 0)
+				{
+					nl = cp - m_data;
+				}
+			}
+		}
+	}
+	m_quotes = quotes;
+}
+
+int64 DelimitedFileChunk::NextField(int64 pos, bool& endOfRecord)
+{
+	const uint64 quotePattern = SWAR_ONES * (byte)'"';
+	const uint64 nlPattern = SWAR_ONES * (byte)'\n';
+	const uint64 crPattern = SWAR_ONES * (byte)'\r';
+	int64 start = pos;
+
+	m_fieldLen = 0;
+	m_quoted = false;
+
+	while (true)
+	{
+		// Ordinary bytes up to the next delimiter, quote or line end.
+		for (; pos + 8 <= m_length; pos += 8)
+		{
+			uint64 word = _SwarLoad(&m_data[pos]);
+			if (0 != (_SwarMatch(word, m_delimPattern) | _SwarMatch(word, quotePattern) | _SwarMatch(word, nlPattern) | _SwarMatch(word, crPattern)))
+			{
+				break;
+			}
+		}
+		while (pos < m_length && !IsSpecial(m_data[pos]))
+		{
+			pos++;
+		}
+		FieldAppend(&m_data[start], pos - start);
+
+		if (pos >= m_length)
+		{
+			endOfRecord = true;
+			return pos;
+		}
+
+		byte ch = m_data[pos++];
+		if ('"' != ch)
+		{
+			endOfRecord = m_delim != (char)ch;
+			if ('\r' == ch && pos < m_length && '\n' == m_data[pos])
+			{
+				pos++;
+			}
+			return pos;
+		}
+
+		// Quoted bytes up to the closing quote; "" is a quote.
+		m_quoted = true;
+		while (true)
+		{
+			const byte *quote = (const byte *)memchr(&m_data[pos], '"', (size_t)(m_length - pos));
+			if (NULL == quote)
+			{
+				// Unterminated, so the rest of the file is the field.
+				FieldAppend(&m_data[pos], m_length - pos);
+				endOfRecord = true;
+				return m_length;
+			}
+			int64 at = quote - m_data;
+			FieldAppend(&m_data[pos], at - pos);
+			pos = at + 1;
+			if (pos < m_length && '"' == m_data[pos])
+			{
+				FieldAppend(quote, 1);
+				pos++;
+				continue;
+			}
+			break;
+		}
+		start = pos;
+	}
+}
+
+void DelimitedFileChunk::Parse()
+{
+	int count = m_cols.Count();
+	int64 pos = m_start;
+
+	while ((pos = SkipBlankLines(pos)) < m_limit && pos < m_length)
+	{
+		bool endOfRecord = false;
+		int col = 0;
+
+		while (!endOfRecord)
+		{
+			pos = NextField(pos, endOfRecord);
+			if (col < count)
+			{
+				IColumn *column = m_cols.ElementAt(col);
+				if (0 == m_fieldLen && !(m_quoted && m_textCols.ElementAt(col)))
+				{
+					column->AppendNull();
+				}
+				else
+				{
+					column->AppendParse(Field(), m_fieldLen);
+				}
+			}
+			col++;
+		}
+		for (; col < count; col++)
+		{
+			m_cols.ElementAt(col)->AppendNull();
+		}
+	}
+	m_stop = pos;
+}
+
+void DelimitedFileChunk::RunScan()
+{
+	try
+	{
+		Scan();
+	}
+	catch (Exception *ex)
+	{
+		m_error = ex;
+	}
+}
+
+void DelimitedFileChunk::RunParse()
+{
+	try
+	{
+		Parse();
+	}
+	catch (Exception *ex)
+	{
+		m_error = ex;
+	}
+}
+
+void DelimitedFileChunk::StartScan(bool thread)
+{
+	if (thread)
+	{
+		m_scanThread.Set(this, &DelimitedFileChunk::RunScan);
+		m_scanThread.Start();
+	}
+	else
+	{
+		RunScan();
+	}
+}
+
+void DelimitedFileChunk::StartParse(bool thread)
+{
+	if (thread)
+	{
+		m_parseThread.Set(this, &DelimitedFileChunk::RunParse);
+		m_parseThread.Start();
+	}
+	else
+	{
+		RunParse();
+	}
+}
+
+void DelimitedFileChunk::Join()
+{
+	// Event::Notify() isn't sticky, so Thread::Join() can miss a thread that
+	// exits just before the wait starts.
+	while (m_scanThread.IsRunning() || m_parseThread.IsRunning())
+	{
+		Thread::YYield();
+	}
+}
+
+static void _JoinChunks(Vector<DelimitedFileChunk *>& chunks)
+{
+	int count = chunks.Count();
+	for (int x = 0; x < count; x++)
+	{
+		chunks.ElementAt(x)->Join();
+	}
+}
+
+/** @brief Rethrows the first chunk's error. */
+static void _CheckChunks(Vector<DelimitedFileChunk *>& chunks)
+{
+	int count = chunks.Count();
+	for (int x = 0; x < count; x++)
+	{
+		DelimitedFileChunk *chunk = chunks.ElementAt(x);
+		if (NULL != chunk->m_error)
+		{
+			Exception *ex = chunk->m_error;
+			chunk->m_error = NULL;
+			throw ex;
+		}
+	}
+}
+
+static void _DeleteChunks(Vector<DelimitedFileChunk *>& chunks)
+{
+	int count = chunks.Count();
+	for (int x = 0; x < count; x++)
+	{
+		delete chunks.ElementAt(x);
+	}
+	chunks.Clear();
+}
+
+DelimitedFileLoader::DelimitedFileLoader(const String& filename, char coldelim)
+: m_file(new MappedFile(filename)), m_coldelim(coldelim), m_hasHeader(false), m_threadCount(Environment::ProcessorCount()), m_chunkSize(4 * 1024 * 1024), m_columns()
+{
+	if (m_threadCount < 1)
+	{
+		m_threadCount = 1;
+	}
+}
+
+DelimitedFileLoader::~DelimitedFileLoader()
+{
+}
+
+void DelimitedFileLoader::DefineColumn(const String& name, int type, int fieldmaxlen)
+{
+	m_columns.DefineColumn(name, type, fieldmaxlen);
+}
+
+int64 DelimitedFileLoader::ReadHeader()
+{
+	DelimitedFileChunk chunk(*m_file, m_coldelim);
+	int64 pos = chunk.SkipBlankLines(0);
+	bool define = 0 == m_columns.ColumnCount();
+	bool endOfRecord = !m_hasHeader;
+
+	while (!endOfRecord)
+	{
+		pos = chunk.NextField(pos, endOfRecord);
+		if (define)
+		{
+			m_columns.DefineColumn(chunk.Field(), DbSqlType::SQL_TYPE_VARCHAR, 0);
+		}
+	}
+
+	if (define && !m_hasHeader && pos < m_file->Length())
+	{
+		// Count the first record's fields.
+		int64 first = pos;
+		int count = 0;
+		for (endOfRecord = false; !endOfRecord; count++)
+		{
+			first = chunk.NextField(first, endOfRecord);
+		}
+		for (int x = 0; x < count; x++)
+		{
+			m_columns.DefineColumn(*Int32::ToString(x), DbSqlType::SQL_TYPE_VARCHAR, 0);
+		}
+	}
+	return pos;
+}
+
+int64 DelimitedFileLoader::ParseBatch(int64 pos, Vector<RecordSet *>& batch)
+{
+	int64 length = m_file->Length();
+	int64 remaining = length - pos;
+	int64 needed = (remaining + m_chunkSize - 1) / m_chunkSize;
+	int pieces = needed > m_threadCount ? m_threadCount : (needed < 1 ? 1 : (int)needed);
+	int64 batchEnd = pos + (int64)pieces * m_chunkSize;
+
+	m_file->WillNeed(pos, batchEnd - pos);
+
+	Vector<DelimitedFileChunk *> chunks;
+	try
+	{
+		// Count the quotes in each piece, so the parity before each piece is known.
+		for (int x = 0; x < pieces; x++)
+		{
+			DelimitedFileChunk *chunk = new DelimitedFileChunk(*m_file, m_coldelim);
+			chunks.Add(chunk);
+			chunk->m_start = pos + (int64)x * m_chunkSize;
+			chunk->m_end = chunk->m_start + m_chunkSize > length ? length : chunk->m_start + m_chunkSize;
+		}
+		if (pieces > 1)
+		{
+			for (int x = 1; x < pieces; x++)
+			{
+				chunks.ElementAt(x)->StartScan(true);
+			}
+			chunks.ElementAt(0)->StartScan(false);
+			_JoinChunks(chunks);
+			_CheckChunks(chunks);
+		}
+
+		// A piece starts a chunk at its first newline outside quotes; a piece
+		// without one is parsed with the chunk before it.
+		Vector<int64> starts;
+		starts.Add(pos);
+		int64 quotes = chunks.ElementAt(0)->m_quotes;
+		for (int x = 1; x < pieces; x++)
+		{
+			DelimitedFileChunk *chunk = chunks.ElementAt(x);
+			int64 nl = (quotes & 1) ? chunk->m_nlOdd : chunk->m_nlEven;
+			if (nl >= 0 && nl + 1 < length)
+			{
+				starts.Add(nl + 1);
+			}
+			quotes += chunk->m_quotes;
+		}
+
+		int count = starts.Count();
+		for (int x = 0; x < count; x++)
+		{
+			DelimitedFileChunk *chunk = chunks.ElementAt(x);
+			chunk->m_start = starts.ElementAt(x);
+			chunk->m_limit = x + 1 < count ? starts.ElementAt(x + 1) : batchEnd;
+			chunk->SetColumns(m_columns);
+		}
+		for (int x = 1; x < count; x++)
+		{
+			chunks.ElementAt(x)->StartParse(true);
+		}
+		chunks.ElementAt(0)->StartParse(false);
+		_JoinChunks(chunks);
+		_CheckChunks(chunks);
+
+		for (int x = 0; x < count; x++)
+		{
+			DelimitedFileChunk *chunk = chunks.ElementAt(x);
+			batch.Add(chunk->m_rs);
+			chunk->m_rs = NULL;
+		}
+		pos = chunks.ElementAt(count - 1)->m_stop;
+	}
+	catch (Exception *ex)
+	{
+		_JoinChunks(chunks);
+		_DeleteChunks(chunks);
+		throw ex;
+	}
+	_DeleteChunks(chunks);
+	return pos;
+}
+
+RecordSetPtr DelimitedFileLoader::Load()
+{
+	RecordSetPtr rs(new RecordSet());
+	Vector<RecordSet *> batch;
+	int64 pos = ReadHeader();
+	int64 length = m_file->Length();
+
+	m_columns.SetColumns(*rs);
+
+	while (pos < length)
+	{
+		pos = ParseBatch(pos, batch);
+
+		int count = batch.Count();
+		for (int x = 0; x < count; x++)
+		{
+			RecordSet *chunk = batch.ElementAt(x);
+			rs->AppendRows(*chunk);
+			delete chunk;
+		}
+		batch.Clear();
+	}
+	return rs;
+}
+
+void DelimitedFileLoader::Load(DelimitedFileBatchDelegatePtr onBatch)
+{
+	Vector<RecordSet *> batch;
+	int64 pos = ReadHeader();
+	int64 length = m_file->Length();
+
+	while (pos < length)
+	{
+		int64 start = pos;
+		pos = ParseBatch(pos, batch);
+
+		int count = batch.Count();
+		int x = 0;
+		try
+		{
+			for (; x < count; x++)
+			{
+				onBatch->Call(*batch.ElementAt(x));
+				delete batch.ElementAt(x);
+			}
+		}
+		catch (Exception *ex)
+		{
+			for (; x < count; x++)
+			{
+				delete batch.ElementAt(x);
+			}
+			throw ex;
+		}
+		batch.Clear();
+
+		// Parsed pages are only read again by a later map of the file.
+		m_file->DontNeed(start, pos - start);
+	}
+}
+
+#if defined(DEBUG)
+void DelimitedFileLoader::CheckMem() const
+{
+	m_file.CheckMem();
+	m_columns.CheckMem();
+}
+
+void DelimitedFileLoader::ValidateMem() const
+{
+	m_file.ValidateMem();
+	m_columns.ValidateMem();
+}
+#endif
@@ -14,15 +14,89 @@
  *   You should have received a copy of the GNU General Public License
  *   along with Syslog X.  If not, see <http://www.gnu.org/licenses/>.
  */
+#if defined(_WIN32) || defined(_WIN64)
+#include <spl/configwin32.h>
+#else
+#include <spl/autoconf/config.h>
+#endif
+
+#ifdef HAVE_ERRNO_H
+#include <errno.h>
+#endif
+#ifdef HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+#ifdef HAVE_SYS_TIME_H
+#include <sys/time.h>
+#endif
+#ifdef HAVE_IO_H
+#include <io.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+
+#include <spl/Environment.h>
+#include <spl/Exception.h>
 #include <spl/io/File.h>
 #include <spl/io/log/Log.h>
 #include <spl/io/log/FileAppendService.h>
 
 using namespace spl;
 
-FileAppendService::FileAppendService(const String& fileName)
-: m_fileName(fileName), m_running(false), m_thread(), m_q()
-{	
+#ifdef _WINDOWS
+static const char *_newLine = "\r\n";
+#elif _MACOSX
+static const char *_newLine = "\r";
+#else
+static const char *_newLine = "\n";
+#endif
+
+static int64 _NowMs()
+{
+#ifdef _WINDOWS
+	return (int64)GetTickCount();
+#else
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return (int64)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+#endif
+}
+
+FileAppendService::FileAppendService(const String& fileName, int maxQueued)
+:	m_running(true),
+	m_fileName(fileName),
+	m_thread(),
+	m_ring(maxQueued, RingQueue<String>::RING_DROP),
+	m_fd(-1),
+	m_buf(FILE_APPEND_FLUSH_BYTES),
+	m_bufLen(0),
+	m_bufLines(0),
+	m_fileBytes(0),
+	m_fileOpened(0),
+	m_lastFlush(0),
+	m_now(0),
+	m_flushBytes(FILE_APPEND_FLUSH_BYTES),
+	m_flushMs(FILE_APPEND_FLUSH_MS),
+	m_fsync(FSYNC_ON_ROTATE),
+	m_rotateBytes(0),
+	m_rotateSeconds(0),
+	m_rotateKeep(5),
+	m_written(),
+	m_dropped(),
+	m_bytesWritten(0),
+	m_flushes(0),
+	m_rotations(0)
+{
 	m_thread = RefCountPtr<ThreadStartDelegate<FileAppendService> >(new ThreadStartDelegate<FileAppendService>(this, &FileAppendService::Run));
 	m_thread->Start();
 }
@@ -35,57 +109,317 @@ FileAppendService::~FileAppendService()
 void FileAppendService::Stop()
 {
 	m_running = false;
+
+	if (m_thread.IsNull())
+	{
+		return;
+	}
+
+	while (m_thread->IsRunning())
+	{
+		m_ring.Wake();
+		Thread::YYield();
+	}
+
+	// Lines put while the writer was finishing up missed the file.
+	String line;
+	while (m_ring.TryGet(line))
+	{
+		m_dropped++;
+	}
 }
 
 void FileAppendService::WriteLine(const String& line)
 {
-	m_q.Put(line);
+	if (!m_running)
+	{
+		m_dropped++;
+		return;
+	}
+	m_ring.Put(line);
 }
 
 void FileAppendService::Run()
 {
-	if (m_running)
-	{
-		throw new Exception("File append service is already running");
-	}
-	
-	m_running = true;
-	
-	while (m_running)
+	String line;
+
+	m_lastFlush = m_now = _NowMs();
+
+	while (true)
 	{
-		String line = m_q.Get();
-		TextWriterPtr writer;
+		// Read before draining, so every line queued before Stop is written.
+		bool stopping = !m_running;
+		int waitMs = m_flushMs > 0 ? m_flushMs : FILE_APPEND_FLUSH_MS;
+		if (m_bufLen > 0)
+		{
+			int64 due = m_lastFlush + waitMs - m_now;
+			waitMs = due < 1 ? 1 : (int)due;
+		}
+
+		bool got = stopping ? m_ring.TryGet(line) : m_ring.Get(line, waitMs);
+		m_now = _NowMs();
+
 		try
 		{
-			writer = File::AppendText(m_fileName);
+			if (m_bufLen == 0 && m_buf.Length() < m_flushBytes)
+			{
+				m_buf = Array<byte>(m_flushBytes);
+			}
+			while (got)
+			{
+				Append(line);
+				got = m_ring.TryGet(line);
+			}
+			if (m_bufLen > 0 && (stopping || m_now - m_lastFlush >= m_flushMs))
+			{
+				Flush();
+			}
 		}
 		catch (Exception *ex)
 		{
+			// Append and Flush have counted the lines they dropped.
 			Log::SWrite(ex);
-			continue;
+			delete ex;
 		}
-		try
+
+		if (stopping && m_ring.IsEmpty())
 		{
-			writer->WriteLine(line);
+			break;
 		}
-		catch (Exception *ex)
+	}
+
+	try
+	{
+		Flush();
+		if (m_fsync != FSYNC_NEVER)
 		{
-			Log::SWrite(ex);
+			Sync();
+		}
+	}
+	catch (Exception *ex)
+	{
+		Log::SWrite(ex);
+		delete ex;
+	}
+	CloseFile();
+}
+
+void FileAppendService::OpenFile()
+{
+	ASSERT(m_fd < 0);
+
+#ifdef _WINDOWS
+	m_fd = _open(m_fileName.GetChars(), _O_WRONLY | _O_APPEND | _O_CREAT | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+	m_fd = open(m_fileName.GetChars(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+#endif
+	if (m_fd < 0)
+	{
+		throw new IOException(Environment::LastErrorMessage());
+	}
+
+	struct stat st;
+	m_fileBytes = (0 == fstat(m_fd, &st)) ? (int64)st.st_size : 0;
+	m_fileOpened = m_now;
+}
+
+void FileAppendService::CloseFile()
+{
+	if (m_fd >= 0)
+	{
+#ifdef _WINDOWS
+		_close(m_fd);
+#else
+		close(m_fd);
+#endif
+		m_fd = -1;
+	}
+}
+
+bool FileAppendService::RotateDue(int len) const
+{
+	if (m_fd < 0 || 0 == m_fileBytes + m_bufLen)
+	{
+		return false;
+	}
+	if (m_rotateBytes > 0 && m_fileBytes + len > m_rotateBytes)
+	{
+		return true;
+	}
+	return m_rotateSeconds > 0 && m_now - m_fileOpened >= (int64)m_rotateSeconds * 1000;
+}
+
+void FileAppendService::Append(const String& line)
+{
+	int nllen = (int)strlen(_newLine);
+	int len = line.Length() + nllen;
+	bool direct = false;
+
+	try
+	{
+		if (m_fd < 0)
+		{
+			OpenFile();
+		}
+		if (RotateDue(len))
+		{
+			Rotate();
+		}
+		if (m_bufLen + len > m_buf.Length())
+		{
+			Flush();
+		}
+		direct = len > m_buf.Length();
+		if (direct)
+		{
+			WriteFile((const byte *)line.GetChars(), line.Length());
+			WriteFile((const byte *)_newLine, nllen);
+		}
+	}
+	catch (Exception *ex)
+	{
+		// The line isn't in the buffer, so Flush won't count it.
+		m_dropped++;
+		throw ex;
+	}
+
+	if (direct)
+	{
+		m_written++;
+		m_bytesWritten += len;
+	}
+	else
+	{
+		memcpy(&m_buf.Data()[m_bufLen], line.GetChars(), line.Length());
+		memcpy(&m_buf.Data()[m_bufLen + line.Length()], _newLine, nllen);
+		m_bufLen += len;
+		m_bufLines++;
+	}
+	m_fileBytes += len;
+
+	if (m_bufLen >= m_flushBytes)
+	{
+		// If this fails Flush counts the line with the rest of the buffer.
+		Flush();
+	}
+}
+
+void FileAppendService::WriteFile(const byte *data, int len)
+{
+	while (len > 0)
+	{
+#ifdef _WINDOWS
+		int count = _write(m_fd, data, len);
+#else
+		int count = (int)write(m_fd, data, len);
+#endif
+		if (count < 0)
+		{
+			if (EINTR == errno)
+			{
+				continue;
+			}
+			throw new IOException(Environment::LastErrorMessage());
 		}
-		writer->Close();
+		data += count;
+		len -= count;
 	}
 }
 
-#if defined(_DEBUG)
+void FileAppendService::Flush()
+{
+	if (0 == m_bufLen)
+	{
+		return;
+	}
+
+	int lines = m_bufLines;
+	int len = m_bufLen;
+	m_bufLen = 0;
+	m_bufLines = 0;
+
+	try
+	{
+		WriteFile(m_buf.Data(), len);
+	}
+	catch (Exception *ex)
+	{
+		m_dropped += lines;
+		throw ex;
+	}
+	m_written += lines;
+	m_bytesWritten += len;
+	m_flushes++;
+	m_lastFlush = m_now;
+
+	if (FSYNC_ON_FLUSH == m_fsync)
+	{
+		Sync();
+	}
+}
+
+void FileAppendService::Sync()
+{
+	if (m_fd < 0)
+	{
+		return;
+	}
+#if defined(_WINDOWS)
+	_commit(m_fd);
+#elif defined(HAVE_FSYNC)
+	fsync(m_fd);
+#endif
+}
+
+void FileAppendService::Rotate()
+{
+	Flush();
+	if (FSYNC_ON_ROTATE == m_fsync)
+	{
+		Sync();
+	}
+	CloseFile();
+
+	if (m_rotateKeep <= 0)
+	{
+		File::Delete(m_fileName);
+	}
+	else
+	{
+		StringPtr oldest = String::Format("%s.%d", m_fileName.GetChars(), m_rotateKeep);
+		if (File::Exists(*oldest))
+		{
+			File::Delete(*oldest);
+		}
+		for (int x = m_rotateKeep - 1; x > 0; x--)
+		{
+			StringPtr from = String::Format("%s.%d", m_fileName.GetChars(), x);
+			if (File::Exists(*from))
+			{
+				File::Rename(*from, *String::Format("%s.%d", m_fileName.GetChars(), x + 1));
+			}
+		}
+		File::Rename(m_fileName, *String::Format("%s.1", m_fileName.GetChars()));
+	}
+
+	m_rotations++;
+	OpenFile();
+}
+
+#if defined(DEBUG)
 void FileAppendService::CheckMem() const
 {
 	m_fileName.CheckMem();
-	m_q.CheckMem();
+	m_thread.CheckMem();
+	m_ring.CheckMem();
+	m_buf.CheckMem();
 }
 
 void FileAppendService::ValidateMem() const
 {
 	m_fileName.ValidateMem();
-	m_q.ValidateMem();
+	m_thread.ValidateMem();
+	m_ring.ValidateMem();
+	m_buf.ValidateMem();
 }
 #endif
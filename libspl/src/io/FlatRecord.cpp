@@ -0,0 +1,778 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <spl/Environment.h>
+#include <spl/Exception.h>
+#include <spl/io/FlatRecord.h>
+#include <spl/threading/ThreadStartDelegate.h>
+
+using namespace spl;
+
+static const int64 _pow10[] =
+{
+	1LL, 10LL, 100LL, 1000LL, 10000LL, 100000LL, 1000000LL, 10000000LL, 100000000LL,
+	1000000000LL, 10000000000LL, 100000000000LL, 1000000000000LL, 10000000000000LL,
+	100000000000000LL, 1000000000000000LL, 10000000000000000LL, 100000000000000000LL,
+	1000000000000000000LL
+};
+
+#define POW10_COUNT ((int)(sizeof(_pow10) / sizeof(_pow10[0])))
+
+FixedFieldDef::FixedFieldDef()
+: m_name(), m_offset(0), m_length(0), m_type(DbSqlType::SQL_TYPE_UNASSIGNED), m_scale(0), m_format(FIXED_FMT_DEFAULT)
+{
+}
+
+FixedFieldDef::FixedFieldDef(const String& name, int offset, int length, int type, int scale, FixedFieldFormat format)
+: m_name(name), m_offset(offset), m_length(length), m_type(type), m_scale(scale), m_format(format)
+{
+}
+
+FixedFieldDef::FixedFieldDef(const FixedFieldDef& fld)
+: m_name(fld.m_name), m_offset(fld.m_offset), m_length(fld.m_length), m_type(fld.m_type), m_scale(fld.m_scale), m_format(fld.m_format)
+{
+}
+
+FixedFieldDef::~FixedFieldDef()
+{
+}
+
+FixedFieldDef& FixedFieldDef::operator =(const FixedFieldDef& fld)
+{
+	m_name = fld.m_name;
+	m_offset = fld.m_offset;
+	m_length = fld.m_length;
+	m_type = fld.m_type;
+	m_scale = fld.m_scale;
+	m_format = fld.m_format;
+	return *this;
+}
+
+#if defined(DEBUG)
+void FixedFieldDef::CheckMem() const
+{
+	m_name.CheckMem();
+}
+
+void FixedFieldDef::ValidateMem() const
+{
+	m_name.ValidateMem();
+}
+#endif
+
+FixedRecordDef::FixedRecordDef(int recordLength)
+: m_recordLength(recordLength), m_recordEnd(0), m_fields(), m_fieldIdx()
+{
+	if (recordLength < 1)
+	{
+		throw new InvalidArgumentException("Record length must be positive");
+	}
+}
+
+FixedRecordDef::~FixedRecordDef()
+{
+}
+
+int FixedRecordDef::AddField(const FixedFieldDef& fld)
+{
+	if (fld.m_length < 1 || fld.m_offset + fld.m_length > m_recordLength)
+	{
+		throw new InvalidArgumentException("Field runs past the end of the record");
+	}
+	if (fld.m_scale < 0 || fld.m_scale >= POW10_COUNT)
+	{
+		throw new InvalidArgumentException("Invalid field scale");
+	}
+	if (!fld.IsFiller() && m_fieldIdx.ContainsKey(fld.m_name))
+	{
+		throw new InvalidArgumentException("Duplicate field name");
+	}
+
+	int ordinal = m_fields.Count();
+	m_fields.Add(fld);
+	if (!fld.IsFiller())
+	{
+		m_fieldIdx.Set(fld.m_name, ordinal);
+	}
+	m_recordEnd += fld.m_length;
+	return ordinal;
+}
+
+int FixedRecordDef::GetFieldOrdinal(const String& name) const
+{
+	int ordinal;
+	if (m_fieldIdx.TryGet(name, ordinal))
+	{
+		return ordinal;
+	}
+	return -1;
+}
+
+void FixedRecordDef::DefineColumns(RecordSet& rs) const
+{
+	int count = m_fields.Count();
+	for (int x = 0; x < count; x++)
+	{
+		const FixedFieldDef& fld = m_fields.ElementAtRef(x);
+		if (!fld.IsFiller())
+		{
+			rs.DefineColumn(fld.m_name, fld.m_type, fld.m_length);
+		}
+	}
+}
+
+FixedRecord FixedRecordDef::Parse(const byte *data) const
+{
+	return FixedRecord(*this, data);
+}
+
+#if defined(DEBUG)
+void FixedRecordDef::CheckMem() const
+{
+	m_fields.CheckMem();
+	m_fieldIdx.CheckMem();
+}
+
+void FixedRecordDef::ValidateMem() const
+{
+	m_fields.ValidateMem();
+	m_fieldIdx.ValidateMem();
+}
+#endif
+
+/** @brief Returns the digits in cp as an unscaled integer, and in scale the
+ *	number of digits after an explicit decimal point, or -1 if there isn't one.
+ */
+static int64 _ParseNumber(const char *cp, int len, int& scale)
+{
+	int x = 0;
+	bool negative = false;
+	int64 n = 0;
+
+	scale = -1;
+	while (x < len && ' ' == cp[x])
+	{
+		x++;
+	}
+	if (x < len && ('+' == cp[x] || '-' == cp[x]))
+	{
+		negative = '-' == cp[x++];
+	}
+	for (; x < len; x++)
+	{
+		char ch = cp[x];
+		if (ch >= '0' && ch <= '9')
+		{
+			n = n * 10 + (ch - '0');
+			if (scale >= 0)
+			{
+				scale++;
+			}
+		}
+		else if ('.' == ch && scale < 0)
+		{
+			scale = 0;
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	if (x < len)
+	{
+		// An overpunched sign in the last digit, or a trailing sign.
+		char ch = cp[x];
+		if ('{' == ch || '}' == ch || (ch >= 'A' && ch <= 'R'))
+		{
+			int digit = '{' == ch || '}' == ch ? 0 : (ch <= 'I' ? ch - 'A' + 1 : ch - 'J' + 1);
+			n = n * 10 + digit;
+			negative = negative || '}' == ch || ch >= 'J';
+			if (scale >= 0)
+			{
+				scale++;
+			}
+			x++;
+		}
+		else if ('+' == ch || '-' == ch)
+		{
+			negative = negative || '-' == ch;
+			x++;
+		}
+		for (; x < len; x++)
+		{
+			if (' ' != cp[x])
+			{
+				throw new ParseException("Invalid number in fixed width field");
+			}
+		}
+	}
+	return negative ? -n : n;
+}
+
+/** @brief Returns the number of len digits at cp, or -1 if they aren't all digits. */
+static inline int _ParseDigits(const char *cp, int len)
+{
+	int n = 0;
+	for (int x = 0; x < len; x++)
+	{
+		if (cp[x] < '0' || cp[x] > '9')
+		{
+			return -1;
+		}
+		n = n * 10 + (cp[x] - '0');
+	}
+	return n;
+}
+
+static bool _IsNullDate(const char *cp, int len)
+{
+	for (int x = 0; x < len; x++)
+	{
+		if (' ' != cp[x] && '0' != cp[x])
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+static void _CheckDate(int year, int month, int day)
+{
+	if (year < 0 || month < 1 || month > 12 || day < 1 || day > 31)
+	{
+		throw new ParseException("Invalid date in fixed width field");
+	}
+}
+
+StringView FixedRecord::GetText(int ordinal) const
+{
+	const FixedFieldDef& fld = m_def->Field(ordinal);
+	const char *cp = &m_data[fld.m_offset];
+	int len = fld.m_length;
+	while (len > 0 && ' ' == cp[len - 1])
+	{
+		len--;
+	}
+	return StringView(cp, len);
+}
+
+bool FixedRecord::IsBlank(int ordinal) const
+{
+	const FixedFieldDef& fld = m_def->Field(ordinal);
+	const char *cp = &m_data[fld.m_offset];
+	for (int x = 0; x < fld.m_length; x++)
+	{
+		if (' ' != cp[x])
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+int64 FixedRecord::GetInt64(int ordinal) const
+{
+	const FixedFieldDef& fld = m_def->Field(ordinal);
+	int scale;
+	int64 n = _ParseNumber(&m_data[fld.m_offset], fld.m_length, scale);
+	if (scale < 0)
+	{
+		scale = fld.m_scale;
+	}
+	return scale > 0 && scale < POW10_COUNT ? n / _pow10[scale] : n;
+}
+
+float64 FixedRecord::GetFloat64(int ordinal) const
+{
+	const FixedFieldDef& fld = m_def->Field(ordinal);
+	int scale;
+	int64 n = _ParseNumber(&m_data[fld.m_offset], fld.m_length, scale);
+	if (scale < 0)
+	{
+		scale = fld.m_scale;
+	}
+	return scale > 0 && scale < POW10_COUNT ? (float64)n / (float64)_pow10[scale] : (float64)n;
+}
+
+Decimal FixedRecord::GetDecimal(int ordinal) const
+{
+	const FixedFieldDef& fld = m_def->Field(ordinal);
+	int scale;
+	int64 n = _ParseNumber(&m_data[fld.m_offset], fld.m_length, scale);
+	if (scale < 0)
+	{
+		scale = fld.m_scale;
+	}
+	if (scale > 0 && scale < POW10_COUNT)
+	{
+		return Decimal(n) / Decimal(_pow10[scale]);
+	}
+	return Decimal(n);
+}
+
+Date FixedRecord::GetDate(int ordinal) const
+{
+	const FixedFieldDef& fld = m_def->Field(ordinal);
+	const char *cp = &m_data[fld.m_offset];
+	FixedFieldFormat format = fld.m_format;
+
+	if (FIXED_FMT_DEFAULT == format)
+	{
+		if (8 == fld.m_length)
+		{
+			format = FIXED_FMT_YYYYMMDD;
+		}
+		else if (6 == fld.m_length)
+		{
+			format = FIXED_FMT_MMDDYY;
+		}
+		else
+		{
+			return Date::Parse(*GetText(ordinal).ToString());
+		}
+	}
+
+	int year, month, day;
+	if (FIXED_FMT_MMDDYY == format && fld.m_length >= 6)
+	{
+		month = _ParseDigits(cp, 2);
+		day = _ParseDigits(&cp[2], 2);
+		year = _ParseDigits(&cp[4], 2);
+		if (year >= 0)
+		{
+			year += year > 50 ? 1900 : 2000;
+		}
+	}
+	else if (FIXED_FMT_YYYYMMDD == format && fld.m_length >= 8)
+	{
+		year = _ParseDigits(cp, 4);
+		month = _ParseDigits(&cp[4], 2);
+		day = _ParseDigits(&cp[6], 2);
+	}
+	else if (FIXED_FMT_TIMESTAMP == format && fld.m_length >= 10)
+	{
+		year = _ParseDigits(cp, 4);
+		month = _ParseDigits(&cp[5], 2);
+		day = _ParseDigits(&cp[8], 2);
+	}
+	else
+	{
+		throw new ParseException("Fixed width date field is too short for its format");
+	}
+	_CheckDate(year, month, day);
+	return Date(year, month, day);
+}
+
+DateTime FixedRecord::GetDateTime(int ordinal) const
+{
+	const FixedFieldDef& fld = m_def->Field(ordinal);
+	if (FIXED_FMT_TIMESTAMP != fld.m_format)
+	{
+		return DateTime(GetDate(ordinal));
+	}
+
+	const char *cp = &m_data[fld.m_offset];
+	int year = fld.m_length >= 10 ? _ParseDigits(cp, 4) : -1;
+	int month = fld.m_length >= 10 ? _ParseDigits(&cp[5], 2) : -1;
+	int day = fld.m_length >= 10 ? _ParseDigits(&cp[8], 2) : -1;
+	_CheckDate(year, month, day);
+
+	int hour = 0, minute = 0, second = 0;
+	if (fld.m_length >= 19)
+	{
+		hour = _ParseDigits(&cp[11], 2);
+		minute = _ParseDigits(&cp[14], 2);
+		second = _ParseDigits(&cp[17], 2);
+		if (hour < 0 || hour > 23 || minute < 0 || minute > 59 || second < 0 || second > 59)
+		{
+			throw new ParseException("Invalid time in fixed width field");
+		}
+	}
+	return DateTime(year, month, day, hour, minute, second);
+}
+
+void FixedRecord::AppendTo(RecordSet& rs) const
+{
+	int count = m_def->FieldCount();
+	int colIdx = 0;
+
+	for (int x = 0; x < count; x++)
+	{
+		const FixedFieldDef& fld = m_def->Field(x);
+		if (fld.IsFiller())
+		{
+			continue;
+		}
+
+		IColumn *col = rs.GetColumn(colIdx++);
+		const char *cp = &m_data[fld.m_offset];
+
+		switch (col->Type())
+		{
+		case DbSqlType::SQL_TYPE_CHAR:
+		case DbSqlType::SQL_TYPE_VARCHAR:
+		{
+			StringView text = GetText(x);
+			col->AppendParse(text.GetChars(), text.Length());
+			break;
+		}
+		case DbSqlType::SQL_TYPE_BLOB:
+			col->Append((void *)cp, fld.m_length);
+			break;
+		case DbSqlType::SQL_TYPE_DATE:
+			if (_IsNullDate(cp, fld.m_length))
+			{
+				col->AppendNull();
+			}
+			else
+			{
+				col->Append(GetDate(x));
+			}
+			break;
+		case DbSqlType::SQL_TYPE_TIMESTAMP:
+		case DbSqlType::SQL_TYPE_DATETIME:
+			if (_IsNullDate(cp, fld.m_length))
+			{
+				col->AppendNull();
+			}
+			else
+			{
+				col->Append(GetDateTime(x));
+			}
+			break;
+		default:
+			if (IsBlank(x))
+			{
+				col->AppendNull();
+				break;
+			}
+			switch (col->Type())
+			{
+			case DbSqlType::SQL_TYPE_INT8:
+				col->Append((int8)GetInt64(x));
+				break;
+			case DbSqlType::SQL_TYPE_INT16:
+				col->Append((int16)GetInt64(x));
+				break;
+			case DbSqlType::SQL_TYPE_INT32:
+				col->Append((int32)GetInt64(x));
+				break;
+			case DbSqlType::SQL_TYPE_INT64:
+				col->Append(GetInt64(x));
+				break;
+			case DbSqlType::SQL_TYPE_DECIMAL:
+				col->Append(GetDecimal(x));
+				break;
+			case DbSqlType::SQL_TYPE_FLOAT32:
+				col->Append((float32)GetFloat64(x));
+				break;
+			case DbSqlType::SQL_TYPE_FLOAT64:
+				col->Append(GetFloat64(x));
+				break;
+			case DbSqlType::SQL_TYPE_FLAG:
+			{
+				StringView text = GetText(x).Trim();
+				char ch = text.Length() > 0 ? text[0] : '0';
+				col->Append('Y' == ch || 'y' == ch || 'T' == ch || 't' == ch || (ch > '0' && ch <= '9'));
+				break;
+			}
+			default:
+				throw new InvalidTypeConversionException();
+			}
+			break;
+		}
+	}
+}
+
+/** @brief One thread's share of a batch: a run of whole records loaded into
+ *	its own record set.
+ */
+class FixedRecordChunk
+{
+private:
+	// forbid copy constructor
+	inline FixedRecordChunk(const FixedRecordChunk& frc) {}
+	inline void operator =(const FixedRecordChunk& frc) {}
+
+	const FixedRecordFile *m_file;
+
+	void Run();
+
+public:
+	int64 m_first;
+	int64 m_count;
+	RecordSet *m_rs;
+	Exception *m_error;
+	ThreadStartDelegate<FixedRecordChunk> m_thread;
+
+	FixedRecordChunk(const FixedRecordFile& file, const FixedRecordDef& def, int64 first, int64 count);
+	~FixedRecordChunk();
+
+	/** @brief Loads on a new thread, or on this one if thread is false. */
+	void Start(bool thread);
+	void Join();
+};
+
+FixedRecordChunk::FixedRecordChunk(const FixedRecordFile& file, const FixedRecordDef& def, int64 first, int64 count)
+: m_file(&file), m_first(first), m_count(count), m_rs(new RecordSet()), m_error(NULL), m_thread()
+{
+	def.DefineColumns(*m_rs);
+}
+
+FixedRecordChunk::~FixedRecordChunk()
+{
+	if (NULL != m_rs)
+	{
+		delete m_rs;
+	}
+	if (NULL != m_error)
+	{
+		delete m_error;
+	}
+}
+
+void FixedRecordChunk::Run()
+{
+	try
+	{
+		int64 end = m_first + m_count;
+		for (int64 x = m_first; x < end; x++)
+		{
+			m_file->Record(x).AppendTo(*m_rs);
+		}
+	}
+	catch (Exception *ex)
+	{
+		m_error = ex;
+	}
+}
+
+void FixedRecordChunk::Start(bool thread)
+{
+	if (thread)
+	{
+		m_thread.Set(this, &FixedRecordChunk::Run);
+		m_thread.Start();
+	}
+	else
+	{
+		Run();
+	}
+}
+
+void FixedRecordChunk::Join()
+{
+	// Event::Notify() isn't sticky, so Thread::Join() can miss a thread that
+	// exits just before the wait starts.
+	while (m_thread.IsRunning())
+	{
+		Thread::YYield();
+	}
+}
+
+static void _DeleteChunks(Vector<FixedRecordChunk *>& chunks)
+{
+	int count = chunks.Count();
+	for (int x = 0; x < count; x++)
+	{
+		delete chunks.ElementAt(x);
+	}
+	chunks.Clear();
+}
+
+FixedRecordFile::FixedRecordFile(const String& filename, FixedRecordDefPtr def)
+: m_file(new MappedFile(filename)), m_def(def), m_stride(def->RecordLength()), m_recordCount(0), m_threadCount(Environment::ProcessorCount()), m_chunkRecords(64 * 1024)
+{
+	if (m_threadCount < 1)
+	{
+		m_threadCount = 1;
+	}
+
+	const byte *data = m_file->Data();
+	int64 length = m_file->Length();
+	int reclen = def->RecordLength();
+
+	if (length > reclen)
+	{
+		if ('\n' == data[reclen])
+		{
+			m_stride = reclen + 1;
+		}
+		else if ('\r' == data[reclen] && length > reclen + 1 && '\n' == data[reclen + 1])
+		{
+			m_stride = reclen + 2;
+		}
+	}
+
+	m_recordCount = length / m_stride;
+	int64 rest = length - m_recordCount * m_stride;
+	if (rest >= reclen)
+	{
+		// The last record has no terminator.
+		m_recordCount++;
+	}
+	else
+	{
+		// Allow trailing blank lines or an end of file mark.
+		for (int64 x = length - rest; x < length; x++)
+		{
+			if ('\r' != data[x] && '\n' != data[x] && ' ' != data[x] && 0x1A != data[x])
+			{
+				throw new IOException("Fixed record file ends in a partial record");
+			}
+		}
+	}
+}
+
+FixedRecordFile::~FixedRecordFile()
+{
+}
+
+void FixedRecordFile::LoadBatch(int64 first, int64 count, Vector<RecordSet *>& batch)
+{
+	Vector<FixedRecordChunk *> chunks;
+	int64 end = first + count;
+	for (int64 pos = first; pos < end; pos += m_chunkRecords)
+	{
+		int64 n = end - pos < m_chunkRecords ? end - pos : m_chunkRecords;
+		try
+		{
+			chunks.Add(new FixedRecordChunk(*this, *m_def, pos, n));
+		}
+		catch (Exception *ex)
+		{
+			_DeleteChunks(chunks);
+			throw ex;
+		}
+	}
+
+	int pieces = chunks.Count();
+	try
+	{
+		for (int x = 1; x < pieces; x++)
+		{
+			chunks.ElementAt(x)->Start(true);
+		}
+		chunks.ElementAt(0)->Start(false);
+	}
+	catch (Exception *ex)
+	{
+		for (int x = 1; x < pieces; x++)
+		{
+			chunks.ElementAt(x)->Join();
+		}
+		_DeleteChunks(chunks);
+		throw ex;
+	}
+	for (int x = 1; x < pieces; x++)
+	{
+		chunks.ElementAt(x)->Join();
+	}
+
+	for (int x = 0; x < pieces; x++)
+	{
+		FixedRecordChunk *chunk = chunks.ElementAt(x);
+		if (NULL != chunk->m_error)
+		{
+			Exception *ex = chunk->m_error;
+			chunk->m_error = NULL;
+			_DeleteChunks(chunks);
+			throw ex;
+		}
+	}
+	for (int x = 0; x < pieces; x++)
+	{
+		FixedRecordChunk *chunk = chunks.ElementAt(x);
+		batch.Add(chunk->m_rs);
+		chunk->m_rs = NULL;
+	}
+	_DeleteChunks(chunks);
+}
+
+RecordSetPtr FixedRecordFile::Load()
+{
+	RecordSetPtr rs(new RecordSet());
+	Vector<RecordSet *> batch;
+	int64 batchRecords = (int64)m_threadCount * m_chunkRecords;
+
+	m_def->DefineColumns(*rs);
+
+	for (int64 first = 0; first < m_recordCount; first += batchRecords)
+	{
+		int64 count = m_recordCount - first < batchRecords ? m_recordCount - first : batchRecords;
+		LoadBatch(first, count, batch);
+
+		int chunks = batch.Count();
+		for (int x = 0; x < chunks; x++)
+		{
+			RecordSet *chunk = batch.ElementAt(x);
+			rs->AppendRows(*chunk);
+			delete chunk;
+		}
+		batch.Clear();
+	}
+	return rs;
+}
+
+void FixedRecordFile::Load(FixedRecordBatchDelegatePtr onBatch)
+{
+	Vector<RecordSet *> batch;
+	int64 batchRecords = (int64)m_threadCount * m_chunkRecords;
+
+	for (int64 first = 0; first < m_recordCount; first += batchRecords)
+	{
+		int64 count = m_recordCount - first < batchRecords ? m_recordCount - first : batchRecords;
+		m_file->WillNeed(first * m_stride, count * m_stride);
+		LoadBatch(first, count, batch);
+
+		int chunks = batch.Count();
+		int x = 0;
+		try
+		{
+			for (; x < chunks; x++)
+			{
+				onBatch->Call(*batch.ElementAt(x));
+				delete batch.ElementAt(x);
+			}
+		}
+		catch (Exception *ex)
+		{
+			for (; x < chunks; x++)
+			{
+				delete batch.ElementAt(x);
+			}
+			throw ex;
+		}
+		batch.Clear();
+
+		m_file->DontNeed(first * m_stride, count * m_stride);
+	}
+}
+
+#if defined(DEBUG)
+void FixedRecordFile::CheckMem() const
+{
+	m_file.CheckMem();
+	m_def.CheckMem();
+}
+
+void FixedRecordFile::ValidateMem() const
+{
+	m_file.ValidateMem();
+	m_def.ValidateMem();
+}
+#endif
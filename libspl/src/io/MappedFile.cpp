@@ -0,0 +1,170 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#if defined(_WIN32) || defined(_WIN64)
+#include <spl/configwin32.h>
+#else
+#include <spl/autoconf/config.h>
+#endif
+
+#ifdef HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+#ifdef HAVE_IO_H
+#include <io.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+
+#include <spl/Environment.h>
+#include <spl/Exception.h>
+#include <spl/io/MappedFile.h>
+
+using namespace spl;
+
+MappedFile::MappedFile(const String& filename)
+: m_data(NULL), m_length(0), m_mapped(false)
+{
+#ifdef _WINDOWS
+	int fd = _open(filename.GetChars(), _O_RDONLY | _O_BINARY);
+#else
+	int fd = open(filename.GetChars(), O_RDONLY);
+#endif
+	if (fd < 0)
+	{
+		throw new IOException(Environment::LastErrorMessage());
+	}
+
+	struct stat st;
+	if (0 != fstat(fd, &st))
+	{
+		close(fd);
+		throw new IOException(Environment::LastErrorMessage());
+	}
+	m_length = (int64)st.st_size;
+
+	if (0 == m_length)
+	{
+		close(fd);
+		return;
+	}
+
+#ifdef HAVE_SYS_MMAN_H
+	void *addr = mmap(NULL, (size_t)m_length, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (MAP_FAILED != addr)
+	{
+		close(fd);
+		m_data = (byte *)addr;
+		m_mapped = true;
+		return;
+	}
+#endif
+
+	m_data = new byte[(size_t)m_length];
+	int64 pos = 0;
+	while (pos < m_length)
+	{
+		int64 want = m_length - pos > 0x40000000 ? 0x40000000 : m_length - pos;
+		int count = (int)read(fd, &m_data[pos], (unsigned)want);
+		if (count <= 0)
+		{
+			close(fd);
+			delete[] m_data;
+			m_data = NULL;
+			throw new IOException(count < 0 ? Environment::LastErrorMessage() : String("File truncated while reading"));
+		}
+		pos += count;
+	}
+	close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+	if (NULL == m_data)
+	{
+		return;
+	}
+#ifdef HAVE_SYS_MMAN_H
+	if (m_mapped)
+	{
+		munmap(m_data, (size_t)m_length);
+		return;
+	}
+#endif
+	delete[] m_data;
+}
+
+#ifdef HAVE_SYS_MMAN_H
+static void _Advise(byte *data, int64 length, int64 offset, int64 len, int advice)
+{
+	// madvise wants a page aligned start.
+	int64 page = (int64)sysconf(_SC_PAGESIZE);
+	int64 start = offset - offset % page;
+	int64 end = offset + len > length ? length : offset + len;
+	if (end > start)
+	{
+		madvise(&data[start], (size_t)(end - start), advice);
+	}
+}
+#endif
+
+void MappedFile::WillNeed(int64 offset, int64 len)
+{
+#ifdef HAVE_SYS_MMAN_H
+	if (m_mapped)
+	{
+		_Advise(m_data, m_length, offset, len, MADV_WILLNEED);
+	}
+#endif
+}
+
+void MappedFile::DontNeed(int64 offset, int64 len)
+{
+#ifdef HAVE_SYS_MMAN_H
+	if (m_mapped)
+	{
+		_Advise(m_data, m_length, offset, len, MADV_DONTNEED);
+	}
+#endif
+}
+
+#if defined(DEBUG)
+void MappedFile::CheckMem() const
+{
+	if (!m_mapped && NULL != m_data)
+	{
+		DEBUG_NOTE_MEM_ALLOCATION(m_data);
+	}
+}
+
+void MappedFile::ValidateMem() const
+{
+	if (!m_mapped && NULL != m_data)
+	{
+		ASSERT_MEM(m_data, m_length);
+	}
+}
+#endif
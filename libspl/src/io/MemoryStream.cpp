@@ -51,13 +51,15 @@ int MemoryStream::Read(Array<byte>& buffer, const int offset, int count)
 	{
 		count = m_buf.Count() - m_ptr;
 	}
-	int bufPos = offset;
-	int pos = count;
-	while ( pos-- > 0 )
+	if ( count <= 0 )
 	{
-		buffer[bufPos++] = m_buf.ElementAt(m_ptr);
-		m_buf.RemoveAt(m_ptr);
+		return 0;
+	}
+	for ( int x = 0; x < count; x++ )
+	{
+		buffer[offset + x] = m_buf.ElementAtRef(m_ptr + x);
 	}
+	m_buf.RemoveRange(m_ptr, count);
 	return count;
 }
 
@@ -81,6 +81,23 @@ spl::IStream::~IStream()
 {
 }
 
+void spl::IStream::WriteGather(const StreamSegment *segments, const int segmentCount)
+{
+	int total = 0;
+	for ( int x = 0; x < segmentCount; x++ )
+	{
+		total += segments[x].count;
+	}
+	Array<byte> buf(total);
+	int pos = 0;
+	for ( int x = 0; x < segmentCount; x++ )
+	{
+		memcpy(&buf.Data()[pos], segments[x].data, segments[x].count);
+		pos += segments[x].count;
+	}
+	Write(buf, 0, total);
+}
+
 IStreamState::IStreamState( IStream* parent, IStreamState **parentStateVar )
 : m_parent(parent), m_holder(parentStateVar)
 {
@@ -762,8 +779,11 @@ int StreamBuffer::Read(Array<byte>& buffer, const int offset, int count)
 	}
 	ASSERT( m_bufpos >= count );
 	memcpy(&buffer[offset], m_buf, count);
-	memcpy(m_buf, &m_buf[count], m_bufpos - count);
 	m_bufpos -= count;
+	if ( m_bufpos > 0 )
+	{
+		memmove(m_buf, &m_buf[count], m_bufpos);
+	}
 	return count;
 }
 
@@ -801,6 +821,30 @@ void StreamBuffer::Write(const Array<byte>& buffer, const int offset, const int
 	ASSERT( m_bufpos < m_buflen );
 }
 
+void StreamBuffer::WriteGather(const StreamSegment *segments, const int segmentCount)
+{
+	int total = 0;
+	for ( int x = 0; x < segmentCount; x++ )
+	{
+		total += segments[x].count;
+	}
+	if ( m_bufpos + total >= m_buflen )
+	{
+		Flush();
+	}
+	if ( total >= m_buflen )
+	{
+		m_strm->WriteGather(segments, segmentCount);
+		return;
+	}
+	for ( int x = 0; x < segmentCount; x++ )
+	{
+		memcpy(&m_buf[m_bufpos], segments[x].data, segments[x].count);
+		m_bufpos += segments[x].count;
+	}
+	ASSERT( m_bufpos < m_buflen );
+}
+
 void StreamBuffer::WriteByte(byte value)
 {
 	if ( m_bufpos + 1 >= m_buflen )
@@ -22,7 +22,7 @@ using namespace spl;
 ThreadedLog::ThreadedLog()
 :	m_file(),
 	Log(Log::FacLocal0, Log::LogToServer),
-	m_relay(),
+	m_relay(THREADED_LOG_RELAY_SIZE, RingQueue<Log::LogEntry>::RING_DROP),
 	m_running(false),
 	m_thread(this, &ThreadedLog::Run)
 {
@@ -58,8 +58,12 @@ void ThreadedLog::Run()
 	
 	while (m_running)
 	{
-		LogEntry le(m_relay.Get());
-		
+		LogEntry le;
+		if (!m_relay.Get(le, RING_QUEUE_WAIT_MS))
+		{
+			continue;
+		}
+
 		for (List<Log::LogServerInfo>::Iterator iter = m_servers.Begin(); iter.Next(); )
 		{
 			if( _LogDoLog(le, iter.CurrentRef().GetWhereToLog()))
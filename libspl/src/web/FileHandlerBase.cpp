@@ -14,9 +14,21 @@
  *   You should have received a copy of the GNU General Public License
  *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
  */
-#include <spl/io/File.h>
-#include <spl/Int32.h>
-#include <spl/io/TextStream.h>
+#if defined(_WIN32) || defined(_WIN64)
+#include <spl/configwin32.h>
+#else
+#include <spl/autoconf/config.h>
+#endif
+
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+
+#include <spl/Int64.h>
+#include <spl/web/HttpUtility.h>
 #include <spl/web/server/HttpFileHandler.h>
 
 using namespace spl;
@@ -24,7 +36,7 @@ using namespace spl;
 const int FileHandlerBase::BLOCK_SIZE = 512;
 
 FileHandlerBase::FileHandlerBase(const String& defaultMimeType)
-: HttpHandler(defaultMimeType)
+: HttpHandler(defaultMimeType), m_cache()
 {
 }
 
@@ -32,10 +44,44 @@ FileHandlerBase::~FileHandlerBase()
 {
 }
 
+void FileHandlerBase::EnableCache(long maxBytes, long maxFileSize)
+{
+	m_cache = HttpFileCachePtr(new HttpFileCache(maxBytes, maxFileSize));
+}
+
 void FileHandlerBase::ProcessFileContentBlock(StringBuffer& buf)
 {
 }
 
+StringPtr FileHandlerBase::EntityTag(long size, time_t mtime)
+{
+	StringBuffer buf;
+	buf.Append('"');
+	buf.Append(Int64::ToString((int64)size, 16));
+	buf.Append('-');
+	buf.Append(Int64::ToString((int64)mtime, 16));
+	buf.Append('"');
+	return buf.ToString();
+}
+
+bool FileHandlerBase::IsNotModified(HttpRequest& request, const String& etag, const String& lastModified)
+{
+	HttpHeader& headers = request.Headers();
+
+	// If-None-Match wins when both are present.
+	if (headers.HasHeader("If-None-Match"))
+	{
+		const String& match = headers.Header("If-None-Match");
+		return match.Equals("*") || 0 <= match.IndexOf(etag);
+	}
+	if (headers.HasHeader("If-Modified-Since"))
+	{
+		// Clients echo Last-Modified, so an exact match is enough.
+		return headers.Header("If-Modified-Since").Equals(lastModified);
+	}
+	return false;
+}
+
 void FileHandlerBase::ProcessRequest(HttpRequest& request, HttpResponse& response)
 {
 	HttpHandler::ProcessRequest(request, response);
@@ -55,43 +101,89 @@ void FileHandlerBase::ProcessRequest(HttpRequest& request, HttpResponse& respons
 	}
 	localPath = localPath + request.URI().Filename();
 
-	if (!File::Exists(localPath))
+	struct stat st;
+	if (0 != stat(localPath.GetChars(), &st) || S_IFREG != (st.st_mode & S_IFMT))
 	{
 		response.StatusCode() = 404;
 		return;
 	}
 
-	if (request.Method() == "GET")
+	bool isGet = request.Method() == "GET";
+	if (!isGet && !request.Method().Equals("HEAD"))
 	{
-		TextReader *reader = new TextReader(File::OpenText(localPath));
-		StringPtr html = reader->ReadToEnd();
-		reader->Close();
-		delete reader;
-
-		TextWriter *writer = new TextWriter(response.GetBodyStream());
-		writer->Write(html);
-		delete writer;
+		response.StatusCode() = 405;
+		response.AddHeader("Allow", "GET,HEAD");
+		return;
 	}
-	else if (request.Method() == "HEAD")
+
+	long size = (long)st.st_size;
+	StringPtr etag = EntityTag(size, st.st_mtime);
+	StringPtr lastModified = HttpUtility::FormatDate(st.st_mtime);
+
+	response.AddHeader("Last-Modified", *lastModified);
+	response.AddHeader("ETag", *etag);
+	response.AddHeader("Accept-Ranges", "bytes");
+
+	if (IsNotModified(request, *etag, *lastModified))
 	{
-		// do nothing.
-		response.StatusCode() = 200;
+		response.StatusCode() = 304;
+		response.SendBody() = false;
+		return;
 	}
-	else
+
+	long offset = 0;
+	long count = size;
+	HttpHeader& headers = request.Headers();
+
+	// A Range with a stale If-Range gets the whole file.
+	if (headers.HasHeader("Range") && (!headers.HasHeader("If-Range") || headers.Header("If-Range").Equals(*etag)))
 	{
-		response.StatusCode() = 405;
-		response.AddHeader("Allow", "GET,HEAD");
+		switch (HttpUtility::ParseByteRange(headers.Header("Range"), size, offset, count))
+		{
+		case HttpUtility::RANGE_SATISFIABLE:
+			response.StatusCode() = 206;
+			response.AddHeader
+			(
+				"Content-Range", 
+				"bytes " + *Int64::ToString(offset) + "-" + *Int64::ToString(offset + count - 1) + "/" + *Int64::ToString(size)
+			);
+			break;
+
+		case HttpUtility::RANGE_UNSATISFIABLE:
+			response.StatusCode() = 416;
+			response.AddHeader("Content-Range", "bytes */" + *Int64::ToString(size));
+			return;
+
+		default:
+			break;
+		}
 	}
+
+	response.SendBody() = isGet;
+
+	if (isGet && m_cache.IsNotNull())
+	{
+		RefCountPtr<Array<byte> > data = m_cache->Get(localPath, st.st_mtime, size);
+		if (data.IsNotNull())
+		{
+			response.GetBodyStream()->Write(*data, (int)offset, (int)count);
+			return;
+		}
+	}
+
+	response.SetBodyFile(localPath, offset, count);
 }
 
 #ifdef DEBUG
 void FileHandlerBase::ValidateMem() const
 {
 	HttpHandler::ValidateMem();
+	m_cache.ValidateMem();
 }
 
 void FileHandlerBase::CheckMem() const
 {
 	HttpHandler::CheckMem();
+	m_cache.CheckMem();
 }
 #endif
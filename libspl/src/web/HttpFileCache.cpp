@@ -0,0 +1,188 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <spl/io/File.h>
+#include <spl/web/server/HttpFileCache.h>
+
+using namespace spl;
+
+HttpFileCacheEntry::HttpFileCacheEntry(RefCountPtr<Array<byte> > data, time_t mtime, int64 lastUse)
+: m_data(data), m_mtime(mtime), m_lastUse(lastUse)
+{
+}
+
+HttpFileCacheEntry::~HttpFileCacheEntry()
+{
+}
+
+#if defined(DEBUG) || defined(_DEBUG)
+void HttpFileCacheEntry::CheckMem() const
+{
+	m_data.CheckMem();
+}
+
+void HttpFileCacheEntry::ValidateMem() const
+{
+	m_data.ValidateMem();
+}
+#endif
+
+HttpFileCache::HttpFileCache( long maxBytes, long maxFileSize )
+: m_entries(), m_mtx(), m_maxBytes(maxBytes), m_maxFileSize(maxFileSize), m_bytes(0), m_clock(0), m_hits(0), m_misses(0)
+{
+	if ( m_maxFileSize > m_maxBytes )
+	{
+		m_maxFileSize = m_maxBytes;
+	}
+}
+
+HttpFileCache::~HttpFileCache()
+{
+	Clear();
+}
+
+RefCountPtr<Array<byte> > HttpFileCache::Get( const String& path, time_t mtime, long size )
+{
+	if ( size > m_maxFileSize )
+	{
+		return RefCountPtr<Array<byte> >();
+	}
+
+	m_mtx.Lock();
+	if ( m_entries.ContainsKey(path) )
+	{
+		HttpFileCacheEntry *entry = m_entries.Get(path);
+		if ( entry->m_mtime == mtime && entry->m_data->Length() == size )
+		{
+			entry->m_lastUse = ++m_clock;
+			m_hits++;
+			RefCountPtr<Array<byte> > data = entry->m_data;
+			m_mtx.Unlock();
+			return data;
+		}
+		Remove( path );
+	}
+	m_misses++;
+	m_mtx.Unlock();
+
+	// Read outside the lock so a slow disk doesn't stall hits on other files.
+	RefCountPtr<Array<byte> > data = File::LoadBinary( path );
+	if ( data.IsNull() || data->Length() != size )
+	{
+		// The file changed since the caller looked at it.
+		return RefCountPtr<Array<byte> >();
+	}
+
+	m_mtx.Lock();
+	if ( m_entries.ContainsKey(path) )
+	{
+		// Another thread loaded it first.
+		Remove( path );
+	}
+	EvictFor( size );
+	m_entries.Set( path, new HttpFileCacheEntry(data, mtime, ++m_clock) );
+	m_bytes += size;
+	m_mtx.Unlock();
+
+	return data;
+}
+
+void HttpFileCache::Remove( const String& path )
+{
+	HttpFileCacheEntry *entry = m_entries.Get(path);
+	m_bytes -= entry->m_data->Length();
+	m_entries.Remove( path );
+	delete entry;
+}
+
+void HttpFileCache::EvictFor( long bytes )
+{
+	while ( m_bytes + bytes > m_maxBytes && m_entries.Count() > 0 )
+	{
+		String oldestPath;
+		int64 oldest = 0;
+		bool found = false;
+
+		Hashtable<String, HttpFileCacheEntry *>::Iterator iter = m_entries.Begin();
+		while ( iter.Next() )
+		{
+			if ( ! found || iter.Current()->m_lastUse < oldest )
+			{
+				oldest = iter.Current()->m_lastUse;
+				oldestPath = iter.CurrentKey();
+				found = true;
+			}
+		}
+		Remove( oldestPath );
+	}
+}
+
+void HttpFileCache::Clear()
+{
+	m_mtx.Lock();
+	Hashtable<String, HttpFileCacheEntry *>::Iterator iter = m_entries.Begin();
+	while ( iter.Next() )
+	{
+		delete iter.Current();
+	}
+	m_entries.Clear();
+	m_bytes = 0;
+	m_mtx.Unlock();
+}
+
+int HttpFileCache::Count()
+{
+	m_mtx.Lock();
+	int count = m_entries.Count();
+	m_mtx.Unlock();
+	return count;
+}
+
+long HttpFileCache::Bytes()
+{
+	m_mtx.Lock();
+	long bytes = m_bytes;
+	m_mtx.Unlock();
+	return bytes;
+}
+
+int HttpFileCache::HitCount()
+{
+	m_mtx.Lock();
+	int hits = m_hits;
+	m_mtx.Unlock();
+	return hits;
+}
+
+int HttpFileCache::MissCount()
+{
+	m_mtx.Lock();
+	int misses = m_misses;
+	m_mtx.Unlock();
+	return misses;
+}
+
+#if defined(DEBUG) || defined(_DEBUG)
+void HttpFileCache::CheckMem() const
+{
+	m_entries.CheckMem();
+}
+
+void HttpFileCache::ValidateMem() const
+{
+	m_entries.ValidateMem();
+}
+#endif
@@ -14,6 +14,7 @@
  *   You should have received a copy of the GNU General Public License
  *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
  */
+#include <ctype.h>
 #include <spl/web/server/HttpHandlerFactory.h>
 
 using namespace spl;
@@ -43,11 +44,33 @@ void HttpHandlerFactory::AddHandler(HttpHandlerPtr handler)
 
 HttpHandler *HttpHandlerFactory::GetHandler(const String& fileExtension) const
 {
-	if (!m_handlerIdx.ContainsKey(fileExtension))
+	return GetHandler(StringView(fileExtension));
+}
+
+HttpHandler *HttpHandlerFactory::GetHandler(const StringView& fileExtension) const
+{
+	// Keys are lower case; fold the extension on the stack instead of making a String.
+	HttpHandler *handler;
+	char lower[32];
+	int len = fileExtension.Length();
+	if ( len >= (int)sizeof(lower) )
+	{
+		if ( ! m_handlerIdx.TryGet(*fileExtension.ToString()->ToLower(), handler) )
+		{
+			return NULL;
+		}
+		return handler;
+	}
+	for ( int x = 0; x < len; x++ )
+	{
+		lower[x] = (char)tolower((unsigned char)fileExtension.GetChars()[x]);
+	}
+
+	if ( ! m_handlerIdx.TryGet(StringView(lower, len), handler) )
 	{
 		return NULL;
 	}
-	return m_handlerIdx.Get(fileExtension.ToLower());
+	return handler;
 }
 
 void HttpHandlerFactory::Clear()
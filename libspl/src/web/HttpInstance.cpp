@@ -19,8 +19,8 @@
 
 using namespace spl;
 
-HttpInstance::HttpInstance(TcpSocketPtr sock, HttpHandlerFactory *handlerFact)
-: m_request(), m_sock(sock), m_handlerFact(handlerFact)
+HttpInstance::HttpInstance(TcpSocketPtr sock, HttpHandlerFactory *handlerFact, int maxRequests)
+: m_parser(), m_request(), m_sock(sock), m_handlerFact(handlerFact), m_maxRequests(maxRequests), m_requestCount(0), m_lastActivity(time(NULL)), m_closed(false), m_mtx()
 {
 	m_sock->SetLingerOn();
 }
@@ -32,29 +32,131 @@ HttpInstance::~HttpInstance()
 void HttpInstance::IStreamRead_OnClose()
 {
 	ValidateMem();
+
+	// Wait out CloseIfIdle, the socket service closes the socket after this returns.
+	m_mtx.Lock();
+	m_closed = true;
+	m_mtx.Unlock();
+
 	printf("Connection from %s was closed.\n", m_sock->GetRemoteIp().GetChars());
 }
 
+void HttpInstance::Respond(bool keepAlive)
+{
+	HttpResponse response;
+	if ( m_parser.IsVersion("HTTP/1.1") )
+	{
+		response.HttpVersion() = "HTTP/1.1";
+	}
+
+	// m_request is attached to m_parser, so its Strings are only made if the handler asks.
+	HttpHandler *handler;
+	StringView ext;
+	if ( m_parser.UriFileExt(ext) )
+	{
+		handler = m_handlerFact->GetHandler(ext);
+	}
+	else
+	{
+		handler = m_handlerFact->GetHandler(m_request.URI().FileExt());
+	}
+	if (NULL == handler)
+	{
+		response.StatusCode() = 404;
+		response.GetBodyStream()->Write(String("<html><body><h1>404 File not found</h1></body></html>").ToByteArray());
+	}
+	else
+	{
+		handler->ProcessRequest(m_request, response);
+	}
+
+	response.AddHeader("Connection", keepAlive ? "keep-alive" : "close");
+
+	if ( response.HasBodyFile() && response.SendBody() )
+	{
+		// Let the kernel copy the file to the socket.
+		response.WriteHeader(*m_sock->GetStream());
+		m_sock->SendFile(response.BodyFile(), response.BodyFileOffset(), response.ContentLength());
+	}
+	else
+	{
+		response.Write(*m_sock->GetStream());
+	}
+}
+
+void HttpInstance::RespondBadRequest()
+{
+	HttpResponse response;
+	response.StatusCode() = 400;
+	response.AddHeader("Connection", "close");
+	response.GetBodyStream()->Write(String("<html><body><h1>400 Bad request</h1></body></html>").ToByteArray());
+	response.Write(*m_sock->GetStream());
+}
+
 void HttpInstance::IStreamRead_OnRead(const Array<byte>& buf, int len)
 {
-	m_request.Parse(buf, len);
+	m_mtx.Lock();
+	m_lastActivity = time(NULL);
 
-	if (m_request.IsComplete())
+	try
 	{
-		HttpResponse response;
-		HttpHandler *handler = m_handlerFact->GetHandler(m_request.URI().FileExt());
-		if (NULL == handler)
+		bool complete = m_parser.Parse(buf, 0, len);
+		while ( complete && ! m_closed )
 		{
-			response.StatusCode() = 404;
-			response.GetBodyStream()->Write(String("<html><body><h1>404 File not found</h1></body></html>").ToByteArray());
+			m_requestCount++;
+			bool keepAlive = m_parser.IsKeepAlive() && m_requestCount < m_maxRequests;
+
+			m_parser.AttachTo(m_request);
+			Respond(keepAlive);
+
+			if ( ! keepAlive )
+			{
+				// Anything pipelined after this request is dropped.
+				m_closed = true;
+				m_sock->Close();
+				break;
+			}
+			complete = m_parser.Next();
 		}
-		else
+	}
+	catch ( Exception *ex )
+	{
+		if ( ! m_closed )
 		{
-			handler->ProcessRequest(m_request, response);
+			RespondBadRequest();
+			m_closed = true;
+			m_sock->Close();
 		}
-		response.Write(*m_sock->GetStream());
-		m_sock->Close();
+		delete ex;
+	}
+
+	m_mtx.Unlock();
+}
+
+bool HttpInstance::CloseIfIdle(time_t now, int idleSeconds)
+{
+	m_mtx.Lock();
+	if ( ! m_closed && m_sock->IsClosed() )
+	{
+		m_closed = true;
 	}
+	if ( ! m_closed && now - m_lastActivity >= idleSeconds )
+	{
+		m_closed = true;
+		try
+		{
+			m_sock->Shutdown();
+		}
+		catch ( SocketException *se )
+		{
+			// Already disconnected.
+			delete se;
+		}
+	}
+	bool closed = m_closed;
+	m_mtx.Unlock();
+
+	return closed;
 }
 
 void HttpInstance::IStreamRead_OnError( const String& msg )
@@ -66,12 +168,14 @@ void HttpInstance::IStreamRead_OnError( const String& msg )
 #if defined(DEBUG) || defined(_DEBUG)
 void HttpInstance::CheckMem() const
 {
+	m_parser.CheckMem();
 	m_request.CheckMem();
 	m_sock.CheckMem();
 }
 
 void HttpInstance::ValidateMem() const
 {
+	m_parser.ValidateMem();
 	m_request.ValidateMem();
 	m_sock.ValidateMem();
 }
@@ -19,6 +19,7 @@
 
 #include <spl/Int32.h>
 #include <spl/web/HttpRequest.h>
+#include <spl/web/HttpRequestParser.h>
 #include <spl/net/TcpSocket.h>
 
 using namespace spl;
@@ -30,7 +31,10 @@ HttpRequest::HttpRequest()
 	m_header(),
 	m_body(NULL),
 	m_state(HTTPREQ_STATE_METHOD),
-	m_accum(128)
+	m_accum(128),
+	m_contentLength(0),
+	m_source(NULL),
+	m_loaded(0)
 {
 }
 
@@ -41,23 +45,26 @@ HttpRequest::HttpRequest(const String& uri)
 	m_header(),
 	m_body(NULL),
 	m_state(HTTPREQ_STATE_METHOD),
-	m_accum(128)
+	m_accum(128),
+	m_contentLength(0),
+	m_source(NULL),
+	m_loaded(0)
 {
 }
 
 HttpRequest::HttpRequest(const HttpRequest& req)
-:	m_method(req.m_method),
-	m_uri(req.m_uri),
-	m_httpVersion(req.m_httpVersion),
-	m_header(req.m_header),
+:	m_method(),
+	m_uri(),
+	m_httpVersion(),
+	m_header(),
 	m_body(NULL),
-	m_state(req.m_state),
-	m_accum(req.m_accum)
+	m_state(HTTPREQ_STATE_METHOD),
+	m_accum(128),
+	m_contentLength(0),
+	m_source(NULL),
+	m_loaded(0)
 {
-	if ( NULL != req.m_body )
-	{
-		m_body = req.m_body->Clone();
-	}
+	*this = req;
 }
 
 HttpRequest::~HttpRequest()
@@ -70,12 +77,18 @@ HttpRequest::~HttpRequest()
 
 HttpRequest& HttpRequest::operator =(const HttpRequest& req)
 {
+	// A copy doesn't depend on the parser, so load everything first.
+	const_cast<HttpRequest&>(req).Need(HTTPREQ_PART_ALL);
+	m_source = NULL;
+	m_loaded = 0;
+
 	m_method = req.m_method;
 	m_uri = req.m_uri;
 	m_httpVersion = req.m_httpVersion;
 	m_header = req.m_header;
 	m_state = req.m_state;
 	m_accum = req.m_accum;
+	m_contentLength = req.m_contentLength;
 
 	if ( NULL != m_body )
 	{
@@ -93,6 +106,18 @@ HttpRequest& HttpRequest::operator =(const HttpRequest& req)
 	return *this;
 }
 
+void HttpRequest::Load(int parts)
+{
+	if ( 0 != (parts & HTTPREQ_PART_BODY) )
+	{
+		// The body type comes from Content-Type.
+		parts |= HTTPREQ_PART_HEADERS;
+	}
+	parts &= ~m_loaded;
+	m_source->CopyPart(*this, parts);
+	m_loaded |= parts;
+}
+
 bool HttpRequest::ParseLine(const byte *data, int len, int *pos)
 {
 	while ( *pos < len )
@@ -111,10 +136,53 @@ bool HttpRequest::ParseLine(const byte *data, int len, int *pos)
 	return false;
 }
 
+int HttpRequest::ParseContentLength()
+{
+	if ( ! m_header.HasHeader("Content-Length") )
+	{
+		return 0;
+	}
+
+	// Digits only, so a sign or junk can't give a negative body length.
+	String& scl = m_header.Header("Content-Length");
+	if ( 0 == scl.Length() || scl.Length() > 9 )
+	{
+		throw new Exception("Invalid Content-Length");
+	}
+	int val = 0;
+	for ( int x = 0; x < scl.Length(); x++ )
+	{
+		char ch = scl.CharAt(x);
+		if ( ch < '0' || ch > '9' )
+		{
+			throw new Exception("Invalid Content-Length");
+		}
+		val = val * 10 + (ch - '0');
+	}
+	return val;
+}
+
+void HttpRequest::CreateBody()
+{
+	if ( m_header.HasHeader("Content-Type") )
+	{
+		String& contentType = m_header.Header("Content-Type");
+		if ( contentType.Equals("application/x-www-form-urlencoded") )
+		{
+			m_body = new HttpRequestBodyFormData();
+			return;
+		}
+	}
+	m_body = new HttpRequestBodyGeneric();
+}
+
 void HttpRequest::Parse(const Array<byte>& data, int len)
 {
-	int pos = 0;
+	Parse(data, 0, len);
+}
 
+int HttpRequest::Parse(const Array<byte>& data, int pos, int len)
+{
 	while ( pos < len )
 	{
 		switch ( m_state )
@@ -130,6 +198,11 @@ void HttpRequest::Parse(const Array<byte>& data, int len)
 					m_state = HTTPREQ_STATE_URI;
 					break;
 				}
+				if ( m_accum.Length() == 0 && (ch == '\r' || ch == '\n') )
+				{
+					// Tolerate a CRLF between pipelined requests (RFC 2616 4.1).
+					continue;
+				}
 				m_accum.Append( ch );
 				if ( m_accum.Length() > 6 )
 				{
@@ -169,7 +242,8 @@ void HttpRequest::Parse(const Array<byte>& data, int len)
 			{
 				if ( m_accum.Length() == 0 )
 				{
-					m_state = HTTPREQ_STATE_BODY;
+					m_contentLength = ParseContentLength();
+					m_state = (0 == m_contentLength) ? HTTPREQ_STATE_COMPLETE : HTTPREQ_STATE_BODY;
 					break;
 				}
 				m_header.ParseLine(m_accum.ToString());
@@ -178,79 +252,87 @@ void HttpRequest::Parse(const Array<byte>& data, int len)
 			break;
 
 		case HTTPREQ_STATE_BODY:
-			if ( NULL == m_body )
 			{
-				if ( m_header.HasHeader("Content-Type") )
+				if ( NULL == m_body )
 				{
-					String& contentType = m_header.Header("Content-Type");
-					if ( contentType.Equals("application/x-www-form-urlencoded") )
-					{
-						m_body = new HttpRequestBodyFormData();
-					}
-					else
-					{
-						m_body = new HttpRequestBodyGeneric();
-					}
+					CreateBody();
 				}
-				else
+
+				// Only take this request's bytes, the rest may be a pipelined request.
+				int count = m_contentLength - m_body->ByteCount();
+				if ( count > len - pos )
 				{
-					m_body = new HttpRequestBodyGeneric();
+					count = len - pos;
 				}
-			}
-			int contentLen;
-			if ( m_header.HasHeader("Content-Length") )
-			{
-				String& scl = m_header.Header("Content-Length");
-				ASSERT( Int32::IsInt(scl) );
-				contentLen = Int32::Parse(scl);
-			}
-			else
-			{
-				contentLen = 0;
-			}
+				m_body->Parse( data, pos, count, m_contentLength );
+				pos += count;
 
-			m_body->Parse( data, pos, len - pos, contentLen );
-			pos = len;
+				if ( m_body->ByteCount() >= m_contentLength )
+				{
+					m_state = HTTPREQ_STATE_COMPLETE;
+				}
+			}
 			break;
 
+		case HTTPREQ_STATE_COMPLETE:
+			return pos;
+
 		default:
 			throw new Exception("HttpRequest::Parse: corrupted state.");
 		}
 	}
+
+	return pos;
 }
 
 bool HttpRequest::IsComplete()
 {
-	if ( m_header.Count() == 0 )
-	{
-		return false;
-	}
+	return HTTPREQ_STATE_COMPLETE == m_state;
+}
 
-	int contentLen;
-	if ( m_header.HasHeader("Content-Length") )
-	{
-		String& scl = m_header.Header("Content-Length");
-		ASSERT( Int32::IsInt(scl) );
-		contentLen = Int32::Parse(scl);
-	}
-	else
+void HttpRequest::Reset()
+{
+	m_method = "GET";
+	m_uri = Uri();
+	m_httpVersion = "HTTP/1.0";
+	m_header.Clear();
+	if ( NULL != m_body )
 	{
-		contentLen = 0;
+		delete m_body;
+		m_body = NULL;
 	}
+	m_state = HTTPREQ_STATE_METHOD;
+	m_accum.SetLength(0);
+	m_contentLength = 0;
+	m_source = NULL;
+	m_loaded = 0;
+}
 
-	if ( NULL != m_body && contentLen > 0 )
+bool HttpRequest::IsKeepAlive()
+{
+	if ( NULL != m_source && 0 == (m_loaded & HTTPREQ_PART_HEADERS) )
 	{
-		return m_body->ByteCount() >= contentLen;
+		return m_source->IsKeepAlive();
 	}
-	else
+	if ( m_header.HasHeader("Connection") )
 	{
-		// request does not have a content lenth, should check Transfer-Encoding and media type "multipart/byteranges".
-		return m_state == HTTPREQ_STATE_BODY;
+		String& con = m_header.Header("Connection");
+		if ( con.EqualsIgnoreCase("close") )
+		{
+			return false;
+		}
+		if ( con.EqualsIgnoreCase("keep-alive") )
+		{
+			return true;
+		}
 	}
+	Need(HTTPREQ_PART_VERSION);
+	return m_httpVersion.Equals("HTTP/1.1");
 }
 
 HttpResponse *HttpRequest::Send()
 {
+	Need(HTTPREQ_PART_ALL);
 	HttpResponse *resp = new HttpResponse();
 	
 	try
@@ -292,6 +374,7 @@ HttpResponse *HttpRequest::Send()
 
 StringPtr HttpRequest::ToString() const
 {
+	const_cast<HttpRequest *>(this)->Need(HTTPREQ_PART_ALL);
 	StringBuffer buf;
 
 	buf.Append( m_method );
@@ -314,7 +397,9 @@ StringPtr HttpRequest::ToString() const
 void HttpRequest::ValidateMem() const
 {
 	m_method.ValidateMem();
+	m_uri.ValidateMem();
 	m_httpVersion.ValidateMem();
+	m_header.ValidateMem();
 	m_accum.ValidateMem();
 
 	if ( NULL != m_body )
@@ -327,7 +412,9 @@ void HttpRequest::ValidateMem() const
 void HttpRequest::CheckMem() const
 {
 	m_method.CheckMem();
+	m_uri.CheckMem();
 	m_httpVersion.CheckMem();
+	m_header.CheckMem();
 	m_accum.CheckMem();
 
 	if ( NULL != m_body )
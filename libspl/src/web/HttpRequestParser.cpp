@@ -0,0 +1,714 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+// RFC 7230 https://tools.ietf.org/html/rfc7230
+
+#include <ctype.h>
+#include <spl/Exception.h>
+#include <spl/Int32.h>
+#include <spl/web/HttpRequestParser.h>
+
+using namespace spl;
+
+// Indexed by HttpHeaderId.
+static const char *_httpHeaderNames[HTTP_HDR_COUNT] = 
+{
+	"",
+	"Accept",
+	"Accept-Encoding",
+	"Accept-Language",
+	"Authorization",
+	"Connection",
+	"Content-Length",
+	"Content-Type",
+	"Cookie",
+	"Expect",
+	"Host",
+	"If-Modified-Since",
+	"If-None-Match",
+	"If-Range",
+	"Range",
+	"Referer",
+	"Transfer-Encoding",
+	"User-Agent"
+};
+
+static int _httpHeaderNameLens[HTTP_HDR_COUNT] = 
+{
+	0, 6, 15, 15, 13, 10, 14, 12, 6, 6, 4, 17, 13, 8, 5, 7, 17, 10
+};
+
+static bool _EqualsIgnoreCase(const char *a, const char *b, int len)
+{
+	for ( int x = 0; x < len; x++ )
+	{
+		if ( tolower(a[x]) != tolower(b[x]) )
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+enum HttpHeaderId HttpRequestParser::HeaderId( const char *name, int len )
+{
+	// The table is short, and most entries are rejected on length.
+	for ( int x = 1; x < HTTP_HDR_COUNT; x++ )
+	{
+		if ( _httpHeaderNameLens[x] == len && _EqualsIgnoreCase(name, _httpHeaderNames[x], len) )
+		{
+			return (enum HttpHeaderId)x;
+		}
+	}
+	return HTTP_HDR_UNKNOWN;
+}
+
+const char *HttpRequestParser::HeaderIdName( enum HttpHeaderId id )
+{
+	return _httpHeaderNames[id];
+}
+
+HttpRequestParser::HttpRequestParser( int maxRequestBytes )
+:	m_buf(HTTP_PARSER_INITIAL_BUFFER), 
+	m_len(0), 
+	m_scan(0), 
+	m_end(0), 
+	m_maxRequestBytes(maxRequestBytes), 
+	m_state(HTTPPARSE_STATE_REQUEST_LINE), 
+	m_method(), 
+	m_uri(), 
+	m_version(), 
+	m_headers(HTTP_PARSER_MAX_HEADERS), 
+	m_headerCount(0), 
+	m_contentLength(0), 
+	m_chunked(false), 
+	m_chunkRemaining(0), 
+	m_bodyOffset(0), 
+	m_bodyLen(0)
+{
+#ifdef DEBUG
+	for ( int x = 0; x < HTTP_HDR_COUNT; x++ )
+	{
+		ASSERT( _httpHeaderNameLens[x] == (int)strlen(_httpHeaderNames[x]) );
+	}
+#endif
+	Clear();
+}
+
+HttpRequestParser::~HttpRequestParser()
+{
+}
+
+void HttpRequestParser::Clear()
+{
+	m_scan = 0;
+	m_end = 0;
+	m_state = HTTPPARSE_STATE_REQUEST_LINE;
+	m_method = HttpSlice();
+	m_uri = HttpSlice();
+	m_version = HttpSlice();
+	m_headerCount = 0;
+	for ( int x = 0; x < HTTP_HDR_COUNT; x++ )
+	{
+		m_known[x] = -1;
+	}
+	m_contentLength = 0;
+	m_chunked = false;
+	m_chunkRemaining = 0;
+	m_bodyOffset = 0;
+	m_bodyLen = 0;
+}
+
+void HttpRequestParser::Reset()
+{
+	m_len = 0;
+	Clear();
+}
+
+void HttpRequestParser::Append( const byte *data, int len )
+{
+	if ( m_len + len > m_maxRequestBytes )
+	{
+		throw new Exception("HTTP request too large");
+	}
+
+	if ( m_len + len > m_buf.Length() )
+	{
+		int size = m_buf.Length() * 2;
+		while ( size < m_len + len )
+		{
+			size *= 2;
+		}
+		Array<byte> buf(size);
+		Array<byte>::CopyBinary(m_buf, 0, buf, 0, m_len);
+		m_buf = buf;
+	}
+
+	memcpy(&m_buf.Data()[m_len], data, len);
+	m_len += len;
+}
+
+bool HttpRequestParser::Parse( const Array<byte>& data, int pos, int len )
+{
+	ASSERT( pos <= len && len <= data.Length() );
+	Append( &data.Data()[pos], len - pos );
+	if ( ! IsComplete() )
+	{
+		Run();
+	}
+	return IsComplete();
+}
+
+bool HttpRequestParser::Next()
+{
+	ASSERT( IsComplete() );
+
+	int pending = m_len - m_end;
+	if ( pending > 0 )
+	{
+		memmove(m_buf.Data(), &m_buf.Data()[m_end], pending);
+	}
+	m_len = pending;
+	Clear();
+
+	if ( m_len > 0 )
+	{
+		Run();
+	}
+	return IsComplete();
+}
+
+bool HttpRequestParser::FindLine( int *lineStart, int *lineLen )
+{
+	const byte *buf = m_buf.Data();
+	const byte *nl = (const byte *)memchr(&buf[m_scan], '\n', m_len - m_scan);
+	if ( NULL == nl )
+	{
+		// Requests start at the front of the buffer, so m_len is at least the header size.
+		if ( m_len > HTTP_PARSER_MAX_HEADER_BYTES && HTTPPARSE_STATE_BODY > m_state )
+		{
+			throw new Exception("HTTP request header too large");
+		}
+		return false;
+	}
+
+	int end = (int)(nl - buf);
+	if ( end > HTTP_PARSER_MAX_HEADER_BYTES && HTTPPARSE_STATE_BODY > m_state )
+	{
+		throw new Exception("HTTP request header too large");
+	}
+	*lineStart = m_scan;
+	*lineLen = end - m_scan;
+	if ( *lineLen > 0 && '\r' == buf[end - 1] )
+	{
+		(*lineLen)--;
+	}
+	m_scan = end + 1;
+	return true;
+}
+
+void HttpRequestParser::ParseRequestLine( int start, int len )
+{
+	const char *cp = (const char *)&m_buf.Data()[start];
+
+	int sp1 = IndexofchfromWithLen(cp, ' ', 0, len);
+	int sp2 = (0 > sp1) ? -1 : IndexofchfromWithLen(cp, ' ', sp1 + 1, len);
+	if ( 0 >= sp1 || sp2 <= sp1 + 1 || sp2 + 1 >= len )
+	{
+		throw new Exception("Invalid HTTP request line");
+	}
+
+	m_method = HttpSlice(start, sp1);
+	m_uri = HttpSlice(start + sp1 + 1, sp2 - sp1 - 1);
+	m_version = HttpSlice(start + sp2 + 1, len - sp2 - 1);
+
+	if ( 8 != m_version.m_len || ! _EqualsIgnoreCase(Chars(m_version), "HTTP/1.", 7) )
+	{
+		throw new Exception("Unsupported HTTP version");
+	}
+}
+
+void HttpRequestParser::ParseHeaderLine( int start, int len )
+{
+	const char *cp = (const char *)&m_buf.Data()[start];
+
+	if ( ' ' == cp[0] || '\t' == cp[0] )
+	{
+		// Obsolete line folding, which RFC 7230 3.2.4 allows a server to reject.
+		throw new Exception("Folded HTTP header");
+	}
+	if ( m_headerCount >= m_headers.Length() )
+	{
+		throw new Exception("Too many HTTP headers");
+	}
+
+	int colon = IndexofchfromWithLen(cp, ':', 0, len);
+	if ( 0 >= colon || ' ' == cp[colon - 1] || '\t' == cp[colon - 1] )
+	{
+		throw new Exception("Invalid HTTP header");
+	}
+
+	int valStart = colon + 1;
+	int valEnd = len;
+	while ( valStart < valEnd && (' ' == cp[valStart] || '\t' == cp[valStart]) )
+	{
+		valStart++;
+	}
+	while ( valEnd > valStart && (' ' == cp[valEnd - 1] || '\t' == cp[valEnd - 1]) )
+	{
+		valEnd--;
+	}
+
+	HttpHeaderSlice& hdr = m_headers[m_headerCount];
+	hdr.m_name = HttpSlice(start, colon);
+	hdr.m_value = HttpSlice(start + valStart, valEnd - valStart);
+	hdr.m_id = HeaderId(cp, colon);
+
+	if ( HTTP_HDR_UNKNOWN != hdr.m_id && 0 > m_known[hdr.m_id] )
+	{
+		m_known[hdr.m_id] = m_headerCount;
+	}
+	m_headerCount++;
+}
+
+void HttpRequestParser::EndOfHeaders()
+{
+	if ( HasHeader(HTTP_HDR_TRANSFER_ENCODING) )
+	{
+		// A request with both is a smuggling attempt (RFC 7230 3.3.3).
+		if ( HasHeader(HTTP_HDR_CONTENT_LENGTH) )
+		{
+			throw new Exception("HTTP request has both Transfer-Encoding and Content-Length");
+		}
+
+		// chunked has to be the last coding, or the body can't be delimited.
+		const HttpSlice& te = m_headers[m_known[HTTP_HDR_TRANSFER_ENCODING]].m_value;
+		if ( te.m_len < 7 || ! _EqualsIgnoreCase(Chars(te) + te.m_len - 7, "chunked", 7) )
+		{
+			throw new Exception("Unsupported Transfer-Encoding");
+		}
+		m_chunked = true;
+		m_bodyOffset = m_scan;
+		m_state = HTTPPARSE_STATE_CHUNK_SIZE;
+		return;
+	}
+
+	if ( HasHeader(HTTP_HDR_CONTENT_LENGTH) )
+	{
+		m_contentLength = 0;
+		for ( int x = 0; x < m_headerCount; x++ )
+		{
+			if ( HTTP_HDR_CONTENT_LENGTH != m_headers[x].m_id )
+			{
+				continue;
+			}
+
+			const HttpSlice& cl = m_headers[x].m_value;
+			const char *cp = Chars(cl);
+			if ( 0 == cl.m_len || cl.m_len > 10 )
+			{
+				throw new Exception("Invalid Content-Length");
+			}
+			long val = 0;
+			for ( int y = 0; y < cl.m_len; y++ )
+			{
+				if ( ! isdigit(cp[y]) )
+				{
+					throw new Exception("Invalid Content-Length");
+				}
+				val = val * 10 + (cp[y] - '0');
+			}
+			if ( x != m_known[HTTP_HDR_CONTENT_LENGTH] && val != m_contentLength )
+			{
+				throw new Exception("Conflicting Content-Length headers");
+			}
+			m_contentLength = val;
+		}
+		if ( m_contentLength > m_maxRequestBytes )
+		{
+			throw new Exception("HTTP request too large");
+		}
+	}
+
+	m_bodyOffset = m_scan;
+	m_state = (0 == m_contentLength) ? HTTPPARSE_STATE_COMPLETE : HTTPPARSE_STATE_BODY;
+	if ( HTTPPARSE_STATE_COMPLETE == m_state )
+	{
+		m_end = m_scan;
+	}
+}
+
+void HttpRequestParser::Run()
+{
+	int lineStart;
+	int lineLen;
+
+	while ( true )
+	{
+		switch ( m_state )
+		{
+		case HTTPPARSE_STATE_REQUEST_LINE:
+			if ( ! FindLine(&lineStart, &lineLen) )
+			{
+				return;
+			}
+			if ( 0 == lineLen )
+			{
+				// Tolerate a CRLF between pipelined requests (RFC 7230 3.5).
+				break;
+			}
+			ParseRequestLine(lineStart, lineLen);
+			m_state = HTTPPARSE_STATE_HEADERS;
+			break;
+
+		case HTTPPARSE_STATE_HEADERS:
+			if ( ! FindLine(&lineStart, &lineLen) )
+			{
+				return;
+			}
+			if ( 0 == lineLen )
+			{
+				EndOfHeaders();
+				break;
+			}
+			ParseHeaderLine(lineStart, lineLen);
+			break;
+
+		case HTTPPARSE_STATE_BODY:
+			if ( m_len - m_bodyOffset < m_contentLength )
+			{
+				m_scan = m_len;
+				return;
+			}
+			m_bodyLen = (int)m_contentLength;
+			m_end = m_scan = m_bodyOffset + m_bodyLen;
+			m_state = HTTPPARSE_STATE_COMPLETE;
+			break;
+
+		case HTTPPARSE_STATE_CHUNK_SIZE:
+			{
+				if ( ! FindLine(&lineStart, &lineLen) )
+				{
+					return;
+				}
+				const char *cp = (const char *)&m_buf.Data()[lineStart];
+				long size = 0;
+				int x;
+				for ( x = 0; x < lineLen && isxdigit(cp[x]); x++ )
+				{
+					if ( x >= 7 )
+					{
+						throw new Exception("HTTP chunk too large");
+					}
+					size = size * 16 + (isdigit(cp[x]) ? cp[x] - '0' : tolower(cp[x]) - 'a' + 10);
+				}
+				// Chunk extensions after ';' are ignored.
+				if ( 0 == x || (x < lineLen && ';' != cp[x] && ' ' != cp[x] && '\t' != cp[x]) )
+				{
+					throw new Exception("Invalid HTTP chunk size");
+				}
+				if ( m_bodyLen + size > m_maxRequestBytes )
+				{
+					throw new Exception("HTTP request too large");
+				}
+				m_chunkRemaining = size;
+				m_state = (0 == size) ? HTTPPARSE_STATE_TRAILERS : HTTPPARSE_STATE_CHUNK_DATA;
+			}
+			break;
+
+		case HTTPPARSE_STATE_CHUNK_DATA:
+			{
+				// Move the data down over the chunk headers, so the body ends up contiguous.
+				int count = m_len - m_scan;
+				if ( count > m_chunkRemaining )
+				{
+					count = (int)m_chunkRemaining;
+				}
+				byte *buf = m_buf.Data();
+				memmove(&buf[m_bodyOffset + m_bodyLen], &buf[m_scan], count);
+				m_bodyLen += count;
+				m_scan += count;
+				m_chunkRemaining -= count;
+				if ( 0 < m_chunkRemaining )
+				{
+					return;
+				}
+				m_state = HTTPPARSE_STATE_CHUNK_END;
+			}
+			break;
+
+		case HTTPPARSE_STATE_CHUNK_END:
+			if ( ! FindLine(&lineStart, &lineLen) )
+			{
+				return;
+			}
+			if ( 0 != lineLen )
+			{
+				throw new Exception("Missing CRLF after HTTP chunk");
+			}
+			m_state = HTTPPARSE_STATE_CHUNK_SIZE;
+			break;
+
+		case HTTPPARSE_STATE_TRAILERS:
+			// Trailer fields are read and dropped.
+			if ( ! FindLine(&lineStart, &lineLen) )
+			{
+				return;
+			}
+			if ( 0 == lineLen )
+			{
+				m_end = m_scan;
+				m_state = HTTPPARSE_STATE_COMPLETE;
+			}
+			break;
+
+		case HTTPPARSE_STATE_COMPLETE:
+			return;
+
+		default:
+			throw new Exception("HttpRequestParser: corrupted state.");
+		}
+	}
+}
+
+bool HttpRequestParser::SliceEquals( const HttpSlice& s, const char *cp ) const
+{
+	int len = (int)strlen(cp);
+	return len == s.m_len && 0 == memcmp(Chars(s), cp, len);
+}
+
+bool HttpRequestParser::SliceContainsToken( const HttpSlice& s, const char *token ) const
+{
+	const char *cp = Chars(s);
+	int tlen = (int)strlen(token);
+	int pos = 0;
+
+	// Comma separated list, e.g. Connection: keep-alive, Upgrade
+	while ( pos < s.m_len )
+	{
+		while ( pos < s.m_len && (' ' == cp[pos] || '\t' == cp[pos] || ',' == cp[pos]) )
+		{
+			pos++;
+		}
+		int start = pos;
+		while ( pos < s.m_len && ',' != cp[pos] )
+		{
+			pos++;
+		}
+		int end = pos;
+		while ( end > start && (' ' == cp[end - 1] || '\t' == cp[end - 1]) )
+		{
+			end--;
+		}
+		if ( end - start == tlen && _EqualsIgnoreCase(&cp[start], token, tlen) )
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool HttpRequestParser::HeaderEquals( enum HttpHeaderId id, const char *value ) const
+{
+	if ( ! HasHeader(id) )
+	{
+		return false;
+	}
+	const HttpSlice& s = m_headers[m_known[id]].m_value;
+	int len = (int)strlen(value);
+	return len == s.m_len && _EqualsIgnoreCase(Chars(s), value, len);
+}
+
+bool HttpRequestParser::IsKeepAlive() const
+{
+	if ( HasHeader(HTTP_HDR_CONNECTION) )
+	{
+		const HttpSlice& con = m_headers[m_known[HTTP_HDR_CONNECTION]].m_value;
+		if ( SliceContainsToken(con, "close") )
+		{
+			return false;
+		}
+		if ( SliceContainsToken(con, "keep-alive") )
+		{
+			return true;
+		}
+	}
+	return IsVersion("HTTP/1.1");
+}
+
+StringPtr HttpRequestParser::Header( enum HttpHeaderId id ) const
+{
+	if ( ! HasHeader(id) )
+	{
+		return StringPtr(new String());
+	}
+	return ToString(m_headers[m_known[id]].m_value);
+}
+
+StringPtr HttpRequestParser::Header( const String& name ) const
+{
+	for ( int x = 0; x < m_headerCount; x++ )
+	{
+		const HttpSlice& n = m_headers[x].m_name;
+		if ( n.m_len == name.Length() && _EqualsIgnoreCase(Chars(n), name.GetChars(), n.m_len) )
+		{
+			return ToString(m_headers[x].m_value);
+		}
+	}
+	return StringPtr(new String());
+}
+
+bool HttpRequestParser::UriFileExt( StringView& ext ) const
+{
+	const char *cp = Chars(m_uri);
+	int len = m_uri.m_len;
+	int query = len;
+	int lastSlash = -1;
+	int dot = -1;
+
+	for ( int x = 0; x < len; x++ )
+	{
+		char ch = cp[x];
+		if ( ':' == ch )
+		{
+			return false;
+		}
+		if ( '?' == ch && query == len )
+		{
+			query = x;
+		}
+		if ( x >= query )
+		{
+			continue;
+		}
+		if ( '/' == ch || '\\' == ch )
+		{
+			lastSlash = x;
+		}
+		else if ( '.' == ch && 0 > dot )
+		{
+			dot = x;
+		}
+	}
+
+	if ( 0 > dot )
+	{
+		// No file name, or a file name without an extension.
+		ext = StringView();
+		return true;
+	}
+
+	// The extension starts after the first '.' in the file name.
+	int start = lastSlash + 1;
+	int x = start;
+	while ( x < query && '.' != cp[x] )
+	{
+		x++;
+	}
+	ext = (x < query) ? StringView(cp, x + 1, query - x - 1) : StringView();
+	return true;
+}
+
+void HttpRequestParser::CopyPart( HttpRequest& req, int parts ) const
+{
+	ASSERT( IsComplete() );
+
+	if ( 0 != (parts & HttpRequest::HTTPREQ_PART_METHOD) )
+	{
+		req.m_method = String(Chars(m_method), m_method.m_len);
+	}
+	if ( 0 != (parts & HttpRequest::HTTPREQ_PART_URI) )
+	{
+		req.m_uri.Parse(String(Chars(m_uri), m_uri.m_len));
+	}
+	if ( 0 != (parts & HttpRequest::HTTPREQ_PART_VERSION) )
+	{
+		req.m_httpVersion = String(Chars(m_version), m_version.m_len);
+	}
+
+	if ( 0 != (parts & HttpRequest::HTTPREQ_PART_HEADERS) )
+	{
+		for ( int x = 0; x < m_headerCount; x++ )
+		{
+			const HttpHeaderSlice& hdr = m_headers[x];
+			if ( m_chunked && HTTP_HDR_TRANSFER_ENCODING == hdr.m_id )
+			{
+				// Handlers see a plain body with a Content-Length.
+				continue;
+			}
+			String name(Chars(hdr.m_name), hdr.m_name.m_len);
+			if ( HTTP_HDR_COOKIE == hdr.m_id )
+			{
+				// ParseLine splits out the cookies.
+				req.m_header.ParseLine(name + ": " + String(Chars(hdr.m_value), hdr.m_value.m_len));
+			}
+			else
+			{
+				req.m_header.Header(name) = String(Chars(hdr.m_value), hdr.m_value.m_len);
+			}
+		}
+
+		if ( m_chunked )
+		{
+			req.m_header.Header(HeaderIdName(HTTP_HDR_CONTENT_LENGTH)) = *Int32::ToString(m_bodyLen);
+		}
+	}
+
+	if ( 0 != (parts & HttpRequest::HTTPREQ_PART_BODY) && m_bodyLen > 0 )
+	{
+		req.CreateBody();
+		req.m_body->Parse(m_buf, m_bodyOffset, m_bodyLen, m_bodyLen);
+	}
+}
+
+void HttpRequestParser::CopyTo( HttpRequest& req ) const
+{
+	ASSERT( IsComplete() );
+
+	req.Reset();
+	CopyPart(req, HttpRequest::HTTPREQ_PART_ALL);
+	req.m_contentLength = m_bodyLen;
+	req.m_state = HttpRequest::HTTPREQ_STATE_COMPLETE;
+}
+
+void HttpRequestParser::AttachTo( HttpRequest& req ) const
+{
+	ASSERT( IsComplete() );
+
+	if ( NULL == req.m_source || 0 != req.m_loaded )
+	{
+		// Nothing to clear if the last attached request was never looked at.
+		req.Reset();
+	}
+	req.m_source = this;
+	req.m_loaded = 0;
+	req.m_contentLength = m_bodyLen;
+	req.m_state = HttpRequest::HTTPREQ_STATE_COMPLETE;
+}
+
+#if defined(DEBUG) || defined(_DEBUG)
+void HttpRequestParser::CheckMem() const
+{
+	m_buf.CheckMem();
+	m_headers.CheckMem();
+}
+
+void HttpRequestParser::ValidateMem() const
+{
+	m_buf.ValidateMem();
+	m_headers.ValidateMem();
+}
+#endif
@@ -15,8 +15,9 @@
  *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <spl/Int32.h>
+#include <spl/Int64.h>
+#include <spl/io/File.h>
 #include <spl/web/HttpResponse.h>
-#include <spl/Int32.h>
 #include <spl/text/StringBuffer.h>
 
 using namespace spl;
@@ -26,6 +27,10 @@ HttpResponse::HttpResponse()
 	m_statusCode(200), 
 	m_header(), 
 	m_body(new MemoryStream()), 
+	m_bodyFile(), 
+	m_bodyFileOffset(0), 
+	m_bodyFileLength(0), 
+	m_sendBody(true), 
 	m_state(HTTPRES_STATE_VERSION), 
 	m_accum()
 {
@@ -36,6 +41,10 @@ HttpResponse::HttpResponse(const HttpResponse& resp)
 	m_statusCode(resp.m_statusCode), 
 	m_header(resp.m_header), 
 	m_body(new MemoryStream(*resp.m_body)), 
+	m_bodyFile(resp.m_bodyFile), 
+	m_bodyFileOffset(resp.m_bodyFileOffset), 
+	m_bodyFileLength(resp.m_bodyFileLength), 
+	m_sendBody(resp.m_sendBody), 
 	m_state(resp.m_state), 
 	m_accum()
 {
@@ -51,6 +60,10 @@ HttpResponse& HttpResponse::operator =(const HttpResponse& resp)
 	m_statusCode = resp.m_statusCode;
 	m_header = resp.m_header;
 	*m_body = *resp.m_body;
+	m_bodyFile = resp.m_bodyFile;
+	m_bodyFileOffset = resp.m_bodyFileOffset;
+	m_bodyFileLength = resp.m_bodyFileLength;
+	m_sendBody = resp.m_sendBody;
 
 	return *this;
 }
@@ -61,11 +74,22 @@ void HttpResponse::Redirect(const String& location)
 	m_header.Header("Location") = location;
 }
 
-void HttpResponse::Write( IStream& strm )
+void HttpResponse::SetBodyFile( const String& filename, long offset, long count )
+{
+	m_bodyFile = filename;
+	m_bodyFileOffset = offset;
+	m_bodyFileLength = count;
+}
+
+void HttpResponse::WriteHeader( IStream& strm )
 {
 	StringBuffer buf;
 
-	m_header.Header("Content-Length") = *Int32::ToString( ContentLength() );
+	// 304 and 204 responses never have a body.
+	if ( 304 != m_statusCode && 204 != m_statusCode )
+	{
+		m_header.Header("Content-Length") = *Int64::ToString( ContentLength() );
+	}
 
 	buf.Append( m_httpVersion );
 	buf.Append( ' ' );
@@ -76,9 +100,36 @@ void HttpResponse::Write( IStream& strm )
 	buf.Append( m_header.ToString() );
 
 	strm.Write( buf.ToByteArray() );
+}
+
+void HttpResponse::Write( IStream& strm )
+{
+	WriteHeader( strm );
+
+	if ( ! m_sendBody )
+	{
+		return;
+	}
 
 	Array<byte> bbuf(512);
 	int count;
+
+	if ( HasBodyFile() )
+	{
+		// Callers with a socket should use TcpSocket::SendFile instead.
+		IStreamPtr file = File::OpenRead( m_bodyFile );
+		file->Seek( m_bodyFileOffset, IStream::SEEK_Begin );
+
+		long remaining = m_bodyFileLength;
+		while ( remaining > 0 && (count = file->Read(bbuf, 0, remaining < bbuf.Length() ? (int)remaining : bbuf.Length())) > 0 )
+		{
+			strm.Write(bbuf, 0, count);
+			remaining -= count;
+		}
+		file->Close();
+		return;
+	}
+
 	while ( (count = m_body->Read(bbuf)) > 0 )
 	{
 		strm.Write(bbuf, 0, count);
@@ -202,6 +253,7 @@ void HttpResponse::ValidateMem() const
 	m_httpVersion.ValidateMem();
 	m_header.ValidateMem();
 	m_body.ValidateMem();
+	m_bodyFile.ValidateMem();
 }
 
 void HttpResponse::CheckMem() const
@@ -209,6 +261,7 @@ void HttpResponse::CheckMem() const
 	m_httpVersion.CheckMem();
 	m_header.CheckMem();
 	m_body.CheckMem();
+	m_bodyFile.CheckMem();
 }
 #endif
 
@@ -19,23 +19,94 @@
 
 using namespace spl;
 
-HttpServer::HttpServer(int port)
-: m_server(new SocketSetServer(this, port)), m_handlerFact()
+HttpServer::HttpServer(int port, enum ISocketService::ServiceType type, int idleTimeout, int maxRequests)
+:	m_handlerFact(), 
+	m_instances(), 
+	m_instancesMtx(), 
+	m_idleTimeout(idleTimeout), 
+	m_maxRequests(maxRequests), 
+	m_running(true), 
+	m_reapEvent(1000), 
+	m_reaper(this, &HttpServer::ReapIdle), 
+	m_server(new SocketSetServer(this, port, type))
 {
+	m_reaper.Start();
 }
 
 HttpServer::~HttpServer()
 {
+	StopReaper();
 }
 
 IStreamReadListenerPtr HttpServer::Create(TcpSocketPtr sock)
 {
-	return IStreamReadListenerPtr(new HttpInstance(sock, &m_handlerFact));
+	HttpInstancePtr instance(new HttpInstance(sock, &m_handlerFact, m_maxRequests));
+
+	m_instancesMtx.Lock();
+	m_instances.Add( instance );
+	m_instancesMtx.Unlock();
+
+	return instance;
+}
+
+void HttpServer::ReapIdle()
+{
+	while ( m_running )
+	{
+		m_reapEvent.Wait();
+
+		time_t now = time(NULL);
+		m_instancesMtx.Lock();
+		for ( int x = m_instances.Count() - 1; x >= 0; x-- )
+		{
+			if ( m_instances.ElementAt(x)->CloseIfIdle(now, m_idleTimeout) )
+			{
+				m_instances.RemoveAt(x);
+			}
+		}
+		m_instancesMtx.Unlock();
+	}
+}
+
+void HttpServer::StopReaper()
+{
+	if ( ! m_running )
+	{
+		return;
+	}
+	m_running = false;
+	m_reapEvent.Notify();
+
+	// Event::Notify() isn't sticky, so Join() could wait out its timeout.
+	while ( m_reaper.IsRunning() )
+	{
+		Thread::YYield();
+	}
+}
+
+int HttpServer::ConnectionCount()
+{
+	int count = 0;
+	m_instancesMtx.Lock();
+	for ( int x = 0; x < m_instances.Count(); x++ )
+	{
+		if ( ! m_instances.ElementAt(x)->IsClosed() )
+		{
+			count++;
+		}
+	}
+	m_instancesMtx.Unlock();
+	return count;
 }
 
 void HttpServer::Close()
 {
+	StopReaper();
 	m_server->CloseAndDelete();
+
+	m_instancesMtx.Lock();
+	m_instances.Clear();
+	m_instancesMtx.Unlock();
 }
 
 void HttpServer::Join(int timeoutms)
@@ -48,11 +119,13 @@ void HttpServer::CheckMem() const
 {
 	m_server.CheckMem();
 	m_handlerFact.CheckMem();
+	m_instances.CheckMem();
 }
 
 void HttpServer::ValidateMem() const
 {
 	m_server.ValidateMem();
 	m_handlerFact.ValidateMem();
+	m_instances.ValidateMem();
 }
 #endif
@@ -529,3 +529,105 @@ StringPtr HttpUtility::HtmlEncode (const char *cp, int len)
 	}
 	return output.ToString();
 }
+
+StringPtr HttpUtility::FormatDate (time_t t)
+{
+	static const char *days[] = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+	static const char *months[] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+
+	struct tm tm;
+#ifdef _WINDOWS
+	gmtime_s(&tm, &t);
+#else
+	gmtime_r(&t, &tm);
+#endif
+
+	// strftime() isn't used since %a and %b are locale dependent.
+	return String::Format
+	(
+		"%s, %02d %s %04d %02d:%02d:%02d GMT", 
+		days[tm.tm_wday], 
+		tm.tm_mday, 
+		months[tm.tm_mon], 
+		tm.tm_year + 1900, 
+		tm.tm_hour, 
+		tm.tm_min, 
+		tm.tm_sec
+	);
+}
+
+static bool _ParseRangeNumber(const char *cp, int len, long& val)
+{
+	if ( 0 == len || len > 18 )
+	{
+		return false;
+	}
+	val = 0;
+	for ( int x = 0; x < len; x++ )
+	{
+		if ( ! isdigit(cp[x]) )
+		{
+			return false;
+		}
+		val = val * 10 + (cp[x] - '0');
+	}
+	return true;
+}
+
+enum HttpUtility::ByteRange HttpUtility::ParseByteRange (const String& range, long size, long& offset, long& count)
+{
+	StringPtr spec = range.Trim();
+	if ( ! spec->StartsWith("bytes=") || 0 <= spec->IndexOf(',') )
+	{
+		return RANGE_NONE;
+	}
+
+	const char *cp = spec->GetChars() + 6;
+	int len = spec->Length() - 6;
+	int dash = IndexofchfromWithLen(cp, '-', 0, len);
+	if ( 0 > dash )
+	{
+		return RANGE_NONE;
+	}
+
+	long first;
+	long last;
+	bool hasFirst = _ParseRangeNumber(cp, dash, first);
+	bool hasLast = _ParseRangeNumber(cp + dash + 1, len - dash - 1, last);
+
+	if ( ! hasFirst )
+	{
+		// Suffix range, the last N bytes.
+		if ( 0 != dash || ! hasLast )
+		{
+			return RANGE_NONE;
+		}
+		if ( 0 == last || 0 == size )
+		{
+			return RANGE_UNSATISFIABLE;
+		}
+		count = last > size ? size : last;
+		offset = size - count;
+		return RANGE_SATISFIABLE;
+	}
+
+	if ( len - dash - 1 > 0 && ! hasLast )
+	{
+		return RANGE_NONE;
+	}
+	if ( hasLast && last < first )
+	{
+		return RANGE_NONE;
+	}
+	if ( first >= size )
+	{
+		return RANGE_UNSATISFIABLE;
+	}
+	if ( ! hasLast || last >= size )
+	{
+		last = size - 1;
+	}
+	offset = first;
+	count = last - first + 1;
+	return RANGE_SATISFIABLE;
+}
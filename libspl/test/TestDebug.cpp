@@ -104,12 +104,72 @@ static void memblockcheck(  )
 	Log::SWriteOkFail( "debug mem block check" );
 }
 
+static void indextest(  )
+{
+	const int count = 20000;
+	void **allocs = (void **)malloc( count * sizeof(void *) );
+	int x;
+
+	DEBUG_CHECK_POINT_HEAP();
+
+	for ( x = 0; x < count; x++ )
+	{
+		allocs[x] = malloc( 8 + x % 64 );
+	}
+	for ( x = 0; x < count; x += 97 )
+	{
+		UNIT_ASSERT_MEM("index lookup", allocs[x], 8 + x % 64);
+	}
+	// Free out of order, so blocks leave the middle of their chains.
+	for ( x = 0; x < 7; x++ )
+	{
+		for ( int y = x; y < count; y += 7 )
+		{
+			free( allocs[y] );
+		}
+	}
+	UNIT_ASSERT_CHECK_POINT("index free");
+	free( allocs );
+
+	Log::SWriteOkFail( "debug heap index" );
+}
+
+static void samplingtest(  )
+{
+	void *allocs[400];
+	int x;
+
+	DEBUG_CHECK_POINT_HEAP();
+	DEBUG_SET_SAMPLE_RATE( 4 );
+	const int line = __LINE__ + 3;
+	for ( x = 0; x < 400; x++ )
+	{
+		allocs[x] = malloc( 16 );
+	}
+	DEBUG_SET_SAMPLE_RATE( 1 );
+
+	// Each stripe tracks every fourth of its own allocations.
+	int tracked = _debugAllocSiteCount( __FILE__, line );
+	UNIT_ASSERT("sampled", tracked >= 400 / 4 - 12 && tracked <= 400 / 4);
+
+	for ( x = 0; x < 400; x++ )
+	{
+		UNIT_ASSERT_PTR("untracked", allocs[x]);
+		free( allocs[x] );
+	}
+	UNIT_ASSERT_CHECK_POINT("sampling free");
+
+	Log::SWriteOkFail( "debug heap sampling" );
+}
+
 void _testdebug(  )
 {
 	simplemalloctest(  );
 	debugmalloctest(  );
 	pointercheck(  );
 	memblockcheck(  );
+	indextest(  );
+	samplingtest(  );
 	UNIT_ASSERT_MEM_NOTED("testdebug");
 }
 
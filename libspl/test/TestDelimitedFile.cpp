@@ -17,9 +17,13 @@
 #include <spl/Debug.h>
 
 #ifdef DEBUG
+#include <spl/Int32.h>
 #include <spl/io/DelimitedFile.h>
+#include <spl/io/DelimitedFileLoader.h>
+#include <spl/io/File.h>
 #include <spl/io/log/Log.h>
 #include <spl/io/MemoryStream.h>
+#include <spl/text/StringBuffer.h>
 
 using namespace spl;
 
@@ -100,6 +104,147 @@ static void _TestDelimFile2()
 	Log::SWriteOkFail( "DelimitedFile 2" );
 }
 
+static void _WriteDelimFile(const String& filename, const String& text)
+{
+	if ( File::Exists(filename) )
+	{
+		File::Delete(filename);
+	}
+	TextWriterPtr writer = File::CreateText(filename);
+	writer->Write(text);
+	writer->Close();
+}
+
+static void _TestDelimFileLoader()
+{
+	String filename("delimload.csv");
+	_WriteDelimFile(filename, "id,name,price\r\n1,abc,2.5\r\n\r\n2,\"x, \"\"y\"\"\nz\",\n3,\"\",7,extra\n4");
+
+	DelimitedFileLoader *loader = new DelimitedFileLoader(filename, ',');
+	loader->SetHasHeader(true);
+	loader->DefineColumn("id", DbSqlType::SQL_TYPE_INT32, 4);
+	loader->DefineColumn("name", DbSqlType::SQL_TYPE_VARCHAR, 32);
+	loader->DefineColumn("price", DbSqlType::SQL_TYPE_FLOAT64, 8);
+	RecordSetPtr rs = loader->Load();
+
+	UNIT_ASSERT("row count", rs->RowCount() == 4);
+	IColumn *id = rs->GetColumn("id");
+	IColumn *name = rs->GetColumn("name");
+	IColumn *price = rs->GetColumn("price");
+	UNIT_ASSERT("id", id->GetInt32(0) == 1 && id->GetInt32(1) == 2 && id->GetInt32(2) == 3 && id->GetInt32(3) == 4);
+	UNIT_ASSERT("abc", name->GetVarchar(0)->Equals("abc"));
+	UNIT_ASSERT("quoted", name->GetVarchar(1)->Equals("x, \"y\"\nz"));
+	UNIT_ASSERT("quoted empty", !name->IsNull(2) && name->GetVarchar(2)->Length() == 0);
+	UNIT_ASSERT("missing name", name->IsNull(3));
+	UNIT_ASSERT("price", price->GetFloat64(0) == 2.5 && price->GetFloat64(2) == 7);
+	UNIT_ASSERT("empty price", price->IsNull(1));
+	UNIT_ASSERT("missing price", price->IsNull(3));
+
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	filename.CheckMem();
+	DEBUG_NOTE_MEM(loader);
+	loader->CheckMem();
+	rs.CheckMem();
+	DEBUG_DUMP_MEM_LEAKS();
+	UNIT_ASSERT_MEM_NOTED("DelimitedFileLoader 1.0");
+
+	delete loader;
+	rs.Release();
+
+	// No columns defined, so they're named from the header.
+	loader = new DelimitedFileLoader(filename, ',');
+	loader->SetHasHeader(true);
+	rs = loader->Load();
+	UNIT_ASSERT("header columns", rs->ColumnCount() == 3 && NULL != rs->GetColumn("price"));
+	UNIT_ASSERT("header rows", rs->RowCount() == 4 && rs->GetColumn("id")->GetVarchar(3)->Equals("4"));
+	delete loader;
+	rs.Release();
+
+	File::Delete(filename);
+
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
+	UNIT_ASSERT_MEM_NOTED("DelimitedFileLoader 1.1");
+	Log::SWriteOkFail( "DelimitedFileLoader 1" );
+}
+
+class _DelimBatchCounter
+{
+public:
+	int m_batches;
+	int m_rows;
+	int64 m_sum;
+
+	_DelimBatchCounter() : m_batches(0), m_rows(0), m_sum(0) {}
+
+	void OnBatch(RecordSet& rs)
+	{
+		m_batches++;
+		m_rows += rs.RowCount();
+		IColumn *id = rs.GetColumn(0);
+		for ( int x = 0; x < id->Count(); x++ )
+		{
+			m_sum += id->GetInt32(x);
+		}
+	}
+};
+
+static void _TestDelimFileLoaderChunks()
+{
+	String filename("delimchunks.csv");
+	StringBuffer csv;
+	int64 sum = 0;
+	for ( int x = 0; x < 500; x++ )
+	{
+		sum += x;
+		csv.Append(Int32::ToString(x));
+		csv.Append(0 == x % 3 ? ",\"line\n\"\"" : ",plain");
+		csv.Append(Int32::ToString(x));
+		csv.Append(0 == x % 3 ? "\"\"\"\n" : "\n");
+	}
+	_WriteDelimFile(filename, *csv.ToString());
+
+	DelimitedFileLoader *loader = new DelimitedFileLoader(filename, ',');
+	loader->DefineColumn("id", DbSqlType::SQL_TYPE_INT32, 4);
+	loader->DefineColumn("text", DbSqlType::SQL_TYPE_VARCHAR, 32);
+	loader->SetThreadCount(1);
+	RecordSetPtr serial = loader->Load();
+
+	// Small chunks put boundaries inside quoted fields.
+	loader->SetThreadCount(4);
+	loader->SetChunkSize(64);
+	RecordSetPtr parallel = loader->Load();
+
+	UNIT_ASSERT("serial rows", serial->RowCount() == 500);
+	UNIT_ASSERT("parallel rows", parallel->RowCount() == 500);
+	bool same = true;
+	for ( int x = 0; x < 500; x++ )
+	{
+		same &= serial->GetColumn(0)->GetInt32(x) == x && parallel->GetColumn(0)->GetInt32(x) == x;
+		same &= serial->GetColumn(1)->GetVarchar(x)->Equals(*parallel->GetColumn(1)->GetVarchar(x));
+	}
+	UNIT_ASSERT("serial == parallel", same);
+	UNIT_ASSERT("quoted newline", parallel->GetColumn(1)->GetVarchar(3)->Equals("line\n\"3\""));
+	UNIT_ASSERT("plain", parallel->GetColumn(1)->GetVarchar(4)->Equals("plain4"));
+
+	_DelimBatchCounter counter;
+	loader->Load(DelegateOneParameter<_DelimBatchCounter, RecordSet&>::Create(&counter, &_DelimBatchCounter::OnBatch));
+	UNIT_ASSERT("batch rows", counter.m_rows == 500 && counter.m_sum == sum);
+	UNIT_ASSERT("batches", counter.m_batches > 1);
+
+	delete loader;
+	serial.Release();
+	parallel.Release();
+	File::Delete(filename);
+
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	filename.CheckMem();
+	csv.CheckMem();
+	DEBUG_DUMP_MEM_LEAKS();
+	UNIT_ASSERT_MEM_NOTED("DelimitedFileLoader 2");
+	Log::SWriteOkFail( "DelimitedFileLoader chunks" );
+}
+
 void _TestDelimFile()
 {
 	_TestDelimFile1();
@@ -109,6 +254,14 @@ void _TestDelimFile()
 	_TestDelimFile2();
 	DEBUG_CLEAR_MEM_CHECK_POINTS();
 	DEBUG_DUMP_MEM_LEAKS();
+
+	_TestDelimFileLoader();
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
+
+	_TestDelimFileLoaderChunks();
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
 }
 
 
@@ -0,0 +1,128 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <spl/Debug.h>
+#include <spl/io/log/Log.h>
+#include <spl/io/File.h>
+#include <spl/io/log/FileAppendService.h>
+
+using namespace spl;
+
+#ifdef DEBUG
+
+static void _DeleteIfExists(const String& filename)
+{
+	if (File::Exists(filename))
+	{
+		File::Delete(filename);
+	}
+}
+
+static void _TestFileAppendServiceBatch()
+{
+	String filename("appendtest.txt");
+	_DeleteIfExists(filename);
+
+	FileAppendServicePtr svc(new FileAppendService(filename));
+	svc->SetFlushBytes(1024);
+	svc->SetFsyncPolicy(FileAppendService::FSYNC_ON_FLUSH);
+
+	for (int x = 0; x < 1000; x++)
+	{
+		svc->WriteLine(*String::Format("line %04d", x));
+	}
+	svc->Stop();
+
+	UNIT_ASSERT("Written", svc->WrittenCount() == 1000);
+	UNIT_ASSERT("Queued", svc->QueuedCount() == 0);
+	UNIT_ASSERT("Dropped", svc->DroppedCount() == 0);
+	UNIT_ASSERT("Bytes", svc->BytesWritten() == 10000);
+	UNIT_ASSERT("Batched", svc->FlushCount() > 0 && svc->FlushCount() < 1000);
+	UNIT_ASSERT("Size", File::Size(filename) == 10000);
+
+	svc->WriteLine("after stop");
+	UNIT_ASSERT("Dropped after stop", svc->DroppedCount() == 1);
+
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	filename.CheckMem();
+	svc.CheckMem();
+	DEBUG_DUMP_MEM_LEAKS();
+	UNIT_ASSERT_MEM_NOTED("FileAppendService batch");
+
+	TextReaderPtr reader(new TextReader(File::OpenText(filename)));
+	StringPtr line = reader->ReadLine();
+	UNIT_ASSERT("First line", line->Equals("line 0000"));
+	for (int x = 1; x < 1000; x++)
+	{
+		line = reader->ReadLine();
+	}
+	UNIT_ASSERT("Last line", line->Equals("line 0999"));
+	reader->Close();
+
+	File::Delete(filename);
+
+	Log::SWriteOkFail( "FileAppendService batch" );
+}
+
+static void _TestFileAppendServiceRotate()
+{
+	String filename("appendrotate.txt");
+	_DeleteIfExists(filename);
+	_DeleteIfExists("appendrotate.txt.1");
+	_DeleteIfExists("appendrotate.txt.2");
+	_DeleteIfExists("appendrotate.txt.3");
+
+	FileAppendServicePtr svc(new FileAppendService(filename));
+	svc->SetRotateBytes(1000);
+	svc->SetRotateKeep(2);
+
+	for (int x = 0; x < 500; x++)
+	{
+		svc->WriteLine(*String::Format("line %04d", x));
+	}
+	svc->Stop();
+
+	UNIT_ASSERT("Written", svc->WrittenCount() == 500);
+	UNIT_ASSERT("Rotations", svc->RotationCount() == 4);
+	UNIT_ASSERT("Current", File::Size(filename) == 1000);
+	UNIT_ASSERT("Kept 1", File::Size("appendrotate.txt.1") == 1000);
+	UNIT_ASSERT("Kept 2", File::Size("appendrotate.txt.2") == 1000);
+	UNIT_ASSERT("Oldest deleted", !File::Exists("appendrotate.txt.3"));
+
+	TextReaderPtr reader(new TextReader(File::OpenText(filename)));
+	StringPtr line = reader->ReadLine();
+	UNIT_ASSERT("Newest file", line->Equals("line 0400"));
+	reader->Close();
+
+	File::Delete(filename);
+	File::Delete("appendrotate.txt.1");
+	File::Delete("appendrotate.txt.2");
+
+	Log::SWriteOkFail( "FileAppendService rotate" );
+}
+
+void _TestFileAppendService()
+{
+	_TestFileAppendServiceBatch();
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
+
+	_TestFileAppendServiceRotate();
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
+}
+
+#endif
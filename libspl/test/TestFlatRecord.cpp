@@ -0,0 +1,209 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <spl/Debug.h>
+
+#ifdef DEBUG
+#include <math.h>
+#include <stdio.h>
+#include <spl/io/File.h>
+#include <spl/io/FlatRecord.h>
+#include <spl/io/log/Log.h>
+#include <spl/text/StringBuffer.h>
+
+using namespace spl;
+
+static FixedRecordDefPtr _MakeFlatDef()
+{
+	FixedRecordDefPtr def(new FixedRecordDef(40));
+	def->AddField("RecordType", 2, DbSqlType::SQL_TYPE_CHAR);
+	def->AddDateField("Received", 6, FIXED_FMT_MMDDYY);
+	def->AddField("Count", 5, DbSqlType::SQL_TYPE_INT32);
+	def->AddFiller(1);
+	def->AddField("Amount", 10, DbSqlType::SQL_TYPE_DECIMAL, 2);
+	def->AddField("Rate", 6, DbSqlType::SQL_TYPE_FLOAT64, 3);
+	def->AddField("Name", 10, DbSqlType::SQL_TYPE_VARCHAR);
+	return def;
+}
+
+static void _TestFlatRecordParse()
+{
+	FixedRecordDefPtr def = _MakeFlatDef();
+	UNIT_ASSERT("field count", def->FieldCount() == 7);
+	UNIT_ASSERT("ordinal", def->GetFieldOrdinal("Amount") == 4 && def->GetFieldOrdinal("Missing") == -1);
+
+	//                        RT MMDDYY Count F Amount    Rate  Name
+	const char *data = "M 12319900042 000001234N001500Smith     ";
+	FixedRecord rec = def->Parse((const byte *)data);
+
+	UNIT_ASSERT("type", rec.GetText(0).Equals("M"));
+	UNIT_ASSERT("raw", rec.GetView(0).Equals("M "));
+	Date received = rec.GetDate(1);
+	UNIT_ASSERT("date", received.Year() == 1999 && received.Month() == 12 && received.Day() == 31);
+	UNIT_ASSERT("count", rec.GetInt32(2) == 42);
+	UNIT_ASSERT("overpunch", rec.GetInt64(4) == -123 && rec.GetFloat64(4) == -123.45);
+	UNIT_ASSERT("decimal", fabs(rec.GetDecimal(4).ToDouble() + 123.45) < 1e-9);
+	UNIT_ASSERT("scale", rec.GetFloat64(5) == 1.5);
+	UNIT_ASSERT("name", rec.GetText(6).Equals("Smith"));
+
+	bool thrown = false;
+	try
+	{
+		def->AddField("TooLong", 1, DbSqlType::SQL_TYPE_CHAR);
+	}
+	catch (InvalidArgumentException *ex)
+	{
+		delete ex;
+		thrown = true;
+	}
+	UNIT_ASSERT("past end", thrown);
+
+	thrown = false;
+	const char *bad = "M 12319900X42 000001234N001500Smith     ";
+	try
+	{
+		def->Parse((const byte *)bad).GetInt32(2);
+	}
+	catch (ParseException *ex)
+	{
+		delete ex;
+		thrown = true;
+	}
+	UNIT_ASSERT("bad number", thrown);
+
+	FixedRecordDef stamp(26);
+	stamp.AddDateField("At", 26, FIXED_FMT_TIMESTAMP);
+	DateTime at = stamp.Parse((const byte *)"2009-07-04:13:45:10.000000").GetDateTime(0);
+	UNIT_ASSERT("timestamp", at.Year() == 2009 && at.Month() == 7 && at.Day() == 4 && at.Hour() == 13 && at.Minutes() == 45 && at.Seconds() == 10);
+
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	def.CheckMem();
+	stamp.CheckMem();
+	DEBUG_DUMP_MEM_LEAKS();
+	UNIT_ASSERT_MEM_NOTED("FixedRecord parse");
+	Log::SWriteOkFail( "FixedRecord parse" );
+}
+
+static void _WriteFlatFile(const String& filename, int records, const char *terminator)
+{
+	FILE *fp = fopen(filename.GetChars(), "wb");
+	for (int x = 0; x < records; x++)
+	{
+		if (0 == x % 5)
+		{
+			// Blank count, amount and date load as nulls.
+			fprintf(fp, "T 000000%16s%06d%-10s%s", "", x % 1000, "", terminator);
+		}
+		else
+		{
+			fprintf(fp, "M 070409%05d +%09d%06d%-10s%s", x, x, x % 1000, "name", terminator);
+		}
+	}
+	fclose(fp);
+}
+
+static void _TestFlatRecordFile()
+{
+	String filename("flatrecord.dat");
+	int records = 1000;
+	int64 sum = 0;
+	for (int x = 0; x < records; x++)
+	{
+		sum += 0 == x % 5 ? 0 : x;
+	}
+
+	// Packed records with no terminator.
+	_WriteFlatFile(filename, records, "");
+	FixedRecordFile *file = new FixedRecordFile(filename, _MakeFlatDef());
+	UNIT_ASSERT("packed count", file->RecordCount() == records && file->Stride() == 40);
+	UNIT_ASSERT("random access", file->Record(7).GetInt32(2) == 7);
+	delete file;
+
+	// CRLF records, loaded serially and on several threads in small chunks.
+	_WriteFlatFile(filename, records, "\r\n");
+	file = new FixedRecordFile(filename, _MakeFlatDef());
+	UNIT_ASSERT("crlf count", file->RecordCount() == records && file->Stride() == 42);
+
+	file->SetThreadCount(1);
+	RecordSetPtr serial = file->Load();
+	file->SetThreadCount(4);
+	file->SetChunkRecords(37);
+	RecordSetPtr parallel = file->Load();
+
+	UNIT_ASSERT("columns", parallel->ColumnCount() == 6);
+	UNIT_ASSERT("rows", serial->RowCount() == records && parallel->RowCount() == records);
+	IColumn *count = parallel->GetColumn("Count");
+	int64 total = 0;
+	bool same = true;
+	for (int x = 0; x < records; x++)
+	{
+		if (!count->IsNull(x))
+		{
+			total += count->GetInt32(x);
+		}
+		same &= count->IsNull(x) == serial->GetColumn("Count")->IsNull(x);
+	}
+	UNIT_ASSERT("sum", total == sum && same);
+	UNIT_ASSERT("null count", count->IsNull(0) && count->IsNull(5) && !count->IsNull(6));
+	UNIT_ASSERT("null date", parallel->GetColumn("Received")->IsNull(0));
+	UNIT_ASSERT("date", parallel->GetColumn("Received")->GetDate(1).Year() == 2009);
+	UNIT_ASSERT("amount", fabs(parallel->GetColumn("Amount")->GetDecimal(6).ToDouble() - 0.06) < 1e-9);
+	UNIT_ASSERT("rate", parallel->GetColumn("Rate")->GetFloat64(12) == 0.012);
+	UNIT_ASSERT("char", parallel->GetColumn("RecordType")->GetChar(5)->Equals("T"));
+	UNIT_ASSERT("varchar", parallel->GetColumn("Name")->GetVarchar(6)->Equals("name") && parallel->GetColumn("Name")->GetVarchar(5)->Length() == 0);
+
+	delete file;
+	serial.Release();
+	parallel.Release();
+
+	// A partial record at the end is an error.
+	FILE *fp = fopen(filename.GetChars(), "ab");
+	fputs("M 0704", fp);
+	fclose(fp);
+	bool thrown = false;
+	try
+	{
+		file = new FixedRecordFile(filename, _MakeFlatDef());
+		delete file;
+	}
+	catch (IOException *ex)
+	{
+		delete ex;
+		thrown = true;
+	}
+	UNIT_ASSERT("partial record", thrown);
+
+	File::Delete(filename);
+
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	filename.CheckMem();
+	DEBUG_DUMP_MEM_LEAKS();
+	UNIT_ASSERT_MEM_NOTED("FixedRecordFile");
+	Log::SWriteOkFail( "FixedRecordFile load" );
+}
+
+void _TestFlatRecord()
+{
+	_TestFlatRecordParse();
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
+
+	_TestFlatRecordFile();
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
+}
+
+#endif
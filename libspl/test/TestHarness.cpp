@@ -29,6 +29,8 @@ extern void TestObjectPool();
 extern void TestCommandLine();
 extern void TestStringBuffer();
 extern void TestPacket();
+extern void _TestPacketSendQueue();
+extern void _TestSocketSet();
 extern void TestTString();
 extern void TestStreams();
 extern void TestRecordSet();
@@ -49,11 +51,16 @@ extern void _TestNetwork();
 extern void _TestConfigSettings();
 extern void _TestMemoryPool();
 extern void _TestDelimFile();
+extern void _TestFlatRecord();
 extern void _TestUri();
+extern void _TestHttpRequest();
+extern void _TestHttpFileHandler();
 extern void _TestDecimal();
 extern void _TestNumeric();
 extern void _TestFile();
+extern void _TestFileAppendService();
 extern void _TestSemaphore();
+extern void _TestRingQueue();
 extern void _TestStringTokenizer();
 extern void _TestRefCountPtr();
 //extern void _TestTermCap();
@@ -202,11 +209,21 @@ void TestHarness::RunTests()
 		DEBUG_DUMP_MEM_LEAKS();
 		DEBUG_FREE_HEAP();
 
+		_TestFlatRecord();
+		DEBUG_CLEAR_MEM_CHECK_POINTS();
+		DEBUG_DUMP_MEM_LEAKS();
+		DEBUG_FREE_HEAP();
+
 		_TestFile();
 		DEBUG_CLEAR_MEM_CHECK_POINTS();
 		DEBUG_DUMP_MEM_LEAKS();
 		DEBUG_FREE_HEAP();
 
+		_TestFileAppendService();
+		DEBUG_CLEAR_MEM_CHECK_POINTS();
+		DEBUG_DUMP_MEM_LEAKS();
+		DEBUG_FREE_HEAP();
+
 		_TestPipe();
 		DEBUG_CLEAR_MEM_CHECK_POINTS();
 		DEBUG_DUMP_MEM_LEAKS();
@@ -228,11 +245,31 @@ void TestHarness::RunTests()
 		DEBUG_DUMP_MEM_LEAKS();
 		DEBUG_FREE_HEAP();
 
+		_TestPacketSendQueue();
+		DEBUG_CLEAR_MEM_CHECK_POINTS();
+		DEBUG_DUMP_MEM_LEAKS();
+		DEBUG_FREE_HEAP();
+
+		_TestSocketSet();
+		DEBUG_CLEAR_MEM_CHECK_POINTS();
+		DEBUG_DUMP_MEM_LEAKS();
+		DEBUG_FREE_HEAP();
+
 		_TestUri();
 		DEBUG_CLEAR_MEM_CHECK_POINTS();
 		DEBUG_DUMP_MEM_LEAKS();
 		DEBUG_FREE_HEAP();
 
+		_TestHttpRequest();
+		DEBUG_CLEAR_MEM_CHECK_POINTS();
+		DEBUG_DUMP_MEM_LEAKS();
+		DEBUG_FREE_HEAP();
+
+		_TestHttpFileHandler();
+		DEBUG_CLEAR_MEM_CHECK_POINTS();
+		DEBUG_DUMP_MEM_LEAKS();
+		DEBUG_FREE_HEAP();
+
 		_TestDesStream();
 		DEBUG_CLEAR_MEM_CHECK_POINTS();
 		DEBUG_DUMP_MEM_LEAKS();
@@ -278,6 +315,11 @@ void TestHarness::RunTests()
 		DEBUG_DUMP_MEM_LEAKS();
 		DEBUG_FREE_HEAP();
 
+		_TestRingQueue();
+		DEBUG_CLEAR_MEM_CHECK_POINTS();
+		DEBUG_DUMP_MEM_LEAKS();
+		DEBUG_FREE_HEAP();
+
 		_TestRegex();
 		DEBUG_CLEAR_MEM_CHECK_POINTS();
 		DEBUG_DUMP_MEM_LEAKS();
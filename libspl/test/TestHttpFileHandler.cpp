@@ -0,0 +1,201 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <spl/Debug.h>
+
+#ifdef DEBUG
+#include <spl/io/File.h>
+#include <spl/io/log/Log.h>
+#include <spl/io/MemoryStream.h>
+#include <spl/web/HttpUtility.h>
+#include <spl/web/server/HttpFileHandler.h>
+
+using namespace spl;
+
+static void _TestHttpFileHandlerRange()
+{
+	long offset = -1;
+	long count = -1;
+
+	UNIT_ASSERT("first-last", HttpUtility::RANGE_SATISFIABLE == HttpUtility::ParseByteRange("bytes=0-99", 1000, offset, count));
+	UNIT_ASSERT("first-last values", 0 == offset && 100 == count);
+	UNIT_ASSERT("first-", HttpUtility::RANGE_SATISFIABLE == HttpUtility::ParseByteRange("bytes=900-", 1000, offset, count));
+	UNIT_ASSERT("first- values", 900 == offset && 100 == count);
+	UNIT_ASSERT("suffix", HttpUtility::RANGE_SATISFIABLE == HttpUtility::ParseByteRange("bytes=-10", 1000, offset, count));
+	UNIT_ASSERT("suffix values", 990 == offset && 10 == count);
+	UNIT_ASSERT("suffix too long", HttpUtility::RANGE_SATISFIABLE == HttpUtility::ParseByteRange("bytes=-5000", 1000, offset, count));
+	UNIT_ASSERT("suffix too long values", 0 == offset && 1000 == count);
+	UNIT_ASSERT("last clipped", HttpUtility::RANGE_SATISFIABLE == HttpUtility::ParseByteRange("bytes=500-5000", 1000, offset, count));
+	UNIT_ASSERT("last clipped values", 500 == offset && 500 == count);
+	UNIT_ASSERT("past end", HttpUtility::RANGE_UNSATISFIABLE == HttpUtility::ParseByteRange("bytes=1000-", 1000, offset, count));
+	UNIT_ASSERT("multiple", HttpUtility::RANGE_NONE == HttpUtility::ParseByteRange("bytes=0-1,5-6", 1000, offset, count));
+	UNIT_ASSERT("units", HttpUtility::RANGE_NONE == HttpUtility::ParseByteRange("items=0-1", 1000, offset, count));
+	UNIT_ASSERT("reversed", HttpUtility::RANGE_NONE == HttpUtility::ParseByteRange("bytes=9-1", 1000, offset, count));
+	UNIT_ASSERT("junk", HttpUtility::RANGE_NONE == HttpUtility::ParseByteRange("bytes=a-b", 1000, offset, count));
+
+	UNIT_ASSERT("date", HttpUtility::FormatDate(0)->Equals("Thu, 01 Jan 1970 00:00:00 GMT"));
+	UNIT_ASSERT("date 2", HttpUtility::FormatDate(1234567890)->Equals("Fri, 13 Feb 2009 23:31:30 GMT"));
+
+	Log::SWriteOkFail( "HttpUtility ranges" );
+}
+
+static void _ParseRequest(HttpRequest& req, const char *text)
+{
+	Array<byte> buf((const byte *)text, (int)strlen(text));
+	req.Parse(buf, 0, buf.Length());
+	UNIT_ASSERT("request complete", req.IsComplete());
+}
+
+static void _TestHttpFileHandlerGet()
+{
+	const char *fileName = "_httpfiletest.bin";
+
+	Array<byte> content(300);
+	for ( int x = 0; x < content.Length(); x++ )
+	{
+		content[x] = (byte)x;
+	}
+	IStreamPtr out = File::Create(fileName);
+	out->Write(content);
+	out->Close();
+
+	FileHandlerBase handler("application/octet-stream");
+
+	{
+		HttpRequest req;
+		HttpResponse res;
+		_ParseRequest(req, "GET /_httpfiletest.bin HTTP/1.1\r\n\r\n");
+		handler.ProcessRequest(req, res);
+		UNIT_ASSERT("200", 200 == res.StatusCode());
+		UNIT_ASSERT("sendfile", res.HasBodyFile() && 300 == res.ContentLength() && 0 == res.BodyFileOffset());
+		UNIT_ASSERT("etag", res.Headers().HasHeader("ETag"));
+		UNIT_ASSERT("last modified", res.Headers().HasHeader("Last-Modified"));
+
+		// Binary content written through the stream fallback.
+		MemoryStream ms;
+		res.Write(ms);
+		UNIT_ASSERT("written", ms.Length() > 300);
+	}
+
+	StringPtr etag;
+	{
+		HttpRequest req;
+		HttpResponse res;
+		_ParseRequest(req, "GET /_httpfiletest.bin HTTP/1.1\r\nRange: bytes=-10\r\n\r\n");
+		handler.ProcessRequest(req, res);
+		UNIT_ASSERT("206", 206 == res.StatusCode());
+		UNIT_ASSERT("range", res.HasBodyFile() && 10 == res.ContentLength() && 290 == res.BodyFileOffset());
+		UNIT_ASSERT("content-range", res.Headers().Header("Content-Range").Equals("bytes 290-299/300"));
+		etag = StringPtr(new String(res.Headers().Header("ETag")));
+	}
+
+	{
+		HttpRequest req;
+		HttpResponse res;
+		_ParseRequest(req, "HEAD /_httpfiletest.bin HTTP/1.1\r\nRange: bytes=300-\r\n\r\n");
+		handler.ProcessRequest(req, res);
+		UNIT_ASSERT("416", 416 == res.StatusCode());
+		UNIT_ASSERT("416 content-range", res.Headers().Header("Content-Range").Equals("bytes */300"));
+	}
+
+	{
+		HttpRequest req;
+		HttpResponse res;
+		String text("GET /_httpfiletest.bin HTTP/1.1\r\nIf-None-Match: " + *etag + "\r\n\r\n");
+		_ParseRequest(req, text.GetChars());
+		handler.ProcessRequest(req, res);
+		UNIT_ASSERT("304", 304 == res.StatusCode() && ! res.SendBody());
+	}
+
+	handler.EnableCache(1024, 512);
+	for ( int x = 0; x < 2; x++ )
+	{
+		HttpRequest req;
+		HttpResponse res;
+		_ParseRequest(req, "GET /_httpfiletest.bin HTTP/1.1\r\nRange: bytes=1-2\r\n\r\n");
+		handler.ProcessRequest(req, res);
+		UNIT_ASSERT("cached 206", 206 == res.StatusCode());
+		UNIT_ASSERT("cached body", ! res.HasBodyFile() && 2 == res.ContentLength());
+	}
+	UNIT_ASSERT("cache count", 1 == handler.Cache()->Count() && 300 == handler.Cache()->Bytes());
+	UNIT_ASSERT("cache hits", 1 == handler.Cache()->HitCount() && 1 == handler.Cache()->MissCount());
+
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	handler.CheckMem();
+	content.CheckMem();
+	out.CheckMem();
+	etag.CheckMem();
+	DEBUG_DUMP_MEM_LEAKS();
+	UNIT_ASSERT_MEM_NOTED("FileHandlerBase");
+
+	File::Delete(fileName);
+
+	Log::SWriteOkFail( "FileHandlerBase GET" );
+}
+
+static void _TestHttpFileCacheEvict()
+{
+	const char *names[] = { "_httpcache1.bin", "_httpcache2.bin", "_httpcache3.bin" };
+	Array<byte> content(100);
+
+	for ( int x = 0; x < 3; x++ )
+	{
+		IStreamPtr out = File::Create(names[x]);
+		out->Write(content);
+		out->Close();
+	}
+
+	HttpFileCache cache(250, 200);
+	UNIT_ASSERT("too big", cache.Get(names[0], 1, 201).IsNull());
+	UNIT_ASSERT("load 1", cache.Get(names[0], 1, 100).IsNotNull());
+	UNIT_ASSERT("load 2", cache.Get(names[1], 1, 100).IsNotNull());
+	UNIT_ASSERT("hit 1", cache.Get(names[0], 1, 100).IsNotNull());
+	UNIT_ASSERT("load 3", cache.Get(names[2], 1, 100).IsNotNull());
+	UNIT_ASSERT("evicted", 2 == cache.Count() && 200 == cache.Bytes());
+	UNIT_ASSERT("lru", 3 == cache.MissCount() && 1 == cache.HitCount());
+	UNIT_ASSERT("hit 1 again", cache.Get(names[0], 1, 100).IsNotNull() && 2 == cache.HitCount());
+	UNIT_ASSERT("mtime changed", cache.Get(names[0], 2, 100).IsNotNull() && 4 == cache.MissCount());
+
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	cache.CheckMem();
+	content.CheckMem();
+	DEBUG_DUMP_MEM_LEAKS();
+	UNIT_ASSERT_MEM_NOTED("HttpFileCache");
+
+	for ( int x = 0; x < 3; x++ )
+	{
+		File::Delete(names[x]);
+	}
+
+	Log::SWriteOkFail( "HttpFileCache evict" );
+}
+
+void _TestHttpFileHandler()
+{
+	_TestHttpFileHandlerRange();
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
+
+	_TestHttpFileHandlerGet();
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
+
+	_TestHttpFileCacheEvict();
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
+}
+
+#endif
@@ -0,0 +1,371 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <spl/Debug.h>
+
+#ifdef DEBUG
+#include <spl/io/log/Log.h>
+#include <spl/web/HttpRequest.h>
+#include <spl/web/HttpRequestParser.h>
+#include <spl/web/server/HttpInstance.h>
+
+#ifdef HAVE_SYS_SOCKET_H
+#include <sys/socket.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+using namespace spl;
+
+static void _TestHttpRequestPipelined()
+{
+	const char *reqs = 
+		"GET /a.html HTTP/1.1\r\nHost: localhost\r\n\r\n"
+		"POST /b.html HTTP/1.1\r\nContent-Length: 5\r\n\r\nhello"
+		"GET /c.html HTTP/1.0\r\n\r\n";
+	Array<byte> buf((const byte *)reqs, (int)strlen(reqs));
+
+	HttpRequest req;
+	int pos = req.Parse(buf, 0, buf.Length());
+	UNIT_ASSERT("first complete", req.IsComplete());
+	UNIT_ASSERT("first file", req.URI().Filename().Equals("a.html"));
+	UNIT_ASSERT("first keep-alive", req.IsKeepAlive());
+	UNIT_ASSERT("first stops at second", pos == (int)strlen("GET /a.html HTTP/1.1\r\nHost: localhost\r\n\r\n"));
+
+	req.Reset();
+	UNIT_ASSERT("reset", ! req.IsComplete() && req.Headers().Count() == 0 && NULL == req.Body());
+
+	pos = req.Parse(buf, pos, buf.Length());
+	UNIT_ASSERT("second complete", req.IsComplete());
+	UNIT_ASSERT("second method", req.Method().Equals("POST"));
+	UNIT_ASSERT("second body", req.Body()->ByteCount() == 5 && req.Body()->ToString()->Equals("hello"));
+
+	req.Reset();
+	pos = req.Parse(buf, pos, buf.Length());
+	UNIT_ASSERT("third complete", req.IsComplete());
+	UNIT_ASSERT("third file", req.URI().Filename().Equals("c.html"));
+	UNIT_ASSERT("third not keep-alive", ! req.IsKeepAlive());
+	UNIT_ASSERT("all consumed", pos == buf.Length());
+
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	req.CheckMem();
+	buf.CheckMem();
+	DEBUG_DUMP_MEM_LEAKS();
+	UNIT_ASSERT_MEM_NOTED("HttpRequest pipelined");
+
+	Log::SWriteOkFail( "HttpRequest pipelined" );
+}
+
+static void _TestHttpRequestSplit()
+{
+	const char *req1 = "GET /x.html HTTP/1.1\r\nConnection: close\r\n\r\n";
+	HttpRequest req;
+	Array<byte> buf(1);
+
+	// One byte at a time, as a slow client would send it.
+	for ( int x = 0; req1[x] != '\0'; x++ )
+	{
+		UNIT_ASSERT("not early", ! req.IsComplete());
+		buf[0] = (byte)req1[x];
+		UNIT_ASSERT("consumed", req.Parse(buf, 0, 1) == 1);
+	}
+	UNIT_ASSERT("complete", req.IsComplete());
+	UNIT_ASSERT("close", ! req.IsKeepAlive());
+
+	Log::SWriteOkFail( "HttpRequest split" );
+}
+
+static void _TestHttpRequestParserPipelined()
+{
+	const char *reqs = 
+		"GET /a.html HTTP/1.1\r\nHost: localhost\r\nX-Custom:  some value \r\n\r\n"
+		"POST /b.html HTTP/1.1\r\nContent-Length: 5\r\nContent-Type: text/plain\r\n\r\nhello"
+		"\r\nGET /c.html HTTP/1.0\r\nConnection: Keep-Alive\r\n\r\n";
+	Array<byte> buf((const byte *)reqs, (int)strlen(reqs));
+
+	HttpRequestParser parser;
+	UNIT_ASSERT("first complete", parser.Parse(buf, 0, buf.Length()));
+	UNIT_ASSERT("first method", parser.IsMethod("GET"));
+	UNIT_ASSERT("first uri", parser.RawUri()->Equals("/a.html"));
+	UNIT_ASSERT("first host", parser.HasHeader(HTTP_HDR_HOST) && parser.HeaderEquals(HTTP_HDR_HOST, "LOCALHOST"));
+	UNIT_ASSERT("first custom", parser.Header("x-custom")->Equals("some value"));
+	UNIT_ASSERT("first keep-alive", parser.IsKeepAlive());
+	UNIT_ASSERT("first no body", 0 == parser.BodyLength() && parser.PendingBytes() > 0);
+
+	UNIT_ASSERT("second complete", parser.Next());
+	UNIT_ASSERT("second method", parser.IsMethod("POST"));
+	UNIT_ASSERT("second length", 5 == parser.ContentLength() && 5 == parser.BodyLength());
+	UNIT_ASSERT("second body", 0 == memcmp(parser.BodyData(), "hello", 5));
+
+	HttpRequest req;
+	parser.CopyTo(req);
+	UNIT_ASSERT("copy complete", req.IsComplete());
+	UNIT_ASSERT("copy method", req.Method().Equals("POST"));
+	UNIT_ASSERT("copy file", req.URI().Filename().Equals("b.html"));
+	UNIT_ASSERT("copy header", req.Headers().Header("Content-Type").Equals("text/plain"));
+	UNIT_ASSERT("copy body", req.Body()->ByteCount() == 5 && req.Body()->ToString()->Equals("hello"));
+
+	UNIT_ASSERT("third complete", parser.Next());
+	UNIT_ASSERT("third version", parser.IsVersion("HTTP/1.0"));
+	UNIT_ASSERT("third keep-alive", parser.IsKeepAlive());
+	UNIT_ASSERT("all consumed", 0 == parser.PendingBytes());
+	UNIT_ASSERT("nothing left", ! parser.Next());
+
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	parser.CheckMem();
+	req.CheckMem();
+	buf.CheckMem();
+	DEBUG_DUMP_MEM_LEAKS();
+	UNIT_ASSERT_MEM_NOTED("HttpRequestParser pipelined");
+
+	Log::SWriteOkFail( "HttpRequestParser pipelined" );
+}
+
+static void _TestHttpRequestParserChunked()
+{
+	const char *req1 = 
+		"POST /up HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"
+		"5\r\nhello\r\n"
+		"7;ext=1\r\n, world\r\n"
+		"0\r\nX-Trailer: x\r\n\r\n"
+		"GET /next HTTP/1.1\r\n\r\n";
+	HttpRequestParser parser;
+	Array<byte> buf(1);
+
+	// One byte at a time, as a slow client would send it.
+	int x;
+	for ( x = 0; ! parser.IsComplete(); x++ )
+	{
+		buf[0] = (byte)req1[x];
+		parser.Parse(buf, 0, 1);
+	}
+	UNIT_ASSERT("chunked", parser.IsChunked());
+	UNIT_ASSERT("chunked body", 12 == parser.BodyLength() && 0 == memcmp(parser.BodyData(), "hello, world", 12));
+
+	HttpRequest req;
+	parser.CopyTo(req);
+	UNIT_ASSERT("chunked copy length", req.Headers().Header("Content-Length").Equals("12"));
+	UNIT_ASSERT("chunked copy no TE", ! req.Headers().HasHeader("Transfer-Encoding"));
+	UNIT_ASSERT("chunked copy body", req.Body()->ToString()->Equals("hello, world"));
+
+	Array<byte> rest((const byte *)&req1[x], (int)strlen(&req1[x]));
+	UNIT_ASSERT("next incomplete", ! parser.Next());
+	UNIT_ASSERT("next complete", parser.Parse(rest, 0, rest.Length()));
+	UNIT_ASSERT("next uri", parser.RawUri()->Equals("/next"));
+
+	Log::SWriteOkFail( "HttpRequestParser chunked" );
+}
+
+static bool _ParserRejects(const char *text)
+{
+	HttpRequestParser parser(1024);
+	Array<byte> buf((const byte *)text, (int)strlen(text));
+	try
+	{
+		parser.Parse(buf, 0, buf.Length());
+	}
+	catch ( Exception *ex )
+	{
+		delete ex;
+		return true;
+	}
+	return false;
+}
+
+static void _TestHttpRequestParserErrors()
+{
+	UNIT_ASSERT("bad line", _ParserRejects("GET\r\n\r\n"));
+	UNIT_ASSERT("bad version", _ParserRejects("GET / FTP/1.0\r\n\r\n"));
+	UNIT_ASSERT("bad header", _ParserRejects("GET / HTTP/1.1\r\nNoColon\r\n\r\n"));
+	UNIT_ASSERT("folded", _ParserRejects("GET / HTTP/1.1\r\nA: b\r\n c\r\n\r\n"));
+	UNIT_ASSERT("bad length", _ParserRejects("POST / HTTP/1.1\r\nContent-Length: 1x\r\n\r\n"));
+	UNIT_ASSERT("negative length", _ParserRejects("POST / HTTP/1.1\r\nContent-Length: -5\r\n\r\n"));
+	UNIT_ASSERT("conflicting length", _ParserRejects("POST / HTTP/1.1\r\nContent-Length: 1\r\nContent-Length: 2\r\n\r\n"));
+	UNIT_ASSERT("TE and length", _ParserRejects("POST / HTTP/1.1\r\nContent-Length: 1\r\nTransfer-Encoding: chunked\r\n\r\n"));
+	UNIT_ASSERT("TE gzip", _ParserRejects("POST / HTTP/1.1\r\nTransfer-Encoding: gzip\r\n\r\n"));
+	UNIT_ASSERT("bad chunk", _ParserRejects("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n"));
+	UNIT_ASSERT("too large", _ParserRejects("POST / HTTP/1.1\r\nContent-Length: 2000\r\n\r\n"));
+	UNIT_ASSERT("ok", ! _ParserRejects("POST / HTTP/1.1\r\nContent-Length: 1\r\n\r\n"));
+
+	Log::SWriteOkFail( "HttpRequestParser errors" );
+}
+
+#ifdef HAVE_SYS_SOCKET_H
+/// One end of a socketpair, so HttpInstance can be run without a listening port.
+class _TestPairSocket : public TcpSocket
+{
+public:
+	_TestPairSocket(int fd) : TcpSocket(fd) {}
+};
+#endif
+
+static void _TestHttpRequestBadLength()
+{
+	const char *bad = "POST /a.html HTTP/1.1\r\nContent-Length: -5\r\n\r\nhello";
+	Array<byte> buf((const byte *)bad, (int)strlen(bad));
+
+	HttpRequest req;
+	bool threw = false;
+	try
+	{
+		req.Parse(buf, 0, buf.Length());
+	}
+	catch ( Exception *ex )
+	{
+		threw = true;
+		delete ex;
+	}
+	UNIT_ASSERT("negative length", threw);
+
+#ifdef HAVE_SYS_SOCKET_H
+	// The server answers 400 and closes the connection.
+	int fds[2];
+	UNIT_ASSERT("socketpair", 0 == socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+	HttpHandlerFactory fact;
+	{
+		HttpInstance inst(TcpSocketPtr(new _TestPairSocket(fds[0])), &fact);
+		inst.IStreamRead_OnRead(buf, buf.Length());
+		UNIT_ASSERT("closed", inst.IsClosed());
+	}
+
+	char resp[512];
+	int count = (int)::read(fds[1], resp, sizeof(resp) - 1);
+	::close(fds[1]);
+	UNIT_ASSERT("response", count > 0);
+	resp[count > 0 ? count : 0] = '\0';
+	UNIT_ASSERT("400", String(resp).IndexOf(" 400 ") > 0);
+#endif
+
+	Log::SWriteOkFail( "HttpRequest bad Content-Length" );
+}
+
+static void _TestHttpRequestParserFileExt()
+{
+	const char *uris[] = { "/a.png", "/dir/x", "/x.tar.gz", "noslash.txt", "/a.b/c", "/a\\b.JS", "/p?q=a.b", "/d/f.html?x=1", "/", NULL };
+
+	HttpRequestParser parser;
+	for ( int x = 0; NULL != uris[x]; x++ )
+	{
+		StringPtr req = String::Format("GET %s HTTP/1.1\r\n\r\n", uris[x]);
+		Array<byte> buf((const byte *)req->GetChars(), req->Length());
+		UNIT_ASSERT("complete", parser.Parse(buf, 0, buf.Length()));
+
+		StringView ext;
+		UNIT_ASSERT("no scheme", parser.UriFileExt(ext));
+		Uri uri(uris[x]);
+		UNIT_ASSERT("same as Uri", uri.FileExt().Equals(*ext.ToString()));
+		parser.Reset();
+	}
+
+	const char *absReq = "GET http://host:80/a.png HTTP/1.1\r\n\r\n";
+	Array<byte> abs((const byte *)absReq, (int)strlen(absReq));
+	UNIT_ASSERT("abs complete", parser.Parse(abs, 0, abs.Length()));
+	StringView ext;
+	UNIT_ASSERT("left to Uri", ! parser.UriFileExt(ext));
+
+	Log::SWriteOkFail( "HttpRequestParser UriFileExt" );
+}
+
+#ifdef HAVE_SYS_SOCKET_H
+/// Records what an HttpInstance handler sees of each request.
+class _TestRecordingHandler : public HttpHandler
+{
+public:
+	String m_seen;
+
+	_TestRecordingHandler() : HttpHandler("text/plain"), m_seen()
+	{
+		m_fileExtensions.Add("png");
+	}
+
+	virtual void ProcessRequest(HttpRequest& request, HttpResponse& response)
+	{
+		m_seen = m_seen + request.Method() + " " + request.URI().Filename() + " " + request.Headers().Header("Host") + ";";
+		response.GetBodyStream()->Write(String("ok").ToByteArray());
+	}
+};
+#endif
+
+static void _TestHttpInstanceHandler()
+{
+#ifdef HAVE_SYS_SOCKET_H
+	// The handler reads the request through the parser, across pipelined requests.
+	const char *reqs = 
+		"GET /img/Logo.PNG?x=1 HTTP/1.1\r\nHost: one\r\n\r\n"
+		"POST /b.png HTTP/1.1\r\nHost: two\r\nContent-Length: 2\r\nConnection: close\r\n\r\nhi";
+	Array<byte> buf((const byte *)reqs, (int)strlen(reqs));
+
+	int fds[2];
+	UNIT_ASSERT("socketpair", 0 == socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+	HttpHandlerFactory fact;
+	_TestRecordingHandler *handler = new _TestRecordingHandler();
+	fact.AddHandler(HttpHandlerPtr(handler));
+	{
+		HttpInstance inst(TcpSocketPtr(new _TestPairSocket(fds[0])), &fact);
+		inst.IStreamRead_OnRead(buf, buf.Length());
+		UNIT_ASSERT("closed", inst.IsClosed());
+		UNIT_ASSERT("two requests", 2 == inst.RequestCount());
+	}
+	UNIT_ASSERT("handler saw requests", handler->m_seen.Equals("GET Logo.PNG one;POST b.png two;"));
+
+	char resp[1024];
+	int count = (int)::read(fds[1], resp, sizeof(resp) - 1);
+	::close(fds[1]);
+	UNIT_ASSERT("response", count > 0);
+	resp[count > 0 ? count : 0] = '\0';
+	UNIT_ASSERT("200", String(resp).IndexOf(" 200 ") > 0);
+#endif
+
+	Log::SWriteOkFail( "HttpInstance handler request" );
+}
+
+void _TestHttpRequest()
+{
+	_TestHttpRequestPipelined();
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
+
+	_TestHttpRequestSplit();
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
+
+	_TestHttpRequestParserPipelined();
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
+
+	_TestHttpRequestParserChunked();
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
+
+	_TestHttpRequestParserErrors();
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
+
+	_TestHttpRequestBadLength();
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
+
+	_TestHttpRequestParserFileExt();
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
+
+	_TestHttpInstanceHandler();
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
+}
+
+#endif
@@ -19,6 +19,8 @@
 #ifdef DEBUG
 #include <spl/io/log/Log.h>
 #include <spl/collection/MemoryPool.h>
+#include <spl/collection/SizeClassPool.h>
+#include <spl/threading/Thread.h>
 
 using namespace spl;
 
@@ -87,9 +89,202 @@ static void _TestMemoryPool1()
 	Log::SWriteOkFail( "MemoryPool test 1" );
 }
 
+static void _TestMemoryPool2()
+{
+	MemoryPool *mp = new MemoryPool(64);
+	byte *ptrs[40];
+
+	for ( int x = 0; x < 40; x++ )
+	{
+		ptrs[x] = (byte *)mp->Malloc(x % 13 + 1);
+		UNIT_ASSERT("aligned", 0 == ((intptr_t)ptrs[x] & 7));
+		memset(ptrs[x], x, x % 13 + 1);
+	}
+	byte *big = (byte *)mp->Malloc(500);
+	memset(big, 'B', 500);
+	for ( int x = 0; x < 40; x++ )
+	{
+		UNIT_ASSERT("contents", ptrs[x][x % 13] == (byte)x);
+	}
+
+	int total = mp->TotalSize();
+	mp->Reset();
+	UNIT_ASSERT("used after reset", 0 == mp->UsedSize());
+	UNIT_ASSERT("large block freed", mp->TotalSize() < total);
+
+	// The kept blocks are reused.
+	total = mp->TotalSize();
+	for ( int x = 0; x < 40; x++ )
+	{
+		mp->Malloc(x % 13 + 1);
+	}
+	UNIT_ASSERT("blocks reused", mp->TotalSize() == total);
+
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_NOTE_MEM(mp);
+	mp->CheckMem();
+	DEBUG_DUMP_MEM_LEAKS();
+	UNIT_ASSERT_MEM_NOTED("MemoryPool test 2.0");
+
+	delete mp;
+
+	Log::SWriteOkFail( "MemoryPool test 2 (Reset)" );
+}
+
+static void _TestSizeClassPool1()
+{
+	SizeClassPool *pool = new SizeClassPool();
+	byte *ptrs[120];
+
+	for ( int x = 0; x < 120; x++ )
+	{
+		int size = x * 10;
+		ptrs[x] = (byte *)pool->Malloc(size);
+		UNIT_ASSERT("aligned", 0 == ((intptr_t)ptrs[x] & 7));
+		if ( size <= SIZECLASSPOOL_MAX_SIZE )
+		{
+			UNIT_ASSERT("block size", SizeClassPool::BlockSize(ptrs[x]) >= size);
+		}
+		memset(ptrs[x], x, size);
+	}
+	for ( int x = 1; x < 120; x++ )
+	{
+		UNIT_ASSERT("contents", ptrs[x][0] == (byte)x && ptrs[x][x * 10 - 1] == (byte)x);
+	}
+
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_NOTE_MEM(pool);
+	pool->CheckMem();
+	for ( int x = 103; x < 120; x++ )
+	{
+		// Blocks over SIZECLASSPOOL_MAX_SIZE belong to the caller.
+		DEBUG_NOTE_MEM((byte *)ptrs[x] - 8);
+	}
+	DEBUG_DUMP_MEM_LEAKS();
+	UNIT_ASSERT_MEM_NOTED("SizeClassPool test 1.0");
+
+	for ( int x = 0; x < 120; x++ )
+	{
+		pool->Free(ptrs[x]);
+	}
+
+	// Freed blocks come back before new spans are made.
+	int64 spanBytes = pool->SpanBytes();
+	for ( int x = 0; x < 120; x++ )
+	{
+		ptrs[x] = (byte *)pool->Malloc(x * 10);
+	}
+	UNIT_ASSERT("spans reused", pool->SpanBytes() == spanBytes);
+	for ( int x = 0; x < 120; x++ )
+	{
+		pool->Free(ptrs[x]);
+	}
+
+	pool->FlushThreadCache();
+	pool->ValidateMem();
+
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_NOTE_MEM(pool);
+	pool->CheckMem();
+	DEBUG_DUMP_MEM_LEAKS();
+	UNIT_ASSERT_MEM_NOTED("SizeClassPool test 1.1");
+
+	delete pool;
+
+	Log::SWriteOkFail( "SizeClassPool test 1" );
+}
+
+#define SCP_TEST_BLOCKS 5000
+
+class _TestSizeClassThread : public Thread
+{
+private:
+	SizeClassPool& m_pool;
+	byte **m_blocks;
+	int m_seed;
+	int m_failcount;
+
+public:
+	/// Allocates SCP_TEST_BLOCKS blocks into blocks; the caller frees them.
+	_TestSizeClassThread(SizeClassPool& pool, byte **blocks, int seed)
+	: m_pool(pool), m_blocks(blocks), m_seed(seed), m_failcount(0)
+	{
+		Start();
+	}
+
+	void Run()
+	{
+		byte *mine[64];
+		for ( int x = 0; x < SCP_TEST_BLOCKS; x++ )
+		{
+			int size = (x * 7 + m_seed) % 300;
+			m_blocks[x] = (byte *)m_pool.Malloc(size + 1);
+			m_blocks[x][0] = (byte)m_seed;
+			m_blocks[x][size] = (byte)m_seed;
+
+			// Some churn of its own, freed on this thread.
+			mine[x & 63] = (byte *)m_pool.Malloc(24);
+			*mine[x & 63] = (byte)x;
+			if ( 63 == (x & 63) )
+			{
+				for ( int y = 0; y < 64; y++ )
+				{
+					if ( *mine[y] != (byte)(x - 63 + y) )
+					{
+						m_failcount++;
+					}
+					m_pool.Free(mine[y]);
+				}
+			}
+		}
+		for ( int y = 0; y <= ((SCP_TEST_BLOCKS - 1) & 63); y++ )
+		{
+			m_pool.Free(mine[y]);
+		}
+	}
+
+	inline int Failures() const { return m_failcount; }
+};
+
+static void _TestSizeClassPool2()
+{
+	SizeClassPool pool;
+	byte **blocks = new byte *[3 * SCP_TEST_BLOCKS];
+
+	for ( int round = 0; round < 2; round++ )
+	{
+		_TestSizeClassThread t1(pool, blocks, 1);
+		_TestSizeClassThread t2(pool, &blocks[SCP_TEST_BLOCKS], 2);
+		_TestSizeClassThread t3(pool, &blocks[2 * SCP_TEST_BLOCKS], 3);
+		t1.Join();
+		t2.Join();
+		t3.Join();
+
+		UNIT_ASSERT("thread churn", 0 == t1.Failures() + t2.Failures() + t3.Failures());
+
+		// Free everything from this thread.
+		for ( int x = 0; x < 3 * SCP_TEST_BLOCKS; x++ )
+		{
+			int seed = x / SCP_TEST_BLOCKS + 1;
+			int size = ((x % SCP_TEST_BLOCKS) * 7 + seed) % 300;
+			UNIT_ASSERT("cross thread contents", blocks[x][0] == (byte)seed && blocks[x][size] == (byte)seed);
+			pool.Free(blocks[x]);
+		}
+		pool.FlushThreadCache();
+	}
+	pool.ValidateMem();
+
+	delete[] blocks;
+
+	Log::SWriteOkFail( "SizeClassPool test 2 (threads)" );
+}
+
 void _TestMemoryPool()
 {
 	_TestMemoryPool1();
+	_TestMemoryPool2();
+	_TestSizeClassPool1();
+	_TestSizeClassPool2();
 	DEBUG_CLEAR_MEM_CHECK_POINTS();
 	DEBUG_DUMP_MEM_LEAKS();
 }
@@ -18,7 +18,9 @@
 #include <spl/io/BlockingStream.h>
 #include <spl/io/log/Log.h>
 #include <spl/net/Packet.h>
+#include <spl/net/PacketBuilder.h>
 #include <spl/io/MemoryStream.h>
+#include <spl/text/StringBuffer.h>
 
 using namespace spl;
 
@@ -86,6 +88,333 @@ static void _TestPacket2()
 	Log::SWriteOkFail( "Packet test 2" );
 }
 
+static StringPtr _MakeLongString(int len)
+{
+	StringBuffer buf(len + 1);
+	for ( int x = 0; x < len; x++ )
+	{
+		buf.Append( (char)('a' + x % 26) );
+	}
+	return buf.ToString();
+}
+
+static void _TestPacketV2()
+{
+	MemoryStream strm;
+	StringPtr longstr = _MakeLongString(70000);
+	Array<byte> raw(5);
+	for ( int x = 0; x < raw.Length(); x++ )
+	{
+		raw[x] = (byte)(250 + x);
+	}
+
+	Packet *pkt = new Packet();
+	UNIT_ASSERT("default v2", pkt->WireVersion() == PACKET_WIRE_V2);
+	pkt->Append((int32)-1);
+	pkt->Append((int32)0x7FFFFFFF);
+	pkt->Append((int64)-5000000000LL);
+	pkt->Append(*longstr);
+	pkt->Append(raw);
+	pkt->Append(Date(2009, 7, 4));
+	pkt->SendPacket(strm);
+	UNIT_ASSERT("v2 frame", strm.Length() == PACKET_V2_HEADER_SIZE + pkt->PayloadSize() && pkt->PayloadSize() > 70000);
+
+	// small ints are one byte plus the tag
+	Packet small;
+	small.Append((int32)-1);
+	UNIT_ASSERT("varint size", small.PayloadSize() == 2);
+
+	pkt->ReadPacket(strm);
+	UNIT_ASSERT("read version", pkt->ReadWireVersion() == PACKET_WIRE_V2);
+	UNIT_ASSERT("frame size", pkt->PacketSize() == PACKET_V2_HEADER_SIZE + pkt->PayloadSize());
+	UNIT_ASSERT("-1", pkt->ReadInt32() == -1);
+	UNIT_ASSERT("max int", pkt->ReadInt32() == 0x7FFFFFFF);
+	UNIT_ASSERT("int64", pkt->ReadInt64() == -5000000000LL);
+	StringPtr str = pkt->ReadString();
+	UNIT_ASSERT("long string", str->Equals(*longstr));
+	byte *data = pkt->ReadBuf(5);
+	UNIT_ASSERT("raw", data[0] == 250 && data[4] == 254);
+	free(data);
+	Date dt = pkt->ReadDate();
+	UNIT_ASSERT("date", dt.Year() == 2009 && dt.Month() == 7 && dt.Day() == 4);
+
+	bool thrown = false;
+	try
+	{
+		pkt->ReadInt8();
+	}
+	catch (PacketUnderflowException *ex)
+	{
+		delete ex;
+		thrown = true;
+	}
+	UNIT_ASSERT("underflow", thrown);
+
+	delete pkt;
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	strm.CheckMem();
+	longstr.CheckMem();
+	str.CheckMem();
+	raw.CheckMem();
+	small.CheckMem();
+	DEBUG_DUMP_MEM_LEAKS();
+	UNIT_ASSERT_MEM_NOTED("Packet v2");
+
+	Log::SWriteOkFail( "Packet v2" );
+}
+
+static void _TestPacketV1()
+{
+	MemoryStream strm;
+	Packet pkt;
+	pkt.SetWireVersion(PACKET_WIRE_V1);
+	pkt.Append((int32)-70000);
+	pkt.Append((int64)0x123456789ALL);
+	pkt.Append("hi");
+	pkt.Append(DateTime(2010, 1, 2, 3, 4, 5));
+	pkt.SendPacket(strm);
+	UNIT_ASSERT("v1 frame", strm.Length() == PACKET_V1_HEADER_SIZE + pkt.PayloadSize());
+
+	// a v2 reader reads v1 frames
+	Packet reader;
+	reader.ReadPacket(strm);
+	UNIT_ASSERT("read version", reader.ReadWireVersion() == PACKET_WIRE_V1);
+	UNIT_ASSERT("int32", reader.ReadInt32() == -70000);
+	UNIT_ASSERT("int64", reader.ReadInt64() == 0x123456789ALL);
+	StringPtr str = reader.ReadString();
+	UNIT_ASSERT("string", str->Equals("hi"));
+	DateTime dtm = reader.ReadDateTime();
+	UNIT_ASSERT("datetime", dtm.Year() == 2010 && dtm.Day() == 2 && dtm.Seconds() == 5);
+
+	// v1 frames are limited to 32K
+	Packet big;
+	big.SetWireVersion(PACKET_WIRE_V1);
+	bool thrown = false;
+	try
+	{
+		big.Append(*_MakeLongString(40000));
+	}
+	catch (InvalidArgumentException *ex)
+	{
+		delete ex;
+		thrown = true;
+	}
+	UNIT_ASSERT("v1 limit", thrown);
+
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	strm.CheckMem();
+	pkt.CheckMem();
+	reader.CheckMem();
+	big.CheckMem();
+	str.CheckMem();
+	DEBUG_DUMP_MEM_LEAKS();
+	UNIT_ASSERT_MEM_NOTED("Packet v1");
+
+	Log::SWriteOkFail( "Packet v1 compatibility" );
+}
+
+class _PacketCounter : public IPacketListener
+{
+public:
+	int64 m_sum;
+	int m_count;
+	int m_strlen;
+
+	_PacketCounter() : m_sum(0), m_count(0), m_strlen(0) {}
+	virtual ~_PacketCounter() {}
+
+	virtual void IPacket_OnData(int64 i) { m_sum += i; m_count++; }
+	virtual void IPacket_OnData(int32 i) { m_sum += i; m_count++; }
+	virtual void IPacket_OnData(int16 i) { m_sum += i; m_count++; }
+	virtual void IPacket_OnData(byte i) { m_sum += i; m_count++; }
+	virtual void IPacket_OnData(bool b) { m_count++; }
+	virtual void IPacket_OnData(double d) { m_count++; }
+	virtual void IPacket_OnData(StringPtr str) { m_strlen += str->Length(); m_count++; }
+	virtual void IPacket_OnData(const Vector<byte>& data, const int len) { m_strlen += len; m_count++; }
+	virtual void IPacket_OnData(const DateTime& dtm) { m_count++; }
+	virtual void IPacket_OnData(const Date& i) { m_count++; }
+	virtual void IStreamRead_OnError(const String& msg) {}
+	virtual void IStreamRead_OnClose() {}
+};
+
+static void _TestPacketBuilder()
+{
+	MemoryStream strm;
+	Array<byte> raw(3);
+	for ( int version = PACKET_WIRE_V1; version <= PACKET_WIRE_V2; version++ )
+	{
+		Packet pkt;
+		pkt.SetWireVersion((PacketWireVersion)version);
+		pkt.Append((int32)-300);
+		pkt.Append((int64)-1);
+		pkt.Append("");
+		pkt.Append("abc");
+		pkt.Append(raw);
+		pkt.Append(66.5);
+		pkt.SendPacket(strm);
+	}
+	Array<byte> frames((int)strm.Length());
+	strm.Read(frames);
+
+	// All at once, then a byte at a time.
+	_PacketCounter counter;
+	PacketBuilder *builder = new PacketBuilder();
+	builder->Delegates().Add(&counter);
+	IStreamReadListener *listener = builder;
+	listener->IStreamRead_OnRead(frames, frames.Length());
+
+	Array<byte> one(1);
+	for ( int x = 0; x < frames.Length(); x++ )
+	{
+		one[0] = frames[x];
+		listener->IStreamRead_OnRead(one, 1);
+	}
+	UNIT_ASSERT("builder values", counter.m_count == 24);
+	UNIT_ASSERT("builder ints", counter.m_sum == -1204);
+	UNIT_ASSERT("builder strings", counter.m_strlen == 24);
+
+	delete builder;
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	strm.CheckMem();
+	raw.CheckMem();
+	frames.CheckMem();
+	one.CheckMem();
+	DEBUG_DUMP_MEM_LEAKS();
+	UNIT_ASSERT_MEM_NOTED("PacketBuilder");
+
+	Log::SWriteOkFail( "PacketBuilder v1 and v2" );
+}
+
+class _FrameCounter : public IPacketFrameListener
+{
+public:
+	int64 m_sum;
+	int m_count;
+	int m_strlen;
+	int m_binlen;
+
+	_FrameCounter() : m_sum(0), m_count(0), m_strlen(0), m_binlen(0) {}
+	virtual ~_FrameCounter() {}
+
+	virtual void IPacketFrame_OnFrame(PacketFrame& frame)
+	{
+		m_count++;
+		m_sum += frame.NextInt32();
+		m_sum += frame.NextInt64();
+		m_strlen += frame.NextStringView().Length();
+		m_strlen += frame.NextStringView().Length();
+		m_binlen += frame.NextBytesView().Length();
+		frame.Skip();
+		if ( frame.HasNext() )
+		{
+			throw new Exception("Frame has extra values");
+		}
+	}
+
+	virtual void IStreamRead_OnError(const String& msg) {}
+	virtual void IStreamRead_OnClose() {}
+};
+
+static void _TestPacketFrame()
+{
+	MemoryStream strm;
+	Array<byte> raw(3);
+	for ( int version = PACKET_WIRE_V1; version <= PACKET_WIRE_V2; version++ )
+	{
+		Packet pkt;
+		pkt.SetWireVersion((PacketWireVersion)version);
+		pkt.Append((int32)-300);
+		pkt.Append((int64)-1);
+		pkt.Append("");
+		pkt.Append("abc");
+		pkt.Append(raw);
+		pkt.Append(66.5);
+		pkt.SendPacket(strm);
+	}
+	Array<byte> frames((int)strm.Length());
+	strm.Read(frames);
+
+	// The cursor reads a Packet's frame in place.
+	MemoryStream in;
+	in.Write(frames);
+	Packet pkt;
+	pkt.ReadPacket(in);
+	PacketFrame& frame = pkt.Frame();
+	UNIT_ASSERT("frame v1", PACKET_WIRE_V1 == frame.Version() && 'I' == frame.PeekType());
+	UNIT_ASSERT("frame int32", frame.NextInt32() == -300);
+	frame.Skip();
+	UNIT_ASSERT("frame empty", frame.NextStringView().IsEmpty());
+	UNIT_ASSERT("frame string", frame.NextStringView().Equals("abc"));
+	int pos = frame.Position();
+	UNIT_ASSERT("frame bytes", frame.NextBytesView().Length() == 3);
+	frame.SetPosition(pos);
+	frame.Skip();
+	UNIT_ASSERT("frame double", frame.NextDouble() == 66.5 && !frame.HasNext());
+	try
+	{
+		frame.NextInt8();
+		UNIT_ASSERT("frame underflow", false);
+	}
+	catch ( PacketUnderflowException *ex )
+	{
+		delete ex;
+	}
+
+	pkt.ReadPacket(in);
+	UNIT_ASSERT("frame v2", PACKET_WIRE_V2 == pkt.Frame().Version() && 'i' == pkt.Frame().PeekType());
+	try
+	{
+		pkt.Frame().NextStringView();
+		UNIT_ASSERT("frame mismatch", false);
+	}
+	catch ( PacketReadTypeMismatchException *ex )
+	{
+		delete ex;
+	}
+
+	// All at once, then a byte at a time.
+	_FrameCounter counter;
+	PacketFrameBuilder *builder = new PacketFrameBuilder(&counter);
+	IStreamReadListener *listener = builder;
+	listener->IStreamRead_OnRead(frames, frames.Length());
+	UNIT_ASSERT("frame builder whole", counter.m_count == 2 && builder->PendingCount() == 0);
+
+	Array<byte> one(1);
+	for ( int x = 0; x < frames.Length(); x++ )
+	{
+		one[0] = frames[x];
+		listener->IStreamRead_OnRead(one, 1);
+	}
+	UNIT_ASSERT("frame builder frames", counter.m_count == 4 && builder->FrameCount() == 4);
+	UNIT_ASSERT("frame builder ints", counter.m_sum == -1204);
+	UNIT_ASSERT("frame builder strings", counter.m_strlen == 12 && counter.m_binlen == 12);
+
+	one[0] = 7;
+	try
+	{
+		listener->IStreamRead_OnRead(one, 1);
+		UNIT_ASSERT("frame builder bad header", false);
+	}
+	catch ( Exception *ex )
+	{
+		delete ex;
+	}
+	UNIT_ASSERT("frame builder reset", builder->PendingCount() == 0);
+
+	delete builder;
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	strm.CheckMem();
+	in.CheckMem();
+	pkt.CheckMem();
+	raw.CheckMem();
+	frames.CheckMem();
+	one.CheckMem();
+	DEBUG_DUMP_MEM_LEAKS();
+	UNIT_ASSERT_MEM_NOTED("PacketFrameBuilder");
+
+	Log::SWriteOkFail( "PacketFrame and PacketFrameBuilder" );
+}
+
 void TestPacket()
 {
 	_TestPacket1();
@@ -95,6 +424,22 @@ void TestPacket()
 	_TestPacket2();
 	DEBUG_CLEAR_MEM_CHECK_POINTS();
 	DEBUG_DUMP_MEM_LEAKS();
+
+	_TestPacketV2();
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
+
+	_TestPacketV1();
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
+
+	_TestPacketBuilder();
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
+
+	_TestPacketFrame();
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
 }
 
 #endif
@@ -0,0 +1,123 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <spl/Debug.h>
+
+#ifdef DEBUG
+#include <spl/io/log/Log.h>
+#include <spl/io/MemoryStream.h>
+#include <spl/net/PacketSendQueue.h>
+#include <spl/threading/Thread.h>
+
+using namespace spl;
+
+static void _TestPacketSendQueueBatch()
+{
+	MemoryStreamPtr strm(new MemoryStream());
+	PacketSendQueue *q = new PacketSendQueue(strm, 256, 0);
+	Packet pkt;
+
+	for ( int x = 0; x < 10; x++ )
+	{
+		pkt.Clear();
+		pkt.Append((int32)x);
+		q->Send(pkt);
+	}
+	UNIT_ASSERT("corked", strm->Length() == 0 && q->QueuedCount() == 10 && q->WriteCount() == 0);
+	q->Flush();
+	UNIT_ASSERT("one write", q->WriteCount() == 1 && q->PacketCount() == 10 && q->PacketsPerWrite() == 10.0);
+	UNIT_ASSERT("bytes", q->BytesWritten() == strm->Length());
+
+	// A packet that fills the buffer goes out with what's queued ahead of it.
+	pkt.Clear();
+	pkt.Append((int32)10);
+	q->Send(pkt);
+	Packet big;
+	Array<byte> data(300);
+	big.Append(data);
+	q->Send(big);
+	UNIT_ASSERT("gathered", q->WriteCount() == 2 && q->PacketCount() == 12 && q->QueuedCount() == 0);
+
+	Packet in;
+	for ( int x = 0; x < 11; x++ )
+	{
+		in.ReadPacket(*strm);
+		UNIT_ASSERT("order", in.ReadInt32() == x);
+	}
+	in.ReadPacket(*strm);
+	byte *buf = in.ReadBuf(300);
+	free(buf);
+	UNIT_ASSERT("drained", strm->Length() == 0);
+
+	delete q;
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	strm.CheckMem();
+	pkt.CheckMem();
+	big.CheckMem();
+	data.CheckMem();
+	in.CheckMem();
+	DEBUG_DUMP_MEM_LEAKS();
+	UNIT_ASSERT_MEM_NOTED("PacketSendQueue batch");
+
+	Log::SWriteOkFail( "PacketSendQueue batch" );
+}
+
+static void _TestPacketSendQueueTimer()
+{
+	MemoryStreamPtr strm(new MemoryStream());
+	PacketSendTimer *timer = new PacketSendTimer(1);
+	PacketSendQueue *q = new PacketSendQueue(strm, 4096, 5);
+	timer->Add(q);
+
+	Packet pkt;
+	pkt.Append("late");
+	q->Send(pkt);
+
+	for ( int x = 0; x < 1000 && q->TimerFlushCount() < 1; x++ )
+	{
+		Thread::Sleep(2);
+	}
+	UNIT_ASSERT("timer flushed", q->QueuedCount() == 0 && q->TimerFlushCount() == 1 && q->WriteCount() == 1);
+
+	// Deleting the queue takes it off the timer.
+	q->Send(pkt);
+	delete q;
+	UNIT_ASSERT("flushed on delete", strm->Length() == 2 * (PACKET_V2_HEADER_SIZE + pkt.PayloadSize()));
+
+	timer->Stop();
+	delete timer;
+
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	strm.CheckMem();
+	pkt.CheckMem();
+	DEBUG_DUMP_MEM_LEAKS();
+	UNIT_ASSERT_MEM_NOTED("PacketSendQueue timer");
+
+	Log::SWriteOkFail( "PacketSendQueue timer" );
+}
+
+void _TestPacketSendQueue()
+{
+	_TestPacketSendQueueBatch();
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
+
+	_TestPacketSendQueueTimer();
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
+}
+
+#endif
@@ -16,6 +16,8 @@
  */
 #include <spl/Debug.h>
 #include <spl/io/log/Log.h>
+#include <spl/data/ColumnOps.h>
+#include <spl/data/ColumnTypes.h>
 #include <spl/data/RecordSet.h>
 
 using namespace spl;
@@ -255,6 +257,206 @@ static void _TestRecordSet4()
 	Log::SWriteOkFail( "RecordSet 4" );
 }
 
+static void _TestRecordSet5()
+{
+	RecordSet *rs = new RecordSet();
+	rs->DefineColumn("c1", DbSqlType::SQL_TYPE_INT32, 4);
+	rs->DefineColumn("c2", DbSqlType::SQL_TYPE_VARCHAR, 22);
+	rs->DefineColumn("c3", DbSqlType::SQL_TYPE_BLOB, 0);
+
+	for (int x = 0; x < 70; x++)
+	{
+		rs->GetColumn("c3")->Append( (void *)"a\0b", 3 );
+		if (0 == x % 3)
+		{
+			rs->GetColumn("c1")->AppendNull();
+		}
+		else
+		{
+			rs->GetColumn("c1")->Append( (int32)x );
+		}
+		rs->GetColumn("c2")->Append( String("v") );
+	}
+	rs->GetColumn("c2")->AppendNull();
+	rs->GetColumn("c3")->AppendNull();
+	rs->ValidateMem();
+
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_NOTE_MEM( rs );
+	rs->CheckMem();
+	DEBUG_DUMP_MEM_LEAKS();
+	UNIT_ASSERT_MEM_NOTED("RecordSet 5.1");
+
+	IColumn *c1 = rs->GetColumn("c1");
+	UNIT_ASSERT( "null count", c1->NullCount() == 24 );
+	UNIT_ASSERT( "row 0 null", c1->IsNull(0) );
+	UNIT_ASSERT( "row 1 not null", !c1->IsNull(1) );
+	UNIT_ASSERT( "row 69 null", c1->IsNull(69) );
+	UNIT_ASSERT( "row 68 value", c1->GetInt32(68) == 68 );
+	UNIT_ASSERT( "varchar null", rs->GetColumn("c2")->IsNull(70) && !rs->GetColumn("c2")->IsNull(69) );
+	UNIT_ASSERT( "blob null", rs->GetColumn("c3")->IsNull(70) && static_cast<BlobColumn *>(rs->GetColumn("c3"))->GetBlob(70).IsNull() );
+	UNIT_ASSERT( "blob", static_cast<BlobColumn *>(rs->GetColumn("c3"))->GetBlob(5)->Length() == 3 && static_cast<BlobColumn *>(rs->GetColumn("c3"))->GetBlob(5)->Data()[2] == 'b' );
+
+	RecordSet *copy = new RecordSet(*rs);
+	UNIT_ASSERT( "copy null count", copy->GetColumn("c1")->NullCount() == 24 );
+	UNIT_ASSERT( "copy null", copy->GetColumn("c1")->IsNull(3) && !copy->GetColumn("c1")->IsNull(4) );
+	UNIT_ASSERT( "copy varchar null", copy->GetColumn("c2")->IsNull(70) );
+	UNIT_ASSERT( "copy blob", copy->GetColumn("c3")->IsNull(70) && copy->GetColumn("c3")->GetVarchar(1)->Equals("YQBi") );
+
+	copy->GetColumn("c1")->Append( c1, 3 );
+	copy->GetColumn("c1")->Append( c1, 4 );
+	UNIT_ASSERT( "append null row", copy->GetColumn("c1")->IsNull(70) );
+	UNIT_ASSERT( "append row", !copy->GetColumn("c1")->IsNull(71) && copy->GetColumn("c1")->GetInt32(71) == 4 );
+	copy->ValidateMem();
+
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_NOTE_MEM( rs );
+	rs->CheckMem();
+	DEBUG_NOTE_MEM( copy );
+	copy->CheckMem();
+	DEBUG_DUMP_MEM_LEAKS();
+	UNIT_ASSERT_MEM_NOTED("RecordSet 5.2");
+
+	delete copy;
+	delete rs;
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
+	UNIT_ASSERT_MEM_NOTED("RecordSet 5.3");
+
+	Log::SWriteOkFail( "RecordSet nulls" );
+}
+
+static void _TestColumnOps1()
+{
+	RecordSet *rs = new RecordSet();
+	rs->DefineColumn("id", DbSqlType::SQL_TYPE_INT32, 4);
+	rs->DefineColumn("grp", DbSqlType::SQL_TYPE_INT16, 2);
+	rs->DefineColumn("name", DbSqlType::SQL_TYPE_VARCHAR, 22);
+	rs->DefineColumn("amt", DbSqlType::SQL_TYPE_FLOAT64, 8);
+
+	// 100 rows: grp is id % 4, amt is id / 2 with every tenth row null.
+	for (int x = 0; x < 100; x++)
+	{
+		rs->GetColumn("id")->Append( (int32)x );
+		rs->GetColumn("grp")->Append( (int16)(x % 4) );
+		rs->GetColumn("name")->Append( 0 == x % 2 ? String("even") : String("odd") );
+		if (0 == x % 10)
+		{
+			rs->GetColumn("amt")->AppendNull();
+		}
+		else
+		{
+			rs->GetColumn("amt")->Append( (float64)x / 2 );
+		}
+	}
+
+	IColumn *id = rs->GetColumn("id");
+	IColumn *amt = rs->GetColumn("amt");
+
+	RowBitmap sel(rs->RowCount());
+	ColumnOps::Filter( id, ColumnOps::CMP_GE, (int64)40, sel );
+	UNIT_ASSERT( "filter >= 40", sel.Count() == 60 && !sel.IsSet(39) && sel.IsSet(40) && sel.IsSet(99) );
+
+	RowBitmap lt(rs->RowCount());
+	ColumnOps::Filter( id, ColumnOps::CMP_LT, (int64)50, lt );
+	sel.And( lt );
+	UNIT_ASSERT( "40 <= id < 50", sel.Count() == 10 );
+
+	RowBitmap amtSel(rs->RowCount());
+	ColumnOps::Filter( amt, ColumnOps::CMP_GT, 20.0, amtSel );
+	UNIT_ASSERT( "amt > 20 drops nulls", amtSel.Count() == 54 && !amtSel.IsSet(50) );
+
+	RowBitmap nulls(rs->RowCount());
+	ColumnOps::FilterNull( amt, true, nulls );
+	UNIT_ASSERT( "null rows", nulls.Count() == 10 && nulls.IsSet(90) );
+	ColumnOps::FilterNull( amt, false, nulls );
+	UNIT_ASSERT( "not null rows", nulls.Count() == 90 && !nulls.IsSet(90) );
+
+	ColumnSummary sum = ColumnOps::Aggregate( id );
+	UNIT_ASSERT( "id count", sum.count == 100 && sum.intSum == 4950 );
+	UNIT_ASSERT( "id min max", sum.min == 0 && sum.max == 99 );
+
+	sum = ColumnOps::Aggregate( id, &sel );
+	UNIT_ASSERT( "id selected", sum.count == 10 && sum.intSum == 445 && sum.min == 40 && sum.max == 49 );
+
+	sum = ColumnOps::Aggregate( amt );
+	UNIT_ASSERT( "amt count", sum.count == 90 && sum.sum == 2250 && sum.min == 0.5 && sum.max == 49.5 );
+	UNIT_ASSERT( "amt avg", sum.Avg() == 25 );
+
+	Vector<int> rows;
+	sel.ToRows( rows );
+	UNIT_ASSERT( "ToRows", rows.Count() == 10 && rows.ElementAt(0) == 40 && rows.ElementAt(9) == 49 );
+
+	RecordSetPtr groups = ColumnOps::GroupBy( *rs, "grp", "amt" );
+	UNIT_ASSERT( "group rows", groups->RowCount() == 4 );
+	UNIT_ASSERT( "group key order", groups->GetColumn("grp")->GetInt64(0) == 0 && groups->GetColumn("grp")->GetInt64(3) == 3 );
+	// grp 0 is ids 0, 4, ... 96; ids 0, 20, 40, 60 and 80 have null amt.
+	UNIT_ASSERT( "group count", groups->GetColumn("count")->GetInt64(0) == 20 );
+	UNIT_ASSERT( "group sum", groups->GetColumn("sum")->GetFloat64(0) == 500 );
+	UNIT_ASSERT( "group min", groups->GetColumn("min")->GetFloat64(0) == 2 );
+	UNIT_ASSERT( "group max", groups->GetColumn("max")->GetFloat64(0) == 48 );
+
+	RecordSetPtr names = ColumnOps::GroupBy( *rs, "name", "id", &sel );
+	UNIT_ASSERT( "name groups", names->RowCount() == 2 );
+	UNIT_ASSERT( "name key", names->GetColumn("name")->GetVarchar(0)->Equals("even") );
+	UNIT_ASSERT( "name sum", names->GetColumn("sum")->GetFloat64(0) == 220 && names->GetColumn("sum")->GetFloat64(1) == 225 );
+
+	Vector<IColumn *> keys;
+	Vector<bool> desc;
+	keys.Add( rs->GetColumn("grp") );
+	desc.Add( true );
+	keys.Add( amt );
+	desc.Add( false );
+	Vector<int> perm;
+	ColumnOps::Sort( keys, desc, NULL, perm );
+	UNIT_ASSERT( "sort count", perm.Count() == 100 );
+	UNIT_ASSERT( "sort first", perm.ElementAt(0) == 3 );
+	UNIT_ASSERT( "sort null first", perm.ElementAt(25) == 10 && perm.ElementAt(26) == 30 );
+	UNIT_ASSERT( "sort last", perm.ElementAt(99) == 96 );
+
+	bool sorted = true;
+	for (int x = 1; x < perm.Count(); x++)
+	{
+		int a = perm.ElementAt(x - 1), b = perm.ElementAt(x);
+		int ga = a % 4, gb = b % 4;
+		if (ga < gb || (ga == gb && !amt->IsNull(a) && (amt->IsNull(b) || amt->GetFloat64(a) > amt->GetFloat64(b))))
+		{
+			sorted = false;
+		}
+	}
+	UNIT_ASSERT( "sort order", sorted );
+
+	keys.Clear();
+	keys.Add( rs->GetColumn("name") );
+	ColumnOps::Sort( keys, Vector<bool>(), &sel, perm );
+	UNIT_ASSERT( "sort strings stable", perm.Count() == 10 && perm.ElementAt(0) == 40 && perm.ElementAt(4) == 48 && perm.ElementAt(5) == 41 );
+
+	sel.ValidateMem();
+	groups.ValidateMem();
+	names.ValidateMem();
+	rs->ValidateMem();
+
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_NOTE_MEM( rs );
+	rs->CheckMem();
+	sel.CheckMem();
+	lt.CheckMem();
+	amtSel.CheckMem();
+	nulls.CheckMem();
+	groups.CheckMem();
+	names.CheckMem();
+	rows.CheckMem();
+	keys.CheckMem();
+	desc.CheckMem();
+	perm.CheckMem();
+	DEBUG_DUMP_MEM_LEAKS();
+	UNIT_ASSERT_MEM_NOTED("ColumnOps 1.1");
+
+	delete rs;
+
+	Log::SWriteOkFail( "ColumnOps 1" );
+}
+
 void TestRecordSet()
 {
 	_TestRecordSet1();
@@ -276,6 +478,14 @@ void TestRecordSet()
 	_TestRecordSet4();
 	DEBUG_CLEAR_MEM_CHECK_POINTS();
 	DEBUG_DUMP_MEM_LEAKS();
+
+	_TestRecordSet5();
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
+
+	_TestColumnOps1();
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
 }
 
 #endif
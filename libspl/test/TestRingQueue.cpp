@@ -0,0 +1,173 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <spl/Debug.h>
+#include <spl/io/log/Log.h>
+#include <spl/collection/RingQueue.h>
+#include <spl/String.h>
+#include <spl/threading/ThreadStartDelegate.h>
+
+using namespace spl;
+
+#if defined(DEBUG)
+
+static void _TestRingQueueBasic()
+{
+	RingQueue<int> q(5, RingQueue<int>::RING_NONBLOCK);
+	int item;
+
+	UNIT_ASSERT("Capacity", q.Capacity() == 8);
+	UNIT_ASSERT("Empty", q.IsEmpty() && !q.TryGet(item));
+
+	// Go around the ring a few times.
+	for (int round = 0; round < 5; round++)
+	{
+		for (int x = 0; x < 8; x++)
+		{
+			UNIT_ASSERT("TryPut", q.TryPut(round * 10 + x));
+		}
+		UNIT_ASSERT("Full", !q.Put(99) && q.Count() == 8);
+		for (int x = 0; x < 8; x++)
+		{
+			UNIT_ASSERT("TryGet", q.TryGet(item) && item == round * 10 + x);
+		}
+		UNIT_ASSERT("Drained", q.IsEmpty());
+	}
+	UNIT_ASSERT("Nonblock doesn't count drops", q.DroppedCount() == 0);
+	UNIT_ASSERT("Timed get", !q.Get(item, 10));
+
+	Log::SWriteOkFail( "RingQueue basic" );
+}
+
+static void _TestRingQueueDrop()
+{
+	RingQueue<String> q(4, RingQueue<String>::RING_DROP);
+	String item;
+
+	for (int x = 0; x < 6; x++)
+	{
+		q.Put(*String::Format("item %d", x));
+	}
+	UNIT_ASSERT("Dropped", q.DroppedCount() == 2 && q.Count() == 4);
+
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	q.CheckMem();
+	item.CheckMem();
+	DEBUG_DUMP_MEM_LEAKS();
+	UNIT_ASSERT_MEM_NOTED("RingQueue drop 1");
+
+	UNIT_ASSERT("Oldest kept", q.TryGet(item) && item.Equals("item 0"));
+	UNIT_ASSERT("Next", q.TryGet(item) && item.Equals("item 1"));
+
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	q.CheckMem();
+	item.CheckMem();
+	DEBUG_DUMP_MEM_LEAKS();
+	UNIT_ASSERT_MEM_NOTED("RingQueue drop 2");
+
+	Log::SWriteOkFail( "RingQueue drop" );
+}
+
+#define RING_TEST_PRODUCERS 4
+#define RING_TEST_ITEMS 20000
+
+class RingProducer
+{
+private:
+	RingQueue<int> *m_q;
+	int m_id;
+
+public:
+	ThreadStartDelegate<RingProducer> m_thread;
+
+	inline RingProducer()
+	: m_q(NULL), m_id(0), m_thread()
+	{
+	}
+
+	inline void Start(RingQueue<int> *q, int id)
+	{
+		m_q = q;
+		m_id = id;
+		m_thread.Set(this, &RingProducer::Run);
+		m_thread.Start();
+	}
+
+	void Run()
+	{
+		for (int x = 0; x < RING_TEST_ITEMS; x++)
+		{
+			m_q->Put((m_id << 24) | x);
+		}
+	}
+};
+
+static void _TestRingQueueThreads()
+{
+	RingQueue<int> q(64);
+	RingProducer producers[RING_TEST_PRODUCERS];
+	int next[RING_TEST_PRODUCERS];
+	bool ordered = true;
+	int item;
+
+	for (int x = 0; x < RING_TEST_PRODUCERS; x++)
+	{
+		next[x] = 0;
+		producers[x].Start(&q, x);
+	}
+
+	for (int count = 0; count < RING_TEST_PRODUCERS * RING_TEST_ITEMS; count++)
+	{
+		item = q.Get();
+		int id = item >> 24;
+		if (id < 0 || id >= RING_TEST_PRODUCERS || (item & 0xFFFFFF) != next[id])
+		{
+			ordered = false;
+			break;
+		}
+		next[id]++;
+	}
+
+	for (int x = 0; x < RING_TEST_PRODUCERS; x++)
+	{
+		while (producers[x].m_thread.IsRunning())
+		{
+			Thread::YYield();
+		}
+	}
+
+	UNIT_ASSERT("Each producer's items in order", ordered);
+	UNIT_ASSERT("All read", q.IsEmpty() && !q.TryGet(item));
+
+	Log::SWriteOkFail( "RingQueue producers" );
+}
+
+void _TestRingQueue()
+{
+	_TestRingQueueBasic();
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
+
+	_TestRingQueueDrop();
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
+
+	_TestRingQueueThreads();
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
+}
+
+#endif
@@ -15,8 +15,12 @@
  *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <spl/Debug.h>
+#include <spl/collection/Vector.h>
+#include <spl/net/EpollSocketSet.h>
 #include <spl/net/PortListener.h>
+#include <spl/net/ReactorSocketSet.h>
 #include <spl/net/SocketSet.h>
+#include <spl/threading/InterlockCounter.h>
 #include <spl/threading/Thread.h>
 #include <spl/io/log/Log.h>
 
@@ -24,6 +28,7 @@ using namespace spl;
 
 #ifdef DEBUG
 static volatile int _debug_msgcount;
+static volatile int _debug_closecount;
 
 class ReflectorStListener;
 typedef RefCountPtrCast<ReflectorStListener, IStreamReadListener, IStreamReadListenerPtr> ReflectorStListenerPtr;
@@ -295,9 +300,366 @@ static void testSS2()
 	UNIT_ASSERT_MEM_NOTED("socketTest2");
 }
 
+#ifdef HAVE_SYS_EPOLL_H
+class EchoListener : public IStreamReadListener
+{
+private:
+	TcpSocketPtr m_sock;
+
+public:
+	EchoListener(TcpSocketPtr sock)
+	: m_sock(sock)
+	{
+	}
+
+	virtual void IStreamRead_OnRead( const Array<byte>& buf, int len )
+	{
+		_debug_msgcount++;
+		m_sock->GetStream()->Write( buf, 0, len );
+	}
+
+	virtual void IStreamRead_OnClose()
+	{
+		_debug_closecount++;
+	}
+
+	virtual void IStreamRead_OnError( const String& msg )
+	{
+		UNIT_ASSERT(msg.GetChars(), false);
+	}
+
+#if defined(DEBUG) || defined(_DEBUG)
+	void CheckMem() const
+	{
+		m_sock.CheckMem();
+	}
+	void ValidateMem() const
+	{
+		m_sock.ValidateMem();
+	}
+#endif
+};
+
+class EchoFactory : public IServerConnectionFactory
+{
+public:
+	virtual IStreamReadListenerPtr Create(TcpSocketPtr sock)
+	{
+		Array<byte> buf((const byte *)"HI\n", 4);
+		sock->SetBlocking();
+		sock->GetStream()->Write( buf, 0, 4 );
+		return IStreamReadListenerPtr(new EchoListener(sock));
+	}
+
+#if defined(DEBUG) || defined(_DEBUG)
+	void CheckMem() const
+	{
+	}
+	void ValidateMem() const
+	{
+	}
+#endif
+};
+
+static void testSSService( const char *name, int port, enum ISocketService::ServiceType type )
+{
+	_debug_msgcount = 0;
+	Array<byte> buf(255);
+	EchoFactory factory;
+	SocketSetServer srv(&factory, port, type);
+	Thread::YYield();
+
+	TcpSocket cnt( "127.0.0.1", port );
+	cnt.SetBlocking();
+	cnt.Connect();
+	cnt.GetStream()->Read( buf, 0, 255 );
+	UNIT_ASSERT( name, buf[0] == 'H' && buf[1] == 'I' );
+
+	TcpSocket cnt2( "127.0.0.1", port );
+	cnt2.SetBlocking();
+	cnt2.Connect();
+	cnt2.GetStream()->Read( buf, 0, 255 );
+	UNIT_ASSERT( name, buf[0] == 'H' && buf[1] == 'I' );
+
+	buf[0] = 'Q';
+	buf[1] = '\0';
+	cnt.GetStream()->Write( buf, 0, 2 );
+	buf[0] = 'A';
+	cnt.GetStream()->Read( buf, 0, 255 );
+	UNIT_ASSERT( name, buf[0] == 'Q' );
+	UNIT_ASSERT( name, _debug_msgcount == 1 );
+
+	cnt2.Close();
+	Thread::Sleep(1000);
+	UNIT_ASSERT( name, srv.SocketCount() == 1 );
+
+	buf[0] = 'Z';
+	cnt.GetStream()->Write( buf, 0, 2 );
+	buf[0] = 'A';
+	cnt.GetStream()->Read( buf, 0, 255 );
+	UNIT_ASSERT( name, buf[0] == 'Z' );
+	UNIT_ASSERT( name, _debug_msgcount == 2 );
+
+	cnt.Close();
+	srv.Close();
+
+	Log::SWriteOkFail( name );
+}
+
+static void testFdReuse( const char *name, int port, ISocketService& es )
+{
+	_debug_msgcount = 0;
+	_debug_closecount = 0;
+	Array<byte> buf(255);
+	ServerSocket server(port, 10);
+
+	// The client ends go in the set so that it is the client that closes
+	// first and the listening port isn't left in TIME_WAIT.
+	TcpSocketPtr cnt(new TcpSocket( "127.0.0.1", port ));
+	cnt->SetBlocking();
+	cnt->Connect();
+	TcpSocketPtr sock = server.Accept();
+	es.AddSocket( IStreamReadListenerPtr(new EchoListener(cnt)), cnt );
+	UNIT_ASSERT( name, es.SocketCount() == 1 );
+
+	// Closed outside a callback, so the set still has an entry for its fd,
+	// which the kernel hands to the next socket.
+	cnt->Close();
+
+	TcpSocketPtr cnt2(new TcpSocket( "127.0.0.1", port ));
+	cnt2->SetBlocking();
+	cnt2->Connect();
+	TcpSocketPtr sock2 = server.Accept();
+	sock2->SetBlocking();
+	es.AddSocket( IStreamReadListenerPtr(new EchoListener(cnt2)), cnt2 );
+	UNIT_ASSERT( name, es.SocketCount() == 1 );
+	UNIT_ASSERT( name, _debug_closecount == 1 );
+
+	buf[0] = 'Q';
+	sock2->GetStream()->Write( buf, 0, 1 );
+	buf[0] = 'A';
+	sock2->GetStream()->Read( buf, 0, 255 );
+	UNIT_ASSERT( name, buf[0] == 'Q' );
+	UNIT_ASSERT( name, _debug_msgcount == 1 );
+
+	es.Close();
+	sock->Close();
+	sock2->Close();
+	server.Close();
+
+	Log::SWriteOkFail( name );
+}
+
+static void testEpollFdReuse()
+{
+	EpollSocketSet es;
+	testFdReuse( "EpollSocketSet fd reuse", 8015, es );
+}
+
+static void testReactorFdReuse()
+{
+	ReactorSocketSet rs(1, 2);
+	testFdReuse( "ReactorSocketSet fd reuse", 8017, rs );
+}
+
+static void testReactorCounters()
+{
+	const char *name = "ReactorSocketSet counters";
+	_debug_msgcount = 0;
+	Array<byte> buf(255);
+	ServerSocket server(8014, 10);
+	ReactorSocketSet rs(1, 2);
+
+	UNIT_ASSERT( name, rs.PollerCount() == 1 && rs.WorkerCount() == 2 );
+
+	TcpSocket cnt( "127.0.0.1", 8014 );
+	cnt.SetBlocking();
+	cnt.Connect();
+	TcpSocketPtr sock = server.Accept();
+	sock->SetBlocking();
+	rs.AddSocket( IStreamReadListenerPtr(new EchoListener(sock)), sock );
+	UNIT_ASSERT( name, rs.SocketCount() == 1 );
+
+	for ( int x = 0; x < 5; x++ )
+	{
+		buf[0] = (byte)('a' + x);
+		cnt.GetStream()->Write( buf, 0, 1 );
+		buf[0] = 'A';
+		cnt.GetStream()->Read( buf, 0, 255 );
+		UNIT_ASSERT( name, buf[0] == 'a' + x );
+	}
+
+	UNIT_ASSERT( name, _debug_msgcount == 5 );
+	// A write that lands before the worker re-arms is read in the same dispatch.
+	UNIT_ASSERT( name, rs.DispatchCount() >= 1 && rs.DispatchCount() <= 5 );
+	UNIT_ASSERT( name, rs.QueueDepth() == 0 );
+	UNIT_ASSERT( name, rs.StealCount() <= rs.DispatchCount() );
+	UNIT_ASSERT( name, rs.StealRate() >= 0.0 && rs.StealRate() <= 1.0 );
+
+	cnt.Close();
+	Thread::Sleep(1000);
+	UNIT_ASSERT( name, rs.SocketCount() == 0 );
+
+	rs.Close();
+	server.Close();
+
+	Log::SWriteOkFail( name );
+}
+
+#define REACTOR_ORDER_CONNS 6
+#define REACTOR_ORDER_ROUNDS 40
+
+class OrderListener;
+typedef RefCountPtrCast<OrderListener, IStreamReadListener, IStreamReadListenerPtr> OrderListenerPtr;
+
+/// Records what arrives on one connection and notes overlapping callbacks.
+class OrderListener : public IStreamReadListener
+{
+private:
+	InterlockCounter m_inFlight;
+
+public:
+	Array<byte> m_recv;
+	volatile int m_count;
+	volatile bool m_overlap;
+
+	OrderListener()
+	: m_inFlight(), m_recv(REACTOR_ORDER_ROUNDS), m_count(0), m_overlap(false)
+	{
+	}
+
+	virtual void IStreamRead_OnRead( const Array<byte>& buf, int len )
+	{
+		if ( 1 != ++m_inFlight )
+		{
+			m_overlap = true;
+		}
+
+		// Slow enough that ready connections back up behind this one.
+		Thread::Sleep(5);
+		for ( int x = 0; x < len && m_count < m_recv.Length(); x++ )
+		{
+			m_recv[m_count++] = buf[x];
+		}
+
+		--m_inFlight;
+	}
+
+	virtual void IStreamRead_OnClose()
+	{
+	}
+
+	virtual void IStreamRead_OnError( const String& msg )
+	{
+		UNIT_ASSERT(msg.GetChars(), false);
+	}
+
+#if defined(DEBUG) || defined(_DEBUG)
+	void CheckMem() const
+	{
+		m_recv.CheckMem();
+	}
+	void ValidateMem() const
+	{
+		m_recv.ValidateMem();
+	}
+#endif
+};
+
+static void testReactorOrdering()
+{
+	const char *name = "ReactorSocketSet ordering";
+	Array<byte> buf(1);
+	Vector<TcpSocketPtr> clients;
+	Vector<OrderListenerPtr> listeners;
+	ServerSocket server(8016, 10);
+	ReactorSocketSet rs(1, 2);
+
+	for ( int x = 0; x < REACTOR_ORDER_CONNS; x++ )
+	{
+		TcpSocketPtr cnt(new TcpSocket( "127.0.0.1", 8016 ));
+		cnt->SetBlocking();
+		cnt->Connect();
+		clients.Add( cnt );
+
+		TcpSocketPtr sock = server.Accept();
+		sock->SetBlocking();
+		OrderListenerPtr listener(new OrderListener());
+		listeners.Add( listener );
+		rs.AddSocket( listener, sock );
+	}
+	UNIT_ASSERT( name, rs.SocketCount() == REACTOR_ORDER_CONNS );
+
+	// Each round makes every connection ready again while the workers are
+	// still sleeping in earlier callbacks, so the idle worker has to steal.
+	for ( int r = 0; r < REACTOR_ORDER_ROUNDS; r++ )
+	{
+		buf[0] = (byte)r;
+		for ( int x = 0; x < REACTOR_ORDER_CONNS; x++ )
+		{
+			clients.ElementAt(x)->GetStream()->Write( buf, 0, 1 );
+		}
+		Thread::Sleep(2);
+	}
+
+	for ( int w = 0; w < 1000; w++ )
+	{
+		bool done = true;
+		for ( int x = 0; x < REACTOR_ORDER_CONNS; x++ )
+		{
+			done = done && listeners.ElementAt(x)->m_count == REACTOR_ORDER_ROUNDS;
+		}
+		if ( done )
+		{
+			break;
+		}
+		Thread::Sleep(10);
+	}
+
+	for ( int x = 0; x < REACTOR_ORDER_CONNS; x++ )
+	{
+		OrderListenerPtr listener = listeners.ElementAt(x);
+		UNIT_ASSERT( name, listener->m_count == REACTOR_ORDER_ROUNDS );
+		UNIT_ASSERT( name, ! listener->m_overlap );
+		for ( int r = 0; r < listener->m_count; r++ )
+		{
+			UNIT_ASSERT( name, listener->m_recv[r] == (byte)r );
+		}
+	}
+	UNIT_ASSERT( name, rs.StealCount() > 0 );
+	UNIT_ASSERT( name, rs.QueueDepth() == 0 );
+
+	for ( int x = 0; x < REACTOR_ORDER_CONNS; x++ )
+	{
+		clients.ElementAt(x)->Close();
+	}
+	rs.Close();
+	server.Close();
+
+	Log::SWriteOkFail( name );
+}
+#endif
+
 void socketSetTestHarness()
 {
 	testSS1();
 	testSS2();
+#ifdef HAVE_SYS_EPOLL_H
+	testSSService( "SocketSetServer epoll", 8012, ISocketService::SERVICE_EPOLL );
+	testSSService( "SocketSetServer reactor", 8013, ISocketService::SERVICE_REACTOR );
+	testReactorCounters();
+#endif
+}
+
+void _TestSocketSet()
+{
+#ifdef HAVE_SYS_EPOLL_H
+	testSSService( "SocketSetServer epoll", 8012, ISocketService::SERVICE_EPOLL );
+	testEpollFdReuse();
+	testSSService( "SocketSetServer reactor", 8013, ISocketService::SERVICE_REACTOR );
+	testReactorFdReuse();
+	testReactorCounters();
+	testReactorOrdering();
+#endif
 }
 #endif
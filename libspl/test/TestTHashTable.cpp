@@ -248,6 +248,51 @@ static void _THashTest6()
 	Log::SWriteOkFail( "Hashtable test 6" );
 }
 
+static void _THashTest7()
+{
+	int x;
+	Hashtable<int, int> ht(300);
+
+	// Multiples of the table size all want the same home slot without mixing.
+	for ( x = 0; x < 300; x++ )
+	{
+		ht.Set(x * 512, x);
+	}
+	for ( x = 0; x < 300; x += 2 )
+	{
+		ht.Remove(x * 512);
+	}
+	UNIT_ASSERT("THash count", ht.Count() == 150);
+	for ( x = 0; x < 300; x++ )
+	{
+		UNIT_ASSERT("THash remove", ht.ContainsKey(x * 512) == (1 == (x & 1)));
+		if ( x & 1 )
+		{
+			UNIT_ASSERT("THash get", ht.Get(x * 512) == x);
+		}
+	}
+
+	Hashtable<int, int> copy(ht);
+	copy.Set(0, 1000);
+	UNIT_ASSERT("THash copy", copy.Count() == 151 && ht.Count() == 150);
+	UNIT_ASSERT("THash copy 2", copy.Get(0) == 1000 && !ht.ContainsKey(0));
+
+	Hashtable<String, int> sht;
+	sht.Set("name", 1);
+	sht.Set("value", 2);
+	int val = 0;
+	UNIT_ASSERT("THash TryGet", sht.TryGet("value", val) && 2 == val);
+	UNIT_ASSERT("THash TryGet miss", !sht.TryGet("valu", val));
+	UNIT_ASSERT("THash TryGet hash", sht.TryGet(StringView("name"), Math::Hash(StringView("name")), val) && 1 == val);
+
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	ht.CheckMem();
+	copy.CheckMem();
+	sht.CheckMem();
+	UNIT_ASSERT_MEM_NOTED("THashtable 7.1");
+	Log::SWriteOkFail( "Hashtable test 7" );
+}
+
 void THashtableTest(  )
 {
 	_THashTest1();
@@ -277,6 +322,10 @@ void THashtableTest(  )
 	_THashTest6();
 	DEBUG_CLEAR_MEM_CHECK_POINTS();
 	UNIT_ASSERT_MEM_NOTED("Hashtable E");
+
+	_THashTest7();
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	UNIT_ASSERT_MEM_NOTED("Hashtable F");
 }
 
 #endif
@@ -23,6 +23,8 @@
 #include <spl/io/log/Log.h>
 #include <spl/math/Math.h>
 #include <spl/String.h>
+#include <spl/StringView.h>
+#include <spl/collection/Hashtable.h>
 
 using namespace spl;
 
@@ -613,6 +615,85 @@ static void _TestLastIndexOf()
 	Log::SWriteOkFail( "String::LastIndexOf" );
 }
 
+static void _TestStringSso()
+{
+	String shortStr("0123456789abcde");
+	String longStr("0123456789abcdef");
+	String copy(shortStr);
+
+	UNIT_ASSERT("short", shortStr.Equals("0123456789abcde") && shortStr.Length() == STRING_SSO_SIZE - 1);
+	UNIT_ASSERT("long", longStr.Equals("0123456789abcdef") && longStr.Length() == STRING_SSO_SIZE);
+	UNIT_ASSERT("copy", copy == shortStr && copy.GetChars() != shortStr.GetChars());
+
+	copy = longStr;
+	UNIT_ASSERT("grow", copy == longStr);
+	copy = "x";
+	UNIT_ASSERT("shrink", copy.Equals("x"));
+
+	Vector<String> vec;
+	vec.Add("b");
+	vec.Add("d");
+	vec.Insert("a", 0);
+	vec.Insert("c", 2);
+	UNIT_ASSERT("insert", vec.ElementAt(0) == "a" && vec.ElementAt(1) == "b" && vec.ElementAt(2) == "c" && vec.ElementAt(3) == "d");
+	vec.RemoveAt(1);
+	UNIT_ASSERT("remove", vec.Count() == 3 && vec.ElementAt(1) == "c" && vec.ElementAt(2) == "d");
+
+	UNIT_ASSERT("cat", (shortStr + longStr).Equals("0123456789abcde0123456789abcdef"));
+	UNIT_ASSERT("cat 2", ("a" + String("b")).Equals("ab"));
+
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	shortStr.CheckMem();
+	longStr.CheckMem();
+	copy.CheckMem();
+	vec.CheckMem();
+	UNIT_ASSERT_MEM_NOTED("String SSO");
+
+	Log::SWriteOkFail( "String small string" );
+}
+
+static void _TestStringView()
+{
+	String line("GET /index.html HTTP/1.1");
+	StringView view(line);
+	Vector<StringView> parts;
+
+	UNIT_ASSERT("split", 3 == line.Split(StringView(" "), parts));
+	UNIT_ASSERT("split 0", parts.ElementAt(0).Equals("GET"));
+	UNIT_ASSERT("split 1", parts.ElementAt(1) == StringView("/index.html"));
+	UNIT_ASSERT("split 2", parts.ElementAt(2).Equals("HTTP/1.1"));
+	UNIT_ASSERT("split ptr", parts.ElementAt(1).GetChars() == &line.GetChars()[4]);
+
+	UNIT_ASSERT("IndexOf", view.IndexOf(StringView("HTTP")) == 16 && line.IndexOf(StringView("HTTP"), 0) == 16);
+	UNIT_ASSERT("IndexOf 2", view.IndexOf(StringView("HTTPS")) < 0 && view.IndexOf('/', 5) == 20);
+	UNIT_ASSERT("StartsWith", line.StartsWith(StringView("GET ")) && view.EndsWith(StringView("1.1")));
+	UNIT_ASSERT("Substring", view.Substring(4, 11).Equals("/index.html") && view.Right(3).Equals("1.1"));
+	UNIT_ASSERT("Substring 2", view.Substring(21, 100).Equals("1.1") && view.Substring(100, 1).IsEmpty());
+	UNIT_ASSERT("Trim", StringView(" \tab \t").Trim().Equals("ab"));
+	UNIT_ASSERT("Compare", StringView("ab").Compare(StringView("abc")) < 0 && line.Compare(view) == 0);
+	UNIT_ASSERT("EqualsIgnoreCase", parts.ElementAt(0).EqualsIgnoreCase(StringView("get")));
+	UNIT_ASSERT("HashCode", parts.ElementAt(1).HashCode() == String("/index.html").HashCode());
+
+	Hashtable<String, int> methods;
+	methods.Set("GET", 1);
+	methods.Set("POST", 2);
+	int method = 0;
+	UNIT_ASSERT("TryGet", methods.TryGet(parts.ElementAt(0), method) && 1 == method);
+	UNIT_ASSERT("TryGet 2", !methods.TryGet(parts.ElementAt(2), method));
+
+	StringPtr path = parts.ElementAt(1).ToString();
+	UNIT_ASSERT("ToString", path->Equals("/index.html"));
+
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	line.CheckMem();
+	parts.CheckMem();
+	methods.CheckMem();
+	path.CheckMem();
+	UNIT_ASSERT_MEM_NOTED("StringView");
+
+	Log::SWriteOkFail( "StringView" );
+}
+
 void TestTString(  )
 {
 	_TestTStringNull();
@@ -704,6 +785,16 @@ void TestTString(  )
 	DEBUG_CLEAR_MEM_CHECK_POINTS();
 	UNIT_ASSERT_MEM_NOTED("TestString LastIndexOf");
 	DEBUG_FREE_HEAP();
+
+	_TestStringSso();
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	UNIT_ASSERT_MEM_NOTED("TestString SSO");
+	DEBUG_FREE_HEAP();
+
+	_TestStringView();
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	UNIT_ASSERT_MEM_NOTED("TestString StringView");
+	DEBUG_FREE_HEAP();
 }
 
 #endif
@@ -231,6 +231,30 @@ static void _VecRemoveAtTest()
 	Log::SWriteOkFail( "Vector RemoveAt stress test" );
 }
 
+static void _VecRemoveRangeTest()
+{
+	Vector<StringPtr> vec;
+	for ( int x = 0; x < 10; x++ )
+	{
+		vec.Add( Int32::ToString(x) );
+	}
+	vec.RemoveRange( 2, 3 );
+	UNIT_ASSERT( "RemoveRange count", vec.Count() == 7 );
+	UNIT_ASSERT( "RemoveRange 1", vec.ElementAt(1)->Equals("1") );
+	UNIT_ASSERT( "RemoveRange 2", vec.ElementAt(2)->Equals("5") );
+	UNIT_ASSERT( "RemoveRange last", vec.ElementAt(6)->Equals("9") );
+	vec.RemoveRange( 5, 100 );
+	UNIT_ASSERT( "RemoveRange past the end", vec.Count() == 5 && vec.ElementAt(4)->Equals("7") );
+	vec.RemoveRange( 5, 1 );
+	UNIT_ASSERT( "RemoveRange nothing", vec.Count() == 5 );
+
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	vec.CheckMem();
+	UNIT_ASSERT_MEM_NOTED("Vector RemoveRange");
+
+	Log::SWriteOkFail( "Vector RemoveRange" );
+}
+
 void TVectorTest(  )
 {
 	_TVecTest1();
@@ -260,6 +284,10 @@ void TVectorTest(  )
 	_VecRemoveAtTest();
 	DEBUG_CLEAR_MEM_CHECK_POINTS();
 	UNIT_ASSERT_MEM_NOTED("Vector F");
+
+	_VecRemoveRangeTest();
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	UNIT_ASSERT_MEM_NOTED("Vector G");
 }
 
 #endif
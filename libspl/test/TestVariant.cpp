@@ -255,6 +255,63 @@ static void _TestVariantToObject()
 	Log::SWriteOkFail( "Variant ToObject" );
 }
 
+static void _TestVariantInline()
+{
+	Variant i((int64)10), j((int64)9), f(2.5), s("a string too long for the small buffer");
+	UNIT_ASSERT("int64 tag", i.Type() == Variant::VAR_INT64);
+	UNIT_ASSERT("float64 tag", f.Type() == Variant::VAR_FLOAT64);
+	UNIT_ASSERT("String tag", s.Type() == Variant::VAR_STRING);
+	UNIT_ASSERT("Date tag", Variant(Date()).Type() == Variant::VAR_DATE);
+	UNIT_ASSERT("DateTime tag", Variant(DateTime::Now()).Type() == Variant::VAR_DATETIME);
+	UNIT_ASSERT("undefined tag", Variant().IsUndefined());
+
+	// Dates are kept as a number and rebuilt on read.
+	Date dt(2024, 2, 29);
+	DateTime dtm(2021, 7, 4, 13, 45, 30);
+	Variant vdt(dt), vdtm(dtm);
+	Variant vdtm2(vdtm);
+	UNIT_ASSERT("Date round trip", vdt.ToDate() == dt);
+	UNIT_ASSERT("DateTime round trip", vdtm.ToDateTime() == dtm);
+	UNIT_ASSERT("DateTime copy", vdtm2.ToDateTime().Hour() == 13 && vdtm2.ToDateTime().Seconds() == 30);
+
+	UNIT_ASSERT("10 > 9", i > j);
+	UNIT_ASSERT("9 < 10", j < i);
+	UNIT_ASSERT("10 == 10.0", i == Variant(10.0));
+	UNIT_ASSERT("2.5 < 9", f < j);
+
+	Variant res = i + f;
+	UNIT_ASSERT("int + float is float", res.Type() == Variant::VAR_FLOAT64 && res.ToFloat64() == 12.5);
+	res = i * j;
+	UNIT_ASSERT("int * int is int", res.Type() == Variant::VAR_INT64 && res.ToInt64() == 90);
+	res = Variant(7) % Variant((int16)4);
+	UNIT_ASSERT("7 % 4", res.ToInt32() == 3);
+	res = s + i;
+	UNIT_ASSERT("string + int", res.ToString()->EndsWith("buffer10"));
+
+	Variant copy(s);
+	res = copy;
+	res = res;
+	copy.Clear();
+	UNIT_ASSERT("Clear", copy.IsUndefined());
+	UNIT_ASSERT("copy", res.Equals(s));
+	UNIT_ASSERT("Clone", s.Clone()->Equals(s));
+
+	Variant *vp = new Variant(*s.ToString());
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_NOTE_MEM( vp );
+	vp->CheckMem();
+	i.CheckMem();
+	f.CheckMem();
+	s.CheckMem();
+	res.CheckMem();
+	copy.CheckMem();
+	DEBUG_DUMP_MEM_LEAKS();
+	UNIT_ASSERT_MEM_NOTED("Variant inline 1.1");
+
+	delete vp;
+	Log::SWriteOkFail( "Variant inline" );
+}
+
 void _TestVariant()
 {
 	_TestVariant1();
@@ -280,6 +337,10 @@ void _TestVariant()
 	_TestVariantToObject();
 	DEBUG_CLEAR_MEM_CHECK_POINTS();
 	DEBUG_DUMP_MEM_LEAKS();
+
+	_TestVariantInline();
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
 }
 
 #endif
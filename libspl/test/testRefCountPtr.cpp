@@ -16,8 +16,11 @@
  */
 #include <spl/Debug.h>
 #include <spl/io/log/Log.h>
+#include <spl/IntrusivePtr.h>
 #include <spl/RefCountPtr.h>
 #include <spl/String.h>
+#include <spl/Variant.h>
+#include <spl/collection/Vector.h>
 
 using namespace spl;
 
@@ -75,6 +78,47 @@ void _TestRefCountPtrRegression1()
 	Log::SWriteOkFail( "RefCountPtr StringPtr() NULL regression" );
 }
 
+static void _TestIntrusivePtr()
+{
+	IntrusivePtr<String> sp = IntrusivePtr<String>::New("a string too long for the inline buffer");
+	UNIT_ASSERT("count 1", sp.ReferenceCount() == 1);
+	UNIT_ASSERT("value", sp->Equals("a string too long for the inline buffer"));
+
+	{
+		Vector<IntrusivePtr<String> > vec;
+		vec.Add(sp);
+		vec.Add(sp);
+		UNIT_ASSERT("count 3", sp.ReferenceCount() == 3);
+
+		IntrusivePtr<String> sp2;
+		UNIT_ASSERT("null", sp2.IsNull());
+		sp2 = vec.ElementAt(1);
+		sp2 = sp2;
+		UNIT_ASSERT("count 4", sp.ReferenceCount() == 4 && sp2 == sp);
+
+		DEBUG_CLEAR_MEM_CHECK_POINTS();
+		sp.CheckMem();
+		vec.CheckMem();
+		UNIT_ASSERT_MEM_NOTED("IntrusivePtr 1.0");
+	}
+	UNIT_ASSERT("count 1 again", sp.ReferenceCount() == 1);
+
+	IntrusivePtr<Variant> vp = IntrusivePtr<Variant>::New(42);
+	IntrusivePtr<IVariant> ip(vp);
+	UNIT_ASSERT("base", ip.ReferenceCount() == 2 && ip->ToInt32() == 42);
+	vp.Release();
+	UNIT_ASSERT("release", vp.IsNull() && ip.ReferenceCount() == 1);
+	vp = IntrusivePtr<Variant>::StaticCast(ip);
+	UNIT_ASSERT("cast", vp.ReferenceCount() == 2 && vp->ToInt32() == 42);
+
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	sp.CheckMem();
+	vp.CheckMem();
+	UNIT_ASSERT_MEM_NOTED("IntrusivePtr 1.1");
+
+	Log::SWriteOkFail( "IntrusivePtr test" );
+}
+
 void _TestRefCountPtr()
 {
 	_TestRefCountPtr1();
@@ -84,6 +128,10 @@ void _TestRefCountPtr()
 	_TestRefCountPtrRegression1();
 	DEBUG_CLEAR_MEM_CHECK_POINTS();
 	UNIT_ASSERT_MEM_NOTED("_TestRefCountPtrRegression1");
+
+	_TestIntrusivePtr();
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	UNIT_ASSERT_MEM_NOTED("_TestIntrusivePtr");
 }
 
 #endif
@@ -0,0 +1,203 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+ *	VarInterp micro-benchmarks, for tracking dispatch cost.  Build against the
+ *	release libraries with
+ *		g++ -O2 -DNDEBUG -I. -I../libspl -o benchjs benchjs.cpp -lspljs -lspl -pthread
+ *	then run "./benchjs [name]" to run one benchmark.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include <spl/types.h>
+#include <spl/Debug.h>
+#include <spl/Exception.h>
+#include <spl/Variant.h>
+#include <spl/interp/JsParse.h>
+#include <spl/interp/VarInterp.h>
+
+using namespace spl;
+
+static double _Seconds()
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return (double)tv.tv_sec + (double)tv.tv_usec / 1000000.0;
+}
+
+static void _Report(const char *name, int count, double secs)
+{
+	printf("%-40s %10d in %6.3fs  %12.0f/s\n", name, count, secs, (double)count / secs);
+}
+
+#define BENCH_JS_ITERATIONS 1000000
+
+/** @brief Parses src, runs it to completion and reports count iterations; returns this.x. */
+static VariantPtr _RunScript(const char *name, const char *src, int count)
+{
+	JsParse jp(false);
+	ProgramPtr prog(jp.Parse(src));
+	VariantPtr method(new Variant(VarInterp::CreateDefaultContext(prog)));
+	Vector<VariantPtr> args;
+
+	double start = _Seconds();
+	VarInterp vi(method, args);
+	vi.Execute(true);
+	_Report(name, count, _Seconds() - start);
+
+	return vi.FindProperty("x");
+}
+
+static void _Check(const char *name, VariantPtr v, int64 expected)
+{
+	if ( v->ToInt64() != expected )
+	{
+		StringPtr s = v->ToString();
+		printf("%s: expected %d, got %s\n", name, (int)expected, s->GetChars());
+	}
+}
+
+/** @brief An empty counting loop: LT, JMPZ, INC and JMP per iteration. */
+static void BenchLoop()
+{
+	const char *src =
+		"var i = 0;\n" \
+		"while (i < 1000000) {\n" \
+		"	i++;\n" \
+		"}\n" \
+		"this.x = i;\n";
+
+	_Check("loop", _RunScript("while loop, i++", src, BENCH_JS_ITERATIONS), BENCH_JS_ITERATIONS);
+}
+
+/** @brief Integer arithmetic on locals in a for loop. */
+static void BenchArith()
+{
+	const char *src =
+		"var sum = 0;\n" \
+		"for (var i = 0; i < 1000000; i++) {\n" \
+		"	sum = sum + i * 2 - i % 7;\n" \
+		"}\n" \
+		"this.x = sum;\n";
+
+	int64 expected = 0;
+	for ( int64 i = 0; i < BENCH_JS_ITERATIONS; i++ )
+	{
+		expected = expected + i * 2 - i % 7;
+	}
+	_Check("arith", _RunScript("for loop, sum = sum + i * 2 - i % 7", src, BENCH_JS_ITERATIONS), expected);
+}
+
+/** @brief Reads and writes a property of this on every iteration. */
+static void BenchProperty()
+{
+	const char *src =
+		"this.x = 0;\n" \
+		"for (var i = 0; i < 1000000; i++) {\n" \
+		"	this.x = this.x + 1;\n" \
+		"}\n";
+
+	_Check("property", _RunScript("for loop, this.x = this.x + 1", src, BENCH_JS_ITERATIONS), BENCH_JS_ITERATIONS);
+}
+
+/** @brief Property reads and writes on an object made with new. */
+static void BenchObject()
+{
+	const char *src =
+		"function Point(x) {\n" \
+		"	this.x = x;\n" \
+		"	this.y = 0;\n" \
+		"}\n" \
+		"var p = new Point(1);\n" \
+		"for (var i = 0; i < 1000000; i++) {\n" \
+		"	p.y = p.y + p.x;\n" \
+		"}\n" \
+		"this.x = p.y;\n";
+
+	_Check("object", _RunScript("for loop, p.y = p.y + p.x", src, BENCH_JS_ITERATIONS), BENCH_JS_ITERATIONS);
+}
+
+/** @brief One script function call per iteration. */
+static void BenchCall()
+{
+	const char *src =
+		"function add(a, b) {\n" \
+		"	return a + b;\n" \
+		"}\n" \
+		"var sum = 0;\n" \
+		"for (var i = 0; i < 1000000; i++) {\n" \
+		"	sum = add(sum, 1);\n" \
+		"}\n" \
+		"this.x = sum;\n";
+
+	_Check("call", _RunScript("for loop, sum = add(sum, 1)", src, BENCH_JS_ITERATIONS), BENCH_JS_ITERATIONS);
+}
+
+/** @brief Recursive calls; fib(25) makes 242785 calls. */
+static void BenchFib()
+{
+	const char *src =
+		"function fib(n) {\n" \
+		"	if (n < 2) { return n; }\n" \
+		"	return fib(n - 1) + fib(n - 2);\n" \
+		"}\n" \
+		"this.x = fib(25);\n";
+
+	_Check("fib", _RunScript("fib(25), recursive calls", src, 242785), 75025);
+}
+
+int main(int argc, char **argv)
+{
+	const char *which = (argc > 1) ? argv[1] : "all";
+
+	try
+	{
+		if ( 0 == strcmp(which, "all") || 0 == strcmp(which, "loop") )
+		{
+			BenchLoop();
+		}
+		if ( 0 == strcmp(which, "all") || 0 == strcmp(which, "arith") )
+		{
+			BenchArith();
+		}
+		if ( 0 == strcmp(which, "all") || 0 == strcmp(which, "property") )
+		{
+			BenchProperty();
+		}
+		if ( 0 == strcmp(which, "all") || 0 == strcmp(which, "object") )
+		{
+			BenchObject();
+		}
+		if ( 0 == strcmp(which, "all") || 0 == strcmp(which, "call") )
+		{
+			BenchCall();
+		}
+		if ( 0 == strcmp(which, "all") || 0 == strcmp(which, "fib") )
+		{
+			BenchFib();
+		}
+	}
+	catch ( Exception *ex )
+	{
+		printf("%s\n", ex->Message());
+		delete ex;
+		return 20;
+	}
+	return 0;
+}
@@ -31,6 +31,8 @@ namespace spl
 	protected:
 		Vector<VariantPtr> m_array;
 		
+		virtual bool CanCacheProperties() const;
+
 	public:
 		JsArray();
 		JsArray(const JsArray& obj);
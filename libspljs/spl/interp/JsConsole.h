@@ -10,6 +10,9 @@ namespace spl
 
 	class JsConsole : public JsObject
 	{
+	protected:
+		virtual bool CanCacheProperties() const;
+
 	public:
 		JsConsole();
 		virtual ~JsConsole();
@@ -10,6 +10,9 @@ namespace spl
 	private:	
 		void SetFunctions();
 		
+	protected:
+		virtual bool CanCacheProperties() const;
+
 	public:
 		inline JsMath()
 		{
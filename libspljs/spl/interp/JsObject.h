@@ -20,7 +20,9 @@
 #include <spl/types.h>
 #include <spl/Debug.h>
 #include <spl/collection/Hashtable.h>
+#include <spl/collection/Vector.h>
 #include <spl/interp/IJsObject.h>
+#include <spl/interp/JsShape.h>
 #include <spl/Memory.h>
 #include <spl/String.h>
 #include <spl/Variant.h>
@@ -30,16 +32,32 @@ namespace spl
 	class JsObject;
 	typedef RefCountPtrCast<JsObject, IJsObject, IJsObjectPtr> JsObjectPtr;
 
+	/** @brief The base of the script objects.
+	 *	Properties are kept in slots named by a shared JsShape until there are
+	 *	more than JSSHAPE_MAX_SLOTS of them, then in a Hashtable (dictionary
+	 *	mode).  Neither is allocated until the first property is set.
+	 */
 	class JsObject : public IJsObject
 	{
 	protected:
-		Hashtable<String, VariantPtr> *m_properties;
+		JsShape *m_shape;
+		Vector<VariantPtr> *m_slots;
+		Hashtable<String, VariantPtr> *m_properties;	//< Dictionary mode; m_shape is NULL.
 		JsObject *m_container;
-		
+
+		/// @brief The object's own property, not super's or the outer context's; NULL if there isn't one.
+		VariantPtr *FindOwn(const String& idx) const;
+		void AddOwn(const String& idx, VariantPtr obj);
+
+		/** @brief False if GetProperty or HasProperty is overridden to answer before the own properties.
+		 *	Shapes made for these objects aren't cached by VarInterp.
+		 */
+		virtual bool CanCacheProperties() const;
+
 	public:
 
 		inline JsObject()
-		: m_properties(NULL), m_container(NULL)
+		: m_shape(NULL), m_slots(NULL), m_properties(NULL), m_container(NULL)
 		{
 		}
 		
@@ -64,6 +82,25 @@ namespace spl
 		virtual StringPtr TypeName() const;
 		
 		inline void SetOuterContext(VariantPtr& vp) { m_container = (JsObject *)vp->ToObject().Get(); }
+		inline JsObject *OuterContext() const { return m_container; }
+
+		/** @brief Gives the object a shape if it doesn't have one, so that copies made by New share it. */
+		void EnsureShape();
+
+		/// @brief The id of the object's shape, JSSHAPE_NO_ID if it has none or can't be cached.
+		inline uint32 ShapeId() const
+		{
+			return (NULL != m_shape && m_shape->IsCacheable()) ? m_shape->Id() : JSSHAPE_NO_ID;
+		}
+
+		inline const JsShape *Shape() const { return m_shape; }
+
+		/// @brief The value in slot, found with Shape()->Find.
+		inline VariantPtr& SlotAt(int slot) const
+		{
+			ASSERT(NULL != m_slots && slot < m_slots->Count());
+			return m_slots->Data()[slot];
+		}
 		//static const char *CONTAINER_PROPERKTY_NAME;
 
 	#if defined(DEBUG) || defined(_DEBUG)
@@ -0,0 +1,127 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _jsshape_h
+#define _jsshape_h
+
+#include <spl/types.h>
+#include <spl/Debug.h>
+#include <spl/Memory.h>
+#include <spl/String.h>
+#include <spl/collection/Vector.h>
+
+namespace spl
+{
+	/// Objects with more properties than this go to a Hashtable instead of a shape.
+	#define JSSHAPE_MAX_SLOTS 32
+
+	/// JsShape::Id() is never this, so it marks an empty inline cache.
+	#define JSSHAPE_NO_ID 0
+
+	class JsShape;
+
+	inline void TypeValidate(JsShape * const s)
+	{
+	}
+
+	inline void TypeCheckMem(JsShape * const s)
+	{
+	}
+
+	/** @brief The property names of a JsObject, in slot order (a hidden class).
+	 *	Objects that were given the same properties in the same order share a
+	 *	shape, so VarInterp can remember the slot a name was found in for a
+	 *	shape and skip the look up the next time it sees that shape.  Adding a
+	 *	property moves the object to a child shape; the children are found
+	 *	again through the parent, so copies of an object (new) stay on the
+	 *	same shapes.
+	 *
+	 *	Shapes are reference counted by hand: each object and each child holds
+	 *	one reference.  The parent's list of children doesn't hold a reference;
+	 *	a child takes itself out of the list when it's deleted.
+	 */
+	class JsShape : public IMemoryValidate
+	{
+	private:
+		JsShape *m_parent;
+		Vector<StringPtr> m_names;			//< Index is the slot.
+		Vector<JsShape *> m_transitions;
+		uint32 m_id;
+		int m_refs;
+		bool m_cacheable;
+
+		inline JsShape(const JsShape&) {}
+		inline void operator =(const JsShape&) {}
+
+		JsShape(JsShape *parent, const String& name);
+		void RemoveTransition(JsShape *child);
+
+		static uint32 NextId();
+
+	public:
+		/** @brief An empty shape, with one reference.
+		 *	@param cacheable False if the owner's GetProperty doesn't always return its own properties first.
+		 */
+		JsShape(bool cacheable);
+		virtual ~JsShape();
+
+		inline void AddRef() { m_refs++; }
+
+		inline void Release()
+		{
+			ASSERT(m_refs > 0);
+			if (0 == --m_refs)
+			{
+				delete this;
+			}
+		}
+
+		/// @brief Unique while the shape is alive; never JSSHAPE_NO_ID.
+		inline uint32 Id() const { return m_id; }
+
+		/// @brief True if slots found in this shape can be cached by VarInterp.
+		inline bool IsCacheable() const { return m_cacheable; }
+
+		inline int SlotCount() const { return m_names.Count(); }
+
+		/** @return The slot for name, or -1. */
+		inline int Find(const String& name) const
+		{
+			const int len = name.Length();
+			const StringPtr *names = m_names.Data();
+			for (int x = m_names.Count() - 1; x >= 0; x--)
+			{
+				if (names[x]->Length() == len && names[x]->Equals(name))
+				{
+					return x;
+				}
+			}
+			return -1;
+		}
+
+		inline const String& NameAt(int slot) const { return *m_names.ElementAtRef(slot); }
+
+		/** @brief The shape with name added as the next slot, with a reference for the caller. */
+		JsShape *Add(const String& name);
+
+	#if defined(DEBUG) || defined(_DEBUG)
+		void CheckMem() const;
+		void ValidateMem() const;
+	#endif
+	};
+}
+
+#endif
@@ -12,6 +12,9 @@ namespace spl
 		
 		void SetFunctions();
 		
+	protected:
+		virtual bool CanCacheProperties() const;
+
 	public:
 		inline JsString()
 		: m_str()
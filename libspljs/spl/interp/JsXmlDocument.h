@@ -13,6 +13,9 @@ namespace spl
 		
 		void SetFunctions();
 		
+	protected:
+		virtual bool CanCacheProperties() const;
+
 	public:
 		inline JsXmlDocument()
 		: m_doc(new XmlDocument())
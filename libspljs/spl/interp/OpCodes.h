@@ -0,0 +1,92 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _interp_opcodes_h
+#define _interp_opcodes_h
+
+namespace spl
+{
+	/** @brief Instructions emitted by JsParse.
+	 *	Jump offsets are relative to the instruction after the jump.  The
+	 *	entries after JSOP_ENDFN are never emitted; Program::ParseComplete
+	 *	decodes PUSH and DEREF into them so VarInterp doesn't test the
+	 *	argument source on every instruction.
+	 */
+	enum JsOpCode
+	{
+		JSOP_NOP = 0,
+		JSOP_LINE,		///< Note the source line number (debug builds).
+		JSOP_PUSH,		///< Push the IMM, TAB or STK argument.
+		JSOP_POP,
+		JSOP_DUP,
+		JSOP_ROT,		///< Swap the top two stack entries.
+		JSOP_RVAL,		///< Replace the top of the stack with a copy of its value.
+		JSOP_NULL,
+		JSOP_THIS,
+		JSOP_ASSIGN,	///< val = pop, target = pop; *target = *val.
+		JSOP_FINDPROP,	///< Push the property named by the TAB argument, looking through the outer contexts.
+		JSOP_DEFPROP,	///< Push the property of this named by the TAB argument.
+		JSOP_DEREF,		///< obj = pop; push obj[TAB], or idx = pop, obj = pop; push obj[idx].
+		JSOP_NEW,		///< Push a new instance of the class named by the TAB argument.
+		JSOP_ENTER,		///< Open a scope; a non zero argument is the break offset.
+		JSOP_LEAVE,
+		JSOP_BREAK,
+		JSOP_JMP,
+		JSOP_JMPZ,		///< Pop, jump if false.
+		JSOP_SWITCH,	///< val = pop, disp = pop; jump to disp[val] or fall through.
+		JSOP_CALL,		///< The function and its arguments are above the innermost scope.
+		JSOP_RET,
+		JSOP_DEFFUNC,	///< src = pop, argc = pop, name = pop; the body follows, up to ENDFN.
+		JSOP_ENDFN,
+		JSOP_SETCTX,	///< fn = pop, ctx = pop; make ctx the outer context of fn.
+		JSOP_ADD,
+		JSOP_SUB,
+		JSOP_MULT,
+		JSOP_DIV,
+		JSOP_MOD,
+		JSOP_NEGATE,
+		JSOP_INC,
+		JSOP_DEC,
+		JSOP_EQ,
+		JSOP_NEQ,
+		JSOP_LT,
+		JSOP_GT,
+		JSOP_LTEQ,
+		JSOP_GTEQ,
+		JSOP_AND,
+		JSOP_OR,
+		JSOP_BINAND,
+		JSOP_BINOR,
+		JSOP_XOR,
+
+		JSOP_PUSHIMM,	///< Decoded JSOP_PUSH, JSOPARG_IMM.
+		JSOP_PUSHTAB,	///< Decoded JSOP_PUSH, JSOPARG_TAB.
+		JSOP_PUSHSTK,	///< Decoded JSOP_PUSH, JSOPARG_STK.
+		JSOP_DEREFTAB,	///< Decoded JSOP_DEREF, JSOPARG_TAB.
+
+		JSOP_COUNT
+	};
+
+	enum JsOpCodeArgSrc
+	{
+		JSOPARG_NONE = 0,
+		JSOPARG_IMM,	///< The argument is the value.
+		JSOPARG_TAB,	///< The argument indexes the constant table.
+		JSOPARG_STK		///< The argument indexes the locals of the current frame.
+	};
+}
+
+#endif
@@ -0,0 +1,196 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _interp_program_h
+#define _interp_program_h
+
+#include <spl/types.h>
+#include <spl/Debug.h>
+#include <spl/Memory.h>
+#include <spl/interp/OpCodes.h>
+#include <spl/RefCountPtr.h>
+#include <spl/collection/StringTable.h>
+#include <spl/Variant.h>
+#include <spl/collection/Vector.h>
+
+namespace spl
+{
+	/** @brief One instruction as emitted by JsParse. */
+	struct Instruction
+	{
+		uint32 opCode : 8;
+		uint32 argSrc : 4;
+		int32 argIdx : 24;
+	};
+
+	inline void TypeValidate(const struct Instruction& i)
+	{
+	}
+
+	inline void TypeCheckMem(const struct Instruction& i)
+	{
+	}
+
+	/** @brief A pre-decoded instruction, built by Program::ParseComplete.
+	 *	Jump targets are absolute, PUSH and DEREF are split by argument source,
+	 *	and label is the VarInterp handler address once the program has been
+	 *	threaded.  FINDPROP, DEFPROP and DEREFTAB keep an inline cache of the
+	 *	last shape they found their property in.
+	 */
+	struct JsCode
+	{
+		const void *label;
+		int32 op;
+		int32 arg;
+		int32 aux;
+		int32 slot;			///< Cached slot of the property.
+		uint32 shape;		///< JsShape::Id of the object the slot was found for, or JSSHAPE_NO_ID.
+		uint32 holder;		///< FINDPROP only: the id of the outer context the slot is in, or JSSHAPE_NO_ID if it's in the object.
+	};
+
+	inline void TypeValidate(const struct JsCode& c)
+	{
+	}
+
+	inline void TypeCheckMem(const struct JsCode& c)
+	{
+	}
+
+	class Program;
+	typedef RefCountPtr<Program> ProgramPtr;
+
+	/** @brief Byte code for one script or function body.
+	 *	JsParse appends instructions with AppendCode, then ParseComplete decodes
+	 *	them into the JsCode array VarInterp runs.  Each function body becomes
+	 *	its own Program, sharing the constant table of the outer one.
+	 */
+	class Program : public IMemoryValidate
+	{
+	private:
+		Vector<VariantPtr> m_cdata;
+		Vector<Instruction> m_code;
+		Instruction m_exitInstr;
+		int m_argCount;				//< This many items should be on the stack when program is ran.
+
+		Vector<JsCode> m_decoded;
+		Vector<StringPtr> m_names;		//< m_cdata as strings, for property look ups.
+		Vector<ProgramPtr> m_functions;
+		bool m_threaded;
+
+		void Decode(int pc, JsCode& code);
+
+	public:
+		Program();
+		Program(const Program& program);
+		Program& operator =(const Program& program);
+		virtual ~Program();
+
+		void Clear();
+
+		inline void NoteArgument() { m_argCount++; }
+		inline int& ArgumentCount() { return m_argCount; }
+
+		int AddToTable(const String& s);
+		int AddToTable(const int32 i);
+		int AddToTable(const float64 f);
+		int AddToTable(const Date& dt);
+		int AddToTable(const DateTime& dtm);
+
+		inline int AddToTable(VariantPtr v) { m_cdata.Add(v); return m_cdata.Count() - 1; }
+		inline void SetTable(const Vector<VariantPtr>& cdata) { m_cdata.Clear(); m_cdata = cdata; }
+		inline const Vector<VariantPtr>& GetTable() const { return m_cdata; }
+
+		int AppendCode(enum JsOpCode i, JsOpCodeArgSrc s, int32 idx);
+		inline int AppendCode(enum JsOpCode c) { return AppendCode(c, JSOPARG_NONE, 0); }
+		inline int AppendCode(Instruction i) { return AppendCode((JsOpCode)i.opCode, (JsOpCodeArgSrc)i.argSrc, i.argIdx); }
+
+		inline int Position() const { return m_code.Count()-1; }
+
+		inline void FixupCode(int pos, int32 idx)
+		{
+			m_code.ElementAtRef(pos).argIdx = idx;
+		}
+
+		inline void FixupCode(int pos)
+		{
+			m_code.ElementAtRef(pos).argIdx = Position() - pos;
+		}
+
+		inline bool CanContinue(int pc) const
+		{
+			return pc >= 0 && pc < m_code.Count();
+		}
+
+		inline Instruction InstructionAt(int pc) const
+		{
+			if (0 > pc || pc >= m_code.Count())
+			{
+				return m_exitInstr;
+			}
+			return m_code.ElementAt(pc);
+		}
+
+		inline VariantPtr GetArg(Instruction i, Vector<VariantPtr>& stk) const
+		{
+			if (JSOPARG_IMM == i.argSrc)
+			{
+				return VariantPtr(new Variant((int32)i.argIdx));
+			}
+			if (JSOPARG_TAB == i.argSrc)
+			{
+				return m_cdata.ElementAt(i.argIdx);
+			}
+			if (JSOPARG_STK == i.argSrc)
+			{
+				return stk.ElementAt(i.argIdx);
+			}
+			throw new Exception("Invalid argument source in Program::GetArg");
+		}
+
+		/** @brief Decodes the instructions for VarInterp; called by JsParse when the source is parsed.
+		 *	Function bodies are moved into their own Programs, see Function().
+		 */
+		void ParseComplete();
+
+		/// @brief The decoded instructions, ending with a JSOP_ENDFN.
+		inline JsCode *Code() { return m_decoded.Data(); }
+		inline int CodeCount() const { return m_decoded.Count(); }
+
+		inline VariantPtr *Table() { return m_cdata.Data(); }
+
+		/// @brief The constant at idx as a string, without converting it on every look up.
+		inline const String& NameAt(int idx) const { return *m_names.ElementAtRef(idx); }
+
+		/// @brief The body of the JSOP_DEFFUNC whose aux is idx.
+		inline ProgramPtr Function(int idx) const { return m_functions.ElementAt(idx); }
+
+		/** @brief Sets JsCode::label from labels, indexed by op code.  Done once, the first time VarInterp runs the program. */
+		void Thread(const void * const *labels);
+		inline bool IsThreaded() const { return m_threaded; }
+
+		StringPtr ToString();
+
+	#if defined(DEBUG) || defined(_DEBUG)
+		void CheckMem() const;
+		void ValidateMem() const;
+	#endif
+	};
+
+	extern String _JsOpCodeToString(enum JsOpCode c);
+	extern String _JsOpArgSrcToString(enum JsOpCodeArgSrc a);
+}
+
+#endif
@@ -0,0 +1,204 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _varinterp_h
+#define _varinterp_h
+
+#include <spl/types.h>
+#include <spl/Debug.h>
+#include <spl/Memory.h>
+#include <spl/RefCountPtr.h>
+#include <spl/collection/Vector.h>
+#include <spl/interp/JsMethod.h>
+#include <spl/interp/Program.h>
+#include <spl/Variant.h>
+
+namespace spl
+{
+	/// Script calls nested deeper than this throw a StateException.
+	#define VARINTERP_MAX_FRAMES 4096
+
+	/** @brief Private, for internal use.  A script function being run by VarInterp. */
+	struct _JsFrame
+	{
+		VariantPtr fn;		///< The JsMethod being run; "this" in the function.
+		JsObject *self;		///< fn as an object.
+		Program *prog;
+		int pc;				///< Where to continue when a call returns.
+		int base;			///< Stack index of the first argument.
+		int scopes;			///< Scope count when the function was entered.
+		int boxes;
+	};
+
+	/** @brief Private, for internal use.  An ENTER. */
+	struct _JsScope
+	{
+		int target;			///< Decoded break target, or -1.
+		int depth;			///< Stack count at the ENTER.
+		int boxes;
+	};
+
+	inline void TypeValidate(const _JsFrame& f)
+	{
+		f.fn.ValidateMem();
+	}
+
+	inline void TypeCheckMem(const _JsFrame& f)
+	{
+		f.fn.CheckMem();
+	}
+
+	inline void TypeValidate(const _JsScope& s)
+	{
+	}
+
+	inline void TypeCheckMem(const _JsScope& s)
+	{
+	}
+
+	class VarInterp;
+	typedef RefCountPtr<VarInterp> VarInterpPtr;
+
+	/** @brief Runs the Programs made by JsParse.
+	 *	The decoded instructions are dispatched by jumping straight to each
+	 *	handler's address (computed goto) where the compiler supports it, and
+	 *	through a switch otherwise.  Values live on one stack that is reused for
+	 *	the whole run: script functions are called without recursing in C, with
+	 *	their arguments left in place as their first locals, and natives get one
+	 *	argument Vector that is reused for every call.
+	 */
+	class VarInterp : public IMemoryValidate
+	{
+	private:
+		Vector<VariantPtr> m_stk;		//< Only [0, m_sp) is in use; the rest are released.
+		int m_sp;
+		Vector<_JsFrame> m_frames;
+		Vector<_JsScope> m_scopes;
+		Vector<VariantPtr> m_boxes;		//< Strings wrapped in a JsString while one of their methods is called.
+		Vector<VariantPtr> m_args;		//< Arguments to native functions.
+		JsObject *m_global;
+		Variant m_one;
+		int m_line;
+		bool m_done;
+
+		inline VarInterp(const VarInterp&) {}
+		inline void operator =(const VarInterp&) {}
+
+		inline VariantPtr& Top(int n = 0)
+		{
+			ASSERT(m_sp > n);
+			return m_stk.Data()[m_sp - 1 - n];
+		}
+
+		inline void Push(const VariantPtr& v)
+		{
+			if (m_sp == m_stk.Count())
+			{
+				// v may be in m_stk, which Add can move.
+				VariantPtr keep(v);
+				m_stk.Add(keep);
+			}
+			else
+			{
+				m_stk.Data()[m_sp] = v;
+			}
+			m_sp++;
+		}
+
+		inline void Drop(int n = 1)
+		{
+			ASSERT(m_sp >= n);
+			while (n-- > 0)
+			{
+				m_stk.Data()[--m_sp].Release();
+			}
+		}
+
+		inline void Truncate(int depth)
+		{
+			if (m_sp > depth)
+			{
+				Drop(m_sp - depth);
+			}
+		}
+
+		void TruncateBoxes(int count);
+		void PopScope();
+		void EnterFrame(const VariantPtr& fn, JsMethod *method, int base);
+		void LeaveFrame();
+		void Return(const VariantPtr& ret);
+		VariantPtr LookUp(const String& name);
+		VariantPtr LookUp(const String& name, JsCode *ip);
+		VariantPtr Deref(const VariantPtr& obj, const String& name);
+		static void CacheSlot(JsCode *ip, JsObject *obj, const String& name);
+		static JsMethod *AsMethod(const VariantPtr& fn);
+
+		static inline JsObject *AsObject(const VariantPtr& v)
+		{
+			return v->IsObject() ? static_cast<JsObject *>(v->ToObject().Get()) : NULL;
+		}
+
+		/// @brief The object FINDPROP's inline cache says has the property, or NULL on a miss.
+		static inline JsObject *CachedHolder(JsObject *self, const JsCode *ip)
+		{
+			if (JSSHAPE_NO_ID == ip->shape || self->ShapeId() != ip->shape)
+			{
+				return NULL;
+			}
+			if (JSSHAPE_NO_ID == ip->holder)
+			{
+				return self;
+			}
+			JsObject *outer = self->OuterContext();
+			return (NULL != outer && outer->ShapeId() == ip->holder) ? outer : NULL;
+		}
+		static bool IsTrue(const Variant& v);
+
+		bool Run(bool step);
+
+	public:
+		VarInterp();
+
+		/** @brief Gets ready to run method, a JsMethod, with args as its arguments. */
+		VarInterp(VariantPtr method, Vector<VariantPtr>& args);
+		virtual ~VarInterp();
+
+		/** @brief Runs to the end of the method, or one instruction if toCompletion is false.
+		 *	@return True if there is more to run.
+		 */
+		bool Execute(bool toCompletion);
+
+		/** @brief Looks a name up the way the running code would. */
+		VariantPtr FindProperty(const String& name);
+
+		VariantPtr StackPeek();
+		void PopStack();
+		inline int StackCount() const { return m_sp; }
+
+		/// @brief The last JSOP_LINE run, if the program was parsed for debugging.
+		inline int LineNumber() const { return m_line; }
+
+		/** @brief A JsMethod for prog with the built in objects (Array, Console, Math, ...) defined. */
+		static IJsObjectPtr CreateDefaultContext(ProgramPtr prog);
+
+	#if defined(DEBUG) || defined(_DEBUG)
+		void CheckMem() const;
+		void ValidateMem() const;
+	#endif
+	};
+}
+
+#endif
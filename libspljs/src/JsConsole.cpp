@@ -13,6 +13,11 @@ JsConsole::~JsConsole()
 {
 }
 
+bool JsConsole::CanCacheProperties() const
+{
+	return false;
+}
+
 VariantPtr JsConsole::GetProperty(const String& idx)
 {
 	return JsObject::GetProperty(idx);
@@ -33,6 +33,11 @@ void JsMath::SetFunctions()
 	SetProperty("tan", VariantPtr(new Variant(RefCountPtr<IJsObject> (new JsFunctionDispatch(this, 1, JsMathTan)))));
 }
 
+bool JsMath::CanCacheProperties() const
+{
+	return false;
+}
+
 VariantPtr JsMath::GetProperty(const String& idx)
 {
 	if (idx == "E")
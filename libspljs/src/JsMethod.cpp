@@ -16,6 +16,7 @@
  */
 #include <spl/interp/JsArray.h>
 #include <spl/interp/JsMethod.h>
+#include <spl/interp/VarInterp.h>
 
 using namespace spl;
 
@@ -40,10 +41,12 @@ JsMethod::~JsMethod()
 
 IJsObjectPtr JsMethod::New()
 {
+	EnsureShape();
 	JsMethod *obj = new JsMethod(*this);
-	if (NULL != m_properties && m_properties->ContainsKey("super"))
+	VariantPtr *super = FindOwn("super");
+	if (NULL != super)
 	{
-		SetProperty("super", m_properties->Get("super")->Clone());		
+		SetProperty("super", (*super)->Clone());
 	}
 	return IJsObjectPtr(obj);
 }
@@ -60,7 +63,17 @@ int JsMethod::ArgumentCount()
 
 VariantPtr JsMethod::Call(JsMethod *isthis, Vector<VariantPtr>& args)
 {
-	throw new Exception("Call of non native method");
+	// Calls from script never get here, VarInterp runs them in its own frames.
+	// This is for natives (and C++) calling back into a script function.
+	VariantPtr method(new Variant(isthis->New()));
+	VarInterp vi(method, args);
+	vi.Execute(true);
+
+	if (0 == vi.StackCount())
+	{
+		return VariantPtr(new Variant());
+	}
+	return vi.StackPeek();
 }
 
 VariantPtr JsMethod::GetProperty(const String& idx)
@@ -79,6 +92,11 @@ bool JsMethod::HasProperty(const String& idx) const
 
 void JsMethod::SetProperty(const String& idx, VariantPtr obj)
 {
+	if ("arguments" == idx)
+	{
+		// Read only, GetProperty always answers with the argument count.
+		return;
+	}
 	JsObject::SetProperty(idx, obj);
 }
 
@@ -36,6 +36,11 @@ StringPtr JsRegExp::TypeName() const
 	return StringPtr(new String("RegExp"));
 }
 
+bool JsRegExp::CanCacheProperties() const
+{
+	return false;
+}
+
 VariantPtr JsRegExp::GetProperty(const String& idx)
 {
 	if (idx == "global")
@@ -0,0 +1,360 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <spl/Int32.h>
+#include <spl/interp/JsShape.h>
+#include <spl/interp/Program.h>
+#include <spl/text/StringBuffer.h>
+
+using namespace spl;
+
+Program::Program()
+: m_cdata(), m_code(), m_argCount(0), m_decoded(), m_names(), m_functions(), m_threaded(false)
+{
+	m_exitInstr.opCode = JSOP_ENDFN;
+	m_exitInstr.argSrc = JSOPARG_NONE;
+	m_exitInstr.argIdx = 0;
+
+	// Methods made without a parse, like the Object constructor, still need an ENDFN to run.
+	ParseComplete();
+}
+
+Program::Program(const Program& program)
+: m_cdata(program.m_cdata),
+  m_code(program.m_code),
+  m_exitInstr(program.m_exitInstr),
+  m_argCount(program.m_argCount),
+  m_decoded(program.m_decoded),
+  m_names(program.m_names),
+  m_functions(program.m_functions),
+  m_threaded(program.m_threaded)
+{
+}
+
+Program& Program::operator =(const Program& program)
+{
+	m_cdata = program.m_cdata;
+	m_code = program.m_code;
+	m_exitInstr = program.m_exitInstr;
+	m_argCount = program.m_argCount;
+	m_decoded = program.m_decoded;
+	m_names = program.m_names;
+	m_functions = program.m_functions;
+	m_threaded = program.m_threaded;
+	return *this;
+}
+
+Program::~Program()
+{
+}
+
+void Program::Clear()
+{
+	m_cdata.Clear();
+	m_code.Clear();
+	m_decoded.Clear();
+	m_names.Clear();
+	m_functions.Clear();
+	m_argCount = 0;
+	m_threaded = false;
+}
+
+int Program::AddToTable(const String& s)
+{
+	return AddToTable(VariantPtr(new Variant(s)));
+}
+
+int Program::AddToTable(const int32 i)
+{
+	return AddToTable(VariantPtr(new Variant(i)));
+}
+
+int Program::AddToTable(const float64 f)
+{
+	return AddToTable(VariantPtr(new Variant(f)));
+}
+
+int Program::AddToTable(const Date& dt)
+{
+	return AddToTable(VariantPtr(new Variant(dt)));
+}
+
+int Program::AddToTable(const DateTime& dtm)
+{
+	return AddToTable(VariantPtr(new Variant(dtm)));
+}
+
+int Program::AppendCode(enum JsOpCode i, JsOpCodeArgSrc s, int32 idx)
+{
+	Instruction instr;
+	instr.opCode = i;
+	instr.argSrc = s;
+	instr.argIdx = idx;
+	m_code.Add(instr);
+	return m_code.Count() - 1;
+}
+
+void Program::Decode(int pc, JsCode& code)
+{
+	Instruction i = m_code.ElementAt(pc);
+
+	code.label = NULL;
+	code.op = i.opCode;
+	code.arg = i.argIdx;
+	code.aux = 0;
+	code.slot = 0;
+	code.shape = JSSHAPE_NO_ID;
+	code.holder = JSSHAPE_NO_ID;
+
+	switch (i.opCode)
+	{
+		case JSOP_PUSH:
+			switch (i.argSrc)
+			{
+				case JSOPARG_IMM:
+					code.op = JSOP_PUSHIMM;
+					break;
+				case JSOPARG_TAB:
+					code.op = JSOP_PUSHTAB;
+					break;
+				case JSOPARG_STK:
+					code.op = JSOP_PUSHSTK;
+					break;
+				default:
+					throw new Exception("Invalid argument source for PUSH in Program::ParseComplete");
+			}
+			break;
+		case JSOP_DEREF:
+			if (JSOPARG_TAB == i.argSrc)
+			{
+				code.op = JSOP_DEREFTAB;
+			}
+			break;
+		case JSOP_JMP:
+		case JSOP_JMPZ:
+			code.arg = pc + i.argIdx + 1;
+			break;
+		case JSOP_ENTER:
+			// Only loop and switch blocks have a break target.
+			code.arg = 0 == i.argIdx ? -1 : pc + i.argIdx + 1;
+			break;
+		case JSOP_SWITCH:
+			// The case offsets in the dispatch object are relative to the SWITCH.
+			code.arg = pc;
+			break;
+	}
+}
+
+void Program::ParseComplete()
+{
+	m_decoded.Clear();
+	m_functions.Clear();
+	m_threaded = false;
+
+	if (m_names.Count() != m_cdata.Count())
+	{
+		m_names.Clear();
+		for (int x = 0; x < m_cdata.Count(); x++)
+		{
+			m_names.Add(m_cdata.ElementAt(x)->ToString());
+		}
+	}
+
+	JsCode code;
+	int count = m_code.Count();
+
+	for (int pc = 0; pc < count; pc++)
+	{
+		if (JSOP_DEFFUNC != m_code.ElementAt(pc).opCode)
+		{
+			Decode(pc, code);
+			m_decoded.Add(code);
+			continue;
+		}
+
+		// The body, up to ENDFN, becomes its own program.  JsParse pushes
+		// the argument count two instructions before the DEFFUNC.
+		int end = pc + m_code.ElementAt(pc).argIdx;
+		ASSERT(end < count && JSOP_ENDFN == m_code.ElementAt(end).opCode);
+
+		ProgramPtr fn(new Program());
+		fn->SetTable(m_cdata);
+		fn->m_names = m_names;
+		for (int x = pc + 1; x < end; x++)
+		{
+			fn->m_code.Add(m_code.ElementAt(x));
+		}
+		if (pc >= 2 && JSOP_PUSH == m_code.ElementAt(pc - 2).opCode && JSOPARG_IMM == m_code.ElementAt(pc - 2).argSrc)
+		{
+			fn->m_argCount = m_code.ElementAt(pc - 2).argIdx;
+		}
+		fn->ParseComplete();
+
+		Decode(pc, code);
+		code.arg = end + 1;
+		code.aux = m_functions.Count();
+		m_functions.Add(fn);
+		m_decoded.Add(code);
+
+		// Keep the positions the same as m_code; the body is never run from here.
+		code.op = JSOP_NOP;
+		code.arg = 0;
+		code.aux = 0;
+		while (pc < end)
+		{
+			m_decoded.Add(code);
+			pc++;
+		}
+	}
+
+	code.label = NULL;
+	code.op = JSOP_ENDFN;
+	code.arg = 0;
+	code.aux = 0;
+	code.slot = 0;
+	code.shape = JSSHAPE_NO_ID;
+	code.holder = JSSHAPE_NO_ID;
+	m_decoded.Add(code);
+}
+
+void Program::Thread(const void * const *labels)
+{
+	int count = m_decoded.Count();
+	JsCode *code = m_decoded.Data();
+
+	for (int x = 0; x < count; x++)
+	{
+		code[x].label = labels[code[x].op];
+	}
+	m_threaded = true;
+}
+
+StringPtr Program::ToString()
+{
+	StringBuffer buf;
+
+	for (int pc = 0; pc < m_code.Count(); pc++)
+	{
+		Instruction i = m_code.ElementAt(pc);
+
+		buf.Append(Int32::ToString(pc));
+		buf.Append('\t');
+		buf.Append(_JsOpCodeToString((JsOpCode)i.opCode));
+		if (JSOPARG_NONE != i.argSrc || 0 != i.argIdx)
+		{
+			buf.Append('\t');
+			buf.Append(_JsOpArgSrcToString((JsOpCodeArgSrc)i.argSrc));
+			buf.Append(' ');
+			buf.Append(Int32::ToString(i.argIdx));
+			if (JSOPARG_TAB == i.argSrc && i.argIdx < m_cdata.Count())
+			{
+				buf.Append("\t; ");
+				buf.Append(m_cdata.ElementAt(i.argIdx)->ToString());
+			}
+		}
+		buf.Append('\n');
+	}
+
+	return buf.ToString();
+}
+
+String spl::_JsOpCodeToString(enum JsOpCode c)
+{
+	switch (c)
+	{
+		case JSOP_NOP: return "NOP";
+		case JSOP_LINE: return "LINE";
+		case JSOP_PUSH: return "PUSH";
+		case JSOP_POP: return "POP";
+		case JSOP_DUP: return "DUP";
+		case JSOP_ROT: return "ROT";
+		case JSOP_RVAL: return "RVAL";
+		case JSOP_NULL: return "NULL";
+		case JSOP_THIS: return "THIS";
+		case JSOP_ASSIGN: return "ASSIGN";
+		case JSOP_FINDPROP: return "FINDPROP";
+		case JSOP_DEFPROP: return "DEFPROP";
+		case JSOP_DEREF: return "DEREF";
+		case JSOP_NEW: return "NEW";
+		case JSOP_ENTER: return "ENTER";
+		case JSOP_LEAVE: return "LEAVE";
+		case JSOP_BREAK: return "BREAK";
+		case JSOP_JMP: return "JMP";
+		case JSOP_JMPZ: return "JMPZ";
+		case JSOP_SWITCH: return "SWITCH";
+		case JSOP_CALL: return "CALL";
+		case JSOP_RET: return "RET";
+		case JSOP_DEFFUNC: return "DEFFUNC";
+		case JSOP_ENDFN: return "ENDFN";
+		case JSOP_SETCTX: return "SETCTX";
+		case JSOP_ADD: return "ADD";
+		case JSOP_SUB: return "SUB";
+		case JSOP_MULT: return "MULT";
+		case JSOP_DIV: return "DIV";
+		case JSOP_MOD: return "MOD";
+		case JSOP_NEGATE: return "NEGATE";
+		case JSOP_INC: return "INC";
+		case JSOP_DEC: return "DEC";
+		case JSOP_EQ: return "EQ";
+		case JSOP_NEQ: return "NEQ";
+		case JSOP_LT: return "LT";
+		case JSOP_GT: return "GT";
+		case JSOP_LTEQ: return "LTEQ";
+		case JSOP_GTEQ: return "GTEQ";
+		case JSOP_AND: return "AND";
+		case JSOP_OR: return "OR";
+		case JSOP_BINAND: return "BINAND";
+		case JSOP_BINOR: return "BINOR";
+		case JSOP_XOR: return "XOR";
+		case JSOP_PUSHIMM: return "PUSHIMM";
+		case JSOP_PUSHTAB: return "PUSHTAB";
+		case JSOP_PUSHSTK: return "PUSHSTK";
+		case JSOP_DEREFTAB: return "DEREFTAB";
+		default: return "???";
+	}
+}
+
+String spl::_JsOpArgSrcToString(enum JsOpCodeArgSrc a)
+{
+	switch (a)
+	{
+		case JSOPARG_NONE: return "";
+		case JSOPARG_IMM: return "IMM";
+		case JSOPARG_TAB: return "TAB";
+		case JSOPARG_STK: return "STK";
+		default: return "???";
+	}
+}
+
+#if defined(DEBUG) || defined(_DEBUG)
+void Program::CheckMem() const
+{
+	m_cdata.CheckMem();
+	m_code.CheckMem();
+	m_decoded.CheckMem();
+	m_names.CheckMem();
+	m_functions.CheckMem();
+}
+
+void Program::ValidateMem() const
+{
+	m_cdata.ValidateMem();
+	m_code.ValidateMem();
+	m_decoded.ValidateMem();
+	m_names.ValidateMem();
+	m_functions.ValidateMem();
+}
+#endif
@@ -44,6 +44,11 @@ IJsObjectPtr JsArray::New()
 	return IJsObjectPtr(obj);
 }
 
+bool JsArray::CanCacheProperties() const
+{
+	return false;
+}
+
 VariantPtr JsArray::GetProperty(const String& idx)
 {
 	if ("length" == idx)
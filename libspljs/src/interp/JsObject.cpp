@@ -27,96 +27,179 @@ IJsObject::~IJsObject()
 //const char *JsObject::CONTAINER_PROPERKTY_NAME = "$___container____$";
 
 JsObject::JsObject(const JsObject& obj)
-: m_properties(NULL), m_container(NULL)
+: m_shape(obj.m_shape), m_slots(NULL), m_properties(NULL), m_container(NULL)
 {
-	if (NULL != obj.m_properties)
+	if (NULL != m_shape)
 	{
+		m_shape->AddRef();
+		m_slots = new Vector<VariantPtr>(m_shape->SlotCount() + 1);
+		for (int x = 0; x < m_shape->SlotCount(); x++)
+		{
+			m_slots->Add(obj.m_slots->ElementAt(x)->Clone());
+		}
+	}
+	else if (NULL != obj.m_properties)
+	{
+		m_properties = new Hashtable<String, VariantPtr>();
 		foreach(v,(*obj.m_properties))
 		{
-			SetProperty(v.CurrentKey(), v.Current()->Clone());
+			m_properties->Set(v.CurrentKey(), v.Current()->Clone());
 		}
 	}
 }
 
 JsObject::~JsObject()
 {
+	if (NULL != m_slots)
+	{
+		delete m_slots;
+	}
+	if (NULL != m_shape)
+	{
+		m_shape->Release();
+	}
 	if (NULL != m_properties)
 	{
 		delete m_properties;
 	}
 }
 
+bool JsObject::CanCacheProperties() const
+{
+	return true;
+}
+
+void JsObject::EnsureShape()
+{
+	if (NULL == m_shape && NULL == m_properties)
+	{
+		m_shape = new JsShape(CanCacheProperties());
+		m_slots = new Vector<VariantPtr>(4);
+	}
+}
+
+VariantPtr *JsObject::FindOwn(const String& idx) const
+{
+	if (NULL != m_shape)
+	{
+		int slot = m_shape->Find(idx);
+		return (0 > slot) ? NULL : &m_slots->Data()[slot];
+	}
+	if (NULL != m_properties && m_properties->ContainsKey(idx))
+	{
+		return &m_properties->GetRef(idx);
+	}
+	return NULL;
+}
+
+void JsObject::AddOwn(const String& idx, VariantPtr obj)
+{
+	ASSERT(NULL == FindOwn(idx));
+
+	EnsureShape();
+	if (NULL != m_properties)
+	{
+		m_properties->Set(idx, obj);
+		return;
+	}
+
+	if (m_shape->SlotCount() < JSSHAPE_MAX_SLOTS)
+	{
+		JsShape *next = m_shape->Add(idx);
+		m_shape->Release();
+		m_shape = next;
+		m_slots->Add(obj);
+		return;
+	}
+
+	// Too many properties to keep sharing shapes, switch to dictionary mode.
+	m_properties = new Hashtable<String, VariantPtr>();
+	for (int x = 0; x < m_shape->SlotCount(); x++)
+	{
+		m_properties->Set(m_shape->NameAt(x), m_slots->ElementAt(x));
+	}
+	m_properties->Set(idx, obj);
+
+	delete m_slots;
+	m_slots = NULL;
+	m_shape->Release();
+	m_shape = NULL;
+}
+
 IJsObjectPtr JsObject::New()
 {
+	EnsureShape();
 	JsObject *obj = new JsObject(*this);
-	if (NULL != m_properties && m_properties->ContainsKey("super"))
+	VariantPtr *super = FindOwn("super");
+	if (NULL != super)
 	{
-		obj->SetProperty("super", m_properties->Get("super")->Clone());
+		obj->SetProperty("super", (*super)->Clone());
 	}
 	return IJsObjectPtr(obj);
 }
 
 VariantPtr JsObject::GetProperty(const String& idx)
 {
-	if (NULL == m_properties)
+	VariantPtr *own = FindOwn(idx);
+	if (NULL != own)
 	{
-		m_properties = new Hashtable<String, VariantPtr>();
+		return *own;
 	}
-	if (! m_properties->ContainsKey(idx))
+
+	VariantPtr *super = FindOwn("super");
+	if (NULL != super)
 	{
-		if (m_properties->ContainsKey("super"))
+		if ((*super)->ToObject()->HasProperty(idx))
 		{
-			if (m_properties->Get("super")->ToObject()->HasProperty(idx))
-			{
-				return m_properties->Get("super")->ToObject()->GetProperty(idx);
-			}
+			return (*super)->ToObject()->GetProperty(idx);
 		}
-		if (NULL != m_container)
+	}
+	if (NULL != m_container)
+	{
+		if (m_container->HasProperty(idx))
 		{
-			if (m_container->HasProperty(idx))
-			{
-				return m_container->GetProperty(idx);
-			}
+			return m_container->GetProperty(idx);
 		}
-		m_properties->Set(idx, VariantPtr(new Variant(Undefined::Instance())));
 	}
-	return m_properties->Get(idx);
+
+	VariantPtr prop(new Variant(Undefined::Instance()));
+	AddOwn(idx, prop);
+	return prop;
 }
 
 bool JsObject::HasProperty(const String& idx) const
 {
-	if (NULL != m_properties)
+	if (NULL != FindOwn(idx))
 	{
-		if( m_properties->ContainsKey(idx) )
-		{
-			return true;
-		}
-		if (m_properties->ContainsKey("super"))
-		{
-			if (m_properties->Get("super")->IsObject())
-			{
-				return m_properties->Get("super")->ToObject()->HasProperty(idx);
-			}
-		}
+		return true;
+	}
+	VariantPtr *super = FindOwn("super");
+	if (NULL != super && (*super)->IsObject())
+	{
+		return (*super)->ToObject()->HasProperty(idx);
 	}
 	return false;
 }
 
 void JsObject::SetProperty(const String& idx, VariantPtr obj)
 {
-	if (NULL == m_properties)
+	VariantPtr *super = FindOwn("super");
+	if (NULL != super)
 	{
-		m_properties = new Hashtable<String, VariantPtr>();
-	}
-	if (m_properties->ContainsKey("super"))
-	{
-		if (m_properties->Get("super")->ToObject()->HasProperty(idx))
+		if ((*super)->ToObject()->HasProperty(idx))
 		{
-			m_properties->Get("super")->ToObject()->SetProperty(idx, obj);
+			(*super)->ToObject()->SetProperty(idx, obj);
 			return;
 		}
 	}
-	if (!m_properties->ContainsKey(idx) && NULL != m_container)
+
+	VariantPtr *own = FindOwn(idx);
+	if (NULL != own)
+	{
+		*own = obj;
+		return;
+	}
+	if (NULL != m_container)
 	{
 		if (m_container->HasProperty(idx))
 		{
@@ -124,7 +207,7 @@ void JsObject::SetProperty(const String& idx, VariantPtr obj)
 			return;
 		}
 	}
-	m_properties->Set(idx, obj);
+	AddOwn(idx, obj);
 }
 
 StringPtr JsObject::ToString() const
@@ -174,6 +257,13 @@ uint32 JsObject::HashCode() const
 #if defined(DEBUG) || defined(_DEBUG)
 void JsObject::CheckMem() const
 {
+	if (NULL != m_shape)
+	{
+		DEBUG_NOTE_MEM(m_shape);
+		m_shape->CheckMem();
+		DEBUG_NOTE_MEM(m_slots);
+		m_slots->CheckMem();
+	}
 	if (NULL != m_properties)
 	{
 		Debug::NoteMem(m_properties);
@@ -183,6 +273,14 @@ void JsObject::CheckMem() const
 
 void JsObject::ValidateMem() const
 {
+	if (NULL != m_shape)
+	{
+		ASSERT_MEM(m_shape, sizeof(JsShape));
+		m_shape->ValidateMem();
+		ASSERT_MEM(m_slots, sizeof(Vector<VariantPtr>));
+		m_slots->ValidateMem();
+		ASSERT(m_slots->Count() == m_shape->SlotCount());
+	}
 	if (NULL != m_properties)
 	{
 		Debug::AssertMem(m_properties, sizeof(Hashtable<String, VariantPtr>));
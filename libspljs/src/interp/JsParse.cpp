@@ -175,16 +175,32 @@ morevar		: ID ASSIGN expr COMMA morevar
 void JsParse::MoreVar()
 {
 	//m_prog->AppendCode(JSOP_DEFPROP, JSOPARG_TAB, m_prog->AddToTable(m_lex.Lexum().ToString()));
-	m_locals.PeekRef()->Set(*m_lex.Lexum().ToString(), m_locals.PeekRef()->Count());
-	m_prog->AppendCode(JSOP_PUSH, JSOPARG_IMM, 0);
+	StringPtr id(m_lex.Lexum().ToString());
 	Match(JsLex::T_ID);
-	
-	if (m_lex.CurrentToken() == JsLex::T_ASSIGN)
+
+	if (m_locals.PeekRef()->ContainsKey(*id))
 	{
-		m_prog->AppendCode(JSOP_DUP);
-		Match(JsLex::T_ASSIGN);
-		Expr();
-		m_prog->AppendCode(JSOP_ASSIGN);
+		// Declared again (for (var i ...) twice), it's the same variable.
+		if (m_lex.CurrentToken() == JsLex::T_ASSIGN)
+		{
+			m_prog->AppendCode(JSOP_PUSH, JSOPARG_STK, m_locals.PeekRef()->Get(*id));
+			Match(JsLex::T_ASSIGN);
+			Expr();
+			m_prog->AppendCode(JSOP_ASSIGN);
+		}
+	}
+	else
+	{
+		m_locals.PeekRef()->Set(*id, m_locals.PeekRef()->Count());
+		m_prog->AppendCode(JSOP_PUSH, JSOPARG_IMM, 0);
+
+		if (m_lex.CurrentToken() == JsLex::T_ASSIGN)
+		{
+			m_prog->AppendCode(JSOP_DUP);
+			Match(JsLex::T_ASSIGN);
+			Expr();
+			m_prog->AppendCode(JSOP_ASSIGN);
+		}
 	}
 	if (m_lex.CurrentToken() == JsLex::T_COMMA)
 	{
@@ -0,0 +1,126 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <spl/interp/JsShape.h>
+
+#ifdef _WINDOWS
+#include <spl/cleanwindows.h>
+#endif
+
+using namespace spl;
+
+static volatile int32 _jsShapeLastId = JSSHAPE_NO_ID;
+
+uint32 JsShape::NextId()
+{
+	uint32 id;
+	do
+	{
+		// Ids are cached by Programs, which may be shared between threads.
+#if defined(_WINDOWS)
+		id = (uint32)InterlockedIncrement((volatile LONG *)&_jsShapeLastId);
+#elif defined(HAVE_ATOMIC_BUILTINS)
+		id = (uint32)__sync_add_and_fetch(&_jsShapeLastId, 1);
+#else
+		id = (uint32)++_jsShapeLastId;
+#endif
+	} while (JSSHAPE_NO_ID == id);
+
+	return id;
+}
+
+JsShape::JsShape(bool cacheable)
+: m_parent(NULL), m_names(4), m_transitions(2), m_id(NextId()), m_refs(1), m_cacheable(cacheable)
+{
+}
+
+JsShape::JsShape(JsShape *parent, const String& name)
+: m_parent(parent), m_names(parent->m_names.Count() + 1), m_transitions(2), m_id(NextId()), m_refs(1), m_cacheable(parent->m_cacheable)
+{
+	m_parent->AddRef();
+	for (int x = 0; x < parent->m_names.Count(); x++)
+	{
+		m_names.Add(parent->m_names.ElementAt(x));
+	}
+	m_names.Add(StringPtr(new String(name)));
+}
+
+JsShape::~JsShape()
+{
+	ASSERT(0 == m_transitions.Count());
+	if (NULL != m_parent)
+	{
+		m_parent->RemoveTransition(this);
+		m_parent->Release();
+	}
+}
+
+void JsShape::RemoveTransition(JsShape *child)
+{
+	for (int x = 0; x < m_transitions.Count(); x++)
+	{
+		if (m_transitions.ElementAt(x) == child)
+		{
+			m_transitions.RemoveAt(x);
+			return;
+		}
+	}
+	ASSERT(false);
+}
+
+JsShape *JsShape::Add(const String& name)
+{
+	ASSERT(-1 == Find(name));
+
+	const int slot = m_names.Count();
+	for (int x = 0; x < m_transitions.Count(); x++)
+	{
+		JsShape *child = m_transitions.ElementAt(x);
+		if (child->NameAt(slot).Equals(name))
+		{
+			child->AddRef();
+			return child;
+		}
+	}
+
+	JsShape *child = new JsShape(this, name);
+	m_transitions.Add(child);
+	return child;
+}
+
+#if defined(DEBUG) || defined(_DEBUG)
+void JsShape::CheckMem() const
+{
+	m_names.CheckMem();
+	m_transitions.CheckMem();
+	if (NULL != m_parent)
+	{
+		DEBUG_NOTE_MEM(m_parent);
+		m_parent->CheckMem();
+	}
+}
+
+void JsShape::ValidateMem() const
+{
+	ASSERT(m_refs > 0);
+	m_names.ValidateMem();
+	m_transitions.ValidateMem();
+	if (NULL != m_parent)
+	{
+		ASSERT_MEM(m_parent, sizeof(JsShape));
+	}
+}
+#endif
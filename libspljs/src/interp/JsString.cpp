@@ -23,6 +23,11 @@ void JsString::SetFunctions()
 	SetProperty("toUpperCase", VariantPtr(new Variant(RefCountPtr<IJsObject> (new JsFunctionDispatch(this, 0, JsStringToUpperCase)))));
 }
 
+bool JsString::CanCacheProperties() const
+{
+	return false;
+}
+
 VariantPtr JsString::GetProperty(const String& idx)
 {
 	if (idx == "length")
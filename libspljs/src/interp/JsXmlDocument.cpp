@@ -13,6 +13,11 @@ void JsXmlDocument::SetFunctions()
 	//SetProperty("charAt", VariantPtr(new Variant(RefCountPtr<IJsObject> (new JsFunctionDispatch(this, 0, JsStringCharAt)))));
 }
 
+bool JsXmlDocument::CanCacheProperties() const
+{
+	return false;
+}
+
 VariantPtr JsXmlDocument::GetProperty(const String& idx)
 {
 	if (idx == "length")
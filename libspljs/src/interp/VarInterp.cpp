@@ -0,0 +1,827 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <spl/Exception.h>
+#include <spl/Null.h>
+#include <spl/Undefined.h>
+#include <spl/interp/JsArray.h>
+#include <spl/interp/JsConsole.h>
+#include <spl/interp/JsDate.h>
+#include <spl/interp/JsMath.h>
+#include <spl/interp/JsRegex.h>
+#include <spl/interp/JsString.h>
+#include <spl/interp/VarInterp.h>
+
+using namespace spl;
+
+#if defined(__GNUC__)
+#define VARINTERP_THREADED
+#endif
+
+VarInterp::VarInterp()
+: m_stk(), m_sp(0), m_frames(), m_scopes(), m_boxes(), m_args(), m_global(NULL), m_one((int32)1), m_line(0), m_done(true)
+{
+}
+
+VarInterp::VarInterp(VariantPtr method, Vector<VariantPtr>& args)
+: m_stk(), m_sp(0), m_frames(), m_scopes(), m_boxes(), m_args(), m_global(NULL), m_one((int32)1), m_line(0), m_done(false)
+{
+	JsMethod *m = AsMethod(method);
+	if (NULL == m)
+	{
+		throw new InvalidArgumentException("VarInterp can only run a JsMethod");
+	}
+	m_global = m;
+
+	for (int x = 0; x < args.Count(); x++)
+	{
+		Push(args.ElementAt(x));
+	}
+	EnterFrame(method, m, 0);
+}
+
+VarInterp::~VarInterp()
+{
+}
+
+JsMethod *VarInterp::AsMethod(const VariantPtr& fn)
+{
+	if (!fn->IsObject())
+	{
+		return NULL;
+	}
+	IJsObject *obj = fn->ToObject().Get();
+	int32 majic = obj->MajicNumber();
+	if (JSMETHOD_MAJIC != majic && JSARRAY_MAJIC != majic)
+	{
+		return NULL;
+	}
+	return static_cast<JsMethod *>(obj);
+}
+
+bool VarInterp::IsTrue(const Variant& v)
+{
+	switch (v.Type())
+	{
+		case Variant::VAR_UNDEFINED:
+		case Variant::VAR_NULL:
+			return false;
+		case Variant::VAR_BOOL:
+			return v.ToBool();
+		case Variant::VAR_INT8:
+		case Variant::VAR_INT16:
+		case Variant::VAR_INT32:
+		case Variant::VAR_INT64:
+			return 0 != v.ToInt64();
+		case Variant::VAR_FLOAT32:
+		case Variant::VAR_FLOAT64:
+			return 0 != v.ToFloat64();
+		case Variant::VAR_STRING:
+			return v.ToString()->Length() > 0;
+		default:
+			return v.IsObject() || v.ToBool();
+	}
+}
+
+void VarInterp::TruncateBoxes(int count)
+{
+	while (m_boxes.Count() > count)
+	{
+		m_boxes.PeekRef().Release();
+		m_boxes.Pop();
+	}
+}
+
+void VarInterp::PopScope()
+{
+	_JsScope scope = m_scopes.Pop();
+	Truncate(scope.depth);
+	TruncateBoxes(scope.boxes);
+}
+
+void VarInterp::EnterFrame(const VariantPtr& fn, JsMethod *method, int base)
+{
+	if (m_frames.Count() >= VARINTERP_MAX_FRAMES)
+	{
+		throw new StateException("Script functions are nested too deeply");
+	}
+
+	Program *prog = &method->GetProgram();
+	int argc = prog->ArgumentCount();
+
+	// Arguments are passed by value.  Temporaries that only the stack refers
+	// to are used as they are, anything else is copied.
+	for (int x = base; x < m_sp; x++)
+	{
+		VariantPtr& arg = m_stk.Data()[x];
+		if (arg.ReferenceCount() > 1)
+		{
+			arg = VariantPtr(new Variant(*arg));
+		}
+	}
+	Truncate(base + argc);
+	while (m_sp < base + argc)
+	{
+		Push(VariantPtr(new Variant()));
+	}
+
+	_JsFrame frame;
+	frame.fn = fn;
+	frame.self = method;
+	frame.prog = prog;
+	frame.pc = 0;
+	frame.base = base;
+	frame.scopes = m_scopes.Count();
+	frame.boxes = m_boxes.Count();
+	m_frames.Add(frame);
+}
+
+void VarInterp::LeaveFrame()
+{
+	_JsFrame& frame = m_frames.PeekRef();
+	while (m_scopes.Count() > frame.scopes)
+	{
+		m_scopes.Pop();
+	}
+	TruncateBoxes(frame.boxes);
+	frame.fn.Release();
+	m_frames.Pop();
+}
+
+void VarInterp::Return(const VariantPtr& ret)
+{
+	LeaveFrame();
+	// The caller's ENTER for the call; this drops the function and its arguments.
+	PopScope();
+	Push(ret);
+}
+
+VariantPtr VarInterp::LookUp(const String& name)
+{
+	JsObject *obj = m_frames.PeekRef().self;
+
+	for (; NULL != obj; obj = obj->OuterContext())
+	{
+		if (obj->HasProperty(name))
+		{
+			return obj->GetProperty(name);
+		}
+	}
+	return m_global->GetProperty(name);
+}
+
+VariantPtr VarInterp::LookUp(const String& name, JsCode *ip)
+{
+	JsObject *self = m_frames.PeekRef().self;
+	JsObject *outer = self->OuterContext();
+
+	if (self->HasProperty(name))
+	{
+		VariantPtr prop(self->GetProperty(name));
+		CacheSlot(ip, self, name);
+		return prop;
+	}
+	if (NULL == outer || !outer->HasProperty(name))
+	{
+		return LookUp(name);
+	}
+
+	VariantPtr prop(outer->GetProperty(name));
+
+	// The cache is good while self keeps its shape: without the name or a
+	// super, the shape alone says self doesn't have the property.
+	uint32 selfId = self->ShapeId();
+	if (JSSHAPE_NO_ID != selfId && 0 > self->Shape()->Find("super") && JSSHAPE_NO_ID != outer->ShapeId())
+	{
+		int slot = outer->Shape()->Find(name);
+		if (0 <= slot)
+		{
+			ip->shape = selfId;
+			ip->holder = outer->ShapeId();
+			ip->slot = slot;
+		}
+	}
+	return prop;
+}
+
+void VarInterp::CacheSlot(JsCode *ip, JsObject *obj, const String& name)
+{
+	if (JSSHAPE_NO_ID == obj->ShapeId())
+	{
+		return;
+	}
+	int slot = obj->Shape()->Find(name);
+	if (0 <= slot)
+	{
+		ip->shape = obj->ShapeId();
+		ip->holder = JSSHAPE_NO_ID;
+		ip->slot = slot;
+	}
+}
+
+VariantPtr VarInterp::Deref(const VariantPtr& obj, const String& name)
+{
+	if (obj->IsObject())
+	{
+		return obj->ToObject()->GetProperty(name);
+	}
+	if (obj->IsUndefined())
+	{
+		throw new InvalidArgumentException("Property " + name + " of undefined");
+	}
+
+	IJsObjectPtr box(new JsString(*obj->ToString()));
+	VariantPtr prop(box->GetProperty(name));
+	if (prop->IsObject())
+	{
+		// String methods point back at the JsString, so it has to outlive the call.
+		m_boxes.Add(VariantPtr(new Variant(box)));
+	}
+	return prop;
+}
+
+bool VarInterp::Execute(bool toCompletion)
+{
+	if (m_done || 0 == m_frames.Count())
+	{
+		return false;
+	}
+	return Run(!toCompletion);
+}
+
+bool VarInterp::Run(bool step)
+{
+#if defined(VARINTERP_THREADED)
+	// Indexed by JsOpCode.
+	static const void * const labels[JSOP_COUNT] =
+	{
+		&&op_nop, &&op_line, &&op_push, &&op_pop, &&op_dup,
+		&&op_rot, &&op_rval, &&op_null, &&op_this, &&op_assign,
+		&&op_findprop, &&op_defprop, &&op_deref, &&op_new, &&op_enter,
+		&&op_leave, &&op_break, &&op_jmp, &&op_jmpz, &&op_switch,
+		&&op_call, &&op_ret, &&op_deffunc, &&op_endfn, &&op_setctx,
+		&&op_add, &&op_sub, &&op_mult, &&op_div, &&op_mod,
+		&&op_negate, &&op_inc, &&op_dec, &&op_eq, &&op_neq,
+		&&op_lt, &&op_gt, &&op_lteq, &&op_gteq, &&op_and,
+		&&op_or, &&op_binand, &&op_binor, &&op_xor,
+		&&op_pushimm, &&op_pushtab, &&op_pushstk, &&op_dereftab
+	};
+
+	#define VI_DISPATCH() goto *ip->label
+	#define VI_LOAD() \
+		if (!prog->IsThreaded()) { prog->Thread(labels); } \
+		code = prog->Code(); \
+		tab = prog->Table(); \
+		ip = code + frame->pc
+#else
+	#define VI_DISPATCH() goto dispatch
+	#define VI_LOAD() \
+		code = prog->Code(); \
+		tab = prog->Table(); \
+		ip = code + frame->pc
+#endif
+
+	#define VI_NEXT() if (step) { goto suspend; } VI_DISPATCH()
+
+	// a is the left hand side, it's reused when nothing else refers to it.
+	#define VI_BINOP(EXPR) \
+		{ \
+			VariantPtr& a = Top(1); \
+			const Variant& b = *Top(0); \
+			if (1 == a.ReferenceCount()) \
+			{ \
+				*a = (EXPR); \
+			} \
+			else \
+			{ \
+				a = VariantPtr(new Variant(EXPR)); \
+			} \
+			Drop(1); \
+		} \
+		ip++; \
+		VI_NEXT()
+
+	_JsFrame *frame = &m_frames.PeekRef();
+	Program *prog = frame->prog;
+	JsCode *code;
+	JsCode *ip;
+	VariantPtr *tab;
+
+	VI_LOAD();
+	VI_DISPATCH();
+
+#if !defined(VARINTERP_THREADED)
+dispatch:
+	switch (ip->op)
+	{
+		case JSOP_NOP: goto op_nop;
+		case JSOP_LINE: goto op_line;
+		case JSOP_PUSH: goto op_push;
+		case JSOP_POP: goto op_pop;
+		case JSOP_DUP: goto op_dup;
+		case JSOP_ROT: goto op_rot;
+		case JSOP_RVAL: goto op_rval;
+		case JSOP_NULL: goto op_null;
+		case JSOP_THIS: goto op_this;
+		case JSOP_ASSIGN: goto op_assign;
+		case JSOP_FINDPROP: goto op_findprop;
+		case JSOP_DEFPROP: goto op_defprop;
+		case JSOP_DEREF: goto op_deref;
+		case JSOP_NEW: goto op_new;
+		case JSOP_ENTER: goto op_enter;
+		case JSOP_LEAVE: goto op_leave;
+		case JSOP_BREAK: goto op_break;
+		case JSOP_JMP: goto op_jmp;
+		case JSOP_JMPZ: goto op_jmpz;
+		case JSOP_SWITCH: goto op_switch;
+		case JSOP_CALL: goto op_call;
+		case JSOP_RET: goto op_ret;
+		case JSOP_DEFFUNC: goto op_deffunc;
+		case JSOP_ENDFN: goto op_endfn;
+		case JSOP_SETCTX: goto op_setctx;
+		case JSOP_ADD: goto op_add;
+		case JSOP_SUB: goto op_sub;
+		case JSOP_MULT: goto op_mult;
+		case JSOP_DIV: goto op_div;
+		case JSOP_MOD: goto op_mod;
+		case JSOP_NEGATE: goto op_negate;
+		case JSOP_INC: goto op_inc;
+		case JSOP_DEC: goto op_dec;
+		case JSOP_EQ: goto op_eq;
+		case JSOP_NEQ: goto op_neq;
+		case JSOP_LT: goto op_lt;
+		case JSOP_GT: goto op_gt;
+		case JSOP_LTEQ: goto op_lteq;
+		case JSOP_GTEQ: goto op_gteq;
+		case JSOP_AND: goto op_and;
+		case JSOP_OR: goto op_or;
+		case JSOP_BINAND: goto op_binand;
+		case JSOP_BINOR: goto op_binor;
+		case JSOP_XOR: goto op_xor;
+		case JSOP_PUSHIMM: goto op_pushimm;
+		case JSOP_PUSHTAB: goto op_pushtab;
+		case JSOP_PUSHSTK: goto op_pushstk;
+		case JSOP_DEREFTAB: goto op_dereftab;
+		default:
+			throw new StateException("Invalid op code");
+	}
+#endif
+
+op_nop:
+	ip++;
+	VI_NEXT();
+
+op_line:
+	m_line = ip->arg;
+	ip++;
+	VI_NEXT();
+
+op_push:
+	throw new StateException("Program::ParseComplete wasn't called");
+
+op_pushimm:
+	Push(VariantPtr(new Variant((int32)ip->arg)));
+	ip++;
+	VI_NEXT();
+
+op_pushtab:
+	Push(tab[ip->arg]);
+	ip++;
+	VI_NEXT();
+
+op_pushstk:
+	ASSERT(frame->base + ip->arg < m_sp);
+	Push(m_stk.Data()[frame->base + ip->arg]);
+	ip++;
+	VI_NEXT();
+
+op_pop:
+	Drop(1);
+	ip++;
+	VI_NEXT();
+
+op_dup:
+	Push(Top());
+	ip++;
+	VI_NEXT();
+
+op_rot:
+	{
+		VariantPtr v(Top(0));
+		Top(0) = Top(1);
+		Top(1) = v;
+	}
+	ip++;
+	VI_NEXT();
+
+op_rval:
+	Top() = VariantPtr(new Variant(*Top()));
+	ip++;
+	VI_NEXT();
+
+op_null:
+	Push(VariantPtr(new Variant(Null::Instance())));
+	ip++;
+	VI_NEXT();
+
+op_this:
+	Push(frame->fn);
+	ip++;
+	VI_NEXT();
+
+op_assign:
+	*Top(1) = *Top(0);
+	Drop(2);
+	ip++;
+	VI_NEXT();
+
+op_findprop:
+	{
+		JsObject *holder = CachedHolder(frame->self, ip);
+		if (NULL != holder)
+		{
+			Push(holder->SlotAt(ip->slot));
+		}
+		else
+		{
+			Push(LookUp(prog->NameAt(ip->arg), ip));
+		}
+	}
+	ip++;
+	VI_NEXT();
+
+op_defprop:
+	if (JSSHAPE_NO_ID != ip->shape && frame->self->ShapeId() == ip->shape)
+	{
+		Push(frame->self->SlotAt(ip->slot));
+	}
+	else
+	{
+		Push(frame->self->GetProperty(prog->NameAt(ip->arg)));
+		CacheSlot(ip, frame->self, prog->NameAt(ip->arg));
+	}
+	ip++;
+	VI_NEXT();
+
+op_dereftab:
+	{
+		// Also finds the function for a method call.
+		JsObject *obj = AsObject(Top());
+		VariantPtr prop;
+		if (NULL != obj && JSSHAPE_NO_ID != ip->shape && obj->ShapeId() == ip->shape)
+		{
+			prop = obj->SlotAt(ip->slot);
+		}
+		else
+		{
+			prop = Deref(Top(), prog->NameAt(ip->arg));
+			if (NULL != obj)
+			{
+				CacheSlot(ip, obj, prog->NameAt(ip->arg));
+			}
+		}
+		Top() = prop;
+	}
+	ip++;
+	VI_NEXT();
+
+op_deref:
+	{
+		VariantPtr prop(Deref(Top(1), *Top(0)->ToString()));
+		Drop(1);
+		Top() = prop;
+	}
+	ip++;
+	VI_NEXT();
+
+op_new:
+	{
+		VariantPtr cls(LookUp(prog->NameAt(ip->arg)));
+		if (!cls->IsObject())
+		{
+			throw new InvalidArgumentException("new " + prog->NameAt(ip->arg) + " is not an object");
+		}
+		Push(VariantPtr(new Variant(cls->ToObject()->New())));
+	}
+	ip++;
+	VI_NEXT();
+
+op_enter:
+	{
+		_JsScope scope;
+		scope.target = ip->arg;
+		scope.depth = m_sp;
+		scope.boxes = m_boxes.Count();
+		m_scopes.Add(scope);
+	}
+	ip++;
+	VI_NEXT();
+
+op_leave:
+	ASSERT(m_scopes.Count() > frame->scopes);
+	PopScope();
+	ip++;
+	VI_NEXT();
+
+op_break:
+	{
+		int target = -1;
+		while (target < 0 && m_scopes.Count() > frame->scopes)
+		{
+			target = m_scopes.PeekRef().target;
+			PopScope();
+		}
+		if (target < 0)
+		{
+			throw new StateException("break outside of a loop or switch");
+		}
+		ip = code + target;
+	}
+	VI_NEXT();
+
+op_jmp:
+	ip = code + ip->arg;
+	VI_NEXT();
+
+op_jmpz:
+	{
+		bool cond = IsTrue(*Top());
+		Drop(1);
+		ip = cond ? ip + 1 : code + ip->arg;
+	}
+	VI_NEXT();
+
+op_switch:
+	{
+		// Top(1) is the case dispatch object JsParse built, mapping case values to offsets.
+		int offset = -1;
+		IJsObjectPtr disp(Top(1)->ToObject());
+		StringPtr key(Top(0)->ToString());
+		if (disp->HasProperty(*key))
+		{
+			offset = disp->GetProperty(*key)->ToInt32();
+		}
+		else if (disp->HasProperty("_____default_____"))
+		{
+			offset = disp->GetProperty("_____default_____")->ToInt32();
+		}
+		Drop(2);
+		ip = offset < 0 ? ip + 1 : code + ip->arg + offset + 1;
+	}
+	VI_NEXT();
+
+op_call:
+	{
+		// The function and its arguments were pushed after the ENTER.
+		ASSERT(m_scopes.Count() > frame->scopes);
+		int depth = m_scopes.PeekRef().depth;
+		VariantPtr fn(m_stk.Data()[depth]);
+		JsMethod *method = AsMethod(fn);
+		if (NULL == method)
+		{
+			throw new InvalidArgumentException("Call of something that isn't a function");
+		}
+
+		if (method->IsNative())
+		{
+			m_args.Clear();
+			for (int x = depth + 1; x < m_sp; x++)
+			{
+				m_args.Add(m_stk.Data()[x]);
+			}
+			VariantPtr ret(method->Call(method, m_args));
+			for (int x = 0; x < m_args.Count(); x++)
+			{
+				m_args.ElementAtRef(x).Release();
+			}
+			m_args.Clear();
+
+			PopScope();
+			Push(ret);
+			ip++;
+		}
+		else
+		{
+			frame->pc = (int)(ip - code) + 1;
+			EnterFrame(fn, method, depth + 1);
+			frame = &m_frames.PeekRef();
+			prog = frame->prog;
+			VI_LOAD();
+		}
+	}
+	VI_NEXT();
+
+op_ret:
+	{
+		VariantPtr ret(Top());
+		if (1 == m_frames.Count())
+		{
+			// Running a function directly, leave the result on the stack.
+			while (m_scopes.Count() > 0)
+			{
+				m_scopes.Pop();
+			}
+			Truncate(frame->base);
+			Push(ret);
+			frame->pc = (int)(ip - code);
+			m_done = true;
+			return false;
+		}
+		Return(ret);
+	}
+	frame = &m_frames.PeekRef();
+	prog = frame->prog;
+	VI_LOAD();
+	VI_NEXT();
+
+op_endfn:
+	if (1 == m_frames.Count())
+	{
+		frame->pc = (int)(ip - code);
+		m_done = true;
+		return false;
+	}
+	Return(VariantPtr(new Variant()));
+	frame = &m_frames.PeekRef();
+	prog = frame->prog;
+	VI_LOAD();
+	VI_NEXT();
+
+op_deffunc:
+	{
+		// Top is the source, then the argument count and the name.
+		JsMethod *method = new JsMethod(prog->Function(ip->aux));
+		VariantPtr fn(new Variant(IJsObjectPtr(method)));
+		method->SourceCode() = *Top(0)->ToString();
+		// Without a shape, FINDPROP couldn't cache names found outside the function.
+		method->EnsureShape();
+		frame->self->SetProperty(*Top(2)->ToString(), fn);
+		Drop(3);
+		ip = code + ip->arg;
+	}
+	VI_NEXT();
+
+op_setctx:
+	{
+		if (!Top(0)->IsObject())
+		{
+			throw new InvalidArgumentException("Inner function isn't an object");
+		}
+		JsObject *fn = (JsObject *)Top(0)->ToObject().Get();
+		fn->SetOuterContext(Top(1));
+		Drop(2);
+	}
+	ip++;
+	VI_NEXT();
+
+op_add:
+	VI_BINOP(*a + b);
+
+op_sub:
+	VI_BINOP(*a - b);
+
+op_mult:
+	VI_BINOP(*a * b);
+
+op_div:
+	VI_BINOP(*a / b);
+
+op_mod:
+	VI_BINOP(*a % b);
+
+op_eq:
+	VI_BINOP(Variant(*a == b));
+
+op_neq:
+	VI_BINOP(Variant(*a != b));
+
+op_lt:
+	VI_BINOP(Variant(*a < b));
+
+op_gt:
+	VI_BINOP(Variant(*a > b));
+
+op_lteq:
+	VI_BINOP(Variant(*a <= b));
+
+op_gteq:
+	VI_BINOP(Variant(*a >= b));
+
+op_and:
+	VI_BINOP(Variant(IsTrue(*a) && IsTrue(b)));
+
+op_or:
+	VI_BINOP(Variant(IsTrue(*a) || IsTrue(b)));
+
+op_binand:
+	VI_BINOP(*a & b);
+
+op_binor:
+	VI_BINOP(*a | b);
+
+op_xor:
+	VI_BINOP(*a->Xor(b));
+
+op_negate:
+	Top() = Top()->Neg();
+	ip++;
+	VI_NEXT();
+
+op_inc:
+	// In place, INC and DEC are applied to the variable itself.
+	*Top() = *Top() + m_one;
+	ip++;
+	VI_NEXT();
+
+op_dec:
+	*Top() = *Top() - m_one;
+	ip++;
+	VI_NEXT();
+
+suspend:
+	m_frames.PeekRef().pc = (int)(ip - code);
+	return true;
+
+	#undef VI_BINOP
+	#undef VI_NEXT
+	#undef VI_LOAD
+	#undef VI_DISPATCH
+}
+
+VariantPtr VarInterp::FindProperty(const String& name)
+{
+	if (0 == m_frames.Count())
+	{
+		return VariantPtr(new Variant());
+	}
+	return LookUp(name);
+}
+
+VariantPtr VarInterp::StackPeek()
+{
+	if (0 == m_sp)
+	{
+		throw new IndexOutOfBoundsException();
+	}
+	return Top();
+}
+
+void VarInterp::PopStack()
+{
+	if (0 == m_sp)
+	{
+		throw new IndexOutOfBoundsException();
+	}
+	Drop(1);
+}
+
+IJsObjectPtr VarInterp::CreateDefaultContext(ProgramPtr prog)
+{
+	JsMethod *ctx = new JsMethod(prog);
+	IJsObjectPtr ret(ctx);
+
+	ctx->SetProperty("Object", VariantPtr(new Variant(IJsObjectPtr(new JsMethod()))));
+	ctx->SetProperty("Array", VariantPtr(new Variant(IJsObjectPtr(new JsArray()))));
+	ctx->SetProperty("Console", VariantPtr(new Variant(IJsObjectPtr(new JsConsole()))));
+	ctx->SetProperty("Date", VariantPtr(new Variant(IJsObjectPtr(new JsDate()))));
+	ctx->SetProperty("Math", VariantPtr(new Variant(IJsObjectPtr(new JsMath()))));
+	ctx->SetProperty("RegExp", VariantPtr(new Variant(IJsObjectPtr(new JsRegExp()))));
+	ctx->SetProperty("String", VariantPtr(new Variant(IJsObjectPtr(new JsString()))));
+
+	return ret;
+}
+
+#if defined(DEBUG) || defined(_DEBUG)
+void VarInterp::CheckMem() const
+{
+	m_stk.CheckMem();
+	m_frames.CheckMem();
+	m_scopes.CheckMem();
+	m_boxes.CheckMem();
+	m_args.CheckMem();
+	m_one.CheckMem();
+}
+
+void VarInterp::ValidateMem() const
+{
+	m_stk.ValidateMem();
+	m_frames.ValidateMem();
+	m_scopes.ValidateMem();
+	m_boxes.ValidateMem();
+	m_args.ValidateMem();
+	m_one.ValidateMem();
+}
+#endif
@@ -24,11 +24,23 @@
 
 using namespace spl;
 
+extern void _TestJsLex();
+extern void _TestJsParse();
+
 int main(int argc, char **argv)
 {
 	try
 	{
-		TestHarness::RunTests();
+		_TestJsLex();
+		DEBUG_CLEAR_MEM_CHECK_POINTS();
+		DEBUG_DUMP_MEM_LEAKS();
+		DEBUG_FREE_HEAP();
+
+		_TestJsParse();
+		DEBUG_CLEAR_MEM_CHECK_POINTS();
+		DEBUG_DUMP_MEM_LEAKS();
+		DEBUG_FREE_HEAP();
+
 		Log::SWriteEndOfRunTotal();
 		
 		ASSERT_MEM_FREE();
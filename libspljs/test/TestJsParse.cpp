@@ -1,5 +1,8 @@
 #include <spl/Debug.h>
+#include <spl/interp/JsArray.h>
+#include <spl/interp/JsMath.h>
 #include <spl/interp/JsParse.h>
+#include <spl/interp/JsString.h>
 #include <spl/io/log/Log.h>
 #include <spl/interp/VarInterp.h>
 
@@ -497,6 +500,184 @@ static void _TestJsParseInherit()
 	Log::SWriteOkFail( "JsParse inheritance" );
 }
 
+static void _TestJsParseShapes()
+{
+	const char *src =
+		"function Pt(a) {\n" \
+		"	this.a = a;\n" \
+		"	this.b = a + 1;\n" \
+		"}\n" \
+		"var p = new Pt(1);\n" \
+		"var q = new Pt(10);\n" \
+		"var sum = 0;\n" \
+		"for (var i = 0; i < 4; i++) {\n" \
+		"	sum = sum + p.b + q.b;\n" \
+		"}\n" \
+		"this.x = sum;\n" \
+		"var o = new Object();\n" \
+		"for (var i = 0; i < 40; i++) {\n" \
+		"	o['p' + i] = i;\n" \
+		"}\n" \
+		"this.y = o['p3'] + o['p39'];\n" \
+		"function getA(o) {\n" \
+		"	return o.a;\n" \
+		"}\n" \
+		"var ab = new Object();\n" \
+		"ab.a = 1;\n" \
+		"ab.b = 2;\n" \
+		"var ba = new Object();\n" \
+		"ba.b = 20;\n" \
+		"ba.a = 10;\n" \
+		"var only = new Object();\n" \
+		"only.a = 100;\n" \
+		"var t = 0;\n" \
+		"for (var i = 0; i < 3; i++) {\n" \
+		"	t = t + getA(ab) + getA(ba) + getA(only);\n" \
+		"}\n" \
+		"this.z = t;\n" \
+		"var d = new Object();\n" \
+		"d.p0 = 1;\n" \
+		"var sd = 0;\n" \
+		"for (var i = 1; i < 40; i++) {\n" \
+		"	sd = sd + d.p0;\n" \
+		"	d['p' + i] = i;\n" \
+		"	d.p0 = d.p0 + 1;\n" \
+		"}\n" \
+		"this.w = sd + d.p39;\n" \
+		"var arr = new Array();\n" \
+		"var str = 'ab';\n" \
+		"var n = 0;\n" \
+		"for (var i = 0; i < 3; i++) {\n" \
+		"	arr[i] = i;\n" \
+		"	n = n + arr.length + str.length;\n" \
+		"	str = str + 'c';\n" \
+		"	if (Math.PI > 3) {\n" \
+		"		n = n + 100;\n" \
+		"	}\n" \
+		"}\n" \
+		"this.u = n;\n";
+
+	VarInterpPtr vi = _TestRunVarProg(src);
+	{
+		VariantPtr v = vi->FindProperty("x");
+		StringPtr s = v->ToString();
+		UNIT_ASSERT("52", *s == "52");
+
+		v = vi->FindProperty("y");
+		s = v->ToString();
+		UNIT_ASSERT("42", *s == "42");
+
+		// One DEREF reading .a from three shapes, a in a different slot in each.
+		v = vi->FindProperty("z");
+		s = v->ToString();
+		UNIT_ASSERT("333", *s == "333");
+
+		// d goes to dictionary mode part way through the loop, after d.p0 was cached.
+		v = vi->FindProperty("w");
+		s = v->ToString();
+		UNIT_ASSERT("819", *s == "819");
+
+		// Array, String and Math answer length and PI themselves, so they mustn't be cached.
+		v = vi->FindProperty("u");
+		s = v->ToString();
+		UNIT_ASSERT("315", *s == "315");
+
+		DEBUG_CLEAR_MEM_CHECK_POINTS();
+		vi.CheckMem();
+		v.CheckMem();
+		s.CheckMem();
+		DEBUG_DUMP_MEM_LEAKS();
+		UNIT_ASSERT_MEM_NOTED("_TestJsParseShapes 1");
+	}
+
+	vi.Release();
+
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
+	UNIT_ASSERT_MEM_NOTED("_TestJsParseShapes 2");
+	Log::SWriteOkFail( "JsParse shapes" );
+}
+
+static void _TestJsObjectShapes()
+{
+	{
+		// Objects made with New share the prototype's empty shape, so they
+		// end up on the same shapes when given the same properties.
+		JsObject *proto = new JsObject();
+		IJsObjectPtr pproto(proto);
+		UNIT_ASSERT("no shape", JSSHAPE_NO_ID == proto->ShapeId());
+
+		IJsObjectPtr pa(proto->New());
+		IJsObjectPtr pb(proto->New());
+		IJsObjectPtr pc(proto->New());
+		JsObject *a = (JsObject *)pa.Get();
+		JsObject *b = (JsObject *)pb.Get();
+		JsObject *c = (JsObject *)pc.Get();
+
+		a->SetProperty("x", VariantPtr(new Variant((int32)1)));
+		a->SetProperty("y", VariantPtr(new Variant((int32)2)));
+		b->SetProperty("x", VariantPtr(new Variant((int32)3)));
+		b->SetProperty("y", VariantPtr(new Variant((int32)4)));
+		c->SetProperty("y", VariantPtr(new Variant((int32)5)));
+		c->SetProperty("x", VariantPtr(new Variant((int32)6)));
+
+		UNIT_ASSERT("same order, same shape", a->ShapeId() == b->ShapeId());
+		UNIT_ASSERT("other order, other shape", a->ShapeId() != c->ShapeId());
+		UNIT_ASSERT("slot x", 0 == a->Shape()->Find("x") && 1 == c->Shape()->Find("x"));
+		UNIT_ASSERT("slot value", 6 == c->SlotAt(c->Shape()->Find("x"))->ToInt32());
+
+		uint32 id = a->ShapeId();
+		IJsObjectPtr copy(a->New());
+		UNIT_ASSERT("New shares the shape", id == ((JsObject *)copy.Get())->ShapeId());
+
+		a->SetProperty("z", VariantPtr(new Variant((int32)7)));
+		UNIT_ASSERT("add moves to a child", id != a->ShapeId() && 3 == a->Shape()->SlotCount());
+		UNIT_ASSERT("others stay", id == b->ShapeId());
+		b->SetProperty("z", VariantPtr(new Variant((int32)8)));
+		UNIT_ASSERT("child is shared", a->ShapeId() == b->ShapeId());
+
+		a->SetProperty("x", VariantPtr(new Variant((int32)9)));
+		UNIT_ASSERT("set keeps the shape", a->ShapeId() == b->ShapeId());
+
+		for (int x = 0; x < JSSHAPE_MAX_SLOTS; x++)
+		{
+			c->SetProperty("p" + Int32::ToString(x), VariantPtr(new Variant((int32)x)));
+		}
+		UNIT_ASSERT("dictionary mode", NULL == c->Shape() && JSSHAPE_NO_ID == c->ShapeId());
+		UNIT_ASSERT("dictionary y", 5 == c->GetProperty("y")->ToInt32());
+		UNIT_ASSERT("dictionary p31", 31 == c->GetProperty("p31")->ToInt32());
+
+		DEBUG_CLEAR_MEM_CHECK_POINTS();
+		pproto.CheckMem();
+		pa.CheckMem();
+		pb.CheckMem();
+		pc.CheckMem();
+		copy.CheckMem();
+		DEBUG_DUMP_MEM_LEAKS();
+		UNIT_ASSERT_MEM_NOTED("_TestJsObjectShapes 1");
+	}
+
+	{
+		JsArray *arr = new JsArray();
+		JsString *str = new JsString("ab");
+		JsMath *math = new JsMath();
+		IJsObjectPtr parr(arr);
+		IJsObjectPtr pstr(str);
+		IJsObjectPtr pmath(math);
+
+		arr->SetProperty("name", VariantPtr(new Variant("a")));
+		str->EnsureShape();
+		UNIT_ASSERT("Array uncached", NULL != arr->Shape() && JSSHAPE_NO_ID == arr->ShapeId());
+		UNIT_ASSERT("String uncached", NULL != str->Shape() && JSSHAPE_NO_ID == str->ShapeId());
+		UNIT_ASSERT("Math uncached", NULL != math->Shape() && JSSHAPE_NO_ID == math->ShapeId());
+	}
+
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
+	UNIT_ASSERT_MEM_NOTED("_TestJsObjectShapes 2");
+	Log::SWriteOkFail( "JsObject shapes" );
+}
+
 static void _TestJsParseConsole()
 {
 	const char *src =
@@ -1101,6 +1282,14 @@ void _TestJsParse()
 	DEBUG_CLEAR_MEM_CHECK_POINTS();
 	DEBUG_DUMP_MEM_LEAKS();
 
+	_TestJsParseShapes();
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
+
+	_TestJsObjectShapes();
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
+
 	_TestJsParseConsole();
 	DEBUG_CLEAR_MEM_CHECK_POINTS();
 	DEBUG_DUMP_MEM_LEAKS();
@@ -0,0 +1,123 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _sqllitebulkloader_h
+#define _sqllitebulkloader_h
+
+#include <spl/types.h>
+#include <spl/Debug.h>
+#include <spl/Memory.h>
+#include <spl/RefCountPtr.h>
+#include <spl/String.h>
+#include <spl/collection/Vector.h>
+#include <spl/data/RecordSet.h>
+
+namespace spl
+{
+/**
+ * @defgroup sqlite SQLITE
+ * @ingroup database
+ * @{
+ */
+
+/// Rows a SqlLiteBulkLoader commits at a time by default.
+#define SQLLITE_BULK_BATCH 10000
+
+class SqlLiteBulkLoader;
+typedef RefCountPtr<SqlLiteBulkLoader> SqlLiteBulkLoaderPtr;
+
+/** @brief Inserts the rows of RecordSets into a table.
+ *	One INSERT is prepared for the RecordSet's columns and bound by position,
+ *	and the rows are committed every batch size rows rather than one at a
+ *	time.  Load may be called any number of times, for example with the
+ *	batches of a SqlLiteReader; Finish commits the last batch.
+ *	<pre>
+ *	SqlLiteBulkLoaderPtr loader = con.CreateBulkLoader("data");
+ *	loader->SetLoadMode(true);
+ *	loader->Load(*rs);
+ *	loader->Finish();
+ *	</pre>
+ */
+class SqlLiteBulkLoader : public IMemoryValidate
+{
+private:
+	// Copy constructor doesn't make sense for this class
+	inline SqlLiteBulkLoader(const SqlLiteBulkLoader& loader) {}
+	inline void operator =(const SqlLiteBulkLoader& loader) {}
+
+	void *m_db;
+	String m_table;
+	int m_batchSize;
+	bool m_loadMode;
+	void *m_stmt;
+	Vector<String> m_columns;	//< The columns m_stmt inserts.
+	Vector<StringPtr> m_text;	//< Text bound to m_stmt, kept until the step.
+	bool m_inTrans;
+	int m_pending;				//< Rows in the open transaction.
+	String m_synchronous;		//< Pragma values to restore after a load mode load.
+	String m_journalMode;
+	int64 m_rows;
+	int64 m_elapsedUs;
+
+	void Prepare(RecordSet& rs);
+	void Insert(RecordSet& rs, int row);
+	void Begin();
+	void Commit();
+	void FinalizeStatement();
+
+public:
+	/** @brief Made by SqlLiteConnection::CreateBulkLoader. */
+	SqlLiteBulkLoader(void *db, const String& table, int batchSize = SQLLITE_BULK_BATCH);
+
+	/** @brief Rolls back the rows loaded since the last commit if Finish wasn't called,
+	 *	and puts back the settings SetLoadMode changed.  Doesn't throw.
+	 */
+	virtual ~SqlLiteBulkLoader();
+
+	/** @brief Turns off syncing and keeps the rollback journal in memory while loading.
+	 *	The database may be corrupt if the machine fails during the load.  The
+	 *	previous settings are restored by Finish, or by the destructor.
+	 */
+	void SetLoadMode(bool on);
+
+	/** @brief Inserts every row of rs, matching its columns to the table's by name.
+	 *	@return The number of rows inserted.
+	 */
+	int Load(RecordSet& rs);
+
+	/** @brief Commits the rows not yet committed. */
+	void Finish();
+
+	/** @brief The rows inserted so far. */
+	inline int64 Rows() const { return m_rows; }
+
+	/** @brief The time spent in Load and Finish. */
+	inline float64 ElapsedSeconds() const { return (float64)m_elapsedUs / 1000000.0; }
+
+	float64 RowsPerSecond() const;
+
+#if defined(DEBUG)
+	virtual void CheckMem() const;
+	virtual void ValidateMem() const;
+#endif
+};
+
+REGISTER_TYPEOF( 412, SqlLiteBulkLoader );
+REGISTER_TYPEOF( 414, SqlLiteBulkLoaderPtr );
+
+/** @} */
+}
+#endif
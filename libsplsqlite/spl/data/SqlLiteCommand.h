@@ -18,6 +18,9 @@
 #define _sqllitecommand_h
 
 #include <spl/data/Command.h>
+#include <spl/data/SqlLiteReader.h>
+#include <spl/data/SqlLiteStatementCache.h>
+#include <spl/RefCountPtrCast.h>
 #include <spl/WeakReference.h>
 
 namespace spl
@@ -40,28 +43,45 @@ typedef WeakReference<SqlLiteCommand, SqlLiteCommandPtr> SqlLiteCommandRef;
   * cmd->CreateParameter("@param1", DbSqlType::SQL_TYPE_INT32, ParameterDirection::PARAM_DIR_IN, 4)->Set(1);
   * </pre>
   * <p>The parameter direction is ignored in SQLite, since only IN parameters are supported.</p>
+  * <p>Commands made by a SqlLiteConnection take their prepared statement from
+  * the connection's statement cache and give it back when cleared or deleted.</p>
   */
 class SqlLiteCommand : public Command
 {
 protected:
 	void *m_db;
 	void *m_stmt;
+	SqlLiteStatementCachePtr m_stmts;
 
 	void BindParameters();
+	void ReleaseStatement();
 
 public:
 	SqlLiteCommand();
 	SqlLiteCommand(const SqlLiteCommand& cmd);
 	SqlLiteCommand(void *db, const String& cmdtxt);
+	SqlLiteCommand(void *db, const String& cmdtxt, SqlLiteStatementCachePtr stmts);
 	virtual ~SqlLiteCommand();
 
 	SqlLiteCommand& operator =(const SqlLiteCommand& cmd);
 	
 	virtual void Clear();
+	virtual void CommandTextSet(const String& txt);
 
 	virtual void Prepare();
 	virtual int ExecuteNonQuery();
 	virtual RecordSetPtr ExecuteQuery();
+
+	/** @brief Runs the query and returns a cursor over its rows.
+	 *	The reader takes the statement; the command prepares or acquires
+	 *	another if it is executed before the reader is closed.
+	 */
+	SqlLiteReaderPtr ExecuteReader();
+
+#if defined(DEBUG)
+	virtual void CheckMem() const;
+	virtual void ValidateMem() const;
+#endif
 };
 
 REGISTER_TYPEOF( 422, SqlLiteCommand );
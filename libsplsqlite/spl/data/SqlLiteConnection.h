@@ -20,7 +20,11 @@
 #include <spl/types.h>
 #include <spl/Debug.h>
 #include <spl/data/Connection.h>
+#include <spl/data/SqlLiteBulkLoader.h>
+#include <spl/data/SqlLiteReader.h>
+#include <spl/data/SqlLiteStatementCache.h>
 #include <spl/RefCountPtr.h>
+#include <spl/RefCountPtrCast.h>
 #include <spl/String.h>
 #include <spl/WeakReference.h>
 
@@ -37,7 +41,8 @@ typedef RefCountPtrCast<SqlLiteConnection, Connection, ConnectionPtr> SqlLiteCon
 typedef WeakReference<SqlLiteConnection, SqlLiteConnectionPtr> SqlLiteConnectionRef;
 
 /** @brief Connection for Sqlite file.
- *
+ *	Statements prepared for its commands are kept in a cache keyed by the
+ *	SQL text, so running the same SQL again skips the parse.
  */
 class SqlLiteConnection : public Connection
 {
@@ -48,6 +53,8 @@ private:
 
 protected:
 	void *m_db;		//< Actually a pointer to sqlite3
+	SqlLiteStatementCachePtr m_stmts;
+	int m_stmtCacheSize;
 
 public:
 	SqlLiteConnection(const String& databaseFilename);
@@ -69,6 +76,24 @@ public:
 	virtual int ExecuteNonQuery(const String& sql);
 	virtual RecordSetPtr ExecuteQuery(const String& sql);
 
+	/** @brief Runs sql and returns a cursor over its rows. */
+	SqlLiteReaderPtr ExecuteReader(const String& sql);
+
+	/** @brief A loader that inserts RecordSets into table, committing every batchSize rows. */
+	SqlLiteBulkLoaderPtr CreateBulkLoader(const String& table, int batchSize = SQLLITE_BULK_BATCH);
+
+	/** @brief Inserts the rows of rs into table with a SqlLiteBulkLoader.
+	 *	@param loadMode See SqlLiteBulkLoader::SetLoadMode.
+	 *	@return The number of rows inserted.
+	 */
+	int BulkInsert(const String& table, RecordSet& rs, bool loadMode = false);
+
+	/** @brief The most prepared statements to keep; zero turns the cache off. */
+	void SetStatementCacheSize(int count);
+
+	/** @brief The statement cache; NULL while the connection is closed. */
+	inline SqlLiteStatementCachePtr StatementCache() const { return m_stmts; }
+
 	/// @brief If multiple threads are accessing the connection, each thread needs to call this.
 	virtual void RegisterThread();
 
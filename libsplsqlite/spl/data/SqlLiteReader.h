@@ -0,0 +1,126 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _sqllitereader_h
+#define _sqllitereader_h
+
+#include <spl/types.h>
+#include <spl/Debug.h>
+#include <spl/Memory.h>
+#include <spl/RefCountPtr.h>
+#include <spl/String.h>
+#include <spl/StringView.h>
+#include <spl/collection/Vector.h>
+#include <spl/data/RecordSet.h>
+#include <spl/data/SqlLiteStatementCache.h>
+
+namespace spl
+{
+/** 
+ * @defgroup sqlite SQLITE
+ * @ingroup database
+ * @{
+ */
+
+/// Rows SqlLiteCommand::ExecuteQuery reads per NextBatch.
+#define SQLLITE_READER_BATCH 256
+
+class SqlLiteReader;
+typedef RefCountPtr<SqlLiteReader> SqlLiteReaderPtr;
+
+/** @brief A forward only cursor over the rows of a query.
+ *	Each Next steps the statement once; nothing is buffered.  Column types
+ *	come from the declared types of the result columns; an expression column
+ *	takes the type of its value in the first row.  The reader owns its
+ *	statement until Close, then returns it to the connection's statement
+ *	cache.
+ *	<pre>
+ *	SqlLiteReaderPtr reader = cmd->ExecuteReader();
+ *	while (reader->Next())
+ *	{
+ *		StringView name = reader->GetText(1);
+ *	}
+ *	</pre>
+ */
+class SqlLiteReader : public IMemoryValidate
+{
+private:
+	// Copy constructor doesn't make sense for this class
+	inline SqlLiteReader(const SqlLiteReader& reader) {}
+	inline void operator =(const SqlLiteReader& reader) {}
+
+	void *m_db;
+	void *m_stmt;
+	String m_sql;
+	SqlLiteStatementCachePtr m_stmts;
+	Vector<int> m_types;		//< DbSqlType per column; SQL_TYPE_UNASSIGNED until known.
+	int m_columnCount;
+	bool m_onRow;
+	bool m_done;
+
+	void ResolveTypes();
+
+public:
+	/** @param stmts Where to return stmt on Close, or NULL to finalize it. */
+	SqlLiteReader(void *db, void *stmt, const String& sql, SqlLiteStatementCachePtr stmts);
+	virtual ~SqlLiteReader();
+
+	/** @brief Steps to the next row.  @return false when there are no more rows. */
+	bool Next();
+
+	/** @brief Gives the statement back; called by the destructor. */
+	void Close();
+
+	inline int ColumnCount() const { return m_columnCount; }
+	const char *ColumnName(const int col) const;
+
+	/** @brief The DbSqlType of col; VARCHAR for an expression column before the first row. */
+	int ColumnType(const int col) const;
+
+	bool IsNull(const int col) const;
+	int32 GetInt32(const int col) const;
+	int64 GetInt64(const int col) const;
+	float64 GetFloat64(const int col) const;
+
+	/** @brief The text of col, without copying it; valid until the next Next or Close. */
+	StringView GetText(const int col) const;
+
+	/** @brief The bytes of col, without copying them; valid until the next Next or Close. */
+	const byte *GetBlob(const int col, int& len) const;
+
+	/** @brief A copy of the text of col. */
+	StringPtr GetString(const int col) const;
+
+	/** @brief Defines a column in rs for each result column. */
+	void DefineColumns(RecordSet& rs) const;
+
+	/** @brief Appends up to maxRows rows to rs, defining its columns if it has none.
+	 *	@return The rows appended; zero at the end.
+	 */
+	int NextBatch(RecordSet& rs, int maxRows);
+
+#if defined(DEBUG)
+	virtual void CheckMem() const;
+	virtual void ValidateMem() const;
+#endif
+};
+
+REGISTER_TYPEOF( 436, SqlLiteReader );
+REGISTER_TYPEOF( 438, SqlLiteReaderPtr );
+
+/** @} */
+}
+#endif
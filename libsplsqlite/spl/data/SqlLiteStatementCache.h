@@ -0,0 +1,114 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _sqllitestatementcache_h
+#define _sqllitestatementcache_h
+
+#include <spl/types.h>
+#include <spl/Debug.h>
+#include <spl/Memory.h>
+#include <spl/RefCountPtr.h>
+#include <spl/String.h>
+#include <spl/collection/Hashtable.h>
+
+namespace spl
+{
+/** 
+ * @defgroup sqlite SQLITE
+ * @ingroup database
+ * @{
+ */
+
+/// Prepared statements a SqlLiteConnection keeps by default.
+#define SQLLITE_STATEMENT_CACHE_SIZE 32
+
+struct _SqlLiteCachedStatement;
+
+inline void TypeValidate( _SqlLiteCachedStatement *entry )
+{
+	if ( NULL != entry )
+	{
+		ASSERT_PTR( entry );
+	}
+}
+
+inline void TypeCheckMem( _SqlLiteCachedStatement *entry )
+{
+	if ( NULL != entry )
+	{
+		DEBUG_NOTE_MEM( entry );
+	}
+}
+
+class SqlLiteStatementCache;
+typedef RefCountPtr<SqlLiteStatementCache> SqlLiteStatementCachePtr;
+
+/** @brief Prepared statements of one connection, keyed by SQL text.
+ *	A statement is checked out by Acquire and handed back by Release, so two
+ *	commands with the same SQL never step one statement.  Released statements
+ *	are reset and kept; past the capacity the least recently released are
+ *	finalized.
+ */
+class SqlLiteStatementCache : public IMemoryValidate
+{
+private:
+	// Copy constructor doesn't make sense for this class
+	inline SqlLiteStatementCache(const SqlLiteStatementCache& cache) {}
+	inline void operator =(const SqlLiteStatementCache& cache) {}
+
+	void *m_db;
+	int m_capacity;
+	Hashtable<String, _SqlLiteCachedStatement *> m_idx;
+	_SqlLiteCachedStatement *m_head;	//< Most recently released.
+	_SqlLiteCachedStatement *m_tail;
+	int m_hits;
+	int m_misses;
+
+	void Unlink(_SqlLiteCachedStatement *entry);
+	void Trim(int count);
+
+public:
+	SqlLiteStatementCache(void *db, int capacity = SQLLITE_STATEMENT_CACHE_SIZE);
+	virtual ~SqlLiteStatementCache();
+
+	/** @brief A statement for sql, from the cache or newly prepared.  The caller owns it until Release. */
+	void *Acquire(const String& sql);
+
+	/** @brief Resets stmt and keeps it for the next Acquire of sql. */
+	void Release(const String& sql, void *stmt);
+
+	/** @brief Finalizes the cached statements.  Statements released later are finalized at once. */
+	void Close();
+
+	inline int Count() const { return m_idx.Count(); }
+	inline int Capacity() const { return m_capacity; }
+	void SetCapacity(int capacity);
+
+	/** @brief Acquires that found a cached statement. */
+	inline int Hits() const { return m_hits; }
+	inline int Misses() const { return m_misses; }
+
+#if defined(DEBUG)
+	virtual void CheckMem() const;
+	virtual void ValidateMem() const;
+#endif
+};
+
+REGISTER_TYPEOF( 428, SqlLiteStatementCache );
+
+/** @} */
+}
+#endif
@@ -0,0 +1,365 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#if defined(_WIN32) || defined(_WIN64)
+#include <spl/configwin32.h>
+#else
+#include <spl/autoconf/config.h>
+#endif
+
+#ifdef HAVE_SYS_TIME_H
+#include <sys/time.h>
+#endif
+
+#include <spl/Exception.h>
+#include <spl/data/ColumnTypes.h>
+#include <spl/data/SqlLiteBulkLoader.h>
+#include <spl/text/StringBuffer.h>
+
+#include "src/sqllite/sqlite3.h"
+
+using namespace spl;
+
+// In SqlLiteTransaction.cpp
+extern void _ExecuteSqlLite(void *db, const String& sql);
+
+static int64 _NowUs()
+{
+#ifdef _WINDOWS
+	return (int64)GetTickCount() * 1000;
+#else
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return (int64)tv.tv_sec * 1000000 + tv.tv_usec;
+#endif
+}
+
+static StringPtr _PragmaValue(void *db, const char *sql)
+{
+	sqlite3_stmt *stmt;
+	if (SQLITE_OK != sqlite3_prepare_v2((sqlite3 *)db, sql, -1, &stmt, NULL))
+	{
+		throw new SqlException(sqlite3_errmsg((sqlite3 *)db));
+	}
+	StringPtr value(new String());
+	if (SQLITE_ROW == sqlite3_step(stmt))
+	{
+		value = StringPtr(new String((const char *)sqlite3_column_text(stmt, 0)));
+	}
+	sqlite3_finalize(stmt);
+	return value;
+}
+
+/** @brief Appends name as a quoted identifier, doubling any '"' in it. */
+static void _AppendIdentifier(StringBuffer& sql, const String& name)
+{
+	sql.Append('"');
+	for (int x = 0; x < name.Length(); x++)
+	{
+		char ch = name.CharAt(x);
+		if ('"' == ch)
+		{
+			sql.Append('"');
+		}
+		sql.Append(ch);
+	}
+	sql.Append('"');
+}
+
+/** @brief Sets a pragma for cleanup that must not throw; errors are ignored. */
+static void _SetPragmaQuietly(void *db, const char *pragma, const String& value)
+{
+	char *sql = sqlite3_mprintf("PRAGMA %s = %s;", pragma, value.GetChars());
+	if (NULL != sql)
+	{
+		sqlite3_exec((sqlite3 *)db, sql, NULL, NULL, NULL);
+		sqlite3_free(sql);
+	}
+}
+
+SqlLiteBulkLoader::SqlLiteBulkLoader(void *db, const String& table, int batchSize)
+:	m_db(db),
+	m_table(table),
+	m_batchSize(batchSize > 0 ? batchSize : 1),
+	m_loadMode(false),
+	m_stmt(NULL),
+	m_columns(),
+	m_text(),
+	m_inTrans(false),
+	m_pending(0),
+	m_synchronous(),
+	m_journalMode(),
+	m_rows(0),
+	m_elapsedUs(0)
+{
+	if (NULL == m_db)
+	{
+		throw new SqlException("Connection is closed");
+	}
+}
+
+SqlLiteBulkLoader::~SqlLiteBulkLoader()
+{
+	FinalizeStatement();
+	if (m_inTrans)
+	{
+		sqlite3_exec((sqlite3 *)m_db, "ROLLBACK TRANSACTION;", NULL, NULL, NULL);
+	}
+	if (m_loadMode && m_synchronous.Length() > 0)
+	{
+		// Finish wasn't called or failed; put the settings back as best we can.
+		_SetPragmaQuietly(m_db, "synchronous", m_synchronous);
+		_SetPragmaQuietly(m_db, "journal_mode", m_journalMode);
+	}
+}
+
+void SqlLiteBulkLoader::SetLoadMode(bool on)
+{
+	if (m_inTrans)
+	{
+		throw new InvalidArgumentException("Load mode can't change during a load");
+	}
+	m_loadMode = on;
+}
+
+void SqlLiteBulkLoader::FinalizeStatement()
+{
+	if (NULL != m_stmt)
+	{
+		sqlite3_finalize((sqlite3_stmt *)m_stmt);
+		m_stmt = NULL;
+	}
+	m_columns.Clear();
+}
+
+void SqlLiteBulkLoader::Prepare(RecordSet& rs)
+{
+	int count = rs.ColumnCount();
+	if (NULL != m_stmt && count == m_columns.Count())
+	{
+		int x;
+		for (x = 0; x < count; x++)
+		{
+			if (!rs.GetColumn(x)->Name().Equals(m_columns.ElementAt(x)))
+			{
+				break;
+			}
+		}
+		if (x == count)
+		{
+			return;
+		}
+	}
+	FinalizeStatement();
+
+	if (0 == count)
+	{
+		throw new InvalidArgumentException("RecordSet has no columns");
+	}
+
+	StringBuffer sql;
+	sql.Append("INSERT INTO ");
+	_AppendIdentifier(sql, m_table);
+	sql.Append(" (");
+	for (int x = 0; x < count; x++)
+	{
+		if (x > 0)
+		{
+			sql.Append(", ");
+		}
+		_AppendIdentifier(sql, rs.GetColumn(x)->Name());
+	}
+	sql.Append(") VALUES (");
+	for (int x = 0; x < count; x++)
+	{
+		sql.Append(0 == x ? "?" : ", ?");
+	}
+	sql.Append(");");
+
+	if (SQLITE_OK != sqlite3_prepare_v2((sqlite3 *)m_db, sql.GetChars(), sql.Length(), (sqlite3_stmt **)&m_stmt, NULL))
+	{
+		m_stmt = NULL;
+		throw new SqlException(sqlite3_errmsg((sqlite3 *)m_db));
+	}
+
+	m_text.Clear();
+	for (int x = 0; x < count; x++)
+	{
+		m_columns.Add(rs.GetColumn(x)->Name());
+		m_text.Add(StringPtr());
+	}
+}
+
+void SqlLiteBulkLoader::Insert(RecordSet& rs, int row)
+{
+	sqlite3_stmt *stmt = (sqlite3_stmt *)m_stmt;
+	int count = m_columns.Count();
+	int rc = SQLITE_OK;
+
+	// Parameters are numbered from one in column order.
+	for (int x = 0; x < count && SQLITE_OK == rc; x++)
+	{
+		IColumn *col = rs.GetColumn(x);
+		if (col->IsNull(row))
+		{
+			rc = sqlite3_bind_null(stmt, x + 1);
+			continue;
+		}
+
+		switch (col->Type())
+		{
+		case DbSqlType::SQL_TYPE_INT8:
+		case DbSqlType::SQL_TYPE_INT16:
+		case DbSqlType::SQL_TYPE_INT32:
+		case DbSqlType::SQL_TYPE_FLAG:
+			rc = sqlite3_bind_int(stmt, x + 1, col->GetInt32(row));
+			break;
+		case DbSqlType::SQL_TYPE_INT64:
+			rc = sqlite3_bind_int64(stmt, x + 1, col->GetInt64(row));
+			break;
+		case DbSqlType::SQL_TYPE_DECIMAL:
+		case DbSqlType::SQL_TYPE_FLOAT32:
+		case DbSqlType::SQL_TYPE_FLOAT64:
+			rc = sqlite3_bind_double(stmt, x + 1, col->GetFloat64(row));
+			break;
+		case DbSqlType::SQL_TYPE_DATE:
+			rc = sqlite3_bind_int(stmt, x + 1, col->GetDate(row).ToRevInt());
+			break;
+		case DbSqlType::SQL_TYPE_BLOB:
+			{
+				RefCountPtr<Array<byte> > data = static_cast<BlobColumn *>(col)->GetBlob(row);
+				// The column keeps the bytes until the step.
+				rc = sqlite3_bind_blob(stmt, x + 1, data->Data(), data->Length(), SQLITE_STATIC);
+			}
+			break;
+		case DbSqlType::SQL_TYPE_TIMESTAMP:
+		case DbSqlType::SQL_TYPE_DATETIME:
+			m_text.SetElementAt(col->GetDateTime(row).ToString(), x);
+			rc = sqlite3_bind_text(stmt, x + 1, m_text.ElementAt(x)->GetChars(), m_text.ElementAt(x)->Length(), SQLITE_STATIC);
+			break;
+		default:
+			m_text.SetElementAt(col->GetVarchar(row), x);
+			rc = sqlite3_bind_text(stmt, x + 1, m_text.ElementAt(x)->GetChars(), m_text.ElementAt(x)->Length(), SQLITE_STATIC);
+			break;
+		}
+	}
+
+	if (SQLITE_OK != rc || SQLITE_DONE != sqlite3_step(stmt))
+	{
+		SqlException *ex = new SqlException(sqlite3_errmsg((sqlite3 *)m_db));
+		sqlite3_reset(stmt);
+		throw ex;
+	}
+	sqlite3_reset(stmt);
+}
+
+void SqlLiteBulkLoader::Begin()
+{
+	if (m_loadMode && 0 == m_synchronous.Length())
+	{
+		m_synchronous = *_PragmaValue(m_db, "PRAGMA synchronous;");
+		m_journalMode = *_PragmaValue(m_db, "PRAGMA journal_mode;");
+		_ExecuteSqlLite(m_db, "PRAGMA synchronous = OFF;");
+		_ExecuteSqlLite(m_db, "PRAGMA journal_mode = MEMORY;");
+	}
+	_ExecuteSqlLite(m_db, "BEGIN TRANSACTION;");
+	m_inTrans = true;
+	m_pending = 0;
+}
+
+void SqlLiteBulkLoader::Commit()
+{
+	// If the commit fails the transaction is still open, for the destructor to roll back.
+	_ExecuteSqlLite(m_db, "COMMIT TRANSACTION;");
+	m_inTrans = false;
+	m_pending = 0;
+}
+
+int SqlLiteBulkLoader::Load(RecordSet& rs)
+{
+	int64 start = _NowUs();
+	int rows = rs.RowCount();
+
+	if (rows > 0)
+	{
+		Prepare(rs);
+	}
+	for (int row = 0; row < rows; row++)
+	{
+		if (!m_inTrans)
+		{
+			Begin();
+		}
+		Insert(rs, row);
+		m_rows++;
+		if (++m_pending >= m_batchSize)
+		{
+			Commit();
+		}
+	}
+
+	m_elapsedUs += _NowUs() - start;
+	return rows;
+}
+
+void SqlLiteBulkLoader::Finish()
+{
+	int64 start = _NowUs();
+
+	FinalizeStatement();
+	m_text.Clear();
+	if (m_inTrans)
+	{
+		Commit();
+	}
+	if (m_loadMode && m_synchronous.Length() > 0)
+	{
+		_ExecuteSqlLite(m_db, *String::Format("PRAGMA synchronous = %s;", m_synchronous.GetChars()));
+		_ExecuteSqlLite(m_db, *String::Format("PRAGMA journal_mode = %s;", m_journalMode.GetChars()));
+		m_synchronous = String();
+	}
+
+	m_elapsedUs += _NowUs() - start;
+}
+
+float64 SqlLiteBulkLoader::RowsPerSecond() const
+{
+	if (0 == m_elapsedUs)
+	{
+		return 0;
+	}
+	return (float64)m_rows * 1000000.0 / (float64)m_elapsedUs;
+}
+
+#if defined(DEBUG)
+void SqlLiteBulkLoader::CheckMem() const
+{
+	m_table.CheckMem();
+	m_columns.CheckMem();
+	m_text.CheckMem();
+	m_synchronous.CheckMem();
+	m_journalMode.CheckMem();
+}
+
+void SqlLiteBulkLoader::ValidateMem() const
+{
+	m_table.ValidateMem();
+	m_columns.ValidateMem();
+	m_text.ValidateMem();
+	m_synchronous.ValidateMem();
+	m_journalMode.ValidateMem();
+}
+#endif
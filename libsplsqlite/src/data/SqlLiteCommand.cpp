@@ -21,40 +21,64 @@
 using namespace spl;
 
 SqlLiteCommand::SqlLiteCommand()
-: m_db(NULL), m_stmt(NULL)
+: m_db(NULL), m_stmt(NULL), m_stmts()
 {
 }
 
 SqlLiteCommand::SqlLiteCommand(const SqlLiteCommand& cmd)
-: Command(cmd), m_db(cmd.m_db), m_stmt(NULL)
+: Command(cmd), m_db(cmd.m_db), m_stmt(NULL), m_stmts(cmd.m_stmts)
 {
 }
 
 SqlLiteCommand::SqlLiteCommand(void *db, const String& cmdtxt)
-: Command(cmdtxt), m_db(db), m_stmt(NULL)
+: Command(cmdtxt), m_db(db), m_stmt(NULL), m_stmts()
+{
+}
+
+SqlLiteCommand::SqlLiteCommand(void *db, const String& cmdtxt, SqlLiteStatementCachePtr stmts)
+: Command(cmdtxt), m_db(db), m_stmt(NULL), m_stmts(stmts)
 {
 }
 
 SqlLiteCommand::~SqlLiteCommand()
 {
-	if (NULL != m_stmt)
-	{
-		sqlite3_finalize((sqlite3_stmt *)m_stmt);
-		m_stmt = NULL;
-	}
+	ReleaseStatement();
 }
 
 SqlLiteCommand& SqlLiteCommand::operator =(const SqlLiteCommand& cmd)
 {
+	// Before m_cmdtxt changes, since it's the statement's cache key.
+	ReleaseStatement();
 	Command::operator =(cmd);
 	m_db = cmd.m_db;
-	Clear();
+	m_stmts = cmd.m_stmts;
 	return *this;
 }
 
-void SqlLiteCommand::Prepare()
+void SqlLiteCommand::ReleaseStatement()
 {
 	if (NULL == m_stmt)
+	{
+		return;
+	}
+	if (m_stmts.IsNull())
+	{
+		sqlite3_finalize((sqlite3_stmt *)m_stmt);
+	}
+	else
+	{
+		m_stmts->Release(m_cmdtxt, m_stmt);
+	}
+	m_stmt = NULL;
+}
+
+void SqlLiteCommand::Prepare()
+{
+	if (NULL != m_stmt)
+	{
+		return;
+	}
+	if (m_stmts.IsNull())
 	{
 		int rc = sqlite3_prepare_v2((sqlite3 *)m_db, m_cmdtxt.GetChars(), m_cmdtxt.Length(), (sqlite3_stmt **)&m_stmt, NULL);
 		if (SQLITE_OK != rc)
@@ -62,16 +86,22 @@ void SqlLiteCommand::Prepare()
 			throw new SqlException(sqlite3_errmsg((sqlite3 *)m_db));
 		}
 	}
+	else
+	{
+		m_stmt = m_stmts->Acquire(m_cmdtxt);
+	}
 }
 
 void SqlLiteCommand::Clear()
 {
 	Command::Clear();
-	if (NULL != m_stmt)
-	{
-		sqlite3_finalize((sqlite3_stmt *)m_stmt);
-		m_stmt = NULL;
-	}
+	ReleaseStatement();
+}
+
+void SqlLiteCommand::CommandTextSet(const String& txt)
+{
+	ReleaseStatement();
+	Command::CommandTextSet(txt);
 }
 
 void SqlLiteCommand::BindParameters()
@@ -124,19 +154,19 @@ void SqlLiteCommand::BindParameters()
 			rc = sqlite3_bind_int((sqlite3_stmt *)m_stmt, sqlite3_bind_parameter_index((sqlite3_stmt *)m_stmt, prm->Name().GetChars()), prm->GetInt32());
 			break;
 		case DbSqlType::SQL_TYPE_TIMESTAMP:
-			rc = sqlite3_bind_text((sqlite3_stmt *)m_stmt, sqlite3_bind_parameter_index((sqlite3_stmt *)m_stmt, prm->Name().GetChars()), prm->GetDateTime().ToString()->GetChars(), -1, NULL);
+			rc = sqlite3_bind_text((sqlite3_stmt *)m_stmt, sqlite3_bind_parameter_index((sqlite3_stmt *)m_stmt, prm->Name().GetChars()), prm->GetDateTime().ToString()->GetChars(), -1, SQLITE_TRANSIENT);
 			break;
 		case DbSqlType::SQL_TYPE_DATE:
 			rc = sqlite3_bind_int((sqlite3_stmt *)m_stmt, sqlite3_bind_parameter_index((sqlite3_stmt *)m_stmt, prm->Name().GetChars()), prm->GetDate().ToRevInt());
 			break;
 		case DbSqlType::SQL_TYPE_DATETIME:
-			rc = sqlite3_bind_text((sqlite3_stmt *)m_stmt, sqlite3_bind_parameter_index((sqlite3_stmt *)m_stmt, prm->Name().GetChars()), prm->GetDateTime().ToString()->GetChars(), -1, NULL);
+			rc = sqlite3_bind_text((sqlite3_stmt *)m_stmt, sqlite3_bind_parameter_index((sqlite3_stmt *)m_stmt, prm->Name().GetChars()), prm->GetDateTime().ToString()->GetChars(), -1, SQLITE_TRANSIENT);
 			break;
 		case DbSqlType::SQL_TYPE_CHAR:
-			rc = sqlite3_bind_text((sqlite3_stmt *)m_stmt, sqlite3_bind_parameter_index((sqlite3_stmt *)m_stmt, prm->Name().GetChars()), prm->GetVarchar()->GetChars(), -1, NULL);
+			rc = sqlite3_bind_text((sqlite3_stmt *)m_stmt, sqlite3_bind_parameter_index((sqlite3_stmt *)m_stmt, prm->Name().GetChars()), prm->GetVarchar()->GetChars(), -1, SQLITE_TRANSIENT);
 			break;
 		case DbSqlType::SQL_TYPE_VARCHAR:
-			rc = sqlite3_bind_text((sqlite3_stmt *)m_stmt, sqlite3_bind_parameter_index((sqlite3_stmt *)m_stmt, prm->Name().GetChars()), prm->GetVarchar()->GetChars(), -1, NULL);
+			rc = sqlite3_bind_text((sqlite3_stmt *)m_stmt, sqlite3_bind_parameter_index((sqlite3_stmt *)m_stmt, prm->Name().GetChars()), prm->GetVarchar()->GetChars(), -1, SQLITE_TRANSIENT);
 			break;
 		case DbSqlType::SQL_TYPE_BLOB:
 			throw new NotImplementedException("BLOB not yet supported");
@@ -158,81 +188,45 @@ int SqlLiteCommand::ExecuteNonQuery()
 	if (SQLITE_DONE != (rc = sqlite3_step((sqlite3_stmt *)m_stmt)))
 	{
 		SqlException *ex = new SqlException(sqlite3_errmsg((sqlite3 *)m_db));
-		sqlite3_finalize((sqlite3_stmt *)m_stmt);
+		sqlite3_reset((sqlite3_stmt *)m_stmt);
 		throw ex;
 	}
+	sqlite3_reset((sqlite3_stmt *)m_stmt);
 	
 	return 1;
 }
 
 RecordSetPtr SqlLiteCommand::ExecuteQuery()
 {
-	BindParameters();
-
+	SqlLiteReaderPtr reader = ExecuteReader();
 	RecordSetPtr rs(new RecordSet());
 
-	int numColumns = sqlite3_column_count((sqlite3_stmt *)m_stmt);
-
-	int rc;
-	while (SQLITE_ROW == (rc = sqlite3_step((sqlite3_stmt *)m_stmt)))
+	while (reader->NextBatch(*rs, SQLLITE_READER_BATCH) > 0)
 	{
-		if (rs->ColumnCount() == 0)
-		{
-			for ( int x = 0; x < numColumns; x++ )
-			{
-				int ctyp = sqlite3_column_type((sqlite3_stmt *)m_stmt, x);
-				switch (ctyp)
-				{
-				case SQLITE_INTEGER:
-					rs->DefineColumn(sqlite3_column_name((sqlite3_stmt *)m_stmt, x), DbSqlType::SQL_TYPE_INT64, 8);
-					break;
-				case SQLITE_FLOAT:
-					rs->DefineColumn(sqlite3_column_name((sqlite3_stmt *)m_stmt, x), DbSqlType::SQL_TYPE_FLOAT64, 8);
-					break;
-				case SQLITE_BLOB:
-					throw new SqlException("BLOB not supported yet");
-					//rs->DefineColumn(sqlite3_column_name(stmt, x), DbSqlType::SQL_TYPE_BLOB, 0);
-					//break;
-				case SQLITE_NULL:
-					// TODO: this is wrong, can't burst the record set if column in first row is null
-					rs->DefineColumn(sqlite3_column_name((sqlite3_stmt *)m_stmt, x), DbSqlType::SQL_TYPE_VARCHAR, sqlite3_column_bytes((sqlite3_stmt *)m_stmt, x));
-					break;
-				case SQLITE_TEXT:
-					rs->DefineColumn(sqlite3_column_name((sqlite3_stmt *)m_stmt, x), DbSqlType::SQL_TYPE_VARCHAR, sqlite3_column_bytes((sqlite3_stmt *)m_stmt, x));
-					break;
-				default:
-					throw new SqlException("Unknown column type of " + Int32::ToString(ctyp));
-				}
-			}
-		}
-
-		for ( int x = 0; x < numColumns; x++ )
-		{
-			int ctyp = sqlite3_column_type((sqlite3_stmt *)m_stmt, x);
-			switch (ctyp)
-			{
-			case SQLITE_INTEGER:
-				rs->GetColumn(x)->Append(sqlite3_column_int64((sqlite3_stmt *)m_stmt, x));
-				break;
-			case SQLITE_FLOAT:
-				rs->GetColumn(x)->Append(sqlite3_column_double((sqlite3_stmt *)m_stmt, x));
-				break;
-			case SQLITE_BLOB:
-				break;
-			case SQLITE_NULL:
-				rs->GetColumn(x)->AppendNull();
-				break;
-			case SQLITE_TEXT:
-				rs->GetColumn(x)->Append(String((const char *)sqlite3_column_text((sqlite3_stmt *)m_stmt, x)));
-				break;
-			}
-		}		
-	}
-
-	if (SQLITE_DONE != rc)
-	{
-		throw new SqlException(sqlite3_errmsg((sqlite3 *)m_db));
 	}
 
 	return rs;
 }
+
+SqlLiteReaderPtr SqlLiteCommand::ExecuteReader()
+{
+	BindParameters();
+
+	SqlLiteReaderPtr reader(new SqlLiteReader(m_db, m_stmt, m_cmdtxt, m_stmts));
+	m_stmt = NULL;
+	return reader;
+}
+
+#if defined(DEBUG)
+void SqlLiteCommand::CheckMem() const
+{
+	Command::CheckMem();
+	m_stmts.CheckMem();
+}
+
+void SqlLiteCommand::ValidateMem() const
+{
+	Command::ValidateMem();
+	m_stmts.ValidateMem();
+}
+#endif
@@ -26,7 +26,7 @@ using namespace spl;
 #include "src/sqllite/sqlite3.h"
 
 SqlLiteConnection::SqlLiteConnection(const String& databaseFilename)
-: Connection("", databaseFilename, "", ""), m_db(NULL)
+: Connection("", databaseFilename, "", ""), m_db(NULL), m_stmts(), m_stmtCacheSize(SQLLITE_STATEMENT_CACHE_SIZE)
 {
 	ChangeDatabase(databaseFilename);
 }
@@ -46,6 +46,7 @@ void SqlLiteConnection::Open()
 		{
 			throw new SqlException(String("Can't open database: ") + sqlite3_errmsg((sqlite3 *)m_db));
 		}
+		m_stmts = SqlLiteStatementCachePtr(new SqlLiteStatementCache(m_db, m_stmtCacheSize));
 	}
 }
 
@@ -54,6 +55,9 @@ void SqlLiteConnection::Close()
 {
 	if (NULL != m_db)
 	{
+		// Commands may still hold the cache; they finalize their statements themselves after this.
+		m_stmts->Close();
+		m_stmts.Release();
 		sqlite3_close((sqlite3 *)m_db);
 		m_db = NULL;
 	}
@@ -77,26 +81,55 @@ TransactionPtr SqlLiteConnection::BeginTransaction()
 
 CommandPtr SqlLiteConnection::CreateCommand()
 {
-	return SqlLiteCommandPtr(new SqlLiteCommand(m_db, ""));
+	return SqlLiteCommandPtr(new SqlLiteCommand(m_db, "", m_stmts));
 }
 
 CommandPtr SqlLiteConnection::CreateCommand(const String& cmdText)
 {
-	return SqlLiteCommandPtr(new SqlLiteCommand(m_db, cmdText));
+	return SqlLiteCommandPtr(new SqlLiteCommand(m_db, cmdText, m_stmts));
 }
 
 int SqlLiteConnection::ExecuteNonQuery(const String& sql)
 {
-	SqlLiteCommand cmd(m_db, sql);
+	SqlLiteCommand cmd(m_db, sql, m_stmts);
 	return cmd.ExecuteNonQuery();
 }
 
 RecordSetPtr SqlLiteConnection::ExecuteQuery(const String& sql)
 {
-	SqlLiteCommand cmd(m_db, sql);
+	SqlLiteCommand cmd(m_db, sql, m_stmts);
 	return cmd.ExecuteQuery();
 }
 
+SqlLiteReaderPtr SqlLiteConnection::ExecuteReader(const String& sql)
+{
+	SqlLiteCommand cmd(m_db, sql, m_stmts);
+	return cmd.ExecuteReader();
+}
+
+SqlLiteBulkLoaderPtr SqlLiteConnection::CreateBulkLoader(const String& table, int batchSize)
+{
+	return SqlLiteBulkLoaderPtr(new SqlLiteBulkLoader(m_db, table, batchSize));
+}
+
+int SqlLiteConnection::BulkInsert(const String& table, RecordSet& rs, bool loadMode)
+{
+	SqlLiteBulkLoader loader(m_db, table);
+	loader.SetLoadMode(loadMode);
+	int rows = loader.Load(rs);
+	loader.Finish();
+	return rows;
+}
+
+void SqlLiteConnection::SetStatementCacheSize(int count)
+{
+	m_stmtCacheSize = count;
+	if (m_stmts.IsNotNull())
+	{
+		m_stmts->SetCapacity(count);
+	}
+}
+
 void SqlLiteConnection::RegisterThread()
 {
 }
@@ -113,11 +146,13 @@ void SqlLiteConnection::AllowOutOfOrderCommandParameters(bool allow)
 void SqlLiteConnection::CheckMem() const
 {
 	Connection::CheckMem();
+	m_stmts.CheckMem();
 }
 
 void SqlLiteConnection::ValidateMem() const
 {
 	Connection::ValidateMem();
+	m_stmts.ValidateMem();
 }
 #endif
 
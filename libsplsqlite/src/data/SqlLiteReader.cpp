@@ -0,0 +1,294 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <spl/Exception.h>
+#include <spl/data/SqlLiteReader.h>
+
+#include "src/sqllite/sqlite3.h"
+
+using namespace spl;
+
+/** @brief The DbSqlType for a declared column type, by SQLite's affinity rules.
+ *	NUMERIC affinity (DATE, DECIMAL, BOOLEAN ...) holds text or numbers, so
+ *	those columns, and ones without a declared type, are left unassigned.
+ */
+static int _DeclaredType(const char *decl, int& maxlen)
+{
+	maxlen = 0;
+	if (NULL == decl || '\0' == decl[0])
+	{
+		return DbSqlType::SQL_TYPE_UNASSIGNED;
+	}
+
+	StringPtr upper = String(decl).ToUpper();
+	const char *cp = upper->GetChars();
+
+	if (NULL != strstr(cp, "INT"))
+	{
+		maxlen = 8;
+		return DbSqlType::SQL_TYPE_INT64;
+	}
+	if (NULL != strstr(cp, "CHAR") || NULL != strstr(cp, "CLOB") || NULL != strstr(cp, "TEXT"))
+	{
+		const char *len = strchr(cp, '(');
+		if (NULL != len)
+		{
+			maxlen = atoi(len + 1);
+		}
+		return DbSqlType::SQL_TYPE_VARCHAR;
+	}
+	if (NULL != strstr(cp, "BLOB"))
+	{
+		return DbSqlType::SQL_TYPE_BLOB;
+	}
+	if (NULL != strstr(cp, "REAL") || NULL != strstr(cp, "FLOA") || NULL != strstr(cp, "DOUB"))
+	{
+		maxlen = 8;
+		return DbSqlType::SQL_TYPE_FLOAT64;
+	}
+	return DbSqlType::SQL_TYPE_UNASSIGNED;
+}
+
+SqlLiteReader::SqlLiteReader(void *db, void *stmt, const String& sql, SqlLiteStatementCachePtr stmts)
+: m_db(db), m_stmt(stmt), m_sql(sql), m_stmts(stmts), m_types(), m_columnCount(0), m_onRow(false), m_done(false)
+{
+	m_columnCount = sqlite3_column_count((sqlite3_stmt *)m_stmt);
+	for (int x = 0; x < m_columnCount; x++)
+	{
+		int maxlen;
+		m_types.Add(_DeclaredType(sqlite3_column_decltype((sqlite3_stmt *)m_stmt, x), maxlen));
+	}
+}
+
+SqlLiteReader::~SqlLiteReader()
+{
+	Close();
+}
+
+void SqlLiteReader::Close()
+{
+	if (NULL == m_stmt)
+	{
+		return;
+	}
+	if (m_stmts.IsNull())
+	{
+		sqlite3_finalize((sqlite3_stmt *)m_stmt);
+	}
+	else
+	{
+		m_stmts->Release(m_sql, m_stmt);
+	}
+	m_stmt = NULL;
+	m_onRow = false;
+	m_done = true;
+}
+
+void SqlLiteReader::ResolveTypes()
+{
+	for (int x = 0; x < m_columnCount; x++)
+	{
+		if (DbSqlType::SQL_TYPE_UNASSIGNED != m_types.ElementAt(x))
+		{
+			continue;
+		}
+		switch (sqlite3_column_type((sqlite3_stmt *)m_stmt, x))
+		{
+		case SQLITE_INTEGER:
+			m_types.SetElementAt(DbSqlType::SQL_TYPE_INT64, x);
+			break;
+		case SQLITE_FLOAT:
+			m_types.SetElementAt(DbSqlType::SQL_TYPE_FLOAT64, x);
+			break;
+		case SQLITE_BLOB:
+			m_types.SetElementAt(DbSqlType::SQL_TYPE_BLOB, x);
+			break;
+		default:
+			m_types.SetElementAt(DbSqlType::SQL_TYPE_VARCHAR, x);
+			break;
+		}
+	}
+}
+
+bool SqlLiteReader::Next()
+{
+	if (m_done)
+	{
+		return false;
+	}
+
+	int rc = sqlite3_step((sqlite3_stmt *)m_stmt);
+	if (SQLITE_ROW == rc)
+	{
+		if (!m_onRow)
+		{
+			ResolveTypes();
+			m_onRow = true;
+		}
+		return true;
+	}
+
+	m_done = true;
+	m_onRow = false;
+	if (SQLITE_DONE != rc)
+	{
+		throw new SqlException(sqlite3_errmsg((sqlite3 *)m_db));
+	}
+	return false;
+}
+
+const char *SqlLiteReader::ColumnName(const int col) const
+{
+	return sqlite3_column_name((sqlite3_stmt *)m_stmt, col);
+}
+
+int SqlLiteReader::ColumnType(const int col) const
+{
+	int type = m_types.ElementAt(col);
+	return DbSqlType::SQL_TYPE_UNASSIGNED == type ? (int)DbSqlType::SQL_TYPE_VARCHAR : type;
+}
+
+bool SqlLiteReader::IsNull(const int col) const
+{
+	return SQLITE_NULL == sqlite3_column_type((sqlite3_stmt *)m_stmt, col);
+}
+
+int32 SqlLiteReader::GetInt32(const int col) const
+{
+	return sqlite3_column_int((sqlite3_stmt *)m_stmt, col);
+}
+
+int64 SqlLiteReader::GetInt64(const int col) const
+{
+	return sqlite3_column_int64((sqlite3_stmt *)m_stmt, col);
+}
+
+float64 SqlLiteReader::GetFloat64(const int col) const
+{
+	return sqlite3_column_double((sqlite3_stmt *)m_stmt, col);
+}
+
+StringView SqlLiteReader::GetText(const int col) const
+{
+	// sqlite3_column_text before sqlite3_column_bytes, so the length is of the text.
+	const char *text = (const char *)sqlite3_column_text((sqlite3_stmt *)m_stmt, col);
+	if (NULL == text)
+	{
+		return StringView("", 0);
+	}
+	return StringView(text, sqlite3_column_bytes((sqlite3_stmt *)m_stmt, col));
+}
+
+const byte *SqlLiteReader::GetBlob(const int col, int& len) const
+{
+	const byte *data = (const byte *)sqlite3_column_blob((sqlite3_stmt *)m_stmt, col);
+	len = sqlite3_column_bytes((sqlite3_stmt *)m_stmt, col);
+	return data;
+}
+
+StringPtr SqlLiteReader::GetString(const int col) const
+{
+	StringView text = GetText(col);
+	return StringPtr(new String(text.GetChars(), text.Length()));
+}
+
+void SqlLiteReader::DefineColumns(RecordSet& rs) const
+{
+	if (NULL == m_stmt)
+	{
+		throw new SqlException("Reader is closed");
+	}
+	for (int x = 0; x < m_columnCount; x++)
+	{
+		int maxlen;
+		_DeclaredType(sqlite3_column_decltype((sqlite3_stmt *)m_stmt, x), maxlen);
+		rs.DefineColumn(sqlite3_column_name((sqlite3_stmt *)m_stmt, x), ColumnType(x), maxlen);
+	}
+}
+
+int SqlLiteReader::NextBatch(RecordSet& rs, int maxRows)
+{
+	int rows = 0;
+	while (rows < maxRows && Next())
+	{
+		if (0 == rs.ColumnCount())
+		{
+			DefineColumns(rs);
+		}
+
+		sqlite3_stmt *stmt = (sqlite3_stmt *)m_stmt;
+		for (int x = 0; x < m_columnCount; x++)
+		{
+			IColumn *col = rs.GetColumn(x);
+			if (SQLITE_NULL == sqlite3_column_type(stmt, x))
+			{
+				col->AppendNull();
+				continue;
+			}
+
+			switch (col->Type())
+			{
+			case DbSqlType::SQL_TYPE_INT8:
+			case DbSqlType::SQL_TYPE_INT16:
+			case DbSqlType::SQL_TYPE_INT32:
+			case DbSqlType::SQL_TYPE_INT64:
+			case DbSqlType::SQL_TYPE_FLAG:
+				col->Append((int64)sqlite3_column_int64(stmt, x));
+				break;
+			case DbSqlType::SQL_TYPE_FLOAT32:
+			case DbSqlType::SQL_TYPE_FLOAT64:
+			case DbSqlType::SQL_TYPE_DECIMAL:
+				col->Append((float64)sqlite3_column_double(stmt, x));
+				break;
+			case DbSqlType::SQL_TYPE_BLOB:
+				{
+					const void *data = sqlite3_column_blob(stmt, x);
+					col->Append((void *)data, sqlite3_column_bytes(stmt, x));
+				}
+				break;
+			default:
+				{
+					const char *text = (const char *)sqlite3_column_text(stmt, x);
+					col->Append((void *)text, sqlite3_column_bytes(stmt, x));
+				}
+				break;
+			}
+		}
+		rows++;
+	}
+
+	if (0 == rs.ColumnCount())
+	{
+		DefineColumns(rs);
+	}
+	return rows;
+}
+
+#if defined(DEBUG)
+void SqlLiteReader::CheckMem() const
+{
+	m_sql.CheckMem();
+	m_stmts.CheckMem();
+	m_types.CheckMem();
+}
+
+void SqlLiteReader::ValidateMem() const
+{
+	m_sql.ValidateMem();
+	m_stmts.ValidateMem();
+	m_types.ValidateMem();
+}
+#endif
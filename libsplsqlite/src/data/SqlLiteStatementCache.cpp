@@ -0,0 +1,161 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <spl/Exception.h>
+#include <spl/data/SqlLiteStatementCache.h>
+
+#include "src/sqllite/sqlite3.h"
+
+using namespace spl;
+
+struct spl::_SqlLiteCachedStatement
+{
+	String sql;
+	sqlite3_stmt *stmt;
+	_SqlLiteCachedStatement *prev;
+	_SqlLiteCachedStatement *next;
+};
+
+SqlLiteStatementCache::SqlLiteStatementCache(void *db, int capacity)
+: m_db(db), m_capacity(capacity), m_idx(), m_head(NULL), m_tail(NULL), m_hits(0), m_misses(0)
+{
+}
+
+SqlLiteStatementCache::~SqlLiteStatementCache()
+{
+	Close();
+}
+
+void SqlLiteStatementCache::Unlink(_SqlLiteCachedStatement *entry)
+{
+	if (NULL == entry->prev)
+	{
+		m_head = entry->next;
+	}
+	else
+	{
+		entry->prev->next = entry->next;
+	}
+	if (NULL == entry->next)
+	{
+		m_tail = entry->prev;
+	}
+	else
+	{
+		entry->next->prev = entry->prev;
+	}
+	m_idx.Remove(entry->sql);
+}
+
+void SqlLiteStatementCache::Trim(int count)
+{
+	while (m_idx.Count() > count)
+	{
+		_SqlLiteCachedStatement *entry = m_tail;
+		Unlink(entry);
+		sqlite3_finalize(entry->stmt);
+		delete entry;
+	}
+}
+
+void *SqlLiteStatementCache::Acquire(const String& sql)
+{
+	_SqlLiteCachedStatement *entry;
+	if (m_idx.TryGet(sql, entry))
+	{
+		Unlink(entry);
+		sqlite3_stmt *stmt = entry->stmt;
+		delete entry;
+		m_hits++;
+		return stmt;
+	}
+
+	if (NULL == m_db)
+	{
+		throw new SqlException("Connection is closed");
+	}
+
+	sqlite3_stmt *stmt = NULL;
+	if (SQLITE_OK != sqlite3_prepare_v2((sqlite3 *)m_db, sql.GetChars(), sql.Length(), &stmt, NULL))
+	{
+		throw new SqlException(sqlite3_errmsg((sqlite3 *)m_db));
+	}
+	m_misses++;
+	return stmt;
+}
+
+void SqlLiteStatementCache::Release(const String& sql, void *stmt)
+{
+	if (NULL == m_db || 0 == m_capacity || m_idx.ContainsKey(sql))
+	{
+		sqlite3_finalize((sqlite3_stmt *)stmt);
+		return;
+	}
+
+	sqlite3_reset((sqlite3_stmt *)stmt);
+	sqlite3_clear_bindings((sqlite3_stmt *)stmt);
+
+	_SqlLiteCachedStatement *entry = new _SqlLiteCachedStatement();
+	entry->sql = sql;
+	entry->stmt = (sqlite3_stmt *)stmt;
+	entry->prev = NULL;
+	entry->next = m_head;
+	if (NULL == m_head)
+	{
+		m_tail = entry;
+	}
+	else
+	{
+		m_head->prev = entry;
+	}
+	m_head = entry;
+	m_idx.Set(sql, entry);
+
+	Trim(m_capacity);
+}
+
+void SqlLiteStatementCache::Close()
+{
+	Trim(0);
+	m_db = NULL;
+}
+
+void SqlLiteStatementCache::SetCapacity(int capacity)
+{
+	m_capacity = capacity < 0 ? 0 : capacity;
+	Trim(m_capacity);
+}
+
+#if defined(DEBUG)
+void SqlLiteStatementCache::CheckMem() const
+{
+	// m_idx notes the entries.
+	m_idx.CheckMem();
+	for (_SqlLiteCachedStatement *entry = m_head; NULL != entry; entry = entry->next)
+	{
+		entry->sql.CheckMem();
+	}
+}
+
+void SqlLiteStatementCache::ValidateMem() const
+{
+	m_idx.ValidateMem();
+	for (_SqlLiteCachedStatement *entry = m_head; NULL != entry; entry = entry->next)
+	{
+		entry->sql.ValidateMem();
+	}
+}
+#endif
@@ -24,11 +24,17 @@
 
 using namespace spl;
 
+extern void _TestSqlLite();
+
 int main(int argc, char **argv)
 {
 	try
 	{
-		TestHarness::RunTests();
+		_TestSqlLite();
+		DEBUG_CLEAR_MEM_CHECK_POINTS();
+		DEBUG_DUMP_MEM_LEAKS();
+		DEBUG_FREE_HEAP();
+
 		Log::SWriteEndOfRunTotal();
 		
 		ASSERT_MEM_FREE();
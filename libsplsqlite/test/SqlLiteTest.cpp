@@ -18,6 +18,8 @@
 
 #ifdef DEBUG
 
+#include <spl/Int32.h>
+#include <spl/data/ColumnTypes.h>
 #include <spl/io/File.h>
 #include <spl/io/log/Log.h>
 
@@ -83,11 +85,262 @@ static void _TestSqlLite1()
 	Log::SWriteOkFail( "SQLite3 test 1" );
 }
 
+static void _TestSqlLite2()
+{
+	const char *filename = "test2.sqlite";
+
+	if (File::Exists(filename))
+	{
+		File::Delete(filename);
+	}
+
+	{
+		SqlLiteConnection con(filename);
+		con.Open();
+
+		con.ExecuteNonQuery("CREATE TABLE data (PK INTEGER PRIMARY KEY, NAME VARCHAR(40), PRICE REAL, IMAGE BLOB);");
+		con.ExecuteNonQuery("INSERT INTO data (PK, NAME, PRICE, IMAGE) VALUES (1, NULL, NULL, NULL);");
+		con.ExecuteNonQuery("INSERT INTO data (PK, NAME, PRICE, IMAGE) VALUES (2, 'bill', 2.5, X'610062');");
+
+		TransactionPtr trans = con.BeginTransaction();
+		CommandPtr insert = con.CreateCommand("INSERT INTO data (PK, NAME, PRICE) VALUES (@pk, @name, 1.0);");
+		for (int x = 3; x <= 600; x++)
+		{
+			insert->Clear();
+			insert->CreateParameter("@pk", (int32)x);
+			insert->CreateParameter("@name", String("row"));
+			insert->ExecuteNonQuery();
+		}
+		trans->Commit();
+		trans.Release();
+		insert.Release();
+
+		// The first row is all nulls; the types come from the declarations.
+		RecordSetPtr rs = con.ExecuteQuery("SELECT PK, NAME, PRICE, IMAGE FROM data ORDER BY PK;");
+		UNIT_ASSERT("row count", rs->RowCount() == 600);
+		UNIT_ASSERT("int column", rs->GetColumn(0)->Type() == DbSqlType::SQL_TYPE_INT64);
+		UNIT_ASSERT("float column", rs->GetColumn(2)->Type() == DbSqlType::SQL_TYPE_FLOAT64);
+		UNIT_ASSERT("blob column", rs->GetColumn(3)->Type() == DbSqlType::SQL_TYPE_BLOB);
+		UNIT_ASSERT("null text", rs->GetColumn(1)->IsNull(0) && !rs->GetColumn(1)->IsNull(1));
+		UNIT_ASSERT("null real", rs->GetColumn(2)->IsNull(0) && rs->GetColumn(2)->GetFloat64(1) == 2.5);
+		UNIT_ASSERT("text", rs->GetColumn(1)->GetVarchar(1)->Equals("bill"));
+		UNIT_ASSERT("blob", static_cast<BlobColumn *>(rs->GetColumn(3))->GetBlob(1)->Length() == 3);
+		UNIT_ASSERT("blob null", rs->GetColumn(3)->IsNull(0) && rs->GetColumn(3)->IsNull(2));
+		rs.Release();
+
+		SqlLiteReaderPtr reader = con.ExecuteReader("SELECT PK, NAME, IMAGE, PK * 2 FROM data WHERE PK <= 2 ORDER BY PK;");
+		UNIT_ASSERT("reader columns", reader->ColumnCount() == 4);
+		UNIT_ASSERT("reader column name", 0 == strcmp(reader->ColumnName(1), "NAME"));
+		UNIT_ASSERT("reader row 1", reader->Next());
+		UNIT_ASSERT("reader null", reader->IsNull(1) && reader->GetInt64(0) == 1);
+		UNIT_ASSERT("reader expression type", reader->ColumnType(3) == DbSqlType::SQL_TYPE_INT64);
+		UNIT_ASSERT("reader row 2", reader->Next());
+		UNIT_ASSERT("reader text", reader->GetText(1).Equals("bill"));
+		int len;
+		const byte *blob = reader->GetBlob(2, len);
+		UNIT_ASSERT("reader blob", 3 == len && 'a' == blob[0] && 0 == blob[1] && 'b' == blob[2]);
+		UNIT_ASSERT("reader end", !reader->Next());
+		UNIT_ASSERT("reader stays at end", !reader->Next());
+		reader.Release();
+
+		// Batches of 256 rows.
+		reader = con.ExecuteReader("SELECT PK FROM data;");
+		RecordSet batch;
+		int rows = 0, batches = 0, count;
+		while ((count = reader->NextBatch(batch, 256)) > 0)
+		{
+			rows += count;
+			batches++;
+			batch.Clear();
+		}
+		UNIT_ASSERT("batches", 600 == rows && 3 == batches);
+		reader.Release();
+
+		SqlLiteStatementCachePtr cache = con.StatementCache();
+		int hits = cache->Hits();
+		rs = con.ExecuteQuery("SELECT PK FROM data WHERE PK = 1;");
+		rs = con.ExecuteQuery("SELECT PK FROM data WHERE PK = 1;");
+		UNIT_ASSERT("cache hit", cache->Hits() == hits + 1);
+
+		// Two readers on the same SQL need two statements.
+		SqlLiteReaderPtr r1 = con.ExecuteReader("SELECT PK FROM data WHERE PK < 3;");
+		SqlLiteReaderPtr r2 = con.ExecuteReader("SELECT PK FROM data WHERE PK < 3;");
+		UNIT_ASSERT("concurrent readers", r1->Next() && r2->Next() && r1->Next() && r1->GetInt64(0) == 2 && r2->GetInt64(0) == 1);
+		r1.Release();
+		r2.Release();
+
+		con.SetStatementCacheSize(2);
+		con.ExecuteQuery("SELECT 1;");
+		con.ExecuteQuery("SELECT 2;");
+		con.ExecuteQuery("SELECT 3;");
+		UNIT_ASSERT("cache size", cache->Count() == 2);
+		hits = cache->Hits();
+		con.ExecuteQuery("SELECT 3;");
+		con.ExecuteQuery("SELECT 1;");
+		UNIT_ASSERT("cache evicts the oldest", cache->Hits() == hits + 1);
+
+		DEBUG_CLEAR_MEM_CHECK_POINTS();
+		con.CheckMem();
+		cache.CheckMem();
+		rs.CheckMem();
+		batch.CheckMem();
+		DEBUG_DUMP_MEM_LEAKS();
+		UNIT_ASSERT_MEM_NOTED("SQLite3 2.1");
+
+		rs.Release();
+		cache.Release();
+		con.Close();
+	}
+
+	File::Delete(filename);
+
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
+	UNIT_ASSERT_MEM_NOTED("SQLite3 2.2");
+	Log::SWriteOkFail( "SQLite3 reader and statement cache" );
+}
+
+static void _TestSqlLite3()
+{
+	const char *filename = "test3.sqlite";
+
+	if (File::Exists(filename))
+	{
+		File::Delete(filename);
+	}
+
+	{
+		SqlLiteConnection con(filename);
+		con.Open();
+
+		con.ExecuteNonQuery("CREATE TABLE data (PK INTEGER PRIMARY KEY, NAME VARCHAR(40), PRICE REAL, IMAGE BLOB);");
+		con.ExecuteNonQuery("CREATE TABLE copy (PK INTEGER PRIMARY KEY, NAME VARCHAR(40), PRICE REAL, IMAGE BLOB);");
+
+		RecordSet rs;
+		rs.DefineColumn("PK", DbSqlType::SQL_TYPE_INT64, 8);
+		rs.DefineColumn("NAME", DbSqlType::SQL_TYPE_VARCHAR, 40);
+		rs.DefineColumn("PRICE", DbSqlType::SQL_TYPE_FLOAT64, 8);
+		rs.DefineColumn("IMAGE", DbSqlType::SQL_TYPE_BLOB, 8);
+		for (int x = 1; x <= 2500; x++)
+		{
+			rs.GetColumn(0)->Append((int64)x);
+			if (0 == x % 10)
+			{
+				rs.GetColumn(1)->AppendNull();
+			}
+			else
+			{
+				rs.GetColumn(1)->Append(*Int32::ToString(x));
+			}
+			rs.GetColumn(2)->Append((float64)x / 2);
+			rs.GetColumn(3)->Append((void *)"a\0b", 3);
+		}
+
+		SqlLiteBulkLoaderPtr loader = con.CreateBulkLoader("data", 1000);
+		loader->SetLoadMode(true);
+		UNIT_ASSERT("load", 2500 == loader->Load(rs));
+		UNIT_ASSERT("load mode", 0 == con.ExecuteQuery("PRAGMA synchronous;")->GetColumn(0)->GetInt32(0));
+		loader->Finish();
+		UNIT_ASSERT("rows", 2500 == loader->Rows());
+		UNIT_ASSERT("rate", loader->RowsPerSecond() >= 0);
+		UNIT_ASSERT("pragma restored", 0 != con.ExecuteQuery("PRAGMA synchronous;")->GetColumn(0)->GetInt32(0));
+		loader.Release();
+
+		RecordSetPtr check = con.ExecuteQuery("SELECT COUNT(*), COUNT(NAME), SUM(PRICE), SUM(LENGTH(IMAGE)) FROM data;");
+		UNIT_ASSERT("count", 2500 == check->GetColumn(0)->GetInt64(0));
+		UNIT_ASSERT("nulls", 2250 == check->GetColumn(1)->GetInt64(0));
+		UNIT_ASSERT("sum", 2500.0 * 2501.0 / 4.0 == check->GetColumn(2)->GetFloat64(0));
+		UNIT_ASSERT("blobs", 7500 == check->GetColumn(3)->GetInt64(0));
+		check = con.ExecuteQuery("SELECT NAME FROM data WHERE PK = 1234;");
+		UNIT_ASSERT("text", check->GetColumn(0)->GetVarchar(0)->Equals("1234"));
+
+		// A table to table copy through reader batches.
+		loader = con.CreateBulkLoader("copy", 300);
+		SqlLiteReaderPtr reader = con.ExecuteReader("SELECT * FROM data;");
+		RecordSet batch;
+		while (reader->NextBatch(batch, 256) > 0)
+		{
+			loader->Load(batch);
+			batch.Clear();
+		}
+		reader.Release();
+		loader->Finish();
+		check = con.ExecuteQuery("SELECT COUNT(*) FROM copy c JOIN data d ON c.PK = d.PK WHERE c.NAME IS d.NAME AND c.PRICE = d.PRICE AND c.IMAGE = d.IMAGE;");
+		UNIT_ASSERT("copy", 2500 == check->GetColumn(0)->GetInt64(0));
+		loader.Release();
+
+		// Rows not committed are rolled back.
+		loader = con.CreateBulkLoader("copy", 5000);
+		try
+		{
+			loader->Load(rs);
+			UNIT_ASSERT("duplicate keys", false);
+		}
+		catch (SqlException *ex)
+		{
+			delete ex;
+		}
+		loader.Release();
+		check = con.ExecuteQuery("SELECT COUNT(*) FROM copy;");
+		UNIT_ASSERT("rollback", 2500 == check->GetColumn(0)->GetInt64(0));
+
+		// Names with a '"' in them are quoted.
+		con.ExecuteNonQuery("CREATE TABLE \"odd\"\"name\" (\"a\"\"b\" INTEGER);");
+		RecordSet odd;
+		odd.DefineColumn("a\"b", DbSqlType::SQL_TYPE_INT64, 8);
+		odd.GetColumn(0)->Append((int64)7);
+		loader = con.CreateBulkLoader("odd\"name");
+		loader->Load(odd);
+		loader->Finish();
+		loader.Release();
+		check = con.ExecuteQuery("SELECT \"a\"\"b\" FROM \"odd\"\"name\";");
+		UNIT_ASSERT("quoted", 7 == check->GetColumn(0)->GetInt64(0));
+
+		// Dropped without Finish, the load is rolled back and the settings restored.
+		loader = con.CreateBulkLoader("odd\"name");
+		loader->SetLoadMode(true);
+		loader->Load(odd);
+		UNIT_ASSERT("load mode again", 0 == con.ExecuteQuery("PRAGMA synchronous;")->GetColumn(0)->GetInt32(0));
+		loader.Release();
+		UNIT_ASSERT("pragma restored by destructor", 0 != con.ExecuteQuery("PRAGMA synchronous;")->GetColumn(0)->GetInt32(0));
+		UNIT_ASSERT("journal restored", !con.ExecuteQuery("PRAGMA journal_mode;")->GetColumn(0)->GetVarchar(0)->EqualsIgnoreCase("memory"));
+		check = con.ExecuteQuery("SELECT COUNT(*) FROM \"odd\"\"name\";");
+		UNIT_ASSERT("destructor rollback", 1 == check->GetColumn(0)->GetInt64(0));
+
+		DEBUG_CLEAR_MEM_CHECK_POINTS();
+		con.CheckMem();
+		rs.CheckMem();
+		odd.CheckMem();
+		check.CheckMem();
+		batch.CheckMem();
+		DEBUG_DUMP_MEM_LEAKS();
+		UNIT_ASSERT_MEM_NOTED("SQLite3 3.1");
+
+		check.Release();
+		con.Close();
+	}
+
+	File::Delete(filename);
+
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
+	UNIT_ASSERT_MEM_NOTED("SQLite3 3.2");
+	Log::SWriteOkFail( "SQLite3 bulk loader" );
+}
+
 void _TestSqlLite()
 {
 	_TestSqlLite1();
 	DEBUG_CLEAR_MEM_CHECK_POINTS();
 	DEBUG_DUMP_MEM_LEAKS();
+
+	_TestSqlLite2();
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
+
+	_TestSqlLite3();
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
 }
 
 #endif
@@ -0,0 +1,209 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+ *	XPath micro-benchmarks over a generated document.  Build against the
+ *	release libraries with
+ *		g++ -O2 -DNDEBUG -I. -I../libspl -o benchxml benchxml.cpp -lsplxml -lspl -pthread
+ *	then run "./benchxml [name]" to run one benchmark.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include <spl/types.h>
+#include <spl/Debug.h>
+#include <spl/Exception.h>
+#include <spl/Int32.h>
+#include <spl/text/StringBuffer.h>
+#include <spl/xml/XmlDocument.h>
+#include <spl/xml/xpath/XPath.h>
+#include <spl/xml/xpath/private/XPathParser.h>
+
+using namespace spl;
+
+#define BENCH_XML_ITEMS 2000
+
+static double _Seconds()
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return (double)tv.tv_sec + (double)tv.tv_usec / 1000000.0;
+}
+
+static void _Report(const char *name, int count, double secs)
+{
+	printf("%-40s %10d in %6.3fs  %12.0f/s\n", name, count, secs, (double)count / secs);
+}
+
+static void _Check(const char *name, int found, int expected)
+{
+	if ( found != expected )
+	{
+		printf("%s: expected %d, got %d\n", name, expected, found);
+	}
+}
+
+/** @brief A catalog of items, each with a title, a price and a few tags. */
+static XmlDocumentPtr _MakeDocument()
+{
+	StringBuffer xml;
+	xml.Append("<catalog>");
+	for ( int x = 0; x < BENCH_XML_ITEMS; x++ )
+	{
+		xml.Append("<item id=\"");
+		xml.Append(Int32::ToString(x));
+		xml.Append("\" kind=\"");
+		xml.Append(0 == x % 10 ? "rare" : "common");
+		xml.Append("\"><title>Item ");
+		xml.Append(Int32::ToString(x));
+		xml.Append("</title><price>");
+		xml.Append(Int32::ToString(x % 100));
+		xml.Append("</price><tags><tag>a</tag><tag>b</tag><tag>c</tag></tags></item>");
+	}
+	xml.Append("</catalog>");
+	return XmlDocument::ParseXml(*xml.ToString());
+}
+
+/** @brief Runs a path with the parser's operators, which build a list per step, and compiled. */
+static void BenchPath(XmlDocumentPtr doc, const char *path, int expected, int count)
+{
+	char name[80];
+	XPathParser parser;
+	Array<XPathOperatorPtr> ops = parser.Parse(path);
+	XPath xpath(path);
+	int found = 0;
+
+	double start = _Seconds();
+	for ( int x = 0; x < count; x++ )
+	{
+		found = XPath::SelectNodes(ops, doc)->Count();
+	}
+	sprintf(name, "%s operators", path);
+	_Report(name, count, _Seconds() - start);
+	_Check(name, found, expected);
+
+	start = _Seconds();
+	for ( int x = 0; x < count; x++ )
+	{
+		found = xpath.SelectNodes(doc)->Count();
+	}
+	sprintf(name, "%s compiled", path);
+	_Report(name, count, _Seconds() - start);
+	_Check(name, found, expected);
+}
+
+/** @brief Child steps, a predicate and attributes. */
+static void BenchSelect(XmlDocumentPtr doc)
+{
+	BenchPath(doc, "/catalog/item/title", BENCH_XML_ITEMS, 20);
+	BenchPath(doc, "/catalog/item[@kind = 'rare']", BENCH_XML_ITEMS / 10, 20);
+	BenchPath(doc, "/catalog/item@id", BENCH_XML_ITEMS, 20);
+}
+
+/** @brief "//" from the document and the root element, walking the tree and from the name index. */
+static void BenchDescendants(XmlDocumentPtr doc)
+{
+	BenchPath(doc, "//price", BENCH_XML_ITEMS, 20);
+
+	const char *paths[] = { "//price", "/catalog//title", NULL };
+	for ( int p = 0; NULL != paths[p]; p++ )
+	{
+		char name[80];
+		XPath xpath(paths[p]);
+		int found = 0;
+		int count = 200;
+
+		doc->SetUseNameIndex(true);
+		double start = _Seconds();
+		for ( int x = 0; x < count; x++ )
+		{
+			found = xpath.SelectNodes(doc)->Count();
+		}
+		sprintf(name, "%s indexed", paths[p]);
+		_Report(name, count, _Seconds() - start);
+		_Check(name, found, BENCH_XML_ITEMS);
+
+		doc->SetUseNameIndex(false);
+		start = _Seconds();
+		for ( int x = 0; x < count; x++ )
+		{
+			found = xpath.SelectNodes(doc)->Count();
+		}
+		sprintf(name, "%s walked", paths[p]);
+		_Report(name, count, _Seconds() - start);
+		_Check(name, found, BENCH_XML_ITEMS);
+	}
+}
+
+/** @brief Many single node lookups, parsing the XPath each time and compiled once. */
+static void BenchSingle(XmlDocumentPtr doc)
+{
+	const char *path = "/catalog/item/price";
+	int count = 100000;
+	XPath xpath(path);
+	int found = 0;
+
+	double start = _Seconds();
+	for ( int x = 0; x < count; x++ )
+	{
+		found += doc->SelectSingleNode(path).IsNotNull() ? 1 : 0;
+	}
+	_Report("SelectSingleNode parsed each time", count, _Seconds() - start);
+	_Check("SelectSingleNode parsed each time", found, count);
+
+	found = 0;
+	start = _Seconds();
+	for ( int x = 0; x < count; x++ )
+	{
+		found += xpath.SelectSingleNode(doc).IsNotNull() ? 1 : 0;
+	}
+	_Report("SelectSingleNode compiled", count, _Seconds() - start);
+	_Check("SelectSingleNode compiled", found, count);
+}
+
+int main(int argc, char **argv)
+{
+	const char *which = (argc > 1) ? argv[1] : "all";
+
+	try
+	{
+		double start = _Seconds();
+		XmlDocumentPtr doc = _MakeDocument();
+		_Report("parse", BENCH_XML_ITEMS, _Seconds() - start);
+
+		if ( 0 == strcmp(which, "all") || 0 == strcmp(which, "select") )
+		{
+			BenchSelect(doc);
+		}
+		if ( 0 == strcmp(which, "all") || 0 == strcmp(which, "descendants") )
+		{
+			BenchDescendants(doc);
+		}
+		if ( 0 == strcmp(which, "all") || 0 == strcmp(which, "single") )
+		{
+			BenchSingle(doc);
+		}
+	}
+	catch ( Exception *ex )
+	{
+		printf("%s\n", ex->Message());
+		delete ex;
+		return 20;
+	}
+	return 0;
+}
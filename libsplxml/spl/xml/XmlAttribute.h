@@ -69,6 +69,7 @@ public:
 			
 	/// Return the name of this attribute.
 	virtual String Name() const;
+	virtual bool HasName( const String& name ) const;
 	
 	void SetName( const String& _name )	{ m_name = _name; }				///< Set the name of this attribute.
 	void SetValue( const String& _value )	{ m_value = _value; }				///< Set the value.
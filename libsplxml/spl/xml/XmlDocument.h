@@ -29,6 +29,8 @@ distribution.
 
 #include <spl/Debug.h>
 #include <spl/collection/Array.h>
+#include <spl/collection/Hashtable.h>
+#include <spl/collection/Vector.h>
 #include <spl/io/FileStream.h>
 #include <spl/RefCountPtr.h>
 #include <spl/io/StringStream.h>
@@ -49,12 +51,29 @@ namespace spl
 class XmlDocument : public XmlNode
 {
 protected:	
+	friend class XmlNode;
+	friend class XPathIterator;
+
 	static bool m_condenseWhiteSpace;
 
 	static int m_tabsize;
 	
 	bool m_useMicrosoftBOM;		///< the UTF-8 BOM were found when read. Note this, and try to write.public:
 
+	bool m_useNameIndex;
+	bool m_nameIndexBuilt;
+	/// Elements by name, in document order.
+	Hashtable<String, RefCountPtr<Vector<XmlNode *> > > m_nameIndex;
+
+	void BuildNameIndex();
+	void InvalidateNameIndex();
+
+	/** @brief The elements called name, or NULL if there are none.
+	 *	@param hash Math::Hash(name).
+	 *	@return false if the index is off.
+	 */
+	bool TryGetIndexed( const String& name, uint32 hash, Vector<XmlNode *> *& nodes );
+
 	/** Parse the given null terminated block of xml data. Passing in an encoding to this
 		method (either TIXML_ENCODING_LEGACY or TIXML_ENCODING_UTF8 will force TinyXml
 		to use that encoding, regardless of what TinyXml might otherwise try to detect.
@@ -107,6 +126,17 @@ public:
 	*/
 	XmlElementPtr RootElement();
 
+	/** @brief All of the elements called name, in document order. */
+	RefCountPtr<XmlNodeList> GetElementsByTagName( const String& name );
+
+	/** @brief Turns on an index of the elements by name, used by "//name" XPath
+	 *	queries and GetElementsByTagName.  The index is built the first time it
+	 *	is needed and dropped whenever a node is added or removed, so turn it on
+	 *	for documents that are queried many times between changes.
+	 */
+	void SetUseNameIndex( bool use );
+	inline bool UseNameIndex() const { return m_useNameIndex; }
+
 	/** SetTabSize() allows the error reporting functions (ErrorRow() and ErrorCol())
 		to report the correct values for row and column. It does not change the output
 		or input in any way.
@@ -55,6 +55,7 @@ public:
 	virtual ~XmlElement();
 
 	virtual String Name() const;
+	virtual bool HasName( const String& name ) const;
 			
 	void operator =( const XmlElement& base );
 	
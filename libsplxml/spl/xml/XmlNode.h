@@ -143,6 +143,7 @@ protected:
 	friend class XmlDocument;
 	friend class TinyXmlParser;
 	friend class XmlElement;
+	friend class XPathIterator;
 	
 	XmlNode*		m_parent;
 	XmlNodeType		m_type;
@@ -169,6 +170,30 @@ protected:
 	XmlNodePtr Identify( const char* start, XmlEncoding encoding );
 
 	virtual const char* _Parse(	const char* p, XmlParsingData* data, XmlEncoding encoding /*= TIXML_ENCODING_UNKNOWN */ ) = 0;
+
+	// Clear without telling the document, for destructors.
+	void ClearChildren();
+
+	// Called after the children change; drops the document's name index.
+	void TreeChanged();
+
+	// The node after node in a pre-order walk of root's descendants, or NULL.
+	inline static XmlNode *NextInTree( const XmlNode *node, const XmlNode *root )
+	{
+		if ( node->m_firstChild.IsNotNull() )
+		{
+			return node->m_firstChild.Get();
+		}
+		while ( node != root )
+		{
+			if ( node->m_next.IsNotNull() )
+			{
+				return node->m_next.Get();
+			}
+			node = node->m_parent;
+		}
+		return NULL;
+	}
 							  
 public:
 	class Iterator : public IIterator<XmlNodePtr>
@@ -210,6 +235,9 @@ public:
 	}
 
 	virtual String Name() const = 0;
+
+	/// @brief Same as Name() == name, without making a copy of the name.
+	virtual bool HasName( const String& name ) const;
 	
 	/** Changes the value of the node. Defined as:
 		@verbatim
@@ -0,0 +1,193 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _xmlreader_h
+#define _xmlreader_h
+
+#include <spl/types.h>
+#include <spl/Debug.h>
+#include <spl/Memory.h>
+#include <spl/RefCountPtr.h>
+#include <spl/String.h>
+#include <spl/StringView.h>
+#include <spl/collection/Array.h>
+#include <spl/collection/Vector.h>
+#include <spl/io/IStream.h>
+#include <spl/xml/XmlNode.h>
+
+namespace spl
+{
+/**
+ * @defgroup xml XML
+ * @{
+ */
+
+/// The initial size of an XmlReader's input buffer.
+#define XMLREADER_BUFFER_SIZE 65536
+
+class XmlReader;
+typedef RefCountPtr<XmlReader> XmlReaderPtr;
+
+/** @brief A run of chars in an XmlReader's buffer, or its scratch space when inScratch. */
+typedef struct _XmlReaderSlice
+{
+	int start;
+	int len;
+	bool inScratch;
+} XmlReaderSlice;
+
+inline void TypeValidate( const XmlReaderSlice& s )
+{
+}
+
+inline void TypeCheckMem( const XmlReaderSlice& s )
+{
+}
+
+/** @brief A forward only, pull parser for large XML documents.
+ *	The input is read a buffer at a time and nothing is kept once the reader
+ *	has moved past it, so memory is bounded by the largest single tag or text
+ *	run rather than the document.  Names and values are StringViews into the
+ *	buffer, valid until the next Read; values are copied only when they
+ *	contain entities.  Call ReadSubtree to get the current element as a DOM.
+ *	<pre>
+ *	XmlReader reader(File::OpenRead("feed.xml"));
+ *	while (reader.Read())
+ *	{
+ *		if (XmlReader::ELEMENT == reader.NodeType() && reader.Name().Equals("item"))
+ *		{
+ *			XmlElementPtr item = reader.ReadSubtree();
+ *		}
+ *	}
+ *	</pre>
+ *	An empty element such as &lt;a/&gt; is one ELEMENT node with IsEmptyElement
+ *	set; it has no END_ELEMENT.  DTDs are skipped and only the predefined and
+ *	character entities are expanded.
+ */
+class XmlReader : public IMemoryValidate
+{
+public:
+	typedef enum _XmlReaderNodeType
+	{
+		NONE = 0,			///< Before the first Read and after the end.
+		ELEMENT = 1,
+		END_ELEMENT = 2,
+		TEXT = 3,
+		CDATA = 4,
+		COMMENT = 5,
+		DECLARATION = 6,	///< &lt;?xml ... ?&gt;; the attributes hold version, encoding, etc.
+		PROCESSING_INSTRUCTION = 7
+	} NodeType_t;
+
+private:
+	// Copy constructor doesn't make sense for this class
+	inline XmlReader(const XmlReader& reader) {}
+	inline void operator =(const XmlReader& reader) {}
+
+	IStreamPtr m_stream;
+	Array<byte> m_buf;
+	int m_pos;				//< Start of the unparsed input.
+	int m_end;				//< End of the input read so far.
+	bool m_eof;
+
+	Array<char> m_scratch;	//< Entity expanded values of the current node.
+	int m_scratchLen;
+	Array<char> m_open;		//< Names of the open elements, end to end.
+	int m_openLen;
+	Vector<int> m_openStarts;
+
+	NodeType_t m_nodeType;
+	int m_depth;
+	bool m_isEmpty;
+	int m_tokStart;			//< The raw text of the current node in m_buf.
+	int m_tokLen;
+	XmlReaderSlice m_name;
+	XmlReaderSlice m_value;
+	Vector<XmlReaderSlice> m_attrs;	//< Name, value pairs.
+	int m_line;
+	bool m_ignoreWhitespace;
+
+	inline const char *Chars(const XmlReaderSlice& s) const
+	{
+		return s.inScratch ? m_scratch.Data() + s.start : (const char *)m_buf.Data() + s.start;
+	}
+
+	int Fill();
+	int Find(int from, const char *term, int termLen);
+	void Decode(int start, int len, XmlReaderSlice& slice);
+	void ParseTag(int start, int end);
+	void ParseAttributes(int pos, int end);
+	void Push(int start, int len);
+	void Error(const char *msg) const;
+
+public:
+	/** @param stream Read from the current position to the end of the stream. */
+	XmlReader(IStreamPtr stream, int bufferSize = XMLREADER_BUFFER_SIZE);
+	virtual ~XmlReader();
+
+	/** @brief Moves to the next node.
+	 *	@return false at the end of the input.
+	 *	@throws XmlException if the input isn't well formed.
+	 */
+	bool Read();
+
+	/** @brief Moves past the end of the current element without reporting its children. */
+	void Skip();
+
+	/** @brief Reads the current element and its children into a DOM.
+	 *	Afterwards the reader is on the element's END_ELEMENT, or still on the
+	 *	element if it is empty.
+	 */
+	XmlElementPtr ReadSubtree();
+
+	inline NodeType_t NodeType() const { return m_nodeType; }
+
+	/** @brief The depth of the current node; the root element is at zero. */
+	inline int Depth() const { return m_depth; }
+
+	/** @brief Element, declaration and processing instruction name. */
+	inline StringView Name() const { return StringView(Chars(m_name), m_name.len); }
+
+	/** @brief Text, CDATA, comment and processing instruction content. */
+	inline StringView Value() const { return StringView(Chars(m_value), m_value.len); }
+
+	inline bool IsEmptyElement() const { return m_isEmpty; }
+
+	inline int AttributeCount() const { return m_attrs.Count() / 2; }
+	inline StringView AttributeName(int idx) const { const XmlReaderSlice& s = m_attrs.ElementAtRef(idx * 2); return StringView(Chars(s), s.len); }
+	inline StringView AttributeValue(int idx) const { const XmlReaderSlice& s = m_attrs.ElementAtRef(idx * 2 + 1); return StringView(Chars(s), s.len); }
+
+	/** @brief Sets value to the attribute called name, if the current node has one. */
+	bool TryGetAttribute(const char *name, StringView& value) const;
+
+	/** @brief The line the current node ends on, from one. */
+	inline int Line() const { return m_line; }
+
+	/** @brief When true, the default, text nodes that are all white space aren't reported. */
+	inline void SetIgnoreWhitespace(bool ignore) { m_ignoreWhitespace = ignore; }
+
+#if defined(DEBUG)
+	virtual void CheckMem() const;
+	virtual void ValidateMem() const;
+#endif
+};
+
+REGISTER_TYPEOF( 516, XmlReader );
+REGISTER_TYPEOF( 518, XmlReaderPtr );
+
+/** @} */
+}
+#endif
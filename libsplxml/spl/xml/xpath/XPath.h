@@ -26,7 +26,9 @@
 #include <spl/String.h>
 #include <spl/xml/XmlNode.h>
 #include <spl/xml/XmlNodeList.h>
+#include <spl/xml/xpath/XPathIterator.h>
 #include <spl/xml/xpath/private/XPathOperator.h>
+#include <spl/xml/xpath/private/XPathPlan.h>
 
 namespace spl
 {
@@ -51,11 +53,14 @@ typedef RefCountPtr<XPath> XPathPtr;
  *	<li>"/bookstore/@"</li>
  *	<li>"/bookstore/book[@category = 'WEB']"</li>
  *	</ul>
+ *	The expression is compiled when the XPath is made, so keep the XPath to run
+ *	the same query many times.  "//" selects in document order.
  */
 class XPath : public IMemoryValidate
 {
 private:
 	Array<XPathOperatorPtr> m_ops;
+	XPathPlanPtr m_plan;
 	
 protected:
 	static XmlNodeListPtr SelectNodes(Array<XPathOperatorPtr>&ops, XmlNodePtr context, bool findAll);
@@ -76,6 +81,12 @@ public:
 	XmlNodeListPtr SelectNodes(XmlNodePtr context);
 	XmlNodePtr SelectSingleNode(XmlNodePtr context);
 
+	/** @brief Iterates the selected nodes without building a list. */
+	inline XPathIterator Select(XmlNodePtr context)
+	{
+		return XPathIterator(m_plan, context);
+	}
+
 	static XmlNodeListPtr SelectNodes(Array<XPathOperatorPtr>&ops, XmlNodePtr context);
 	
 #if defined(DEBUG) || defined(_DEBUG)
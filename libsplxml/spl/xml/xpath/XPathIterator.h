@@ -0,0 +1,107 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _xpathiterator_h
+#define _xpathiterator_h
+
+#include <spl/types.h>
+#include <spl/Debug.h>
+#include <spl/IIterator.h>
+#include <spl/Memory.h>
+#include <spl/RefCountPtr.h>
+#include <spl/collection/Vector.h>
+#include <spl/xml/XmlNode.h>
+#include <spl/xml/xpath/private/XPathPlan.h>
+
+namespace spl
+{
+/**
+ * @defgroup xml XML
+ * @{
+ */
+
+/** @brief Where an XPathIterator is in one step for one input node. */
+typedef struct _XPathFrame
+{
+	int step;
+	XmlNode *input;
+	XmlNode *cur;				//< The last node returned.
+	int pos;					//< Calls so far, or the next index of indexed.
+	Vector<XmlNode *> *indexed;	//< The document's elements called the step's name.
+	bool inScope;				//< indexed nodes must be descendants of input.
+} XPathFrame;
+
+inline void TypeValidate( const XPathFrame& f )
+{
+}
+
+inline void TypeCheckMem( const XPathFrame& f )
+{
+}
+
+/** @brief Walks the nodes an XPath selects, one at a time.
+ *	Each step pulls its next node from the step before it, so no lists are
+ *	built between steps and evaluation can stop at the first match.
+ *	Descendant steps in a document with XmlDocument::SetUseNameIndex on look
+ *	the name up in the index instead of walking the tree.  The document must
+ *	not change while the iterator is in use.
+ *	<pre>
+ *	XPath xpath("//item");
+ *	for (XPathIterator iter(xpath.Select(doc)); iter.Next(); )
+ *	{
+ *		XmlNodePtr item = iter.Current();
+ *	}
+ *	</pre>
+ */
+class XPathIterator : public IIterator<XmlNodePtr>, public IMemoryValidate
+{
+private:
+	XPathPlanPtr m_plan;
+	XmlNodePtr m_context;
+	Vector<XPathFrame> m_stack;
+	XmlNodePtr m_current;
+
+	// For predicates, which hold their own reference to the context.
+	XPathIterator(XPathPlanPtr plan, XmlNode *context);
+
+	void Push(int step, XmlNode *input);
+	XmlNode *NextNode();
+	XmlNode *Advance(XPathFrame& frame);
+	XmlNode *AdvanceDescendants(XPathFrame& frame, const XPathStep& step);
+	bool Test(const XPathStep& step, XmlNode *node);
+
+public:
+	XPathIterator(XPathPlanPtr plan, XmlNodePtr context);
+	XPathIterator(const XPathIterator& iter);
+	virtual ~XPathIterator();
+
+	XPathIterator& operator =(const XPathIterator& iter);
+
+	virtual bool Next();
+	virtual bool Prev();
+
+	virtual XmlNodePtr Current();
+	virtual XmlNodePtr& CurrentRef();
+
+#if defined(DEBUG) || defined(_DEBUG)
+	void CheckMem() const;
+	void ValidateMem() const;
+#endif
+};
+
+/** @} */
+}
+#endif
@@ -23,6 +23,7 @@ public:
 	
 	virtual bool IsMatch(XmlNode& context);
 	virtual XmlNodeListPtr NextContext(XmlNodePtr context);
+	virtual void Compile(XPathPlan& plan);
 	
 #if defined(DEBUG) || defined(_DEBUG)
 	void CheckMem() const;
@@ -41,6 +41,7 @@ public:
 	
 	virtual bool IsMatch(XmlNode& context);
 	virtual XmlNodeListPtr NextContext(XmlNodePtr context);
+	virtual void Compile(XPathPlan& plan);
 	
 	inline Vector<XPathOperatorPtr>& Operators() { return m_ops; }
 	inline Operator& BinOp() { return m_binop; }
@@ -11,6 +11,7 @@
 
 namespace spl
 {
+	class XPathPlan;
 	class XPathOperator;
 	typedef RefCountPtr<XPathOperator> XPathOperatorPtr;
 
@@ -25,6 +26,7 @@ namespace spl
 		
 		virtual bool IsMatch(XmlNode& context);
 		virtual XmlNodeListPtr NextContext(XmlNodePtr context);
+		virtual void Compile(XPathPlan& plan);
 		
 	#if defined(DEBUG) || defined(_DEBUG)
 		void CheckMem() const;
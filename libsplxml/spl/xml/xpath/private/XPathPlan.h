@@ -0,0 +1,86 @@
+#ifndef _xpathplan_h
+#define _xpathplan_h
+
+#include <spl/types.h>
+#include <spl/Debug.h>
+#include <spl/Memory.h>
+#include <spl/RefCountPtr.h>
+#include <spl/String.h>
+#include <spl/Variant.h>
+#include <spl/collection/Array.h>
+#include <spl/collection/Vector.h>
+#include <spl/xml/xpath/private/XPathOperator.h>
+
+namespace spl
+{
+class XPathPlan;
+typedef RefCountPtr<XPathPlan> XPathPlanPtr;
+
+/** @brief One step of a compiled XPath; it maps each input node to zero or more nodes. */
+class XPathStep : public IMemoryValidate
+{
+public:
+	typedef enum _XPathStepKind
+	{
+		XPS_NONE = 0,		///< Nothing.
+		XPS_ROOT = 1,		///< The input, if it has no parent.
+		XPS_CHILDREN = 2,	///< The children, or the children called name.
+		XPS_DESCENDANTS = 3,///< The descendants in document order, or those called name.
+		XPS_NAMED = 4,		///< The input, if it is called name.
+		XPS_ATTRIBUTES = 5,	///< An element's attributes.
+		XPS_PREDICATE = 6,	///< The input, if a node predicate selects from it compares true to arg.
+		XPS_ERROR = 7		///< Throws name as the message.
+	} Kind;
+
+	Kind kind;
+	String name;
+	uint32 hash;			///< Math::Hash(name), for the document name index.
+	XPathPlanPtr predicate;
+	int binop;				///< An XPathOpPredicate::Operator.
+	VariantPtr arg;
+
+	XPathStep();
+	XPathStep(Kind k);
+	XPathStep(Kind k, const String& n);
+	XPathStep(const XPathStep& step);
+	virtual ~XPathStep();
+
+	XPathStep& operator =(const XPathStep& step);
+
+#if defined(DEBUG) || defined(_DEBUG)
+	void CheckMem() const;
+	void ValidateMem() const;
+#endif
+};
+
+/** @brief The steps of an XPath, compiled from the parser's operators once and
+ *	shared by every XPathIterator that evaluates it.
+ */
+class XPathPlan : public IMemoryValidate
+{
+private:
+	// Plans are shared, not copied
+	inline XPathPlan(const XPathPlan& plan) {}
+	inline void operator =(const XPathPlan& plan) {}
+
+	Vector<XPathStep> m_steps;
+
+public:
+	XPathPlan();
+	virtual ~XPathPlan();
+
+	static XPathPlanPtr Compile(Array<XPathOperatorPtr>& ops);
+
+	/** @brief Appends step, folding a name test into a CHILDREN or DESCENDANTS step before it. */
+	void Add(const XPathStep& step);
+
+	inline int Count() const { return m_steps.Count(); }
+	inline const XPathStep& Step(int idx) const { return m_steps.ElementAtRef(idx); }
+
+#if defined(DEBUG) || defined(_DEBUG)
+	void CheckMem() const;
+	void ValidateMem() const;
+#endif
+};
+}
+#endif
@@ -56,6 +56,11 @@ String XmlAttribute::Name() const
 	return m_name;
 }
 
+bool XmlAttribute::HasName( const String& name ) const
+{
+	return m_name.Length() == name.Length() && m_name.Equals(name);
+}
+
 XmlNodePtr XmlAttribute::Clone() const
 {
 	XmlAttributePtr clone(new XmlAttribute());
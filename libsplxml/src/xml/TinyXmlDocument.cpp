@@ -27,6 +27,7 @@ distribution.
 #include <spl/xml/XmlDocument.h>
 #include <spl/xml/XmlElement.h>
 #include <spl/xml/XmlIterator.h>
+#include <spl/xml/XmlNodeList.h>
 
 using namespace spl;
 
@@ -35,7 +36,10 @@ bool XmlDocument::m_condenseWhiteSpace = true;
 
 XmlDocument::XmlDocument() 
 :	XmlNode( XmlNode::DOCUMENT ), 
-	m_useMicrosoftBOM(false)
+	m_useMicrosoftBOM(false),
+	m_useNameIndex(false),
+	m_nameIndexBuilt(false),
+	m_nameIndex()
 {
 	m_tabsize = 4;
 	m_useMicrosoftBOM = false;
@@ -43,7 +47,10 @@ XmlDocument::XmlDocument()
 
 XmlDocument::XmlDocument( const XmlDocument& copy ) 
 :	XmlNode( XmlNode::DOCUMENT ),
-	m_useMicrosoftBOM(false)
+	m_useMicrosoftBOM(false),
+	m_useNameIndex(false),
+	m_nameIndexBuilt(false),
+	m_nameIndex()
 {
 	copy.CopyTo( *this );
 }
@@ -63,6 +70,87 @@ XmlElementPtr XmlDocument::RootElement()
 	return FirstChildElement(); 
 }
 
+void XmlDocument::SetUseNameIndex( bool use )
+{
+	m_useNameIndex = use;
+	if ( !use )
+	{
+		InvalidateNameIndex();
+	}
+}
+
+void XmlDocument::InvalidateNameIndex()
+{
+	if ( m_nameIndexBuilt )
+	{
+		m_nameIndex.Clear();
+		m_nameIndexBuilt = false;
+	}
+}
+
+void XmlDocument::BuildNameIndex()
+{
+	RefCountPtr<Vector<XmlNode *> > nodes;
+
+	// Pre-order, so each list is in document order.
+	for ( XmlNode *node = NextInTree(this, this); NULL != node; node = NextInTree(node, this) )
+	{
+		if ( !node->IsElement() )
+		{
+			continue;
+		}
+		String name(node->Name());
+		if ( !m_nameIndex.TryGet(name, nodes) )
+		{
+			nodes = RefCountPtr<Vector<XmlNode *> >(new Vector<XmlNode *>());
+			m_nameIndex.Set(name, nodes);
+		}
+		nodes->Add(node);
+	}
+
+	m_nameIndexBuilt = true;
+}
+
+bool XmlDocument::TryGetIndexed( const String& name, uint32 hash, Vector<XmlNode *> *& nodes )
+{
+	if ( !m_useNameIndex )
+	{
+		return false;
+	}
+	if ( !m_nameIndexBuilt )
+	{
+		BuildNameIndex();
+	}
+
+	RefCountPtr<Vector<XmlNode *> > found;
+	nodes = m_nameIndex.TryGet(name, hash, found) ? found.Get() : NULL;
+	return true;
+}
+
+XmlNodeListPtr XmlDocument::GetElementsByTagName( const String& name )
+{
+	XmlNodeListPtr list(new XmlNodeList());
+	Vector<XmlNode *> *nodes;
+
+	if ( TryGetIndexed(name, (uint32)Math::Hash(name), nodes) )
+	{
+		for ( int x = 0; NULL != nodes && x < nodes->Count(); x++ )
+		{
+			list->Add(nodes->ElementAt(x)->m_self);
+		}
+		return list;
+	}
+
+	for ( XmlNode *node = NextInTree(this, this); NULL != node; node = NextInTree(node, this) )
+	{
+		if ( node->IsElement() && node->HasName(name) )
+		{
+			list->Add(node->m_self);
+		}
+	}
+	return list;
+}
+
 String XmlDocument::Name() const
 {
 	return String("#document");
@@ -170,6 +258,7 @@ void XmlDocument::CopyTo( XmlDocument& target ) const
 
 	target.m_tabsize = m_tabsize;
 	target.m_useMicrosoftBOM = m_useMicrosoftBOM;
+	target.m_useNameIndex = m_useNameIndex;
 
 	if (m_firstChild.IsNotNull())
 	{
@@ -221,6 +310,7 @@ XmlDocumentPtr  XmlDocument::ToDocument()    const
 void XmlDocument::ValidateMem() const
 {
 	XmlNode::ValidateMem();
+	m_nameIndex.ValidateMem();
 
 	XmlIterator iter(ToDocument());
 	while ( iter.Next() )
@@ -232,6 +322,7 @@ void XmlDocument::ValidateMem() const
 void XmlDocument::CheckMem() const
 {
 	XmlNode::CheckMem();
+	m_nameIndex.CheckMem();
 
 	XmlIterator iter(ToDocument());
 	while ( iter.Next() )
@@ -73,6 +73,11 @@ String XmlElement::Name() const
 	return m_name;
 }
 
+bool XmlElement::HasName( const String& name ) const
+{
+	return m_name.Length() == name.Length() && m_name.Equals(name);
+}
+
 XmlElementPtr XmlElement::ChildElement( int count )
 {
 	int i;
@@ -132,6 +137,8 @@ void XmlElement::SetAttribute( const String& cname, const String& cvalue )
 	{
 		throw new XmlException( _xmlErrorStrings[TIXML_ENCODING_UNKNOWN], 0, 0 );
 	}
+	XmlNodePtr xattrib = (XmlNodePtr)attrib;
+	attrib->m_self = xattrib;
 	m_attribs->Add( attrib );
 }
 
@@ -44,7 +44,7 @@ XmlNode::XmlNode( XmlNodeType _type )
 
 XmlNode::~XmlNode()
 {
-	Clear();
+	ClearChildren();
 	m_self.Clear();
 }
 
@@ -54,6 +54,12 @@ void XmlNode::CopyTo( XmlNode& target ) const
 }
 
 void XmlNode::Clear()
+{
+	TreeChanged();
+	ClearChildren();
+}
+
+void XmlNode::ClearChildren()
 {
 	XmlNodePtr node = m_firstChild;
 	XmlNodePtr temp;
@@ -61,7 +67,7 @@ void XmlNode::Clear()
 	while ( node.IsNotNull() )
 	{
 		temp = node->m_next;
-		node->Clear();
+		node->ClearChildren();
 		node = temp;
 	}
 
@@ -73,6 +79,24 @@ void XmlNode::Clear()
 	m_parent = NULL;
 }
 
+void XmlNode::TreeChanged()
+{
+	XmlNode *node = this;
+	while ( NULL != node->m_parent )
+	{
+		node = node->m_parent;
+	}
+	if ( node->IsDocument() )
+	{
+		static_cast<XmlDocument *>(node)->InvalidateNameIndex();
+	}
+}
+
+bool XmlNode::HasName( const String& name ) const
+{
+	return Name().Equals(name);
+}
+
 XmlNodeListPtr XmlNode::ChildNodes() const
 {
 	XmlNodeListPtr nodes(new XmlNodeList());
@@ -119,6 +143,7 @@ void XmlNode::AppendChild( XmlNodePtr node )
 	}
 
 	m_lastChild = node;
+	TreeChanged();
 }
 
 void XmlNode::InsertBefore( XmlNodePtr beforeThis, XmlNodePtr addThis )
@@ -146,6 +171,7 @@ void XmlNode::InsertBefore( XmlNodePtr beforeThis, XmlNodePtr addThis )
 		m_firstChild = addThis;
 	}
 	beforeThis->m_prev = addThis;
+	TreeChanged();
 }
 
 void XmlNode::InsertAfter( XmlNodePtr afterThis, XmlNodePtr addThis )
@@ -173,6 +199,7 @@ void XmlNode::InsertAfter( XmlNodePtr afterThis, XmlNodePtr addThis )
 		m_lastChild = addThis;
 	}
 	afterThis->m_next = addThis;
+	TreeChanged();
 }
 
 void XmlNode::ReplaceChild( XmlNodePtr replaceThis, XmlNodePtr withThis )
@@ -206,6 +233,11 @@ void XmlNode::ReplaceChild( XmlNodePtr replaceThis, XmlNodePtr withThis )
 	}
 
 	withThis->m_parent = this;
+
+	replaceThis->m_next.Release();
+	replaceThis->m_prev.Release();
+	replaceThis->m_parent = NULL;
+	TreeChanged();
 }
 
 bool XmlNode::RemoveChild( XmlNodePtr removeThis )
@@ -235,6 +267,11 @@ bool XmlNode::RemoveChild( XmlNodePtr removeThis )
 		m_firstChild = removeThis->m_next;
 	}
 
+	removeThis->m_next.Release();
+	removeThis->m_prev.Release();
+	removeThis->m_parent = NULL;
+	TreeChanged();
+
 	return true;
 }
 
@@ -1101,6 +1101,8 @@ const char* XmlElement::_Parse( const char* p, XmlParsingData* data, XmlEncoding
 		{
 			// Try to read an attribute:
 			XmlAttributePtr attrib = XmlAttributePtr(new XmlAttribute());
+			XmlNodePtr xattrib = (XmlNodePtr)attrib;
+			attrib->m_self = xattrib;
 			XmlDocumentPtr document = GetDocument();
 			attrib->SetDocument( document );
 			pErr = p;
@@ -0,0 +1,676 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <string.h>
+
+#include <spl/Exception.h>
+#include <spl/text/StringBuffer.h>
+#include <spl/xml/XmlDocument.h>
+#include <spl/xml/XmlElement.h>
+#include <spl/xml/XmlReader.h>
+
+using namespace spl;
+
+static inline bool _IsXmlSpace(const char c)
+{
+	return ' ' == c || '\t' == c || '\n' == c || '\r' == c;
+}
+
+static inline bool _IsNameEnd(const char c)
+{
+	return _IsXmlSpace(c) || '/' == c || '>' == c || '=' == c || '?' == c;
+}
+
+static int _CountLines(const char *cp, int len)
+{
+	int lines = 0;
+	const char *end = cp + len;
+	while (NULL != (cp = (const char *)memchr(cp, '\n', end - cp)))
+	{
+		lines++;
+		cp++;
+	}
+	return lines;
+}
+
+static void _Grow(Array<char>& buf, int need)
+{
+	if (need <= buf.Length())
+	{
+		return;
+	}
+	int len = buf.Length() > 0 ? buf.Length() : 64;
+	while (len < need)
+	{
+		len *= 2;
+	}
+	Array<char> bigger(len);
+	memcpy(bigger.Data(), buf.Data(), buf.Length());
+	buf = bigger;
+}
+
+XmlReader::XmlReader(IStreamPtr stream, int bufferSize)
+:	m_stream(stream),
+	m_buf(bufferSize > 16 ? bufferSize : 16),
+	m_pos(0),
+	m_end(0),
+	m_eof(false),
+	m_scratch(),
+	m_scratchLen(0),
+	m_open(),
+	m_openLen(0),
+	m_openStarts(),
+	m_nodeType(NONE),
+	m_depth(0),
+	m_isEmpty(false),
+	m_tokStart(0),
+	m_tokLen(0),
+	m_attrs(),
+	m_line(1),
+	m_ignoreWhitespace(true)
+{
+	m_name.start = m_name.len = 0;
+	m_name.inScratch = false;
+	m_value = m_name;
+}
+
+XmlReader::~XmlReader()
+{
+}
+
+void XmlReader::Error(const char *msg) const
+{
+	throw new XmlException(msg, m_line, -1);
+}
+
+int XmlReader::Fill()
+{
+	if (m_eof)
+	{
+		return 0;
+	}
+	if (m_pos > 0)
+	{
+		memmove(m_buf.Data(), m_buf.Data() + m_pos, m_end - m_pos);
+		m_end -= m_pos;
+		m_pos = 0;
+	}
+	if (m_end == m_buf.Length())
+	{
+		// A single token bigger than the buffer.
+		Array<byte> bigger(m_buf.Length() * 2);
+		memcpy(bigger.Data(), m_buf.Data(), m_end);
+		m_buf = bigger;
+	}
+
+	int count = m_stream->Read(m_buf, m_end, m_buf.Length() - m_end);
+	if (count <= 0)
+	{
+		m_eof = true;
+		return 0;
+	}
+	m_end += count;
+	return count;
+}
+
+int XmlReader::Find(int from, const char *term, int termLen)
+{
+	while (true)
+	{
+		const char *buf = (const char *)m_buf.Data() + m_pos;
+		int avail = m_end - m_pos;
+		const char *cp = buf + from;
+		const char *last = buf + avail - termLen;
+		while (cp <= last && NULL != (cp = (const char *)memchr(cp, term[0], last - cp + 1)))
+		{
+			if (0 == memcmp(cp, term, termLen))
+			{
+				return (int)(cp - buf);
+			}
+			cp++;
+		}
+		// The terminator may straddle what has been read so far.
+		if (avail - termLen + 1 > from)
+		{
+			from = avail - termLen + 1;
+		}
+		if (0 == Fill())
+		{
+			return -1;
+		}
+	}
+}
+
+void XmlReader::Decode(int start, int len, XmlReaderSlice& slice)
+{
+	const char *cp = (const char *)m_buf.Data() + start;
+	const char *amp = (const char *)memchr(cp, '&', len);
+	if (NULL == amp)
+	{
+		slice.start = start;
+		slice.len = len;
+		slice.inScratch = false;
+		return;
+	}
+
+	// Expanding never lengthens the text.
+	_Grow(m_scratch, m_scratchLen + len);
+	char *out = m_scratch.Data() + m_scratchLen;
+	char *outStart = out;
+	const char *end = cp + len;
+	memcpy(out, cp, amp - cp);
+	out += amp - cp;
+	cp = amp;
+
+	while (cp < end)
+	{
+		if ('&' != *cp)
+		{
+			*out++ = *cp++;
+			continue;
+		}
+		const char *semi = (const char *)memchr(cp, ';', end - cp);
+		int nameLen = NULL == semi ? 0 : (int)(semi - cp) - 1;
+		const char *name = cp + 1;
+		if (nameLen > 1 && '#' == name[0])
+		{
+			uint32 code = 0;
+			bool hex = 'x' == name[1];
+			for (int x = hex ? 2 : 1; x < nameLen; x++)
+			{
+				char c = name[x];
+				int digit = (c >= '0' && c <= '9') ? c - '0' : (hex && c >= 'a' && c <= 'f') ? c - 'a' + 10 : (hex && c >= 'A' && c <= 'F') ? c - 'A' + 10 : -1;
+				if (digit < 0)
+				{
+					Error("Invalid character reference");
+				}
+				code = code * (hex ? 16 : 10) + digit;
+				if (code > 0x10FFFF)
+				{
+					Error("Invalid character reference");
+				}
+			}
+			if (0 == code)
+			{
+				Error("Invalid character reference");
+			}
+			// UTF-8; "&#N;" is never shorter than the bytes it encodes.
+			if (code < 0x80)
+			{
+				*out++ = (char)code;
+			}
+			else if (code < 0x800)
+			{
+				*out++ = (char)(0xC0 | (code >> 6));
+				*out++ = (char)(0x80 | (code & 0x3F));
+			}
+			else if (code < 0x10000)
+			{
+				*out++ = (char)(0xE0 | (code >> 12));
+				*out++ = (char)(0x80 | ((code >> 6) & 0x3F));
+				*out++ = (char)(0x80 | (code & 0x3F));
+			}
+			else
+			{
+				*out++ = (char)(0xF0 | (code >> 18));
+				*out++ = (char)(0x80 | ((code >> 12) & 0x3F));
+				*out++ = (char)(0x80 | ((code >> 6) & 0x3F));
+				*out++ = (char)(0x80 | (code & 0x3F));
+			}
+			cp = semi + 1;
+		}
+		else if (2 == nameLen && 0 == memcmp(name, "lt", 2))
+		{
+			*out++ = '<';
+			cp = semi + 1;
+		}
+		else if (2 == nameLen && 0 == memcmp(name, "gt", 2))
+		{
+			*out++ = '>';
+			cp = semi + 1;
+		}
+		else if (3 == nameLen && 0 == memcmp(name, "amp", 3))
+		{
+			*out++ = '&';
+			cp = semi + 1;
+		}
+		else if (4 == nameLen && 0 == memcmp(name, "quot", 4))
+		{
+			*out++ = '"';
+			cp = semi + 1;
+		}
+		else if (4 == nameLen && 0 == memcmp(name, "apos", 4))
+		{
+			*out++ = '\'';
+			cp = semi + 1;
+		}
+		else
+		{
+			// Unknown entities are passed through, as TinyXml does.
+			*out++ = *cp++;
+		}
+	}
+
+	slice.start = m_scratchLen;
+	slice.len = (int)(out - outStart);
+	slice.inScratch = true;
+	m_scratchLen += slice.len;
+}
+
+void XmlReader::ParseAttributes(int pos, int end)
+{
+	const char *buf = (const char *)m_buf.Data();
+	while (true)
+	{
+		while (pos < end && _IsXmlSpace(buf[pos]))
+		{
+			pos++;
+		}
+		if (pos >= end)
+		{
+			return;
+		}
+
+		XmlReaderSlice name;
+		name.start = pos;
+		name.inScratch = false;
+		while (pos < end && !_IsNameEnd(buf[pos]))
+		{
+			pos++;
+		}
+		name.len = pos - name.start;
+		while (pos < end && _IsXmlSpace(buf[pos]))
+		{
+			pos++;
+		}
+		if (0 == name.len || pos >= end || '=' != buf[pos])
+		{
+			Error("Expected an attribute");
+		}
+		pos++;
+		while (pos < end && _IsXmlSpace(buf[pos]))
+		{
+			pos++;
+		}
+		if (pos >= end || ('"' != buf[pos] && '\'' != buf[pos]))
+		{
+			Error("Expected a quoted attribute value");
+		}
+		char quote = buf[pos++];
+		const char *close = (const char *)memchr(buf + pos, quote, end - pos);
+		if (NULL == close)
+		{
+			Error("Unterminated attribute value");
+		}
+
+		XmlReaderSlice value;
+		Decode(pos, (int)(close - buf) - pos, value);
+		m_attrs.Add(name);
+		m_attrs.Add(value);
+		pos = (int)(close - buf) + 1;
+	}
+}
+
+void XmlReader::ParseTag(int start, int end)
+{
+	const char *buf = (const char *)m_buf.Data();
+	int pos = start + 1;
+
+	m_isEmpty = '/' == buf[end - 1];
+	if (m_isEmpty)
+	{
+		end--;
+	}
+
+	m_name.start = pos;
+	while (pos < end && !_IsNameEnd(buf[pos]))
+	{
+		pos++;
+	}
+	m_name.len = pos - m_name.start;
+	if (0 == m_name.len)
+	{
+		Error("Expected an element name");
+	}
+	ParseAttributes(pos, end);
+}
+
+void XmlReader::Push(int start, int len)
+{
+	_Grow(m_open, m_openLen + len);
+	memcpy(m_open.Data() + m_openLen, m_buf.Data() + start, len);
+	m_openStarts.Add(m_openLen);
+	m_openLen += len;
+}
+
+bool XmlReader::Read()
+{
+	m_scratchLen = 0;
+	m_attrs.Clear();
+	m_isEmpty = false;
+	m_name.start = m_name.len = 0;
+	m_name.inScratch = false;
+	m_value = m_name;
+
+	while (true)
+	{
+		if (m_pos == m_end && 0 == Fill())
+		{
+			if (m_openStarts.Count() > 0)
+			{
+				Error("Unexpected end of input");
+			}
+			m_nodeType = NONE;
+			m_depth = 0;
+			m_tokLen = 0;
+			return false;
+		}
+
+		const char *buf = (const char *)m_buf.Data();
+		int len;
+
+		if ('<' != buf[m_pos])
+		{
+			len = Find(0, "<", 1);
+			if (len < 0)
+			{
+				len = m_end - m_pos;
+			}
+			buf = (const char *)m_buf.Data();
+
+			m_tokStart = m_pos;
+			m_tokLen = len;
+			m_line += _CountLines(buf + m_pos, len);
+			m_pos += len;
+
+			if (m_ignoreWhitespace)
+			{
+				int x;
+				for (x = 0; x < len && _IsXmlSpace(buf[m_tokStart + x]); x++)
+				{
+				}
+				if (x == len)
+				{
+					continue;
+				}
+			}
+			m_nodeType = TEXT;
+			m_depth = m_openStarts.Count();
+			Decode(m_tokStart, len, m_value);
+			return true;
+		}
+
+		// Enough to tell the kind of markup.
+		while (m_end - m_pos < 9 && 0 != Fill())
+		{
+		}
+		buf = (const char *)m_buf.Data();
+		int avail = m_end - m_pos;
+
+		if (avail >= 4 && 0 == memcmp(buf + m_pos, "<!--", 4))
+		{
+			int close = Find(4, "-->", 3);
+			if (close < 0)
+			{
+				Error("Unterminated comment");
+			}
+			m_nodeType = COMMENT;
+			m_value.start = m_pos + 4;
+			m_value.len = close - 4;
+			len = close + 3;
+		}
+		else if (avail >= 9 && 0 == memcmp(buf + m_pos, "<![CDATA[", 9))
+		{
+			int close = Find(9, "]]>", 3);
+			if (close < 0)
+			{
+				Error("Unterminated CDATA");
+			}
+			m_nodeType = CDATA;
+			m_value.start = m_pos + 9;
+			m_value.len = close - 9;
+			len = close + 3;
+		}
+		else if (avail >= 2 && '?' == buf[m_pos + 1])
+		{
+			int close = Find(2, "?>", 2);
+			if (close < 0)
+			{
+				Error("Unterminated processing instruction");
+			}
+			buf = (const char *)m_buf.Data();
+			int pos = m_pos + 2;
+			m_name.start = pos;
+			while (pos < m_pos + close && !_IsNameEnd(buf[pos]))
+			{
+				pos++;
+			}
+			m_name.len = pos - m_name.start;
+			if (3 == m_name.len && 0 == memcmp(buf + m_name.start, "xml", 3))
+			{
+				m_nodeType = DECLARATION;
+				ParseAttributes(pos, m_pos + close);
+			}
+			else
+			{
+				m_nodeType = PROCESSING_INSTRUCTION;
+				while (pos < m_pos + close && _IsXmlSpace(buf[pos]))
+				{
+					pos++;
+				}
+				m_value.start = pos;
+				m_value.len = m_pos + close - pos;
+			}
+			len = close + 2;
+		}
+		else if (avail >= 2 && '!' == buf[m_pos + 1])
+		{
+			// DOCTYPE and the like; an internal subset ends at "]" then ">".
+			int close = Find(2, ">", 1);
+			if (close >= 0)
+			{
+				const char *bracket = (const char *)memchr(m_buf.Data() + m_pos, '[', close);
+				if (NULL != bracket)
+				{
+					int subset = Find((int)(bracket - (const char *)m_buf.Data()) - m_pos, "]", 1);
+					close = subset < 0 ? -1 : Find(subset, ">", 1);
+				}
+			}
+			if (close < 0)
+			{
+				Error("Unterminated declaration");
+			}
+			buf = (const char *)m_buf.Data();
+			m_line += _CountLines(buf + m_pos, close + 1);
+			m_pos += close + 1;
+			continue;
+		}
+		else if (avail >= 2 && '/' == buf[m_pos + 1])
+		{
+			int close = Find(2, ">", 1);
+			if (close < 0)
+			{
+				Error("Unterminated end tag");
+			}
+			buf = (const char *)m_buf.Data();
+			int pos = m_pos + 2;
+			m_name.start = pos;
+			while (pos < m_pos + close && !_IsNameEnd(buf[pos]))
+			{
+				pos++;
+			}
+			m_name.len = pos - m_name.start;
+
+			if (0 == m_openStarts.Count())
+			{
+				Error("End tag without a start tag");
+			}
+			int openStart = m_openStarts.Peek();
+			if (m_openLen - openStart != m_name.len || 0 != memcmp(m_open.Data() + openStart, buf + m_name.start, m_name.len))
+			{
+				Error("End tag doesn't match the start tag");
+			}
+			m_openLen = m_openStarts.Pop();
+
+			m_nodeType = END_ELEMENT;
+			len = close + 1;
+		}
+		else
+		{
+			// A start tag ends at the first '>' outside a quoted value.
+			int x = 1;
+			char quote = 0;
+			while (true)
+			{
+				if (m_pos + x >= m_end)
+				{
+					if (0 == Fill())
+					{
+						Error("Unterminated start tag");
+					}
+					continue;
+				}
+				char c = (char)m_buf.Data()[m_pos + x];
+				if (0 != quote)
+				{
+					if (c == quote)
+					{
+						quote = 0;
+					}
+				}
+				else if ('"' == c || '\'' == c)
+				{
+					quote = c;
+				}
+				else if ('>' == c)
+				{
+					break;
+				}
+				x++;
+			}
+			ParseTag(m_pos, m_pos + x);
+			m_nodeType = ELEMENT;
+			len = x + 1;
+		}
+
+		m_depth = m_openStarts.Count();
+		if (ELEMENT == m_nodeType && !m_isEmpty)
+		{
+			Push(m_name.start, m_name.len);
+		}
+		m_tokStart = m_pos;
+		m_tokLen = len;
+		m_line += _CountLines((const char *)m_buf.Data() + m_pos, len);
+		m_pos += len;
+		return true;
+	}
+}
+
+void XmlReader::Skip()
+{
+	if (ELEMENT != m_nodeType || m_isEmpty)
+	{
+		return;
+	}
+	int depth = m_depth;
+	while (Read())
+	{
+		if (END_ELEMENT == m_nodeType && depth == m_depth)
+		{
+			return;
+		}
+	}
+}
+
+XmlElementPtr XmlReader::ReadSubtree()
+{
+	if (ELEMENT != m_nodeType)
+	{
+		throw new InvalidArgumentException("XmlReader is not on an element");
+	}
+
+	StringBuffer xml(m_tokLen + 1);
+	xml.Append((const char *)m_buf.Data() + m_tokStart, m_tokLen);
+
+	if (!m_isEmpty)
+	{
+		int depth = m_depth;
+		bool ignore = m_ignoreWhitespace;
+		m_ignoreWhitespace = false;
+		try
+		{
+			while (Read())
+			{
+				xml.Append((const char *)m_buf.Data() + m_tokStart, m_tokLen);
+				if (END_ELEMENT == m_nodeType && depth == m_depth)
+				{
+					break;
+				}
+			}
+		}
+		catch (Exception *)
+		{
+			m_ignoreWhitespace = ignore;
+			throw;
+		}
+		m_ignoreWhitespace = ignore;
+	}
+
+	// Detached, since the document clears its children when it goes.
+	XmlDocumentPtr doc = XmlDocument::ParseXml(*xml.ToString());
+	XmlElementPtr element = doc->RootElement();
+	doc->RemoveChild(element);
+	return element;
+}
+
+bool XmlReader::TryGetAttribute(const char *name, StringView& value) const
+{
+	int len = (int)strlen(name);
+	int count = m_attrs.Count();
+	for (int x = 0; x < count; x += 2)
+	{
+		const XmlReaderSlice& s = m_attrs.ElementAtRef(x);
+		if (s.len == len && 0 == memcmp(Chars(s), name, len))
+		{
+			const XmlReaderSlice& v = m_attrs.ElementAtRef(x + 1);
+			value = StringView(Chars(v), v.len);
+			return true;
+		}
+	}
+	return false;
+}
+
+#if defined(DEBUG)
+void XmlReader::CheckMem() const
+{
+	m_stream.CheckMem();
+	m_buf.CheckMem();
+	m_scratch.CheckMem();
+	m_open.CheckMem();
+	m_openStarts.CheckMem();
+	m_attrs.CheckMem();
+}
+
+void XmlReader::ValidateMem() const
+{
+	m_stream.ValidateMem();
+	m_buf.ValidateMem();
+	m_scratch.ValidateMem();
+	m_open.ValidateMem();
+	m_openStarts.ValidateMem();
+	m_attrs.ValidateMem();
+}
+#endif
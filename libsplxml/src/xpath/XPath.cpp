@@ -20,19 +20,20 @@
 using namespace spl;
 
 XPath::XPath()
-: m_ops()
+: m_ops(), m_plan(new XPathPlan())
 {
 }
 
 XPath::XPath(const String& xp)
-: m_ops()
+: m_ops(), m_plan()
 {
 	XPathParser parser;
 	m_ops = parser.Parse(xp);
+	m_plan = XPathPlan::Compile(m_ops);
 }
 
 XPath::XPath(const XPath& xp)
-: m_ops(xp.m_ops)
+: m_ops(xp.m_ops), m_plan(xp.m_plan)
 {
 }
 
@@ -43,22 +44,28 @@ XPath::~XPath()
 XPath& XPath::operator =(const XPath& xp)
 {
 	m_ops = xp.m_ops;
+	m_plan = xp.m_plan;
 	return *this;
 }
 
 XmlNodeListPtr XPath::SelectNodes(XmlNodePtr context)
 {
-	return SelectNodes(context, true);
+	XmlNodeListPtr nodes(new XmlNodeList());
+	for (XPathIterator iter(m_plan, context); iter.Next(); )
+	{
+		nodes->Add(iter.CurrentRef());
+	}
+	return nodes;
 }
 
 XmlNodePtr XPath::SelectSingleNode(XmlNodePtr context)
 {
-	XmlNodeListPtr nodes = SelectNodes(context, false);
-	if (nodes->Count() == 0)
+	XPathIterator iter(m_plan, context);
+	if (iter.Next())
 	{
-		return XmlNodePtr();
+		return iter.Current();
 	}
-	return nodes->Item(0);
+	return XmlNodePtr();
 }
 
 XmlNodeListPtr XPath::SelectNodes(Array<XPathOperatorPtr>&ops, XmlNodePtr context)
@@ -94,10 +101,12 @@ XmlNodeListPtr XPath::SelectNodes(Array<XPathOperatorPtr>&ops, XmlNodePtr contex
 void XPath::CheckMem() const
 {
 	m_ops.CheckMem();
+	m_plan.CheckMem();
 }
 
 void XPath::ValidateMem() const
 {
 	m_ops.ValidateMem();
+	m_plan.ValidateMem();
 }
 #endif
@@ -0,0 +1,307 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <spl/Exception.h>
+#include <spl/xml/XmlAttributeCollection.h>
+#include <spl/xml/XmlDocument.h>
+#include <spl/xml/XmlElement.h>
+#include <spl/xml/xpath/XPathIterator.h>
+#include <spl/xml/xpath/private/XPathOpPredicate.h>
+
+using namespace spl;
+
+XPathIterator::XPathIterator(XPathPlanPtr plan, XmlNodePtr context)
+: m_plan(plan), m_context(context), m_stack(), m_current()
+{
+	Push(0, context.Get());
+}
+
+XPathIterator::XPathIterator(XPathPlanPtr plan, XmlNode *context)
+: m_plan(plan), m_context(), m_stack(), m_current()
+{
+	Push(0, context);
+}
+
+XPathIterator::XPathIterator(const XPathIterator& iter)
+: m_plan(iter.m_plan), m_context(iter.m_context), m_stack(iter.m_stack), m_current(iter.m_current)
+{
+}
+
+XPathIterator::~XPathIterator()
+{
+}
+
+XPathIterator& XPathIterator::operator =(const XPathIterator& iter)
+{
+	m_plan = iter.m_plan;
+	m_context = iter.m_context;
+	m_stack = iter.m_stack;
+	m_current = iter.m_current;
+	return *this;
+}
+
+void XPathIterator::Push(int step, XmlNode *input)
+{
+	XPathFrame frame;
+	frame.step = step;
+	frame.input = input;
+	frame.cur = NULL;
+	frame.pos = 0;
+	frame.indexed = NULL;
+	frame.inScope = false;
+	m_stack.Add(frame);
+}
+
+bool XPathIterator::Next()
+{
+	XmlNode *node = NextNode();
+	if (NULL == node)
+	{
+		m_current.Release();
+		return false;
+	}
+	m_current = node->m_self;
+	return true;
+}
+
+bool XPathIterator::Prev()
+{
+	throw new NotImplementedException();
+}
+
+XmlNodePtr XPathIterator::Current()
+{
+	return m_current;
+}
+
+XmlNodePtr& XPathIterator::CurrentRef()
+{
+	return m_current;
+}
+
+XmlNode *XPathIterator::NextNode()
+{
+	int last = m_plan->Count() - 1;
+
+	while (m_stack.Count() > 0)
+	{
+		XPathFrame& frame = m_stack.PeekRef();
+		XmlNode *node = Advance(frame);
+		if (NULL == node)
+		{
+			m_stack.Pop();
+			continue;
+		}
+		if (frame.step >= last)
+		{
+			return node;
+		}
+		Push(frame.step + 1, node);
+	}
+	return NULL;
+}
+
+XmlNode *XPathIterator::Advance(XPathFrame& frame)
+{
+	if (frame.step >= m_plan->Count())
+	{
+		// An empty XPath selects the context.
+		return 0 == frame.pos++ ? frame.input : NULL;
+	}
+
+	const XPathStep& step = m_plan->Step(frame.step);
+	XmlNode *node;
+
+	switch (step.kind)
+	{
+	case XPathStep::XPS_ROOT:
+		return 0 == frame.pos++ && NULL == frame.input->m_parent ? frame.input : NULL;
+
+	case XPathStep::XPS_NAMED:
+		return 0 == frame.pos++ && frame.input->HasName(step.name) ? frame.input : NULL;
+
+	case XPathStep::XPS_PREDICATE:
+		return 0 == frame.pos++ && Test(step, frame.input) ? frame.input : NULL;
+
+	case XPathStep::XPS_CHILDREN:
+		node = 0 == frame.pos++ ? frame.input->m_firstChild.Get() : frame.cur->m_next.Get();
+		if (step.name.Length() > 0)
+		{
+			while (NULL != node && !node->HasName(step.name))
+			{
+				node = node->m_next.Get();
+			}
+		}
+		return frame.cur = node;
+
+	case XPathStep::XPS_DESCENDANTS:
+		return AdvanceDescendants(frame, step);
+
+	case XPathStep::XPS_ATTRIBUTES:
+		{
+			if (!frame.input->IsElement())
+			{
+				return NULL;
+			}
+			XmlAttributeCollectionPtr attribs = static_cast<XmlElement *>(frame.input)->Attributes();
+			if (attribs.IsNull() || frame.pos >= attribs->Count())
+			{
+				return NULL;
+			}
+			return attribs->Item(frame.pos++).Get();
+		}
+
+	case XPathStep::XPS_ERROR:
+		throw new Exception(step.name.GetChars());
+
+	default:
+		return NULL;
+	}
+}
+
+XmlNode *XPathIterator::AdvanceDescendants(XPathFrame& frame, const XPathStep& step)
+{
+	XmlNode *node;
+
+	if (0 == frame.pos)
+	{
+		frame.pos = 1;
+
+		// The index only pays when most of the named elements are in scope, so
+		// it is used from the document or its top level elements.
+		XmlNode *doc = frame.input->IsDocument() ? frame.input : frame.input->m_parent;
+		bool indexable = step.name.Length() > 0 && '#' != step.name.CharAt(0) && NULL != doc && doc->IsDocument();
+
+		if (indexable && static_cast<XmlDocument *>(doc)->TryGetIndexed(step.name, step.hash, frame.indexed))
+		{
+			if (NULL == frame.indexed)
+			{
+				return NULL;
+			}
+			frame.inScope = doc != frame.input;
+		}
+		else
+		{
+			node = XmlNode::NextInTree(frame.input, frame.input);
+		}
+	}
+	else if (NULL == frame.indexed)
+	{
+		node = XmlNode::NextInTree(frame.cur, frame.input);
+	}
+
+	if (NULL != frame.indexed)
+	{
+		// pos is one past the next index.
+		while (frame.pos <= frame.indexed->Count())
+		{
+			node = frame.indexed->ElementAt(frame.pos++ - 1);
+			if (!frame.inScope)
+			{
+				return node;
+			}
+			for (XmlNode *parent = node->m_parent; NULL != parent; parent = parent->m_parent)
+			{
+				if (parent == frame.input)
+				{
+					return node;
+				}
+			}
+		}
+		return NULL;
+	}
+
+	if (step.name.Length() > 0)
+	{
+		while (NULL != node && !node->HasName(step.name))
+		{
+			node = XmlNode::NextInTree(node, frame.input);
+		}
+	}
+	return frame.cur = node;
+}
+
+bool XPathIterator::Test(const XPathStep& step, XmlNode *node)
+{
+	XPathIterator inner(step.predicate, node);
+	XmlNode *found;
+
+	while (NULL != (found = inner.NextNode()))
+	{
+		Variant value(*found->Value());
+
+		switch (step.binop)
+		{
+		case XPathOpPredicate::OP_EQ:
+			if (value == *step.arg)
+			{
+				return true;
+			}
+			break;
+		case XPathOpPredicate::OP_NEQ:
+			if (value != *step.arg)
+			{
+				return true;
+			}
+			break;
+		case XPathOpPredicate::OP_LT:
+			if (value < *step.arg)
+			{
+				return true;
+			}
+			break;
+		case XPathOpPredicate::OP_LTEQ:
+			if (value <= *step.arg)
+			{
+				return true;
+			}
+			break;
+		case XPathOpPredicate::OP_GT:
+			if (value > *step.arg)
+			{
+				return true;
+			}
+			break;
+		case XPathOpPredicate::OP_GTEQ:
+			if (value >= *step.arg)
+			{
+				return true;
+			}
+			break;
+		default:
+			throw new SyntaxException("Internal predicate operator error");
+		}
+	}
+	return false;
+}
+
+#if defined(DEBUG) || defined(_DEBUG)
+void XPathIterator::CheckMem() const
+{
+	m_plan.CheckMem();
+	m_context.CheckMem();
+	m_stack.CheckMem();
+	m_current.CheckMem();
+}
+
+void XPathIterator::ValidateMem() const
+{
+	m_plan.ValidateMem();
+	m_context.ValidateMem();
+	m_stack.ValidateMem();
+	m_current.ValidateMem();
+}
+#endif
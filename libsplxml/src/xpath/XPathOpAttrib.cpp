@@ -1,6 +1,7 @@
 #include <spl/xml/xpath/private/XPathOpAttrib.h>
 #include <spl/xml/XmlElement.h>
 #include <spl/xml/XmlNode.h>
+#include <spl/xml/xpath/private/XPathPlan.h>
 
 using namespace spl;
 
@@ -43,6 +44,11 @@ XmlNodeListPtr XPathOpAttrib::NextContext(XmlNodePtr context)
 	return nodes;
 }
 
+void XPathOpAttrib::Compile(XPathPlan& plan)
+{
+	plan.Add(XPathStep(XPathStep::XPS_ATTRIBUTES));
+}
+
 #if defined(DEBUG) || defined(_DEBUG)
 void XPathOpAttrib::CheckMem() const
 {
@@ -1,4 +1,5 @@
 #include <spl/xml/xpath/private/XPathOpChildTree.h>
+#include <spl/xml/xpath/private/XPathPlan.h>
 
 using namespace spl;
 
@@ -38,6 +39,11 @@ XmlNodeListPtr XPathOpChildTree::NextContext(XmlNodePtr context)
 	return nodes;
 }
 
+void XPathOpChildTree::Compile(XPathPlan& plan)
+{
+	plan.Add(XPathStep(XPathStep::XPS_DESCENDANTS));
+}
+
 #if defined(DEBUG) || defined(_DEBUG)
 void XPathOpChildTree::CheckMem() const
 {
@@ -1,4 +1,5 @@
 #include <spl/xml/xpath/private/XPathOpChildern.h>
+#include <spl/xml/xpath/private/XPathPlan.h>
 
 using namespace spl;
 
@@ -55,6 +56,11 @@ XmlNodeListPtr XPathOpChildern::NextContext(XmlNodePtr context)
 	return nodes;
 }
 
+void XPathOpChildern::Compile(XPathPlan& plan)
+{
+	plan.Add(XPathStep(XPathStep::XPS_CHILDREN, m_name));
+}
+
 #if defined(DEBUG) || defined(_DEBUG)
 void XPathOpChildern::CheckMem() const
 {
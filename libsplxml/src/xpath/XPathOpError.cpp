@@ -1,4 +1,5 @@
 #include <spl/xml/xpath/private/XPathOpError.h>
+#include <spl/xml/xpath/private/XPathPlan.h>
 
 using namespace spl;
 
@@ -37,6 +38,11 @@ XmlNodeListPtr XPathOpError::NextContext(XmlNodePtr context)
 	throw new Exception(m_msg);
 }
 
+void XPathOpError::Compile(XPathPlan& plan)
+{
+	plan.Add(XPathStep(XPathStep::XPS_ERROR, m_msg));
+}
+
 #if defined(DEBUG) || defined(_DEBUG)
 void XPathOpError::CheckMem() const
 {
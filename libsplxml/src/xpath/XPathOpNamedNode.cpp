@@ -1,4 +1,5 @@
 #include <spl/xml/xpath/private/XPathOpNamedNode.h>
+#include <spl/xml/xpath/private/XPathPlan.h>
 
 using namespace spl;
 
@@ -36,6 +37,11 @@ XmlNodeListPtr XPathOpNamedNode::NextContext(XmlNodePtr context)
 	return nodes;
 }
 
+void XPathOpNamedNode::Compile(XPathPlan& plan)
+{
+	plan.Add(XPathStep(XPathStep::XPS_NAMED, m_nodeName));
+}
+
 #if defined(DEBUG) || defined(_DEBUG)
 void XPathOpNamedNode::CheckMem() const
 {
@@ -1,5 +1,6 @@
 #include <spl/xml/xpath/private/XPathOpPredicate.h>
 #include <spl/xml/xpath/XPath.h>
+#include <spl/xml/xpath/private/XPathPlan.h>
 
 using namespace spl;
 
@@ -9,7 +10,7 @@ XPathOpPredicate::XPathOpPredicate()
 }
 
 XPathOpPredicate::XPathOpPredicate(const XPathOpPredicate& op)
-: XPathOperator(op), m_ops(op.m_ops), m_binop(OP_ERROR), m_arg(new Variant())
+: XPathOperator(op), m_ops(op.m_ops), m_binop(op.m_binop), m_arg(op.m_arg)
 {
 }
 
@@ -93,6 +94,19 @@ XmlNodeListPtr XPathOpPredicate::NextContext(XmlNodePtr context)
 	return matchNodes;
 }
 
+void XPathOpPredicate::Compile(XPathPlan& plan)
+{
+	XPathStep step(XPathStep::XPS_PREDICATE);
+	step.predicate = XPathPlanPtr(new XPathPlan());
+	for (int x = 0; x < m_ops.Count(); x++)
+	{
+		m_ops.ElementAt(x)->Compile(*step.predicate);
+	}
+	step.binop = m_binop;
+	step.arg = m_arg;
+	plan.Add(step);
+}
+
 #if defined(DEBUG) || defined(_DEBUG)
 void XPathOpPredicate::CheckMem() const
 {
@@ -1,4 +1,5 @@
 #include <spl/xml/xpath/private/XPathOpRoot.h>
+#include <spl/xml/xpath/private/XPathPlan.h>
 
 using namespace spl;
 
@@ -33,6 +34,11 @@ XmlNodeListPtr XPathOpRoot::NextContext(XmlNodePtr context)
 	return nodes;
 }
 
+void XPathOpRoot::Compile(XPathPlan& plan)
+{
+	plan.Add(XPathStep(XPathStep::XPS_ROOT));
+}
+
 #if defined(DEBUG) || defined(_DEBUG)
 void XPathOpRoot::CheckMem() const
 {
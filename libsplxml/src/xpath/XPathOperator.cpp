@@ -1,4 +1,5 @@
 #include <spl/xml/xpath/private/XPathOperator.h>
+#include <spl/xml/xpath/private/XPathPlan.h>
 
 using namespace spl;
 
@@ -29,6 +30,11 @@ XmlNodeListPtr XPathOperator::NextContext(XmlNodePtr context)
 	return XmlNodeListPtr();
 }
 
+void XPathOperator::Compile(XPathPlan& plan)
+{
+	plan.Add(XPathStep(XPathStep::XPS_NONE));
+}
+
 #if defined(DEBUG) || defined(_DEBUG)
 void XPathOperator::CheckMem() const
 {
@@ -0,0 +1,102 @@
+#include <spl/math/Math.h>
+#include <spl/xml/xpath/private/XPathPlan.h>
+
+using namespace spl;
+
+XPathStep::XPathStep()
+: kind(XPS_NONE), name(), hash(0), predicate(), binop(0), arg()
+{
+}
+
+XPathStep::XPathStep(Kind k)
+: kind(k), name(), hash(0), predicate(), binop(0), arg()
+{
+}
+
+XPathStep::XPathStep(Kind k, const String& n)
+: kind(k), name(n), hash((uint32)Math::Hash(n)), predicate(), binop(0), arg()
+{
+}
+
+XPathStep::XPathStep(const XPathStep& step)
+: kind(step.kind), name(step.name), hash(step.hash), predicate(step.predicate), binop(step.binop), arg(step.arg)
+{
+}
+
+XPathStep::~XPathStep()
+{
+}
+
+XPathStep& XPathStep::operator =(const XPathStep& step)
+{
+	kind = step.kind;
+	name = step.name;
+	hash = step.hash;
+	predicate = step.predicate;
+	binop = step.binop;
+	arg = step.arg;
+	return *this;
+}
+
+#if defined(DEBUG) || defined(_DEBUG)
+void XPathStep::CheckMem() const
+{
+	name.CheckMem();
+	predicate.CheckMem();
+	arg.CheckMem();
+}
+
+void XPathStep::ValidateMem() const
+{
+	name.ValidateMem();
+	predicate.ValidateMem();
+	arg.ValidateMem();
+}
+#endif
+
+XPathPlan::XPathPlan()
+: m_steps()
+{
+}
+
+XPathPlan::~XPathPlan()
+{
+}
+
+XPathPlanPtr XPathPlan::Compile(Array<XPathOperatorPtr>& ops)
+{
+	XPathPlanPtr plan(new XPathPlan());
+	for (int x = 0; x < ops.Length(); x++)
+	{
+		ops[x]->Compile(*plan);
+	}
+	return plan;
+}
+
+void XPathPlan::Add(const XPathStep& step)
+{
+	int count = m_steps.Count();
+	if (XPathStep::XPS_NAMED == step.kind && count > 0)
+	{
+		XPathStep& last = m_steps.ElementAtRef(count - 1);
+		if ((XPathStep::XPS_CHILDREN == last.kind || XPathStep::XPS_DESCENDANTS == last.kind) && 0 == last.name.Length())
+		{
+			last.name = step.name;
+			last.hash = step.hash;
+			return;
+		}
+	}
+	m_steps.Add(step);
+}
+
+#if defined(DEBUG) || defined(_DEBUG)
+void XPathPlan::CheckMem() const
+{
+	m_steps.CheckMem();
+}
+
+void XPathPlan::ValidateMem() const
+{
+	m_steps.ValidateMem();
+}
+#endif
@@ -24,11 +24,23 @@
 
 using namespace spl;
 
+extern void _TestXmlReader();
+extern void _TestXPath();
+
 int main(int argc, char **argv)
 {
 	try
 	{
-		TestHarness::RunTests();
+		_TestXmlReader();
+		DEBUG_CLEAR_MEM_CHECK_POINTS();
+		DEBUG_DUMP_MEM_LEAKS();
+		DEBUG_FREE_HEAP();
+
+		_TestXPath();
+		DEBUG_CLEAR_MEM_CHECK_POINTS();
+		DEBUG_DUMP_MEM_LEAKS();
+		DEBUG_FREE_HEAP();
+
 		Log::SWriteEndOfRunTotal();
 		
 		ASSERT_MEM_FREE();
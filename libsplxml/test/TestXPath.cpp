@@ -19,6 +19,8 @@
 #include <spl/xml/XmlElement.h>
 #include <spl/xml/XmlDocument.h>
 #include <spl/xml/xpath/XPath.h>
+#include <spl/xml/xpath/XPathIterator.h>
+#include <spl/xml/xpath/private/XPathParser.h>
 
 using namespace spl;
 
@@ -250,6 +252,135 @@ static void _TestXPathPredicate()
 	Log::SWriteOkFail( "XPath /bookstore/book[@category = 'WEB']" );
 }
 
+static bool _SameNodes(XmlNodeListPtr a, XmlNodeListPtr b)
+{
+	if (a->Count() != b->Count())
+	{
+		return false;
+	}
+	for (int x = 0; x < a->Count(); x++)
+	{
+		int y;
+		for (y = 0; y < b->Count(); y++)
+		{
+			if (a->Item(x).Get() == b->Item(y).Get())
+			{
+				break;
+			}
+		}
+		if (y == b->Count())
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+static void _TestXPathCompiled()
+{
+	const char *exprs[] = 
+	{
+		"/", "/bookstore", "bookstore", "/bookstore/book", "/bookstore/*", "/bookstore//price", 
+		"//title", "//title@lang", "/bookstore/book/title@lang", "/bookstore/@", 
+		"/bookstore/book[@category = 'WEB']", "/bookstore/book[@category != 'WEB']//author", "//nothing", NULL
+	};
+
+	{
+		XmlDocumentPtr doc = XmlDocument::ParseXml(_xpathTestXml);
+		XPathParser parser;
+
+		// The compiled plan selects the same nodes as the operators.
+		for (int x = 0; NULL != exprs[x]; x++)
+		{
+			Array<XPathOperatorPtr> ops = parser.Parse(exprs[x]);
+			XmlNodeListPtr expected = XPath::SelectNodes(ops, doc);
+			XmlNodeListPtr nodes = XPath(exprs[x]).SelectNodes(doc);
+			UNIT_ASSERT(exprs[x], _SameNodes(expected, nodes));
+		}
+
+		XPath xpath("//author");
+		XmlNodeListPtr authors = xpath.SelectNodes(doc);
+		UNIT_ASSERT("authors", 8 == authors->Count());
+		UNIT_ASSERT("document order", authors->Item(0)->InnerText()->Equals("Giada De Laurentiis"));
+		UNIT_ASSERT("document order", authors->Item(7)->InnerText()->Equals("Erik T. Ray"));
+
+		XPathIterator iter(xpath.Select(doc));
+		UNIT_ASSERT("iter 1", iter.Next() && iter.Current().Get() == authors->Item(0).Get());
+		UNIT_ASSERT("iter 2", iter.Next() && iter.Current().Get() == authors->Item(1).Get());
+		UNIT_ASSERT("single", xpath.SelectSingleNode(doc).Get() == authors->Item(0).Get());
+
+		// Relative to an element.
+		XmlNodePtr book = XPath("/bookstore/book[@category = 'WEB']").SelectSingleNode(doc);
+		UNIT_ASSERT("web book", book->ToElement()->Attribute("category")->Value()->Equals("WEB"));
+		UNIT_ASSERT("book authors", 5 == XPath("//author").SelectNodes(book)->Count());
+		
+		DEBUG_CLEAR_MEM_CHECK_POINTS();
+		doc.CheckMem();
+		parser.CheckMem();
+		xpath.CheckMem();
+		authors.CheckMem();
+		iter.CheckMem();
+		book.CheckMem();
+		DEBUG_DUMP_MEM_LEAKS();
+		UNIT_ASSERT_MEM_NOTED("XPath compiled 1");
+	}
+
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
+	UNIT_ASSERT_MEM_NOTED("XPath compiled 2");
+	Log::SWriteOkFail( "XPath compiled" );
+}
+
+static void _TestXPathNameIndex()
+{
+	{
+		XmlDocumentPtr doc = XmlDocument::ParseXml(_xpathTestXml);
+		doc->SetUseNameIndex(true);
+
+		XPath prices("//price");
+		XPath bookPrices("/bookstore//price");
+		UNIT_ASSERT("//price", 4 == prices.SelectNodes(doc)->Count());
+		UNIT_ASSERT("/bookstore//price", 4 == bookPrices.SelectNodes(doc)->Count());
+		UNIT_ASSERT("first price", prices.SelectSingleNode(doc)->InnerText()->Equals("30.00"));
+		UNIT_ASSERT("by tag name", 8 == doc->GetElementsByTagName("author")->Count());
+		UNIT_ASSERT("no such tag", 0 == doc->GetElementsByTagName("nothing")->Count());
+
+		// Indexed from a top level element, but not from deeper ones.
+		XmlNodePtr book = XPath("/bookstore/book").SelectSingleNode(doc);
+		UNIT_ASSERT("book price", 1 == prices.SelectNodes(book)->Count());
+
+		// Changes to the tree drop the index.
+		XmlElementPtr extra = XmlElement::CreateElement("book");
+		XmlElementPtr price = XmlElement::CreateElement("price");
+		extra->AppendChild(price);
+		doc->RootElement()->AppendChild(extra);
+		UNIT_ASSERT("added price", 5 == prices.SelectNodes(doc)->Count());
+		UNIT_ASSERT("added price last", prices.SelectNodes(doc)->Item(4).Get() == price.Get());
+
+		doc->RootElement()->RemoveChild(book);
+		UNIT_ASSERT("removed book", 4 == bookPrices.SelectNodes(doc)->Count());
+		UNIT_ASSERT("removed book authors", 7 == doc->GetElementsByTagName("author")->Count());
+
+		doc->SetUseNameIndex(false);
+		UNIT_ASSERT("unindexed", 4 == prices.SelectNodes(doc)->Count());
+
+		book.Release();
+		DEBUG_CLEAR_MEM_CHECK_POINTS();
+		doc.CheckMem();
+		prices.CheckMem();
+		bookPrices.CheckMem();
+		extra.CheckMem();
+		price.CheckMem();
+		DEBUG_DUMP_MEM_LEAKS();
+		UNIT_ASSERT_MEM_NOTED("XPath name index 1");
+	}
+
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
+	UNIT_ASSERT_MEM_NOTED("XPath name index 2");
+	Log::SWriteOkFail( "XPath name index" );
+}
+
 void _TestXPath()
 {
 	_TestXPathRoot();
@@ -275,6 +406,14 @@ void _TestXPath()
 	_TestXPathPredicate();
 	DEBUG_CLEAR_MEM_CHECK_POINTS();
 	DEBUG_DUMP_MEM_LEAKS();
+	
+	_TestXPathCompiled();
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
+	
+	_TestXPathNameIndex();
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
 }
 
 #endif
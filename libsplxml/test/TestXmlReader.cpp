@@ -0,0 +1,238 @@
+/*
+ *   This file is part of the Standard Portable Library (SPL).
+ *
+ *   SPL is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   SPL is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with SPL.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <spl/Debug.h>
+#include <spl/Int32.h>
+#include <spl/io/log/Log.h>
+#include <spl/io/StringStream.h>
+#include <spl/text/StringBuffer.h>
+#include <spl/xml/XmlDocument.h>
+#include <spl/xml/XmlElement.h>
+#include <spl/xml/XmlReader.h>
+
+using namespace spl;
+
+#ifdef DEBUG
+
+static const char *_readerTestXml =
+	"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+	"<!DOCTYPE feed [ <!ELEMENT feed ANY> ]>\n"
+	"<!-- a & b -->\n"
+	"<feed xmlns=\"urn:x\" title='Tom &amp; Jerry'>\n"
+	"  <item id=\"1\" name=\"a &gt; b\">first &lt;item&gt; &#65;&#x42;</item>\n"
+	"  <item id=\"2\"><![CDATA[<raw> & stuff]]></item>\n"
+	"  <?render fast?>\n"
+	"  <empty attr = \"x\" />\n"
+	"</feed>\n";
+
+static void _ReadAll(int bufferSize, StringBuffer& out)
+{
+	XmlReader reader(StringStreamPtr(new StringStream(_readerTestXml)), bufferSize);
+	while (reader.Read())
+	{
+		out.Append(Int32::ToString(reader.NodeType()));
+		out.Append(':');
+		out.Append(Int32::ToString(reader.Depth()));
+		out.Append(':');
+		out.Append(reader.Name().GetChars(), reader.Name().Length());
+		out.Append(':');
+		out.Append(reader.Value().GetChars(), reader.Value().Length());
+		for (int x = 0; x < reader.AttributeCount(); x++)
+		{
+			out.Append(' ');
+			out.Append(reader.AttributeName(x).GetChars(), reader.AttributeName(x).Length());
+			out.Append('=');
+			out.Append(reader.AttributeValue(x).GetChars(), reader.AttributeValue(x).Length());
+		}
+		out.Append('\n');
+	}
+}
+
+static void _TestXmlReaderNodes()
+{
+	{
+		XmlReader reader(StringStreamPtr(new StringStream(_readerTestXml)));
+		StringView value;
+
+		UNIT_ASSERT("declaration", reader.Read() && XmlReader::DECLARATION == reader.NodeType());
+		UNIT_ASSERT("declaration version", reader.TryGetAttribute("version", value) && value.Equals("1.0"));
+		UNIT_ASSERT("comment", reader.Read() && XmlReader::COMMENT == reader.NodeType() && reader.Value().Equals(" a & b "));
+		UNIT_ASSERT("feed", reader.Read() && XmlReader::ELEMENT == reader.NodeType() && reader.Name().Equals("feed") && 0 == reader.Depth());
+		UNIT_ASSERT("feed title", reader.TryGetAttribute("title", value) && value.Equals("Tom & Jerry"));
+		UNIT_ASSERT("feed no such attribute", !reader.TryGetAttribute("tit", value));
+		UNIT_ASSERT("item", reader.Read() && XmlReader::ELEMENT == reader.NodeType() && reader.Name().Equals("item") && 1 == reader.Depth());
+		UNIT_ASSERT("item attributes", 2 == reader.AttributeCount() && reader.AttributeName(1).Equals("name") && reader.AttributeValue(1).Equals("a > b"));
+		UNIT_ASSERT("item text", reader.Read() && XmlReader::TEXT == reader.NodeType() && reader.Value().Equals("first <item> AB") && 2 == reader.Depth());
+		UNIT_ASSERT("item end", reader.Read() && XmlReader::END_ELEMENT == reader.NodeType() && reader.Name().Equals("item") && 1 == reader.Depth());
+		UNIT_ASSERT("item 2", reader.Read() && XmlReader::ELEMENT == reader.NodeType());
+		UNIT_ASSERT("cdata", reader.Read() && XmlReader::CDATA == reader.NodeType() && reader.Value().Equals("<raw> & stuff"));
+		UNIT_ASSERT("item 2 end", reader.Read() && XmlReader::END_ELEMENT == reader.NodeType());
+		UNIT_ASSERT("pi", reader.Read() && XmlReader::PROCESSING_INSTRUCTION == reader.NodeType() && reader.Name().Equals("render") && reader.Value().Equals("fast"));
+		UNIT_ASSERT("empty", reader.Read() && XmlReader::ELEMENT == reader.NodeType() && reader.IsEmptyElement() && reader.Name().Equals("empty"));
+		UNIT_ASSERT("empty attr", 1 == reader.AttributeCount() && reader.AttributeValue(0).Equals("x"));
+		UNIT_ASSERT("feed end", reader.Read() && XmlReader::END_ELEMENT == reader.NodeType() && 0 == reader.Depth());
+		UNIT_ASSERT("feed end line", 9 == reader.Line());
+		UNIT_ASSERT("end", !reader.Read() && XmlReader::NONE == reader.NodeType());
+		UNIT_ASSERT("still at end", !reader.Read());
+
+		DEBUG_CLEAR_MEM_CHECK_POINTS();
+		reader.CheckMem();
+		DEBUG_DUMP_MEM_LEAKS();
+		UNIT_ASSERT_MEM_NOTED("XmlReader 1.1");
+	}
+
+	// Tokens split across reads give the same nodes.
+	{
+		StringBuffer big;
+		StringBuffer small;
+		_ReadAll(XMLREADER_BUFFER_SIZE, big);
+		_ReadAll(16, small);
+		UNIT_ASSERT("small buffer", big.Equals(small.GetChars()));
+	}
+
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
+	UNIT_ASSERT_MEM_NOTED("XmlReader 1.2");
+	Log::SWriteOkFail( "XmlReader nodes" );
+}
+
+static void _TestXmlReaderSubtree()
+{
+	{
+		XmlReader reader(StringStreamPtr(new StringStream(_readerTestXml)));
+		while (reader.Read() && !reader.Name().Equals("item"))
+		{
+		}
+
+		XmlElementPtr item = reader.ReadSubtree();
+		UNIT_ASSERT("subtree name", item->Name().Equals("item"));
+		UNIT_ASSERT("subtree attribute", item->Attribute("name")->Value()->Equals("a > b"));
+		UNIT_ASSERT("subtree text", item->InnerText()->Equals("first <item> AB"));
+		UNIT_ASSERT("subtree end", XmlReader::END_ELEMENT == reader.NodeType() && 1 == reader.Depth());
+
+		UNIT_ASSERT("item 2", reader.Read() && reader.Name().Equals("item"));
+		reader.Skip();
+		UNIT_ASSERT("skipped", XmlReader::END_ELEMENT == reader.NodeType() && reader.Name().Equals("item"));
+		UNIT_ASSERT("after skip", reader.Read() && XmlReader::PROCESSING_INSTRUCTION == reader.NodeType());
+
+		UNIT_ASSERT("empty", reader.Read() && reader.IsEmptyElement());
+		item = reader.ReadSubtree();
+		UNIT_ASSERT("empty subtree", item->Name().Equals("empty") && item->Attribute("attr")->Value()->Equals("x"));
+		UNIT_ASSERT("feed end", reader.Read() && XmlReader::END_ELEMENT == reader.NodeType());
+
+		DEBUG_CLEAR_MEM_CHECK_POINTS();
+		reader.CheckMem();
+		item.CheckMem();
+		DEBUG_DUMP_MEM_LEAKS();
+		UNIT_ASSERT_MEM_NOTED("XmlReader 2.1");
+	}
+
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
+	UNIT_ASSERT_MEM_NOTED("XmlReader 2.2");
+	Log::SWriteOkFail( "XmlReader subtree" );
+}
+
+static void _TestXmlReaderStream()
+{
+	{
+		StringBuffer xml;
+		xml.Append("<feed>");
+		for (int x = 0; x < 2000; x++)
+		{
+			xml.Append("<item id=\"");
+			xml.Append(Int32::ToString(x));
+			xml.Append("\"><title>Item number ");
+			xml.Append(Int32::ToString(x));
+			xml.Append("</title></item>\n");
+		}
+		// Longer than the buffer.
+		xml.Append("<long>");
+		xml.Fill('z', 3000);
+		xml.Append("</long></feed>");
+
+		XmlReader reader(StringStreamPtr(new StringStream(*xml.ToString())), 1024);
+		int items = 0;
+		int64 sum = 0;
+		StringView value;
+		while (reader.Read())
+		{
+			if (XmlReader::ELEMENT == reader.NodeType() && reader.Name().Equals("item"))
+			{
+				items++;
+				UNIT_ASSERT("id", reader.TryGetAttribute("id", value));
+				sum += Int32::Parse(value.GetChars(), value.Length());
+			}
+			else if (XmlReader::TEXT == reader.NodeType() && 2 == reader.Depth())
+			{
+				UNIT_ASSERT("long text", 3000 == reader.Value().Length());
+			}
+		}
+		UNIT_ASSERT("items", 2000 == items && 1999 * 1000 == sum);
+	}
+
+	{
+		XmlReader reader(StringStreamPtr(new StringStream("<a><b></a></b>")));
+		try
+		{
+			while (reader.Read())
+			{
+			}
+			UNIT_ASSERT("mismatched tags", false);
+		}
+		catch (XmlException *ex)
+		{
+			delete ex;
+		}
+	}
+
+	{
+		XmlReader reader(StringStreamPtr(new StringStream("<a><b>")));
+		try
+		{
+			while (reader.Read())
+			{
+			}
+			UNIT_ASSERT("unclosed tags", false);
+		}
+		catch (XmlException *ex)
+		{
+			delete ex;
+		}
+	}
+
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
+	UNIT_ASSERT_MEM_NOTED("XmlReader 3.1");
+	Log::SWriteOkFail( "XmlReader stream" );
+}
+
+void _TestXmlReader()
+{
+	_TestXmlReaderNodes();
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
+
+	_TestXmlReaderSubtree();
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
+
+	_TestXmlReaderStream();
+	DEBUG_CLEAR_MEM_CHECK_POINTS();
+	DEBUG_DUMP_MEM_LEAKS();
+}
+
+#endif